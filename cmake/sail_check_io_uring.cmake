@@ -0,0 +1,33 @@
+# Intended to be included by SAIL.
+#
+function(sail_check_io_uring)
+    cmake_push_check_state(RESET)
+        check_c_source_compiles(
+        "
+            #include <linux/io_uring.h>
+            #include <sys/syscall.h>
+
+            int main(int argc, char *argv[]) {
+                struct io_uring_params params;
+                struct io_uring_probe probe;
+                int syscalls[] = { __NR_io_uring_setup, __NR_io_uring_enter, __NR_io_uring_register };
+                int values[] = { IORING_OP_READ, IORING_REGISTER_PROBE, IORING_FEAT_SINGLE_MMAP, IO_URING_OP_SUPPORTED };
+                (void)params;
+                (void)probe;
+                (void)syscalls;
+                (void)values;
+                return 0;
+            }
+        "
+        SAIL_HAVE_IO_URING
+        )
+        # This variable is used for displaying the test result with message()
+        # in the main CMake file.
+        #
+        if (SAIL_HAVE_IO_URING)
+            set(SAIL_HAVE_IO_URING_DISPLAY ON CACHE INTERNAL "")
+        else()
+            set(SAIL_HAVE_IO_URING_DISPLAY OFF CACHE INTERNAL "")
+        endif()
+    cmake_pop_check_state()
+endfunction()
@@ -0,0 +1,29 @@
+# Intended to be included by SAIL.
+#
+function(sail_check_posix_fadvise)
+    cmake_push_check_state(RESET)
+        set(CMAKE_REQUIRED_DEFINITIONS -D_POSIX_C_SOURCE=200112L)
+
+        check_c_source_compiles(
+        "
+            #include <fcntl.h>
+
+            int main(int argc, char *argv[]) {
+                posix_fadvise(0, 0, 0, POSIX_FADV_SEQUENTIAL);
+                posix_fadvise(0, 0, 0, POSIX_FADV_WILLNEED);
+                posix_fadvise(0, 0, 0, POSIX_FADV_DONTNEED);
+                return 0;
+            }
+        "
+        SAIL_HAVE_POSIX_FADVISE
+        )
+        # This variable is used for displaying the test result with message()
+        # in the main CMake file.
+        #
+        if (SAIL_HAVE_POSIX_FADVISE)
+            set(SAIL_HAVE_POSIX_FADVISE_DISPLAY ON CACHE INTERNAL "")
+        else()
+            set(SAIL_HAVE_POSIX_FADVISE_DISPLAY OFF CACHE INTERNAL "")
+        endif()
+    cmake_pop_check_state()
+endfunction()
@@ -0,0 +1,263 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+/*
+ * Quantizes the frames of an animated image through a shared palette and saves them as GIF
+ * with full frames in a single thread and with delta frames in the given number of threads.
+ */
+
+#include <stdio.h>
+#include <stdlib.h> /* atoi */
+#include <string.h>
+
+#include <sail/sail.h>
+#include <sail-manip/sail-manip.h>
+
+/* Limit of pixels to build the shared palette from. Frame rows are skipped evenly above that. */
+#define PALETTE_SAMPLE_PIXELS (16 * 1024 * 1024)
+
+static void destroy_frames(struct sail_image **frames, unsigned count) {
+
+    for (unsigned i = 0; i < count; i++) {
+        sail_destroy_image(frames[i]);
+    }
+
+    sail_free(frames);
+}
+
+static sail_status_t load_frames(const char *path, struct sail_image ***frames, unsigned *count) {
+
+    void *state = NULL;
+    SAIL_TRY_OR_CLEANUP(sail_start_loading_from_file(path, NULL, &state),
+                        /* cleanup */ sail_stop_loading(state));
+
+    struct sail_image **frames_local = NULL;
+    unsigned count_local = 0;
+    struct sail_image *image;
+    sail_status_t status;
+
+    while ((status = sail_load_next_frame(state, &image)) == SAIL_OK) {
+        struct sail_image *image_converted;
+        status = sail_convert_image(image, SAIL_PIXEL_FORMAT_BPP32_RGBA, &image_converted);
+        sail_destroy_image(image);
+
+        if (status != SAIL_OK) {
+            break;
+        }
+
+        void *ptr = frames_local;
+        status = sail_realloc(sizeof(struct sail_image *) * (count_local + 1), &ptr);
+
+        if (status != SAIL_OK) {
+            sail_destroy_image(image_converted);
+            break;
+        }
+
+        frames_local = ptr;
+        frames_local[count_local++] = image_converted;
+    }
+
+    sail_stop_loading(state);
+
+    if (status != SAIL_ERROR_NO_MORE_FRAMES || count_local == 0) {
+        destroy_frames(frames_local, count_local);
+        SAIL_LOG_AND_RETURN(status);
+    }
+
+    *frames = frames_local;
+    *count = count_local;
+
+    return SAIL_OK;
+}
+
+/* Quantizes the rows of all the frames stacked together. */
+static sail_status_t build_shared_palette(struct sail_image **frames, unsigned count, struct sail_palette **palette) {
+
+    const unsigned width = frames[0]->width;
+    const size_t total_rows = (size_t)frames[0]->height * count;
+    const size_t step = (total_rows * width + PALETTE_SAMPLE_PIXELS - 1) / PALETTE_SAMPLE_PIXELS;
+
+    struct sail_image *sample;
+    SAIL_TRY(sail_alloc_image(&sample));
+
+    sample->width          = width;
+    sample->height         = (unsigned)((total_rows + step - 1) / step);
+    sample->pixel_format   = SAIL_PIXEL_FORMAT_BPP32_RGBA;
+    sample->bytes_per_line = sail_bytes_per_line(sample->width, sample->pixel_format);
+
+    SAIL_TRY_OR_CLEANUP(sail_malloc((size_t)sample->bytes_per_line * sample->height, &sample->pixels),
+                        /* cleanup */ sail_destroy_image(sample));
+
+    for (unsigned row = 0; row < sample->height; row++) {
+        const size_t source_row = row * step;
+        const struct sail_image *frame = frames[source_row / frames[0]->height];
+
+        memcpy(sail_scan_line(sample, row), sail_scan_line(frame, (unsigned)(source_row % frames[0]->height)), sample->bytes_per_line);
+    }
+
+    struct sail_image *sample_quantized;
+    SAIL_TRY_OR_CLEANUP(sail_convert_image(sample, SAIL_PIXEL_FORMAT_BPP8_INDEXED, &sample_quantized),
+                        /* cleanup */ sail_destroy_image(sample));
+    sail_destroy_image(sample);
+
+    *palette = sample_quantized->palette;
+    sample_quantized->palette = NULL;
+    sail_destroy_image(sample_quantized);
+
+    return SAIL_OK;
+}
+
+static sail_status_t save_gif(struct sail_image **frames, unsigned count, const struct sail_codec_info *codec_info,
+                                bool delta_frames, unsigned threads, uint64_t *elapsed, size_t *size) {
+
+    struct sail_save_options *save_options;
+    SAIL_TRY(sail_alloc_save_options_from_features(codec_info->save_features, &save_options));
+
+    if (save_options->tuning == NULL) {
+        SAIL_TRY_OR_CLEANUP(sail_alloc_hash_map(&save_options->tuning),
+                            /* cleanup */ sail_destroy_save_options(save_options));
+    }
+
+    struct sail_variant *variant;
+    SAIL_TRY_OR_CLEANUP(sail_alloc_variant(&variant),
+                        /* cleanup */ sail_destroy_save_options(save_options));
+
+    sail_set_variant_bool(variant, delta_frames);
+    SAIL_TRY_OR_CLEANUP(sail_put_hash_map(save_options->tuning, "gif-delta-frames", variant),
+                        /* cleanup */ sail_destroy_variant(variant),
+                                      sail_destroy_save_options(save_options));
+
+    sail_set_variant_unsigned_int(variant, threads);
+    SAIL_TRY_OR_CLEANUP(sail_put_hash_map(save_options->tuning, "gif-threads", variant),
+                        /* cleanup */ sail_destroy_variant(variant),
+                                      sail_destroy_save_options(save_options));
+    sail_destroy_variant(variant);
+
+    struct sail_io *io;
+    SAIL_TRY_OR_CLEANUP(sail_alloc_io_write_growable_memory(&io),
+                        /* cleanup */ sail_destroy_save_options(save_options));
+
+    const uint64_t start = sail_now();
+
+    void *state = NULL;
+    SAIL_TRY_OR_CLEANUP(sail_start_saving_into_io_with_options(io, codec_info, save_options, &state),
+                        /* cleanup */ sail_stop_saving(state), sail_destroy_io(io), sail_destroy_save_options(save_options));
+    sail_destroy_save_options(save_options);
+
+    for (unsigned i = 0; i < count; i++) {
+        SAIL_TRY_OR_CLEANUP(sail_write_next_frame(state, frames[i]),
+                            /* cleanup */ sail_stop_saving(state), sail_destroy_io(io));
+    }
+
+    SAIL_TRY_OR_CLEANUP(sail_stop_saving(state),
+                        /* cleanup */ sail_destroy_io(io));
+
+    *elapsed = sail_now() - start;
+
+    SAIL_TRY_OR_CLEANUP(io->tell(io->stream, size),
+                        /* cleanup */ sail_destroy_io(io));
+    sail_destroy_io(io);
+
+    return SAIL_OK;
+}
+
+int main(int argc, char *argv[]) {
+
+    if (argc < 2 || strcmp(argv[1], "-h") == 0) {
+        fprintf(stderr, "Usage: sail-gif-benchmark [-t THREADS] FILE\n");
+        fprintf(stderr, "       -t THREADS - number of threads to compare with, 0 (OpenMP default) by default\n");
+        return 1;
+    }
+
+    unsigned threads = 0;
+    int first = 1;
+
+    if (strcmp(argv[1], "-t") == 0) {
+        if (argc < 4) {
+            fprintf(stderr, "Error: Invalid arguments. Run with -h to see command arguments.\n");
+            return 1;
+        }
+
+        threads = (unsigned)atoi(argv[2]);
+        first = 3;
+    }
+
+    sail_set_log_barrier(SAIL_LOG_LEVEL_ERROR);
+
+    struct sail_image **frames;
+    unsigned count;
+    SAIL_TRY_OR_EXECUTE(load_frames(argv[first], &frames, &count),
+                        /* on error */ return 1);
+
+    for (unsigned i = 1; i < count; i++) {
+        if (frames[i]->width != frames[0]->width || frames[i]->height != frames[0]->height) {
+            fprintf(stderr, "Error: All frames must have the same dimensions.\n");
+            destroy_frames(frames, count);
+            return 1;
+        }
+    }
+
+    const struct sail_codec_info *codec_info;
+    SAIL_TRY_OR_EXECUTE(sail_codec_info_from_extension("gif", &codec_info),
+                        /* on error */ destroy_frames(frames, count); return 1);
+
+    /* Quantize. */
+    const uint64_t quantize_start = sail_now();
+
+    struct sail_conversion_options *conversion_options;
+    SAIL_TRY_OR_EXECUTE(sail_alloc_conversion_options(&conversion_options),
+                        /* on error */ destroy_frames(frames, count); return 1);
+
+    SAIL_TRY_OR_EXECUTE(build_shared_palette(frames, count, &conversion_options->palette),
+                        /* on error */ sail_destroy_conversion_options(conversion_options); destroy_frames(frames, count); return 1);
+
+    for (unsigned i = 0; i < count; i++) {
+        struct sail_image *image_quantized;
+        SAIL_TRY_OR_EXECUTE(sail_convert_image_with_options(frames[i], SAIL_PIXEL_FORMAT_BPP8_INDEXED, conversion_options, &image_quantized),
+                            /* on error */ sail_destroy_conversion_options(conversion_options); destroy_frames(frames, count); return 1);
+        sail_destroy_image(frames[i]);
+        frames[i] = image_quantized;
+    }
+
+    sail_destroy_conversion_options(conversion_options);
+
+    printf("%u frames %ux%u quantized in %u ms\n", count, frames[0]->width, frames[0]->height, (unsigned)(sail_now() - quantize_start));
+
+    uint64_t full_elapsed, delta_elapsed;
+    size_t full_size, delta_size;
+
+    SAIL_TRY_OR_EXECUTE(save_gif(frames, count, codec_info, false, 1, &full_elapsed, &full_size),
+                        /* on error */ destroy_frames(frames, count); return 1);
+    SAIL_TRY_OR_EXECUTE(save_gif(frames, count, codec_info, true, threads, &delta_elapsed, &delta_size),
+                        /* on error */ destroy_frames(frames, count); return 1);
+
+    printf("Encoder                   | Time, ms | Size, bytes\n");
+    printf("Full frames, 1 thread     | %8u | %11zu\n", (unsigned)full_elapsed, full_size);
+    printf("Delta frames, parallel    | %8u | %11zu\n", (unsigned)delta_elapsed, delta_size);
+
+    destroy_frames(frames, count);
+
+    return 0;
+}
@@ -0,0 +1,195 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+/*
+ * Compares the regular FILE-based I/O with the prefetched I/O when loading many files
+ * on a cold page cache. The prefetched I/O is measured with io_uring, if SAIL is built with it,
+ * and with posix_fadvise(). The page cache is dropped per file with POSIX_FADV_DONTNEED,
+ * so no root privileges are required.
+ */
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h> /* atoi */
+#include <string.h>
+#include <unistd.h>
+
+#include <sail/sail.h>
+
+typedef sail_status_t (*alloc_io_func)(const char *path, struct sail_io **io);
+
+/* Reads the files without decoding them when set, like copying or hashing tools do. */
+static bool read_only = false;
+
+static void drop_page_cache(int argc, char *argv[]) {
+
+    for (int i = 0; i < argc; i++) {
+        const int fd = open(argv[i], O_RDONLY);
+
+        if (fd >= 0) {
+            posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+            close(fd);
+        }
+    }
+}
+
+static sail_status_t load_file(const char *path, alloc_io_func alloc_io) {
+
+    const struct sail_codec_info *codec_info;
+    SAIL_TRY(sail_codec_info_from_path(path, &codec_info));
+
+    struct sail_io *io;
+    SAIL_TRY(alloc_io(path, &io));
+
+    void *state;
+    SAIL_TRY_OR_CLEANUP(sail_start_loading_from_io(io, codec_info, &state),
+                        /* cleanup */ sail_destroy_io(io));
+
+    struct sail_image *image;
+    sail_status_t status;
+
+    while ((status = sail_load_next_frame(state, &image)) == SAIL_OK) {
+        sail_destroy_image(image);
+    }
+
+    sail_stop_loading(state);
+    sail_destroy_io(io);
+
+    if (status != SAIL_ERROR_NO_MORE_FRAMES) {
+        SAIL_LOG_AND_RETURN(status);
+    }
+
+    return SAIL_OK;
+}
+
+static sail_status_t read_file(const char *path, alloc_io_func alloc_io) {
+
+    struct sail_io *io;
+    SAIL_TRY(alloc_io(path, &io));
+
+    static unsigned char buffer[64 * 1024];
+    size_t read_size;
+
+    do {
+        SAIL_TRY_OR_CLEANUP(io->tolerant_read(io->stream, buffer, sizeof(buffer), &read_size),
+                            /* cleanup */ sail_destroy_io(io));
+    } while (read_size > 0);
+
+    sail_destroy_io(io);
+
+    return SAIL_OK;
+}
+
+static sail_status_t benchmark(int argc, char *argv[], alloc_io_func alloc_io, int prefetch, uint64_t *elapsed) {
+
+    drop_page_cache(argc, argv);
+
+    const uint64_t start = sail_now();
+
+    /* Prefetch the first files. */
+    for (int i = 0; i < prefetch && i < argc; i++) {
+        SAIL_TRY(sail_prefetch_file(argv[i]));
+    }
+
+    for (int i = 0; i < argc; i++) {
+        /* Keep 'prefetch' files ahead of the decoder. */
+        if (prefetch > 0 && i + prefetch < argc) {
+            SAIL_TRY(sail_prefetch_file(argv[i + prefetch]));
+        }
+
+        if (read_only) {
+            SAIL_TRY(read_file(argv[i], alloc_io));
+        } else {
+            SAIL_TRY(load_file(argv[i], alloc_io));
+        }
+    }
+
+    *elapsed = sail_now() - start;
+
+    return SAIL_OK;
+}
+
+int main(int argc, char *argv[]) {
+
+    if (argc < 2 || strcmp(argv[1], "-h") == 0) {
+        fprintf(stderr, "Usage: sail-io-benchmark [-p PREFETCH] [-r] FILE...\n");
+        fprintf(stderr, "       -p PREFETCH - number of files to prefetch ahead, 4 by default\n");
+        fprintf(stderr, "       -r          - read the files without decoding them\n");
+        return 1;
+    }
+
+    int prefetch = 4;
+    int first = 1;
+
+    for (; first < argc && argv[first][0] == '-'; first++) {
+        if (strcmp(argv[first], "-p") == 0 && first + 1 < argc) {
+            prefetch = atoi(argv[++first]);
+        } else if (strcmp(argv[first], "-r") == 0) {
+            read_only = true;
+        } else {
+            fprintf(stderr, "Error: Invalid arguments. Run with -h to see command arguments.\n");
+            return 1;
+        }
+    }
+
+    if (first == argc) {
+        fprintf(stderr, "Error: Invalid arguments. Run with -h to see command arguments.\n");
+        return 1;
+    }
+
+    sail_set_log_barrier(SAIL_LOG_LEVEL_SILENCE);
+
+    /* Load codecs before measuring. */
+    SAIL_TRY_OR_EXECUTE(load_file(argv[first], sail_alloc_io_read_file),
+                        /* on error */ return 1);
+
+    uint64_t file_elapsed;
+    uint64_t prefetched_elapsed;
+
+    SAIL_TRY_OR_EXECUTE(benchmark(argc - first, argv + first, sail_alloc_io_read_file, 0, &file_elapsed),
+                        /* on error */ return 1);
+
+#ifdef SAIL_HAVE_IO_URING
+    uint64_t uring_elapsed;
+
+    SAIL_TRY_OR_EXECUTE(benchmark(argc - first, argv + first, sail_alloc_io_read_file_prefetched, prefetch, &uring_elapsed),
+                        /* on error */ return 1);
+
+    setenv("SAIL_DISABLE_IO_URING", "1", 1);
+#endif
+
+    SAIL_TRY_OR_EXECUTE(benchmark(argc - first, argv + first, sail_alloc_io_read_file_prefetched, prefetch, &prefetched_elapsed),
+                        /* on error */ return 1);
+
+    printf("Files:                                     %d\n", argc - first);
+    printf("FILE I/O:                                  %u ms.\n", (unsigned)file_elapsed);
+    printf("Prefetched I/O, posix_fadvise (%d ahead):   %u ms.\n", prefetch, (unsigned)prefetched_elapsed);
+#ifdef SAIL_HAVE_IO_URING
+    printf("Prefetched I/O, io_uring (%d ahead):        %u ms.\n", prefetch, (unsigned)uring_elapsed);
+#endif
+
+    return 0;
+}
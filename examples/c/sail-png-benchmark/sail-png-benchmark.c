@@ -0,0 +1,143 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+/*
+ * Saves an image as PNG at every compression level with a single thread and with
+ * the given number of threads to compare the serial libpng encoder with the parallel one.
+ */
+
+#include <stdio.h>
+#include <stdlib.h> /* atoi */
+#include <string.h>
+
+#include <sail/sail.h>
+#include <sail-manip/sail-manip.h>
+
+static sail_status_t save_png(const struct sail_image *image, const struct sail_codec_info *codec_info,
+                                int compression_level, unsigned threads, uint64_t *elapsed, size_t *size) {
+
+    struct sail_save_options *save_options;
+    SAIL_TRY(sail_alloc_save_options_from_features(codec_info->save_features, &save_options));
+
+    save_options->compression_level = compression_level;
+    save_options->options &= ~SAIL_OPTION_INTERLACED;
+
+    if (save_options->tuning == NULL) {
+        SAIL_TRY_OR_CLEANUP(sail_alloc_hash_map(&save_options->tuning),
+                            /* cleanup */ sail_destroy_save_options(save_options));
+    }
+
+    struct sail_variant *variant;
+    SAIL_TRY_OR_CLEANUP(sail_alloc_variant(&variant),
+                        /* cleanup */ sail_destroy_save_options(save_options));
+    sail_set_variant_unsigned_int(variant, threads);
+
+    SAIL_TRY_OR_CLEANUP(sail_put_hash_map(save_options->tuning, "png-threads", variant),
+                        /* cleanup */ sail_destroy_variant(variant),
+                                      sail_destroy_save_options(save_options));
+    sail_destroy_variant(variant);
+
+    struct sail_io *io;
+    SAIL_TRY_OR_CLEANUP(sail_alloc_io_write_growable_memory(&io),
+                        /* cleanup */ sail_destroy_save_options(save_options));
+
+    const uint64_t start = sail_now();
+
+    void *state = NULL;
+    SAIL_TRY_OR_CLEANUP(sail_start_saving_into_io_with_options(io, codec_info, save_options, &state),
+                        /* cleanup */ sail_stop_saving(state), sail_destroy_io(io), sail_destroy_save_options(save_options));
+    sail_destroy_save_options(save_options);
+
+    SAIL_TRY_OR_CLEANUP(sail_write_next_frame(state, image),
+                        /* cleanup */ sail_stop_saving(state), sail_destroy_io(io));
+    SAIL_TRY_OR_CLEANUP(sail_stop_saving(state),
+                        /* cleanup */ sail_destroy_io(io));
+
+    *elapsed = sail_now() - start;
+
+    SAIL_TRY_OR_CLEANUP(io->tell(io->stream, size),
+                        /* cleanup */ sail_destroy_io(io));
+    sail_destroy_io(io);
+
+    return SAIL_OK;
+}
+
+int main(int argc, char *argv[]) {
+
+    if (argc < 2 || strcmp(argv[1], "-h") == 0) {
+        fprintf(stderr, "Usage: sail-png-benchmark [-t THREADS] FILE\n");
+        fprintf(stderr, "       -t THREADS - number of threads to compare with, 0 (OpenMP default) by default\n");
+        return 1;
+    }
+
+    unsigned threads = 0;
+    int first = 1;
+
+    if (strcmp(argv[1], "-t") == 0) {
+        if (argc < 4) {
+            fprintf(stderr, "Error: Invalid arguments. Run with -h to see command arguments.\n");
+            return 1;
+        }
+
+        threads = (unsigned)atoi(argv[2]);
+        first = 3;
+    }
+
+    sail_set_log_barrier(SAIL_LOG_LEVEL_ERROR);
+
+    struct sail_image *image;
+    SAIL_TRY_OR_EXECUTE(sail_load_from_file(argv[first], &image),
+                        /* on error */ return 1);
+
+    const struct sail_codec_info *codec_info;
+    SAIL_TRY_OR_EXECUTE(sail_codec_info_from_extension("png", &codec_info),
+                        /* on error */ sail_destroy_image(image); return 1);
+
+    struct sail_image *image_converted;
+    SAIL_TRY_OR_EXECUTE(sail_convert_image_for_saving(image, codec_info->save_features, &image_converted),
+                        /* on error */ sail_destroy_image(image); return 1);
+    sail_destroy_image(image);
+    image = image_converted;
+
+    printf("Level | Serial, ms | Size, bytes | Parallel, ms | Size, bytes\n");
+
+    for (int level = codec_info->save_features->compression_level->min_level;
+            level <= codec_info->save_features->compression_level->max_level; level++) {
+        uint64_t serial_elapsed, parallel_elapsed;
+        size_t serial_size, parallel_size;
+
+        SAIL_TRY_OR_EXECUTE(save_png(image, codec_info, level, 1, &serial_elapsed, &serial_size),
+                            /* on error */ sail_destroy_image(image); return 1);
+        SAIL_TRY_OR_EXECUTE(save_png(image, codec_info, level, threads, &parallel_elapsed, &parallel_size),
+                            /* on error */ sail_destroy_image(image); return 1);
+
+        printf("%5d | %10u | %11zu | %12u | %11zu\n",
+                level, (unsigned)serial_elapsed, serial_size, (unsigned)parallel_elapsed, parallel_size);
+    }
+
+    sail_destroy_image(image);
+
+    return 0;
+}
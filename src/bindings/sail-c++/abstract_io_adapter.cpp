@@ -34,83 +34,113 @@ namespace sail
  * Private functions.
  */
 
+namespace
+{
+
+struct wrapped_stream
+{
+    explicit wrapped_stream(sail::abstract_io &other_abstract_io)
+        : abstract_io(other_abstract_io)
+    {
+    }
+
+    sail::abstract_io &abstract_io;
+    sail::cancellation_token token;
+};
+
+sail_status_t check_cancelled(const wrapped_stream &stream) {
+
+    if (stream.token.is_cancelled()) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_CANCELLED);
+    }
+
+    return SAIL_OK;
+}
+
+}
+
 static sail_status_t wrapped_tolerant_read(void *stream, void *buf, size_t size_to_read, size_t *read_size) {
 
-    sail::abstract_io &abstract_io = *reinterpret_cast<sail::abstract_io *&>(stream);
+    wrapped_stream &wrapped = *reinterpret_cast<wrapped_stream *>(stream);
 
-    SAIL_TRY(abstract_io.tolerant_read(buf, size_to_read, read_size));
+    SAIL_TRY(check_cancelled(wrapped));
+    SAIL_TRY(wrapped.abstract_io.tolerant_read(buf, size_to_read, read_size));
 
     return SAIL_OK;
 }
 
 static sail_status_t wrapped_strict_read(void *stream, void *buf, size_t size_to_read) {
 
-    sail::abstract_io &abstract_io = *reinterpret_cast<sail::abstract_io *&>(stream);
+    wrapped_stream &wrapped = *reinterpret_cast<wrapped_stream *>(stream);
 
-    SAIL_TRY(abstract_io.strict_read(buf, size_to_read));
+    SAIL_TRY(check_cancelled(wrapped));
+    SAIL_TRY(wrapped.abstract_io.strict_read(buf, size_to_read));
 
     return SAIL_OK;
 }
 
 static sail_status_t wrapped_tolerant_write(void *stream, const void *buf, size_t size_to_write, size_t *written_size) {
 
-    sail::abstract_io &abstract_io = *reinterpret_cast<sail::abstract_io *&>(stream);
+    wrapped_stream &wrapped = *reinterpret_cast<wrapped_stream *>(stream);
 
-    SAIL_TRY(abstract_io.tolerant_write(buf, size_to_write, written_size));
+    SAIL_TRY(check_cancelled(wrapped));
+    SAIL_TRY(wrapped.abstract_io.tolerant_write(buf, size_to_write, written_size));
 
     return SAIL_OK;
 }
 
 static sail_status_t wrapped_strict_write(void *stream, const void *buf, size_t size_to_write) {
 
-    sail::abstract_io &abstract_io = *reinterpret_cast<sail::abstract_io *&>(stream);
+    wrapped_stream &wrapped = *reinterpret_cast<wrapped_stream *>(stream);
 
-    SAIL_TRY(abstract_io.strict_write(buf, size_to_write));
+    SAIL_TRY(check_cancelled(wrapped));
+    SAIL_TRY(wrapped.abstract_io.strict_write(buf, size_to_write));
 
     return SAIL_OK;
 }
 
 static sail_status_t wrapped_seek(void *stream, long offset, int whence) {
 
-    sail::abstract_io &abstract_io = *reinterpret_cast<sail::abstract_io *&>(stream);
+    wrapped_stream &wrapped = *reinterpret_cast<wrapped_stream *>(stream);
 
-    SAIL_TRY(abstract_io.seek(offset, whence));
+    SAIL_TRY(check_cancelled(wrapped));
+    SAIL_TRY(wrapped.abstract_io.seek(offset, whence));
 
     return SAIL_OK;
 }
 
 static sail_status_t wrapped_tell(void *stream, size_t *offset) {
 
-    sail::abstract_io &abstract_io = *reinterpret_cast<sail::abstract_io *&>(stream);
+    wrapped_stream &wrapped = *reinterpret_cast<wrapped_stream *>(stream);
 
-    SAIL_TRY(abstract_io.tell(offset));
+    SAIL_TRY(wrapped.abstract_io.tell(offset));
 
     return SAIL_OK;
 }
 
 static sail_status_t wrapped_flush(void *stream) {
 
-    sail::abstract_io &abstract_io = *reinterpret_cast<sail::abstract_io *&>(stream);
+    wrapped_stream &wrapped = *reinterpret_cast<wrapped_stream *>(stream);
 
-    SAIL_TRY(abstract_io.flush());
+    SAIL_TRY(wrapped.abstract_io.flush());
 
     return SAIL_OK;
 }
 
 static sail_status_t wrapped_close(void *stream) {
 
-    sail::abstract_io &abstract_io = *reinterpret_cast<sail::abstract_io *&>(stream);
+    wrapped_stream &wrapped = *reinterpret_cast<wrapped_stream *>(stream);
 
-    SAIL_TRY(abstract_io.close());
+    SAIL_TRY(wrapped.abstract_io.close());
 
     return SAIL_OK;
 }
 
 static sail_status_t wrapped_eof(void *stream, bool *result) {
 
-    sail::abstract_io &abstract_io = *reinterpret_cast<sail::abstract_io *&>(stream);
+    wrapped_stream &wrapped = *reinterpret_cast<wrapped_stream *>(stream);
 
-    SAIL_TRY(abstract_io.eof(result));
+    SAIL_TRY(wrapped.abstract_io.eof(result));
 
     return SAIL_OK;
 }
@@ -119,10 +149,10 @@ class SAIL_HIDDEN abstract_io_adapter::pimpl
 {
 public:
     explicit pimpl(sail::abstract_io &other_abstract_io)
-        : abstract_io(other_abstract_io)
+        : stream(other_abstract_io)
     {
-        sail_io.features       = abstract_io.features();
-        sail_io.stream         = &abstract_io;
+        sail_io.features       = stream.abstract_io.features();
+        sail_io.stream         = &stream;
         sail_io.tolerant_read  = wrapped_tolerant_read;
         sail_io.strict_read    = wrapped_strict_read;
         sail_io.tolerant_write = wrapped_tolerant_write;
@@ -134,7 +164,7 @@ public:
         sail_io.eof            = wrapped_eof;
     }
 
-    sail::abstract_io &abstract_io;
+    wrapped_stream stream;
     struct sail_io sail_io;
 };
 
@@ -152,4 +182,9 @@ struct sail_io& abstract_io_adapter::sail_io_c() const
     return d->sail_io;
 }
 
+void abstract_io_adapter::set_cancellation_token(const sail::cancellation_token &token)
+{
+    d->stream.token = token;
+}
+
 }
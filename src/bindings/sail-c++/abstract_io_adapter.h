@@ -37,6 +37,7 @@ namespace sail
 {
 
 class abstract_io;
+class cancellation_token;
 
 /*
  * Adapter to make abstract I/O streams suitable for C functions.
@@ -59,6 +60,12 @@ public:
      */
     struct sail_io& sail_io_c() const;
 
+    /*
+     * Makes all the read, write, and seek operations fail with SAIL_ERROR_CANCELLED
+     * once the specified token is cancelled.
+     */
+    void set_cancellation_token(const sail::cancellation_token &token);
+
 private:
     class pimpl;
     const std::unique_ptr<pimpl> d;
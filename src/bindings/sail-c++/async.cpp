@@ -0,0 +1,223 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <sail-c++/sail-c++.h>
+
+namespace sail
+{
+
+/*
+ * Private functions.
+ */
+
+namespace
+{
+
+class thread_pool
+{
+public:
+    thread_pool()
+        : stopped(false)
+    {
+        const unsigned threads = std::max(std::thread::hardware_concurrency(), 1U);
+
+        for (unsigned i = 0; i < threads; i++) {
+            workers.emplace_back(&thread_pool::run, this);
+        }
+    }
+
+    ~thread_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopped = true;
+        }
+
+        condition.notify_all();
+
+        for (std::thread &worker : workers) {
+            worker.join();
+        }
+    }
+
+    void post(std::function<void()> task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back(std::move(task));
+        }
+
+        condition.notify_one();
+    }
+
+private:
+    void run()
+    {
+        for (;;) {
+            std::function<void()> task;
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [this] { return stopped || !tasks.empty(); });
+
+                /* Finish the queued tasks before stopping to fulfill their promises. */
+                if (tasks.empty()) {
+                    return;
+                }
+
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+
+            task();
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<std::function<void()>> tasks;
+    std::vector<std::thread> workers;
+    bool stopped;
+};
+
+}
+
+executor default_executor()
+{
+    static thread_pool pool;
+
+    return [](std::function<void()> task) {
+        pool.post(std::move(task));
+    };
+}
+
+class SAIL_HIDDEN cancellation_token::pimpl
+{
+public:
+    pimpl()
+        : cancelled(false)
+    {
+    }
+
+    std::atomic<bool> cancelled;
+};
+
+cancellation_token::cancellation_token()
+    : d(std::make_shared<pimpl>())
+{
+}
+
+void cancellation_token::cancel()
+{
+    d->cancelled.store(true, std::memory_order_relaxed);
+}
+
+bool cancellation_token::is_cancelled() const
+{
+    return d->cancelled.load(std::memory_order_relaxed);
+}
+
+std::future<std::tuple<sail::image, sail_status_t>> load_async(const std::string &path, const sail::cancellation_token &token, const sail::executor &executor)
+{
+    std::shared_ptr<std::promise<std::tuple<sail::image, sail_status_t>>> promise =
+        std::make_shared<std::promise<std::tuple<sail::image, sail_status_t>>>();
+    std::future<std::tuple<sail::image, sail_status_t>> future = promise->get_future();
+
+    executor([path, token, promise] {
+        if (token.is_cancelled()) {
+            promise->set_value(std::make_tuple(sail::image(), SAIL_ERROR_CANCELLED));
+            return;
+        }
+
+        sail::image image;
+        sail_status_t status;
+
+        /* Opening a file throws on error, pass the exception to the future. */
+        try {
+            sail::image_input image_input(path);
+            image_input.with(token);
+
+            status = image_input.next_frame(&image);
+
+            if (status != SAIL_OK) {
+                image = sail::image();
+            }
+        } catch (...) {
+            promise->set_exception(std::current_exception());
+            return;
+        }
+
+        promise->set_value(std::make_tuple(std::move(image), status));
+    });
+
+    return future;
+}
+
+std::future<sail_status_t> save_async(const std::string &path, sail::image image, const sail::cancellation_token &token, const sail::executor &executor)
+{
+    std::shared_ptr<std::promise<sail_status_t>> promise = std::make_shared<std::promise<sail_status_t>>();
+    std::future<sail_status_t> future = promise->get_future();
+
+    /* C++11 lambdas cannot capture by move, so share the image with the task to avoid copying pixels. */
+    std::shared_ptr<sail::image> shared_image = std::make_shared<sail::image>(std::move(image));
+
+    executor([path, shared_image, token, promise] {
+        if (token.is_cancelled()) {
+            promise->set_value(SAIL_ERROR_CANCELLED);
+            return;
+        }
+
+        sail_status_t status;
+
+        /* Opening a file throws on error, pass the exception to the future. */
+        try {
+            sail::image_output image_output(path);
+            image_output.with(token);
+
+            status = image_output.next_frame(*shared_image);
+
+            if (status == SAIL_OK) {
+                status = image_output.finish();
+            }
+        } catch (...) {
+            promise->set_exception(std::current_exception());
+            return;
+        }
+
+        promise->set_value(status);
+    });
+
+    return future;
+}
+
+}
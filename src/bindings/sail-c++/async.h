@@ -0,0 +1,121 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_ASYNC_CPP_H
+#define SAIL_ASYNC_CPP_H
+
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <tuple>
+
+#include <sail-common/export.h>
+#include <sail-common/status.h>
+
+#include <sail-c++/image.h>
+
+namespace sail
+{
+
+/*
+ * Runs tasks of asynchronous operations. An executor must eventually run every posted task
+ * exactly once, in any thread. For example, an executor posting tasks to an application
+ * event loop:
+ *
+ *     sail::executor executor = [&loop](std::function<void()> task) { loop.post(std::move(task)); };
+ */
+using executor = std::function<void(std::function<void()>)>;
+
+/*
+ * Returns the built-in executor. It runs tasks on a shared pool of std::thread::hardware_concurrency()
+ * worker threads. The pool is started on first use and stopped at program exit.
+ *
+ * The workers take tasks from a single FIFO queue, there is no work stealing. Don't wait
+ * for the future of another task posted to the built-in executor from its task. When all
+ * the workers wait, no worker is left to run the awaited tasks. Provide your own executor
+ * for nested or long-running workloads.
+ */
+SAIL_EXPORT executor default_executor();
+
+/*
+ * Cancels asynchronous operations. Copies of a token share the same state, so cancelling
+ * any copy cancels all of them.
+ *
+ * Cancellation is checked before an operation starts and on every read, write, and seek
+ * of the I/O stream. A cancelled operation fails with SAIL_ERROR_CANCELLED at the next check.
+ * There are no checks between scan lines. Codecs that stream data, like PNG or GIF,
+ * stop at the next chunk they read. Codecs that read the whole file before decoding it,
+ * like WebP, don't notice cancellation while decoding.
+ */
+class SAIL_EXPORT cancellation_token
+{
+public:
+    /*
+     * Constructs a new token that is not cancelled.
+     */
+    cancellation_token();
+
+    /*
+     * Cancels all the operations that use this token.
+     */
+    void cancel();
+
+    /*
+     * Returns true if the token is cancelled.
+     */
+    bool is_cancelled() const;
+
+private:
+    class pimpl;
+    std::shared_ptr<pimpl> d;
+};
+
+/*
+ * Loads the first frame of the specified image file asynchronously.
+ *
+ * The future holds the loaded image and SAIL_OK on success. On error, it holds an invalid image
+ * and the error status, SAIL_ERROR_CANCELLED on cancellation. If the file cannot be opened,
+ * the future rethrows the exception thrown by sail::io_file.
+ */
+SAIL_EXPORT std::future<std::tuple<sail::image, sail_status_t>> load_async(const std::string &path,
+                                                                           const sail::cancellation_token &token = sail::cancellation_token(),
+                                                                           const sail::executor &executor = default_executor());
+
+/*
+ * Saves the image into the specified file asynchronously. Detects the image format based
+ * on the file extension. Move the image into the function to avoid copying its pixels.
+ *
+ * The future holds SAIL_OK on success. If the file cannot be opened, the future rethrows
+ * the exception thrown by sail::io_file.
+ */
+SAIL_EXPORT std::future<sail_status_t> save_async(const std::string &path,
+                                                  sail::image image,
+                                                  const sail::cancellation_token &token = sail::cancellation_token(),
+                                                  const sail::executor &executor = default_executor());
+
+}
+
+#endif
@@ -48,6 +48,7 @@ public:
     }
 
     sail_conversion_options *conversion_options;
+    sail::palette palette;
 };
 
 conversion_options::conversion_options()
@@ -80,6 +81,9 @@ conversion_options& conversion_options::operator=(const conversion_options &co)
     set_options(co.options());
     set_background(co.background48());
     set_background(co.background24());
+    set_quantization(co.quantization());
+    set_dithering(co.dithering());
+    set_palette(co.palette());
 
     return *this;
 }
@@ -115,6 +119,21 @@ sail_rgb24_t conversion_options::background24() const
     return d->conversion_options->background24;
 }
 
+SailQuantizationAlgorithm conversion_options::quantization() const
+{
+    return d->conversion_options->quantization;
+}
+
+SailDithering conversion_options::dithering() const
+{
+    return d->conversion_options->dithering;
+}
+
+const sail::palette& conversion_options::palette() const
+{
+    return d->palette;
+}
+
 void conversion_options::set_options(int options)
 {
     d->conversion_options->options = options;
@@ -142,12 +161,34 @@ void conversion_options::set_background(const sail_rgb24_t &rgb24)
     };
 }
 
+void conversion_options::set_quantization(SailQuantizationAlgorithm quantization)
+{
+    d->conversion_options->quantization = quantization;
+}
+
+void conversion_options::set_dithering(SailDithering dithering)
+{
+    d->conversion_options->dithering = dithering;
+}
+
+void conversion_options::set_palette(const sail::palette &palette)
+{
+    d->palette = palette;
+}
+
 sail_status_t conversion_options::to_sail_conversion_options(sail_conversion_options **conversion_options) const
 {
     SAIL_CHECK_PTR(conversion_options);
 
     SAIL_TRY(sail_alloc_conversion_options(conversion_options));
     **conversion_options = *d->conversion_options;
+    (*conversion_options)->palette = nullptr;
+
+    if (d->palette.is_valid()) {
+        SAIL_TRY_OR_CLEANUP(d->palette.to_sail_palette(&(*conversion_options)->palette),
+                            /* cleanup */ sail_destroy_conversion_options(*conversion_options),
+                                          *conversion_options = nullptr);
+    }
 
     return SAIL_OK;
 }
@@ -34,6 +34,8 @@
 
 #include <sail-manip/manip_common.h>
 
+#include <sail-c++/palette.h>
+
 struct sail_conversion_options;
 
 namespace sail
@@ -108,6 +110,22 @@ public:
      */
     sail_rgb24_t background24() const;
 
+    /*
+     * Returns the algorithm to build palettes when converting to indexed pixel formats.
+     */
+    SailQuantizationAlgorithm quantization() const;
+
+    /*
+     * Returns the dithering method to use when converting to indexed pixel formats.
+     */
+    SailDithering dithering() const;
+
+    /*
+     * Returns the fixed palette to map pixels to when converting to indexed pixel formats.
+     * If the palette is invalid, a new palette is built with the quantization algorithm.
+     */
+    const sail::palette& palette() const;
+
     /*
      * Sets new or-ed SailConversionOption-s. If zero, SAIL_CONVERSION_OPTION_DROP_ALPHA is assumed.
      */
@@ -125,6 +143,23 @@ public:
      */
     void set_background(const sail_rgb24_t &rgb24);
 
+    /*
+     * Sets a new algorithm to build palettes when converting to indexed pixel formats.
+     */
+    void set_quantization(SailQuantizationAlgorithm quantization);
+
+    /*
+     * Sets a new dithering method to use when converting to indexed pixel formats.
+     */
+    void set_dithering(SailDithering dithering);
+
+    /*
+     * Sets a new fixed palette to map pixels to when converting to indexed pixel formats.
+     * Its pixel format must be BPP24-RGB or BPP32-RGBA. Set an invalid palette to build
+     * a new palette with the quantization algorithm.
+     */
+    void set_palette(const sail::palette &palette);
+
 private:
     sail_status_t to_sail_conversion_options(sail_conversion_options **conversion_options) const;
 
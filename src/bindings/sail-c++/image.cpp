@@ -97,7 +97,7 @@ image::image(SailPixelFormat pixel_format, unsigned width, unsigned height)
     set_pixel_format(pixel_format);
     set_bytes_per_line_auto();
 
-    d->pixels_size = static_cast<std::size_t>(height) * bytes_per_line();
+    d->pixels_size = sail_bytes_per_image(d->sail_image);
 
     SAIL_TRY_OR_EXECUTE(sail_malloc(d->pixels_size, &d->sail_image->pixels),
                         /* on error */ throw std::bad_alloc());
@@ -110,7 +110,7 @@ image::image(SailPixelFormat pixel_format, unsigned width, unsigned height, unsi
     set_pixel_format(pixel_format);
     set_bytes_per_line(bytes_per_line);
 
-    d->pixels_size = static_cast<std::size_t>(height) * bytes_per_line;
+    d->pixels_size = sail_bytes_per_image(d->sail_image);
 
     SAIL_TRY_OR_EXECUTE(sail_malloc(d->pixels_size, &d->sail_image->pixels),
                         /* on error */ throw std::bad_alloc());
@@ -420,9 +420,16 @@ sail_status_t image::convert(SailPixelFormat pixel_format, const conversion_opti
     d->sail_image->bytes_per_line = sail_image_output->bytes_per_line;
     d->sail_image->pixel_format   = sail_image_output->pixel_format;
     d->sail_image->pixels         = sail_image_output->pixels;
-    d->pixels_size                = static_cast<std::size_t>(sail_image_output->height) * sail_image_output->bytes_per_line;
+    d->pixels_size                = sail_bytes_per_image(sail_image_output);
     d->shallow_pixels             = false;
 
+    /* Indexed outputs get new palettes, other outputs have no palettes. */
+    if (sail_image_output->palette != nullptr) {
+        set_palette(sail::palette(sail_image_output->palette));
+    } else {
+        set_palette(sail::palette{});
+    }
+
     sail_image_output->pixels = nullptr;
     sail_destroy_image(sail_image_output);
 
@@ -581,6 +588,49 @@ sail_status_t image::mirror(SailOrientation orientation)
     return SAIL_OK;
 }
 
+sail_status_t image::rotate(SailOrientation orientation)
+{
+    switch (orientation) {
+        case SAIL_ORIENTATION_ROTATED_90:
+        case SAIL_ORIENTATION_ROTATED_270:
+        case SAIL_ORIENTATION_MIRRORED_HORIZONTALLY_ROTATED_90:
+        case SAIL_ORIENTATION_MIRRORED_HORIZONTALLY_ROTATED_270: {
+            /* sail_rotate_image() frees the old pixels, so they must be owned. */
+            if (d->shallow_pixels && d->sail_image->pixels != nullptr) {
+                void *pixels;
+                SAIL_TRY(sail_memdup(d->sail_image->pixels, sail_bytes_per_image(d->sail_image), &pixels));
+
+                d->sail_image->pixels = pixels;
+                d->shallow_pixels = false;
+            }
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+
+    SAIL_TRY(sail_rotate_image(d->sail_image, orientation));
+
+    return SAIL_OK;
+}
+
+sail_status_t image::crop(unsigned x, unsigned y, unsigned width, unsigned height)
+{
+    /* sail_crop_image() reallocates the pixels, so they must be owned. */
+    if (d->shallow_pixels && d->sail_image->pixels != nullptr) {
+        void *pixels;
+        SAIL_TRY(sail_memdup(d->sail_image->pixels, sail_bytes_per_image(d->sail_image), &pixels));
+
+        d->sail_image->pixels = pixels;
+        d->shallow_pixels = false;
+    }
+
+    SAIL_TRY(sail_crop_image(d->sail_image, x, y, width, height));
+
+    return SAIL_OK;
+}
+
 bool image::can_convert(SailPixelFormat input_pixel_format, SailPixelFormat output_pixel_format)
 {
     return sail_can_convert(input_pixel_format, output_pixel_format);
@@ -707,7 +757,7 @@ sail_status_t image::transfer_pixels_pointer(const sail_image *sail_image)
     }
 
     d->sail_image->pixels = sail_image->pixels;
-    d->pixels_size        = static_cast<std::size_t>(sail_image->height) * sail_image->bytes_per_line;
+    d->pixels_size        = sail_bytes_per_image(sail_image);
 
     return SAIL_OK;
 }
@@ -799,7 +849,7 @@ void image::set_bytes_per_line_auto()
 
 void image::set_pixels(const void *pixels)
 {
-    set_pixels(pixels, height() * bytes_per_line());
+    set_pixels(pixels, sail_bytes_per_image(d->sail_image));
 }
 
 void image::set_pixels(const void *pixels, std::size_t pixels_size)
@@ -820,7 +870,7 @@ void image::set_pixels(const void *pixels, std::size_t pixels_size)
 
 void image::set_shallow_pixels(void *pixels)
 {
-    set_shallow_pixels(pixels, height() * bytes_per_line());
+    set_shallow_pixels(pixels, sail_bytes_per_image(d->sail_image));
 }
 
 void image::set_shallow_pixels(void *pixels, std::size_t pixels_size)
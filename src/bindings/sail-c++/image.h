@@ -592,6 +592,27 @@ public:
      */
     sail_status_t mirror(SailOrientation orientation);
 
+    /*
+     * Transforms the image according to the orientation, so an image stored with this orientation
+     * becomes upright. For example, SAIL_ORIENTATION_ROTATED_90 rotates the image 90 degrees clockwise.
+     * The image pixel size must be a multiple of 8, e.g. 8, 16, 24 etc.
+     *
+     * Rotations by 90 and 270 degrees and transpositions reallocate the pixels and swap the image
+     * width and height. Shallow pixels are deep copied in this case.
+     *
+     * Returns SAIL_OK on success.
+     */
+    sail_status_t rotate(SailOrientation orientation);
+
+    /*
+     * Crops the image in place to the specified region, so the image contains only the region pixels.
+     * The region must lie inside the image. Planar pixel formats are not supported. Shallow pixels
+     * are deep copied.
+     *
+     * Returns SAIL_OK on success.
+     */
+    sail_status_t crop(unsigned x, unsigned y, unsigned width, unsigned height);
+
     /*
      * Returns true if the conversion or updating functions can convert or update from the input
      * pixel format to the output pixel format.
@@ -23,6 +23,7 @@
     SOFTWARE.
 */
 
+#include <future>
 #include <memory>
 
 #include <sail/sail.h>
@@ -150,6 +151,13 @@ image_input& image_input::with(const sail::load_options &load_options)
     return *this;
 }
 
+image_input& image_input::with(const sail::cancellation_token &token)
+{
+    d->abstract_io_adapter->set_cancellation_token(token);
+
+    return *this;
+}
+
 sail_status_t image_input::next_frame(sail::image *image)
 {
     if (d->state == nullptr) {
@@ -180,6 +188,38 @@ image image_input::next_frame()
     return image;
 }
 
+std::future<std::tuple<image, sail_status_t>> image_input::next_frame_async(const sail::executor &executor)
+{
+    std::shared_ptr<std::promise<std::tuple<sail::image, sail_status_t>>> promise =
+        std::make_shared<std::promise<std::tuple<sail::image, sail_status_t>>>();
+    std::future<std::tuple<sail::image, sail_status_t>> future = promise->get_future();
+
+    /* The caller keeps the image input alive until the future is ready. */
+    executor([this, promise] {
+        sail::image image;
+        const sail_status_t status = next_frame(&image);
+
+        if (status != SAIL_OK) {
+            image = sail::image();
+        }
+
+        promise->set_value(std::make_tuple(std::move(image), status));
+    });
+
+    return future;
+}
+
+sail_status_t image_input::seek(unsigned frame)
+{
+    if (d->state == nullptr) {
+        SAIL_TRY(d->start());
+    }
+
+    SAIL_TRY(sail_seek_to_frame(d->state, frame));
+
+    return SAIL_OK;
+}
+
 sail_status_t image_input::finish()
 {
     sail_status_t saved_status = SAIL_OK;
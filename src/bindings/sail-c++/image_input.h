@@ -27,6 +27,7 @@
 #define SAIL_IMAGE_INPUT_CPP_H
 
 #include <cstddef> /* std::size_t */
+#include <future>
 #include <memory>
 #include <string>
 #include <tuple>
@@ -35,6 +36,7 @@
 #include <sail-common/status.h>
 
 #include <sail-c++/arbitrary_data.h>
+#include <sail-c++/async.h>
 #include <sail-c++/image.h>
 
 namespace sail
@@ -95,6 +97,12 @@ public:
      */
     image_input& with(const sail::load_options &load_options);
 
+    /*
+     * Sets the token to cancel loading with. Once the token is cancelled, loading
+     * fails with SAIL_ERROR_CANCELLED.
+     */
+    image_input& with(const sail::cancellation_token &token);
+
     /*
      * Continues loading the image. Assigns the loaded image to the 'image' argument.
      *
@@ -110,6 +118,28 @@ public:
      */
     image next_frame();
 
+    /*
+     * Continues loading the image asynchronously on the specified executor. The pixels
+     * are moved into the resulting image without copying.
+     *
+     * The task uses the image input, so the image input must stay alive until the future
+     * is ready, even if the future is destroyed earlier. Don't call other methods until then.
+     *
+     * The future holds the loaded image and SAIL_OK on success. On error, it holds an invalid image
+     * and the error status, SAIL_ERROR_NO_MORE_FRAMES when no more frames are available.
+     */
+    std::future<std::tuple<image, sail_status_t>> next_frame_async(const sail::executor &executor = default_executor());
+
+    /*
+     * Seeks to the specified frame. The next call to next_frame() returns the frame
+     * with the specified index. Frame indexes start from 0. See sail_seek_to_frame()
+     * for details.
+     *
+     * Returns SAIL_OK on success.
+     * Returns SAIL_ERROR_NO_MORE_FRAMES when no frame with the specified index is available.
+     */
+    sail_status_t seek(unsigned frame);
+
     /*
      * Finishes loading and closes the I/O stream. Call to finish() is optional.
      *
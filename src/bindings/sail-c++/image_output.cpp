@@ -23,6 +23,11 @@
     SOFTWARE.
 */
 
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <future>
 #include <memory>
 
 #include <sail/sail.h>
@@ -32,6 +37,157 @@
 namespace sail
 {
 
+/*
+ * Writes into arbitrary data and grows it as needed. The data always holds exactly
+ * the bytes written, so no copy is needed after saving.
+ */
+class SAIL_HIDDEN io_arbitrary_data : public sail::abstract_io
+{
+public:
+    explicit io_arbitrary_data(sail::arbitrary_data &other_arbitrary_data)
+        : arbitrary_data(other_arbitrary_data)
+        , pos(0)
+    {
+        arbitrary_data.clear();
+    }
+
+    int features() const override
+    {
+        return SAIL_IO_FEATURE_SEEKABLE;
+    }
+
+    sail_status_t tolerant_read(void *buf, std::size_t size_to_read, std::size_t *read_size) override
+    {
+        SAIL_CHECK_PTR(buf);
+        SAIL_CHECK_PTR(read_size);
+
+        *read_size = 0;
+
+        if (pos >= arbitrary_data.size()) {
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_EOF);
+        }
+
+        const std::size_t actual_size_to_read = std::min(size_to_read, arbitrary_data.size() - pos);
+
+        std::memcpy(buf, arbitrary_data.data() + pos, actual_size_to_read);
+        pos += actual_size_to_read;
+
+        *read_size = actual_size_to_read;
+
+        return SAIL_OK;
+    }
+
+    sail_status_t strict_read(void *buf, std::size_t size_to_read) override
+    {
+        std::size_t read_size;
+
+        SAIL_TRY(tolerant_read(buf, size_to_read, &read_size));
+
+        if (read_size != size_to_read) {
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_READ_IO);
+        }
+
+        return SAIL_OK;
+    }
+
+    sail_status_t tolerant_write(const void *buf, std::size_t size_to_write, std::size_t *written_size) override
+    {
+        SAIL_CHECK_PTR(buf);
+        SAIL_CHECK_PTR(written_size);
+
+        const std::uint8_t *data = reinterpret_cast<const std::uint8_t *>(buf);
+
+        /* Zero the gap left by seeking past the end. */
+        if (pos > arbitrary_data.size()) {
+            arbitrary_data.resize(pos);
+        }
+
+        /* Overwrite the existing bytes, and append the rest. std::vector grows geometrically. */
+        const std::size_t size_to_overwrite = std::min(size_to_write, arbitrary_data.size() - pos);
+
+        std::memcpy(arbitrary_data.data() + pos, data, size_to_overwrite);
+        arbitrary_data.insert(arbitrary_data.end(), data + size_to_overwrite, data + size_to_write);
+        pos += size_to_write;
+
+        *written_size = size_to_write;
+
+        return SAIL_OK;
+    }
+
+    sail_status_t strict_write(const void *buf, std::size_t size_to_write) override
+    {
+        std::size_t written_size;
+
+        SAIL_TRY(tolerant_write(buf, size_to_write, &written_size));
+
+        if (written_size != size_to_write) {
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_WRITE_IO);
+        }
+
+        return SAIL_OK;
+    }
+
+    sail_status_t seek(long offset, int whence) override
+    {
+        std::size_t base_pos;
+
+        switch (whence) {
+            case SEEK_SET: base_pos = 0;                     break;
+            case SEEK_CUR: base_pos = pos;                   break;
+            case SEEK_END: base_pos = arbitrary_data.size(); break;
+
+            default: {
+                SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_SEEK_WHENCE);
+            }
+        }
+
+        if (offset < 0 && static_cast<std::size_t>(-offset) > base_pos) {
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_SEEK_IO);
+        }
+
+        pos = base_pos + offset;
+
+        return SAIL_OK;
+    }
+
+    sail_status_t tell(std::size_t *offset) override
+    {
+        SAIL_CHECK_PTR(offset);
+
+        *offset = pos;
+
+        return SAIL_OK;
+    }
+
+    sail_status_t flush() override
+    {
+        return SAIL_OK;
+    }
+
+    sail_status_t close() override
+    {
+        return SAIL_OK;
+    }
+
+    sail_status_t eof(bool *result) override
+    {
+        SAIL_CHECK_PTR(result);
+
+        *result = pos >= arbitrary_data.size();
+
+        return SAIL_OK;
+    }
+
+    sail::codec_info codec_info() override
+    {
+        return sail::codec_info();
+    }
+
+private:
+    sail::arbitrary_data &arbitrary_data;
+    std::size_t pos;
+};
+
 class SAIL_HIDDEN image_output::pimpl
 {
 public:
@@ -100,7 +256,7 @@ image_output::image_output(void *buffer, std::size_t buffer_size, const sail::co
 }
 
 image_output::image_output(sail::arbitrary_data *arbitrary_data, const sail::codec_info &codec_info)
-    : image_output(arbitrary_data->data(), arbitrary_data->size(), codec_info)
+    : d(new pimpl(new io_arbitrary_data(*arbitrary_data), codec_info))
 {
 }
 
@@ -144,6 +300,13 @@ image_output& image_output::with(const sail::save_options &save_options)
     return *this;
 }
 
+image_output& image_output::with(const sail::cancellation_token &token)
+{
+    d->abstract_io_adapter->set_cancellation_token(token);
+
+    return *this;
+}
+
 sail_status_t image_output::next_frame(const sail::image &image)
 {
     if (d->state == nullptr) {
@@ -163,6 +326,22 @@ sail_status_t image_output::next_frame(const sail::image &image)
     return SAIL_OK;
 }
 
+std::future<sail_status_t> image_output::next_frame_async(sail::image image, const sail::executor &executor)
+{
+    std::shared_ptr<std::promise<sail_status_t>> promise = std::make_shared<std::promise<sail_status_t>>();
+    std::future<sail_status_t> future = promise->get_future();
+
+    /* C++11 lambdas cannot capture by move, so share the image with the task to avoid copying pixels. */
+    std::shared_ptr<sail::image> shared_image = std::make_shared<sail::image>(std::move(image));
+
+    /* The caller keeps the image output alive until the future is ready. */
+    executor([this, shared_image, promise] {
+        promise->set_value(next_frame(*shared_image));
+    });
+
+    return future;
+}
+
 sail_status_t image_output::finish()
 {
     sail_status_t saved_status = SAIL_OK;
@@ -27,6 +27,7 @@
 #define SAIL_IMAGE_OUTPUT_CPP_H
 
 #include <cstddef> /* std::size_t */
+#include <future>
 #include <memory>
 #include <string>
 
@@ -34,6 +35,7 @@
 #include <sail-common/status.h>
 
 #include <sail-c++/arbitrary_data.h>
+#include <sail-c++/async.h>
 
 namespace sail
 {
@@ -61,7 +63,9 @@ public:
     image_output(void *buffer, std::size_t buffer_size, const sail::codec_info &codec_info);
 
     /*
-     * Constructs a new image output to the specified memory buffer.
+     * Constructs a new image output to the specified arbitrary data. The data is cleared
+     * and grows while saving, so there is no need to guess the size of the output beforehand.
+     * When saving is finished, the data holds exactly the encoded image.
      */
     image_output(sail::arbitrary_data *arbitrary_data, const sail::codec_info &codec_info);
 
@@ -95,6 +99,12 @@ public:
      */
     image_output& with(const sail::save_options &save_options);
 
+    /*
+     * Sets the token to cancel saving with. Once the token is cancelled, saving
+     * fails with SAIL_ERROR_CANCELLED.
+     */
+    image_output& with(const sail::cancellation_token &token);
+
     /*
      * Continues saving into the I/O target.
      *
@@ -105,6 +115,17 @@ public:
      */
     sail_status_t next_frame(const sail::image &image);
 
+    /*
+     * Continues saving into the I/O target asynchronously on the specified executor.
+     * Move the image into the function to avoid copying its pixels.
+     *
+     * The task uses the image output, so the image output must stay alive until the future
+     * is ready, even if the future is destroyed earlier. Don't call other methods until then.
+     *
+     * The future holds SAIL_OK on success.
+     */
+    std::future<sail_status_t> next_frame_async(sail::image image, const sail::executor &executor = default_executor());
+
     /*
      * Finishes saving and closes the I/O stream. Call to finish() is recommended
      * if you want to ensure the I/O stream is flushed and closed successfully.
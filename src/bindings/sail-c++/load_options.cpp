@@ -72,6 +72,7 @@ load_options& load_options::operator=(const sail::load_options &load_options)
 {
     set_options(load_options.options());
     set_tuning(load_options.tuning());
+    set_region(load_options.region());
 
     return *this;
 }
@@ -107,6 +108,11 @@ const sail::tuning& load_options::tuning() const
     return d->tuning;
 }
 
+const sail_region& load_options::region() const
+{
+    return d->sail_load_options->region;
+}
+
 void load_options::set_options(int options)
 {
     d->sail_load_options->options = options;
@@ -117,6 +123,11 @@ void load_options::set_tuning(const sail::tuning &tuning)
     d->tuning = tuning;
 }
 
+void load_options::set_region(const sail_region &region)
+{
+    d->sail_load_options->region = region;
+}
+
 load_options::load_options(const sail_load_options *ro)
     : load_options()
 {
@@ -127,6 +138,7 @@ load_options::load_options(const sail_load_options *ro)
 
     set_options(ro->options);
     set_tuning(utils_private::c_tuning_to_cpp_tuning(ro->tuning));
+    set_region(ro->region);
 }
 
 sail_status_t load_options::to_sail_load_options(sail_load_options **load_options) const
@@ -138,6 +150,7 @@ sail_status_t load_options::to_sail_load_options(sail_load_options **load_option
     SAIL_TRY(sail_alloc_load_options(&load_options_local));
 
     load_options_local->options = d->sail_load_options->options;
+    load_options_local->region  = d->sail_load_options->region;
 
     SAIL_TRY_OR_CLEANUP(sail_alloc_hash_map(&load_options_local->tuning),
                         /* cleanup */ sail_destroy_load_options(load_options_local));
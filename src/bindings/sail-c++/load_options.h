@@ -30,6 +30,7 @@
 #include <vector>
 
 #include <sail-common/export.h>
+#include <sail-common/load_options.h>
 #include <sail-common/status.h>
 
 #include <sail-c++/tuning.h>
@@ -116,6 +117,12 @@ public:
      */
     const sail::tuning& tuning() const;
 
+    /*
+     * Returns the region of interest to load. Zero width or height loads whole frames.
+     * See sail_load_options.region.
+     */
+    const sail_region& region() const;
+
     /*
      * Sets new or-ed manipulation options for loading operations. See SailOption.
      */
@@ -126,6 +133,12 @@ public:
      */
     void set_tuning(const sail::tuning &tuning);
 
+    /*
+     * Sets new region of interest to load. The region is specified in the coordinates of the stored
+     * pixels and gets clipped to the frame dimensions. Zero width or height loads whole frames.
+     */
+    void set_region(const sail_region &region);
+
 private:
     /*
      * Makes a deep copy of the specified load options and stores the pointer for further use.
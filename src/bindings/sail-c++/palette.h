@@ -44,6 +44,7 @@ namespace sail
  */
 class SAIL_EXPORT palette
 {
+    friend class conversion_options;
     friend class image;
 
 public:
@@ -43,6 +43,7 @@
 
 #include <sail-c++/abstract_io.h>
 #include <sail-c++/arbitrary_data.h>
+#include <sail-c++/async.h>
 #include <sail-c++/at_scope_exit.h>
 #include <sail-c++/codec_info.h>
 #include <sail-c++/compression_level.h>
@@ -46,6 +46,9 @@ struct avif_state {
     struct avifDecoder *avif_decoder;
     struct avifRGBImage rgb_image;
     struct sail_avif_context avif_context;
+
+    /* Output premultiplied pixels. libavif premultiplies them while converting from YUV. */
+    bool premultiplied_alpha;
 };
 
 static sail_status_t alloc_avif_state(struct sail_io *io,
@@ -88,7 +91,8 @@ static sail_status_t alloc_avif_state(struct sail_io *io,
             .io          = io,
             .buffer      = buffer,
             .buffer_size = buffer_size,
-        }
+        },
+        .premultiplied_alpha = false,
     };
 
 #if AVIF_VERSION_MAJOR > 0 || AVIF_VERSION_MINOR >= 9
@@ -132,6 +136,11 @@ SAIL_EXPORT sail_status_t sail_codec_load_init_v8_avif(struct sail_io *io, const
 
     avif_state->avif_decoder->ignoreExif = avif_state->avif_decoder->ignoreXMP = (avif_state->load_options->options & SAIL_OPTION_META_DATA) == 0;
 
+    /* Handle tuning. */
+    if (avif_state->load_options->tuning != NULL) {
+        sail_traverse_hash_map_with_user_data(avif_state->load_options->tuning, avif_private_tuning_key_value_callback, &avif_state->premultiplied_alpha);
+    }
+
     /* Initialize AVIF. */
     avifResult avif_result = avifDecoderParse(avif_state->avif_decoder);
 
@@ -165,6 +174,13 @@ SAIL_EXPORT sail_status_t sail_codec_load_seek_next_frame_v8_avif(void *state, s
     avifRGBImageSetDefaults(&avif_state->rgb_image, avif_image);
     avif_state->rgb_image.depth = avif_private_round_depth(avif_state->rgb_image.depth);
 
+    /* Opaque images are the same either way. */
+    bool premultiplied_alpha = false;
+#if AVIF_VERSION_MAJOR > 0 || AVIF_VERSION_MINOR >= 9
+    premultiplied_alpha = avif_state->premultiplied_alpha && avif_image->alphaPlane != NULL;
+    avif_state->rgb_image.alphaPremultiplied = premultiplied_alpha ? AVIF_TRUE : AVIF_FALSE;
+#endif
+
     if (avif_state->load_options->options & SAIL_OPTION_SOURCE_IMAGE) {
         SAIL_TRY_OR_CLEANUP(sail_alloc_source_image(&image_local->source_image),
                             /* cleanup */ sail_destroy_image(image_local));
@@ -177,7 +193,7 @@ SAIL_EXPORT sail_status_t sail_codec_load_seek_next_frame_v8_avif(void *state, s
 
     image_local->width          = avif_image->width;
     image_local->height         = avif_image->height;
-    image_local->pixel_format   = avif_private_rgb_sail_pixel_format(avif_state->rgb_image.format, avif_state->rgb_image.depth);
+    image_local->pixel_format   = avif_private_rgb_sail_pixel_format(avif_state->rgb_image.format, avif_state->rgb_image.depth, premultiplied_alpha);
     image_local->bytes_per_line = sail_bytes_per_line(image_local->width, image_local->pixel_format);
     image_local->delay          = (int)(avif_state->avif_decoder->imageTiming.duration * 1000);
 
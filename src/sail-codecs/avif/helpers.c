@@ -23,6 +23,8 @@
     SOFTWARE.
 */
 
+#include <string.h>
+
 #include <sail-common/sail-common.h>
 
 #include "helpers.h"
@@ -67,17 +69,17 @@ enum SailChromaSubsampling avif_private_sail_chroma_subsampling(enum avifPixelFo
     }
 }
 
-enum SailPixelFormat avif_private_rgb_sail_pixel_format(enum avifRGBFormat rgb_pixel_format, uint32_t depth) {
+enum SailPixelFormat avif_private_rgb_sail_pixel_format(enum avifRGBFormat rgb_pixel_format, uint32_t depth, bool premultiplied_alpha) {
 
     switch (depth) {
         case 8: {
             switch (rgb_pixel_format) {
                 case AVIF_RGB_FORMAT_RGB:  return SAIL_PIXEL_FORMAT_BPP24_RGB;
-                case AVIF_RGB_FORMAT_RGBA: return SAIL_PIXEL_FORMAT_BPP32_RGBA;
-                case AVIF_RGB_FORMAT_ARGB: return SAIL_PIXEL_FORMAT_BPP32_ARGB;
+                case AVIF_RGB_FORMAT_RGBA: return premultiplied_alpha ? SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED : SAIL_PIXEL_FORMAT_BPP32_RGBA;
+                case AVIF_RGB_FORMAT_ARGB: return premultiplied_alpha ? SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED : SAIL_PIXEL_FORMAT_BPP32_ARGB;
                 case AVIF_RGB_FORMAT_BGR:  return SAIL_PIXEL_FORMAT_BPP24_BGR;
-                case AVIF_RGB_FORMAT_BGRA: return SAIL_PIXEL_FORMAT_BPP32_BGRA;
-                case AVIF_RGB_FORMAT_ABGR: return SAIL_PIXEL_FORMAT_BPP32_ABGR;
+                case AVIF_RGB_FORMAT_BGRA: return premultiplied_alpha ? SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED : SAIL_PIXEL_FORMAT_BPP32_BGRA;
+                case AVIF_RGB_FORMAT_ABGR: return premultiplied_alpha ? SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED : SAIL_PIXEL_FORMAT_BPP32_ABGR;
 
                 default: return SAIL_PIXEL_FORMAT_UNKNOWN;
             }
@@ -85,11 +87,11 @@ enum SailPixelFormat avif_private_rgb_sail_pixel_format(enum avifRGBFormat rgb_p
         case 16: {
             switch (rgb_pixel_format) {
                 case AVIF_RGB_FORMAT_RGB:  return SAIL_PIXEL_FORMAT_BPP48_RGB;
-                case AVIF_RGB_FORMAT_RGBA: return SAIL_PIXEL_FORMAT_BPP64_RGBA;
-                case AVIF_RGB_FORMAT_ARGB: return SAIL_PIXEL_FORMAT_BPP64_ARGB;
+                case AVIF_RGB_FORMAT_RGBA: return premultiplied_alpha ? SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED : SAIL_PIXEL_FORMAT_BPP64_RGBA;
+                case AVIF_RGB_FORMAT_ARGB: return premultiplied_alpha ? SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED : SAIL_PIXEL_FORMAT_BPP64_ARGB;
                 case AVIF_RGB_FORMAT_BGR:  return SAIL_PIXEL_FORMAT_BPP48_BGR;
-                case AVIF_RGB_FORMAT_BGRA: return SAIL_PIXEL_FORMAT_BPP64_BGRA;
-                case AVIF_RGB_FORMAT_ABGR: return SAIL_PIXEL_FORMAT_BPP64_ABGR;
+                case AVIF_RGB_FORMAT_BGRA: return premultiplied_alpha ? SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED : SAIL_PIXEL_FORMAT_BPP64_BGRA;
+                case AVIF_RGB_FORMAT_ABGR: return premultiplied_alpha ? SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED : SAIL_PIXEL_FORMAT_BPP64_ABGR;
 
                 default: return SAIL_PIXEL_FORMAT_UNKNOWN;
             }
@@ -141,3 +143,17 @@ sail_status_t avif_private_fetch_meta_data(enum SailMetaData key, const struct a
 
     return SAIL_OK;
 }
+
+bool avif_private_tuning_key_value_callback(const char *key, const struct sail_variant *value, void *user_data) {
+
+    bool *premultiplied_alpha = user_data;
+
+    if (strcmp(key, "avif-premultiplied-alpha") == 0) {
+        if (value->type == SAIL_VARIANT_TYPE_BOOL) {
+            *premultiplied_alpha = sail_variant_to_bool(value);
+            SAIL_LOG_TRACE("AVIF: Premultiplied alpha: %s", *premultiplied_alpha ? "yes" : "no");
+        }
+    }
+
+    return true;
+}
@@ -41,7 +41,7 @@ SAIL_HIDDEN enum SailPixelFormat avif_private_sail_pixel_format(enum avifPixelFo
 
 SAIL_HIDDEN enum SailChromaSubsampling avif_private_sail_chroma_subsampling(enum avifPixelFormat avif_pixel_format);
 
-SAIL_HIDDEN enum SailPixelFormat avif_private_rgb_sail_pixel_format(enum avifRGBFormat rgb_pixel_format, uint32_t depth);
+SAIL_HIDDEN enum SailPixelFormat avif_private_rgb_sail_pixel_format(enum avifRGBFormat rgb_pixel_format, uint32_t depth, bool premultiplied_alpha);
 
 SAIL_HIDDEN uint32_t avif_private_round_depth(uint32_t depth);
 
@@ -49,4 +49,6 @@ SAIL_HIDDEN sail_status_t avif_private_fetch_iccp(const struct avifRWData *avif_
 
 SAIL_HIDDEN sail_status_t avif_private_fetch_meta_data(enum SailMetaData key, const struct avifRWData *avif_rw_data, struct sail_meta_data_node **meta_data_node);
 
+SAIL_HIDDEN bool avif_private_tuning_key_value_callback(const char *key, const struct sail_variant *value, void *user_data);
+
 #endif
@@ -35,10 +35,44 @@
 
 #include "helpers.h"
 #include "io.h"
+#include "lzw.h"
+#include "quantize.h"
+
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
 
 static const int InterlacedOffset[] = { 0, 4, 2, 1 };
 static const int InterlacedJumps[]  = { 8, 8, 4, 2 };
 
+/*
+ * Frame index entry. The index is populated lazily as frames are read.
+ */
+struct gif_frame_index_entry {
+    /* I/O offset of the first record of the frame. */
+    size_t offset;
+    /* The composited frame doesn't depend on the preceding frames. */
+    bool key_frame;
+};
+
+/*
+ * A frame to save. Frames are written one frame late, as the disposal method of a frame
+ * depends on the next frame.
+ */
+struct gif_frame {
+    bool valid;
+    /* Indexes of the whole frame with all the transparent colors mapped onto the transparency index. */
+    GifPixelType *indexes;
+    ColorMapObject *map;
+    /* Number of palette colors in the color map. The rest of the entries are unused. */
+    unsigned color_count;
+    uint32_t rgba_palette[256];
+    int transparency_index;
+    /* Delay in 1/100 of seconds. */
+    unsigned delay;
+    struct sail_meta_data_node *meta_data_node;
+};
+
 /*
  * Codec-specific state.
  */
@@ -51,7 +85,6 @@ struct gif_state {
     const ColorMapObject *map;
     unsigned char *buf;
     int transparency_index;
-    int first_frame_height;
     int disposal;
     int prev_disposal;
     int current_image;
@@ -63,8 +96,36 @@ struct gif_state {
     unsigned prev_column;
     unsigned prev_width;
     unsigned prev_height;
-    unsigned char **first_frame;
+
+    /* Return frames as is, without compositing them onto the canvas. */
+    bool raw_frames;
+
+    /* RGBA canvas of the logical screen size. Not allocated in the raw frames mode. */
+    unsigned char *canvas;
+    uint32_t rgba_palette[256];
     unsigned char background[4]; /* RGBA */
+
+    /* Frames seen so far. Used to seek to arbitrary frames. */
+    struct gif_frame_index_entry *frame_index;
+    unsigned frame_index_size;
+    unsigned frame_index_capacity;
+    /* -1 until the terminator record is reached. */
+    int frame_count;
+    /* The next frame header read by a seek. Returned by the next sail_codec_load_seek_next_frame_v8_gif(). */
+    struct sail_image *peeked_image;
+
+    /* Encoding. */
+    struct gif_private_save_tuning save_tuning;
+    int threads;
+    bool gif_error;
+    unsigned frames_written;
+    ColorMapObject *global_map;
+    /* The frame waiting for the next one and the frame being saved now. */
+    struct gif_frame frames[2];
+    unsigned pending_frame;
+    /* Pixels a viewer displays before drawing the next frame. */
+    uint32_t *saved_canvas;
+    GifPixelType *rectangle;
 };
 
 static sail_status_t alloc_gif_state(struct sail_io *io,
@@ -96,9 +157,40 @@ static sail_status_t alloc_gif_state(struct sail_io *io,
         .prev_column        = 0,
         .prev_width         = 0,
         .prev_height        = 0,
-        .first_frame        = NULL,
+        .raw_frames         = false,
+        .canvas             = NULL,
+
+        .frame_index          = NULL,
+        .frame_index_size     = 0,
+        .frame_index_capacity = 0,
+        .frame_count          = -1,
+        .peeked_image         = NULL,
+
+        .save_tuning = {
+            .delta_frames = true,
+            .threads      = 0,
+        },
+        .threads        = 1,
+        .gif_error      = false,
+        .frames_written = 0,
+        .global_map     = NULL,
+        .pending_frame  = 0,
+        .saved_canvas   = NULL,
+        .rectangle      = NULL,
     };
 
+    for (unsigned i = 0; i < 2; i++) {
+        (*gif_state)->frames[i] = (struct gif_frame) {
+            .valid              = false,
+            .indexes            = NULL,
+            .map                = NULL,
+            .color_count        = 0,
+            .transparency_index = -1,
+            .delay              = 0,
+            .meta_data_node     = NULL,
+        };
+    }
+
     return SAIL_OK;
 }
 
@@ -109,16 +201,437 @@ static void destroy_gif_state(struct gif_state *gif_state) {
     }
 
     sail_free(gif_state->buf);
+    sail_free(gif_state->canvas);
+    sail_free(gif_state->frame_index);
+    sail_destroy_image(gif_state->peeked_image);
+
+    for (unsigned i = 0; i < 2; i++) {
+        sail_free(gif_state->frames[i].indexes);
+        GifFreeMapObject(gif_state->frames[i].map);
+        sail_destroy_meta_data_node_chain(gif_state->frames[i].meta_data_node);
+    }
+
+    GifFreeMapObject(gif_state->global_map);
+    sail_free(gif_state->saved_canvas);
+    sail_free(gif_state->rectangle);
 
-    if (gif_state->first_frame != NULL) {
-        for(int i = 0; i < gif_state->first_frame_height; i++) {
-            sail_free(gif_state->first_frame[i]);
+    sail_free(gif_state);
+}
+
+static uint32_t* canvas_pixel(const struct gif_state *gif_state, unsigned row, unsigned column) {
+
+    return (uint32_t *)(gif_state->canvas + ((size_t)row * gif_state->gif->SWidth + column) * 4); /* 4 = RGBA */
+}
+
+static sail_status_t append_to_frame_index(struct gif_state *gif_state, size_t offset) {
+
+    const bool full_frame = gif_state->width == (unsigned)gif_state->gif->SWidth && gif_state->height == (unsigned)gif_state->gif->SHeight;
+
+    bool key_frame;
+
+    if (gif_state->current_image == 0) {
+        key_frame = true;
+    } else if (full_frame && gif_state->transparency_index < 0) {
+        /* Overwrites the whole canvas. */
+        key_frame = true;
+    } else if (gif_state->prev_disposal == DISPOSE_BACKGROUND) {
+        /* The previous frame leaves a clean canvas behind. Key frames are composited onto a clean canvas. */
+        const bool prev_full_frame = gif_state->prev_width == (unsigned)gif_state->gif->SWidth &&
+                                        gif_state->prev_height == (unsigned)gif_state->gif->SHeight;
+        key_frame = prev_full_frame || gif_state->frame_index[gif_state->current_image - 1].key_frame;
+    } else {
+        key_frame = false;
+    }
+
+    if (gif_state->frame_index_size == gif_state->frame_index_capacity) {
+        const unsigned new_capacity = (gif_state->frame_index_capacity == 0) ? 16 : gif_state->frame_index_capacity * 2;
+
+        void *ptr = gif_state->frame_index;
+        SAIL_TRY(sail_realloc(sizeof(struct gif_frame_index_entry) * new_capacity, &ptr));
+        gif_state->frame_index          = ptr;
+        gif_state->frame_index_capacity = new_capacity;
+    }
+
+    gif_state->frame_index[gif_state->frame_index_size++] = (struct gif_frame_index_entry) {
+        .offset    = offset,
+        .key_frame = key_frame,
+    };
+
+    return SAIL_OK;
+}
+
+/*
+ * Reads the current frame pixels. In the raw frames mode, the frame is expanded into the image
+ * or skipped without decoding when the image is NULL. Otherwise, the frame is composited onto
+ * the canvas which is copied into the image when the image is not NULL.
+ */
+static sail_status_t read_frame(struct gif_state *gif_state, struct sail_image *image) {
+
+    if (gif_state->raw_frames && image == NULL) {
+        int code_size;
+        GifByteType *code_block;
+
+        if (DGifGetCode(gif_state->gif, &code_size, &code_block) == GIF_ERROR) {
+            SAIL_LOG_ERROR("GIF: %s", GifErrorString(gif_state->gif->Error));
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
         }
 
-        sail_free(gif_state->first_frame);
+        while (code_block != NULL) {
+            if (DGifGetCodeNext(gif_state->gif, &code_block) == GIF_ERROR) {
+                SAIL_LOG_ERROR("GIF: %s", GifErrorString(gif_state->gif->Error));
+                SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+            }
+        }
+
+        return SAIL_OK;
     }
 
-    sail_free(gif_state);
+    /* Apply the disposal method of the previous frame. Only its rectangle is touched. */
+    if (!gif_state->raw_frames && gif_state->current_image > 0 && gif_state->prev_disposal == DISPOSE_BACKGROUND) {
+        /*
+         * Spec:
+         *     2 - Restore to background color. The area used by the
+         *         graphic must be restored to the background color.
+         *
+         * The meaning of the background color is not quite clear here. My idea was that
+         * it's the color specified by the background color index in the global color map.
+         * However, other decoders like XnView treat "background" as a transparent color here.
+         * Let's do the same.
+         */
+        for (unsigned row = gif_state->prev_row; row < gif_state->prev_row + gif_state->prev_height; row++) {
+            memset(canvas_pixel(gif_state, row, gif_state->prev_column), 0, (size_t)gif_state->prev_width * 4); /* 4 = RGBA */
+        }
+    }
+
+    /* Read lines. In interlaced mode, every pass starts at its own offset and skips some lines. */
+    const int passes = gif_state->gif->Image.Interlace ? 4 : 1;
+
+    for (int current_pass = 0; current_pass < passes; current_pass++) {
+        const unsigned first_row = gif_state->gif->Image.Interlace ? InterlacedOffset[current_pass] : 0;
+        const unsigned row_step  = gif_state->gif->Image.Interlace ? InterlacedJumps[current_pass]  : 1;
+
+        for (unsigned row = first_row; row < gif_state->height; row += row_step) {
+            if (DGifGetLine(gif_state->gif, gif_state->buf, gif_state->width) == GIF_ERROR) {
+                SAIL_LOG_ERROR("GIF: %s", GifErrorString(gif_state->gif->Error));
+                SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+            }
+
+            if (gif_state->raw_frames) {
+                gif_private_expand_row(sail_scan_line(image, row), gif_state->rgba_palette, gif_state->buf, gif_state->width);
+            } else {
+                gif_private_blend_row(canvas_pixel(gif_state, gif_state->row + row, gif_state->column),
+                                        gif_state->rgba_palette, gif_state->buf, gif_state->width);
+            }
+        }
+    }
+
+    /* Copy the composited canvas into the frame. */
+    if (!gif_state->raw_frames && image != NULL) {
+        const size_t canvas_bytes_per_line = (size_t)image->width * 4; /* 4 = RGBA */
+
+        if (image->bytes_per_line == canvas_bytes_per_line) {
+            memcpy(image->pixels, gif_state->canvas, canvas_bytes_per_line * image->height);
+        } else {
+            for (unsigned row = 0; row < image->height; row++) {
+                memcpy(sail_scan_line(image, row), canvas_pixel(gif_state, row, 0), canvas_bytes_per_line);
+            }
+        }
+    }
+
+    return SAIL_OK;
+}
+
+/*
+ * Restarts reading at the specified indexed frame. GIFLIB doesn't buffer data between records,
+ * so reading can continue from any record boundary. Reopen GIFLIB anyway to discard
+ * the images it has accumulated so far.
+ */
+static sail_status_t restart_at_frame(struct gif_state *gif_state, unsigned frame) {
+
+    DGifCloseFile(gif_state->gif, /* ErrorCode */ NULL);
+    gif_state->gif = NULL;
+
+    SAIL_TRY(gif_state->io->seek(gif_state->io->stream, 0, SEEK_SET));
+
+    int error_code;
+    gif_state->gif = DGifOpen(gif_state->io, my_read_proc, &error_code);
+
+    if (gif_state->gif == NULL) {
+        SAIL_LOG_ERROR("GIF: Failed to initialize. GIFLIB error code: %d", error_code);
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+    }
+
+    SAIL_TRY(gif_state->io->seek(gif_state->io->stream, (long)gif_state->frame_index[frame].offset, SEEK_SET));
+
+    gif_state->current_image = (int)frame - 1;
+    gif_state->disposal      = DISPOSAL_UNSPECIFIED;
+    gif_state->row           = 0;
+    gif_state->column        = 0;
+    gif_state->width         = 0;
+    gif_state->height        = 0;
+
+    /* Key frames are composited onto a clean canvas. */
+    if (!gif_state->raw_frames) {
+        memset(gif_state->canvas, 0, (size_t)gif_state->gif->SWidth * gif_state->gif->SHeight * 4); /* 4 = RGBA */
+    }
+
+    return SAIL_OK;
+}
+
+/*
+ * Encoding helpers.
+ */
+
+struct rectangle {
+    unsigned left;
+    unsigned top;
+    unsigned right;
+    unsigned bottom;
+};
+
+static void extend_rectangle(struct rectangle *rectangle, unsigned row, unsigned column) {
+
+    rectangle->left   = SAIL_MIN(rectangle->left, column);
+    rectangle->top    = SAIL_MIN(rectangle->top, row);
+    rectangle->right  = SAIL_MAX(rectangle->right, column + 1);
+    rectangle->bottom = SAIL_MAX(rectangle->bottom, row + 1);
+}
+
+static bool is_rectangle_empty(const struct rectangle *rectangle) {
+
+    return rectangle->left >= rectangle->right || rectangle->top >= rectangle->bottom;
+}
+
+static bool color_maps_equal(const ColorMapObject *map1, const ColorMapObject *map2) {
+
+    return map1->ColorCount == map2->ColorCount &&
+            memcmp(map1->Colors, map2->Colors, sizeof(GifColorType) * map1->ColorCount) == 0;
+}
+
+static sail_status_t write_loop_extension(GifFileType *gif) {
+
+    static const GifByteType loop[3] = { 1, 0, 0 }; /* Loop forever. */
+
+    if (EGifPutExtensionLeader(gif, APPLICATION_EXT_FUNC_CODE) == GIF_ERROR ||
+            EGifPutExtensionBlock(gif, 11, "NETSCAPE2.0") == GIF_ERROR ||
+            EGifPutExtensionBlock(gif, sizeof(loop), loop) == GIF_ERROR ||
+            EGifPutExtensionTrailer(gif) == GIF_ERROR) {
+        SAIL_LOG_ERROR("GIF: %s", GifErrorString(gif->Error));
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+    }
+
+    return SAIL_OK;
+}
+
+static sail_status_t write_comments(GifFileType *gif, const struct sail_meta_data_node *meta_data_node) {
+
+    for (; meta_data_node != NULL; meta_data_node = meta_data_node->next) {
+        const struct sail_meta_data *meta_data = meta_data_node->meta_data;
+
+        if (meta_data->key != SAIL_META_DATA_COMMENT) {
+            SAIL_LOG_WARNING("GIF: Ignoring unsupported meta data key '%s'", sail_meta_data_to_string(meta_data->key));
+            continue;
+        }
+
+        if (meta_data->value->type != SAIL_VARIANT_TYPE_STRING) {
+            SAIL_LOG_ERROR("GIF: Comment must have STRING type");
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_INVALID_ARGUMENT);
+        }
+
+        if (EGifPutComment(gif, sail_variant_to_string(meta_data->value)) == GIF_ERROR) {
+            SAIL_LOG_ERROR("GIF: %s", GifErrorString(gif->Error));
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+        }
+    }
+
+    return SAIL_OK;
+}
+
+/* Returns true if some pixels in the rectangle match the saved canvas. */
+static bool has_unchanged_pixels(const struct gif_state *gif_state, const struct gif_frame *frame, const struct rectangle *rectangle) {
+
+    const unsigned width = (unsigned)gif_state->gif->SWidth;
+
+    for (unsigned row = rectangle->top; row < rectangle->bottom; row++) {
+        const GifPixelType *indexes = frame->indexes + (size_t)row * width;
+        const uint32_t *canvas = gif_state->saved_canvas + (size_t)row * width;
+
+        for (unsigned column = rectangle->left; column < rectangle->right; column++) {
+            if (frame->rgba_palette[indexes[column]] == canvas[column]) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Writes the frame. The saved canvas holds what a viewer displays before drawing the frame.
+ * Only the rectangle which differs from the canvas is written, and its pixels which match
+ * the canvas become transparent to compress better. When the next frame has transparent pixels
+ * over opaque pixels of this frame, the frame is disposed to the background, so its rectangle
+ * is extended to cover them.
+ */
+static sail_status_t write_frame(struct gif_state *gif_state, struct gif_frame *frame, const struct gif_frame *next_frame) {
+
+    GifFileType *gif = gif_state->gif;
+    const unsigned width  = (unsigned)gif->SWidth;
+    const unsigned height = (unsigned)gif->SHeight;
+    const bool first = gif_state->frames_written == 0;
+    const bool animated = !first || next_frame != NULL;
+    const bool delta = gif_state->save_tuning.delta_frames && !first;
+
+    if (first) {
+        if (EGifPutScreenDesc(gif, (int)width, (int)height, frame->map->BitsPerPixel, 0, frame->map) == GIF_ERROR) {
+            SAIL_LOG_ERROR("GIF: %s", GifErrorString(gif->Error));
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+        }
+
+        gif_state->global_map = GifMakeMapObject(frame->map->ColorCount, frame->map->Colors);
+
+        if (gif_state->global_map == NULL) {
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_MEMORY_ALLOCATION);
+        }
+
+        if (animated) {
+            SAIL_TRY(write_loop_extension(gif));
+        }
+    }
+
+    /* Changed pixels. */
+    struct rectangle rectangle = { width, height, 0, 0 };
+
+    if (delta) {
+        for (unsigned row = 0; row < height; row++) {
+            const GifPixelType *indexes = frame->indexes + (size_t)row * width;
+            const uint32_t *canvas = gif_state->saved_canvas + (size_t)row * width;
+
+            for (unsigned column = 0; column < width; column++) {
+                if (frame->rgba_palette[indexes[column]] != canvas[column]) {
+                    extend_rectangle(&rectangle, row, column);
+                }
+            }
+        }
+    } else {
+        rectangle = (struct rectangle) { 0, 0, width, height };
+    }
+
+    /* Opaque pixels to be cleared for the next frame. */
+    struct rectangle clear_rectangle = { width, height, 0, 0 };
+
+    if (next_frame != NULL) {
+        for (unsigned row = 0; row < height; row++) {
+            const GifPixelType *indexes = frame->indexes + (size_t)row * width;
+            const GifPixelType *next_indexes = next_frame->indexes + (size_t)row * width;
+
+            for (unsigned column = 0; column < width; column++) {
+                if (next_frame->rgba_palette[next_indexes[column]] == 0 && frame->rgba_palette[indexes[column]] != 0) {
+                    extend_rectangle(&clear_rectangle, row, column);
+                }
+            }
+        }
+    }
+
+    int disposal;
+
+    if (!is_rectangle_empty(&clear_rectangle)) {
+        disposal = DISPOSE_BACKGROUND;
+        extend_rectangle(&rectangle, clear_rectangle.top, clear_rectangle.left);
+        extend_rectangle(&rectangle, clear_rectangle.bottom - 1, clear_rectangle.right - 1);
+    } else {
+        disposal = animated ? DISPOSE_DO_NOT : DISPOSAL_UNSPECIFIED;
+    }
+
+    /* Nothing changed. GIF frames cannot be empty. */
+    if (is_rectangle_empty(&rectangle)) {
+        rectangle = (struct rectangle) { 0, 0, 1, 1 };
+    }
+
+    const unsigned rectangle_width  = rectangle.right - rectangle.left;
+    const unsigned rectangle_height = rectangle.bottom - rectangle.top;
+
+    /* Reserve the transparency index only when some pixels in the rectangle are unchanged. */
+    if (delta && frame->transparency_index < 0 && has_unchanged_pixels(gif_state, frame, &rectangle)) {
+        SAIL_TRY(gif_private_reserve_transparency(&frame->map, frame->color_count, &frame->transparency_index));
+        gif_private_build_rgba_palette(frame->map, frame->transparency_index, frame->rgba_palette);
+    }
+
+    /* Full palettes have no room for the transparency index. Such frames are only cropped. */
+    const bool delta_transparency = delta && frame->transparency_index >= 0;
+    const bool interlaced = gif_state->save_options->options & SAIL_OPTION_INTERLACED;
+
+    /* Gather the rectangle rows in the order they're stored. */
+    bool transparency_used = false;
+    GifPixelType *output = gif_state->rectangle;
+
+    const int passes = interlaced ? 4 : 1;
+
+    for (int current_pass = 0; current_pass < passes; current_pass++) {
+        const unsigned first_row = interlaced ? InterlacedOffset[current_pass] : 0;
+        const unsigned row_step  = interlaced ? InterlacedJumps[current_pass]  : 1;
+
+        for (unsigned row = rectangle.top + first_row; row < rectangle.bottom; row += row_step) {
+            const GifPixelType *indexes = frame->indexes + (size_t)row * width + rectangle.left;
+            const uint32_t *canvas = gif_state->saved_canvas + (size_t)row * width + rectangle.left;
+
+            for (unsigned column = 0; column < rectangle_width; column++) {
+                GifPixelType index = indexes[column];
+
+                if (delta_transparency && frame->rgba_palette[index] == canvas[column]) {
+                    index = (GifPixelType)frame->transparency_index;
+                }
+
+                transparency_used |= (int)index == frame->transparency_index;
+                *output++ = index;
+            }
+        }
+    }
+
+    SAIL_TRY(write_comments(gif, frame->meta_data_node));
+
+    if (animated || transparency_used) {
+        const GraphicsControlBlock gcb = {
+            .DisposalMode     = disposal,
+            .UserInputFlag    = false,
+            .DelayTime        = (int)frame->delay,
+            .TransparentColor = transparency_used ? frame->transparency_index : NO_TRANSPARENT_COLOR,
+        };
+
+        GifByteType extension[4];
+        const size_t extension_length = EGifGCBToExtension(&gcb, extension);
+
+        if (EGifPutExtension(gif, GRAPHICS_EXT_FUNC_CODE, (int)extension_length, extension) == GIF_ERROR) {
+            SAIL_LOG_ERROR("GIF: %s", GifErrorString(gif->Error));
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+        }
+    }
+
+    /* Frames with the same colors as the first one use the global color map. */
+    const ColorMapObject *local_map = color_maps_equal(frame->map, gif_state->global_map) ? NULL : frame->map;
+
+    if (EGifPutImageDesc(gif, (int)rectangle.left, (int)rectangle.top, (int)rectangle_width, (int)rectangle_height,
+                            interlaced, local_map) == GIF_ERROR) {
+        SAIL_LOG_ERROR("GIF: %s", GifErrorString(gif->Error));
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+    }
+
+    SAIL_TRY(gif_private_write_lzw(gif, gif_state->rectangle, (size_t)rectangle_width * rectangle_height,
+                                    SAIL_MAX(frame->map->BitsPerPixel, 2), gif_state->threads));
+
+    /* Pixels outside the rectangle match the canvas already. */
+    for (unsigned row = rectangle.top; row < rectangle.bottom; row++) {
+        const GifPixelType *indexes = frame->indexes + (size_t)row * width + rectangle.left;
+        uint32_t *canvas = gif_state->saved_canvas + (size_t)row * width + rectangle.left;
+
+        for (unsigned column = 0; column < rectangle_width; column++) {
+            canvas[column] = (disposal == DISPOSE_BACKGROUND) ? 0 : frame->rgba_palette[indexes[column]];
+        }
+    }
+
+    gif_state->frames_written++;
+
+    return SAIL_OK;
 }
 
 /*
@@ -153,19 +666,20 @@ SAIL_EXPORT sail_status_t sail_codec_load_init_v8_gif(struct sail_io *io, const
         memset(&gif_state->background, 0, sizeof(gif_state->background));
     }
 
+    /* Handle tuning. */
+    if (gif_state->load_options->tuning != NULL) {
+        sail_traverse_hash_map_with_user_data(gif_state->load_options->tuning, gif_private_tuning_key_value_callback, &gif_state->raw_frames);
+    }
+
     void *ptr;
 
     SAIL_TRY(sail_malloc(gif_state->gif->SWidth * sizeof(GifPixelType), &ptr));
     gif_state->buf = ptr;
 
-    gif_state->first_frame_height = gif_state->gif->SHeight;
-
-    SAIL_TRY(sail_malloc(gif_state->first_frame_height * sizeof(unsigned char *), &ptr));
-    gif_state->first_frame = ptr;
-
-    for (int i = 0; i < gif_state->first_frame_height; i++) {
-        SAIL_TRY(sail_calloc(gif_state->gif->SWidth, 4, &ptr)); /* 4 = RGBA */
-        gif_state->first_frame[i] = ptr;
+    /* A single contiguous canvas. Frames update only their own rectangles in it. */
+    if (!gif_state->raw_frames) {
+        SAIL_TRY(sail_calloc((size_t)gif_state->gif->SWidth * gif_state->gif->SHeight, 4, &ptr)); /* 4 = RGBA */
+        gif_state->canvas = ptr;
     }
 
     return SAIL_OK;
@@ -175,6 +689,17 @@ SAIL_EXPORT sail_status_t sail_codec_load_seek_next_frame_v8_gif(void *state, st
 
     struct gif_state *gif_state = state;
 
+    if (gif_state->peeked_image != NULL) {
+        *image = gif_state->peeked_image;
+        gif_state->peeked_image = NULL;
+        return SAIL_OK;
+    }
+
+    /* The terminator record has been consumed already. */
+    if (gif_state->frame_count >= 0 && gif_state->current_image + 1 >= gif_state->frame_count) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_NO_MORE_FRAMES);
+    }
+
     struct sail_image *image_local;
     SAIL_TRY(sail_alloc_image(&image_local));
 
@@ -186,6 +711,10 @@ SAIL_EXPORT sail_status_t sail_codec_load_seek_next_frame_v8_gif(void *state, st
         image_local->source_image->compression = SAIL_COMPRESSION_LZW;
     }
 
+    size_t frame_offset;
+    SAIL_TRY_OR_CLEANUP(gif_state->io->tell(gif_state->io->stream, &frame_offset),
+                        /* cleanup */ sail_destroy_image(image_local));
+
     gif_state->current_image++;
 
     gif_state->prev_disposal      = gif_state->disposal;
@@ -217,9 +746,6 @@ SAIL_EXPORT sail_status_t sail_codec_load_seek_next_frame_v8_gif(void *state, st
                     SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
                 }
 
-                image_local->width = gif_state->gif->SWidth;
-                image_local->height = gif_state->gif->SHeight;
-
                 gif_state->row    = gif_state->gif->Image.Top;
                 gif_state->column = gif_state->gif->Image.Left;
                 gif_state->width  = gif_state->gif->Image.Width;
@@ -230,6 +756,14 @@ SAIL_EXPORT sail_status_t sail_codec_load_seek_next_frame_v8_gif(void *state, st
                     sail_destroy_image(image_local);
                     SAIL_LOG_AND_RETURN(SAIL_ERROR_INCORRECT_IMAGE_DIMENSIONS);
                 }
+
+                if (gif_state->raw_frames) {
+                    image_local->width  = gif_state->width;
+                    image_local->height = gif_state->height;
+                } else {
+                    image_local->width  = gif_state->gif->SWidth;
+                    image_local->height = gif_state->gif->SHeight;
+                }
                 break;
             }
 
@@ -300,6 +834,7 @@ SAIL_EXPORT sail_status_t sail_codec_load_seek_next_frame_v8_gif(void *state, st
             }
 
             case TERMINATE_RECORD_TYPE: {
+                gif_state->frame_count = gif_state->current_image;
                 sail_destroy_image(image_local);
                 SAIL_LOG_AND_RETURN(SAIL_ERROR_NO_MORE_FRAMES);
             }
@@ -323,9 +858,36 @@ SAIL_EXPORT sail_status_t sail_codec_load_seek_next_frame_v8_gif(void *state, st
                 }
             }
 
+            /* Raw frames are useless without their offsets, so store them unconditionally. */
+            if (gif_state->raw_frames) {
+                if (image_local->source_image == NULL) {
+                    SAIL_TRY_OR_CLEANUP(sail_alloc_source_image(&image_local->source_image),
+                                        /* cleanup */ sail_destroy_image(image_local));
+                    image_local->source_image->pixel_format = SAIL_PIXEL_FORMAT_BPP8_INDEXED;
+                    image_local->source_image->compression = SAIL_COMPRESSION_LZW;
+                }
+
+                if (image_local->source_image->special_properties == NULL) {
+                    SAIL_TRY_OR_CLEANUP(sail_alloc_hash_map(&image_local->source_image->special_properties),
+                                        /* cleanup */ sail_destroy_image(image_local));
+                }
+
+                SAIL_TRY_OR_CLEANUP(gif_private_store_frame_properties(gif_state->gif->SWidth, gif_state->gif->SHeight,
+                                                                        gif_state->column, gif_state->row, gif_state->disposal,
+                                                                        image_local->source_image->special_properties),
+                                    /* cleanup */ sail_destroy_image(image_local));
+            }
+
+            gif_private_build_rgba_palette(gif_state->map, gif_state->transparency_index, gif_state->rgba_palette);
+
             image_local->pixel_format = SAIL_PIXEL_FORMAT_BPP32_RGBA;
             image_local->bytes_per_line = sail_bytes_per_line(image_local->width, image_local->pixel_format);
 
+            if ((unsigned)gif_state->current_image == gif_state->frame_index_size) {
+                SAIL_TRY_OR_CLEANUP(append_to_frame_index(gif_state, frame_offset),
+                                    /* cleanup */ sail_destroy_image(image_local));
+            }
+
             break;
         }
     }
@@ -339,90 +901,113 @@ SAIL_EXPORT sail_status_t sail_codec_load_frame_v8_gif(void *state, struct sail_
 
     struct gif_state *gif_state = state;
 
-    const int passes = gif_state->gif->Image.Interlace ? 4 : 1;
-    const int last_pass = passes - 1;
-    unsigned next_interlaced_row = 0;
+    SAIL_TRY(read_frame(gif_state, image));
 
-    for (int current_pass = 0; current_pass < passes; current_pass++) {
-        /* Apply disposal method on the previous frame. */
-        if (gif_state->current_image > 0 && current_pass == 0) {
-           for (unsigned cc = gif_state->prev_row; cc < gif_state->prev_row+gif_state->prev_height; cc++) {
-                unsigned char *scan = (unsigned char *)image->pixels + image->width*4*cc;
-
-                if (gif_state->prev_disposal == DISPOSE_BACKGROUND) {
-                    /*
-                     * Spec:
-                     *     2 - Restore to background color. The area used by the
-                     *         graphic must be restored to the background color.
-                     *
-                     * The meaning of the background color is not quite clear here. My idea was that
-                     * it's the color specified by the background color index in the global color map.
-                     * However, other decoders like XnView treat "background" as a transparent color here.
-                     * Let's do the same.
-                     */
-                    memset(gif_state->first_frame[cc] + gif_state->prev_column*4, 0, gif_state->prev_width*4); /* 4 = RGBA */
-                }
+    return SAIL_OK;
+}
 
-                memcpy(scan, gif_state->first_frame[cc], image->width * 4);
-            }
-        }
+/*
+ * Reads the next frame header to find out whether the frame exists. The header is kept for
+ * the next sail_codec_load_seek_next_frame_v8_gif() call instead of rewinding the I/O stream,
+ * which may be not seekable. On error, the fields sail_codec_load_seek_next_frame_v8_gif()
+ * updates are restored.
+ */
+static sail_status_t peek_next_frame(struct gif_state *gif_state) {
+
+    const int current_image = gif_state->current_image;
+    const int disposal      = gif_state->disposal;
+    const unsigned row      = gif_state->row;
+    const unsigned column   = gif_state->column;
+    const unsigned width    = gif_state->width;
+    const unsigned height   = gif_state->height;
+
+    struct sail_image *image;
+    const sail_status_t status = sail_codec_load_seek_next_frame_v8_gif(gif_state, &image);
+
+    if (status != SAIL_OK) {
+        gif_state->current_image = current_image;
+        gif_state->disposal      = disposal;
+        gif_state->row           = row;
+        gif_state->column        = column;
+        gif_state->width         = width;
+        gif_state->height        = height;
+
+        return status;
+    }
 
-        /* Read lines. */
-        for (unsigned cc = 0; cc < image->height; cc++) {
-            unsigned char *scan = (unsigned char *)image->pixels + image->width*4*cc;
+    gif_state->peeked_image = image;
 
-            if (cc < gif_state->row || cc >= gif_state->row + gif_state->height) {
-                if (current_pass == 0) {
-                    memcpy(scan, gif_state->first_frame[cc], image->width * 4);
-                }
+    return SAIL_OK;
+}
 
-                continue;
-            }
+SAIL_EXPORT sail_status_t sail_codec_load_seek_to_frame_v8_gif(void *state, unsigned frame) {
 
-            /* In interlaced mode we skip some lines. */
-            bool do_read = false;
+    struct gif_state *gif_state = state;
 
-            if (gif_state->gif->Image.Interlace) {
-                if (cc == gif_state->row) {
-                    next_interlaced_row = InterlacedOffset[current_pass] + gif_state->row;
-                }
+    if (gif_state->frame_count >= 0 && frame >= (unsigned)gif_state->frame_count) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_NO_MORE_FRAMES);
+    }
 
-                if (cc == next_interlaced_row) {
-                    do_read = true;
-                    next_interlaced_row += InterlacedJumps[current_pass];
-                }
-            } else {
-                do_read = true;
-            }
+    /* The previous seek has stopped right before the frame. */
+    if (gif_state->peeked_image != NULL) {
+        if (frame == (unsigned)gif_state->current_image) {
+            return SAIL_OK;
+        }
 
-            if (do_read) {
-                if (DGifGetLine(gif_state->gif, gif_state->buf, gif_state->width) == GIF_ERROR) {
-                    SAIL_LOG_ERROR("GIF: %s", GifErrorString(gif_state->gif->Error));
-                    SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
-                }
+        /* Skip the peeked frame. Composited frames still update the canvas. */
+        sail_destroy_image(gif_state->peeked_image);
+        gif_state->peeked_image = NULL;
 
-                memcpy(scan, gif_state->first_frame[cc], image->width * 4);
+        SAIL_TRY(read_frame(gif_state, NULL));
+    }
 
-                for (unsigned i = 0; i < gif_state->width; i++) {
-                    if (gif_state->buf[i] == gif_state->transparency_index) {
-                        continue;
-                    }
+    /*
+     * Find the closest indexed frame to start reading from. Raw frames are independent,
+     * so any indexed frame works. Composited frames are replayed from the nearest key frame.
+     */
+    const unsigned next_frame = (unsigned)(gif_state->current_image + 1);
+    bool restart = false;
+    unsigned start_frame = next_frame;
 
-                    unsigned char *pixel = scan + (gif_state->column + i)*4;
+    if (gif_state->frame_index_size > 0) {
+        unsigned indexed_frame = (frame < gif_state->frame_index_size) ? frame : gif_state->frame_index_size - 1;
 
-                    *(pixel+0) = gif_state->map->Colors[gif_state->buf[i]].Red;
-                    *(pixel+1) = gif_state->map->Colors[gif_state->buf[i]].Green;
-                    *(pixel+2) = gif_state->map->Colors[gif_state->buf[i]].Blue;
-                    *(pixel+3) = 255;
-                } // for
+        if (!gif_state->raw_frames) {
+            while (!gif_state->frame_index[indexed_frame].key_frame) {
+                indexed_frame--;
             }
+        }
 
-            if (current_pass == last_pass) {
-                memcpy(gif_state->first_frame[cc], scan, image->width * 4);
-            }
+        /* Continue reading when the current position is closer. */
+        const bool can_continue = next_frame <= frame && next_frame >= indexed_frame &&
+                                    (gif_state->frame_count < 0 || next_frame < (unsigned)gif_state->frame_count);
+
+        if (!can_continue) {
+            restart = true;
+            start_frame = indexed_frame;
         }
     }
 
+    SAIL_LOG_TRACE("GIF: Seeking to frame #%u from frame #%u", frame, start_frame);
+
+    if (restart) {
+        SAIL_TRY(restart_at_frame(gif_state, start_frame));
+    }
+
+    /* Skip the frames in between. Raw frames are not even decoded. */
+    while ((unsigned)(gif_state->current_image + 1) < frame) {
+        struct sail_image *image;
+        SAIL_TRY(sail_codec_load_seek_next_frame_v8_gif(gif_state, &image));
+        sail_destroy_image(image);
+
+        SAIL_TRY(read_frame(gif_state, NULL));
+    }
+
+    /* Frames not seen yet may be missing. */
+    if (frame >= gif_state->frame_index_size) {
+        SAIL_TRY(peek_next_frame(gif_state));
+    }
+
     return SAIL_OK;
 }
 
@@ -447,32 +1032,206 @@ SAIL_EXPORT sail_status_t sail_codec_load_finish_v8_gif(void **state) {
 
 SAIL_EXPORT sail_status_t sail_codec_save_init_v8_gif(struct sail_io *io, const struct sail_save_options *save_options, void **state) {
 
-    (void)io;
-    (void)save_options;
-    (void)state;
+    *state = NULL;
+
+    /* Allocate a new state. */
+    struct gif_state *gif_state;
+    SAIL_TRY(alloc_gif_state(io, NULL, save_options, &gif_state));
+    *state = gif_state;
+
+    if (gif_state->save_options->compression != SAIL_COMPRESSION_LZW) {
+        SAIL_LOG_ERROR("GIF: Only LZW compression is allowed for saving");
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_COMPRESSION);
+    }
+
+    /* Handle tuning. */
+    if (gif_state->save_options->tuning != NULL) {
+        sail_traverse_hash_map_with_user_data(gif_state->save_options->tuning, gif_private_save_tuning_key_value_callback, &gif_state->save_tuning);
+    }
+
+#ifdef _OPENMP
+    gif_state->threads = gif_state->save_tuning.threads > 0 ? (int)gif_state->save_tuning.threads : omp_get_max_threads();
+#endif
+
+    /* Initialize GIF. */
+    int error_code;
+    gif_state->gif = EGifOpen(gif_state->io, my_write_proc, &error_code);
+
+    if (gif_state->gif == NULL) {
+        SAIL_LOG_ERROR("GIF: Failed to initialize. GIFLIB error code: %d", error_code);
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+    }
+
+    /* Graphics control extensions need GIF89a. */
+    EGifSetGifVersion(gif_state->gif, true);
 
-    SAIL_LOG_AND_RETURN(SAIL_ERROR_NOT_IMPLEMENTED);
+    return SAIL_OK;
 }
 
 SAIL_EXPORT sail_status_t sail_codec_save_seek_next_frame_v8_gif(void *state, const struct sail_image *image) {
 
-    (void)state;
-    (void)image;
+    struct gif_state *gif_state = state;
+
+    if (gif_state->gif_error) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+    }
+
+    switch (image->pixel_format) {
+        case SAIL_PIXEL_FORMAT_BPP1_INDEXED:
+        case SAIL_PIXEL_FORMAT_BPP2_INDEXED:
+        case SAIL_PIXEL_FORMAT_BPP4_INDEXED:
+        case SAIL_PIXEL_FORMAT_BPP8_INDEXED: {
+            break;
+        }
+
+        default: {
+            /* RGB frames are quantized. */
+            if (!gif_private_is_quantizable(image->pixel_format)) {
+                SAIL_LOG_ERROR("GIF: %s pixel format is not currently supported for saving", sail_pixel_format_to_string(image->pixel_format));
+                SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+            }
+        }
+    }
+
+    if (sail_is_indexed(image->pixel_format) && image->palette == NULL) {
+        SAIL_LOG_ERROR("GIF: The indexed image has no palette");
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_MISSING_PALETTE);
+    }
+
+    /* The first frame defines the logical screen. */
+    if (gif_state->saved_canvas == NULL) {
+        if (image->width > UINT16_MAX || image->height > UINT16_MAX) {
+            SAIL_LOG_ERROR("GIF: Image dimensions %ux%u exceed the limit of %u", image->width, image->height, UINT16_MAX);
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_INCORRECT_IMAGE_DIMENSIONS);
+        }
+
+        const size_t pixels = (size_t)image->width * image->height;
+
+        /*
+         * The canvas marks the logical screen as defined, so assign it only after
+         * all the buffers are allocated.
+         */
+        void *saved_canvas = NULL;
+        void *rectangle = NULL;
+        void *indexes[2] = { NULL, NULL };
+
+        SAIL_TRY(sail_calloc(pixels, sizeof(uint32_t), &saved_canvas));
+        SAIL_TRY_OR_CLEANUP(sail_malloc(pixels, &rectangle),
+                            /* cleanup */ sail_free(saved_canvas));
+        SAIL_TRY_OR_CLEANUP(sail_malloc(pixels, &indexes[0]),
+                            /* cleanup */ sail_free(rectangle),
+                                          sail_free(saved_canvas));
+        SAIL_TRY_OR_CLEANUP(sail_malloc(pixels, &indexes[1]),
+                            /* cleanup */ sail_free(indexes[0]),
+                                          sail_free(rectangle),
+                                          sail_free(saved_canvas));
+
+        gif_state->gif->SWidth  = (GifWord)image->width;
+        gif_state->gif->SHeight = (GifWord)image->height;
+
+        gif_state->saved_canvas      = saved_canvas;
+        gif_state->rectangle         = rectangle;
+        gif_state->frames[0].indexes = indexes[0];
+        gif_state->frames[1].indexes = indexes[1];
+    } else if (image->width != (unsigned)gif_state->gif->SWidth || image->height != (unsigned)gif_state->gif->SHeight) {
+        SAIL_LOG_ERROR("GIF: All frames must be %ux%u", (unsigned)gif_state->gif->SWidth, (unsigned)gif_state->gif->SHeight);
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_INCORRECT_IMAGE_DIMENSIONS);
+    }
 
-    SAIL_LOG_AND_RETURN(SAIL_ERROR_NOT_IMPLEMENTED);
+    return SAIL_OK;
 }
 
 SAIL_EXPORT sail_status_t sail_codec_save_frame_v8_gif(void *state, const struct sail_image *image) {
 
-    (void)state;
-    (void)image;
+    struct gif_state *gif_state = state;
+
+    if (gif_state->gif_error) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+    }
+
+    struct gif_frame *pending_frame = &gif_state->frames[gif_state->pending_frame];
+    struct gif_frame *frame = pending_frame->valid ? &gif_state->frames[gif_state->pending_frame ^ 1] : pending_frame;
+
+    GifFreeMapObject(frame->map);
+    frame->map = NULL;
+    sail_destroy_meta_data_node_chain(frame->meta_data_node);
+    frame->meta_data_node = NULL;
+
+    unsigned char remap[256];
+
+    if (sail_is_indexed(image->pixel_format)) {
+        SAIL_TRY(gif_private_build_color_map(image->palette, &frame->map, remap, &frame->transparency_index));
+        frame->color_count = image->palette->color_count;
+
+        const unsigned bits_per_pixel = sail_bits_per_pixel(image->pixel_format);
+
+        for (unsigned row = 0; row < image->height; row++) {
+            SAIL_TRY(gif_private_unpack_row(frame->indexes + (size_t)row * image->width, sail_scan_line(image, row),
+                                            bits_per_pixel, image->width, remap, image->palette->color_count));
+        }
+    } else {
+        struct sail_palette *palette;
+        SAIL_TRY(gif_private_quantize(image, frame->indexes, &palette));
+
+        SAIL_TRY_OR_CLEANUP(gif_private_build_color_map(palette, &frame->map, remap, &frame->transparency_index),
+                            /* cleanup */ sail_destroy_palette(palette));
+        frame->color_count = palette->color_count;
+        sail_destroy_palette(palette);
+
+        /* The quantized palette has a single transparent entry, so the indexes need no remapping. */
+    }
+
+    gif_private_build_rgba_palette(frame->map, frame->transparency_index, frame->rgba_palette);
+
+    frame->delay = (image->delay > 0) ? (unsigned)(image->delay + 5) / 10 : 0;
+
+    if (gif_state->save_options->options & SAIL_OPTION_META_DATA && image->meta_data_node != NULL) {
+        SAIL_TRY(sail_copy_meta_data_node_chain(image->meta_data_node, &frame->meta_data_node));
+    }
+
+    if (frame != pending_frame) {
+        SAIL_TRY_OR_CLEANUP(write_frame(gif_state, pending_frame, frame),
+                            /* cleanup */ gif_state->gif_error = true);
+        pending_frame->valid = false;
+        gif_state->pending_frame ^= 1;
+    }
+
+    frame->valid = true;
 
-    SAIL_LOG_AND_RETURN(SAIL_ERROR_NOT_IMPLEMENTED);
+    return SAIL_OK;
 }
 
 SAIL_EXPORT sail_status_t sail_codec_save_finish_v8_gif(void **state) {
 
-    (void)state;
+    struct gif_state *gif_state = *state;
+
+    /* Subsequent calls to finish() will expectedly fail in the above line. */
+    *state = NULL;
+
+    sail_status_t status = SAIL_OK;
+    struct gif_frame *pending_frame = &gif_state->frames[gif_state->pending_frame];
+
+    if (gif_state->gif != NULL && !gif_state->gif_error && pending_frame->valid) {
+        status = write_frame(gif_state, pending_frame, NULL);
+    }
+
+    if (gif_state->gif != NULL) {
+        int error_code;
 
-    SAIL_LOG_AND_RETURN(SAIL_ERROR_NOT_IMPLEMENTED);
+        if (EGifCloseFile(gif_state->gif, &error_code) == GIF_ERROR) {
+            SAIL_LOG_ERROR("GIF: Failed to finish. GIFLIB error code: %d", error_code);
+
+            if (status == SAIL_OK) {
+                status = SAIL_ERROR_UNDERLYING_CODEC;
+            }
+        }
+    }
+
+    destroy_gif_state(gif_state);
+
+    if (status != SAIL_OK) {
+        SAIL_LOG_AND_RETURN(status);
+    }
+
+    return SAIL_OK;
 }
@@ -23,6 +23,8 @@
     SOFTWARE.
 */
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
 
 #include <gif_lib.h>
@@ -74,3 +76,231 @@ sail_status_t gif_private_fetch_application(const GifByteType *extension, struct
 
     return SAIL_OK;
 }
+
+void gif_private_build_rgba_palette(const ColorMapObject *map, int transparency_index, uint32_t rgba_palette[256]) {
+
+    /*
+     * Palette entries are stored as RGBA bytes in memory regardless of the host endianness.
+     * Missing entries become opaque black. The transparent entry becomes all zeros, so
+     * a non-zero entry always means an opaque pixel.
+     */
+    for (int i = 0; i < 256; i++) {
+        unsigned char rgba[4] = { 0, 0, 0, 255 };
+
+        if (i == transparency_index) {
+            rgba[3] = 0;
+        } else if (i < map->ColorCount) {
+            rgba[0] = map->Colors[i].Red;
+            rgba[1] = map->Colors[i].Green;
+            rgba[2] = map->Colors[i].Blue;
+        }
+
+        memcpy(&rgba_palette[i], rgba, sizeof(rgba));
+    }
+}
+
+void gif_private_expand_row(uint32_t *dst, const uint32_t *rgba_palette, const GifPixelType *indexes, unsigned width) {
+
+    for (unsigned i = 0; i < width; i++) {
+        dst[i] = rgba_palette[indexes[i]];
+    }
+}
+
+void gif_private_blend_row(uint32_t *dst, const uint32_t *rgba_palette, const GifPixelType *indexes, unsigned width) {
+
+    /* Branchless select so the compiler is able to vectorize the loop. */
+    for (unsigned i = 0; i < width; i++) {
+        const uint32_t pixel = rgba_palette[indexes[i]];
+        dst[i] = (pixel != 0) ? pixel : dst[i];
+    }
+}
+
+sail_status_t gif_private_store_frame_properties(unsigned screen_width, unsigned screen_height,
+                                                    unsigned left, unsigned top, int disposal,
+                                                    struct sail_hash_map *special_properties) {
+
+    struct sail_variant *variant;
+    SAIL_TRY(sail_alloc_variant(&variant));
+
+    SAIL_LOG_TRACE("GIF: Screen: %ux%u, frame offset: %u,%u", screen_width, screen_height, left, top);
+
+    sail_set_variant_unsigned_int(variant, screen_width);
+    sail_put_hash_map(special_properties, "gif-screen-width", variant);
+
+    sail_set_variant_unsigned_int(variant, screen_height);
+    sail_put_hash_map(special_properties, "gif-screen-height", variant);
+
+    sail_set_variant_unsigned_int(variant, left);
+    sail_put_hash_map(special_properties, "gif-frame-left", variant);
+
+    sail_set_variant_unsigned_int(variant, top);
+    sail_put_hash_map(special_properties, "gif-frame-top", variant);
+
+    const char *disposal_str;
+
+    switch (disposal) {
+        case DISPOSE_DO_NOT:     disposal_str = "none";        break;
+        case DISPOSE_BACKGROUND: disposal_str = "background";  break;
+        case DISPOSE_PREVIOUS:   disposal_str = "previous";    break;
+        default:                 disposal_str = "unspecified"; break;
+    }
+
+    sail_set_variant_string(variant, disposal_str);
+    sail_put_hash_map(special_properties, "gif-frame-disposal", variant);
+
+    sail_destroy_variant(variant);
+
+    return SAIL_OK;
+}
+
+bool gif_private_tuning_key_value_callback(const char *key, const struct sail_variant *value, void *user_data) {
+
+    bool *raw_frames = user_data;
+
+    if (strcmp(key, "gif-raw-frames") == 0) {
+        if (value->type == SAIL_VARIANT_TYPE_BOOL) {
+            *raw_frames = sail_variant_to_bool(value);
+            SAIL_LOG_TRACE("GIF: Raw frames: %s", *raw_frames ? "yes" : "no");
+        }
+    }
+
+    return true;
+}
+
+bool gif_private_save_tuning_key_value_callback(const char *key, const struct sail_variant *value, void *user_data) {
+
+    struct gif_private_save_tuning *save_tuning = user_data;
+
+    if (strcmp(key, "gif-delta-frames") == 0) {
+        if (value->type == SAIL_VARIANT_TYPE_BOOL) {
+            save_tuning->delta_frames = sail_variant_to_bool(value);
+            SAIL_LOG_TRACE("GIF: Delta frames: %s", save_tuning->delta_frames ? "yes" : "no");
+        }
+    } else if (strcmp(key, "gif-threads") == 0) {
+        if (value->type == SAIL_VARIANT_TYPE_UNSIGNED_INT) {
+            save_tuning->threads = sail_variant_to_unsigned_int(value);
+            SAIL_LOG_TRACE("GIF: Threads: %u", save_tuning->threads);
+        }
+    }
+
+    return true;
+}
+
+sail_status_t gif_private_build_color_map(const struct sail_palette *palette,
+                                            ColorMapObject **map, unsigned char remap[256], int *transparency_index) {
+
+    unsigned bytes_per_color;
+
+    switch (palette->pixel_format) {
+        case SAIL_PIXEL_FORMAT_BPP24_RGB:  bytes_per_color = 3; break;
+        case SAIL_PIXEL_FORMAT_BPP32_RGBA: bytes_per_color = 4; break;
+
+        default: {
+            SAIL_LOG_ERROR("GIF: Palettes with %s pixel format are not supported for saving", sail_pixel_format_to_string(palette->pixel_format));
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+        }
+    }
+
+    if (palette->color_count == 0 || palette->color_count > 256) {
+        SAIL_LOG_ERROR("GIF: Palette with %u colors is not supported", palette->color_count);
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_BROKEN_IMAGE);
+    }
+
+    const unsigned char *data = palette->data;
+    int transparency_index_local = -1;
+
+    for (unsigned i = 0; i < palette->color_count; i++) {
+        const bool transparent = bytes_per_color == 4 && data[i * 4 + 3] < 128;
+
+        if (transparent && transparency_index_local < 0) {
+            transparency_index_local = (int)i;
+        }
+
+        remap[i] = transparent ? (unsigned char)transparency_index_local : (unsigned char)i;
+    }
+
+    /* Color maps are powers of two with at least 2 entries. */
+    const int map_size = 1 << GifBitSize((int)SAIL_MAX(palette->color_count, 2));
+
+    *map = GifMakeMapObject(map_size, NULL);
+
+    if (*map == NULL) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_MEMORY_ALLOCATION);
+    }
+
+    for (int i = 0; i < map_size; i++) {
+        if ((unsigned)i < palette->color_count) {
+            (*map)->Colors[i].Red   = data[i * bytes_per_color + 0];
+            (*map)->Colors[i].Green = data[i * bytes_per_color + 1];
+            (*map)->Colors[i].Blue  = data[i * bytes_per_color + 2];
+        } else {
+            (*map)->Colors[i].Red   = 0;
+            (*map)->Colors[i].Green = 0;
+            (*map)->Colors[i].Blue  = 0;
+        }
+    }
+
+    *transparency_index = transparency_index_local;
+
+    return SAIL_OK;
+}
+
+sail_status_t gif_private_reserve_transparency(ColorMapObject **map, unsigned color_count, int *transparency_index) {
+
+    if (color_count >= 256) {
+        *transparency_index = -1;
+        return SAIL_OK;
+    }
+
+    if ((int)color_count >= (*map)->ColorCount) {
+        ColorMapObject *grown_map = GifMakeMapObject((*map)->ColorCount * 2, NULL);
+
+        if (grown_map == NULL) {
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_MEMORY_ALLOCATION);
+        }
+
+        for (int i = 0; i < grown_map->ColorCount; i++) {
+            if (i < (*map)->ColorCount) {
+                grown_map->Colors[i] = (*map)->Colors[i];
+            } else {
+                grown_map->Colors[i].Red   = 0;
+                grown_map->Colors[i].Green = 0;
+                grown_map->Colors[i].Blue  = 0;
+            }
+        }
+
+        GifFreeMapObject(*map);
+        *map = grown_map;
+    }
+
+    *transparency_index = (int)color_count;
+
+    return SAIL_OK;
+}
+
+sail_status_t gif_private_unpack_row(GifPixelType *dst, const unsigned char *scan, unsigned bits_per_pixel, unsigned width,
+                                        const unsigned char remap[256], unsigned color_count) {
+
+    const unsigned pixels_per_byte = 8 / bits_per_pixel;
+    const unsigned mask = (1u << bits_per_pixel) - 1;
+
+    for (unsigned i = 0; i < width; i++) {
+        unsigned index;
+
+        if (bits_per_pixel == 8) {
+            index = scan[i];
+        } else {
+            const unsigned shift = 8 - bits_per_pixel * (i % pixels_per_byte + 1);
+            index = (scan[i / pixels_per_byte] >> shift) & mask;
+        }
+
+        if (index >= color_count) {
+            SAIL_LOG_ERROR("GIF: Palette index %u is out of range [0; %u)", index, color_count);
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_BROKEN_IMAGE);
+        }
+
+        dst[i] = remap[index];
+    }
+
+    return SAIL_OK;
+}
@@ -26,16 +26,62 @@
 #ifndef SAIL_GIF_HELPERS_H
 #define SAIL_GIF_HELPERS_H
 
+#include <stdbool.h>
+#include <stdint.h>
+
 #include <gif_lib.h>
 
 #include <sail-common/common.h>
 #include <sail-common/export.h>
 #include <sail-common/status.h>
 
+struct sail_hash_map;
 struct sail_meta_data_node;
+struct sail_palette;
+struct sail_variant;
+
+struct gif_private_save_tuning {
+    /* Write only the changed rectangles of frames with unchanged pixels made transparent. */
+    bool delta_frames;
+    /* Number of threads to compress frames with. 0 means the OpenMP default. */
+    unsigned threads;
+};
 
 SAIL_HIDDEN sail_status_t gif_private_fetch_comment(const GifByteType *extension, struct sail_meta_data_node **meta_data_node);
 
 SAIL_HIDDEN sail_status_t gif_private_fetch_application(const GifByteType *extension, struct sail_meta_data_node **meta_data_node);
 
+SAIL_HIDDEN void gif_private_build_rgba_palette(const ColorMapObject *map, int transparency_index, uint32_t rgba_palette[256]);
+
+SAIL_HIDDEN void gif_private_expand_row(uint32_t *dst, const uint32_t *rgba_palette, const GifPixelType *indexes, unsigned width);
+
+SAIL_HIDDEN void gif_private_blend_row(uint32_t *dst, const uint32_t *rgba_palette, const GifPixelType *indexes, unsigned width);
+
+SAIL_HIDDEN sail_status_t gif_private_store_frame_properties(unsigned screen_width, unsigned screen_height,
+                                                                unsigned left, unsigned top, int disposal,
+                                                                struct sail_hash_map *special_properties);
+
+SAIL_HIDDEN bool gif_private_tuning_key_value_callback(const char *key, const struct sail_variant *value, void *user_data);
+
+SAIL_HIDDEN bool gif_private_save_tuning_key_value_callback(const char *key, const struct sail_variant *value, void *user_data);
+
+/*
+ * Builds a color map from the palette. Palette colors with alpha below 128 are mapped onto
+ * a single transparency index through 'remap'. Sets 'transparency_index' to -1 when the palette
+ * has no such colors.
+ */
+SAIL_HIDDEN sail_status_t gif_private_build_color_map(const struct sail_palette *palette,
+                                                        ColorMapObject **map, unsigned char remap[256], int *transparency_index);
+
+/*
+ * Appends an entry to the color map of 'color_count' palette colors to serve as the transparency index.
+ * Doubles the color map when it has no room for the entry. Sets 'transparency_index' to -1 when
+ * the palette has 256 colors already.
+ */
+SAIL_HIDDEN sail_status_t gif_private_reserve_transparency(ColorMapObject **map, unsigned color_count, int *transparency_index);
+
+/* Unpacks 1, 2, 4, or 8-bit indexes and maps them through 'remap'. Fails on indexes beyond the palette. */
+SAIL_HIDDEN sail_status_t gif_private_unpack_row(GifPixelType *dst, const unsigned char *scan, unsigned bits_per_pixel, unsigned width,
+                                                    const unsigned char remap[256], unsigned color_count);
+
 #endif
@@ -42,7 +42,7 @@ int my_read_proc(GifFileType *gif, GifByteType *buffer, int buffer_size) {
     return (int)nbytes;
 }
 
-int my_write_proc(GifFileType *gif, GifByteType *buffer, int buffer_size) {
+int my_write_proc(GifFileType *gif, const GifByteType *buffer, int buffer_size) {
 
     struct sail_io *io = gif->UserData;
     size_t nbytes;
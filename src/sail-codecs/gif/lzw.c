@@ -0,0 +1,323 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <gif_lib.h>
+
+#include <sail-common/sail-common.h>
+
+#include "lzw.h"
+
+/*
+ * Private functions.
+ */
+
+/* Number of pixels to compress in a single segment. */
+#define SEGMENT_SIZE (256 * 1024)
+
+/* Codes are limited to 12 bits. The table is cleared when it's full, just like GIFLIB does. */
+#define LZW_MAX_CODE 4095
+
+#define HASH_BITS 13
+#define HASH_SIZE (1 << HASH_BITS)
+#define HASH_EMPTY UINT32_MAX
+
+/* LZW codes of a segment. The last bits that don't fill up a byte are kept in 'accumulator'. */
+struct segment {
+    unsigned char *data;
+    size_t size;
+    uint32_t accumulator;
+    unsigned bits;
+};
+
+/* Prefix code and pixel pairs mapped to their codes. */
+struct lzw_table {
+    uint32_t keys[HASH_SIZE];
+    uint16_t codes[HASH_SIZE];
+};
+
+/* Writes sub-blocks of up to 255 bytes into GIFLIB. */
+struct block_writer {
+    GifFileType *gif;
+    int code_size;
+    bool first;
+    unsigned size;
+    GifByteType block[256];
+};
+
+static inline void put_code(struct segment *segment, unsigned code, unsigned width) {
+
+    segment->accumulator |= (uint32_t)code << segment->bits;
+    segment->bits += width;
+
+    while (segment->bits >= 8) {
+        segment->data[segment->size++] = (unsigned char)segment->accumulator;
+        segment->accumulator >>= 8;
+        segment->bits -= 8;
+    }
+}
+
+static inline uint32_t hash_key(uint32_t key) {
+
+    return (key * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static sail_status_t compress_segment(const GifPixelType *indexes, size_t count, unsigned code_size,
+                                        bool first, bool last, struct segment *segment) {
+
+    /* Every code takes at most 12 bits and codes at least one pixel, clear codes aside. */
+    const size_t capacity = (count + count / 256 + 4) * 12 / 8 + 1;
+
+    void *ptr;
+    SAIL_TRY(sail_malloc(capacity, &ptr));
+    segment->data        = ptr;
+    segment->size        = 0;
+    segment->accumulator = 0;
+    segment->bits        = 0;
+
+    SAIL_TRY(sail_malloc(sizeof(struct lzw_table), &ptr));
+    struct lzw_table *table = ptr;
+    memset(table->keys, 0xFF, sizeof(table->keys));
+
+    const unsigned clear_code = 1u << code_size;
+    const unsigned eoi_code   = clear_code + 1;
+
+    unsigned width = code_size + 1;
+    unsigned limit = 1u << width;
+    unsigned next_code = eoi_code + 1;
+
+    /* The code width grows when the table outgrows it, in the same manner as GIFLIB. */
+#define EMIT(code)                      \
+    do {                                \
+        put_code(segment, code, width); \
+        if (next_code >= limit) {       \
+            width++;                    \
+            limit <<= 1;                \
+        }                               \
+    } while (0)
+
+    if (first) {
+        EMIT(clear_code);
+    }
+
+    unsigned current = indexes[0];
+
+    for (size_t i = 1; i < count; i++) {
+        const unsigned pixel = indexes[i];
+        const uint32_t key = ((uint32_t)current << 8) | pixel;
+        uint32_t slot = hash_key(key);
+
+        while (table->keys[slot] != HASH_EMPTY && table->keys[slot] != key) {
+            slot = (slot + 1) & (HASH_SIZE - 1);
+        }
+
+        if (table->keys[slot] == key) {
+            current = table->codes[slot];
+            continue;
+        }
+
+        EMIT(current);
+        current = pixel;
+
+        if (next_code >= LZW_MAX_CODE) {
+            EMIT(clear_code);
+
+            width = code_size + 1;
+            limit = 1u << width;
+            next_code = eoi_code + 1;
+            memset(table->keys, 0xFF, sizeof(table->keys));
+        } else {
+            table->keys[slot]  = key;
+            table->codes[slot] = (uint16_t)next_code++;
+        }
+    }
+
+    EMIT(current);
+
+    /* The next segment starts with an empty table. */
+    EMIT(last ? eoi_code : clear_code);
+
+#undef EMIT
+
+    sail_free(table);
+
+    return SAIL_OK;
+}
+
+static sail_status_t write_byte(struct block_writer *writer, unsigned char byte) {
+
+    writer->block[1 + writer->size++] = byte;
+
+    if (writer->size == 255) {
+        writer->block[0] = 255;
+
+        const int result = writer->first
+                            ? EGifPutCode(writer->gif, writer->code_size, writer->block)
+                            : EGifPutCodeNext(writer->gif, writer->block);
+
+        if (result == GIF_ERROR) {
+            SAIL_LOG_ERROR("GIF: %s", GifErrorString(writer->gif->Error));
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+        }
+
+        writer->first = false;
+        writer->size  = 0;
+    }
+
+    return SAIL_OK;
+}
+
+static sail_status_t finish_blocks(struct block_writer *writer) {
+
+    if (writer->size > 0) {
+        writer->block[0] = (GifByteType)writer->size;
+
+        const int result = writer->first
+                            ? EGifPutCode(writer->gif, writer->code_size, writer->block)
+                            : EGifPutCodeNext(writer->gif, writer->block);
+
+        if (result == GIF_ERROR) {
+            SAIL_LOG_ERROR("GIF: %s", GifErrorString(writer->gif->Error));
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+        }
+    }
+
+    /* Block terminator. */
+    if (EGifPutCodeNext(writer->gif, NULL) == GIF_ERROR) {
+        SAIL_LOG_ERROR("GIF: %s", GifErrorString(writer->gif->Error));
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+    }
+
+    return SAIL_OK;
+}
+
+/* Appends the segment codes to the codes written so far which end in the middle of 'accumulator'. */
+static sail_status_t append_segment(struct block_writer *writer, const struct segment *segment, uint32_t *accumulator, unsigned *bits) {
+
+    for (size_t i = 0; i < segment->size; i++) {
+        *accumulator |= (uint32_t)segment->data[i] << *bits;
+        SAIL_TRY(write_byte(writer, (unsigned char)*accumulator));
+        *accumulator >>= 8;
+    }
+
+    *accumulator |= segment->accumulator << *bits;
+    *bits += segment->bits;
+
+    while (*bits >= 8) {
+        SAIL_TRY(write_byte(writer, (unsigned char)*accumulator));
+        *accumulator >>= 8;
+        *bits -= 8;
+    }
+
+    return SAIL_OK;
+}
+
+static void destroy_segments(struct segment *segments, unsigned count) {
+
+    for (unsigned i = 0; i < count; i++) {
+        sail_free(segments[i].data);
+        segments[i].data = NULL;
+    }
+}
+
+/*
+ * Public functions.
+ */
+
+sail_status_t gif_private_write_lzw(GifFileType *gif, const GifPixelType *indexes, size_t count,
+                                    int code_size, int threads) {
+
+    /* A single segment compresses exactly like GIFLIB. */
+    const size_t segments_count = (threads > 1) ? (count + SEGMENT_SIZE - 1) / SEGMENT_SIZE : 1;
+    const size_t segment_size   = (threads > 1) ? SEGMENT_SIZE : count;
+
+    /* Keep a limited number of compressed segments in memory. */
+    const unsigned batch = (unsigned)SAIL_MIN((size_t)SAIL_MAX(threads, 1) * 2, segments_count);
+
+    void *ptr;
+    SAIL_TRY(sail_malloc(batch * sizeof(struct segment), &ptr));
+    struct segment *segments = ptr;
+
+    for (unsigned i = 0; i < batch; i++) {
+        segments[i].data = NULL;
+    }
+
+    struct block_writer writer = {
+        .gif       = gif,
+        .code_size = code_size,
+        .first     = true,
+        .size      = 0,
+    };
+
+    uint32_t accumulator = 0;
+    unsigned bits = 0;
+    bool failed = false;
+
+    SAIL_LOG_TRACE("GIF: Compressing %u segments in %d threads", (unsigned)segments_count, threads);
+
+    for (size_t first_segment = 0; first_segment < segments_count && !failed; first_segment += batch) {
+        const int segments_in_batch = (int)SAIL_MIN(batch, segments_count - first_segment);
+
+        int i;
+
+        #pragma omp parallel for schedule(SAIL_OPENMP_SCHEDULE) num_threads(threads)
+        for (i = 0; i < segments_in_batch; i++) {
+            const size_t segment  = first_segment + i;
+            const size_t offset   = segment * segment_size;
+            const size_t length   = SAIL_MIN(segment_size, count - offset);
+
+            if (compress_segment(indexes + offset, length, (unsigned)code_size,
+                                    segment == 0, segment + 1 == segments_count, &segments[i]) != SAIL_OK) {
+                #pragma omp atomic write
+                failed = true;
+            }
+        }
+
+        for (i = 0; i < segments_in_batch && !failed; i++) {
+            if (append_segment(&writer, &segments[i], &accumulator, &bits) != SAIL_OK) {
+                failed = true;
+            }
+        }
+
+        destroy_segments(segments, batch);
+    }
+
+    sail_free(segments);
+
+    if (failed) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+    }
+
+    if (bits > 0) {
+        SAIL_TRY(write_byte(&writer, (unsigned char)accumulator));
+    }
+
+    SAIL_TRY(finish_blocks(&writer));
+
+    return SAIL_OK;
+}
@@ -0,0 +1,48 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_GIF_LZW_H
+#define SAIL_GIF_LZW_H
+
+#include <stddef.h>
+
+#include <gif_lib.h>
+
+#include <sail-common/common.h>
+#include <sail-common/export.h>
+
+/*
+ * Compresses the pixel indexes with LZW and writes them as the image data of the current
+ * frame. The image descriptor must be written already. 'code_size' is the minimum code size
+ * GIFLIB has written for the frame color map.
+ *
+ * The indexes are split into segments compressed in parallel. Every segment but the last one
+ * ends with a clear code, so the segments are joined into a single standard code stream
+ * by shifting their bits.
+ */
+SAIL_HIDDEN sail_status_t gif_private_write_lzw(GifFileType *gif, const GifPixelType *indexes, size_t count,
+                                                int code_size, int threads);
+
+#endif
@@ -0,0 +1,450 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <gif_lib.h>
+
+#include <sail-common/sail-common.h>
+
+#include "quantize.h"
+
+/*
+ * Private functions.
+ */
+
+/* Opaque colors a palette holds. The last entry is left for the transparency index. */
+#define MAX_OPAQUE_COLORS 255
+
+/* Open addressing table to collect exact colors. Twice as large as the colors it holds. */
+#define EXACT_TABLE_SIZE 512
+
+/* Median cut works on 5 bits per channel. */
+#define HISTOGRAM_BITS 5
+#define HISTOGRAM_SIZE (1 << (HISTOGRAM_BITS * 3))
+
+struct channel_offsets {
+    unsigned bytes_per_pixel;
+    unsigned r;
+    unsigned g;
+    unsigned b;
+    /* -1 when there's no alpha channel. */
+    int a;
+};
+
+struct exact_table {
+    uint32_t keys[EXACT_TABLE_SIZE];
+    /* Palette index plus one. 0 marks empty slots. */
+    uint16_t indexes[EXACT_TABLE_SIZE];
+    unsigned count;
+};
+
+struct histogram_entry {
+    uint16_t key;
+    uint32_t count;
+    uint64_t sums[3];
+};
+
+struct box {
+    unsigned start;
+    unsigned end;
+    /* Channel with the largest range and the range. */
+    unsigned channel;
+    unsigned range;
+};
+
+static bool channel_offsets(enum SailPixelFormat pixel_format, struct channel_offsets *offsets) {
+
+    switch (pixel_format) {
+        case SAIL_PIXEL_FORMAT_BPP24_RGB:  *offsets = (struct channel_offsets) { 3, 0, 1, 2, -1 }; return true;
+        case SAIL_PIXEL_FORMAT_BPP24_BGR:  *offsets = (struct channel_offsets) { 3, 2, 1, 0, -1 }; return true;
+        case SAIL_PIXEL_FORMAT_BPP32_RGBA: *offsets = (struct channel_offsets) { 4, 0, 1, 2,  3 }; return true;
+        case SAIL_PIXEL_FORMAT_BPP32_BGRA: *offsets = (struct channel_offsets) { 4, 2, 1, 0,  3 }; return true;
+        case SAIL_PIXEL_FORMAT_BPP32_ARGB: *offsets = (struct channel_offsets) { 4, 1, 2, 3,  0 }; return true;
+        case SAIL_PIXEL_FORMAT_BPP32_ABGR: *offsets = (struct channel_offsets) { 4, 3, 2, 1,  0 }; return true;
+
+        default: {
+            return false;
+        }
+    }
+}
+
+static inline bool is_transparent(const unsigned char *pixel, const struct channel_offsets *offsets) {
+
+    return offsets->a >= 0 && pixel[offsets->a] < 128;
+}
+
+static inline uint32_t pixel_key(const unsigned char *pixel, const struct channel_offsets *offsets) {
+
+    return ((uint32_t)pixel[offsets->r] << 16) | ((uint32_t)pixel[offsets->g] << 8) | pixel[offsets->b];
+}
+
+static inline unsigned histogram_key(const unsigned char *pixel, const struct channel_offsets *offsets) {
+
+    const unsigned shift = 8 - HISTOGRAM_BITS;
+
+    return ((unsigned)(pixel[offsets->r] >> shift) << (HISTOGRAM_BITS * 2)) |
+            ((unsigned)(pixel[offsets->g] >> shift) << HISTOGRAM_BITS) |
+            (unsigned)(pixel[offsets->b] >> shift);
+}
+
+static inline unsigned histogram_component(uint16_t key, unsigned channel) {
+
+    return (key >> (HISTOGRAM_BITS * (2 - channel))) & ((1 << HISTOGRAM_BITS) - 1);
+}
+
+/* Returns the slot of the key, or the empty slot to insert it into. */
+static unsigned exact_table_slot(const struct exact_table *table, uint32_t key) {
+
+    unsigned slot = (key * 2654435761u) >> 23; /* 9 bits = 512 slots */
+
+    while (table->indexes[slot] != 0 && table->keys[slot] != key) {
+        slot = (slot + 1) & (EXACT_TABLE_SIZE - 1);
+    }
+
+    return slot;
+}
+
+/*
+ * Collects the distinct opaque colors in the order they're met. Returns false when there are more
+ * than MAX_OPAQUE_COLORS of them.
+ */
+static bool collect_exact_colors(const struct sail_image *image, const struct channel_offsets *offsets,
+                                    struct exact_table *table, unsigned char colors[MAX_OPAQUE_COLORS][3],
+                                    bool *has_transparency) {
+
+    for (unsigned row = 0; row < image->height; row++) {
+        const unsigned char *pixel = sail_scan_line(image, row);
+
+        for (unsigned column = 0; column < image->width; column++, pixel += offsets->bytes_per_pixel) {
+            if (is_transparent(pixel, offsets)) {
+                *has_transparency = true;
+                continue;
+            }
+
+            const uint32_t key = pixel_key(pixel, offsets);
+            const unsigned slot = exact_table_slot(table, key);
+
+            if (table->indexes[slot] != 0) {
+                continue;
+            }
+
+            if (table->count == MAX_OPAQUE_COLORS) {
+                return false;
+            }
+
+            colors[table->count][0] = pixel[offsets->r];
+            colors[table->count][1] = pixel[offsets->g];
+            colors[table->count][2] = pixel[offsets->b];
+
+            table->keys[slot]    = key;
+            table->indexes[slot] = (uint16_t)++table->count;
+        }
+    }
+
+    return true;
+}
+
+static int compare_red(const void *a, const void *b) {
+
+    return (int)histogram_component(((const struct histogram_entry *)a)->key, 0) -
+            (int)histogram_component(((const struct histogram_entry *)b)->key, 0);
+}
+
+static int compare_green(const void *a, const void *b) {
+
+    return (int)histogram_component(((const struct histogram_entry *)a)->key, 1) -
+            (int)histogram_component(((const struct histogram_entry *)b)->key, 1);
+}
+
+static int compare_blue(const void *a, const void *b) {
+
+    return (int)histogram_component(((const struct histogram_entry *)a)->key, 2) -
+            (int)histogram_component(((const struct histogram_entry *)b)->key, 2);
+}
+
+static int (* const CHANNEL_COMPARATORS[3])(const void *, const void *) = { compare_red, compare_green, compare_blue };
+
+static void measure_box(const struct histogram_entry *entries, struct box *box) {
+
+    unsigned min[3] = { UINT32_MAX, UINT32_MAX, UINT32_MAX };
+    unsigned max[3] = { 0, 0, 0 };
+
+    for (unsigned i = box->start; i < box->end; i++) {
+        for (unsigned channel = 0; channel < 3; channel++) {
+            const unsigned component = histogram_component(entries[i].key, channel);
+
+            min[channel] = SAIL_MIN(min[channel], component);
+            max[channel] = SAIL_MAX(max[channel], component);
+        }
+    }
+
+    box->channel = 0;
+    box->range   = 0;
+
+    for (unsigned channel = 0; channel < 3; channel++) {
+        if (max[channel] - min[channel] > box->range) {
+            box->channel = channel;
+            box->range   = max[channel] - min[channel];
+        }
+    }
+}
+
+/* Splits the histogram entries into at most max_boxes boxes. Returns the number of boxes. */
+static unsigned median_cut(struct histogram_entry *entries, unsigned entries_count, struct box *boxes, unsigned max_boxes) {
+
+    unsigned boxes_count = 1;
+    boxes[0] = (struct box) { 0, entries_count, 0, 0 };
+    measure_box(entries, &boxes[0]);
+
+    while (boxes_count < max_boxes) {
+        /* Split the box with the widest range. */
+        struct box *box = NULL;
+
+        for (unsigned i = 0; i < boxes_count; i++) {
+            if (boxes[i].range > 0 && (box == NULL || boxes[i].range > box->range)) {
+                box = &boxes[i];
+            }
+        }
+
+        if (box == NULL) {
+            break;
+        }
+
+        qsort(entries + box->start, box->end - box->start, sizeof(struct histogram_entry), CHANNEL_COMPARATORS[box->channel]);
+
+        /* Split at the median pixel, keeping both halves non-empty. */
+        uint64_t total = 0;
+
+        for (unsigned i = box->start; i < box->end; i++) {
+            total += entries[i].count;
+        }
+
+        uint64_t count = 0;
+        unsigned split = box->start + 1;
+
+        for (unsigned i = box->start; i < box->end - 1; i++) {
+            count += entries[i].count;
+            split = i + 1;
+
+            if (count * 2 >= total) {
+                break;
+            }
+        }
+
+        boxes[boxes_count] = (struct box) { split, box->end, 0, 0 };
+        box->end = split;
+
+        measure_box(entries, box);
+        measure_box(entries, &boxes[boxes_count]);
+        boxes_count++;
+    }
+
+    return boxes_count;
+}
+
+static unsigned nearest_color(const unsigned char colors[MAX_OPAQUE_COLORS][3], unsigned colors_count, const unsigned char color[3]) {
+
+    unsigned nearest = 0;
+    unsigned nearest_distance = UINT32_MAX;
+
+    for (unsigned i = 0; i < colors_count; i++) {
+        const int dr = (int)colors[i][0] - color[0];
+        const int dg = (int)colors[i][1] - color[1];
+        const int db = (int)colors[i][2] - color[2];
+        const unsigned distance = (unsigned)(dr * dr + dg * dg + db * db);
+
+        if (distance < nearest_distance) {
+            nearest = i;
+            nearest_distance = distance;
+        }
+    }
+
+    return nearest;
+}
+
+/*
+ * Reduces the opaque colors with median cut. Every histogram entry is mapped to the palette color
+ * nearest to its mean color, and the pixels are mapped through the histogram. Transparent pixels
+ * are mapped to the entry following the opaque colors.
+ */
+static sail_status_t quantize_median_cut(const struct sail_image *image, const struct channel_offsets *offsets,
+                                            unsigned char colors[MAX_OPAQUE_COLORS][3], unsigned *colors_count,
+                                            GifPixelType *indexes, bool *has_transparency) {
+
+    void *ptr;
+    SAIL_TRY(sail_calloc(HISTOGRAM_SIZE, sizeof(struct histogram_entry), &ptr));
+    struct histogram_entry *histogram = ptr;
+
+    for (unsigned row = 0; row < image->height; row++) {
+        const unsigned char *pixel = sail_scan_line(image, row);
+
+        for (unsigned column = 0; column < image->width; column++, pixel += offsets->bytes_per_pixel) {
+            if (is_transparent(pixel, offsets)) {
+                *has_transparency = true;
+                continue;
+            }
+
+            struct histogram_entry *entry = &histogram[histogram_key(pixel, offsets)];
+
+            entry->count++;
+            entry->sums[0] += pixel[offsets->r];
+            entry->sums[1] += pixel[offsets->g];
+            entry->sums[2] += pixel[offsets->b];
+        }
+    }
+
+    /* Keep the used entries in front and remember where every key went. */
+    SAIL_TRY_OR_CLEANUP(sail_malloc(HISTOGRAM_SIZE * sizeof(uint8_t), &ptr),
+                        /* cleanup */ sail_free(histogram));
+    uint8_t *key_to_index = ptr;
+
+    unsigned entries_count = 0;
+
+    for (unsigned key = 0; key < HISTOGRAM_SIZE; key++) {
+        if (histogram[key].count > 0) {
+            histogram[entries_count] = histogram[key];
+            histogram[entries_count].key = (uint16_t)key;
+            entries_count++;
+        }
+    }
+
+    struct box boxes[MAX_OPAQUE_COLORS];
+    *colors_count = median_cut(histogram, entries_count, boxes, MAX_OPAQUE_COLORS);
+
+    for (unsigned i = 0; i < *colors_count; i++) {
+        uint64_t count = 0;
+        uint64_t sums[3] = { 0, 0, 0 };
+
+        for (unsigned j = boxes[i].start; j < boxes[i].end; j++) {
+            count   += histogram[j].count;
+            sums[0] += histogram[j].sums[0];
+            sums[1] += histogram[j].sums[1];
+            sums[2] += histogram[j].sums[2];
+        }
+
+        for (unsigned channel = 0; channel < 3; channel++) {
+            colors[i][channel] = (unsigned char)((sums[channel] + count / 2) / count);
+        }
+    }
+
+    for (unsigned i = 0; i < entries_count; i++) {
+        const unsigned char mean[3] = {
+            (unsigned char)(histogram[i].sums[0] / histogram[i].count),
+            (unsigned char)(histogram[i].sums[1] / histogram[i].count),
+            (unsigned char)(histogram[i].sums[2] / histogram[i].count),
+        };
+
+        key_to_index[histogram[i].key] = (uint8_t)nearest_color(colors, *colors_count, mean);
+    }
+
+    sail_free(histogram);
+
+    for (unsigned row = 0; row < image->height; row++) {
+        const unsigned char *pixel = sail_scan_line(image, row);
+        GifPixelType *row_indexes = indexes + (size_t)row * image->width;
+
+        for (unsigned column = 0; column < image->width; column++, pixel += offsets->bytes_per_pixel) {
+            row_indexes[column] = is_transparent(pixel, offsets)
+                                    ? (GifPixelType)*colors_count
+                                    : key_to_index[histogram_key(pixel, offsets)];
+        }
+    }
+
+    sail_free(key_to_index);
+
+    return SAIL_OK;
+}
+
+/*
+ * Public functions.
+ */
+
+bool gif_private_is_quantizable(enum SailPixelFormat pixel_format) {
+
+    struct channel_offsets offsets;
+
+    return channel_offsets(pixel_format, &offsets);
+}
+
+sail_status_t gif_private_quantize(const struct sail_image *image, GifPixelType *indexes, struct sail_palette **palette) {
+
+    struct channel_offsets offsets;
+
+    if (!channel_offsets(image->pixel_format, &offsets)) {
+        SAIL_LOG_ERROR("GIF: %s pixel format cannot be quantized", sail_pixel_format_to_string(image->pixel_format));
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    }
+
+    unsigned char colors[MAX_OPAQUE_COLORS][3];
+    unsigned colors_count;
+    bool has_transparency = false;
+
+    void *ptr;
+    SAIL_TRY(sail_calloc(1, sizeof(struct exact_table), &ptr));
+    struct exact_table *table = ptr;
+
+    if (collect_exact_colors(image, &offsets, table, colors, &has_transparency)) {
+        colors_count = table->count;
+
+        for (unsigned row = 0; row < image->height; row++) {
+            const unsigned char *pixel = sail_scan_line(image, row);
+            GifPixelType *row_indexes = indexes + (size_t)row * image->width;
+
+            for (unsigned column = 0; column < image->width; column++, pixel += offsets.bytes_per_pixel) {
+                row_indexes[column] = is_transparent(pixel, &offsets)
+                                        ? (GifPixelType)colors_count
+                                        : (GifPixelType)(table->indexes[exact_table_slot(table, pixel_key(pixel, &offsets))] - 1);
+            }
+        }
+
+        sail_free(table);
+    } else {
+        sail_free(table);
+
+        SAIL_TRY(quantize_median_cut(image, &offsets, colors, &colors_count, indexes, &has_transparency));
+    }
+
+    /* The transparent entry follows the opaque colors. */
+    struct sail_palette *palette_local;
+    SAIL_TRY(sail_alloc_palette_for_data(SAIL_PIXEL_FORMAT_BPP32_RGBA, colors_count + (has_transparency ? 1 : 0), &palette_local));
+
+    unsigned char *data = palette_local->data;
+    memset(data, 0, (size_t)palette_local->color_count * 4);
+
+    for (unsigned i = 0; i < colors_count; i++) {
+        data[i * 4 + 0] = colors[i][0];
+        data[i * 4 + 1] = colors[i][1];
+        data[i * 4 + 2] = colors[i][2];
+        data[i * 4 + 3] = 255;
+    }
+
+    *palette = palette_local;
+
+    return SAIL_OK;
+}
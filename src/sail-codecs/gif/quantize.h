@@ -0,0 +1,51 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_GIF_QUANTIZE_H
+#define SAIL_GIF_QUANTIZE_H
+
+#include <stdbool.h>
+
+#include <gif_lib.h>
+
+#include <sail-common/common.h>
+#include <sail-common/export.h>
+#include <sail-common/status.h>
+
+struct sail_image;
+struct sail_palette;
+
+/* Returns true if the pixel format is one of the 24 or 32-bit RGB formats gif_private_quantize() accepts. */
+SAIL_HIDDEN bool gif_private_is_quantizable(enum SailPixelFormat pixel_format);
+
+/*
+ * Builds a BPP32-RGBA palette for the image pixels and maps the pixels onto it, one index per pixel.
+ * Pixels with alpha below 128 share a single fully transparent entry. Up to 255 opaque colors are kept
+ * exactly, so one entry is left for the transparency index of delta frames. Images with more colors
+ * are reduced to 255 colors with median cut.
+ */
+SAIL_HIDDEN sail_status_t gif_private_quantize(const struct sail_image *image, GifPixelType *indexes, struct sail_palette **palette);
+
+#endif
@@ -86,3 +86,124 @@ sail_status_t ico_private_store_cur_hotspot(const struct SailIcoDirEntry *ico_di
 
     return SAIL_OK;
 }
+
+unsigned ico_private_dir_entry_bit_depth(const struct SailIcoDirEntry *dir_entry, bool is_cur) {
+
+    /* CUR stores the hotspot in place of the bit count. */
+    if (!is_cur && dir_entry->bit_count != 0) {
+        return dir_entry->bit_count;
+    }
+
+    /* Zero means 256 colors or more, which is almost always true color. */
+    if (dir_entry->color_count == 0) {
+        return 32;
+    }
+
+    unsigned bit_depth = 1;
+
+    while ((1U << bit_depth) < dir_entry->color_count) {
+        bit_depth++;
+    }
+
+    return bit_depth;
+}
+
+/*
+ * Values not less than the requested one win as scaling down looks better than scaling up.
+ * Among them, the closest one wins. Otherwise, the largest one wins.
+ */
+static bool is_better_fit(bool candidate_fits, unsigned long candidate, bool best_fits, unsigned long best) {
+
+    if (candidate_fits != best_fits) {
+        return candidate_fits;
+    }
+
+    return candidate_fits ? candidate < best : candidate > best;
+}
+
+sail_status_t ico_private_find_best_dir_entry(const struct SailIcoDirEntry *dir_entries, unsigned dir_entries_count, bool is_cur,
+                                                const struct ico_load_tuning *load_tuning, const bool *skip, unsigned *index) {
+
+    /* When only one dimension is requested, assume a square. */
+    const unsigned requested_width  = (load_tuning->width  > 0) ? load_tuning->width  : load_tuning->height;
+    const unsigned requested_height = (load_tuning->height > 0) ? load_tuning->height : load_tuning->width;
+
+    bool found = false;
+    unsigned best_index = 0;
+    unsigned long best_area = 0;
+    bool best_size_fits = false;
+    unsigned best_bit_depth = 0;
+    bool best_bit_depth_fits = false;
+
+    for (unsigned i = 0; i < dir_entries_count; i++) {
+        if (skip != NULL && skip[i]) {
+            continue;
+        }
+
+        /* Zero means 256. */
+        const unsigned width  = (dir_entries[i].width  == 0) ? 256 : dir_entries[i].width;
+        const unsigned height = (dir_entries[i].height == 0) ? 256 : dir_entries[i].height;
+        const unsigned long area = (unsigned long)width * height;
+        const unsigned bit_depth = ico_private_dir_entry_bit_depth(&dir_entries[i], is_cur);
+
+        /* The largest size and the deepest entry win when nothing is requested. */
+        const bool size_fits      = requested_width > 0 && width >= requested_width && height >= requested_height;
+        const bool bit_depth_fits = load_tuning->bit_depth > 0 && bit_depth >= load_tuning->bit_depth;
+
+        bool better;
+
+        if (!found) {
+            better = true;
+        } else if (area != best_area || size_fits != best_size_fits) {
+            better = is_better_fit(size_fits, area, best_size_fits, best_area);
+        } else {
+            better = is_better_fit(bit_depth_fits, bit_depth, best_bit_depth_fits, best_bit_depth);
+        }
+
+        if (better) {
+            found               = true;
+            best_index          = i;
+            best_area           = area;
+            best_size_fits      = size_fits;
+            best_bit_depth      = bit_depth;
+            best_bit_depth_fits = bit_depth_fits;
+        }
+    }
+
+    if (!found) {
+        SAIL_LOG_ERROR("ICO: No suitable images found");
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_NO_MORE_FRAMES);
+    }
+
+    SAIL_LOG_TRACE("ICO: Selected image #%u", best_index);
+
+    *index = best_index;
+
+    return SAIL_OK;
+}
+
+bool ico_private_tuning_key_value_callback(const char *key, const struct sail_variant *value, void *user_data) {
+
+    struct ico_load_tuning *load_tuning = user_data;
+
+    unsigned *target;
+
+    if (strcmp(key, "ico-width") == 0) {
+        target = &load_tuning->width;
+    } else if (strcmp(key, "ico-height") == 0) {
+        target = &load_tuning->height;
+    } else if (strcmp(key, "ico-bit-depth") == 0) {
+        target = &load_tuning->bit_depth;
+    } else {
+        return true;
+    }
+
+    if (value->type == SAIL_VARIANT_TYPE_UNSIGNED_INT) {
+        *target = sail_variant_to_unsigned_int(value);
+        SAIL_LOG_TRACE("ICO: %s(%u)", key, *target);
+    } else {
+        SAIL_LOG_ERROR("ICO: '%s' must be an unsigned int", key);
+    }
+
+    return true;
+}
@@ -26,12 +26,15 @@
 #ifndef SAIL_ICO_HELPERS_H
 #define SAIL_ICO_HELPERS_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include <sail-common/export.h>
 #include <sail-common/status.h>
 
+struct sail_hash_map;
 struct sail_io;
+struct sail_variant;
 
 /* File header. */
 struct SailIcoHeader
@@ -59,6 +62,14 @@ enum SailIcoImageType
     SAIL_ICO_IMAGE_PNG,
 };
 
+/* Best-fit entry selection. Zero values mean "not requested". */
+struct ico_load_tuning
+{
+    unsigned width;
+    unsigned height;
+    unsigned bit_depth;
+};
+
 SAIL_HIDDEN sail_status_t ico_private_read_header(struct sail_io *io, struct SailIcoHeader *header);
 
 SAIL_HIDDEN sail_status_t ico_private_read_dir_entry(struct sail_io *io, struct SailIcoDirEntry *dir_entry);
@@ -67,4 +78,16 @@ SAIL_HIDDEN sail_status_t ico_private_probe_image_type(struct sail_io *io, enum
 
 SAIL_HIDDEN sail_status_t ico_private_store_cur_hotspot(const struct SailIcoDirEntry *ico_dir_entry, struct sail_hash_map *special_properties);
 
+/* Returns the entry bit depth as declared in the directory. */
+SAIL_HIDDEN unsigned ico_private_dir_entry_bit_depth(const struct SailIcoDirEntry *dir_entry, bool is_cur);
+
+/*
+ * Selects the entry that best matches the requested size and bit depth using the directory only.
+ * Entries with skip[i] set are ignored. skip may be NULL.
+ */
+SAIL_HIDDEN sail_status_t ico_private_find_best_dir_entry(const struct SailIcoDirEntry *dir_entries, unsigned dir_entries_count, bool is_cur,
+                                                            const struct ico_load_tuning *load_tuning, const bool *skip, unsigned *index);
+
+SAIL_HIDDEN bool ico_private_tuning_key_value_callback(const char *key, const struct sail_variant *value, void *user_data);
+
 #endif
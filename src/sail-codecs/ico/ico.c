@@ -34,6 +34,9 @@
 #include "common/bmp/bmp.h"
 
 #include "helpers.h"
+#ifdef SAIL_HAVE_ICO_PNG
+    #include "png_entry.h"
+#endif
 
 #define SAIL_ICO_TYPE_ICO 1
 #define SAIL_ICO_TYPE_CUR 2
@@ -50,7 +53,16 @@ struct ico_state {
     struct SailIcoDirEntry *ico_dir_entries;
     unsigned current_frame;
 
+    struct ico_load_tuning load_tuning;
+    /* The only entry to decode when best-fit tuning is set. */
+    bool best_fit;
+    unsigned best_fit_entry;
+
+    enum SailIcoImageType current_image_type;
     void *common_bmp_state;
+#ifdef SAIL_HAVE_ICO_PNG
+    struct ico_png_state *png_state;
+#endif
 };
 
 static sail_status_t alloc_ico_state(struct sail_io *io,
@@ -67,9 +79,16 @@ static sail_status_t alloc_ico_state(struct sail_io *io,
         .load_options = load_options,
         .save_options = save_options,
 
-        .ico_dir_entries  = NULL,
-        .current_frame    = 0,
-        .common_bmp_state = NULL,
+        .ico_dir_entries    = NULL,
+        .current_frame      = 0,
+        .load_tuning        = { .width = 0, .height = 0, .bit_depth = 0 },
+        .best_fit           = false,
+        .best_fit_entry     = 0,
+        .current_image_type = SAIL_ICO_IMAGE_BMP,
+        .common_bmp_state   = NULL,
+#ifdef SAIL_HAVE_ICO_PNG
+        .png_state          = NULL,
+#endif
     };
 
     return SAIL_OK;
@@ -83,6 +102,10 @@ static void destroy_ico_state(struct ico_state *ico_state) {
 
     sail_free(ico_state->ico_dir_entries);
 
+#ifdef SAIL_HAVE_ICO_PNG
+    ico_private_png_read_finish(&ico_state->png_state);
+#endif
+
     sail_free(ico_state);
 }
 
@@ -90,6 +113,40 @@ static void destroy_ico_state(struct ico_state *ico_state) {
  * Decoding functions.
  */
 
+static sail_status_t select_best_fit_entry(struct ico_state *ico_state) {
+
+    const bool is_cur = ico_state->ico_header.type == SAIL_ICO_TYPE_CUR;
+
+#ifdef SAIL_HAVE_ICO_PNG
+    SAIL_TRY(ico_private_find_best_dir_entry(ico_state->ico_dir_entries, ico_state->ico_header.images_count, is_cur,
+                                                &ico_state->load_tuning, NULL, &ico_state->best_fit_entry));
+#else
+    /* PNG images cannot be decoded, so exclude them from the selection. */
+    void *ptr;
+    SAIL_TRY(sail_malloc(sizeof(bool) * ico_state->ico_header.images_count, &ptr));
+    bool *skip = ptr;
+
+    for (unsigned i = 0; i < ico_state->ico_header.images_count; i++) {
+        enum SailIcoImageType ico_image_type;
+
+        SAIL_TRY_OR_CLEANUP(ico_state->io->seek(ico_state->io->stream, (long)ico_state->ico_dir_entries[i].image_offset, SEEK_SET),
+                            /* cleanup */ sail_free(skip));
+        SAIL_TRY_OR_CLEANUP(ico_private_probe_image_type(ico_state->io, &ico_image_type),
+                            /* cleanup */ sail_free(skip));
+
+        skip[i] = ico_image_type != SAIL_ICO_IMAGE_BMP;
+    }
+
+    SAIL_TRY_OR_CLEANUP(ico_private_find_best_dir_entry(ico_state->ico_dir_entries, ico_state->ico_header.images_count, is_cur,
+                                                        &ico_state->load_tuning, skip, &ico_state->best_fit_entry),
+                        /* cleanup */ sail_free(skip));
+
+    sail_free(skip);
+#endif
+
+    return SAIL_OK;
+}
+
 SAIL_EXPORT sail_status_t sail_codec_load_init_v8_ico(struct sail_io *io, const struct sail_load_options *load_options, void **state) {
 
     *state = NULL;
@@ -124,6 +181,17 @@ SAIL_EXPORT sail_status_t sail_codec_load_init_v8_ico(struct sail_io *io, const
         SAIL_TRY(ico_private_read_dir_entry(ico_state->io, &ico_state->ico_dir_entries[i]));
     }
 
+    /* Handle tuning. */
+    if (ico_state->load_options->tuning != NULL) {
+        sail_traverse_hash_map_with_user_data(ico_state->load_options->tuning, ico_private_tuning_key_value_callback, &ico_state->load_tuning);
+    }
+
+    ico_state->best_fit = ico_state->load_tuning.width > 0 || ico_state->load_tuning.height > 0 || ico_state->load_tuning.bit_depth > 0;
+
+    if (ico_state->best_fit) {
+        SAIL_TRY(select_best_fit_entry(ico_state));
+    }
+
     return SAIL_OK;
 }
 
@@ -131,25 +199,66 @@ SAIL_EXPORT sail_status_t sail_codec_load_seek_next_frame_v8_ico(void *state, st
 
     struct ico_state *ico_state = state;
 
-    /* Skip non-BMP images. */
-    enum SailIcoImageType ico_image_type;
+    const struct SailIcoDirEntry *ico_dir_entry;
 
-    do {
-        if (ico_state->current_frame >= ico_state->ico_header.images_count) {
+    if (ico_state->best_fit) {
+        /* Only the selected entry is exposed. */
+        if (ico_state->current_frame > 0) {
             SAIL_LOG_AND_RETURN(SAIL_ERROR_NO_MORE_FRAMES);
         }
 
-        SAIL_TRY(ico_state->io->seek(ico_state->io->stream, (long)ico_state->ico_dir_entries[ico_state->current_frame++].image_offset, SEEK_SET));
+        ico_state->current_frame++;
+        ico_dir_entry = &ico_state->ico_dir_entries[ico_state->best_fit_entry];
 
-        /* Check the image is not PNG. */
-        SAIL_TRY(ico_private_probe_image_type(ico_state->io, &ico_image_type));
-    } while (ico_image_type != SAIL_ICO_IMAGE_BMP);
+        SAIL_TRY(ico_state->io->seek(ico_state->io->stream, (long)ico_dir_entry->image_offset, SEEK_SET));
+        SAIL_TRY(ico_private_probe_image_type(ico_state->io, &ico_state->current_image_type));
+    } else {
+        for (;;) {
+            if (ico_state->current_frame >= ico_state->ico_header.images_count) {
+                SAIL_LOG_AND_RETURN(SAIL_ERROR_NO_MORE_FRAMES);
+            }
+
+            ico_dir_entry = &ico_state->ico_dir_entries[ico_state->current_frame++];
+
+            SAIL_TRY(ico_state->io->seek(ico_state->io->stream, (long)ico_dir_entry->image_offset, SEEK_SET));
+            SAIL_TRY(ico_private_probe_image_type(ico_state->io, &ico_state->current_image_type));
+
+#ifndef SAIL_HAVE_ICO_PNG
+            /* Skip PNG images as they cannot be decoded. */
+            if (ico_state->current_image_type != SAIL_ICO_IMAGE_BMP) {
+                continue;
+            }
+#endif
+            break;
+        }
+    }
 
-    /* Continue to loading BMP. */
     struct sail_image *image_local;
 
-    SAIL_TRY(bmp_private_read_init(ico_state->io, ico_state->load_options, &ico_state->common_bmp_state, SAIL_NO_BMP_FLAGS));
-    SAIL_TRY(bmp_private_read_seek_next_frame(ico_state->common_bmp_state, ico_state->io, &image_local));
+    if (ico_state->current_image_type == SAIL_ICO_IMAGE_PNG) {
+#ifdef SAIL_HAVE_ICO_PNG
+        ico_private_png_read_finish(&ico_state->png_state);
+
+        SAIL_TRY(ico_private_png_read_init(ico_state->io,
+                                            ico_dir_entry->image_offset,
+                                            ico_dir_entry->image_size,
+                                            ico_state->load_options,
+                                            &ico_state->png_state,
+                                            &image_local));
+#else
+        SAIL_LOG_ERROR("ICO: PNG images are not supported");
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_FORMAT);
+#endif
+    } else {
+        SAIL_TRY(bmp_private_read_init(ico_state->io, ico_state->load_options, &ico_state->common_bmp_state, SAIL_NO_BMP_FLAGS));
+        SAIL_TRY(bmp_private_read_seek_next_frame(ico_state->common_bmp_state, ico_state->io, &image_local));
+
+        /*
+         * The contained image is twice the height declared in the directory.
+         * The second half is a mask. We need just the image.
+         */
+        image_local->height /= 2;
+    }
 
     /* Store CUR hotspot. */
     if (ico_state->load_options->options & SAIL_OPTION_SOURCE_IMAGE) {
@@ -162,19 +271,12 @@ SAIL_EXPORT sail_status_t sail_codec_load_seek_next_frame_v8_ico(void *state, st
 
                 SAIL_TRY_OR_CLEANUP(sail_alloc_hash_map(&image_local->source_image->special_properties),
                                     /* cleanup */ sail_destroy_image(image_local));
-                SAIL_TRY_OR_CLEANUP(ico_private_store_cur_hotspot(&ico_state->ico_dir_entries[ico_state->current_frame - 1],
-                                                                    image_local->source_image->special_properties),
+                SAIL_TRY_OR_CLEANUP(ico_private_store_cur_hotspot(ico_dir_entry, image_local->source_image->special_properties),
                                     /* cleanup */ sail_destroy_image(image_local));
             }
         }
     }
 
-    /*
-     * The contained image is twice the height declared in the directory.
-     * The second half is a mask. We need just the image.
-     */
-    image_local->height /= 2;
-
     *image = image_local;
 
     return SAIL_OK;
@@ -184,12 +286,66 @@ SAIL_EXPORT sail_status_t sail_codec_load_frame_v8_ico(void *state, struct sail_
 
     struct ico_state *ico_state = state;
 
+#ifdef SAIL_HAVE_ICO_PNG
+    if (ico_state->current_image_type == SAIL_ICO_IMAGE_PNG) {
+        SAIL_TRY(ico_private_png_read_frame(ico_state->png_state, image));
+        ico_private_png_read_finish(&ico_state->png_state);
+
+        return SAIL_OK;
+    }
+#endif
+
     SAIL_TRY(bmp_private_read_frame(ico_state->common_bmp_state, ico_state->io, image));
     SAIL_TRY(bmp_private_read_finish(&ico_state->common_bmp_state, ico_state->io));
 
     return SAIL_OK;
 }
 
+SAIL_EXPORT sail_status_t sail_codec_load_seek_to_frame_v8_ico(void *state, unsigned frame) {
+
+    struct ico_state *ico_state = state;
+
+    if (ico_state->best_fit) {
+        if (frame > 0) {
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_NO_MORE_FRAMES);
+        }
+
+        ico_state->current_frame = 0;
+        return SAIL_OK;
+    }
+
+#ifdef SAIL_HAVE_ICO_PNG
+    /* Every entry is a frame. */
+    if (frame >= ico_state->ico_header.images_count) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_NO_MORE_FRAMES);
+    }
+
+    ico_state->current_frame = frame;
+    return SAIL_OK;
+#else
+    /* Frames are counted among BMP images only as PNG images are skipped. Probe the types without decoding. */
+    unsigned bmp_frame = 0;
+
+    for (unsigned i = 0; i < ico_state->ico_header.images_count; i++) {
+        SAIL_TRY(ico_state->io->seek(ico_state->io->stream, (long)ico_state->ico_dir_entries[i].image_offset, SEEK_SET));
+
+        enum SailIcoImageType ico_image_type;
+        SAIL_TRY(ico_private_probe_image_type(ico_state->io, &ico_image_type));
+
+        if (ico_image_type != SAIL_ICO_IMAGE_BMP) {
+            continue;
+        }
+
+        if (bmp_frame++ == frame) {
+            ico_state->current_frame = i;
+            return SAIL_OK;
+        }
+    }
+
+    SAIL_LOG_AND_RETURN(SAIL_ERROR_NO_MORE_FRAMES);
+#endif
+}
+
 SAIL_EXPORT sail_status_t sail_codec_load_finish_v8_ico(void **state) {
 
     struct ico_state *ico_state = *state;
@@ -0,0 +1,191 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include <sail-common/sail-common.h>
+
+#include "io_view.h"
+
+struct io_view_stream {
+    struct sail_io *parent;
+    size_t offset;
+    size_t size;
+
+    /* Current position relative to the offset. */
+    size_t pos;
+};
+
+static sail_status_t io_view_tolerant_read(void *stream, void *buf, size_t size_to_read, size_t *read_size) {
+
+    struct io_view_stream *io_view_stream = stream;
+
+    *read_size = 0;
+
+    if (io_view_stream->pos >= io_view_stream->size) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_EOF);
+    }
+
+    const size_t available = io_view_stream->size - io_view_stream->pos;
+    const size_t actual_size_to_read = (size_to_read > available) ? available : size_to_read;
+
+    SAIL_TRY(io_view_stream->parent->tolerant_read(io_view_stream->parent->stream, buf, actual_size_to_read, read_size));
+
+    io_view_stream->pos += *read_size;
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_view_strict_read(void *stream, void *buf, size_t size_to_read) {
+
+    size_t read_size;
+
+    SAIL_TRY(io_view_tolerant_read(stream, buf, size_to_read, &read_size));
+
+    if (read_size != size_to_read) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_READ_IO);
+    }
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_view_tolerant_write(void *stream, const void *buf, size_t size_to_write, size_t *written_size) {
+
+    (void)stream;
+    (void)buf;
+    (void)size_to_write;
+    (void)written_size;
+
+    SAIL_LOG_AND_RETURN(SAIL_ERROR_NOT_IMPLEMENTED);
+}
+
+static sail_status_t io_view_strict_write(void *stream, const void *buf, size_t size_to_write) {
+
+    (void)stream;
+    (void)buf;
+    (void)size_to_write;
+
+    SAIL_LOG_AND_RETURN(SAIL_ERROR_NOT_IMPLEMENTED);
+}
+
+static sail_status_t io_view_seek(void *stream, long offset, int whence) {
+
+    struct io_view_stream *io_view_stream = stream;
+
+    long new_pos;
+
+    switch (whence) {
+        case SEEK_SET: new_pos = offset;                                break;
+        case SEEK_CUR: new_pos = (long)io_view_stream->pos  + offset; break;
+        case SEEK_END: new_pos = (long)io_view_stream->size + offset; break;
+
+        default: {
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_SEEK_WHENCE);
+        }
+    }
+
+    if (new_pos < 0 || (size_t)new_pos > io_view_stream->size) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_SEEK_IO);
+    }
+
+    SAIL_TRY(io_view_stream->parent->seek(io_view_stream->parent->stream, (long)io_view_stream->offset + new_pos, SEEK_SET));
+
+    io_view_stream->pos = (size_t)new_pos;
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_view_tell(void *stream, size_t *offset) {
+
+    struct io_view_stream *io_view_stream = stream;
+
+    *offset = io_view_stream->pos;
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_view_flush(void *stream) {
+
+    (void)stream;
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_view_close(void *stream) {
+
+    sail_free(stream);
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_view_eof(void *stream, bool *result) {
+
+    struct io_view_stream *io_view_stream = stream;
+
+    *result = io_view_stream->pos >= io_view_stream->size;
+
+    return SAIL_OK;
+}
+
+/*
+ * Public functions.
+ */
+
+sail_status_t ico_private_alloc_io_view(struct sail_io *parent, size_t offset, size_t size, struct sail_io **io) {
+
+    SAIL_TRY(parent->seek(parent->stream, (long)offset, SEEK_SET));
+
+    void *ptr;
+    SAIL_TRY(sail_malloc(sizeof(struct io_view_stream), &ptr));
+    struct io_view_stream *io_view_stream = ptr;
+
+    *io_view_stream = (struct io_view_stream) {
+        .parent = parent,
+        .offset = offset,
+        .size   = size,
+        .pos    = 0,
+    };
+
+    struct sail_io *io_local;
+    SAIL_TRY_OR_CLEANUP(sail_alloc_io(&io_local),
+                        /* cleanup */ sail_free(io_view_stream));
+
+    io_local->features       = parent->features;
+    io_local->stream         = io_view_stream;
+    io_local->tolerant_read  = io_view_tolerant_read;
+    io_local->strict_read    = io_view_strict_read;
+    io_local->tolerant_write = io_view_tolerant_write;
+    io_local->strict_write   = io_view_strict_write;
+    io_local->seek           = io_view_seek;
+    io_local->tell           = io_view_tell;
+    io_local->flush          = io_view_flush;
+    io_local->close          = io_view_close;
+    io_local->eof            = io_view_eof;
+
+    *io = io_local;
+
+    return SAIL_OK;
+}
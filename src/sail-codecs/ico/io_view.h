@@ -0,0 +1,45 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_ICO_IO_VIEW_H
+#define SAIL_ICO_IO_VIEW_H
+
+#include <stddef.h>
+
+#include <sail-common/export.h>
+#include <sail-common/status.h>
+
+struct sail_io;
+
+/*
+ * Allocates a read-only I/O object over the [offset, offset + size) range of the parent I/O.
+ * Reads are clamped to the range and forwarded to the parent, so no data is copied.
+ * The parent I/O must outlive the view and must not be used while the view is being read.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_HIDDEN sail_status_t ico_private_alloc_io_view(struct sail_io *parent, size_t offset, size_t size, struct sail_io **io);
+
+#endif
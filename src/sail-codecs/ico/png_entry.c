@@ -0,0 +1,243 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <setjmp.h>
+#include <stdbool.h>
+
+#include <png.h>
+
+#include <sail-common/sail-common.h>
+
+#include "io_view.h"
+#include "png_entry.h"
+
+struct ico_png_state {
+    struct sail_io *io;
+
+    png_structp png_ptr;
+    png_infop info_ptr;
+
+    int interlaced_passes;
+};
+
+static void my_read_fn(png_structp png_ptr, png_bytep bytes, png_size_t bytes_size) {
+
+    struct sail_io *io = png_get_io_ptr(png_ptr);
+
+    if (io->strict_read(io->stream, bytes, bytes_size) != SAIL_OK) {
+        png_error(png_ptr, "Failed to read from the I/O stream");
+    }
+}
+
+static void my_error_fn(png_structp png_ptr, png_const_charp text) {
+
+    (void)png_ptr;
+
+    SAIL_LOG_ERROR("ICO: PNG: %s", text);
+}
+
+static void my_warning_fn(png_structp png_ptr, png_const_charp text) {
+
+    (void)png_ptr;
+
+    SAIL_LOG_WARNING("ICO: PNG: %s", text);
+}
+
+static enum SailPixelFormat png_color_type_to_pixel_format(int color_type, int bit_depth) {
+
+    switch (color_type) {
+        case PNG_COLOR_TYPE_GRAY: {
+            switch (bit_depth) {
+                case 1:  return SAIL_PIXEL_FORMAT_BPP1_GRAYSCALE;
+                case 2:  return SAIL_PIXEL_FORMAT_BPP2_GRAYSCALE;
+                case 4:  return SAIL_PIXEL_FORMAT_BPP4_GRAYSCALE;
+                case 8:  return SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE;
+                case 16: return SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE;
+            }
+            break;
+        }
+        case PNG_COLOR_TYPE_GRAY_ALPHA: {
+            switch (bit_depth) {
+                case 8:  return SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE_ALPHA;
+                case 16: return SAIL_PIXEL_FORMAT_BPP32_GRAYSCALE_ALPHA;
+            }
+            break;
+        }
+        case PNG_COLOR_TYPE_PALETTE: {
+            switch (bit_depth) {
+                case 1: return SAIL_PIXEL_FORMAT_BPP1_INDEXED;
+                case 2: return SAIL_PIXEL_FORMAT_BPP2_INDEXED;
+                case 4: return SAIL_PIXEL_FORMAT_BPP4_INDEXED;
+                case 8: return SAIL_PIXEL_FORMAT_BPP8_INDEXED;
+            }
+            break;
+        }
+        case PNG_COLOR_TYPE_RGB: {
+            switch (bit_depth) {
+                case 8:  return SAIL_PIXEL_FORMAT_BPP24_RGB;
+                case 16: return SAIL_PIXEL_FORMAT_BPP48_RGB;
+            }
+            break;
+        }
+        case PNG_COLOR_TYPE_RGB_ALPHA: {
+            switch (bit_depth) {
+                case 8:  return SAIL_PIXEL_FORMAT_BPP32_RGBA;
+                case 16: return SAIL_PIXEL_FORMAT_BPP64_RGBA;
+            }
+            break;
+        }
+    }
+
+    return SAIL_PIXEL_FORMAT_UNKNOWN;
+}
+
+/* All libpng calls that may jump are grouped here so no locals need to survive a longjmp. */
+static sail_status_t read_header(struct ico_png_state *state, png_uint_32 *width, png_uint_32 *height,
+                                    int *color_type, int *bit_depth) {
+
+    if (setjmp(png_jmpbuf(state->png_ptr))) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+    }
+
+    png_set_read_fn(state->png_ptr, state->io, my_read_fn);
+    png_read_info(state->png_ptr, state->info_ptr);
+
+    png_get_IHDR(state->png_ptr, state->info_ptr, width, height, bit_depth, color_type, NULL, NULL, NULL);
+
+    /* Expand everything to 8-bit RGBA. */
+    const bool has_trns = png_get_valid(state->png_ptr, state->info_ptr, PNG_INFO_tRNS) != 0;
+
+    if (*color_type == PNG_COLOR_TYPE_PALETTE) {
+        png_set_palette_to_rgb(state->png_ptr);
+    }
+    if (*color_type == PNG_COLOR_TYPE_GRAY && *bit_depth < 8) {
+        png_set_expand_gray_1_2_4_to_8(state->png_ptr);
+    }
+    if (has_trns) {
+        png_set_tRNS_to_alpha(state->png_ptr);
+    }
+    if (*bit_depth == 16) {
+        png_set_strip_16(state->png_ptr);
+    }
+    if (*color_type == PNG_COLOR_TYPE_GRAY || *color_type == PNG_COLOR_TYPE_GRAY_ALPHA) {
+        png_set_gray_to_rgb(state->png_ptr);
+    }
+    if ((*color_type & PNG_COLOR_MASK_ALPHA) == 0 && !has_trns) {
+        png_set_add_alpha(state->png_ptr, 0xff, PNG_FILLER_AFTER);
+    }
+
+    state->interlaced_passes = png_set_interlace_handling(state->png_ptr);
+
+    png_read_update_info(state->png_ptr, state->info_ptr);
+
+    return SAIL_OK;
+}
+
+sail_status_t ico_private_png_read_init(struct sail_io *io, size_t offset, size_t size,
+                                        const struct sail_load_options *load_options,
+                                        struct ico_png_state **state, struct sail_image **image) {
+
+    void *ptr;
+    SAIL_TRY(sail_malloc(sizeof(struct ico_png_state), &ptr));
+    struct ico_png_state *state_local = ptr;
+
+    *state_local = (struct ico_png_state) {
+        .io                = NULL,
+        .png_ptr           = NULL,
+        .info_ptr          = NULL,
+        .interlaced_passes = 1,
+    };
+
+    SAIL_TRY_OR_CLEANUP(ico_private_alloc_io_view(io, offset, size, &state_local->io),
+                        /* cleanup */ ico_private_png_read_finish(&state_local));
+
+    if ((state_local->png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, my_error_fn, my_warning_fn)) == NULL ||
+            (state_local->info_ptr = png_create_info_struct(state_local->png_ptr)) == NULL) {
+        ico_private_png_read_finish(&state_local);
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+    }
+
+    png_uint_32 width;
+    png_uint_32 height;
+    int color_type;
+    int bit_depth;
+    SAIL_TRY_OR_CLEANUP(read_header(state_local, &width, &height, &color_type, &bit_depth),
+                        /* cleanup */ ico_private_png_read_finish(&state_local));
+
+    struct sail_image *image_local;
+    SAIL_TRY_OR_CLEANUP(sail_alloc_image(&image_local),
+                        /* cleanup */ ico_private_png_read_finish(&state_local));
+
+    image_local->width          = width;
+    image_local->height         = height;
+    image_local->pixel_format   = SAIL_PIXEL_FORMAT_BPP32_RGBA;
+    image_local->bytes_per_line = sail_bytes_per_line(image_local->width, image_local->pixel_format);
+
+    if (load_options->options & SAIL_OPTION_SOURCE_IMAGE) {
+        SAIL_TRY_OR_CLEANUP(sail_alloc_source_image(&image_local->source_image),
+                            /* cleanup */ sail_destroy_image(image_local),
+                                          ico_private_png_read_finish(&state_local));
+
+        image_local->source_image->pixel_format = png_color_type_to_pixel_format(color_type, bit_depth);
+        image_local->source_image->compression  = SAIL_COMPRESSION_DEFLATE;
+        image_local->source_image->interlaced   = state_local->interlaced_passes > 1;
+    }
+
+    *state = state_local;
+    *image = image_local;
+
+    return SAIL_OK;
+}
+
+sail_status_t ico_private_png_read_frame(struct ico_png_state *state, struct sail_image *image) {
+
+    if (setjmp(png_jmpbuf(state->png_ptr))) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+    }
+
+    for (int current_pass = 0; current_pass < state->interlaced_passes; current_pass++) {
+        for (unsigned row = 0; row < image->height; row++) {
+            png_read_row(state->png_ptr, sail_scan_line(image, row), NULL);
+        }
+    }
+
+    return SAIL_OK;
+}
+
+void ico_private_png_read_finish(struct ico_png_state **state) {
+
+    if (*state == NULL) {
+        return;
+    }
+
+    if ((*state)->png_ptr != NULL) {
+        png_destroy_read_struct(&(*state)->png_ptr, ((*state)->info_ptr != NULL) ? &(*state)->info_ptr : NULL, NULL);
+    }
+
+    sail_destroy_io((*state)->io);
+
+    sail_free(*state);
+    *state = NULL;
+}
@@ -0,0 +1,51 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_ICO_PNG_ENTRY_H
+#define SAIL_ICO_PNG_ENTRY_H
+
+#include <stddef.h>
+
+#include <sail-common/export.h>
+#include <sail-common/status.h>
+
+struct ico_png_state;
+struct sail_image;
+struct sail_io;
+struct sail_load_options;
+
+/*
+ * Starts decoding a PNG image stored in the [offset, offset + size) range of the I/O.
+ * The image is read in place through a bounded I/O view and always returned as BPP32-RGBA.
+ */
+SAIL_HIDDEN sail_status_t ico_private_png_read_init(struct sail_io *io, size_t offset, size_t size,
+                                                    const struct sail_load_options *load_options,
+                                                    struct ico_png_state **state, struct sail_image **image);
+
+SAIL_HIDDEN sail_status_t ico_private_png_read_frame(struct ico_png_state *state, struct sail_image *image);
+
+SAIL_HIDDEN void ico_private_png_read_finish(struct ico_png_state **state);
+
+#endif
@@ -32,6 +32,8 @@
 
 #include "helpers.h"
 
+static const unsigned char EXIF_HEADER[] = { 'E', 'x', 'i', 'f', 0, 0 };
+
 void jpeg_private_my_output_message(j_common_ptr cinfo) {
     char buffer[JMSG_LENGTH_MAX];
 
@@ -89,6 +91,8 @@ J_COLOR_SPACE jpeg_private_pixel_format_to_color_space(enum SailPixelFormat pixe
 #endif
 
         case SAIL_PIXEL_FORMAT_BPP24_YCBCR:     return JCS_YCbCr;
+        case SAIL_PIXEL_FORMAT_BPP12_YUV420P:   return JCS_YCbCr;
+        case SAIL_PIXEL_FORMAT_BPP16_YUV422P:   return JCS_YCbCr;
         case SAIL_PIXEL_FORMAT_BPP32_CMYK:      return JCS_CMYK;
         case SAIL_PIXEL_FORMAT_BPP32_YCCK:      return JCS_YCCK;
 
@@ -112,6 +116,19 @@ sail_status_t jpeg_private_fetch_meta_data(struct jpeg_decompress_struct *decomp
             SAIL_TRY_OR_CLEANUP(sail_set_variant_substring(meta_data_node->meta_data->value, (const char *)it->data, it->data_length),
                                 /* cleanup */ sail_destroy_meta_data_node(meta_data_node));
 
+            *last_meta_data_node = meta_data_node;
+            last_meta_data_node = &meta_data_node->next;
+        } else if (it->marker == JPEG_APP0 + 1 && it->data_length > sizeof(EXIF_HEADER) && memcmp(it->data, EXIF_HEADER, sizeof(EXIF_HEADER)) == 0) {
+            struct sail_meta_data_node *meta_data_node;
+            SAIL_TRY(sail_alloc_meta_data_node(&meta_data_node));
+
+            SAIL_TRY_OR_CLEANUP(sail_alloc_meta_data_and_value_from_known_key(SAIL_META_DATA_EXIF, &meta_data_node->meta_data),
+                                /* cleanup */ sail_destroy_meta_data_node(meta_data_node));
+            SAIL_TRY_OR_CLEANUP(sail_set_variant_data(meta_data_node->meta_data->value,
+                                                        it->data + sizeof(EXIF_HEADER),
+                                                        it->data_length - sizeof(EXIF_HEADER)),
+                                /* cleanup */ sail_destroy_meta_data_node(meta_data_node));
+
             *last_meta_data_node = meta_data_node;
             last_meta_data_node = &meta_data_node->next;
         }
@@ -152,11 +169,14 @@ sail_status_t jpeg_private_fetch_iccp(struct jpeg_decompress_struct *decompress_
                    jpeg_read_icc_profile(decompress_context, &data, &data_size)
                    ? "" : "not ");
 
+    /* libjpeg allocates the profile with malloc(), so it must not be freed with sail_free(). */
     if (data != NULL && data_size > 0) {
-        SAIL_TRY_OR_CLEANUP(sail_alloc_iccp_from_shallow_data(data, data_size, iccp),
-                            /* cleanup */ sail_free(data));
+        SAIL_TRY_OR_CLEANUP(sail_alloc_iccp_from_data(data, data_size, iccp),
+                            /* cleanup */ free(data));
     }
 
+    free(data);
+
     return SAIL_OK;
 }
 #endif
@@ -250,7 +270,268 @@ bool jpeg_private_tuning_key_value_callback(const char *key, const struct sail_v
             SAIL_LOG_TRACE("JPEG: Smoothing the image");
             compress_context->smoothing_factor = sail_variant_to_unsigned_int(value);
         }
+    } else if (strcmp(key, "jpeg-progressive") == 0) {
+        if (value->type == SAIL_VARIANT_TYPE_BOOL) {
+            if (sail_variant_to_bool(value)) {
+                SAIL_LOG_TRACE("JPEG: Progressive coding");
+                jpeg_simple_progression(compress_context);
+            }
+        }
+    } else if (strcmp(key, "jpeg-restart-interval") == 0) {
+        if (value->type == SAIL_VARIANT_TYPE_UNSIGNED_INT) {
+            const unsigned restart_rows = sail_variant_to_unsigned_int(value);
+
+            if (restart_rows <= 65535) {
+                SAIL_LOG_TRACE("JPEG: Restart interval: %u MCU row(s)", restart_rows);
+                compress_context->restart_interval = 0;
+                compress_context->restart_in_rows  = (int)restart_rows;
+            } else {
+                SAIL_LOG_ERROR("JPEG: Restart interval must be in the range [0; 65535]");
+            }
+        }
+    } else if (strcmp(key, "jpeg-chroma-subsampling") == 0) {
+        if (value->type == SAIL_VARIANT_TYPE_STRING) {
+            /* Raw planar input is already subsampled. */
+            if (compress_context->jpeg_color_space != JCS_YCbCr || compress_context->raw_data_in) {
+                SAIL_LOG_TRACE("JPEG: Chroma subsampling is ignored for this pixel format");
+                return true;
+            }
+
+            const char *str_value = sail_variant_to_string(value);
+            int h_samp_factor;
+            int v_samp_factor;
+
+            if (strcmp(str_value, "444") == 0) {
+                h_samp_factor = 1;
+                v_samp_factor = 1;
+            } else if (strcmp(str_value, "422") == 0) {
+                h_samp_factor = 2;
+                v_samp_factor = 1;
+            } else if (strcmp(str_value, "420") == 0) {
+                h_samp_factor = 2;
+                v_samp_factor = 2;
+            } else {
+                SAIL_LOG_ERROR("JPEG: Unsupported chroma subsampling '%s'", str_value);
+                return true;
+            }
+
+            SAIL_LOG_TRACE("JPEG: Chroma subsampling: %s", str_value);
+            compress_context->comp_info[0].h_samp_factor = h_samp_factor;
+            compress_context->comp_info[0].v_samp_factor = v_samp_factor;
+        }
+    }
+
+    return true;
+}
+
+bool jpeg_private_load_tuning_key_value_callback(const char *key, const struct sail_variant *value, void *user_data) {
+
+    struct jpeg_private_load_tuning *load_tuning = user_data;
+
+    if (strcmp(key, "jpeg-planar-yuv") == 0) {
+        if (value->type == SAIL_VARIANT_TYPE_BOOL) {
+            load_tuning->planar_yuv = sail_variant_to_bool(value);
+            SAIL_LOG_TRACE("JPEG: Planar YUV: %s", load_tuning->planar_yuv ? "yes" : "no");
+        }
+    } else if (strcmp(key, "jpeg-threads") == 0) {
+        if (value->type == SAIL_VARIANT_TYPE_UNSIGNED_INT) {
+            load_tuning->threads = sail_variant_to_unsigned_int(value);
+            SAIL_LOG_TRACE("JPEG: Threads: %u", load_tuning->threads);
+        }
     }
 
     return true;
 }
+
+enum SailPixelFormat jpeg_private_raw_pixel_format(const struct jpeg_decompress_struct *decompress_context) {
+
+    if (decompress_context->num_components != 3 || decompress_context->jpeg_color_space != JCS_YCbCr) {
+        return SAIL_PIXEL_FORMAT_UNKNOWN;
+    }
+
+    const jpeg_component_info *comp_info = decompress_context->comp_info;
+
+    for (int c = 1; c < 3; c++) {
+        if (comp_info[c].h_samp_factor != 1 || comp_info[c].v_samp_factor != 1) {
+            return SAIL_PIXEL_FORMAT_UNKNOWN;
+        }
+    }
+
+    if (comp_info[0].h_samp_factor != 2) {
+        return SAIL_PIXEL_FORMAT_UNKNOWN;
+    }
+
+    switch (comp_info[0].v_samp_factor) {
+        case 2:  return SAIL_PIXEL_FORMAT_BPP12_YUV420P;
+        case 1:  return SAIL_PIXEL_FORMAT_BPP16_YUV422P;
+        default: return SAIL_PIXEL_FORMAT_UNKNOWN;
+    }
+}
+
+void jpeg_private_set_raw_sampling(struct jpeg_compress_struct *compress_context, enum SailPixelFormat pixel_format) {
+
+    compress_context->raw_data_in = true;
+
+    compress_context->comp_info[0].h_samp_factor = 2;
+    compress_context->comp_info[0].v_samp_factor = (pixel_format == SAIL_PIXEL_FORMAT_BPP12_YUV420P) ? 2 : 1;
+
+    for (int c = 1; c < 3; c++) {
+        compress_context->comp_info[c].h_samp_factor = 1;
+        compress_context->comp_info[c].v_samp_factor = 1;
+    }
+}
+
+size_t jpeg_private_raw_buffer_size(const jpeg_component_info *comp_info) {
+
+    size_t size = 0;
+
+    for (int c = 0; c < 3; c++) {
+        size += (size_t)comp_info[c].v_samp_factor * DCTSIZE * comp_info[c].width_in_blocks * DCTSIZE;
+    }
+
+    return size;
+}
+
+/*
+ * Points the rows of every component into the buffer. Every component gets v_samp_factor * DCTSIZE
+ * rows padded to whole blocks as required by jpeg_read_raw_data() and jpeg_write_raw_data().
+ */
+static void setup_raw_rows(const jpeg_component_info *comp_info, unsigned char *buffer,
+                            JSAMPROW rows[3][2 * DCTSIZE], JSAMPARRAY data[3]) {
+
+    for (int c = 0; c < 3; c++) {
+        const size_t padded_width = (size_t)comp_info[c].width_in_blocks * DCTSIZE;
+
+        for (int r = 0; r < comp_info[c].v_samp_factor * DCTSIZE; r++) {
+            rows[c][r] = buffer;
+            buffer += padded_width;
+        }
+
+        data[c] = rows[c];
+    }
+}
+
+sail_status_t jpeg_private_read_raw_yuv(struct jpeg_decompress_struct *decompress_context, unsigned char *buffer, struct sail_image *image) {
+
+    struct sail_plane planes[3];
+    unsigned planes_count;
+    SAIL_TRY(sail_image_planes(image, planes, &planes_count));
+
+    JSAMPROW rows[3][2 * DCTSIZE];
+    JSAMPARRAY data[3];
+    setup_raw_rows(decompress_context->comp_info, buffer, rows, data);
+
+    const unsigned lines_per_imcu_row = (unsigned)decompress_context->max_v_samp_factor * DCTSIZE;
+
+    while (decompress_context->output_scanline < decompress_context->output_height) {
+        const unsigned imcu_row = decompress_context->output_scanline / lines_per_imcu_row;
+
+        (void)jpeg_read_raw_data(decompress_context, data, lines_per_imcu_row);
+
+        for (unsigned c = 0; c < planes_count; c++) {
+            const unsigned plane_rows = (unsigned)decompress_context->comp_info[c].v_samp_factor * DCTSIZE;
+
+            for (unsigned r = 0, row = imcu_row * plane_rows; r < plane_rows && row < planes[c].height; r++, row++) {
+                memcpy((unsigned char *)planes[c].pixels + (size_t)row * planes[c].bytes_per_line, rows[c][r], planes[c].width);
+            }
+        }
+    }
+
+    return SAIL_OK;
+}
+
+sail_status_t jpeg_private_write_raw_yuv(struct jpeg_compress_struct *compress_context, unsigned char *buffer, const struct sail_image *image) {
+
+    struct sail_plane planes[3];
+    unsigned planes_count;
+    SAIL_TRY(sail_image_planes(image, planes, &planes_count));
+
+    JSAMPROW rows[3][2 * DCTSIZE];
+    JSAMPARRAY data[3];
+    setup_raw_rows(compress_context->comp_info, buffer, rows, data);
+
+    const unsigned lines_per_imcu_row = (unsigned)compress_context->max_v_samp_factor * DCTSIZE;
+
+    while (compress_context->next_scanline < compress_context->image_height) {
+        const unsigned imcu_row = compress_context->next_scanline / lines_per_imcu_row;
+
+        /* Replicate the edge samples into the padding. */
+        for (unsigned c = 0; c < planes_count; c++) {
+            const unsigned plane_rows   = (unsigned)compress_context->comp_info[c].v_samp_factor * DCTSIZE;
+            const unsigned padded_width = compress_context->comp_info[c].width_in_blocks * DCTSIZE;
+
+            for (unsigned r = 0; r < plane_rows; r++) {
+                unsigned row = imcu_row * plane_rows + r;
+
+                if (row >= planes[c].height) {
+                    row = planes[c].height - 1;
+                }
+
+                const unsigned char *scan = (const unsigned char *)planes[c].pixels + (size_t)row * planes[c].bytes_per_line;
+
+                memcpy(rows[c][r], scan, planes[c].width);
+                memset(rows[c][r] + planes[c].width, scan[planes[c].width - 1], padded_width - planes[c].width);
+            }
+        }
+
+        (void)jpeg_write_raw_data(compress_context, data, lines_per_imcu_row);
+    }
+
+    return SAIL_OK;
+}
+
+enum SailOrientation jpeg_private_fetch_orientation(struct jpeg_decompress_struct *decompress_context) {
+
+    for (jpeg_saved_marker_ptr it = decompress_context->marker_list; it != NULL; it = it->next) {
+        if (it->marker == JPEG_APP0 + 1 && it->data_length > sizeof(EXIF_HEADER) && memcmp(it->data, EXIF_HEADER, sizeof(EXIF_HEADER)) == 0) {
+            enum SailOrientation orientation;
+
+            if (sail_exif_orientation(it->data, it->data_length, &orientation) == SAIL_OK) {
+                return orientation;
+            }
+        }
+    }
+
+    return SAIL_ORIENTATION_NORMAL;
+}
+
+bool jpeg_private_is_transposing_orientation(enum SailOrientation orientation) {
+
+    return orientation == SAIL_ORIENTATION_ROTATED_90 ||
+            orientation == SAIL_ORIENTATION_ROTATED_270 ||
+            orientation == SAIL_ORIENTATION_MIRRORED_HORIZONTALLY_ROTATED_90 ||
+            orientation == SAIL_ORIENTATION_MIRRORED_HORIZONTALLY_ROTATED_270;
+}
+
+void jpeg_private_mirror_row(unsigned char *scan, unsigned width, unsigned components) {
+
+    for (unsigned char *left = scan, *right = scan + (size_t)(width - 1) * components; left < right; left += components, right -= components) {
+        for (unsigned i = 0; i < components; i++) {
+            const unsigned char c = left[i];
+            left[i] = right[i];
+            right[i] = c;
+        }
+    }
+}
+
+void jpeg_private_transpose_rows(const unsigned char *rows, unsigned rows_count, unsigned first_row,
+                                    unsigned input_width, unsigned input_height, unsigned components,
+                                    enum SailOrientation orientation, struct sail_image *image) {
+
+    const bool flip_x = orientation == SAIL_ORIENTATION_ROTATED_270 || orientation == SAIL_ORIENTATION_MIRRORED_HORIZONTALLY_ROTATED_90;
+    const bool flip_y = orientation == SAIL_ORIENTATION_ROTATED_90  || orientation == SAIL_ORIENTATION_MIRRORED_HORIZONTALLY_ROTATED_90;
+    const size_t input_bytes_per_line = (size_t)input_width * components;
+
+    /* Every input column becomes an output row. Input rows of the strip are adjacent output pixels. */
+    for (unsigned column = 0; column < input_width; column++) {
+        unsigned char *output_scan = sail_scan_line(image, flip_x ? input_width - 1 - column : column);
+        const unsigned char *input = rows + (size_t)column * components;
+
+        for (unsigned r = 0; r < rows_count; r++) {
+            const unsigned row = first_row + r;
+            const unsigned output_column = flip_y ? input_height - 1 - row : row;
+
+            memcpy(output_scan + (size_t)output_column * components, input + r * input_bytes_per_line, components);
+        }
+    }
+}
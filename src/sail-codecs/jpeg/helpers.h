@@ -28,6 +28,7 @@
 
 #include <setjmp.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdio.h>
 
 #include <jpeglib.h>
@@ -35,6 +36,7 @@
 #include <sail-common/common.h>
 #include <sail-common/export.h>
 
+struct sail_image;
 struct sail_meta_data_node;
 struct sail_resolution;
 
@@ -43,6 +45,14 @@ struct jpeg_private_my_error_context {
     jmp_buf setjmp_buffer;
 };
 
+/* Load tuning. */
+struct jpeg_private_load_tuning {
+    /* Return the YCbCr samples as is in planar YUV pixel formats. */
+    bool planar_yuv;
+    /* Number of threads to decode restart intervals with. 0 means the OpenMP default. */
+    unsigned threads;
+};
+
 SAIL_HIDDEN void jpeg_private_my_output_message(j_common_ptr cinfo);
 
 SAIL_HIDDEN void jpeg_private_my_error_exit(j_common_ptr cinfo);
@@ -63,6 +73,33 @@ SAIL_HIDDEN sail_status_t jpeg_private_fetch_resolution(struct jpeg_decompress_s
 
 SAIL_HIDDEN sail_status_t jpeg_private_write_resolution(struct jpeg_compress_struct *compress_context, const struct sail_resolution *resolution);
 
+/* Returns the orientation from the saved EXIF marker. */
+SAIL_HIDDEN enum SailOrientation jpeg_private_fetch_orientation(struct jpeg_decompress_struct *decompress_context);
+
+SAIL_HIDDEN bool jpeg_private_is_transposing_orientation(enum SailOrientation orientation);
+
+SAIL_HIDDEN void jpeg_private_mirror_row(unsigned char *scan, unsigned width, unsigned components);
+
+/* Writes the decoded input rows into the output image columns according to the orientation. */
+SAIL_HIDDEN void jpeg_private_transpose_rows(const unsigned char *rows, unsigned rows_count, unsigned first_row,
+                                                unsigned input_width, unsigned input_height, unsigned components,
+                                                enum SailOrientation orientation, struct sail_image *image);
+
 SAIL_HIDDEN bool jpeg_private_tuning_key_value_callback(const char *key, const struct sail_variant *value, void *user_data);
 
+SAIL_HIDDEN bool jpeg_private_load_tuning_key_value_callback(const char *key, const struct sail_variant *value, void *user_data);
+
+/* Returns the planar pixel format to read the YCbCr samples in as is, or SAIL_PIXEL_FORMAT_UNKNOWN. */
+SAIL_HIDDEN enum SailPixelFormat jpeg_private_raw_pixel_format(const struct jpeg_decompress_struct *decompress_context);
+
+/* Enables raw data input with the sampling factors of the planar pixel format. */
+SAIL_HIDDEN void jpeg_private_set_raw_sampling(struct jpeg_compress_struct *compress_context, enum SailPixelFormat pixel_format);
+
+/* Returns the size of the buffer needed to read or write one iMCU row of raw data. */
+SAIL_HIDDEN size_t jpeg_private_raw_buffer_size(const jpeg_component_info *comp_info);
+
+SAIL_HIDDEN sail_status_t jpeg_private_read_raw_yuv(struct jpeg_decompress_struct *decompress_context, unsigned char *buffer, struct sail_image *image);
+
+SAIL_HIDDEN sail_status_t jpeg_private_write_raw_yuv(struct jpeg_compress_struct *compress_context, unsigned char *buffer, const struct sail_image *image);
+
 #endif
@@ -31,11 +31,16 @@
 
 #include <jpeglib.h>
 
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
 #include <sail-common/sail-common.h>
 
 #include "helpers.h"
 #include "io_dest.h"
 #include "io_src.h"
+#include "restart.h"
 
 /*
  * Codec-specific data types.
@@ -45,6 +50,12 @@ static const double COMPRESSION_MIN     = 0;
 static const double COMPRESSION_MAX     = 100;
 static const double COMPRESSION_DEFAULT = 15;
 
+/* Number of rows decoded at once when the orientation requires transposing. */
+static const unsigned TRANSPOSE_STRIP_HEIGHT = 16;
+
+/* Smaller images are decoded serially even with restart markers. */
+static const size_t PARALLEL_MIN_PIXELS = 1024 * 1024;
+
 /*
  * Codec-specific state.
  */
@@ -53,6 +64,10 @@ struct jpeg_state {
     const struct sail_load_options *load_options;
     const struct sail_save_options *save_options;
 
+    /* The source I/O and the start of the image in it when it's seekable, or NULL. */
+    struct sail_io *io;
+    size_t io_start;
+
     struct jpeg_decompress_struct *decompress_context;
     struct jpeg_compress_struct *compress_context;
     struct jpeg_private_my_error_context error_context;
@@ -60,6 +75,21 @@ struct jpeg_state {
     bool frame_loaded;
     bool frame_saved;
     bool started_compress;
+
+    /* The EXIF orientation applied while decoding. */
+    enum SailOrientation orientation;
+    unsigned char *transpose_strip;
+
+    struct jpeg_private_load_tuning load_tuning;
+    /* Planar pixel format of raw YCbCr samples, or SAIL_PIXEL_FORMAT_UNKNOWN. */
+    enum SailPixelFormat raw_pixel_format;
+    unsigned char *raw_buffer;
+
+    /* Region of interest clipped to the frame. */
+    struct sail_region region;
+    /* Decoded rows of a partial region and the number of columns to skip in them. */
+    unsigned char *region_row;
+    unsigned region_offset;
 };
 
 static sail_status_t alloc_jpeg_state(const struct sail_load_options *load_options,
@@ -74,12 +104,29 @@ static sail_status_t alloc_jpeg_state(const struct sail_load_options *load_optio
         .load_options = load_options,
         .save_options = save_options,
 
+        .io       = NULL,
+        .io_start = 0,
+
         .decompress_context = NULL,
         .compress_context   = NULL,
         .libjpeg_error      = false,
         .frame_loaded       = false,
         .frame_saved        = false,
         .started_compress   = false,
+
+        .orientation     = SAIL_ORIENTATION_NORMAL,
+        .transpose_strip = NULL,
+
+        .load_tuning = {
+            .planar_yuv = false,
+            .threads    = 0,
+        },
+        .raw_pixel_format = SAIL_PIXEL_FORMAT_UNKNOWN,
+        .raw_buffer       = NULL,
+
+        .region        = { 0, 0, 0, 0 },
+        .region_row    = NULL,
+        .region_offset = 0,
     };
 
     return SAIL_OK;
@@ -93,10 +140,107 @@ static void destroy_jpeg_state(struct jpeg_state *jpeg_state) {
 
     sail_free(jpeg_state->decompress_context);
     sail_free(jpeg_state->compress_context);
+    sail_free(jpeg_state->transpose_strip);
+    sail_free(jpeg_state->raw_buffer);
+    sail_free(jpeg_state->region_row);
 
     sail_free(jpeg_state);
 }
 
+/* Restricts decoding to the columns of the region where libjpeg allows it. */
+static sail_status_t start_region_decoding(struct jpeg_state *jpeg_state) {
+
+    struct jpeg_decompress_struct *decompress_context = jpeg_state->decompress_context;
+
+#ifdef SAIL_HAVE_JPEG_CROP
+    /* libjpeg-turbo aligns the cropped columns to iMCU boundaries. */
+    JDIMENSION xoffset = jpeg_state->region.x;
+    JDIMENSION width   = jpeg_state->region.width;
+    jpeg_crop_scanline(decompress_context, &xoffset, &width);
+
+    jpeg_state->region_offset = jpeg_state->region.x - xoffset;
+#else
+    jpeg_state->region_offset = jpeg_state->region.x;
+#endif
+
+    void *ptr;
+    SAIL_TRY(sail_malloc((size_t)decompress_context->output_width * decompress_context->output_components, &ptr));
+    jpeg_state->region_row = ptr;
+
+    return SAIL_OK;
+}
+
+static void skip_region_scanlines(struct jpeg_state *jpeg_state) {
+
+#ifdef SAIL_HAVE_JPEG_CROP
+    (void)jpeg_skip_scanlines(jpeg_state->decompress_context, jpeg_state->region.y);
+#else
+    for (unsigned row = 0; row < jpeg_state->region.y; row++) {
+        JSAMPROW samprow = (JSAMPROW)jpeg_state->region_row;
+        (void)jpeg_read_scanlines(jpeg_state->decompress_context, &samprow, 1);
+    }
+#endif
+}
+
+/* Reads the next scan line of the region. */
+static void read_region_scanline(struct jpeg_state *jpeg_state, unsigned char *scanline, unsigned components) {
+
+    if (jpeg_state->region_row == NULL) {
+        JSAMPROW samprow = (JSAMPROW)scanline;
+        (void)jpeg_read_scanlines(jpeg_state->decompress_context, &samprow, 1);
+        return;
+    }
+
+    JSAMPROW samprow = (JSAMPROW)jpeg_state->region_row;
+    (void)jpeg_read_scanlines(jpeg_state->decompress_context, &samprow, 1);
+
+    memcpy(scanline,
+            jpeg_state->region_row + (size_t)jpeg_state->region_offset * components,
+            (size_t)jpeg_state->region.width * components);
+}
+
+#ifdef _OPENMP
+/*
+ * Decodes bands of MCU rows split at restart markers in parallel. Sets 'decoded' to false
+ * when the image cannot be decoded this way, and the caller should continue decoding serially.
+ */
+static sail_status_t decode_in_parallel(struct jpeg_state *jpeg_state, struct sail_image *image, bool *decoded) {
+
+    *decoded = false;
+
+    const int threads = jpeg_state->load_tuning.threads > 0 ? (int)jpeg_state->load_tuning.threads : omp_get_max_threads();
+
+    if (threads < 2
+            || jpeg_state->io == NULL
+            || (size_t)image->width * image->height < PARALLEL_MIN_PIXELS
+            || !jpeg_private_has_row_restarts(jpeg_state->decompress_context)) {
+        return SAIL_OK;
+    }
+
+    /* The bands need the headers and the whole entropy-coded data. */
+    struct sail_io *io = jpeg_state->io;
+    size_t offset;
+    SAIL_TRY(io->tell(io->stream, &offset));
+    SAIL_TRY(io->seek(io->stream, (long)jpeg_state->io_start, SEEK_SET));
+
+    void *data;
+    size_t data_size;
+    SAIL_TRY(sail_alloc_data_from_io_contents(io, &data, &data_size));
+
+    SAIL_TRY_OR_CLEANUP(jpeg_private_decode_restart_bands(data, data_size, jpeg_state->decompress_context, threads, image, decoded),
+                        /* cleanup */ sail_free(data));
+
+    sail_free(data);
+
+    /* Continue serial decoding from where it was. */
+    if (!*decoded) {
+        SAIL_TRY(io->seek(io->stream, (long)offset, SEEK_SET));
+    }
+
+    return SAIL_OK;
+}
+#endif
+
 /*
  * Decoding functions.
  */
@@ -125,6 +269,11 @@ SAIL_EXPORT sail_status_t sail_codec_load_init_v8_jpeg(struct sail_io *io, const
         SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
     }
 
+    /* Remember the start of the image to decode restart intervals in parallel later. */
+    if (io->features & SAIL_IO_FEATURE_SEEKABLE && io->tell(io->stream, &jpeg_state->io_start) == SAIL_OK) {
+        jpeg_state->io = io;
+    }
+
     /* JPEG setup. */
     jpeg_create_decompress(jpeg_state->decompress_context);
     jpeg_private_sail_io_src(jpeg_state->decompress_context, io);
@@ -132,14 +281,57 @@ SAIL_EXPORT sail_status_t sail_codec_load_init_v8_jpeg(struct sail_io *io, const
     if (jpeg_state->load_options->options & SAIL_OPTION_META_DATA) {
         jpeg_save_markers(jpeg_state->decompress_context, JPEG_COM, 0xffff);
     }
+    if (jpeg_state->load_options->options & (SAIL_OPTION_META_DATA | SAIL_OPTION_APPLY_ORIENTATION)) {
+        jpeg_save_markers(jpeg_state->decompress_context, JPEG_APP0 + 1, 0xffff);
+    }
     if (jpeg_state->load_options->options & SAIL_OPTION_ICCP) {
         jpeg_save_markers(jpeg_state->decompress_context, JPEG_APP0 + 2, 0xFFFF);
     }
 
     jpeg_read_header(jpeg_state->decompress_context, true);
 
+    /* Handle tuning. */
+    if (jpeg_state->load_options->tuning != NULL) {
+        sail_traverse_hash_map_with_user_data(jpeg_state->load_options->tuning, jpeg_private_load_tuning_key_value_callback, &jpeg_state->load_tuning);
+    }
+
+    SAIL_TRY(sail_clip_region(&jpeg_state->load_options->region,
+                                jpeg_state->decompress_context->image_width,
+                                jpeg_state->decompress_context->image_height,
+                                &jpeg_state->region));
+
+    const bool partial_region = jpeg_state->region.width  != jpeg_state->decompress_context->image_width
+                                || jpeg_state->region.height != jpeg_state->decompress_context->image_height;
+
+    if (partial_region && jpeg_state->load_tuning.planar_yuv) {
+        SAIL_LOG_DEBUG("JPEG: Planar YUV is not available for regions, decoding to RGB");
+        jpeg_state->load_tuning.planar_yuv = false;
+    }
+
+    /* Apply the EXIF orientation while decoding instead of rotating the decoded image. */
+    if (jpeg_state->load_options->options & SAIL_OPTION_APPLY_ORIENTATION) {
+        jpeg_state->orientation = jpeg_private_fetch_orientation(jpeg_state->decompress_context);
+    }
+
+    /* Planar samples cannot be rotated. */
+    if (jpeg_state->orientation != SAIL_ORIENTATION_NORMAL && jpeg_state->load_tuning.planar_yuv) {
+        SAIL_LOG_DEBUG("JPEG: Planar YUV is not available when applying the orientation, decoding to RGB");
+        jpeg_state->load_tuning.planar_yuv = false;
+    }
+
+    if (jpeg_state->load_tuning.planar_yuv) {
+        jpeg_state->raw_pixel_format = jpeg_private_raw_pixel_format(jpeg_state->decompress_context);
+
+        if (jpeg_state->raw_pixel_format == SAIL_PIXEL_FORMAT_UNKNOWN) {
+            SAIL_LOG_DEBUG("JPEG: Planar YUV is not available for this chroma subsampling, decoding to RGB");
+        }
+    }
+
     /* Handle the requested color space. */
-    if (jpeg_state->decompress_context->jpeg_color_space == JCS_YCbCr) {
+    if (jpeg_state->raw_pixel_format != SAIL_PIXEL_FORMAT_UNKNOWN) {
+        jpeg_state->decompress_context->out_color_space = JCS_YCbCr;
+        jpeg_state->decompress_context->raw_data_out    = true;
+    } else if (jpeg_state->decompress_context->jpeg_color_space == JCS_YCbCr) {
         jpeg_state->decompress_context->out_color_space = JCS_RGB;
     } else {
         jpeg_state->decompress_context->out_color_space = jpeg_state->decompress_context->jpeg_color_space;
@@ -151,6 +343,10 @@ SAIL_EXPORT sail_status_t sail_codec_load_init_v8_jpeg(struct sail_io *io, const
     /* Launch decompression! */
     jpeg_start_decompress(jpeg_state->decompress_context);
 
+    if (partial_region) {
+        SAIL_TRY(start_region_decoding(jpeg_state));
+    }
+
     return SAIL_OK;
 }
 
@@ -178,24 +374,44 @@ SAIL_EXPORT sail_status_t sail_codec_load_seek_next_frame_v8_jpeg(void *state, s
 
         image_local->source_image->pixel_format = jpeg_private_color_space_to_pixel_format(jpeg_state->decompress_context->jpeg_color_space);
         image_local->source_image->compression  = SAIL_COMPRESSION_JPEG;
+        image_local->source_image->orientation  = jpeg_state->orientation;
     }
 
+    const bool transpose = jpeg_private_is_transposing_orientation(jpeg_state->orientation);
+
     /* Image properties. */
-    image_local->width          = jpeg_state->decompress_context->output_width;
-    image_local->height         = jpeg_state->decompress_context->output_height;
-    image_local->pixel_format   = jpeg_private_color_space_to_pixel_format(jpeg_state->decompress_context->out_color_space);
+    image_local->width          = transpose ? jpeg_state->region.height : jpeg_state->region.width;
+    image_local->height         = transpose ? jpeg_state->region.width  : jpeg_state->region.height;
+    image_local->pixel_format   = (jpeg_state->raw_pixel_format != SAIL_PIXEL_FORMAT_UNKNOWN)
+                                    ? jpeg_state->raw_pixel_format
+                                    : jpeg_private_color_space_to_pixel_format(jpeg_state->decompress_context->out_color_space);
     image_local->bytes_per_line = sail_bytes_per_line(image_local->width, image_local->pixel_format);
 
     /* Read meta data. */
     if (jpeg_state->load_options->options & SAIL_OPTION_META_DATA) {
         SAIL_TRY_OR_CLEANUP(jpeg_private_fetch_meta_data(jpeg_state->decompress_context, &image_local->meta_data_node),
                             /* cleanup */ sail_destroy_image(image_local));
+
+        /* The pixels will be upright. */
+        if (jpeg_state->orientation != SAIL_ORIENTATION_NORMAL) {
+            for (struct sail_meta_data_node *node = image_local->meta_data_node; node != NULL; node = node->next) {
+                if (node->meta_data->key == SAIL_META_DATA_EXIF) {
+                    sail_reset_exif_orientation(node->meta_data->value->value, node->meta_data->value->size);
+                }
+            }
+        }
     }
 
     /* Fetch resolution. */
     SAIL_TRY_OR_CLEANUP(jpeg_private_fetch_resolution(jpeg_state->decompress_context, &image_local->resolution),
                             /* cleanup */ sail_destroy_image(image_local));
 
+    if (transpose && image_local->resolution != NULL) {
+        const double x = image_local->resolution->x;
+        image_local->resolution->x = image_local->resolution->y;
+        image_local->resolution->y = x;
+    }
+
     /* Fetch ICC profile. */
 #ifdef SAIL_HAVE_JPEG_ICCP
     if (jpeg_state->load_options->options & SAIL_OPTION_ICCP) {
@@ -222,11 +438,76 @@ SAIL_EXPORT sail_status_t sail_codec_load_frame_v8_jpeg(void *state, struct sail
         SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
     }
 
-    for (unsigned row = 0; row < image->height; row++) {
-        unsigned char *scanline = sail_scan_line(image, row);
+    /* Read the YCbCr samples without upsampling and color conversion. */
+    if (jpeg_state->raw_pixel_format != SAIL_PIXEL_FORMAT_UNKNOWN) {
+        if (jpeg_state->raw_buffer == NULL) {
+            void *ptr;
+            SAIL_TRY(sail_malloc(jpeg_private_raw_buffer_size(jpeg_state->decompress_context->comp_info), &ptr));
+            jpeg_state->raw_buffer = ptr;
+        }
 
-        JSAMPROW samprow = (JSAMPROW)scanline;
-        (void)jpeg_read_scanlines(jpeg_state->decompress_context, &samprow, 1);
+        SAIL_TRY(jpeg_private_read_raw_yuv(jpeg_state->decompress_context, jpeg_state->raw_buffer, image));
+
+        return SAIL_OK;
+    }
+
+#ifdef _OPENMP
+    if (jpeg_state->region_row == NULL && jpeg_state->orientation == SAIL_ORIENTATION_NORMAL) {
+        bool decoded;
+        SAIL_TRY(decode_in_parallel(jpeg_state, image, &decoded));
+
+        if (decoded) {
+            return SAIL_OK;
+        }
+    }
+#endif
+
+    const unsigned width      = jpeg_state->region.width;
+    const unsigned height     = jpeg_state->region.height;
+    const unsigned components = (unsigned)jpeg_state->decompress_context->output_components;
+
+    if (jpeg_state->region_row != NULL) {
+        skip_region_scanlines(jpeg_state);
+    }
+
+    switch (jpeg_state->orientation) {
+        case SAIL_ORIENTATION_NORMAL:
+        case SAIL_ORIENTATION_MIRRORED_HORIZONTALLY:
+        case SAIL_ORIENTATION_MIRRORED_VERTICALLY:
+        case SAIL_ORIENTATION_ROTATED_180: {
+            const bool reverse_rows = jpeg_state->orientation == SAIL_ORIENTATION_MIRRORED_VERTICALLY   || jpeg_state->orientation == SAIL_ORIENTATION_ROTATED_180;
+            const bool mirror_rows  = jpeg_state->orientation == SAIL_ORIENTATION_MIRRORED_HORIZONTALLY || jpeg_state->orientation == SAIL_ORIENTATION_ROTATED_180;
+
+            for (unsigned row = 0; row < height; row++) {
+                unsigned char *scanline = sail_scan_line(image, reverse_rows ? height - 1 - row : row);
+
+                read_region_scanline(jpeg_state, scanline, components);
+
+                if (mirror_rows) {
+                    jpeg_private_mirror_row(scanline, width, components);
+                }
+            }
+            break;
+        }
+        default: {
+            /* Decode strips of rows and scatter them into the output columns. */
+            if (jpeg_state->transpose_strip == NULL) {
+                void *ptr;
+                SAIL_TRY(sail_malloc((size_t)TRANSPOSE_STRIP_HEIGHT * width * components, &ptr));
+                jpeg_state->transpose_strip = ptr;
+            }
+
+            for (unsigned row = 0; row < height; row += TRANSPOSE_STRIP_HEIGHT) {
+                const unsigned rows_count = (height - row < TRANSPOSE_STRIP_HEIGHT) ? height - row : TRANSPOSE_STRIP_HEIGHT;
+
+                for (unsigned r = 0; r < rows_count; r++) {
+                    read_region_scanline(jpeg_state, jpeg_state->transpose_strip + (size_t)r * width * components, components);
+                }
+
+                jpeg_private_transpose_rows(jpeg_state->transpose_strip, rows_count, row, width, height, components,
+                                            jpeg_state->orientation, image);
+            }
+        }
     }
 
     return SAIL_OK;
@@ -317,16 +598,23 @@ SAIL_EXPORT sail_status_t sail_codec_save_seek_next_frame_v8_jpeg(void *state, c
         SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
     }
 
+    const bool planar = sail_is_planar(image->pixel_format);
+
     /* Initialize compression. */
     jpeg_state->compress_context->image_width      = image->width;
     jpeg_state->compress_context->image_height     = image->height;
-    jpeg_state->compress_context->input_components = sail_bits_per_pixel(image->pixel_format) / 8;
+    jpeg_state->compress_context->input_components = planar ? 3 : (int)(sail_bits_per_pixel(image->pixel_format) / 8);
     jpeg_state->compress_context->in_color_space   = color_space;
     jpeg_state->compress_context->input_gamma      = image->gamma;
 
     jpeg_set_defaults(jpeg_state->compress_context);
     jpeg_set_colorspace(jpeg_state->compress_context, color_space);
 
+    /* Planar samples are already subsampled, pass them as is. */
+    if (planar) {
+        jpeg_private_set_raw_sampling(jpeg_state->compress_context, image->pixel_format);
+    }
+
     /* Save resolution. */
     SAIL_TRY(jpeg_private_write_resolution(jpeg_state->compress_context, image->resolution));
 
@@ -376,6 +664,18 @@ SAIL_EXPORT sail_status_t sail_codec_save_frame_v8_jpeg(void *state, const struc
         SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
     }
 
+    if (jpeg_state->compress_context->raw_data_in) {
+        if (jpeg_state->raw_buffer == NULL) {
+            void *ptr;
+            SAIL_TRY(sail_malloc(jpeg_private_raw_buffer_size(jpeg_state->compress_context->comp_info), &ptr));
+            jpeg_state->raw_buffer = ptr;
+        }
+
+        SAIL_TRY(jpeg_private_write_raw_yuv(jpeg_state->compress_context, jpeg_state->raw_buffer, image));
+
+        return SAIL_OK;
+    }
+
     for (unsigned row = 0; row < image->height; row++) {
         JSAMPROW samprow = (JSAMPROW)sail_scan_line(image, row);
         jpeg_write_scanlines(jpeg_state->compress_context, &samprow, 1);
@@ -0,0 +1,384 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <setjmp.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <jerror.h>
+
+#include <sail-common/sail-common.h>
+
+#include "helpers.h"
+#include "restart.h"
+
+/*
+ * Private functions.
+ */
+
+/* Offsets of the JPEG structures in the file. */
+struct restart_layout {
+    /* Size of the headers up to the end of the SOS segment. */
+    size_t header_size;
+    /* Offset of the 16-bit image height in the SOF segment. */
+    size_t sof_height_offset;
+    /* Offset of the marker that ends the entropy-coded data. */
+    size_t entropy_end;
+    /* Offsets of the restart markers that end every restart interval except the last one. */
+    size_t *markers;
+    unsigned markers_count;
+};
+
+/* Parameters of a band shared between all the decoding threads. */
+struct band_context {
+    const unsigned char *data;
+    const struct restart_layout *layout;
+    J_COLOR_SPACE out_color_space;
+    unsigned intervals;
+    unsigned interval_height;
+    struct sail_image *image;
+};
+
+static unsigned mcu_height(const struct jpeg_decompress_struct *decompress_context) {
+
+    return (decompress_context->comps_in_scan == 1) ? DCTSIZE : (unsigned)decompress_context->max_v_samp_factor * DCTSIZE;
+}
+
+static unsigned restart_intervals(const struct jpeg_decompress_struct *decompress_context) {
+
+    const size_t mcus = (size_t)decompress_context->MCUs_per_row * decompress_context->MCU_rows_in_scan;
+
+    return (unsigned)((mcus + decompress_context->restart_interval - 1) / decompress_context->restart_interval);
+}
+
+/* Finds the end of the headers and the restart markers. Returns false if the file layout is unexpected. */
+static bool find_restart_layout(const unsigned char *data, size_t data_size, struct restart_layout *layout) {
+
+    if (data_size < 4 || data[0] != 0xFF || data[1] != 0xD8 /* SOI */) {
+        return false;
+    }
+
+    layout->header_size       = 0;
+    layout->sof_height_offset = 0;
+
+    for (size_t pos = 2; pos + 4 <= data_size;) {
+        if (data[pos] != 0xFF) {
+            return false;
+        }
+
+        const unsigned char marker = data[pos + 1];
+
+        /* Fill bytes. */
+        if (marker == 0xFF) {
+            pos++;
+            continue;
+        }
+
+        const size_t length = ((size_t)data[pos + 2] << 8) | data[pos + 3];
+
+        if (length < 2 || pos + 2 + length > data_size) {
+            return false;
+        }
+
+        if (marker == 0xC0 || marker == 0xC1) {
+            /* Baseline and extended sequential Huffman SOF. */
+            if (length < 8) {
+                return false;
+            }
+            layout->sof_height_offset = pos + 5;
+        } else if (marker >= 0xC2 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+            /* Progressive, lossless, hierarchical, and arithmetic frames. */
+            return false;
+        } else if (marker == JPEG_EOI || (marker >= JPEG_RST0 && marker <= JPEG_RST0 + 7)) {
+            return false;
+        } else if (marker == 0xDA /* SOS */) {
+            layout->header_size = pos + 2 + length;
+            break;
+        }
+
+        pos += 2 + length;
+    }
+
+    if (layout->header_size == 0 || layout->sof_height_offset == 0) {
+        return false;
+    }
+
+    /* Stuffed zero bytes follow 0xFF in the entropy-coded data, so every other 0xFF starts a marker. */
+    unsigned markers_count = 0;
+
+    for (size_t pos = layout->header_size; pos + 1 < data_size; pos++) {
+        if (data[pos] != 0xFF) {
+            continue;
+        }
+
+        const unsigned char marker = data[pos + 1];
+
+        if (marker == 0x00) {
+            pos++;
+        } else if (marker == 0xFF) {
+            continue;
+        } else if (marker >= JPEG_RST0 && marker <= JPEG_RST0 + 7) {
+            if (markers_count == layout->markers_count) {
+                return false;
+            }
+            layout->markers[markers_count++] = pos;
+            pos++;
+        } else {
+            layout->entropy_end = pos;
+            return markers_count == layout->markers_count;
+        }
+    }
+
+    return false;
+}
+
+/* Minimal memory source manager. */
+static void mem_init_source(j_decompress_ptr cinfo) {
+
+    (void)cinfo;
+}
+
+static boolean mem_fill_input_buffer(j_decompress_ptr cinfo) {
+
+    static const JOCTET eoi[2] = { 0xFF, JPEG_EOI };
+
+    WARNMS(cinfo, JWRN_JPEG_EOF);
+
+    cinfo->src->next_input_byte = eoi;
+    cinfo->src->bytes_in_buffer = sizeof(eoi);
+
+    return TRUE;
+}
+
+static void mem_skip_input_data(j_decompress_ptr cinfo, long num_bytes) {
+
+    if (num_bytes <= 0) {
+        return;
+    }
+
+    if ((size_t)num_bytes > cinfo->src->bytes_in_buffer) {
+        (void)mem_fill_input_buffer(cinfo);
+    } else {
+        cinfo->src->next_input_byte += num_bytes;
+        cinfo->src->bytes_in_buffer -= (size_t)num_bytes;
+    }
+}
+
+static void mem_term_source(j_decompress_ptr cinfo) {
+
+    (void)cinfo;
+}
+
+/*
+ * Decodes the JPEG in 'buffer' skipping the first 'skip_rows' rows and writing the next 'rows'
+ * rows into the image starting from 'first_row'.
+ */
+static sail_status_t decode_buffer(const unsigned char *buffer, size_t buffer_size, J_COLOR_SPACE out_color_space,
+                                    unsigned skip_rows, unsigned first_row, unsigned rows, struct sail_image *image) {
+
+    struct jpeg_decompress_struct decompress_context;
+    struct jpeg_private_my_error_context error_context;
+    struct jpeg_source_mgr source;
+    unsigned char *volatile skip_row = NULL;
+
+    decompress_context.err = jpeg_std_error(&error_context.jpeg_error_mgr);
+    error_context.jpeg_error_mgr.error_exit = jpeg_private_my_error_exit;
+    error_context.jpeg_error_mgr.output_message = jpeg_private_my_output_message;
+
+    if (setjmp(error_context.setjmp_buffer) != 0) {
+        jpeg_destroy_decompress(&decompress_context);
+        sail_free(skip_row);
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+    }
+
+    jpeg_create_decompress(&decompress_context);
+
+    source.next_input_byte   = buffer;
+    source.bytes_in_buffer   = buffer_size;
+    source.init_source       = mem_init_source;
+    source.fill_input_buffer = mem_fill_input_buffer;
+    source.skip_input_data   = mem_skip_input_data;
+    source.resync_to_restart = jpeg_resync_to_restart;
+    source.term_source       = mem_term_source;
+    decompress_context.src   = &source;
+
+    jpeg_read_header(&decompress_context, true);
+
+    decompress_context.out_color_space = out_color_space;
+    decompress_context.quantize_colors = false;
+
+    jpeg_start_decompress(&decompress_context);
+
+    if (skip_rows > 0) {
+        void *ptr;
+        SAIL_TRY_OR_CLEANUP(sail_malloc((size_t)decompress_context.output_width * decompress_context.output_components, &ptr),
+                            /* cleanup */ jpeg_destroy_decompress(&decompress_context));
+        skip_row = ptr;
+
+        for (unsigned row = 0; row < skip_rows; row++) {
+            JSAMPROW samprow = (JSAMPROW)skip_row;
+            (void)jpeg_read_scanlines(&decompress_context, &samprow, 1);
+        }
+    }
+
+    for (unsigned row = 0; row < rows; row++) {
+        JSAMPROW samprow = (JSAMPROW)sail_scan_line(image, first_row + row);
+        (void)jpeg_read_scanlines(&decompress_context, &samprow, 1);
+    }
+
+    jpeg_abort_decompress(&decompress_context);
+    jpeg_destroy_decompress(&decompress_context);
+    sail_free(skip_row);
+
+    return SAIL_OK;
+}
+
+/*
+ * Decodes the intervals [first_interval, last_interval). Neighbor intervals are decoded
+ * as well and thrown away, so upsampled chroma rows at the band edges match serial decoding.
+ */
+static sail_status_t decode_band(const struct band_context *band_context, unsigned first_interval, unsigned last_interval) {
+
+    const struct restart_layout *layout = band_context->layout;
+    const unsigned image_height = band_context->image->height;
+
+    const unsigned start = (first_interval > 0) ? first_interval - 1 : 0;
+    const unsigned end   = (last_interval < band_context->intervals) ? last_interval + 1 : band_context->intervals;
+
+    const unsigned first_row     = first_interval * band_context->interval_height;
+    const unsigned last_row      = SAIL_MIN(last_interval * band_context->interval_height, image_height);
+    const unsigned band_first_px = start * band_context->interval_height;
+    const unsigned band_height   = SAIL_MIN(end * band_context->interval_height, image_height) - band_first_px;
+
+    const size_t entropy_start = (start == 0) ? layout->header_size : layout->markers[start - 1] + 2;
+    const size_t entropy_end   = (end == band_context->intervals) ? layout->entropy_end : layout->markers[end - 1];
+    const size_t buffer_size   = layout->header_size + (entropy_end - entropy_start) + 2;
+
+    void *ptr;
+    SAIL_TRY(sail_malloc(buffer_size, &ptr));
+    unsigned char *buffer = ptr;
+
+    /* The band is a standalone JPEG with the original headers and a smaller height. */
+    memcpy(buffer, band_context->data, layout->header_size);
+    buffer[layout->sof_height_offset]     = (unsigned char)(band_height >> 8);
+    buffer[layout->sof_height_offset + 1] = (unsigned char)(band_height & 0xFF);
+
+    memcpy(buffer + layout->header_size, band_context->data + entropy_start, entropy_end - entropy_start);
+    buffer[buffer_size - 2] = 0xFF;
+    buffer[buffer_size - 1] = JPEG_EOI;
+
+    /* Restart markers must count from RST0 again. */
+    for (unsigned marker = start; marker + 1 < end; marker++) {
+        buffer[layout->header_size + (layout->markers[marker] - entropy_start) + 1] = (unsigned char)(JPEG_RST0 + (marker - start) % 8);
+    }
+
+    SAIL_TRY_OR_CLEANUP(decode_buffer(buffer, buffer_size, band_context->out_color_space,
+                                        first_row - band_first_px, first_row, last_row - first_row, band_context->image),
+                        /* cleanup */ sail_free(buffer));
+
+    sail_free(buffer);
+
+    return SAIL_OK;
+}
+
+/*
+ * Public functions.
+ */
+
+bool jpeg_private_has_row_restarts(const struct jpeg_decompress_struct *decompress_context) {
+
+    return !decompress_context->progressive_mode
+            && !decompress_context->arith_code
+            && decompress_context->restart_interval > 0
+            && decompress_context->comps_in_scan == decompress_context->num_components
+            && decompress_context->output_width == decompress_context->image_width
+            && decompress_context->output_height == decompress_context->image_height
+            && decompress_context->restart_interval % decompress_context->MCUs_per_row == 0
+            && restart_intervals(decompress_context) > 1;
+}
+
+sail_status_t jpeg_private_decode_restart_bands(const unsigned char *data, size_t data_size,
+                                                const struct jpeg_decompress_struct *decompress_context,
+                                                int threads, struct sail_image *image, bool *decoded) {
+
+    *decoded = false;
+
+    const unsigned intervals = restart_intervals(decompress_context);
+
+    struct restart_layout layout;
+    layout.markers_count = intervals - 1;
+
+    void *ptr;
+    SAIL_TRY(sail_malloc(sizeof(size_t) * layout.markers_count, &ptr));
+    layout.markers = ptr;
+
+    if (!find_restart_layout(data, data_size, &layout)) {
+        SAIL_LOG_DEBUG("JPEG: Restart markers don't match the header, decoding serially");
+        sail_free(layout.markers);
+        return SAIL_OK;
+    }
+
+    const struct band_context band_context = {
+        .data            = data,
+        .layout          = &layout,
+        .out_color_space = decompress_context->out_color_space,
+        .intervals       = intervals,
+        .interval_height = decompress_context->restart_interval / decompress_context->MCUs_per_row * mcu_height(decompress_context),
+        .image           = image,
+    };
+
+    const int bands = SAIL_MIN(threads, (int)intervals);
+    bool failed = false;
+
+    SAIL_LOG_TRACE("JPEG: Decoding %u restart intervals in %d bands", intervals, bands);
+
+    int band;
+
+    #pragma omp parallel for schedule(SAIL_OPENMP_SCHEDULE) num_threads(threads)
+    for (band = 0; band < bands; band++) {
+        const unsigned first_interval = (unsigned)((uint64_t)intervals * band / bands);
+        const unsigned last_interval  = (unsigned)((uint64_t)intervals * (band + 1) / bands);
+
+        if (decode_band(&band_context, first_interval, last_interval) != SAIL_OK) {
+            #pragma omp atomic write
+            failed = true;
+        }
+    }
+
+    /* Broken bands may still be decodable with the error recovery of a single pass. */
+    if (failed) {
+        SAIL_LOG_DEBUG("JPEG: Failed to decode restart intervals in parallel, decoding serially");
+        SAIL_TRY_OR_CLEANUP(decode_buffer(data, data_size, band_context.out_color_space, 0, 0, image->height, image),
+                            /* cleanup */ sail_free(layout.markers));
+    }
+
+    sail_free(layout.markers);
+
+    *decoded = true;
+
+    return SAIL_OK;
+}
@@ -0,0 +1,55 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_JPEG_RESTART_H
+#define SAIL_JPEG_RESTART_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include <jpeglib.h>
+
+#include <sail-common/common.h>
+#include <sail-common/export.h>
+
+struct sail_image;
+
+/*
+ * Returns true if the image being decoded has restart markers at MCU row boundaries,
+ * so its MCU rows can be decoded in independent bands.
+ */
+SAIL_HIDDEN bool jpeg_private_has_row_restarts(const struct jpeg_decompress_struct *decompress_context);
+
+/*
+ * Splits the entropy-coded data of the whole JPEG file in 'data' at restart markers and decodes
+ * the bands of MCU rows in parallel into the disjoint row ranges of the image. Sets 'decoded'
+ * to false and leaves the image untouched when the restart markers don't match the header.
+ */
+SAIL_HIDDEN sail_status_t jpeg_private_decode_restart_bands(const unsigned char *data, size_t data_size,
+                                                            const struct jpeg_decompress_struct *decompress_context,
+                                                            int threads, struct sail_image *image, bool *decoded);
+
+#endif
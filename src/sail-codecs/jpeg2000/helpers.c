@@ -23,6 +23,8 @@
     SOFTWARE.
 */
 
+#include <string.h>
+
 #include <sail-common/sail-common.h>
 
 #include "helpers.h"
@@ -59,3 +61,78 @@ enum SailPixelFormat jpeg2000_private_sail_pixel_format(jas_clrspc_t jasper_colo
         }
     }
 }
+
+/*
+ * Every channel count gets its own loop so the compiler is able to vectorize it.
+ */
+#define JPEG2000_INTERLEAVE(type)                                                  \
+    switch (number_channels) {                                                     \
+        case 1: {                                                                  \
+            const jas_seqent_t *p0 = planes[0];                                    \
+                                                                                   \
+            for (unsigned column = 0; column < width; column++) {                  \
+                scan[column] = (type)(p0[column] << shift);                        \
+            }                                                                      \
+            break;                                                                 \
+        }                                                                          \
+        case 3: {                                                                  \
+            const jas_seqent_t *p0 = planes[0], *p1 = planes[1], *p2 = planes[2]; \
+                                                                                   \
+            for (unsigned column = 0; column < width; column++) {                  \
+                scan[column * 3 + 0] = (type)(p0[column] << shift);                \
+                scan[column * 3 + 1] = (type)(p1[column] << shift);                \
+                scan[column * 3 + 2] = (type)(p2[column] << shift);                \
+            }                                                                      \
+            break;                                                                 \
+        }                                                                          \
+        case 4: {                                                                  \
+            const jas_seqent_t *p0 = planes[0], *p1 = planes[1], *p2 = planes[2]; \
+            const jas_seqent_t *p3 = planes[3];                                    \
+                                                                                   \
+            for (unsigned column = 0; column < width; column++) {                  \
+                scan[column * 4 + 0] = (type)(p0[column] << shift);                \
+                scan[column * 4 + 1] = (type)(p1[column] << shift);                \
+                scan[column * 4 + 2] = (type)(p2[column] << shift);                \
+                scan[column * 4 + 3] = (type)(p3[column] << shift);                \
+            }                                                                      \
+            break;                                                                 \
+        }                                                                          \
+        default: {                                                                 \
+            for (unsigned column = 0; column < width; column++) {                  \
+                for (int channel = 0; channel < number_channels; channel++) {      \
+                    *scan++ = (type)(planes[channel][column] << shift);            \
+                }                                                                  \
+            }                                                                      \
+        }                                                                          \
+    }
+
+void jpeg2000_private_interleave8(const jas_seqent_t *planes[4], int number_channels, unsigned shift, unsigned width, uint8_t *scan) {
+
+    JPEG2000_INTERLEAVE(uint8_t)
+}
+
+void jpeg2000_private_interleave16(const jas_seqent_t *planes[4], int number_channels, unsigned shift, unsigned width, uint16_t *scan) {
+
+    JPEG2000_INTERLEAVE(uint16_t)
+}
+
+#undef JPEG2000_INTERLEAVE
+
+bool jpeg2000_private_tuning_key_value_callback(const char *key, const struct sail_variant *value, void *user_data) {
+
+    struct jpeg2000_load_tuning *load_tuning = user_data;
+
+    if (strcmp(key, "jpeg2000-max-layers") == 0) {
+        if (value->type == SAIL_VARIANT_TYPE_UNSIGNED_INT) {
+            load_tuning->max_layers = sail_variant_to_unsigned_int(value);
+            SAIL_LOG_TRACE("JPEG2000: Max layers: %u", load_tuning->max_layers);
+        }
+    } else if (strcmp(key, "jpeg2000-threads") == 0) {
+        if (value->type == SAIL_VARIANT_TYPE_UNSIGNED_INT) {
+            load_tuning->threads = sail_variant_to_unsigned_int(value);
+            SAIL_LOG_TRACE("JPEG2000: Threads: %u", load_tuning->threads);
+        }
+    }
+
+    return true;
+}
@@ -26,12 +26,35 @@
 #ifndef SAIL_JPEG2000_HELPERS_H
 #define SAIL_JPEG2000_HELPERS_H
 
+#include <stdbool.h>
+#include <stdint.h>
+
 #include <jasper/jas_cm.h>
+#include <jasper/jas_seq.h>
 
 #include <sail-common/common.h>
 #include <sail-common/export.h>
 #include <sail-common/status.h>
 
+struct sail_variant;
+
+/* Load tuning. */
+struct jpeg2000_load_tuning {
+    /* Maximum number of quality layers to decode. 0 means all layers. */
+    unsigned max_layers;
+    /* Number of threads to deinterleave samples with. 0 means the OpenMP default. */
+    unsigned threads;
+};
+
 SAIL_HIDDEN enum SailPixelFormat jpeg2000_private_sail_pixel_format(jas_clrspc_t jasper_color_space, int bpp);
 
+/*
+ * Interleave up to 4 planar rows of samples into a scan line shifting every sample left by 'shift' bits.
+ */
+SAIL_HIDDEN void jpeg2000_private_interleave8(const jas_seqent_t *planes[4], int number_channels, unsigned shift, unsigned width, uint8_t *scan);
+
+SAIL_HIDDEN void jpeg2000_private_interleave16(const jas_seqent_t *planes[4], int number_channels, unsigned shift, unsigned width, uint16_t *scan);
+
+SAIL_HIDDEN bool jpeg2000_private_tuning_key_value_callback(const char *key, const struct sail_variant *value, void *user_data);
+
 #endif
@@ -26,6 +26,11 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <stdio.h>
+
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
 
 #include <jasper/jasper.h>
 
@@ -33,6 +38,9 @@
 
 #include "helpers.h"
 
+/* Number of rows to fetch from JasPer at once. */
+#define JPEG2000_STRIP_HEIGHT 64
+
 /*
  * Codec-specific state.
  */
@@ -48,10 +56,15 @@ struct jpeg2000_state {
     jas_clrspc_t jas_color_space_family;
     int channels[4];
     int number_channels;
+    /* Strip of JPEG2000_STRIP_HEIGHT rows per channel. */
     jas_matrix_t *matrix[4];
     /* Channel depth in bits scaled to a byte boundary. For example, 12 bit images are scaled to 16 bit. */
     unsigned channel_depth_scaled;
     unsigned shift;
+    /* Region of interest clipped to the image. */
+    struct sail_region region;
+
+    struct jpeg2000_load_tuning load_tuning;
 };
 
 static sail_status_t alloc_jpeg2000_state(const struct sail_load_options *load_options,
@@ -75,6 +88,12 @@ static sail_status_t alloc_jpeg2000_state(const struct sail_load_options *load_o
         .number_channels = 0,
         .matrix          = { NULL, NULL, NULL, NULL },
         .shift           = 0,
+        .region          = { 0, 0, 0, 0 },
+
+        .load_tuning = {
+            .max_layers = 0,
+            .threads    = 0,
+        },
     };
 
     return SAIL_OK;
@@ -145,8 +164,24 @@ SAIL_EXPORT sail_status_t sail_codec_load_seek_next_frame_v8_jpeg2000(void *stat
 
     jpeg2000_state->frame_loaded = true;
 
+    /* Handle tuning. */
+    if (jpeg2000_state->load_options->tuning != NULL) {
+        sail_traverse_hash_map_with_user_data(jpeg2000_state->load_options->tuning,
+                                                jpeg2000_private_tuning_key_value_callback,
+                                                &jpeg2000_state->load_tuning);
+    }
+
+    /* Decode only the first N quality layers if requested. */
+    char decoder_options[32];
+    const char *decoder_options_ptr = NULL;
+
+    if (jpeg2000_state->load_tuning.max_layers > 0) {
+        snprintf(decoder_options, sizeof(decoder_options), "maxlyrs=%u", jpeg2000_state->load_tuning.max_layers);
+        decoder_options_ptr = decoder_options;
+    }
+
     /* Get image info. */
-    jpeg2000_state->jas_image = jas_image_decode(jpeg2000_state->jas_stream, -1 /* format */, NULL /* options */);
+    jpeg2000_state->jas_image = jas_image_decode(jpeg2000_state->jas_stream, -1 /* format */, decoder_options_ptr);
 
     if (jpeg2000_state->jas_image == NULL) {
         SAIL_LOG_ERROR("JPEG2000: Failed to read image");
@@ -226,9 +261,14 @@ SAIL_EXPORT sail_status_t sail_codec_load_seek_next_frame_v8_jpeg2000(void *stat
         }
     }
 
+    /* JasPer decodes whole images, so only the region of interest is fetched from the decoded image. */
+    SAIL_TRY(sail_clip_region(&jpeg2000_state->load_options->region, width, height, &jpeg2000_state->region));
+
     /* Allocate matrix per channel for reading. */
+    const unsigned strip_height = jpeg2000_state->region.height < JPEG2000_STRIP_HEIGHT ? jpeg2000_state->region.height : JPEG2000_STRIP_HEIGHT;
+
     for (int i = 0; i < jpeg2000_state->number_channels; i++) {
-        if ((jpeg2000_state->matrix[i] = jas_matrix_create(1, width)) == NULL) {
+        if ((jpeg2000_state->matrix[i] = jas_matrix_create(strip_height, jpeg2000_state->region.width)) == NULL) {
             SAIL_LOG_ERROR("JPEG2000: Matrix allocation failure");
             SAIL_LOG_AND_RETURN(SAIL_ERROR_MEMORY_ALLOCATION);
         }
@@ -266,8 +306,8 @@ SAIL_EXPORT sail_status_t sail_codec_load_seek_next_frame_v8_jpeg2000(void *stat
         image_local->source_image->compression  = SAIL_COMPRESSION_JPEG_2000;
     }
 
-    image_local->width          = width;
-    image_local->height         = height;
+    image_local->width          = jpeg2000_state->region.width;
+    image_local->height         = jpeg2000_state->region.height;
     image_local->pixel_format   = pixel_format;
     image_local->bytes_per_line = sail_bytes_per_line(image_local->width, image_local->pixel_format);
 
@@ -280,31 +320,39 @@ SAIL_EXPORT sail_status_t sail_codec_load_frame_v8_jpeg2000(void *state, struct
 
     const struct jpeg2000_state *jpeg2000_state = state;
 
-    for (unsigned row = 0; row < image->height; row++) {
+#ifdef _OPENMP
+    const int threads = jpeg2000_state->load_tuning.threads > 0 ? (int)jpeg2000_state->load_tuning.threads : omp_get_max_threads();
+#endif
+
+    for (unsigned strip_row = 0; strip_row < image->height; strip_row += JPEG2000_STRIP_HEIGHT) {
+        const unsigned strip_height = (image->height - strip_row) < JPEG2000_STRIP_HEIGHT ? (image->height - strip_row) : JPEG2000_STRIP_HEIGHT;
+
         for (int channel = 0; channel < jpeg2000_state->number_channels; channel++) {
             if (jas_image_readcmpt(jpeg2000_state->jas_image, jpeg2000_state->channels[channel],
-                    0 /* x */, row /* y */, image->width /* width */, 1 /* height */,
+                    jpeg2000_state->region.x /* x */, jpeg2000_state->region.y + strip_row /* y */, image->width /* width */, strip_height /* height */,
                     jpeg2000_state->matrix[channel]) != 0) {
-                SAIL_LOG_ERROR("JPEG2000: Failed to read image row #%u", row);
+                SAIL_LOG_ERROR("JPEG2000: Failed to read image rows #%u-#%u", strip_row, strip_row + strip_height - 1);
                 SAIL_LOG_AND_RETURN(SAIL_ERROR_BROKEN_IMAGE);
             }
         }
 
-        if (jpeg2000_state->channel_depth_scaled == 8) {
-            unsigned char *scan = sail_scan_line(image, row);
+        /* Rows within a strip are independent, so deinterleave them in parallel. */
+        unsigned row;
+
+        #pragma omp parallel for schedule(SAIL_OPENMP_SCHEDULE) num_threads(threads)
+        for (row = 0; row < strip_height; row++) {
+            const jas_seqent_t *planes[4] = { NULL, NULL, NULL, NULL };
 
-            for (unsigned column = 0; column < image->width; column++) {
-                for (int channel = 0; channel < jpeg2000_state->number_channels; channel++) {
-                    *scan++ = (unsigned char)(jas_matrix_getv(jpeg2000_state->matrix[channel], column) << jpeg2000_state->shift);
-                }
+            for (int channel = 0; channel < jpeg2000_state->number_channels; channel++) {
+                planes[channel] = jas_matrix_getref(jpeg2000_state->matrix[channel], row, 0);
             }
-        } else {
-            uint16_t *scan = sail_scan_line(image, row);
 
-            for (unsigned column = 0; column < image->width; column++) {
-                for (int channel = 0; channel < jpeg2000_state->number_channels; channel++) {
-                    *scan++ = (uint16_t)(jas_matrix_getv(jpeg2000_state->matrix[channel], column) << jpeg2000_state->shift);
-                }
+            if (jpeg2000_state->channel_depth_scaled == 8) {
+                jpeg2000_private_interleave8(planes, jpeg2000_state->number_channels, jpeg2000_state->shift,
+                                                image->width, sail_scan_line(image, strip_row + row));
+            } else {
+                jpeg2000_private_interleave16(planes, jpeg2000_state->number_channels, jpeg2000_state->shift,
+                                                image->width, sail_scan_line(image, strip_row + row));
             }
         }
     }
@@ -49,6 +49,8 @@ struct jpegxl_state {
 
     bool libjxl_success;
     bool frame_header_seen;
+    /* Number of frames. 0 means not counted yet. */
+    unsigned frames;
     JxlBasicInfo *basic_info;
     JxlMemoryManager *memory_manager;
     void *runner;
@@ -95,6 +97,7 @@ static sail_status_t alloc_jpegxl_state(struct sail_io *io,
 
         .libjxl_success    = false,
         .frame_header_seen = false,
+        .frames            = 0,
         .basic_info        = NULL,
         .memory_manager    = memory_manager,
         .runner            = NULL,
@@ -125,6 +128,72 @@ static void destroy_jpegxl_state(struct jpegxl_state *jpegxl_state) {
     sail_free(jpegxl_state);
 }
 
+/*
+ * Checks whether the frame exists with a separate decoder that is subscribed to frame headers only,
+ * so the frames are not decoded. Stops at the requested frame. The total number of frames is cached
+ * when the end of the image is reached.
+ */
+static sail_status_t frame_exists(struct jpegxl_state *jpegxl_state, unsigned frame, bool *exists) {
+
+    if (jpegxl_state->frames > 0) {
+        *exists = frame < jpegxl_state->frames;
+        return SAIL_OK;
+    }
+
+    JxlDecoder *decoder = JxlDecoderCreate(jpegxl_state->memory_manager);
+
+    if (decoder == NULL) {
+        SAIL_LOG_ERROR("JPEGXL: Failed to create decoder");
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+    }
+
+    if (JxlDecoderSubscribeEvents(decoder, JXL_DEC_FRAME) != JXL_DEC_SUCCESS) {
+        JxlDecoderDestroy(decoder);
+        SAIL_LOG_ERROR("JPEGXL: Failed to subscribe to decoder events");
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+    }
+
+    SAIL_TRY_OR_CLEANUP(jpegxl_state->io->seek(jpegxl_state->io->stream, 0, SEEK_SET),
+                        /* cleanup */ JxlDecoderDestroy(decoder));
+
+    unsigned frames = 0;
+    *exists = false;
+
+    while (!*exists) {
+        const JxlDecoderStatus status = JxlDecoderProcessInput(decoder);
+
+        switch (status) {
+            case JXL_DEC_NEED_MORE_INPUT: {
+                SAIL_TRY_OR_CLEANUP(jpegxl_private_read_more_data(jpegxl_state->io,
+                                                                     decoder,
+                                                                     jpegxl_state->buffer,
+                                                                     jpegxl_state->buffer_size),
+                                    /* cleanup */ JxlDecoderDestroy(decoder));
+                break;
+            }
+            case JXL_DEC_FRAME: {
+                *exists = frames++ == frame;
+                break;
+            }
+            case JXL_DEC_SUCCESS: {
+                JxlDecoderDestroy(decoder);
+                jpegxl_state->frames = frames;
+                SAIL_LOG_TRACE("JPEGXL: Frames: %u", frames);
+                return SAIL_OK;
+            }
+            default: {
+                JxlDecoderDestroy(decoder);
+                SAIL_LOG_ERROR("JPEGXL: Unexpected decoder status %u", status);
+                SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+            }
+        }
+    }
+
+    JxlDecoderDestroy(decoder);
+
+    return SAIL_OK;
+}
+
 /*
  * Decoding functions.
  */
@@ -397,6 +466,43 @@ SAIL_EXPORT sail_status_t sail_codec_load_frame_v8_jpegxl(void *state, struct sa
     return SAIL_OK;
 }
 
+SAIL_EXPORT sail_status_t sail_codec_load_seek_to_frame_v8_jpegxl(void *state, unsigned frame) {
+
+    struct jpegxl_state *jpegxl_state = state;
+
+    if (frame > 0 && jpegxl_state->basic_info != NULL && !jpegxl_state->basic_info->have_animation) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_NO_MORE_FRAMES);
+    }
+
+    /*
+     * libjxl cannot go backwards and cannot skip a frame it has already started. Rewind
+     * and let libjxl skip frames. It keeps the frame references collected so far
+     * and decodes only the frames the requested frame depends on.
+     */
+    JxlDecoderRewind(jpegxl_state->decoder);
+
+    bool exists;
+    SAIL_TRY(frame_exists(jpegxl_state, frame, &exists));
+
+    SAIL_TRY(jpegxl_state->io->seek(jpegxl_state->io->stream, 0, SEEK_SET));
+
+    sail_free(jpegxl_state->basic_info);
+    jpegxl_state->basic_info = NULL;
+    sail_destroy_source_image(jpegxl_state->source_image);
+    jpegxl_state->source_image = NULL;
+
+    jpegxl_state->frame_header_seen = false;
+    jpegxl_state->libjxl_success    = false;
+
+    if (!exists) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_NO_MORE_FRAMES);
+    }
+
+    JxlDecoderSkipFrames(jpegxl_state->decoder, frame);
+
+    return SAIL_OK;
+}
+
 SAIL_EXPORT sail_status_t sail_codec_load_finish_v8_jpegxl(void **state) {
 
     struct jpegxl_state *jpegxl_state = *state;
@@ -533,6 +533,59 @@ sail_status_t png_private_fetch_palette(png_structp png_ptr, png_infop info_ptr,
     return SAIL_OK;
 }
 
+sail_status_t png_private_write_palette(png_structp png_ptr, png_infop info_ptr, const struct sail_palette *palette) {
+
+    SAIL_CHECK_PTR(png_ptr);
+    SAIL_CHECK_PTR(info_ptr);
+    SAIL_CHECK_PTR(palette);
+
+    if (palette->color_count == 0 || palette->color_count > PNG_MAX_PALETTE_LENGTH) {
+        SAIL_LOG_ERROR("PNG: Palette with %u colors is not supported", palette->color_count);
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    }
+
+    switch (palette->pixel_format) {
+        case SAIL_PIXEL_FORMAT_BPP24_RGB: {
+            /* Deep copy palette. */
+            png_set_PLTE(png_ptr, info_ptr, palette->data, palette->color_count);
+            break;
+        }
+        case SAIL_PIXEL_FORMAT_BPP32_RGBA: {
+            png_color png_palette[PNG_MAX_PALETTE_LENGTH];
+            png_byte transparency[PNG_MAX_PALETTE_LENGTH];
+            int transparency_length = 0;
+
+            const unsigned char *palette_ptr = palette->data;
+
+            for (unsigned i = 0; i < palette->color_count; i++) {
+                png_palette[i].red   = *palette_ptr++;
+                png_palette[i].green = *palette_ptr++;
+                png_palette[i].blue  = *palette_ptr++;
+                transparency[i]      = *palette_ptr++;
+
+                /* Trailing opaque entries are omitted. */
+                if (transparency[i] != 255) {
+                    transparency_length = (int)i + 1;
+                }
+            }
+
+            /* Deep copy palette and transparency. */
+            png_set_PLTE(png_ptr, info_ptr, png_palette, palette->color_count);
+
+            if (transparency_length > 0) {
+                png_set_tRNS(png_ptr, info_ptr, transparency, transparency_length, NULL);
+            }
+            break;
+        }
+        default: {
+            SAIL_LOG_ERROR("PNG: Only BPP24-RGB and BPP32-RGBA palettes are currently supported");
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+        }
+    }
+
+    return SAIL_OK;
+}
+
 #ifdef PNG_APNG_SUPPORTED
 sail_status_t png_private_blend_source(void *dst_raw, unsigned dst_offset, const void *src_raw, unsigned src_width, unsigned bytes_per_pixel) {
 
@@ -695,6 +748,72 @@ sail_status_t png_private_store_num_frames_and_plays(png_structp png_ptr, png_in
 
     return SAIL_OK;
 }
+
+sail_status_t png_private_store_frame_properties(unsigned canvas_width, unsigned canvas_height,
+                                                    png_uint_32 x_offset, png_uint_32 y_offset,
+                                                    png_byte dispose_op, png_byte blend_op,
+                                                    struct sail_hash_map *special_properties) {
+
+    struct sail_variant *variant;
+    SAIL_TRY(sail_alloc_variant(&variant));
+
+    sail_set_variant_unsigned_int(variant, canvas_width);
+    sail_put_hash_map(special_properties, "apng-canvas-width", variant);
+
+    sail_set_variant_unsigned_int(variant, canvas_height);
+    sail_put_hash_map(special_properties, "apng-canvas-height", variant);
+
+    sail_set_variant_unsigned_int(variant, x_offset);
+    sail_put_hash_map(special_properties, "apng-frame-x", variant);
+
+    sail_set_variant_unsigned_int(variant, y_offset);
+    sail_put_hash_map(special_properties, "apng-frame-y", variant);
+
+    const char *dispose_op_str;
+
+    switch (dispose_op) {
+        case PNG_DISPOSE_OP_BACKGROUND: dispose_op_str = "background"; break;
+        case PNG_DISPOSE_OP_PREVIOUS:   dispose_op_str = "previous";   break;
+        default:                        dispose_op_str = "none";       break;
+    }
+
+    sail_set_variant_string(variant, dispose_op_str);
+    sail_put_hash_map(special_properties, "apng-frame-dispose-op", variant);
+
+    sail_set_variant_string(variant, (blend_op == PNG_BLEND_OP_OVER) ? "over" : "source");
+    sail_put_hash_map(special_properties, "apng-frame-blend-op", variant);
+
+    SAIL_LOG_TRACE("PNG: Raw frame: %u,%u, dispose: %s, blend: %s", x_offset, y_offset,
+                    dispose_op_str, (blend_op == PNG_BLEND_OP_OVER) ? "over" : "source");
+
+    sail_destroy_variant(variant);
+
+    return SAIL_OK;
+}
+
+bool png_private_is_key_frame(png_uint_32 canvas_width, png_uint_32 canvas_height,
+                                png_uint_32 width, png_uint_32 height, png_byte dispose_op, png_byte blend_op,
+                                png_uint_32 previous_width, png_uint_32 previous_height, png_byte previous_dispose_op,
+                                bool previous_is_key_frame) {
+
+    /*
+     * The frame overwrites the whole canvas. Restoring the previous canvas afterwards
+     * would depend on the preceding frames though.
+     */
+    if (width == canvas_width && height == canvas_height && blend_op == PNG_BLEND_OP_SOURCE && dispose_op != PNG_DISPOSE_OP_PREVIOUS) {
+        return true;
+    }
+
+    /*
+     * The previous frame leaves a clean canvas behind. A key frame is composited onto
+     * a clean canvas or covers it entirely, so disposing it to the background cleans the whole canvas again.
+     */
+    if (previous_dispose_op == PNG_DISPOSE_OP_BACKGROUND) {
+        return previous_is_key_frame || (previous_width == canvas_width && previous_height == canvas_height);
+    }
+
+    return false;
+}
 #endif
 
 sail_status_t png_private_fetch_resolution(png_structp png_ptr, png_infop info_ptr, struct sail_resolution **resolution) {
@@ -754,7 +873,7 @@ sail_status_t png_private_write_resolution(png_structp png_ptr, png_infop info_p
 
 bool png_private_tuning_key_value_callback(const char *key, const struct sail_variant *value, void *user_data) {
 
-    png_structp png_ptr = user_data;
+    struct png_private_save_tuning *save_tuning = user_data;
 
     if (strcmp(key, "png-filter") == 0) {
         if (value->type == SAIL_VARIANT_TYPE_STRING) {
@@ -787,7 +906,26 @@ bool png_private_tuning_key_value_callback(const char *key, const struct sail_va
 
             sail_destroy_string_node_chain(string_node_filters);
 
-            png_set_filter(png_ptr, 0, filters);
+            save_tuning->filters = filters;
+        }
+    } else if (strcmp(key, "png-threads") == 0) {
+        if (value->type == SAIL_VARIANT_TYPE_UNSIGNED_INT) {
+            save_tuning->threads = sail_variant_to_unsigned_int(value);
+            SAIL_LOG_TRACE("PNG: Threads: %u", save_tuning->threads);
+        }
+    }
+
+    return true;
+}
+
+bool png_private_load_tuning_key_value_callback(const char *key, const struct sail_variant *value, void *user_data) {
+
+    bool *raw_frames = user_data;
+
+    if (strcmp(key, "png-raw-frames") == 0) {
+        if (value->type == SAIL_VARIANT_TYPE_BOOL) {
+            *raw_frames = sail_variant_to_bool(value);
+            SAIL_LOG_TRACE("PNG: Raw frames: %s", *raw_frames ? "yes" : "no");
         }
     }
 
@@ -42,6 +42,14 @@ struct sail_palette;
 struct sail_resolution;
 struct sail_variant;
 
+/* Save tuning. */
+struct png_private_save_tuning {
+    /* Mask of PNG_FILTER_* values to apply. 0 means the libpng defaults. */
+    int filters;
+    /* Number of threads to deflate row blocks with. 1 means libpng, 0 means the OpenMP default. */
+    unsigned threads;
+};
+
 SAIL_HIDDEN void png_private_my_error_fn(png_structp png_ptr, png_const_charp text);
 
 SAIL_HIDDEN void png_private_my_warning_fn(png_structp png_ptr, png_const_charp text);
@@ -62,6 +70,8 @@ SAIL_HIDDEN sail_status_t png_private_fetch_iccp(png_structp png_ptr, png_infop
 
 SAIL_HIDDEN sail_status_t png_private_fetch_palette(png_structp png_ptr, png_infop info_ptr, struct sail_palette **palette);
 
+SAIL_HIDDEN sail_status_t png_private_write_palette(png_structp png_ptr, png_infop info_ptr, const struct sail_palette *palette);
+
 #ifdef PNG_APNG_SUPPORTED
 SAIL_HIDDEN sail_status_t png_private_blend_source(void *dst_raw, unsigned dst_offset, const void *src_raw, unsigned src_width, unsigned bytes_per_pixel);
 
@@ -74,6 +84,16 @@ SAIL_HIDDEN sail_status_t png_private_alloc_rows(png_bytep **A, unsigned row_len
 SAIL_HIDDEN void png_private_destroy_rows(png_bytep **A, unsigned height);
 
 SAIL_HIDDEN sail_status_t png_private_store_num_frames_and_plays(png_structp png_ptr, png_infop info_ptr, struct sail_hash_map *special_properties);
+
+SAIL_HIDDEN sail_status_t png_private_store_frame_properties(unsigned canvas_width, unsigned canvas_height,
+                                                                png_uint_32 x_offset, png_uint_32 y_offset,
+                                                                png_byte dispose_op, png_byte blend_op,
+                                                                struct sail_hash_map *special_properties);
+
+SAIL_HIDDEN bool png_private_is_key_frame(png_uint_32 canvas_width, png_uint_32 canvas_height,
+                                            png_uint_32 width, png_uint_32 height, png_byte dispose_op, png_byte blend_op,
+                                            png_uint_32 previous_width, png_uint_32 previous_height, png_byte previous_dispose_op,
+                                            bool previous_is_key_frame);
 #endif
 
 SAIL_HIDDEN sail_status_t png_private_fetch_resolution(png_structp png_ptr, png_infop info_ptr, struct sail_resolution **resolution);
@@ -82,4 +102,6 @@ SAIL_HIDDEN sail_status_t png_private_write_resolution(png_structp png_ptr, png_
 
 SAIL_HIDDEN bool png_private_tuning_key_value_callback(const char *key, const struct sail_variant *value, void *user_data);
 
+SAIL_HIDDEN bool png_private_load_tuning_key_value_callback(const char *key, const struct sail_variant *value, void *user_data);
+
 #endif
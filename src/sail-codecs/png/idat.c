@@ -0,0 +1,585 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <setjmp.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <zlib.h>
+
+#include <sail-common/sail-common.h>
+
+#include "idat.h"
+
+/*
+ * Private functions.
+ */
+
+/* Size of the filtered data to deflate in a single block. Same as the pigz default. */
+#define BLOCK_SIZE (128 * 1024)
+
+/* Size of the deflate window to prime every block with. */
+#define WINDOW_SIZE 32768
+
+/* Order of the source channels for every PNG channel when libpng would swap them. */
+static const unsigned BGR_CHANNELS[]  = { 2, 1, 0 };
+static const unsigned BGRA_CHANNELS[] = { 2, 1, 0, 3 };
+static const unsigned ARGB_CHANNELS[] = { 1, 2, 3, 0 };
+static const unsigned ABGR_CHANNELS[] = { 3, 2, 1, 0 };
+
+/* Adam7 passes: starting column and row, column and row increments. */
+static const unsigned ADAM7_PASSES[7][4] = {
+    { 0, 0, 8, 8 },
+    { 4, 0, 8, 8 },
+    { 0, 4, 4, 8 },
+    { 2, 0, 4, 4 },
+    { 0, 2, 2, 4 },
+    { 1, 0, 2, 2 },
+    { 0, 1, 1, 2 },
+};
+
+struct pass {
+    unsigned x0;
+    unsigned dx;
+    unsigned width;
+    /* Size of a row without the filter type byte. */
+    size_t row_bytes;
+};
+
+/* A row of the filtered data. Interlaced images have rows of every pass one after another. */
+struct line {
+    unsigned pass;
+    /* Row of the image to take the pixels from. */
+    unsigned y;
+    /* The first row of a pass is filtered with no previous row. */
+    bool first_in_pass;
+    /* Offset of the row in the filtered data. */
+    size_t offset;
+};
+
+/* Parameters shared between all the compressing threads. */
+struct block_context {
+    const struct sail_image *image;
+    unsigned bits_per_pixel;
+    /* Size of a full image row. Rows of the passes are not longer. */
+    size_t row_bytes;
+    /* Distance to the corresponding byte of the previous pixel. */
+    unsigned filter_distance;
+    /* Source channels when they need reordering, or NULL. */
+    const unsigned *channels_map;
+    unsigned channels;
+    unsigned sample_size;
+    int filters;
+    int compression_level;
+    int strategy;
+
+    struct pass passes[7];
+    /* The lines followed by a sentinel with the offset of the end of the filtered data. */
+    struct line *lines;
+    /* Index of the first line of every block followed by the number of lines. */
+    unsigned *block_lines;
+    unsigned blocks;
+};
+
+/* A deflated block of filtered rows. */
+struct block {
+    unsigned char *data;
+    size_t size;
+    uLong adler;
+    size_t filtered_size;
+};
+
+static const unsigned* channels_map(enum SailPixelFormat pixel_format, unsigned *channels) {
+
+    switch (pixel_format) {
+        case SAIL_PIXEL_FORMAT_BPP24_BGR:
+        case SAIL_PIXEL_FORMAT_BPP48_BGR:  *channels = 3; return BGR_CHANNELS;
+        case SAIL_PIXEL_FORMAT_BPP32_BGRA:
+        case SAIL_PIXEL_FORMAT_BPP64_BGRA: *channels = 4; return BGRA_CHANNELS;
+        case SAIL_PIXEL_FORMAT_BPP32_ARGB:
+        case SAIL_PIXEL_FORMAT_BPP64_ARGB: *channels = 4; return ARGB_CHANNELS;
+        case SAIL_PIXEL_FORMAT_BPP32_ABGR:
+        case SAIL_PIXEL_FORMAT_BPP64_ABGR: *channels = 4; return ABGR_CHANNELS;
+
+        default: {
+            *channels = 0;
+            return NULL;
+        }
+    }
+}
+
+/* Returns the pixels of the line in the PNG channel order, gathering them into 'buffer' if necessary. */
+static const unsigned char* fetch_line(const struct block_context *context, const struct line *line, unsigned char *buffer) {
+
+    const struct pass *pass = &context->passes[line->pass];
+    const unsigned char *scan_line = sail_scan_line(context->image, line->y);
+
+    if (pass->dx == 1 && context->channels_map == NULL) {
+        return scan_line;
+    }
+
+    if (context->bits_per_pixel < 8) {
+        const unsigned bits = context->bits_per_pixel;
+        const unsigned mask = (1U << bits) - 1;
+
+        memset(buffer, 0, pass->row_bytes);
+
+        for (unsigned i = 0; i < pass->width; i++) {
+            const size_t src_bit = (size_t)(pass->x0 + i * pass->dx) * bits;
+            const size_t dst_bit = (size_t)i * bits;
+            const unsigned value = (scan_line[src_bit >> 3] >> (8 - bits - (src_bit & 7))) & mask;
+
+            buffer[dst_bit >> 3] |= (unsigned char)(value << (8 - bits - (dst_bit & 7)));
+        }
+
+        return buffer;
+    }
+
+    const size_t pixel_size = context->bits_per_pixel / 8;
+
+    for (unsigned i = 0; i < pass->width; i++) {
+        const unsigned char *src = scan_line + (size_t)(pass->x0 + i * pass->dx) * pixel_size;
+        unsigned char *dst = buffer + i * pixel_size;
+
+        if (context->channels_map == NULL) {
+            memcpy(dst, src, pixel_size);
+        } else {
+            for (unsigned c = 0; c < context->channels; c++) {
+                memcpy(dst + c * context->sample_size, src + context->channels_map[c] * context->sample_size, context->sample_size);
+            }
+        }
+    }
+
+    return buffer;
+}
+
+static inline unsigned char paeth_predictor(unsigned a, unsigned b, unsigned c) {
+
+    const int p  = (int)a + (int)b - (int)c;
+    const int pa = abs(p - (int)a);
+    const int pb = abs(p - (int)b);
+    const int pc = abs(p - (int)c);
+
+    if (pa <= pb && pa <= pc) {
+        return (unsigned char)a;
+    } else if (pb <= pc) {
+        return (unsigned char)b;
+    } else {
+        return (unsigned char)c;
+    }
+}
+
+/* Filters the row with the filter type. 'prev' is NULL for the first row. */
+static void apply_filter(int type, const unsigned char *row, const unsigned char *prev, size_t size, unsigned distance, unsigned char *output) {
+
+    output[0] = (unsigned char)type;
+    output++;
+
+    switch (type) {
+        case PNG_FILTER_VALUE_SUB: {
+            for (size_t i = 0; i < size; i++) {
+                output[i] = (unsigned char)(row[i] - (i >= distance ? row[i - distance] : 0));
+            }
+            break;
+        }
+        case PNG_FILTER_VALUE_UP: {
+            for (size_t i = 0; i < size; i++) {
+                output[i] = (unsigned char)(row[i] - (prev != NULL ? prev[i] : 0));
+            }
+            break;
+        }
+        case PNG_FILTER_VALUE_AVG: {
+            for (size_t i = 0; i < size; i++) {
+                const unsigned a = i >= distance ? row[i - distance] : 0;
+                const unsigned b = prev != NULL ? prev[i] : 0;
+                output[i] = (unsigned char)(row[i] - ((a + b) >> 1));
+            }
+            break;
+        }
+        case PNG_FILTER_VALUE_PAETH: {
+            for (size_t i = 0; i < size; i++) {
+                const unsigned a = i >= distance ? row[i - distance] : 0;
+                const unsigned b = prev != NULL ? prev[i] : 0;
+                const unsigned c = (i >= distance && prev != NULL) ? prev[i - distance] : 0;
+                output[i] = (unsigned char)(row[i] - paeth_predictor(a, b, c));
+            }
+            break;
+        }
+        default: {
+            memcpy(output, row, size);
+        }
+    }
+}
+
+/* Sum of the absolute values of the filtered bytes as signed ones. Same heuristic as libpng uses. */
+static uint64_t filtered_row_cost(const unsigned char *filtered, size_t size) {
+
+    uint64_t cost = 0;
+
+    for (size_t i = 0; i < size; i++) {
+        cost += filtered[i] < 128 ? filtered[i] : 256 - filtered[i];
+    }
+
+    return cost;
+}
+
+/* Writes the filter type byte and the filtered row into 'output' picking the filter with the lowest cost. */
+static void filter_row(const struct block_context *context, const unsigned char *row, const unsigned char *prev, size_t row_bytes,
+                        unsigned char *candidate, unsigned char *output) {
+
+    static const int FILTER_MASKS[] = { PNG_FILTER_NONE, PNG_FILTER_SUB, PNG_FILTER_UP, PNG_FILTER_AVG, PNG_FILTER_PAETH };
+
+    uint64_t best_cost = UINT64_MAX;
+
+    for (int type = PNG_FILTER_VALUE_NONE; type <= PNG_FILTER_VALUE_PAETH; type++) {
+        if ((context->filters & FILTER_MASKS[type]) == 0) {
+            continue;
+        }
+
+        if (best_cost == UINT64_MAX) {
+            apply_filter(type, row, prev, row_bytes, context->filter_distance, output);
+            best_cost = (context->filters & ~FILTER_MASKS[type] & PNG_ALL_FILTERS) == 0 ? 0 : filtered_row_cost(output + 1, row_bytes);
+        } else {
+            apply_filter(type, row, prev, row_bytes, context->filter_distance, candidate);
+            const uint64_t cost = filtered_row_cost(candidate + 1, row_bytes);
+
+            if (cost < best_cost) {
+                best_cost = cost;
+                memcpy(output, candidate, row_bytes + 1);
+            }
+        }
+    }
+}
+
+/*
+ * Filters and deflates the lines of the block into a raw deflate stream. The stream
+ * is primed with the filtered tail of the previous block and ends on a byte boundary,
+ * or with the final deflate block if this is the last block.
+ */
+static sail_status_t compress_block(const struct block_context *context, unsigned index, struct block *block) {
+
+    const struct line *lines = context->lines;
+
+    const unsigned first_line = context->block_lines[index];
+    const unsigned end_line   = context->block_lines[index + 1];
+    unsigned start_line = first_line;
+
+    while (start_line > 0 && lines[first_line].offset - lines[start_line].offset < WINDOW_SIZE) {
+        start_line--;
+    }
+
+    const size_t dictionary_size = lines[first_line].offset - lines[start_line].offset;
+    const size_t filtered_size   = lines[end_line].offset - lines[first_line].offset;
+    const size_t max_row_bytes   = context->row_bytes;
+
+    void *ptr;
+    SAIL_TRY(sail_malloc(dictionary_size + filtered_size + (max_row_bytes + 1) + 2 * max_row_bytes, &ptr));
+    unsigned char *filtered  = ptr;
+    unsigned char *candidate = filtered + dictionary_size + filtered_size;
+    unsigned char *rows[2]   = { candidate + max_row_bytes + 1, candidate + max_row_bytes + 1 + max_row_bytes };
+
+    const unsigned char *prev = lines[start_line].first_in_pass
+                                    ? NULL
+                                    : fetch_line(context, &lines[start_line - 1], rows[(start_line - 1) & 1]);
+
+    for (unsigned line = start_line; line < end_line; line++) {
+        const unsigned char *current = fetch_line(context, &lines[line], rows[line & 1]);
+
+        filter_row(context, current, lines[line].first_in_pass ? NULL : prev, context->passes[lines[line].pass].row_bytes,
+                    candidate, filtered + (lines[line].offset - lines[start_line].offset));
+        prev = current;
+    }
+    const unsigned char *input = filtered + dictionary_size;
+    const bool last = (index + 1 == context->blocks);
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+
+    if (deflateInit2(&stream, context->compression_level, Z_DEFLATED, -15, 8, context->strategy) != Z_OK) {
+        sail_free(filtered);
+        SAIL_LOG_ERROR("PNG: Failed to initialize deflate");
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+    }
+
+    if (dictionary_size > 0) {
+        const size_t window = SAIL_MIN(dictionary_size, (size_t)WINDOW_SIZE);
+        deflateSetDictionary(&stream, input - window, (uInt)window);
+    }
+
+    /* Room for the empty stored block of the sync flush. */
+    const size_t bound = deflateBound(&stream, (uLong)filtered_size) + 16;
+
+    SAIL_TRY_OR_CLEANUP(sail_malloc(bound, &ptr),
+                        /* cleanup */ deflateEnd(&stream),
+                                      sail_free(filtered));
+    block->data = ptr;
+
+    stream.next_in   = (Bytef *)input;
+    stream.avail_in  = (uInt)filtered_size;
+    stream.next_out  = block->data;
+    stream.avail_out = (uInt)bound;
+
+    const int result = deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+    const bool deflated = last
+                            ? result == Z_STREAM_END
+                            : (result == Z_OK && stream.avail_in == 0 && stream.avail_out > 0);
+
+    block->size          = bound - stream.avail_out;
+    block->adler         = adler32(adler32(0, NULL, 0), input, (uInt)filtered_size);
+    block->filtered_size = filtered_size;
+
+    deflateEnd(&stream);
+    sail_free(filtered);
+
+    if (!deflated) {
+        SAIL_LOG_ERROR("PNG: Failed to deflate block #%u", index);
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+    }
+
+    return SAIL_OK;
+}
+
+/* Splits the image into lines of the passes and groups them into blocks of BLOCK_SIZE filtered bytes. */
+static sail_status_t build_lines(struct block_context *context, bool interlaced) {
+
+    const struct sail_image *image = context->image;
+    const unsigned passes = interlaced ? 7 : 1;
+
+    unsigned lines_count = 0;
+
+    for (unsigned p = 0; p < passes; p++) {
+        const unsigned x0 = interlaced ? ADAM7_PASSES[p][0] : 0;
+        const unsigned y0 = interlaced ? ADAM7_PASSES[p][1] : 0;
+        const unsigned dx = interlaced ? ADAM7_PASSES[p][2] : 1;
+        const unsigned dy = interlaced ? ADAM7_PASSES[p][3] : 1;
+
+        struct pass *pass = &context->passes[p];
+
+        pass->x0        = x0;
+        pass->dx        = dx;
+        pass->width     = (image->width > x0) ? (image->width - x0 + dx - 1) / dx : 0;
+        pass->row_bytes = ((size_t)pass->width * context->bits_per_pixel + 7) / 8;
+
+        /* Empty passes have no filter type bytes. */
+        if (pass->width > 0 && image->height > y0) {
+            lines_count += (image->height - y0 + dy - 1) / dy;
+        }
+    }
+
+    void *ptr;
+    SAIL_TRY(sail_malloc((lines_count + 1) * sizeof(struct line), &ptr));
+    context->lines = ptr;
+
+    unsigned line = 0;
+    size_t offset = 0;
+
+    for (unsigned p = 0; p < passes; p++) {
+        const unsigned y0 = interlaced ? ADAM7_PASSES[p][1] : 0;
+        const unsigned dy = interlaced ? ADAM7_PASSES[p][3] : 1;
+
+        if (context->passes[p].width == 0) {
+            continue;
+        }
+
+        for (unsigned y = y0; y < image->height; y += dy) {
+            context->lines[line++] = (struct line) {
+                .pass          = p,
+                .y             = y,
+                .first_in_pass = (y == y0),
+                .offset        = offset,
+            };
+
+            offset += context->passes[p].row_bytes + 1;
+        }
+    }
+
+    context->lines[line] = (struct line) { .offset = offset };
+
+    /* Every block but the last one has at least BLOCK_SIZE bytes. */
+    const size_t max_blocks = (offset + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+    SAIL_TRY(sail_malloc((max_blocks + 1) * sizeof(unsigned), &ptr));
+    context->block_lines = ptr;
+
+    unsigned blocks = 0;
+
+    for (line = 0; line < lines_count; line++) {
+        if (line == 0 || context->lines[line].offset - context->lines[context->block_lines[blocks - 1]].offset >= BLOCK_SIZE) {
+            context->block_lines[blocks++] = line;
+        }
+    }
+
+    context->block_lines[blocks] = lines_count;
+    context->blocks = blocks;
+
+    return SAIL_OK;
+}
+
+static void destroy_blocks(struct block *blocks, unsigned count) {
+
+    for (unsigned i = 0; i < count; i++) {
+        sail_free(blocks[i].data);
+        blocks[i].data = NULL;
+    }
+}
+
+/*
+ * Public functions.
+ */
+
+sail_status_t png_private_write_idat_in_parallel(png_structp png_ptr, const struct sail_image *image, bool interlaced,
+                                                 int compression_level, int filters, int threads,
+                                                 bool *written) {
+
+    *written = false;
+
+    struct block_context context = {
+        .image             = image,
+        .bits_per_pixel    = sail_bits_per_pixel(image->pixel_format),
+        .row_bytes         = sail_bytes_per_line(image->width, image->pixel_format),
+        .filter_distance   = SAIL_MAX(sail_bits_per_pixel(image->pixel_format) / 8, 1),
+        .filters           = filters,
+        .compression_level = compression_level,
+        .lines             = NULL,
+        .block_lines       = NULL,
+    };
+
+    SAIL_TRY_OR_CLEANUP(build_lines(&context, interlaced),
+                        /* cleanup */ sail_free(context.lines));
+
+    if (context.blocks < 2) {
+        sail_free(context.block_lines);
+        sail_free(context.lines);
+        return SAIL_OK;
+    }
+
+    context.channels_map = channels_map(image->pixel_format, &context.channels);
+
+    if (context.channels_map != NULL) {
+        context.sample_size = context.bits_per_pixel / 8 / context.channels;
+    }
+
+    /* Same defaults as in libpng. */
+    if ((context.filters & PNG_ALL_FILTERS) == 0) {
+        context.filters = (sail_is_indexed(image->pixel_format) || context.bits_per_pixel < 8)
+                            ? PNG_FILTER_NONE
+                            : PNG_ALL_FILTERS;
+    }
+
+    context.strategy = (context.filters == PNG_FILTER_NONE) ? Z_DEFAULT_STRATEGY : Z_FILTERED;
+
+    /* Keep a limited number of deflated blocks in memory. */
+    const unsigned batch = (unsigned)threads * 2;
+
+    void *ptr;
+    SAIL_TRY_OR_CLEANUP(sail_malloc(batch * sizeof(struct block), &ptr),
+                        /* cleanup */ sail_free(context.block_lines),
+                                      sail_free(context.lines));
+    struct block *blocks = ptr;
+
+    for (unsigned i = 0; i < batch; i++) {
+        blocks[i].data = NULL;
+    }
+
+    /* Restore the caller's error handler on return. */
+    jmp_buf caller_jmpbuf;
+    memcpy(caller_jmpbuf, png_jmpbuf(png_ptr), sizeof(jmp_buf));
+
+    if (setjmp(png_jmpbuf(png_ptr))) {
+        memcpy(png_jmpbuf(png_ptr), caller_jmpbuf, sizeof(jmp_buf));
+        destroy_blocks(blocks, batch);
+        sail_free(blocks);
+        sail_free(context.block_lines);
+        sail_free(context.lines);
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+    }
+
+    /* zlib header with no preset dictionary. */
+    const int flevel = (compression_level < 2) ? 0 : (compression_level < 6) ? 1 : (compression_level == 6) ? 2 : 3;
+    unsigned char zlib_header[2] = { 0x78, (unsigned char)(flevel << 6) };
+    zlib_header[1] += (unsigned char)(31 - ((zlib_header[0] << 8) + zlib_header[1]) % 31);
+
+    uLong adler = adler32(0, NULL, 0);
+    bool failed = false;
+
+    SAIL_LOG_TRACE("PNG: Deflating %u blocks in %d threads", context.blocks, threads);
+
+    for (unsigned first_block = 0; first_block < context.blocks && !failed; first_block += batch) {
+        const int count = (int)SAIL_MIN(batch, context.blocks - first_block);
+
+        int i;
+
+        #pragma omp parallel for schedule(SAIL_OPENMP_SCHEDULE) num_threads(threads)
+        for (i = 0; i < count; i++) {
+            if (compress_block(&context, first_block + i, &blocks[i]) != SAIL_OK) {
+                #pragma omp atomic write
+                failed = true;
+            }
+        }
+
+        for (i = 0; i < count && !failed; i++) {
+            const bool is_first = (first_block + i == 0);
+            const bool is_last  = (first_block + i + 1 == context.blocks);
+
+            adler = adler32_combine(adler, blocks[i].adler, (z_off_t)blocks[i].filtered_size);
+
+            png_write_chunk_start(png_ptr, (png_const_bytep)"IDAT",
+                                    (png_uint_32)(blocks[i].size + (is_first ? 2 : 0) + (is_last ? 4 : 0)));
+
+            if (is_first) {
+                png_write_chunk_data(png_ptr, zlib_header, sizeof(zlib_header));
+            }
+
+            png_write_chunk_data(png_ptr, blocks[i].data, blocks[i].size);
+
+            if (is_last) {
+                const unsigned char adler_bytes[4] = {
+                    (unsigned char)(adler >> 24), (unsigned char)(adler >> 16), (unsigned char)(adler >> 8), (unsigned char)adler
+                };
+                png_write_chunk_data(png_ptr, adler_bytes, sizeof(adler_bytes));
+            }
+
+            png_write_chunk_end(png_ptr);
+        }
+
+        destroy_blocks(blocks, batch);
+    }
+
+    memcpy(png_jmpbuf(png_ptr), caller_jmpbuf, sizeof(jmp_buf));
+    sail_free(blocks);
+    sail_free(context.block_lines);
+    sail_free(context.lines);
+
+    if (failed) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+    }
+
+    *written = true;
+
+    return SAIL_OK;
+}
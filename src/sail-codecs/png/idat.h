@@ -0,0 +1,53 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_PNG_IDAT_H
+#define SAIL_PNG_IDAT_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include <png.h>
+
+#include <sail-common/common.h>
+#include <sail-common/export.h>
+
+struct sail_image;
+
+/*
+ * Filters and deflates blocks of image rows in parallel and writes them as IDAT chunks
+ * of a single zlib stream. Every block is primed with the tail of the previous block
+ * and ends on a byte boundary, so the concatenated stream is a standard one. Interlaced
+ * images are split into the Adam7 passes first.
+ *
+ * 'filters' is a mask of PNG_FILTER_* values to select from adaptively, or 0 to use
+ * the libpng defaults. Sets 'written' to false and writes nothing when the image
+ * is too small to be split into blocks.
+ */
+SAIL_HIDDEN sail_status_t png_private_write_idat_in_parallel(png_structp png_ptr, const struct sail_image *image, bool interlaced,
+                                                             int compression_level, int filters, int threads,
+                                                             bool *written);
+
+#endif
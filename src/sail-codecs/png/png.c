@@ -32,9 +32,14 @@
 
 #include <png.h>
 
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
 #include <sail-common/sail-common.h>
 
 #include "helpers.h"
+#include "idat.h"
 #include "io.h"
 
 /*
@@ -49,6 +54,7 @@ static const double COMPRESSION_DEFAULT = 6;
  * Codec-specific state.
  */
 struct png_state {
+    struct sail_io *io;
     const struct sail_load_options *load_options;
     const struct sail_save_options *save_options;
 
@@ -65,6 +71,11 @@ struct png_state {
     int frames;
     int current_frame;
 
+    struct png_private_save_tuning save_tuning;
+    int compression_level;
+    /* IDAT chunks were written in parallel, bypassing libpng. */
+    bool idat_written;
+
     /* APNG-specific. */
 #ifdef PNG_APNG_SUPPORTED
     bool is_apng;
@@ -80,15 +91,24 @@ struct png_state {
     png_byte next_frame_blend_op;
 
     bool skipped_hidden;
+    /* Return frames as is, without compositing them onto the canvas. */
+    bool raw_frames;
     png_bytep *prev;
     /* Temporary scanline to read into. We need it for blending. */
     void *temp_scanline;
     /* Scan line for skipping a first hidden frame. */
     void *scanline_for_skipping;
+    /* Scan line for skipping frames while seeking. */
+    void *seek_scanline;
+
+    /* Key frames seen so far. Key frames don't depend on the preceding frames. */
+    bool *key_frames;
+    unsigned key_frames_known;
 #endif
 };
 
-static sail_status_t alloc_png_state(const struct sail_load_options *load_options,
+static sail_status_t alloc_png_state(struct sail_io *io,
+                                        const struct sail_load_options *load_options,
                                         const struct sail_save_options *save_options,
                                         struct png_state **png_state) {
 
@@ -97,6 +117,7 @@ static sail_status_t alloc_png_state(const struct sail_load_options *load_option
     *png_state = ptr;
 
     **png_state = (struct png_state) {
+        .io           = io,
         .load_options = load_options,
         .save_options = save_options,
 
@@ -112,6 +133,13 @@ static sail_status_t alloc_png_state(const struct sail_load_options *load_option
         .frames            = 0,
         .current_frame     = 0,
 
+        .save_tuning = {
+            .filters = 0,
+            .threads = 1,
+        },
+        .compression_level = 0,
+        .idat_written      = false,
+
 /* APNG-specific. */
 #ifdef PNG_APNG_SUPPORTED
         .is_apng               = false,
@@ -127,9 +155,14 @@ static sail_status_t alloc_png_state(const struct sail_load_options *load_option
         .next_frame_blend_op   = PNG_BLEND_OP_SOURCE,
 
         .skipped_hidden        = false,
+        .raw_frames            = false,
         .prev                  = NULL,
         .temp_scanline         = NULL,
         .scanline_for_skipping = NULL,
+        .seek_scanline         = NULL,
+
+        .key_frames       = NULL,
+        .key_frames_known = 0,
 #endif
     };
 
@@ -145,6 +178,8 @@ static void destroy_png_state(struct png_state *png_state) {
 #ifdef PNG_APNG_SUPPORTED
     sail_free(png_state->temp_scanline);
     sail_free(png_state->scanline_for_skipping);
+    sail_free(png_state->seek_scanline);
+    sail_free(png_state->key_frames);
 
     if (png_state->first_image != NULL) {
         png_private_destroy_rows(&png_state->prev, png_state->first_image->height);
@@ -160,14 +195,8 @@ static void destroy_png_state(struct png_state *png_state) {
  * Decoding functions.
  */
 
-SAIL_EXPORT sail_status_t sail_codec_load_init_v8_png(struct sail_io *io, const struct sail_load_options *load_options, void **state) {
-
-    *state = NULL;
-
-    /* Allocate a new state. */
-    struct png_state *png_state;
-    SAIL_TRY(alloc_png_state(load_options, NULL, &png_state));
-    *state = png_state;
+/* Reads the image header from the current I/O position. */
+static sail_status_t start_reading(struct png_state *png_state) {
 
     /* Initialize PNG. */
     if ((png_state->png_ptr = png_create_read_struct_2(PNG_LIBPNG_VER_STRING, NULL, png_private_my_error_fn, png_private_my_warning_fn, NULL, png_private_my_malloc_fn, png_private_my_free_fn)) == NULL) {
@@ -186,7 +215,7 @@ SAIL_EXPORT sail_status_t sail_codec_load_init_v8_png(struct sail_io *io, const
         SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
     }
 
-    png_set_read_fn(png_state->png_ptr, io, png_private_my_read_fn);
+    png_set_read_fn(png_state->png_ptr, png_state->io, png_private_my_read_fn);
     png_read_info(png_state->png_ptr, png_state->info_ptr);
 
     SAIL_TRY(sail_alloc_image(&png_state->first_image));
@@ -229,8 +258,17 @@ SAIL_EXPORT sail_status_t sail_codec_load_init_v8_png(struct sail_io *io, const
         SAIL_LOG_AND_RETURN(SAIL_ERROR_NO_MORE_FRAMES);
     }
 
-    if (png_state->is_apng) {
+    /* Handle tuning. */
+    if (png_state->load_options->tuning != NULL) {
+        sail_traverse_hash_map_with_user_data(png_state->load_options->tuning, png_private_load_tuning_key_value_callback, &png_state->raw_frames);
+    }
+
+    /* Raw frames are not composited, so no canvas is needed. */
+    if (png_state->is_apng && !png_state->raw_frames) {
         SAIL_TRY(png_private_alloc_rows(&png_state->prev, png_state->first_image->bytes_per_line, png_state->first_image->height));
+    }
+
+    if (png_state->is_apng) {
 
         if (png_state->load_options->options & SAIL_OPTION_SOURCE_IMAGE) {
             if (png_state->load_options->options & SAIL_OPTION_META_DATA) {
@@ -271,7 +309,7 @@ SAIL_EXPORT sail_status_t sail_codec_load_init_v8_png(struct sail_io *io, const
     }
 
 #ifdef PNG_APNG_SUPPORTED
-    if (png_state->is_apng) {
+    if (png_state->is_apng && !png_state->raw_frames) {
         SAIL_TRY(sail_malloc(png_state->first_image->bytes_per_line, &png_state->temp_scanline));
     }
 #endif
@@ -279,6 +317,148 @@ SAIL_EXPORT sail_status_t sail_codec_load_init_v8_png(struct sail_io *io, const
     return SAIL_OK;
 }
 
+#ifdef PNG_APNG_SUPPORTED
+/* libpng reads sequentially, so the only way back is reading from the very beginning. */
+static sail_status_t restart_reading(struct png_state *png_state) {
+
+    if (png_state->png_ptr != NULL) {
+        if (setjmp(png_jmpbuf(png_state->png_ptr))) {
+            png_state->libpng_error = true;
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+        }
+
+        png_destroy_read_struct(&png_state->png_ptr, &png_state->info_ptr, NULL);
+    }
+
+    sail_free(png_state->temp_scanline);
+    png_state->temp_scanline = NULL;
+
+    if (png_state->first_image != NULL) {
+        png_private_destroy_rows(&png_state->prev, png_state->first_image->height);
+    }
+
+    sail_destroy_image(png_state->first_image);
+    png_state->first_image = NULL;
+
+    png_state->libpng_error          = false;
+    png_state->frames                = 0;
+    png_state->current_frame         = 0;
+    png_state->skipped_hidden        = false;
+    png_state->next_frame_width      = 0;
+    png_state->next_frame_height     = 0;
+    png_state->next_frame_x_offset   = 0;
+    png_state->next_frame_y_offset   = 0;
+    png_state->next_frame_dispose_op = PNG_DISPOSE_OP_BACKGROUND;
+    png_state->next_frame_blend_op   = PNG_BLEND_OP_SOURCE;
+
+    SAIL_TRY(png_state->io->seek(png_state->io->stream, 0, SEEK_SET));
+    SAIL_TRY(start_reading(png_state));
+
+    return SAIL_OK;
+}
+
+static sail_status_t append_key_frame(struct png_state *png_state,
+                                        png_uint_32 previous_width, png_uint_32 previous_height, png_byte previous_dispose_op) {
+
+    if (png_state->key_frames == NULL) {
+        void *ptr;
+        SAIL_TRY(sail_malloc(sizeof(bool) * png_state->frames, &ptr));
+        png_state->key_frames = ptr;
+    }
+
+    const unsigned frame = png_state->key_frames_known;
+
+    png_state->key_frames[frame] = (frame == 0) ||
+        png_private_is_key_frame(png_state->first_image->width, png_state->first_image->height,
+                                    png_state->next_frame_width, png_state->next_frame_height,
+                                    png_state->next_frame_dispose_op, png_state->next_frame_blend_op,
+                                    previous_width, previous_height, previous_dispose_op,
+                                    png_state->key_frames[frame - 1]);
+
+    png_state->key_frames_known++;
+
+    return SAIL_OK;
+}
+
+/*
+ * Reads the current frame. When the image is NULL, the frame is read into a scratch scan line
+ * just to update the canvas, or to skip the frame when it's not composited.
+ */
+static sail_status_t read_frame(struct png_state *png_state, struct sail_image *image, bool composite) {
+
+    if (image == NULL && png_state->seek_scanline == NULL) {
+        SAIL_TRY(sail_malloc(png_state->first_image->bytes_per_line, &png_state->seek_scanline));
+    }
+
+    const unsigned height = composite
+                                ? png_state->first_image->height
+                                : (image != NULL) ? image->height : png_state->next_frame_height;
+
+    for (int current_pass = 0; current_pass < png_state->interlaced_passes; current_pass++) {
+        if (composite) {
+            for (unsigned row = 0; row < height; row++) {
+                unsigned char *scanline = (image != NULL) ? sail_scan_line(image, row) : png_state->seek_scanline;
+
+                memcpy(scanline, png_state->prev[row], png_state->first_image->bytes_per_line);
+
+                if (row >= png_state->next_frame_y_offset && row < png_state->next_frame_y_offset + png_state->next_frame_height) {
+                    png_read_row(png_state->png_ptr, (png_bytep)png_state->temp_scanline, NULL);
+
+                    /* Copy all pixel values including alpha. */
+                    if (png_state->current_frame == 1 || png_state->next_frame_blend_op == PNG_BLEND_OP_SOURCE) {
+                        SAIL_TRY(png_private_blend_source(scanline,
+                                                png_state->next_frame_x_offset,
+                                                png_state->temp_scanline,
+                                                png_state->next_frame_width,
+                                                png_state->bytes_per_pixel));
+                    } else { /* PNG_BLEND_OP_OVER */
+                        SAIL_TRY(png_private_blend_over(scanline,
+                                            png_state->next_frame_x_offset,
+                                            png_state->temp_scanline,
+                                            png_state->next_frame_width,
+                                            png_state->first_image->pixel_format));
+                    }
+
+                    /* Workaround: Apply disposal method only for images with bpp >= 8. */
+                    if (png_state->bytes_per_pixel > 0) {
+                        if (png_state->next_frame_dispose_op == PNG_DISPOSE_OP_BACKGROUND) {
+                            memset(png_state->prev[row] + png_state->next_frame_x_offset * png_state->bytes_per_pixel,
+                                    0,
+                                    (size_t)png_state->next_frame_width * png_state->bytes_per_pixel);
+                        } else if (png_state->next_frame_dispose_op == PNG_DISPOSE_OP_NONE) {
+                            memcpy(png_state->prev[row] + png_state->next_frame_x_offset * png_state->bytes_per_pixel,
+                                    scanline,
+                                    (size_t)png_state->next_frame_width * png_state->bytes_per_pixel);
+                        } else { /* PNG_DISPOSE_OP_PREVIOUS */
+                        }
+                    }
+                }
+            }
+        } else {
+            for (unsigned row = 0; row < height; row++) {
+                png_read_row(png_state->png_ptr, (image != NULL) ? sail_scan_line(image, row) : png_state->seek_scanline, NULL);
+            }
+        }
+    }
+
+    return SAIL_OK;
+}
+#endif
+
+SAIL_EXPORT sail_status_t sail_codec_load_init_v8_png(struct sail_io *io, const struct sail_load_options *load_options, void **state) {
+
+    *state = NULL;
+
+    /* Allocate a new state. */
+    struct png_state *png_state;
+    SAIL_TRY(alloc_png_state(io, load_options, NULL, &png_state));
+    *state = png_state;
+
+    SAIL_TRY(start_reading(png_state));
+
+    return SAIL_OK;
+}
+
 SAIL_EXPORT sail_status_t sail_codec_load_seek_next_frame_v8_png(void *state, struct sail_image **image) {
 
     struct png_state *png_state = state;
@@ -326,6 +506,10 @@ SAIL_EXPORT sail_status_t sail_codec_load_seek_next_frame_v8_png(void *state, st
         png_state->skipped_hidden = true;
         png_read_frame_head(png_state->png_ptr, png_state->info_ptr);
 
+        const png_uint_32 previous_width      = png_state->next_frame_width;
+        const png_uint_32 previous_height     = png_state->next_frame_height;
+        const png_byte    previous_dispose_op = png_state->next_frame_dispose_op;
+
         if (png_get_valid(png_state->png_ptr, png_state->info_ptr, PNG_INFO_fcTL) != 0) {
             png_get_next_frame_fcTL(png_state->png_ptr, png_state->info_ptr,
                                     &png_state->next_frame_width, &png_state->next_frame_height,
@@ -362,6 +546,36 @@ SAIL_EXPORT sail_status_t sail_codec_load_seek_next_frame_v8_png(void *state, st
         }
 
         image_local->delay = (int)(((double)png_state->next_frame_delay_num / png_state->next_frame_delay_den) * 1000);
+
+        if ((unsigned)png_state->current_frame == png_state->key_frames_known) {
+            SAIL_TRY_OR_CLEANUP(append_key_frame(png_state, previous_width, previous_height, previous_dispose_op),
+                                /* cleanup */ sail_destroy_image(image_local));
+        }
+
+        /* Raw frames are useless without their offsets, so store them unconditionally. */
+        if (png_state->raw_frames) {
+            image_local->width          = png_state->next_frame_width;
+            image_local->height         = png_state->next_frame_height;
+            image_local->bytes_per_line = sail_bytes_per_line(image_local->width, image_local->pixel_format);
+
+            if (image_local->source_image == NULL) {
+                SAIL_TRY_OR_CLEANUP(sail_alloc_source_image(&image_local->source_image),
+                                    /* cleanup */ sail_destroy_image(image_local));
+                image_local->source_image->pixel_format = png_private_png_color_type_to_pixel_format(png_state->color_type, png_state->bit_depth);
+                image_local->source_image->compression  = SAIL_COMPRESSION_DEFLATE;
+            }
+
+            if (image_local->source_image->special_properties == NULL) {
+                SAIL_TRY_OR_CLEANUP(sail_alloc_hash_map(&image_local->source_image->special_properties),
+                                    /* cleanup */ sail_destroy_image(image_local));
+            }
+
+            SAIL_TRY_OR_CLEANUP(png_private_store_frame_properties(png_state->first_image->width, png_state->first_image->height,
+                                                                    png_state->next_frame_x_offset, png_state->next_frame_y_offset,
+                                                                    png_state->next_frame_dispose_op, png_state->next_frame_blend_op,
+                                                                    image_local->source_image->special_properties),
+                                /* cleanup */ sail_destroy_image(image_local));
+        }
     }
 #endif
 
@@ -385,61 +599,85 @@ SAIL_EXPORT sail_status_t sail_codec_load_frame_v8_png(void *state, struct sail_
         SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
     }
 
+#ifdef PNG_APNG_SUPPORTED
+    SAIL_TRY(read_frame(png_state, image, png_state->is_apng && !png_state->raw_frames));
+#else
     for (int current_pass = 0; current_pass < png_state->interlaced_passes; current_pass++) {
-    #ifdef PNG_APNG_SUPPORTED
-        if (png_state->is_apng) {
-            for (unsigned row = 0; row < image->height; row++) {
-                unsigned char *scanline = sail_scan_line(image, row);
+        for (unsigned row = 0; row < image->height; row++) {
+            png_read_row(png_state->png_ptr, sail_scan_line(image, row), NULL);
+        }
+    }
+#endif
 
-                memcpy(scanline, png_state->prev[row], png_state->first_image->bytes_per_line);
+    return SAIL_OK;
+}
 
-                if (row >= png_state->next_frame_y_offset && row < png_state->next_frame_y_offset + png_state->next_frame_height) {
-                    png_read_row(png_state->png_ptr, (png_bytep)png_state->temp_scanline, NULL);
+#ifdef PNG_APNG_SUPPORTED
+SAIL_EXPORT sail_status_t sail_codec_load_seek_to_frame_v8_png(void *state, unsigned frame) {
 
-                    /* Copy all pixel values including alpha. */
-                    if (png_state->current_frame == 1 || png_state->next_frame_blend_op == PNG_BLEND_OP_SOURCE) {
-                        SAIL_TRY(png_private_blend_source(scanline,
-                                                png_state->next_frame_x_offset,
-                                                png_state->temp_scanline,
-                                                png_state->next_frame_width,
-                                                png_state->bytes_per_pixel));
-                    } else { /* PNG_BLEND_OP_OVER */
-                        SAIL_TRY(png_private_blend_over(scanline,
-                                            png_state->next_frame_x_offset,
-                                            png_state->temp_scanline,
-                                            png_state->next_frame_width,
-                                            image->pixel_format));
-                    }
+    struct png_state *png_state = state;
 
-                    /* Workaround: Apply disposal method only for images with bpp >= 8. */
-                    if (png_state->bytes_per_pixel > 0) {
-                        if (png_state->next_frame_dispose_op == PNG_DISPOSE_OP_BACKGROUND) {
-                            memset(png_state->prev[row] + png_state->next_frame_x_offset * png_state->bytes_per_pixel,
-                                    0,
-                                    (size_t)png_state->next_frame_width * png_state->bytes_per_pixel);
-                        } else if (png_state->next_frame_dispose_op == PNG_DISPOSE_OP_NONE) {
-                            memcpy(png_state->prev[row] + png_state->next_frame_x_offset * png_state->bytes_per_pixel,
-                                    scanline,
-                                    (size_t)png_state->next_frame_width * png_state->bytes_per_pixel);
-                        } else { /* PNG_DISPOSE_OP_PREVIOUS */
-                        }
-                    }
-                }
-            }
-        } else {
-            for (unsigned row = 0; row < image->height; row++) {
-                png_read_row(png_state->png_ptr, sail_scan_line(image, row), NULL);
-            }
+    if (png_state->libpng_error) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+    }
+
+    /* A hidden first frame is not counted until it's skipped. */
+    const bool hidden_pending = png_state->is_apng && !png_state->skipped_hidden &&
+                                    png_get_first_frame_is_hidden(png_state->png_ptr, png_state->info_ptr);
+    const unsigned frames = (unsigned)png_state->frames - (hidden_pending ? 1 : 0);
+
+    if (frame >= frames) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_NO_MORE_FRAMES);
+    }
+
+    /* libpng cannot go backwards. */
+    if ((unsigned)png_state->current_frame > frame) {
+        SAIL_TRY(restart_reading(png_state));
+    }
+
+    /*
+     * Frames are still inflated sequentially. Compositing starts at the nearest
+     * known key frame though, as the preceding frames don't affect the requested one.
+     */
+    unsigned key_frame = 0;
+
+    if (png_state->key_frames_known > 0) {
+        key_frame = (frame < png_state->key_frames_known) ? frame : png_state->key_frames_known - 1;
+
+        while (!png_state->key_frames[key_frame]) {
+            key_frame--;
         }
-    #else
-        for (unsigned row = 0; row < image->height; row++) {
-            png_read_row(png_state->png_ptr, sail_scan_line(image, row), NULL);
+    }
+
+    SAIL_LOG_TRACE("PNG: Seeking to frame #%u from frame #%d, key frame #%u", frame, png_state->current_frame, key_frame);
+
+    while ((unsigned)png_state->current_frame < frame) {
+        struct sail_image *image;
+        SAIL_TRY(sail_codec_load_seek_next_frame_v8_png(png_state, &image));
+        sail_destroy_image(image);
+
+        /* The jump buffer set by the seek above is not valid anymore. */
+        if (setjmp(png_jmpbuf(png_state->png_ptr))) {
+            png_state->libpng_error = true;
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
         }
-    #endif
+
+        const unsigned skipped_frame = (unsigned)png_state->current_frame - 1;
+        const bool composite = png_state->is_apng && !png_state->raw_frames && skipped_frame >= key_frame;
+
+        /* Key frames, including the first frame after a restart, are composited onto a clean canvas. */
+        if (composite && skipped_frame == key_frame) {
+            for (unsigned row = 0; row < png_state->first_image->height; row++) {
+                memset(png_state->prev[row], 0, png_state->first_image->bytes_per_line);
+            }
+        }
+
+        SAIL_TRY(read_frame(png_state, NULL, composite));
     }
 
     return SAIL_OK;
 }
+#endif
 
 SAIL_EXPORT sail_status_t sail_codec_load_finish_v8_png(void **state) {
 
@@ -472,7 +710,7 @@ SAIL_EXPORT sail_status_t sail_codec_save_init_v8_png(struct sail_io *io, const
     *state = NULL;
 
     struct png_state *png_state;
-    SAIL_TRY(alloc_png_state(NULL, save_options, &png_state));
+    SAIL_TRY(alloc_png_state(io, NULL, save_options, &png_state));
     *state = png_state;
 
     if (png_state->save_options->compression != SAIL_COMPRESSION_DEFLATE) {
@@ -499,7 +737,11 @@ SAIL_EXPORT sail_status_t sail_codec_save_init_v8_png(struct sail_io *io, const
 
     /* Handle tuning. */
     if (png_state->save_options->tuning != NULL) {
-        sail_traverse_hash_map_with_user_data(png_state->save_options->tuning, png_private_tuning_key_value_callback, png_state->png_ptr);
+        sail_traverse_hash_map_with_user_data(png_state->save_options->tuning, png_private_tuning_key_value_callback, &png_state->save_tuning);
+    }
+
+    if (png_state->save_tuning.filters != 0) {
+        png_set_filter(png_state->png_ptr, 0, png_state->save_tuning.filters);
     }
 
     png_set_write_fn(png_state->png_ptr, io, png_private_my_write_fn, png_private_my_flush_fn);
@@ -569,13 +811,7 @@ SAIL_EXPORT sail_status_t sail_codec_save_seek_next_frame_v8_png(void *state, co
             SAIL_LOG_AND_RETURN(SAIL_ERROR_MISSING_PALETTE);
         }
 
-        if (image->palette->pixel_format != SAIL_PIXEL_FORMAT_BPP24_RGB) {
-            SAIL_LOG_ERROR("PNG: Only BPP24-RGB palette is currently supported");
-            SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
-        }
-
-        /* Deep copy palette. */
-        png_set_PLTE(png_state->png_ptr, png_state->info_ptr, image->palette->data, image->palette->color_count);
+        SAIL_TRY(png_private_write_palette(png_state->png_ptr, png_state->info_ptr, image->palette));
     }
 
     /* Save gamma. */
@@ -587,7 +823,8 @@ SAIL_EXPORT sail_status_t sail_codec_save_seek_next_frame_v8_png(void *state, co
                                 ? COMPRESSION_DEFAULT
                                 : png_state->save_options->compression_level;
 
-    png_set_compression_level(png_state->png_ptr, (int)compression);
+    png_state->compression_level = (int)compression;
+    png_set_compression_level(png_state->png_ptr, png_state->compression_level);
 
     png_write_info(png_state->png_ptr, png_state->info_ptr);
 
@@ -630,6 +867,21 @@ SAIL_EXPORT sail_status_t sail_codec_save_frame_v8_png(void *state, const struct
         SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
     }
 
+#ifdef _OPENMP
+    const int threads = png_state->save_tuning.threads > 0 ? (int)png_state->save_tuning.threads : omp_get_max_threads();
+
+    if (threads > 1) {
+        SAIL_TRY_OR_CLEANUP(png_private_write_idat_in_parallel(png_state->png_ptr, image, png_state->interlaced_passes > 1,
+                                                                png_state->compression_level, png_state->save_tuning.filters,
+                                                                threads, &png_state->idat_written),
+                            /* cleanup */ png_state->libpng_error = true);
+
+        if (png_state->idat_written) {
+            return SAIL_OK;
+        }
+    }
+#endif
+
     for (int current_pass = 0; current_pass < png_state->interlaced_passes; current_pass++) {
         for (unsigned row = 0; row < image->height; row++) {
             png_write_row(png_state->png_ptr, sail_scan_line(image, row));
@@ -655,7 +907,12 @@ SAIL_EXPORT sail_status_t sail_codec_save_finish_v8_png(void **state) {
     }
 
     if (png_state->png_ptr != NULL && !png_state->libpng_error) {
-        png_write_end(png_state->png_ptr, png_state->info_ptr);
+        if (png_state->idat_written) {
+            /* All the ancillary chunks were written before IDAT, so IEND is the only one left. */
+            png_write_chunk(png_state->png_ptr, (png_const_bytep)"IEND", NULL, 0);
+        } else {
+            png_write_end(png_state->png_ptr, png_state->info_ptr);
+        }
     }
 
     if (png_state->png_ptr != NULL) {
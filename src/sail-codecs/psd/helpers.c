@@ -23,6 +23,8 @@
     SOFTWARE.
 */
 
+#include <string.h>
+
 #include <sail-common/sail-common.h>
 
 #include "helpers.h"
@@ -123,3 +125,147 @@ enum SailCompression psd_private_sail_compression(enum SailPsdCompression compre
         default: return SAIL_COMPRESSION_UNKNOWN;
     }
 }
+
+sail_status_t psd_private_unpack_rle(const uint8_t *src, size_t src_size, uint8_t *dst, size_t dst_size) {
+
+    const uint8_t *src_end = src + src_size;
+    size_t written = 0;
+
+    while (written < dst_size) {
+        if (src == src_end) {
+            SAIL_LOG_ERROR("PSD: RLE row is too short");
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_BROKEN_IMAGE);
+        }
+
+        const unsigned c = *src++;
+
+        if (c < 128) {
+            /* c + 1 literal bytes. */
+            const size_t count = c + 1;
+
+            if (count > (size_t)(src_end - src) || count > dst_size - written) {
+                SAIL_LOG_ERROR("PSD: RLE literal run overflows the row");
+                SAIL_LOG_AND_RETURN(SAIL_ERROR_BROKEN_IMAGE);
+            }
+
+            memcpy(dst + written, src, count);
+            src     += count;
+            written += count;
+        } else if (c > 128) {
+            /* The next byte repeated 257 - c times. */
+            const size_t count = 257 - c;
+
+            if (src == src_end || count > dst_size - written) {
+                SAIL_LOG_ERROR("PSD: RLE repeated run overflows the row");
+                SAIL_LOG_AND_RETURN(SAIL_ERROR_BROKEN_IMAGE);
+            }
+
+            memset(dst + written, *src++, count);
+            written += count;
+        }
+
+        /* 128 is a no-op. */
+    }
+
+    return SAIL_OK;
+}
+
+/* Separate loops for the common channel counts let compilers vectorize them. */
+void psd_private_interleave8(const uint8_t *planes[4], unsigned channels, unsigned width, uint8_t *scan) {
+
+    switch (channels) {
+        case 1: {
+            memcpy(scan, planes[0], width);
+            break;
+        }
+        case 3: {
+            const uint8_t *p0 = planes[0], *p1 = planes[1], *p2 = planes[2];
+
+            for (unsigned column = 0; column < width; column++) {
+                scan[column * 3 + 0] = p0[column];
+                scan[column * 3 + 1] = p1[column];
+                scan[column * 3 + 2] = p2[column];
+            }
+            break;
+        }
+        case 4: {
+            const uint8_t *p0 = planes[0], *p1 = planes[1], *p2 = planes[2], *p3 = planes[3];
+
+            for (unsigned column = 0; column < width; column++) {
+                scan[column * 4 + 0] = p0[column];
+                scan[column * 4 + 1] = p1[column];
+                scan[column * 4 + 2] = p2[column];
+                scan[column * 4 + 3] = p3[column];
+            }
+            break;
+        }
+        default: {
+            for (unsigned column = 0; column < width; column++) {
+                for (unsigned channel = 0; channel < channels; channel++) {
+                    *scan++ = planes[channel][column];
+                }
+            }
+        }
+    }
+}
+
+/* Assembling samples from bytes swaps them to the native byte order on any platform. */
+#define PSD_SAMPLE16(plane, column) (uint16_t)((plane)[(column) * 2] << 8 | (plane)[(column) * 2 + 1])
+
+void psd_private_interleave16(const uint8_t *planes[4], unsigned channels, unsigned width, uint16_t *scan) {
+
+    switch (channels) {
+        case 1: {
+            const uint8_t *p0 = planes[0];
+
+            for (unsigned column = 0; column < width; column++) {
+                scan[column] = PSD_SAMPLE16(p0, column);
+            }
+            break;
+        }
+        case 3: {
+            const uint8_t *p0 = planes[0], *p1 = planes[1], *p2 = planes[2];
+
+            for (unsigned column = 0; column < width; column++) {
+                scan[column * 3 + 0] = PSD_SAMPLE16(p0, column);
+                scan[column * 3 + 1] = PSD_SAMPLE16(p1, column);
+                scan[column * 3 + 2] = PSD_SAMPLE16(p2, column);
+            }
+            break;
+        }
+        case 4: {
+            const uint8_t *p0 = planes[0], *p1 = planes[1], *p2 = planes[2], *p3 = planes[3];
+
+            for (unsigned column = 0; column < width; column++) {
+                scan[column * 4 + 0] = PSD_SAMPLE16(p0, column);
+                scan[column * 4 + 1] = PSD_SAMPLE16(p1, column);
+                scan[column * 4 + 2] = PSD_SAMPLE16(p2, column);
+                scan[column * 4 + 3] = PSD_SAMPLE16(p3, column);
+            }
+            break;
+        }
+        default: {
+            for (unsigned column = 0; column < width; column++) {
+                for (unsigned channel = 0; channel < channels; channel++) {
+                    *scan++ = PSD_SAMPLE16(planes[channel], column);
+                }
+            }
+        }
+    }
+}
+
+#undef PSD_SAMPLE16
+
+bool psd_private_tuning_key_value_callback(const char *key, const struct sail_variant *value, void *user_data) {
+
+    struct psd_load_tuning *load_tuning = user_data;
+
+    if (strcmp(key, "psd-threads") == 0) {
+        if (value->type == SAIL_VARIANT_TYPE_UNSIGNED_INT) {
+            load_tuning->threads = sail_variant_to_unsigned_int(value);
+            SAIL_LOG_TRACE("PSD: Threads: %u", load_tuning->threads);
+        }
+    }
+
+    return true;
+}
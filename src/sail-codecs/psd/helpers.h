@@ -26,6 +26,8 @@
 #ifndef SAIL_PSD_HELPERS_H
 #define SAIL_PSD_HELPERS_H
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include <sail-common/common.h>
@@ -52,7 +54,14 @@ enum SailPsdCompression {
     SAIL_PSD_COMPRESSION_ZIP_WITH_PREDICTION    = 3,
 };
 
+/* Load tuning. */
+struct psd_load_tuning {
+    /* Number of threads to decode channels with. 0 means the OpenMP default. */
+    unsigned threads;
+};
+
 struct sail_io;
+struct sail_variant;
 
 SAIL_HIDDEN sail_status_t psd_private_get_big_endian_uint16_t(struct sail_io *io, uint16_t *v);
 
@@ -62,4 +71,21 @@ SAIL_HIDDEN sail_status_t psd_private_sail_pixel_format(enum SailPsdMode mode, u
 
 SAIL_HIDDEN enum SailCompression psd_private_sail_compression(enum SailPsdCompression compression);
 
+/*
+ * Unpacks a PackBits-compressed row of exactly 'dst_size' bytes.
+ */
+SAIL_HIDDEN sail_status_t psd_private_unpack_rle(const uint8_t *src, size_t src_size, uint8_t *dst, size_t dst_size);
+
+/*
+ * Interleave up to 4 planar rows of 8-bit samples into a scan line.
+ */
+SAIL_HIDDEN void psd_private_interleave8(const uint8_t *planes[4], unsigned channels, unsigned width, uint8_t *scan);
+
+/*
+ * Interleave up to 4 planar rows of big-endian 16-bit samples into a scan line of native 16-bit samples.
+ */
+SAIL_HIDDEN void psd_private_interleave16(const uint8_t *planes[4], unsigned channels, unsigned width, uint16_t *scan);
+
+SAIL_HIDDEN bool psd_private_tuning_key_value_callback(const char *key, const struct sail_variant *value, void *user_data);
+
 #endif
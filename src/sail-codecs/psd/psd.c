@@ -24,14 +24,23 @@
 */
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
 #include <sail-common/sail-common.h>
 
 #include "helpers.h"
 
+/* Number of rows to read from every channel at once. */
+#define PSD_STRIP_HEIGHT 64
+
 static const unsigned SAIL_PSD_MAGIC = 0x38425053;
 
 static const unsigned char SAIL_PSD_MONO_PALETTE[] = { 255, 255, 255, 0, 0, 0 };
@@ -45,12 +54,22 @@ struct psd_state {
     const struct sail_save_options *save_options;
 
     bool frame_loaded;
+    struct psd_load_tuning load_tuning;
 
     uint16_t channels;
     uint16_t depth;
     enum SailPsdCompression compression;
+    /* Size of a row of a single channel. */
     unsigned bytes_per_channel;
-    unsigned char *scan_buffer;
+    /* Offset of the image data in the file. */
+    size_t data_offset;
+    /* Offsets of every channel row in the RLE data. Channels are stored one after another. */
+    uint64_t *row_offsets;
+    /* RLE data of the current strip. */
+    unsigned char *compressed;
+    size_t compressed_size;
+    /* Planar rows of the current strip, PSD_STRIP_HEIGHT rows per channel. */
+    unsigned char *planes;
     struct sail_palette *palette;
 };
 
@@ -69,12 +88,17 @@ static sail_status_t alloc_psd_state(struct sail_io *io,
         .save_options = save_options,
 
         .frame_loaded      = false,
+        .load_tuning       = { .threads = 0 },
 
         .channels          = 0,
         .depth             = 0,
         .compression       = SAIL_PSD_COMPRESSION_NONE,
         .bytes_per_channel = 0,
-        .scan_buffer       = NULL,
+        .data_offset       = 0,
+        .row_offsets       = NULL,
+        .compressed        = NULL,
+        .compressed_size   = 0,
+        .planes            = NULL,
         .palette           = NULL,
     };
 
@@ -87,7 +111,9 @@ static void destroy_psd_state(struct psd_state *psd_state) {
         return;
     }
 
-    sail_free(psd_state->scan_buffer);
+    sail_free(psd_state->row_offsets);
+    sail_free(psd_state->compressed);
+    sail_free(psd_state->planes);
 
     sail_destroy_palette(psd_state->palette);
 
@@ -124,6 +150,11 @@ SAIL_EXPORT sail_status_t sail_codec_load_init_v8_psd(struct sail_io *io, const
         SAIL_LOG_AND_RETURN(SAIL_ERROR_BROKEN_IMAGE);
     }
 
+    /* Handle tuning. */
+    if (psd_state->load_options->tuning != NULL) {
+        sail_traverse_hash_map_with_user_data(psd_state->load_options->tuning, psd_private_tuning_key_value_callback, &psd_state->load_tuning);
+    }
+
     return SAIL_OK;
 }
 
@@ -196,24 +227,47 @@ SAIL_EXPORT sail_status_t sail_codec_load_seek_next_frame_v8_psd(void *state, st
 
     psd_state->compression = compression;
 
-    /* Skip byte counts for all the scan lines. */
-    if (psd_state->compression == SAIL_PSD_COMPRESSION_RLE) {
-        SAIL_TRY(psd_state->io->seek(psd_state->io->stream, (long)height * psd_state->channels * 2, SEEK_CUR));
+    if (width == 0 || height == 0) {
+        SAIL_LOG_ERROR("PSD: Invalid image dimensions %ux%u", width, height);
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_INCORRECT_IMAGE_DIMENSIONS);
     }
 
-    /* Used to optimize uncompressed readings. */
-    if (psd_state->compression == SAIL_PSD_COMPRESSION_NONE) {
-        psd_state->bytes_per_channel = ((unsigned)width * psd_state->depth + 7) / 8;
+    SAIL_LOG_TRACE("PSD: mode(%u), channels(%u), depth(%u)", mode, psd_state->channels, psd_state->depth);
+
+    enum SailPixelFormat pixel_format;
+    SAIL_TRY(psd_private_sail_pixel_format(mode, psd_state->channels, psd_state->depth, &pixel_format));
+
+    /* Every channel row is stored separately. */
+    psd_state->bytes_per_channel = ((unsigned)width * psd_state->depth + 7) / 8;
+
+    /* Turn the byte counts of all the RLE rows into offsets, so every row can be found up front. */
+    if (psd_state->compression == SAIL_PSD_COMPRESSION_RLE) {
+        const size_t rows = (size_t)height * psd_state->channels;
 
         void *ptr;
-        SAIL_TRY(sail_malloc(psd_state->bytes_per_channel, &ptr));
-        psd_state->scan_buffer = ptr;
+        SAIL_TRY(sail_malloc((rows + 1) * sizeof(uint64_t), &ptr));
+        psd_state->row_offsets = ptr;
+
+        SAIL_TRY(sail_malloc(rows * 2, &ptr));
+        uint8_t *byte_counts = ptr;
+
+        SAIL_TRY_OR_CLEANUP(psd_state->io->strict_read(psd_state->io->stream, byte_counts, rows * 2),
+                            /* cleanup */ sail_free(byte_counts));
+
+        psd_state->row_offsets[0] = 0;
+
+        for (size_t i = 0; i < rows; i++) {
+            psd_state->row_offsets[i + 1] = psd_state->row_offsets[i] + (unsigned)(byte_counts[i * 2] << 8 | byte_counts[i * 2 + 1]);
+        }
+
+        sail_free(byte_counts);
     }
 
-    SAIL_LOG_TRACE("PSD: mode(%u), channels(%u), depth(%u)", mode, psd_state->channels, psd_state->depth);
+    SAIL_TRY(psd_state->io->tell(psd_state->io->stream, &psd_state->data_offset));
 
-    enum SailPixelFormat pixel_format;
-    SAIL_TRY(psd_private_sail_pixel_format(mode, psd_state->channels, psd_state->depth, &pixel_format));
+    void *ptr;
+    SAIL_TRY(sail_malloc((size_t)PSD_STRIP_HEIGHT * psd_state->channels * psd_state->bytes_per_channel, &ptr));
+    psd_state->planes = ptr;
 
     /* Allocate image. */
     struct sail_image *image_local;
@@ -241,56 +295,111 @@ SAIL_EXPORT sail_status_t sail_codec_load_seek_next_frame_v8_psd(void *state, st
     return SAIL_OK;
 }
 
+/* Reads the RLE data of the strip of every channel one after another into the strip buffer. */
+static sail_status_t read_rle_strip(struct psd_state *psd_state, unsigned height, unsigned strip_row, unsigned strip_height,
+                                    size_t channel_offsets[4]) {
+
+    size_t size = 0;
+
+    for (unsigned channel = 0; channel < psd_state->channels; channel++) {
+        const size_t first = (size_t)channel * height + strip_row;
+
+        channel_offsets[channel] = size;
+        size += (size_t)(psd_state->row_offsets[first + strip_height] - psd_state->row_offsets[first]);
+    }
+
+    if (size > psd_state->compressed_size) {
+        void *ptr = psd_state->compressed;
+        SAIL_TRY(sail_realloc(size, &ptr));
+        psd_state->compressed      = ptr;
+        psd_state->compressed_size = size;
+    }
+
+    for (unsigned channel = 0; channel < psd_state->channels; channel++) {
+        const size_t first = (size_t)channel * height + strip_row;
+        const size_t channel_size = (size_t)(psd_state->row_offsets[first + strip_height] - psd_state->row_offsets[first]);
+
+        SAIL_TRY(psd_state->io->seek(psd_state->io->stream, (long)(psd_state->data_offset + psd_state->row_offsets[first]), SEEK_SET));
+        SAIL_TRY(psd_state->io->strict_read(psd_state->io->stream, psd_state->compressed + channel_offsets[channel], channel_size));
+    }
+
+    return SAIL_OK;
+}
+
+/* Reads the uncompressed strip of every channel directly into the planes. */
+static sail_status_t read_raw_strip(struct psd_state *psd_state, unsigned height, unsigned strip_row, unsigned strip_height) {
+
+    const size_t plane_size = (size_t)PSD_STRIP_HEIGHT * psd_state->bytes_per_channel;
+
+    for (unsigned channel = 0; channel < psd_state->channels; channel++) {
+        const size_t offset = ((size_t)channel * height + strip_row) * psd_state->bytes_per_channel;
+
+        SAIL_TRY(psd_state->io->seek(psd_state->io->stream, (long)(psd_state->data_offset + offset), SEEK_SET));
+        SAIL_TRY(psd_state->io->strict_read(psd_state->io->stream, psd_state->planes + channel * plane_size,
+                                            (size_t)strip_height * psd_state->bytes_per_channel));
+    }
+
+    return SAIL_OK;
+}
+
 SAIL_EXPORT sail_status_t sail_codec_load_frame_v8_psd(void *state, struct sail_image *image) {
 
-    const struct psd_state *psd_state = state;
+    struct psd_state *psd_state = state;
 
-    const unsigned bpp = (psd_state->channels * psd_state->depth + 7) / 8;
+#ifdef _OPENMP
+    const int threads = psd_state->load_tuning.threads > 0 ? (int)psd_state->load_tuning.threads : omp_get_max_threads();
+#endif
 
-    if (psd_state->compression == SAIL_PSD_COMPRESSION_RLE) {
-        for (unsigned channel = 0; channel < psd_state->channels; channel++) {
-            for (unsigned row = 0; row < image->height; row++) {
-                for (unsigned count = 0; count < image->width; ) {
-                    unsigned char c;
-                    SAIL_TRY(psd_state->io->strict_read(psd_state->io->stream, &c, sizeof(c)));
-
-                    if (c > 128) {
-                        c ^= 0xff;
-                        c += 2;
-
-                        unsigned char value;
-                        SAIL_TRY(psd_state->io->strict_read(psd_state->io->stream, &value, sizeof(value)));
-
-                        for (unsigned i = count; i < count + c; i++) {
-                            unsigned char *scan = (unsigned char *)sail_scan_line(image, row) + i * bpp;
-                            *(scan + channel) = value;
-                        }
-                    } else if (c < 128) {
-                        c++;
-
-                        for (unsigned i = count; i < count + c; i++) {
-                            unsigned char value;
-                            SAIL_TRY(psd_state->io->strict_read(psd_state->io->stream, &value, sizeof(value)));
-
-                            unsigned char *scan = (unsigned char *)sail_scan_line(image, row) + i * bpp;
-                            *(scan + channel) = value;
-                        }
-                    }
+    const bool rle = psd_state->compression == SAIL_PSD_COMPRESSION_RLE;
+    const size_t plane_size = (size_t)PSD_STRIP_HEIGHT * psd_state->bytes_per_channel;
 
-                    count += c;
-                }
-            }
+    for (unsigned strip_row = 0; strip_row < image->height; strip_row += PSD_STRIP_HEIGHT) {
+        const unsigned strip_height = SAIL_MIN(image->height - strip_row, PSD_STRIP_HEIGHT);
+        size_t channel_offsets[4] = { 0, 0, 0, 0 };
+
+        if (rle) {
+            SAIL_TRY(read_rle_strip(psd_state, image->height, strip_row, strip_height, channel_offsets));
+        } else {
+            SAIL_TRY(read_raw_strip(psd_state, image->height, strip_row, strip_height));
         }
-    } else {
-        for (unsigned channel = 0; channel < psd_state->channels; channel++) {
-            for (unsigned row = 0; row < image->height; row++) {
-                SAIL_TRY(psd_state->io->strict_read(psd_state->io->stream, psd_state->scan_buffer, psd_state->bytes_per_channel));
-
-                for (unsigned count = 0; count < psd_state->bytes_per_channel; count++) {
-                    unsigned char *scan = (unsigned char *)sail_scan_line(image, row) + count * bpp;
-                    *(scan + channel) = *(psd_state->scan_buffer + count);
+
+        /* Every row of every channel is compressed separately, so rows are unpacked and merged in parallel. */
+        bool failed = false;
+        unsigned row;
+
+        #pragma omp parallel for schedule(SAIL_OPENMP_SCHEDULE) num_threads(threads)
+        for (row = 0; row < strip_height; row++) {
+            const uint8_t *planes[4] = { NULL, NULL, NULL, NULL };
+
+            for (unsigned channel = 0; channel < psd_state->channels; channel++) {
+                uint8_t *plane = psd_state->planes + channel * plane_size + (size_t)row * psd_state->bytes_per_channel;
+
+                if (rle) {
+                    const size_t first = (size_t)channel * image->height + strip_row;
+                    const uint64_t src_offset = psd_state->row_offsets[first + row] - psd_state->row_offsets[first];
+                    const uint64_t src_size   = psd_state->row_offsets[first + row + 1] - psd_state->row_offsets[first + row];
+
+                    if (psd_private_unpack_rle(psd_state->compressed + channel_offsets[channel] + src_offset, (size_t)src_size,
+                                                plane, psd_state->bytes_per_channel) != SAIL_OK) {
+                        #pragma omp atomic write
+                        failed = true;
+                    }
                 }
+
+                planes[channel] = plane;
             }
+
+            if (psd_state->depth == 16) {
+                psd_private_interleave16(planes, psd_state->channels, image->width, sail_scan_line(image, strip_row + row));
+            } else {
+                /* 1-bit images have a single channel copied as is. */
+                psd_private_interleave8(planes, psd_state->channels, psd_state->bytes_per_channel, sail_scan_line(image, strip_row + row));
+            }
+        }
+
+        if (failed) {
+            SAIL_LOG_ERROR("PSD: Failed to decode rows #%u-#%u", strip_row, strip_row + strip_height - 1);
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_BROKEN_IMAGE);
         }
     }
 
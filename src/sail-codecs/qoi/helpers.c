@@ -0,0 +1,66 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <string.h>
+
+#include <sail-common/sail-common.h>
+
+#include "helpers.h"
+
+bool qoi_private_is_supported_pixel_format(enum SailPixelFormat pixel_format) {
+
+    switch (pixel_format) {
+        case SAIL_PIXEL_FORMAT_BPP24_RGB:
+        case SAIL_PIXEL_FORMAT_BPP24_BGR:
+        case SAIL_PIXEL_FORMAT_BPP32_RGBA:
+        case SAIL_PIXEL_FORMAT_BPP32_BGRA: {
+            return true;
+        }
+        default: {
+            return false;
+        }
+    }
+}
+
+bool qoi_private_tuning_key_value_callback(const char *key, const struct sail_variant *value, void *user_data) {
+
+    struct qoi_load_tuning *load_tuning = user_data;
+
+    if (strcmp(key, "qoi-pixel-format") == 0) {
+        if (value->type == SAIL_VARIANT_TYPE_STRING) {
+            const char *str_value = sail_variant_to_string(value);
+            const enum SailPixelFormat pixel_format = sail_pixel_format_from_string(str_value);
+
+            if (qoi_private_is_supported_pixel_format(pixel_format)) {
+                load_tuning->pixel_format = pixel_format;
+                SAIL_LOG_TRACE("QOI: Pixel format: %s", str_value);
+            } else {
+                SAIL_LOG_ERROR("QOI: Unsupported pixel format '%s'", str_value);
+            }
+        }
+    }
+
+    return true;
+}
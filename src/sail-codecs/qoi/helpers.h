@@ -0,0 +1,46 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_QOI_HELPERS_H
+#define SAIL_QOI_HELPERS_H
+
+#include <stdbool.h>
+
+#include <sail-common/common.h>
+#include <sail-common/export.h>
+
+struct sail_variant;
+
+/* Load tuning. */
+struct qoi_load_tuning {
+    /* Pixel format to decode into. SAIL_PIXEL_FORMAT_UNKNOWN selects the format stored in the file. */
+    enum SailPixelFormat pixel_format;
+};
+
+SAIL_HIDDEN bool qoi_private_is_supported_pixel_format(enum SailPixelFormat pixel_format);
+
+SAIL_HIDDEN bool qoi_private_tuning_key_value_callback(const char *key, const struct sail_variant *value, void *user_data);
+
+#endif
@@ -24,16 +24,12 @@
 */
 
 #include <stdbool.h>
-#include <stdio.h>
-#include <string.h>
+#include <stddef.h>
 
 #include <sail-common/sail-common.h>
 
-#define QOI_MALLOC sail_malloc_std_signature
-#define QOI_FREE sail_free
-#define QOI_IMPLEMENTATION
-#define QOI_NO_STDIO
-#include "qoi.h"
+#include "helpers.h"
+#include "stream.h"
 
 /*
  * Codec-specific state.
@@ -46,11 +42,10 @@ struct qoi_state {
     bool frame_loaded;
     bool frame_saved;
 
-    void *image_data;
-    size_t image_data_size;
-    void *pixels;
+    struct qoi_load_tuning load_tuning;
 
-    qoi_desc qoi_desc;
+    struct qoi_private_decoder *decoder;
+    struct qoi_private_encoder *encoder;
 };
 
 static sail_status_t alloc_qoi_state(struct sail_io *io,
@@ -70,9 +65,10 @@ static sail_status_t alloc_qoi_state(struct sail_io *io,
         .frame_loaded = false,
         .frame_saved  = false,
 
-        .image_data      = NULL,
-        .image_data_size = 0,
-        .pixels          = NULL,
+        .load_tuning = { .pixel_format = SAIL_PIXEL_FORMAT_UNKNOWN },
+
+        .decoder = NULL,
+        .encoder = NULL,
     };
 
     return SAIL_OK;
@@ -84,8 +80,8 @@ static void destroy_qoi_state(struct qoi_state *qoi_state) {
         return;
     }
 
-    sail_free(qoi_state->image_data);
-    sail_free(qoi_state->pixels);
+    sail_free(qoi_state->decoder);
+    sail_free(qoi_state->encoder);
 
     sail_free(qoi_state);
 }
@@ -103,8 +99,15 @@ SAIL_EXPORT sail_status_t sail_codec_load_init_v8_qoi(struct sail_io *io, const
     SAIL_TRY(alloc_qoi_state(io, load_options, NULL, &qoi_state));
     *state = qoi_state;
 
-    /* Cache the entire file as the QOI API requires. */
-    SAIL_TRY(sail_alloc_data_from_io_contents(io, &qoi_state->image_data, &qoi_state->image_data_size));
+    /* Handle tuning. */
+    if (qoi_state->load_options->tuning != NULL) {
+        sail_traverse_hash_map_with_user_data(qoi_state->load_options->tuning, qoi_private_tuning_key_value_callback, &qoi_state->load_tuning);
+    }
+
+    /* The pixels are decoded in chunks, so the file is never cached entirely. */
+    void *ptr;
+    SAIL_TRY(sail_malloc(sizeof(struct qoi_private_decoder), &ptr));
+    qoi_state->decoder = ptr;
 
     return SAIL_OK;
 }
@@ -119,26 +122,20 @@ SAIL_EXPORT sail_status_t sail_codec_load_seek_next_frame_v8_qoi(void *state, st
 
     qoi_state->frame_loaded = true;
 
-    /* Decode the image. */
-    /* TODO Remove (int) when QOI supports size_t. */
-    qoi_state->pixels = qoi_decode(qoi_state->image_data, (int)qoi_state->image_data_size, &qoi_state->qoi_desc, 0);
-
-    if (qoi_state->pixels == NULL) {
-        SAIL_LOG_ERROR("QOI: Image is broken without any details");
-        SAIL_LOG_AND_RETURN(SAIL_ERROR_BROKEN_IMAGE);
-    }
+    struct qoi_private_header header;
+    SAIL_TRY(qoi_private_decoder_init(qoi_state->decoder, qoi_state->io, &header));
 
-    if (qoi_state->qoi_desc.colorspace != QOI_SRGB) {
+    if (header.colorspace != QOI_PRIVATE_SRGB) {
         SAIL_LOG_ERROR("QOI: Only RGB images are supported");
         SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
     }
 
-    enum SailPixelFormat pixel_format;
-    switch (qoi_state->qoi_desc.channels) {
-        case 3: pixel_format = SAIL_PIXEL_FORMAT_BPP24_RGB;  break;
-        case 4: pixel_format = SAIL_PIXEL_FORMAT_BPP32_RGBA; break;
+    enum SailPixelFormat source_pixel_format;
+    switch (header.channels) {
+        case 3: source_pixel_format = SAIL_PIXEL_FORMAT_BPP24_RGB;  break;
+        case 4: source_pixel_format = SAIL_PIXEL_FORMAT_BPP32_RGBA; break;
         default: {
-            SAIL_LOG_ERROR("QOI: Number of channels is %d, but only RGB24 and RGB32 images are supported", qoi_state->qoi_desc.channels);
+            SAIL_LOG_ERROR("QOI: Number of channels is %u, but only RGB24 and RGB32 images are supported", header.channels);
             SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
         }
     }
@@ -151,13 +148,15 @@ SAIL_EXPORT sail_status_t sail_codec_load_seek_next_frame_v8_qoi(void *state, st
         SAIL_TRY_OR_CLEANUP(sail_alloc_source_image(&image_local->source_image),
                             /* cleanup */ sail_destroy_image(image_local));
 
-        image_local->source_image->pixel_format = pixel_format;
+        image_local->source_image->pixel_format = source_pixel_format;
         image_local->source_image->compression  = SAIL_COMPRESSION_QOI;
     }
 
-    image_local->width          = qoi_state->qoi_desc.width;
-    image_local->height         = qoi_state->qoi_desc.height;
-    image_local->pixel_format   = pixel_format;
+    image_local->width          = header.width;
+    image_local->height         = header.height;
+    image_local->pixel_format   = (qoi_state->load_tuning.pixel_format == SAIL_PIXEL_FORMAT_UNKNOWN)
+                                    ? source_pixel_format
+                                    : qoi_state->load_tuning.pixel_format;
     image_local->bytes_per_line = sail_bytes_per_line(image_local->width, image_local->pixel_format);
 
     *image = image_local;
@@ -167,11 +166,11 @@ SAIL_EXPORT sail_status_t sail_codec_load_seek_next_frame_v8_qoi(void *state, st
 
 SAIL_EXPORT sail_status_t sail_codec_load_frame_v8_qoi(void *state, struct sail_image *image) {
 
-    const struct qoi_state *qoi_state = state;
-
-    const size_t pixels_size = (size_t)image->bytes_per_line * image->height;
+    struct qoi_state *qoi_state = state;
 
-    memcpy(image->pixels, qoi_state->pixels, pixels_size);
+    for (unsigned row = 0; row < image->height; row++) {
+        SAIL_TRY(qoi_private_decode_row(qoi_state->decoder, sail_scan_line(image, row), image->width, image->pixel_format));
+    }
 
     return SAIL_OK;
 }
@@ -205,6 +204,10 @@ SAIL_EXPORT sail_status_t sail_codec_save_init_v8_qoi(struct sail_io *io, const
         SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_COMPRESSION);
     }
 
+    void *ptr;
+    SAIL_TRY(sail_malloc(sizeof(struct qoi_private_encoder), &ptr));
+    qoi_state->encoder = ptr;
+
     return SAIL_OK;
 }
 
@@ -212,30 +215,26 @@ SAIL_EXPORT sail_status_t sail_codec_save_seek_next_frame_v8_qoi(void *state, co
 
     struct qoi_state *qoi_state = state;
 
-    unsigned char channels;
-
-    switch (image->pixel_format) {
-        case SAIL_PIXEL_FORMAT_BPP24_RGB:  channels = 3; break;
-        case SAIL_PIXEL_FORMAT_BPP32_RGBA: channels = 4; break;
-        default: {
-            SAIL_LOG_ERROR("QOI: %s pixel format is not currently supported for saving", sail_pixel_format_to_string(image->pixel_format));
-            SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
-        }
+    if (qoi_state->frame_saved) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_NO_MORE_FRAMES);
     }
 
-    int written;
-    qoi_state->pixels = qoi_encode(image->pixels, &(qoi_desc){
-    	                    .width      = image->width,
-                    	    .height     = image->height,
-                        	.channels   = channels,
-                        	.colorspace = QOI_SRGB
-                        }, &written);
-
-    if (qoi_state->pixels == NULL) {
-        SAIL_LOG_ERROR("QOI: Encoding failed without any details");
-        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+    qoi_state->frame_saved = true;
+
+    if (!qoi_private_is_supported_pixel_format(image->pixel_format)) {
+        SAIL_LOG_ERROR("QOI: %s pixel format is not currently supported for saving", sail_pixel_format_to_string(image->pixel_format));
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
     }
 
+    const struct qoi_private_header header = {
+        .width      = image->width,
+        .height     = image->height,
+        .channels   = (sail_bits_per_pixel(image->pixel_format) == 32) ? 4 : 3,
+        .colorspace = QOI_PRIVATE_SRGB,
+    };
+
+    SAIL_TRY(qoi_private_encoder_init(qoi_state->encoder, qoi_state->io, &header));
+
     return SAIL_OK;
 }
 
@@ -243,9 +242,11 @@ SAIL_EXPORT sail_status_t sail_codec_save_frame_v8_qoi(void *state, const struct
 
     struct qoi_state *qoi_state = state;
 
-    const size_t pixels_size = (size_t)image->bytes_per_line * image->height;
+    for (unsigned row = 0; row < image->height; row++) {
+        SAIL_TRY(qoi_private_encode_row(qoi_state->encoder, sail_scan_line(image, row), image->width, image->pixel_format));
+    }
 
-    SAIL_TRY(qoi_state->io->strict_write(qoi_state->io->stream, qoi_state->pixels, pixels_size));
+    SAIL_TRY(qoi_private_encoder_finish(qoi_state->encoder));
 
     return SAIL_OK;
 }
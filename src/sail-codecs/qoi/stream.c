@@ -0,0 +1,383 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <sail-common/sail-common.h>
+
+#include "stream.h"
+
+#define QOI_OP_INDEX 0x00 /* 00xxxxxx */
+#define QOI_OP_DIFF  0x40 /* 01xxxxxx */
+#define QOI_OP_LUMA  0x80 /* 10xxxxxx */
+#define QOI_OP_RUN   0xc0 /* 11xxxxxx */
+#define QOI_OP_RGB   0xfe /* 11111110 */
+#define QOI_OP_RGBA  0xff /* 11111111 */
+
+#define QOI_MASK_2   0xc0 /* 11000000 */
+
+#define QOI_HEADER_SIZE 14
+
+/* The longest chunk is QOI_OP_RGBA. */
+#define QOI_MAX_CHUNK_SIZE 5
+
+/* Same limit as in the reference implementation to reject unreasonable dimensions early. */
+#define QOI_PIXELS_MAX 400000000U
+
+#define QOI_COLOR_HASH(p) (((unsigned)(p)[0] * 3 + (unsigned)(p)[1] * 5 + (unsigned)(p)[2] * 7 + (unsigned)(p)[3] * 11) % 64)
+
+static const unsigned char QOI_MAGIC[4] = { 'q', 'o', 'i', 'f' };
+
+static const unsigned char QOI_PADDING[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+
+static uint32_t read_be32(const unsigned char *bytes) {
+
+    return (uint32_t)bytes[0] << 24 | (uint32_t)bytes[1] << 16 | (uint32_t)bytes[2] << 8 | bytes[3];
+}
+
+static void write_be32(unsigned char *bytes, uint32_t value) {
+
+    bytes[0] = (unsigned char)(value >> 24);
+    bytes[1] = (unsigned char)(value >> 16);
+    bytes[2] = (unsigned char)(value >> 8);
+    bytes[3] = (unsigned char)value;
+}
+
+/*
+ * Decoding functions.
+ */
+
+/* Moves the unread bytes to the beginning of the buffer and reads the next chunk after them. */
+static sail_status_t fill_buffer(struct qoi_private_decoder *decoder) {
+
+    const size_t left = decoder->buffer_size - decoder->buffer_pos;
+
+    memmove(decoder->buffer, decoder->buffer + decoder->buffer_pos, left);
+    decoder->buffer_pos  = 0;
+    decoder->buffer_size = left;
+
+    size_t read_size = 0;
+    const sail_status_t status = decoder->io->tolerant_read(decoder->io->stream, decoder->buffer + left,
+                                                            sizeof(decoder->buffer) - left, &read_size);
+
+    /* The end of file is fine here. Missing chunks are detected by the caller. */
+    if (status != SAIL_ERROR_EOF) {
+        SAIL_TRY(status);
+        decoder->buffer_size += read_size;
+    }
+
+    return SAIL_OK;
+}
+
+sail_status_t qoi_private_decoder_init(struct qoi_private_decoder *decoder, struct sail_io *io,
+                                        struct qoi_private_header *header) {
+
+    unsigned char bytes[QOI_HEADER_SIZE];
+    SAIL_TRY(io->strict_read(io->stream, bytes, sizeof(bytes)));
+
+    if (memcmp(bytes, QOI_MAGIC, sizeof(QOI_MAGIC)) != 0) {
+        SAIL_LOG_ERROR("QOI: Invalid magic number");
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_BROKEN_IMAGE);
+    }
+
+    header->width      = read_be32(bytes + 4);
+    header->height     = read_be32(bytes + 8);
+    header->channels   = bytes[12];
+    header->colorspace = bytes[13];
+
+    if (header->width == 0 || header->height == 0 || header->height >= QOI_PIXELS_MAX / header->width) {
+        SAIL_LOG_ERROR("QOI: Invalid image dimensions %ux%u", header->width, header->height);
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_INCORRECT_IMAGE_DIMENSIONS);
+    }
+
+    decoder->io          = io;
+    decoder->buffer_pos  = 0;
+    decoder->buffer_size = 0;
+    decoder->run         = 0;
+
+    memset(decoder->index, 0, sizeof(decoder->index));
+    memcpy(decoder->pixel, (uint8_t[4]){ 0, 0, 0, 255 }, sizeof(decoder->pixel));
+
+    return SAIL_OK;
+}
+
+/*
+ * Decodes a row with the specified output layout. 'r' and 'b' are the byte offsets of the red
+ * and blue channels. Called with constant arguments, so every layout gets its own loop.
+ */
+static inline sail_status_t decode_row(struct qoi_private_decoder *decoder, uint8_t *row, unsigned width,
+                                        unsigned channels, unsigned r, unsigned b) {
+
+    uint8_t pixel[4];
+    memcpy(pixel, decoder->pixel, sizeof(pixel));
+    unsigned run = decoder->run;
+
+    for (unsigned x = 0; x < width; x++, row += channels) {
+        if (run > 0) {
+            run--;
+        } else {
+            if (decoder->buffer_size - decoder->buffer_pos < QOI_MAX_CHUNK_SIZE) {
+                SAIL_TRY(fill_buffer(decoder));
+            }
+
+            const unsigned char *bytes = decoder->buffer + decoder->buffer_pos;
+            const size_t available = decoder->buffer_size - decoder->buffer_pos;
+
+            if (available == 0) {
+                SAIL_LOG_ERROR("QOI: Unexpected end of file");
+                SAIL_LOG_AND_RETURN(SAIL_ERROR_BROKEN_IMAGE);
+            }
+
+            const unsigned op = bytes[0];
+            const size_t chunk_size = (op == QOI_OP_RGBA) ? 5
+                                        : (op == QOI_OP_RGB) ? 4
+                                        : ((op & QOI_MASK_2) == QOI_OP_LUMA) ? 2 : 1;
+
+            if (available < chunk_size) {
+                SAIL_LOG_ERROR("QOI: Unexpected end of file");
+                SAIL_LOG_AND_RETURN(SAIL_ERROR_BROKEN_IMAGE);
+            }
+
+            if (op == QOI_OP_RGB) {
+                pixel[0] = bytes[1];
+                pixel[1] = bytes[2];
+                pixel[2] = bytes[3];
+            } else if (op == QOI_OP_RGBA) {
+                pixel[0] = bytes[1];
+                pixel[1] = bytes[2];
+                pixel[2] = bytes[3];
+                pixel[3] = bytes[4];
+            } else {
+                switch (op & QOI_MASK_2) {
+                    case QOI_OP_INDEX: {
+                        memcpy(pixel, decoder->index[op], sizeof(pixel));
+                        break;
+                    }
+                    case QOI_OP_DIFF: {
+                        pixel[0] += ((op >> 4) & 0x03) - 2;
+                        pixel[1] += ((op >> 2) & 0x03) - 2;
+                        pixel[2] += ( op       & 0x03) - 2;
+                        break;
+                    }
+                    case QOI_OP_LUMA: {
+                        const int vg = (int)(op & 0x3f) - 32;
+                        pixel[0] += vg - 8 + ((bytes[1] >> 4) & 0x0f);
+                        pixel[1] += vg;
+                        pixel[2] += vg - 8 +  (bytes[1]       & 0x0f);
+                        break;
+                    }
+                    default: {
+                        run = op & 0x3f;
+                        break;
+                    }
+                }
+            }
+
+            decoder->buffer_pos += chunk_size;
+            memcpy(decoder->index[QOI_COLOR_HASH(pixel)], pixel, sizeof(pixel));
+        }
+
+        row[r] = pixel[0];
+        row[1] = pixel[1];
+        row[b] = pixel[2];
+
+        if (channels == 4) {
+            row[3] = pixel[3];
+        }
+    }
+
+    memcpy(decoder->pixel, pixel, sizeof(pixel));
+    decoder->run = run;
+
+    return SAIL_OK;
+}
+
+sail_status_t qoi_private_decode_row(struct qoi_private_decoder *decoder, void *row, unsigned width,
+                                        enum SailPixelFormat pixel_format) {
+
+    switch (pixel_format) {
+        case SAIL_PIXEL_FORMAT_BPP24_RGB:  return decode_row(decoder, row, width, 3, 0, 2);
+        case SAIL_PIXEL_FORMAT_BPP24_BGR:  return decode_row(decoder, row, width, 3, 2, 0);
+        case SAIL_PIXEL_FORMAT_BPP32_RGBA: return decode_row(decoder, row, width, 4, 0, 2);
+        case SAIL_PIXEL_FORMAT_BPP32_BGRA: return decode_row(decoder, row, width, 4, 2, 0);
+
+        default: {
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+        }
+    }
+}
+
+/*
+ * Encoding functions.
+ */
+
+static sail_status_t flush_buffer(struct qoi_private_encoder *encoder) {
+
+    SAIL_TRY(encoder->io->strict_write(encoder->io->stream, encoder->buffer, encoder->buffer_size));
+    encoder->buffer_size = 0;
+
+    return SAIL_OK;
+}
+
+sail_status_t qoi_private_encoder_init(struct qoi_private_encoder *encoder, struct sail_io *io,
+                                        const struct qoi_private_header *header) {
+
+    if (header->width == 0 || header->height == 0 || header->height >= QOI_PIXELS_MAX / header->width) {
+        SAIL_LOG_ERROR("QOI: Invalid image dimensions %ux%u", header->width, header->height);
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_INCORRECT_IMAGE_DIMENSIONS);
+    }
+
+    encoder->io  = io;
+    encoder->run = 0;
+
+    memset(encoder->index, 0, sizeof(encoder->index));
+    memcpy(encoder->pixel, (uint8_t[4]){ 0, 0, 0, 255 }, sizeof(encoder->pixel));
+
+    memcpy(encoder->buffer, QOI_MAGIC, sizeof(QOI_MAGIC));
+    write_be32(encoder->buffer + 4, header->width);
+    write_be32(encoder->buffer + 8, header->height);
+    encoder->buffer[12] = header->channels;
+    encoder->buffer[13] = header->colorspace;
+    encoder->buffer_size = QOI_HEADER_SIZE;
+
+    return SAIL_OK;
+}
+
+/*
+ * Encodes a row with the specified input layout. 'r' and 'b' are the byte offsets of the red
+ * and blue channels. Called with constant arguments, so every layout gets its own loop.
+ */
+static inline sail_status_t encode_row(struct qoi_private_encoder *encoder, const uint8_t *row, unsigned width,
+                                        unsigned channels, unsigned r, unsigned b) {
+
+    uint8_t previous[4];
+    memcpy(previous, encoder->pixel, sizeof(previous));
+    unsigned run = encoder->run;
+
+    for (unsigned x = 0; x < width; x++, row += channels) {
+        const uint8_t pixel[4] = { row[r], row[1], row[b], (channels == 4) ? row[3] : 255 };
+
+        /* A pending run and the longest chunk. */
+        if (sizeof(encoder->buffer) - encoder->buffer_size < 1 + QOI_MAX_CHUNK_SIZE) {
+            SAIL_TRY(flush_buffer(encoder));
+        }
+
+        unsigned char *bytes = encoder->buffer + encoder->buffer_size;
+
+        if (memcmp(pixel, previous, sizeof(pixel)) == 0) {
+            if (++run == 62) {
+                *bytes = QOI_OP_RUN | (run - 1);
+                encoder->buffer_size++;
+                run = 0;
+            }
+
+            continue;
+        }
+
+        if (run > 0) {
+            *bytes++ = QOI_OP_RUN | (run - 1);
+            run = 0;
+        }
+
+        const unsigned index_pos = QOI_COLOR_HASH(pixel);
+
+        if (memcmp(encoder->index[index_pos], pixel, sizeof(pixel)) == 0) {
+            *bytes++ = QOI_OP_INDEX | index_pos;
+        } else {
+            memcpy(encoder->index[index_pos], pixel, sizeof(pixel));
+
+            if (pixel[3] == previous[3]) {
+                const int8_t vr = (int8_t)(pixel[0] - previous[0]);
+                const int8_t vg = (int8_t)(pixel[1] - previous[1]);
+                const int8_t vb = (int8_t)(pixel[2] - previous[2]);
+
+                const int8_t vg_r = (int8_t)(vr - vg);
+                const int8_t vg_b = (int8_t)(vb - vg);
+
+                if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2) {
+                    *bytes++ = (unsigned char)(QOI_OP_DIFF | (vr + 2) << 4 | (vg + 2) << 2 | (vb + 2));
+                } else if (vg_r > -9 && vg_r < 8 && vg > -33 && vg < 32 && vg_b > -9 && vg_b < 8) {
+                    *bytes++ = (unsigned char)(QOI_OP_LUMA | (vg + 32));
+                    *bytes++ = (unsigned char)((vg_r + 8) << 4 | (vg_b + 8));
+                } else {
+                    *bytes++ = QOI_OP_RGB;
+                    *bytes++ = pixel[0];
+                    *bytes++ = pixel[1];
+                    *bytes++ = pixel[2];
+                }
+            } else {
+                *bytes++ = QOI_OP_RGBA;
+                *bytes++ = pixel[0];
+                *bytes++ = pixel[1];
+                *bytes++ = pixel[2];
+                *bytes++ = pixel[3];
+            }
+        }
+
+        encoder->buffer_size = (size_t)(bytes - encoder->buffer);
+        memcpy(previous, pixel, sizeof(previous));
+    }
+
+    memcpy(encoder->pixel, previous, sizeof(previous));
+    encoder->run = run;
+
+    return SAIL_OK;
+}
+
+sail_status_t qoi_private_encode_row(struct qoi_private_encoder *encoder, const void *row, unsigned width,
+                                        enum SailPixelFormat pixel_format) {
+
+    switch (pixel_format) {
+        case SAIL_PIXEL_FORMAT_BPP24_RGB:  return encode_row(encoder, row, width, 3, 0, 2);
+        case SAIL_PIXEL_FORMAT_BPP24_BGR:  return encode_row(encoder, row, width, 3, 2, 0);
+        case SAIL_PIXEL_FORMAT_BPP32_RGBA: return encode_row(encoder, row, width, 4, 0, 2);
+        case SAIL_PIXEL_FORMAT_BPP32_BGRA: return encode_row(encoder, row, width, 4, 2, 0);
+
+        default: {
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+        }
+    }
+}
+
+sail_status_t qoi_private_encoder_finish(struct qoi_private_encoder *encoder) {
+
+    if (sizeof(encoder->buffer) - encoder->buffer_size < 1 + sizeof(QOI_PADDING)) {
+        SAIL_TRY(flush_buffer(encoder));
+    }
+
+    if (encoder->run > 0) {
+        encoder->buffer[encoder->buffer_size++] = QOI_OP_RUN | (encoder->run - 1);
+        encoder->run = 0;
+    }
+
+    memcpy(encoder->buffer + encoder->buffer_size, QOI_PADDING, sizeof(QOI_PADDING));
+    encoder->buffer_size += sizeof(QOI_PADDING);
+
+    SAIL_TRY(flush_buffer(encoder));
+
+    return SAIL_OK;
+}
@@ -0,0 +1,111 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_QOI_STREAM_H
+#define SAIL_QOI_STREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <sail-common/common.h>
+#include <sail-common/export.h>
+
+struct sail_io;
+
+/* Size of the chunks read from and written to I/O. */
+#define QOI_PRIVATE_BUFFER_SIZE 65536
+
+#define QOI_PRIVATE_SRGB   0
+#define QOI_PRIVATE_LINEAR 1
+
+struct qoi_private_header {
+    uint32_t width;
+    uint32_t height;
+    uint8_t channels;
+    uint8_t colorspace;
+};
+
+/*
+ * Streaming QOI decoder. Reads the image data in chunks and decodes pixels row by row
+ * directly into the output buffer.
+ */
+struct qoi_private_decoder {
+    struct sail_io *io;
+
+    unsigned char buffer[QOI_PRIVATE_BUFFER_SIZE];
+    size_t buffer_pos;
+    size_t buffer_size;
+
+    uint8_t index[64][4];
+    uint8_t pixel[4];
+    unsigned run;
+};
+
+/*
+ * Streaming QOI encoder. Encodes pixels row by row and writes them in chunks.
+ */
+struct qoi_private_encoder {
+    struct sail_io *io;
+
+    unsigned char buffer[QOI_PRIVATE_BUFFER_SIZE];
+    size_t buffer_size;
+
+    uint8_t index[64][4];
+    uint8_t pixel[4];
+    unsigned run;
+};
+
+/*
+ * Reads the file header and prepares the decoder to decode pixels.
+ */
+SAIL_HIDDEN sail_status_t qoi_private_decoder_init(struct qoi_private_decoder *decoder, struct sail_io *io,
+                                                    struct qoi_private_header *header);
+
+/*
+ * Decodes the next row of 'width' pixels into 'row' in the specified pixel format. Only BPP24-RGB,
+ * BPP24-BGR, BPP32-RGBA, and BPP32-BGRA are supported. Alpha is dropped from 24-bit rows.
+ */
+SAIL_HIDDEN sail_status_t qoi_private_decode_row(struct qoi_private_decoder *decoder, void *row, unsigned width,
+                                                    enum SailPixelFormat pixel_format);
+
+/*
+ * Writes the file header and prepares the encoder to encode pixels.
+ */
+SAIL_HIDDEN sail_status_t qoi_private_encoder_init(struct qoi_private_encoder *encoder, struct sail_io *io,
+                                                    const struct qoi_private_header *header);
+
+/*
+ * Encodes the next row of 'width' pixels in the specified pixel format. Only BPP24-RGB,
+ * BPP24-BGR, BPP32-RGBA, and BPP32-BGRA are supported.
+ */
+SAIL_HIDDEN sail_status_t qoi_private_encode_row(struct qoi_private_encoder *encoder, const void *row, unsigned width,
+                                                    enum SailPixelFormat pixel_format);
+
+/*
+ * Finishes the pending run, writes the end marker, and flushes the buffered data.
+ */
+SAIL_HIDDEN sail_status_t qoi_private_encoder_finish(struct qoi_private_encoder *encoder);
+
+#endif
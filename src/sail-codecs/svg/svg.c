@@ -23,10 +23,15 @@
     SOFTWARE.
 */
 
+#include <math.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <string.h>
 
+#ifdef _MSC_VER
+    #include <intrin.h>
+#endif
+
 #ifdef SAIL_RESVG
     #include <resvg.h>
 #else
@@ -38,6 +43,80 @@
 
 #include <sail-common/sail-common.h>
 
+/* Resolution SVG user units are defined in. */
+#define SVG_DEFAULT_DPI 96.0
+
+/*
+ * Creating resvg options loads the system font database, and creating a NanoSVG rasterizer
+ * allocates its edge and span buffers. Both are expensive compared to decoding a small icon,
+ * so the process keeps one spare between loads. Loads running in parallel take it in turns
+ * under the lock, and the ones that find no spare create their own. The spare is destroyed
+ * in sail_codec_release_v8_svg() when libsail unloads the codec.
+ */
+#ifdef SAIL_RESVG
+typedef resvg_options svg_spare_t;
+#else
+typedef NSVGrasterizer svg_spare_t;
+#endif
+
+static svg_spare_t *spare = NULL;
+static long spare_lock = 0;
+
+#ifdef _MSC_VER
+static void lock_spare(void) {
+    while (_InterlockedCompareExchange(&spare_lock, 1, 0) != 0) {
+    }
+}
+
+static void unlock_spare(void) {
+    _InterlockedExchange(&spare_lock, 0);
+}
+#else
+static void lock_spare(void) {
+    while (__atomic_exchange_n(&spare_lock, 1, __ATOMIC_ACQUIRE) != 0) {
+    }
+}
+
+static void unlock_spare(void) {
+    __atomic_store_n(&spare_lock, 0, __ATOMIC_RELEASE);
+}
+#endif
+
+static void destroy_spare(svg_spare_t *object) {
+
+#ifdef SAIL_RESVG
+    resvg_options_destroy(object);
+#else
+    nsvgDeleteRasterizer(object);
+#endif
+}
+
+/* Returns the spare or NULL. The caller owns the result. */
+static svg_spare_t* take_spare(void) {
+
+    lock_spare();
+    svg_spare_t *object = spare;
+    spare = NULL;
+    unlock_spare();
+
+    return object;
+}
+
+/* Keeps the object as the spare, or destroys it when there's one already. */
+static void put_spare(svg_spare_t *object) {
+
+    lock_spare();
+    const bool keep = spare == NULL;
+    if (keep) {
+        spare = object;
+    }
+    unlock_spare();
+
+    if (!keep) {
+        destroy_spare(object);
+    }
+}
+
 /*
  * Codec-specific state.
  */
@@ -47,6 +126,13 @@ struct svg_state {
 
     bool frame_loaded;
 
+    /* Load tuning. 0 means not set. */
+    unsigned target_width;
+    unsigned target_height;
+    double target_dpi;
+
+    float scale;
+
 #ifdef SAIL_RESVG
     resvg_options *resvg_options;
     resvg_render_tree *resvg_tree;
@@ -70,6 +156,11 @@ static sail_status_t alloc_svg_state(const struct sail_load_options *load_option
 
         .frame_loaded  = false,
 
+        .target_width  = 0,
+        .target_height = 0,
+        .target_dpi    = 0,
+        .scale         = 1,
+
 #ifdef SAIL_RESVG
         .resvg_options = NULL,
         .resvg_tree    = NULL,
@@ -89,20 +180,93 @@ static void destroy_svg_state(struct svg_state *svg_state) {
     }
 
 #ifdef SAIL_RESVG
-    if (svg_state->resvg_options != NULL) {
-        resvg_options_destroy(svg_state->resvg_options);
-    }
     if (svg_state->resvg_tree != NULL) {
         resvg_tree_destroy(svg_state->resvg_tree);
     }
+    if (svg_state->resvg_options != NULL) {
+        put_spare(svg_state->resvg_options);
+    }
 #else
-    nsvgDeleteRasterizer(svg_state->nsvg_rasterizer);
+    if (svg_state->nsvg_rasterizer != NULL) {
+        put_spare(svg_state->nsvg_rasterizer);
+    }
     nsvgDelete(svg_state->nsvg_image);
 #endif
 
     sail_free(svg_state);
 }
 
+static bool svg_tuning_key_value_callback(const char *key, const struct sail_variant *value, void *user_data) {
+
+    struct svg_state *svg_state = user_data;
+
+    if (strcmp(key, "svg-width") == 0) {
+        if (value->type == SAIL_VARIANT_TYPE_UNSIGNED_INT) {
+            svg_state->target_width = sail_variant_to_unsigned_int(value);
+            SAIL_LOG_TRACE("SVG: Target width: %u", svg_state->target_width);
+        }
+    } else if (strcmp(key, "svg-height") == 0) {
+        if (value->type == SAIL_VARIANT_TYPE_UNSIGNED_INT) {
+            svg_state->target_height = sail_variant_to_unsigned_int(value);
+            SAIL_LOG_TRACE("SVG: Target height: %u", svg_state->target_height);
+        }
+    } else if (strcmp(key, "svg-dpi") == 0) {
+        if (value->type == SAIL_VARIANT_TYPE_UNSIGNED_INT) {
+            svg_state->target_dpi = sail_variant_to_unsigned_int(value);
+        } else if (value->type == SAIL_VARIANT_TYPE_DOUBLE) {
+            svg_state->target_dpi = sail_variant_to_double(value);
+        }
+
+        SAIL_LOG_TRACE("SVG: Target DPI: %.1f", svg_state->target_dpi);
+    }
+
+    return true;
+}
+
+static unsigned scale_dimension(float dimension, float scale) {
+
+    const long scaled = lroundf(dimension * scale);
+
+    return scaled > 0 ? (unsigned)scaled : 1;
+}
+
+/*
+ * Computes the scale to render the image with and the output image size. The target size takes precedence
+ * over DPI. The aspect ratio is always preserved: the limiting dimension gets exactly the target size,
+ * and the other one is rounded to the nearest pixel.
+ */
+static void compute_geometry(struct svg_state *svg_state, float width, float height,
+                                unsigned *output_width, unsigned *output_height) {
+
+    svg_state->scale = 1;
+
+    if (width <= 0 || height <= 0) {
+        *output_width  = scale_dimension(width, 1);
+        *output_height = scale_dimension(height, 1);
+        return;
+    }
+
+    const float scale_x = svg_state->target_width / width;
+    const float scale_y = svg_state->target_height / height;
+
+    if (svg_state->target_width > 0 && (svg_state->target_height == 0 || scale_x <= scale_y)) {
+        svg_state->scale = scale_x;
+        *output_width    = svg_state->target_width;
+        *output_height   = scale_dimension(height, scale_x);
+    } else if (svg_state->target_height > 0) {
+        svg_state->scale = scale_y;
+        *output_width    = scale_dimension(width, scale_y);
+        *output_height   = svg_state->target_height;
+    } else {
+        if (svg_state->target_dpi > 0) {
+            svg_state->scale = (float)(svg_state->target_dpi / SVG_DEFAULT_DPI);
+        }
+
+        *output_width  = scale_dimension(width, svg_state->scale);
+        *output_height = scale_dimension(height, svg_state->scale);
+    }
+}
+
 /*
  * Decoding functions.
  */
@@ -116,13 +280,23 @@ SAIL_EXPORT sail_status_t sail_codec_load_init_v8_svg(struct sail_io *io, const
     SAIL_TRY(alloc_svg_state(load_options, NULL, &svg_state));
     *state = svg_state;
 
+    /* Handle tuning. */
+    if (svg_state->load_options->tuning != NULL) {
+        sail_traverse_hash_map_with_user_data(svg_state->load_options->tuning, svg_tuning_key_value_callback, svg_state);
+    }
+
     /* Read the entire image as the resvg API requires. */
     void *image_data;
     size_t image_size;
     SAIL_TRY(sail_alloc_data_from_io_contents(io, &image_data, &image_size));
 
 #ifdef SAIL_RESVG
-    svg_state->resvg_options = resvg_options_create();
+    svg_state->resvg_options = take_spare();
+
+    if (svg_state->resvg_options == NULL) {
+        svg_state->resvg_options = resvg_options_create();
+        resvg_options_load_system_fonts(svg_state->resvg_options);
+    }
 
     const int result = resvg_parse_tree_from_data(image_data, image_size, svg_state->resvg_options, &svg_state->resvg_tree);
 
@@ -133,7 +307,7 @@ SAIL_EXPORT sail_status_t sail_codec_load_init_v8_svg(struct sail_io *io, const
         SAIL_LOG_AND_RETURN(SAIL_ERROR_BROKEN_IMAGE);
     }
 #else
-    svg_state->nsvg_image = nsvgParse(image_data, "px", 96.0f);
+    svg_state->nsvg_image = nsvgParse(image_data, "px", (float)SVG_DEFAULT_DPI);
 
     sail_free(image_data);
 
@@ -142,7 +316,11 @@ SAIL_EXPORT sail_status_t sail_codec_load_init_v8_svg(struct sail_io *io, const
         SAIL_LOG_AND_RETURN(SAIL_ERROR_BROKEN_IMAGE);
     }
 
-    svg_state->nsvg_rasterizer = nsvgCreateRasterizer();
+    svg_state->nsvg_rasterizer = take_spare();
+
+    if (svg_state->nsvg_rasterizer == NULL) {
+        svg_state->nsvg_rasterizer = nsvgCreateRasterizer();
+    }
 
     if (svg_state->nsvg_rasterizer == NULL) {
         SAIL_LOG_ERROR("SVG: Failed to create NanoSVG rasterizer");
@@ -176,13 +354,15 @@ SAIL_EXPORT sail_status_t sail_codec_load_seek_next_frame_v8_svg(void *state, st
 
 #ifdef SAIL_RESVG
     const resvg_size image_size = resvg_get_image_size(svg_state->resvg_tree);
-
-    image_local->width          = (unsigned)image_size.width;
-    image_local->height         = (unsigned)image_size.height;
+    const float width  = (float)image_size.width;
+    const float height = (float)image_size.height;
 #else
-    image_local->width          = (unsigned)svg_state->nsvg_image->width;
-    image_local->height         = (unsigned)svg_state->nsvg_image->height;
+    const float width  = svg_state->nsvg_image->width;
+    const float height = svg_state->nsvg_image->height;
 #endif
+
+    compute_geometry(svg_state, width, height, &image_local->width, &image_local->height);
+
     image_local->pixel_format   = SAIL_PIXEL_FORMAT_BPP32_RGBA;
     image_local->bytes_per_line = sail_bytes_per_line(image_local->width, image_local->pixel_format);
 
@@ -199,13 +379,16 @@ SAIL_EXPORT sail_status_t sail_codec_load_frame_v8_svg(void *state, struct sail_
 
 #ifdef SAIL_RESVG
     #ifdef SAIL_HAVE_RESVG_FIT_TO
-        const resvg_fit_to resvg_fit_to = { RESVG_FIT_TO_ORIGINAL, 0 };
+        const resvg_fit_to resvg_fit_to = { RESVG_FIT_TO_ZOOM, svg_state->scale };
         resvg_render(svg_state->resvg_tree, resvg_fit_to, image->width, image->height, image->pixels);
     #else
-        resvg_render(svg_state->resvg_tree, resvg_transform_identity(), image->width, image->height, image->pixels);
+        resvg_transform resvg_transform = resvg_transform_identity();
+        resvg_transform.a = svg_state->scale;
+        resvg_transform.d = svg_state->scale;
+        resvg_render(svg_state->resvg_tree, resvg_transform, image->width, image->height, image->pixels);
     #endif
 #else
-    nsvgRasterize(svg_state->nsvg_rasterizer, svg_state->nsvg_image, /* x */ 0, /* y */ 0, /* scale */ 1,
+    nsvgRasterize(svg_state->nsvg_rasterizer, svg_state->nsvg_image, /* x */ 0, /* y */ 0, svg_state->scale,
                     image->pixels, (int)image->width, (int)image->height, (int)image->bytes_per_line);
 #endif
 
@@ -258,3 +441,18 @@ SAIL_EXPORT sail_status_t sail_codec_save_finish_v8_svg(void **state) {
 
     SAIL_LOG_AND_RETURN(SAIL_ERROR_NOT_IMPLEMENTED);
 }
+
+/*
+ * Codec functions.
+ */
+
+SAIL_EXPORT sail_status_t sail_codec_release_v8_svg(void) {
+
+    svg_spare_t *object = take_spare();
+
+    if (object != NULL) {
+        destroy_spare(object);
+    }
+
+    return SAIL_OK;
+}
@@ -160,6 +160,17 @@ SAIL_EXPORT sail_status_t sail_codec_load_seek_next_frame_v8_tiff(void *state, s
         SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
     }
 
+    /* libtiff decodes only the strips or tiles that intersect the region of interest. */
+    struct sail_region region;
+    SAIL_TRY_OR_CLEANUP(sail_clip_region(&tiff_state->load_options->region, image_local->width, image_local->height, &region),
+                        /* cleanup */ sail_destroy_image(image_local));
+
+    tiff_state->image.row_offset = (int)region.y;
+    tiff_state->image.col_offset = (int)region.x;
+
+    image_local->width  = region.width;
+    image_local->height = region.height;
+
     /* Fetch meta data. */
     if (tiff_state->load_options->options & SAIL_OPTION_META_DATA) {
         struct sail_meta_data_node **last_meta_data_node = &image_local->meta_data_node;
@@ -219,6 +230,24 @@ SAIL_EXPORT sail_status_t sail_codec_load_frame_v8_tiff(void *state, struct sail
     return SAIL_OK;
 }
 
+SAIL_EXPORT sail_status_t sail_codec_load_seek_to_frame_v8_tiff(void *state, unsigned frame) {
+
+    struct tiff_state *tiff_state = state;
+
+    if (tiff_state->libtiff_error) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+    }
+
+    /* Validate the directory index. The next seek will re-read the same directory. */
+    if (frame > UINT16_MAX || !TIFFSetDirectory(tiff_state->tiff, (uint16_t)frame)) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_NO_MORE_FRAMES);
+    }
+
+    tiff_state->current_frame = (uint16_t)frame;
+
+    return SAIL_OK;
+}
+
 SAIL_EXPORT sail_status_t sail_codec_load_finish_v8_tiff(void **state) {
 
     struct tiff_state *tiff_state = *state;
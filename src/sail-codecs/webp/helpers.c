@@ -25,6 +25,8 @@
 
 #include <string.h>
 
+#include <webp/decode.h>
+
 #include <sail-common/sail-common.h>
 
 #include "helpers.h"
@@ -66,6 +68,92 @@ sail_status_t webp_private_blend_over(void *dst_raw, unsigned dst_offset, const
     return SAIL_OK;
 }
 
+/* c * a / 255 rounded to the nearest integer. */
+static inline uint8_t mul_div255(unsigned c, unsigned a) {
+
+    const unsigned t = c * a + 128;
+    return (uint8_t)((t + (t >> 8)) >> 8);
+}
+
+sail_status_t webp_private_blend_over_premultiplied(void *dst_raw, const void *src_raw, unsigned width, unsigned bytes_per_pixel) {
+
+    SAIL_CHECK_PTR(src_raw);
+    SAIL_CHECK_PTR(dst_raw);
+
+    if (bytes_per_pixel != 4) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_BIT_DEPTH);
+    }
+
+    const uint8_t *src = src_raw;
+    uint8_t *dst = dst_raw;
+
+    /* Premultiplied "over" is the same for colors and alpha: src + dst * (1 - src_a). */
+    for (unsigned i = 0; i < width * 4; i += 4) {
+        const unsigned inv_src_a = 255 - src[i + 3];
+
+        dst[i + 0] = (uint8_t)(src[i + 0] + mul_div255(dst[i + 0], inv_src_a));
+        dst[i + 1] = (uint8_t)(src[i + 1] + mul_div255(dst[i + 1], inv_src_a));
+        dst[i + 2] = (uint8_t)(src[i + 2] + mul_div255(dst[i + 2], inv_src_a));
+        dst[i + 3] = (uint8_t)(src[i + 3] + mul_div255(dst[i + 3], inv_src_a));
+    }
+
+    return SAIL_OK;
+}
+
+uint32_t webp_private_premultiply_color(uint32_t color) {
+
+    uint8_t rgba[4];
+    memcpy(rgba, &color, sizeof(rgba));
+
+    rgba[0] = mul_div255(rgba[0], rgba[3]);
+    rgba[1] = mul_div255(rgba[1], rgba[3]);
+    rgba[2] = mul_div255(rgba[2], rgba[3]);
+
+    memcpy(&color, rgba, sizeof(color));
+
+    return color;
+}
+
+sail_status_t webp_private_decode_into(const uint8_t *data, size_t data_size, void *pixels, size_t pixels_size,
+                                        unsigned bytes_per_line, bool premultiplied_alpha) {
+
+    SAIL_CHECK_PTR(data);
+    SAIL_CHECK_PTR(pixels);
+
+    if (!premultiplied_alpha) {
+        if (WebPDecodeRGBAInto(data, data_size, pixels, pixels_size, (int)bytes_per_line) == NULL) {
+            SAIL_LOG_ERROR("WEBP: Failed to decode image");
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+        }
+
+        return SAIL_OK;
+    }
+
+    /* The simple API has no premultiplied output, so decode into the external buffer with MODE_rgbA. */
+    WebPDecoderConfig config;
+
+    if (!WebPInitDecoderConfig(&config)) {
+        SAIL_LOG_ERROR("WEBP: Failed to initialize decoder configuration");
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+    }
+
+    config.output.colorspace         = MODE_rgbA;
+    config.output.is_external_memory = 1;
+    config.output.u.RGBA.rgba        = pixels;
+    config.output.u.RGBA.stride      = (int)bytes_per_line;
+    config.output.u.RGBA.size        = pixels_size;
+
+    const VP8StatusCode status = WebPDecode(data, data_size, &config);
+    WebPFreeDecBuffer(&config.output);
+
+    if (status != VP8_STATUS_OK) {
+        SAIL_LOG_ERROR("WEBP: Failed to decode image, status: %d", status);
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+    }
+
+    return SAIL_OK;
+}
+
 sail_status_t webp_private_fetch_iccp(WebPDemuxer *webp_demux, struct sail_iccp **iccp) {
 
     SAIL_CHECK_PTR(webp_demux);
@@ -143,3 +231,77 @@ sail_status_t webp_private_fetch_meta_data(WebPDemuxer *webp_demux, struct sail_
 
     return SAIL_OK;
 }
+
+sail_status_t webp_private_store_frame_properties(unsigned canvas_width, unsigned canvas_height, uint32_t background_color,
+                                                    const WebPIterator *webp_iterator, struct sail_hash_map *special_properties) {
+
+    struct sail_variant *variant;
+    SAIL_TRY(sail_alloc_variant(&variant));
+
+    sail_set_variant_unsigned_int(variant, canvas_width);
+    sail_put_hash_map(special_properties, "webp-canvas-width", variant);
+
+    sail_set_variant_unsigned_int(variant, canvas_height);
+    sail_put_hash_map(special_properties, "webp-canvas-height", variant);
+
+    sail_set_variant_unsigned_int(variant, background_color);
+    sail_put_hash_map(special_properties, "webp-background-color", variant);
+
+    sail_set_variant_unsigned_int(variant, webp_iterator->x_offset);
+    sail_put_hash_map(special_properties, "webp-frame-x", variant);
+
+    sail_set_variant_unsigned_int(variant, webp_iterator->y_offset);
+    sail_put_hash_map(special_properties, "webp-frame-y", variant);
+
+    sail_set_variant_string(variant, (webp_iterator->dispose_method == WEBP_MUX_DISPOSE_BACKGROUND) ? "background" : "none");
+    sail_put_hash_map(special_properties, "webp-frame-dispose-method", variant);
+
+    sail_set_variant_string(variant, (webp_iterator->blend_method == WEBP_MUX_BLEND) ? "blend" : "none");
+    sail_put_hash_map(special_properties, "webp-frame-blend-method", variant);
+
+    SAIL_LOG_TRACE("WEBP: Raw frame: %d,%d %dx%d", webp_iterator->x_offset, webp_iterator->y_offset, webp_iterator->width, webp_iterator->height);
+
+    sail_destroy_variant(variant);
+
+    return SAIL_OK;
+}
+
+bool webp_private_is_key_frame(const WebPIterator *current, const WebPIterator *previous, bool previous_is_key_frame,
+                                unsigned canvas_width, unsigned canvas_height) {
+
+    /* The frame overwrites the whole canvas. */
+    if ((!current->has_alpha || current->blend_method == WEBP_MUX_NO_BLEND) &&
+            (unsigned)current->width == canvas_width && (unsigned)current->height == canvas_height) {
+        return true;
+    }
+
+    /*
+     * The previous frame leaves a clean canvas behind. A key frame is composited onto
+     * a clean canvas, so disposing it to the background cleans the whole canvas again.
+     */
+    if (previous->dispose_method == WEBP_MUX_DISPOSE_BACKGROUND) {
+        return previous_is_key_frame ||
+                ((unsigned)previous->width == canvas_width && (unsigned)previous->height == canvas_height);
+    }
+
+    return false;
+}
+
+bool webp_private_tuning_key_value_callback(const char *key, const struct sail_variant *value, void *user_data) {
+
+    struct webp_load_tuning *load_tuning = user_data;
+
+    if (strcmp(key, "webp-raw-frames") == 0) {
+        if (value->type == SAIL_VARIANT_TYPE_BOOL) {
+            load_tuning->raw_frames = sail_variant_to_bool(value);
+            SAIL_LOG_TRACE("WEBP: Raw frames: %s", load_tuning->raw_frames ? "yes" : "no");
+        }
+    } else if (strcmp(key, "webp-premultiplied-alpha") == 0) {
+        if (value->type == SAIL_VARIANT_TYPE_BOOL) {
+            load_tuning->premultiplied_alpha = sail_variant_to_bool(value);
+            SAIL_LOG_TRACE("WEBP: Premultiplied alpha: %s", load_tuning->premultiplied_alpha ? "yes" : "no");
+        }
+    }
+
+    return true;
+}
@@ -26,6 +26,8 @@
 #ifndef SAIL_WEBP_HELPERS_H
 #define SAIL_WEBP_HELPERS_H
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include <webp/demux.h>
@@ -34,14 +36,37 @@
 #include <sail-common/export.h>
 #include <sail-common/status.h>
 
+/* Load tuning. */
+struct webp_load_tuning {
+    /* Return frames as is, without compositing them onto the canvas. */
+    bool raw_frames;
+    /* Output BPP32-RGBA-PREMULTIPLIED pixels and composite them without divisions. */
+    bool premultiplied_alpha;
+};
+
 SAIL_HIDDEN void webp_private_fill_color(uint8_t *pixels, unsigned bytes_per_line, unsigned bytes_per_pixel,
                                             uint32_t color, unsigned x, unsigned y, unsigned width, unsigned height);
 
 SAIL_HIDDEN sail_status_t webp_private_blend_over(void *dst_raw, unsigned dst_offset, const void *src_raw,
                                                     unsigned width, unsigned bytes_per_pixel);
 
+SAIL_HIDDEN sail_status_t webp_private_blend_over_premultiplied(void *dst_raw, const void *src_raw, unsigned width, unsigned bytes_per_pixel);
+
+SAIL_HIDDEN uint32_t webp_private_premultiply_color(uint32_t color);
+
+SAIL_HIDDEN sail_status_t webp_private_decode_into(const uint8_t *data, size_t data_size, void *pixels, size_t pixels_size,
+                                                    unsigned bytes_per_line, bool premultiplied_alpha);
+
 SAIL_HIDDEN sail_status_t webp_private_fetch_iccp(WebPDemuxer *webp_demux, struct sail_iccp **iccp);
 
 SAIL_HIDDEN sail_status_t webp_private_fetch_meta_data(WebPDemuxer *webp_demux, struct sail_meta_data_node **last_meta_data_node);
 
+SAIL_HIDDEN sail_status_t webp_private_store_frame_properties(unsigned canvas_width, unsigned canvas_height, uint32_t background_color,
+                                                                const WebPIterator *webp_iterator, struct sail_hash_map *special_properties);
+
+SAIL_HIDDEN bool webp_private_is_key_frame(const WebPIterator *current, const WebPIterator *previous, bool previous_is_key_frame,
+                                            unsigned canvas_width, unsigned canvas_height);
+
+SAIL_HIDDEN bool webp_private_tuning_key_value_callback(const char *key, const struct sail_variant *value, void *user_data);
+
 #endif
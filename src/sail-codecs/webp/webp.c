@@ -57,6 +57,10 @@ struct webp_state {
     WebPMuxAnimDispose frame_dispose_method;
     WebPMuxAnimBlend frame_blend_method;
 
+    struct webp_load_tuning load_tuning;
+    /* Lazily built on the first seek. Key frames don't depend on the preceding frames. */
+    bool *key_frames;
+
     void *image_data;
     size_t image_data_size;
 };
@@ -86,6 +90,8 @@ static sail_status_t alloc_webp_state(const struct sail_load_options *load_optio
         .frame_height         = 0,
         .frame_dispose_method = WEBP_MUX_DISPOSE_NONE,
         .frame_blend_method   = WEBP_MUX_NO_BLEND,
+        .load_tuning          = { .raw_frames = false, .premultiplied_alpha = false },
+        .key_frames           = NULL,
 
         .image_data      = NULL,
         .image_data_size = 0,
@@ -105,6 +111,7 @@ static void destroy_webp_state(struct webp_state *webp_state) {
         sail_free(webp_state->webp_iterator);
     }
 
+    sail_free(webp_state->key_frames);
     sail_free(webp_state->image_data);
 
     WebPDemuxDelete(webp_state->webp_demux);
@@ -114,6 +121,147 @@ static void destroy_webp_state(struct webp_state *webp_state) {
     sail_free(webp_state);
 }
 
+/* The canvas background color in the canvas pixel format. */
+static uint32_t canvas_background_color(const struct webp_state *webp_state) {
+
+    return webp_state->load_tuning.premultiplied_alpha
+            ? webp_private_premultiply_color(webp_state->background_color)
+            : webp_state->background_color;
+}
+
+static sail_status_t alloc_canvas(struct webp_state *webp_state) {
+
+    if (webp_state->canvas_image->pixels == NULL) {
+        const size_t image_size = (size_t)webp_state->canvas_image->bytes_per_line * webp_state->canvas_image->height;
+
+        void *ptr;
+        SAIL_TRY(sail_malloc(image_size, &ptr));
+        webp_state->canvas_image->pixels = ptr;
+    }
+
+    /* Fill background. */
+    webp_private_fill_color(webp_state->canvas_image->pixels, webp_state->canvas_image->bytes_per_line, webp_state->bytes_per_pixel,
+                            canvas_background_color(webp_state), 0, 0, webp_state->canvas_image->width, webp_state->canvas_image->height);
+
+    return SAIL_OK;
+}
+
+/* Applies the disposal method of the current frame to the canvas. */
+static sail_status_t dispose_frame(struct webp_state *webp_state) {
+
+    switch (webp_state->frame_dispose_method) {
+        case WEBP_MUX_DISPOSE_BACKGROUND: {
+            webp_private_fill_color(webp_state->canvas_image->pixels, webp_state->canvas_image->bytes_per_line, webp_state->bytes_per_pixel,
+                                    canvas_background_color(webp_state), webp_state->frame_x, webp_state->frame_y,
+                                    webp_state->frame_width, webp_state->frame_height);
+            break;
+        }
+        case WEBP_MUX_DISPOSE_NONE: {
+            break;
+        }
+        default: {
+            SAIL_LOG_ERROR("WEBP: Unknown disposal method");
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+        }
+    }
+
+    return SAIL_OK;
+}
+
+static void fetch_frame_geometry(struct webp_state *webp_state) {
+
+    webp_state->frame_x              = webp_state->webp_iterator->x_offset;
+    webp_state->frame_y              = webp_state->webp_iterator->y_offset;
+    webp_state->frame_width          = webp_state->webp_iterator->width;
+    webp_state->frame_height         = webp_state->webp_iterator->height;
+    webp_state->frame_dispose_method = webp_state->webp_iterator->dispose_method;
+    webp_state->frame_blend_method   = webp_state->webp_iterator->blend_method;
+}
+
+/*
+ * Decodes the current frame onto the canvas. The scratch buffer must fit the frame
+ * as it's used to blend the frame over the canvas.
+ */
+static sail_status_t composite_frame(struct webp_state *webp_state, void *scratch, size_t scratch_size) {
+
+    switch (webp_state->frame_blend_method) {
+        case WEBP_MUX_NO_BLEND: {
+            SAIL_TRY(webp_private_decode_into(webp_state->webp_iterator->fragment.bytes,
+                                                webp_state->webp_iterator->fragment.size,
+                                                (uint8_t *)webp_state->canvas_image->pixels + webp_state->canvas_image->bytes_per_line * webp_state->frame_y +
+                                                    webp_state->frame_x * webp_state->bytes_per_pixel,
+                                                (size_t)webp_state->canvas_image->bytes_per_line * webp_state->canvas_image->height,
+                                                webp_state->canvas_image->bytes_per_line,
+                                                webp_state->load_tuning.premultiplied_alpha));
+            break;
+        }
+        case WEBP_MUX_BLEND: {
+            SAIL_TRY(webp_private_decode_into(webp_state->webp_iterator->fragment.bytes,
+                                                webp_state->webp_iterator->fragment.size,
+                                                scratch,
+                                                scratch_size,
+                                                webp_state->frame_width * webp_state->bytes_per_pixel,
+                                                webp_state->load_tuning.premultiplied_alpha));
+
+            uint8_t *dst_scanline = (uint8_t *)sail_scan_line(webp_state->canvas_image, webp_state->frame_y) + webp_state->frame_x * webp_state->bytes_per_pixel;
+            const uint8_t *src_scanline = scratch;
+
+            for (unsigned row = 0; row < webp_state->frame_height; row++, dst_scanline += webp_state->canvas_image->bytes_per_line,
+                                                                          src_scanline += webp_state->frame_width * webp_state->bytes_per_pixel) {
+                if (webp_state->load_tuning.premultiplied_alpha) {
+                    SAIL_TRY(webp_private_blend_over_premultiplied(dst_scanline, src_scanline, webp_state->frame_width, webp_state->bytes_per_pixel));
+                } else {
+                    SAIL_TRY(webp_private_blend_over(dst_scanline, 0, src_scanline, webp_state->frame_width, webp_state->bytes_per_pixel));
+                }
+            }
+            break;
+        }
+        default: {
+            SAIL_LOG_ERROR("WEBP: Unknown blending method");
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+        }
+    }
+
+    return SAIL_OK;
+}
+
+static sail_status_t build_key_frames(struct webp_state *webp_state) {
+
+    void *ptr;
+    SAIL_TRY(sail_malloc(sizeof(bool) * webp_state->frame_count, &ptr));
+    bool *key_frames = ptr;
+
+    WebPIterator previous;
+    WebPIterator current;
+
+    for (uint32_t i = 0; i < webp_state->frame_count; i++) {
+        if (WebPDemuxGetFrame(webp_state->webp_demux, (int)i + 1, &current) == 0) {
+            if (i > 0) {
+                WebPDemuxReleaseIterator(&previous);
+            }
+            sail_free(key_frames);
+            SAIL_LOG_ERROR("WEBP: Failed to get frame #%u", i);
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+        }
+
+        if (i == 0) {
+            key_frames[i] = true;
+        } else {
+            key_frames[i] = webp_private_is_key_frame(&current, &previous, key_frames[i - 1],
+                                                        webp_state->canvas_image->width, webp_state->canvas_image->height);
+            WebPDemuxReleaseIterator(&previous);
+        }
+
+        previous = current;
+    }
+
+    WebPDemuxReleaseIterator(&previous);
+
+    webp_state->key_frames = key_frames;
+
+    return SAIL_OK;
+}
+
 /*
  * Decoding functions.
  */
@@ -127,6 +275,11 @@ SAIL_EXPORT sail_status_t sail_codec_load_init_v8_webp(struct sail_io *io, const
     SAIL_TRY(alloc_webp_state(load_options, NULL, &webp_state));
     *state = webp_state;
 
+    /* Handle tuning. */
+    if (webp_state->load_options->tuning != NULL) {
+        sail_traverse_hash_map_with_user_data(webp_state->load_options->tuning, webp_private_tuning_key_value_callback, &webp_state->load_tuning);
+    }
+
     /* Read the entire image. */
     SAIL_ALIGNAS(uint32_t) char signature_and_size[8];
     SAIL_TRY(io->strict_read(io->stream, signature_and_size, sizeof(signature_and_size)));
@@ -166,7 +319,9 @@ SAIL_EXPORT sail_status_t sail_codec_load_init_v8_webp(struct sail_io *io, const
 
     image_local->width          = WebPDemuxGetI(webp_state->webp_demux, WEBP_FF_CANVAS_WIDTH);
     image_local->height         = WebPDemuxGetI(webp_state->webp_demux, WEBP_FF_CANVAS_HEIGHT);
-    image_local->pixel_format   = SAIL_PIXEL_FORMAT_BPP32_RGBA;
+    image_local->pixel_format   = webp_state->load_tuning.premultiplied_alpha
+                                    ? SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED
+                                    : SAIL_PIXEL_FORMAT_BPP32_RGBA;
     image_local->bytes_per_line = sail_bytes_per_line(image_local->width, image_local->pixel_format);
 
     webp_state->bytes_per_pixel = image_local->bytes_per_line / image_local->width;
@@ -199,32 +354,16 @@ SAIL_EXPORT sail_status_t sail_codec_load_seek_next_frame_v8_webp(void *state, s
             SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
         }
 
-        /* Allocate a canvas frame to apply disposal later. */
-        size_t image_size = (size_t)webp_state->canvas_image->bytes_per_line * webp_state->canvas_image->height;
-
-        void *ptr;
-        SAIL_TRY(sail_malloc(image_size, &ptr));
-        webp_state->canvas_image->pixels = ptr;
-
-        /* Fill background. */
-        webp_private_fill_color(webp_state->canvas_image->pixels, webp_state->canvas_image->bytes_per_line, webp_state->bytes_per_pixel,
-                                webp_state->background_color, 0, 0, webp_state->canvas_image->width, webp_state->canvas_image->height);
-    } else {
-        switch (webp_state->frame_dispose_method) {
-            case WEBP_MUX_DISPOSE_BACKGROUND: {
-                webp_private_fill_color(webp_state->canvas_image->pixels, webp_state->canvas_image->bytes_per_line, webp_state->bytes_per_pixel,
-                                        webp_state->background_color, webp_state->frame_x, webp_state->frame_y,
-                                        webp_state->frame_width, webp_state->frame_height);
-                break;
-            }
-            case WEBP_MUX_DISPOSE_NONE: {
-                break;
-            }
-            default: {
-                SAIL_LOG_ERROR("WEBP: Unknown disposal method");
-                SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
-            }
+        /* Allocate a canvas frame to apply disposal later. Raw frames are not composited. */
+        if (!webp_state->load_tuning.raw_frames) {
+            SAIL_TRY(alloc_canvas(webp_state));
         }
+    } else if (webp_state->load_tuning.raw_frames) {
+        if (WebPDemuxNextFrame(webp_state->webp_iterator) == 0) {
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_NO_MORE_FRAMES);
+        }
+    } else {
+        SAIL_TRY(dispose_frame(webp_state));
 
         if (WebPDemuxNextFrame(webp_state->webp_iterator) == 0) {
             SAIL_LOG_AND_RETURN(SAIL_ERROR_NO_MORE_FRAMES);
@@ -232,12 +371,7 @@ SAIL_EXPORT sail_status_t sail_codec_load_seek_next_frame_v8_webp(void *state, s
     }
 
     webp_state->frame_number++;
-    webp_state->frame_x              = webp_state->webp_iterator->x_offset;
-    webp_state->frame_y              = webp_state->webp_iterator->y_offset;
-    webp_state->frame_width          = webp_state->webp_iterator->width;
-    webp_state->frame_height         = webp_state->webp_iterator->height;
-    webp_state->frame_dispose_method = webp_state->webp_iterator->dispose_method;
-    webp_state->frame_blend_method   = webp_state->webp_iterator->blend_method;
+    fetch_frame_geometry(webp_state);
 
     /* Construct image. */
     struct sail_image *image_local;
@@ -254,6 +388,30 @@ SAIL_EXPORT sail_status_t sail_codec_load_seek_next_frame_v8_webp(void *state, s
         image_local->delay = webp_state->webp_iterator->duration <= 0 ? 100 : webp_state->webp_iterator->duration;
     }
 
+    /* Raw frames are useless without their offsets, so store them unconditionally. */
+    if (webp_state->load_tuning.raw_frames) {
+        image_local->width          = webp_state->frame_width;
+        image_local->height         = webp_state->frame_height;
+        image_local->bytes_per_line = sail_bytes_per_line(image_local->width, image_local->pixel_format);
+
+        if (image_local->source_image == NULL) {
+            SAIL_TRY_OR_CLEANUP(sail_alloc_source_image(&image_local->source_image),
+                                /* cleanup */ sail_destroy_image(image_local));
+            image_local->source_image->chroma_subsampling = SAIL_CHROMA_SUBSAMPLING_420;
+            image_local->source_image->compression = SAIL_COMPRESSION_WEBP;
+        }
+
+        if (image_local->source_image->special_properties == NULL) {
+            SAIL_TRY_OR_CLEANUP(sail_alloc_hash_map(&image_local->source_image->special_properties),
+                                /* cleanup */ sail_destroy_image(image_local));
+        }
+
+        SAIL_TRY_OR_CLEANUP(webp_private_store_frame_properties(webp_state->canvas_image->width, webp_state->canvas_image->height,
+                                                                webp_state->background_color, webp_state->webp_iterator,
+                                                                image_local->source_image->special_properties),
+                            /* cleanup */ sail_destroy_image(image_local));
+    }
+
     *image = image_local;
 
     return SAIL_OK;
@@ -263,45 +421,102 @@ SAIL_EXPORT sail_status_t sail_codec_load_frame_v8_webp(void *state, struct sail
 
     struct webp_state *webp_state = state;
 
-    switch (webp_state->frame_blend_method) {
-        case WEBP_MUX_NO_BLEND: {
-            if (WebPDecodeRGBAInto(webp_state->webp_iterator->fragment.bytes,
-                                    webp_state->webp_iterator->fragment.size,
-                                    (uint8_t *)webp_state->canvas_image->pixels + webp_state->canvas_image->bytes_per_line * webp_state->frame_y +
-                                        webp_state->frame_x * webp_state->bytes_per_pixel,
-                                    (size_t)webp_state->canvas_image->bytes_per_line * webp_state->canvas_image->height,
-                                    webp_state->canvas_image->bytes_per_line) == NULL) {
-                SAIL_LOG_ERROR("WEBP: Failed to decode image");
-                SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
-            }
-            break;
+    if (webp_state->load_tuning.raw_frames) {
+        SAIL_TRY(webp_private_decode_into(webp_state->webp_iterator->fragment.bytes,
+                                            webp_state->webp_iterator->fragment.size,
+                                            image->pixels,
+                                            (size_t)image->bytes_per_line * image->height,
+                                            image->bytes_per_line,
+                                            webp_state->load_tuning.premultiplied_alpha));
+
+        return SAIL_OK;
+    }
+
+    /* Use the output pixels as a scratch buffer to blend. The canvas is copied over them afterwards. */
+    SAIL_TRY(composite_frame(webp_state, image->pixels, (size_t)image->bytes_per_line * image->height));
+
+    memcpy(image->pixels, webp_state->canvas_image->pixels, (size_t)image->bytes_per_line * image->height);
+
+    return SAIL_OK;
+}
+
+SAIL_EXPORT sail_status_t sail_codec_load_seek_to_frame_v8_webp(void *state, unsigned frame) {
+
+    struct webp_state *webp_state = state;
+
+    if (frame >= webp_state->frame_count) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_NO_MORE_FRAMES);
+    }
+
+    /* The next seek starts demuxing from the very beginning. */
+    if (frame == 0) {
+        webp_state->frame_number = 0;
+        return SAIL_OK;
+    }
+
+    /* Raw frames are independent. Stop right before the requested frame. WebP frame numbers start from 1. */
+    if (webp_state->load_tuning.raw_frames) {
+        if (WebPDemuxGetFrame(webp_state->webp_demux, (int)frame, webp_state->webp_iterator) == 0) {
+            SAIL_LOG_ERROR("WEBP: Failed to get frame #%u", frame - 1);
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
         }
-        case WEBP_MUX_BLEND: {
-            if (WebPDecodeRGBAInto(webp_state->webp_iterator->fragment.bytes,
-                                    webp_state->webp_iterator->fragment.size,
-                                    image->pixels,
-                                    (size_t)image->bytes_per_line * image->height,
-                                    webp_state->frame_width * webp_state->bytes_per_pixel) == NULL) {
-                SAIL_LOG_ERROR("WEBP: Failed to decode image");
+
+        webp_state->frame_number = frame;
+        return SAIL_OK;
+    }
+
+    /* Find the nearest key frame. The first frame is always a key frame. */
+    if (webp_state->key_frames == NULL) {
+        SAIL_TRY(build_key_frames(webp_state));
+    }
+
+    unsigned key_frame = frame;
+    while (!webp_state->key_frames[key_frame]) {
+        key_frame--;
+    }
+
+    SAIL_LOG_TRACE("WEBP: Seeking to frame #%u from key frame #%u", frame, key_frame);
+
+    /* Key frames are composited onto a clean canvas. Replay the frames from the key frame. */
+    SAIL_TRY(alloc_canvas(webp_state));
+
+    if (key_frame == frame) {
+        if (WebPDemuxGetFrame(webp_state->webp_demux, (int)frame, webp_state->webp_iterator) == 0) {
+            SAIL_LOG_ERROR("WEBP: Failed to get frame #%u", frame - 1);
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+        }
+
+        fetch_frame_geometry(webp_state);
+        /* The canvas is clean already. */
+        webp_state->frame_dispose_method = WEBP_MUX_DISPOSE_NONE;
+    } else {
+        const size_t scratch_size = (size_t)webp_state->canvas_image->bytes_per_line * webp_state->canvas_image->height;
+
+        void *scratch;
+        SAIL_TRY(sail_malloc(scratch_size, &scratch));
+
+        for (unsigned i = key_frame; i < frame; i++) {
+            if (i > key_frame) {
+                SAIL_TRY_OR_CLEANUP(dispose_frame(webp_state),
+                                    /* cleanup */ sail_free(scratch));
+            }
+
+            if (WebPDemuxGetFrame(webp_state->webp_demux, (int)i + 1, webp_state->webp_iterator) == 0) {
+                sail_free(scratch);
+                SAIL_LOG_ERROR("WEBP: Failed to get frame #%u", i);
                 SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
             }
 
-            uint8_t *dst_scanline = (uint8_t *)sail_scan_line(webp_state->canvas_image, webp_state->frame_y) + webp_state->frame_x * webp_state->bytes_per_pixel;
-            uint8_t *src_scanline = image->pixels;
+            fetch_frame_geometry(webp_state);
 
-            for (unsigned row = 0; row < webp_state->frame_height; row++, dst_scanline += webp_state->canvas_image->bytes_per_line,
-                                                                          src_scanline += webp_state->frame_width * webp_state->bytes_per_pixel) {
-                SAIL_TRY(webp_private_blend_over(dst_scanline, 0, src_scanline, webp_state->frame_width, webp_state->bytes_per_pixel));
-            }
-            break;
-        }
-        default: {
-            SAIL_LOG_ERROR("WEBP: Unknown blending method");
-            SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+            SAIL_TRY_OR_CLEANUP(composite_frame(webp_state, scratch, scratch_size),
+                                /* cleanup */ sail_free(scratch));
         }
+
+        sail_free(scratch);
     }
 
-    memcpy(image->pixels, webp_state->canvas_image->pixels, (size_t)image->bytes_per_line * image->height);
+    webp_state->frame_number = frame;
 
     return SAIL_OK;
 }
@@ -170,6 +170,28 @@ enum SailPixelFormat {
     SAIL_PIXEL_FORMAT_BPP40_YUVA,
     SAIL_PIXEL_FORMAT_BPP48_YUVA,
     SAIL_PIXEL_FORMAT_BPP64_YUVA,
+
+    /*
+     * Planar YUV formats with full-range BT.601 (JFIF) samples. The planes follow each other
+     * in the pixel data: the full-resolution Y plane with the image stride, then the subsampled
+     * chroma planes. Use sail_image_planes() to get the plane pointers and strides.
+     */
+    SAIL_PIXEL_FORMAT_BPP12_YUV420P, /* I420: Y, U, and V planes. U and V are subsampled 2x2 */
+    SAIL_PIXEL_FORMAT_BPP16_YUV422P, /* Y, U, and V planes. U and V are subsampled 2x1       */
+    SAIL_PIXEL_FORMAT_BPP12_NV12,    /* Y plane and interleaved UV plane subsampled 2x2      */
+
+    /*
+     * RGBA formats with color components premultiplied by alpha.
+     */
+    SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED,
+    SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED,
+    SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED,
+    SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED,
+
+    SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED,
+    SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED,
+    SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED,
+    SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED,
 };
 
 /* Chroma subsampling. See https://en.wikipedia.org/wiki/Chroma_subsampling */
@@ -318,6 +340,15 @@ enum SailCodecFeature {
 
     /* Can preserve the source image information. */
     SAIL_CODEC_FEATURE_SOURCE_IMAGE = 1 << 7,
+
+    /* Can seek to an arbitrary frame without loading all the preceding frames. */
+    SAIL_CODEC_FEATURE_FRAME_SEEK   = 1 << 8,
+
+    /* Can load a region of interest without decoding whole frames. See sail_load_options.region. */
+    SAIL_CODEC_FEATURE_REGION       = 1 << 9,
+
+    /* Can load from non-seekable I/O streams reading data forward only. */
+    SAIL_CODEC_FEATURE_STREAMING    = 1 << 10,
 };
 
 /* Load or save options. */
@@ -340,6 +371,22 @@ enum SailOption {
      * Specifying this option for saving operations has no effect.
      */
     SAIL_OPTION_SOURCE_IMAGE = 1 << 3,
+
+    /*
+     * Instruction to rotate or mirror loaded images according to their EXIF orientation,
+     * so the pixels are upright. Codecs that support it transform pixels while decoding. Otherwise,
+     * the image is rotated with sail_rotate_image() after decoding. The EXIF orientation
+     * tag in the loaded meta data is reset to normal. Specifying this option for saving
+     * operations has no effect.
+     */
+    SAIL_OPTION_APPLY_ORIENTATION = 1 << 4,
+
+    /*
+     * Instruction to allocate small objects like images, meta data, hash maps, and codec states
+     * from an arena of the loading or saving operation instead of allocating them one by one.
+     * Pixels are never allocated from the arena. See sail_alloc_arena().
+     */
+    SAIL_OPTION_ARENA = 1 << 5,
 };
 
 #endif
@@ -123,6 +123,20 @@ const char* sail_pixel_format_to_string(enum SailPixelFormat pixel_format) {
         case SAIL_PIXEL_FORMAT_BPP40_YUVA:            return "BPP40-YUVA";
         case SAIL_PIXEL_FORMAT_BPP48_YUVA:            return "BPP48-YUVA";
         case SAIL_PIXEL_FORMAT_BPP64_YUVA:            return "BPP64-YUVA";
+
+        case SAIL_PIXEL_FORMAT_BPP12_YUV420P:         return "BPP12-YUV420P";
+        case SAIL_PIXEL_FORMAT_BPP16_YUV422P:         return "BPP16-YUV422P";
+        case SAIL_PIXEL_FORMAT_BPP12_NV12:            return "BPP12-NV12";
+
+        case SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED: return "BPP32-RGBA-PREMULTIPLIED";
+        case SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED: return "BPP32-BGRA-PREMULTIPLIED";
+        case SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED: return "BPP32-ARGB-PREMULTIPLIED";
+        case SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED: return "BPP32-ABGR-PREMULTIPLIED";
+
+        case SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED: return "BPP64-RGBA-PREMULTIPLIED";
+        case SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED: return "BPP64-BGRA-PREMULTIPLIED";
+        case SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED: return "BPP64-ARGB-PREMULTIPLIED";
+        case SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED: return "BPP64-ABGR-PREMULTIPLIED";
     }
 
     return NULL;
@@ -233,6 +247,20 @@ enum SailPixelFormat sail_pixel_format_from_string(const char *str) {
         case UINT64_C(8244605668934919965):  return SAIL_PIXEL_FORMAT_BPP40_YUVA;
         case UINT64_C(8244605669248003109):  return SAIL_PIXEL_FORMAT_BPP48_YUVA;
         case UINT64_C(8244605671674397475):  return SAIL_PIXEL_FORMAT_BPP64_YUVA;
+
+        case UINT64_C(13237220243473897185): return SAIL_PIXEL_FORMAT_BPP12_YUV420P;
+        case UINT64_C(13237225869108370215): return SAIL_PIXEL_FORMAT_BPP16_YUV422P;
+        case UINT64_C(8244605665138391390):  return SAIL_PIXEL_FORMAT_BPP12_NV12;
+
+        case UINT64_C(5755462582571748834):  return SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED;
+        case UINT64_C(10184454581647182306): return SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED;
+        case UINT64_C(5784931875222153954):  return SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED;
+        case UINT64_C(888213552061228770):   return SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED;
+
+        case UINT64_C(403932174454299175):   return SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED;
+        case UINT64_C(4832924173529732647):  return SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED;
+        case UINT64_C(433401467104704295):   return SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED;
+        case UINT64_C(13983427217653330727): return SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED;
     }
 
     return SAIL_PIXEL_FORMAT_UNKNOWN;
@@ -509,6 +537,9 @@ const char* sail_codec_feature_to_string(enum SailCodecFeature codec_feature) {
         case SAIL_CODEC_FEATURE_INTERLACED:   return "INTERLACED";
         case SAIL_CODEC_FEATURE_ICCP:         return "ICCP";
         case SAIL_CODEC_FEATURE_SOURCE_IMAGE: return "SOURCE-IMAGE";
+        case SAIL_CODEC_FEATURE_FRAME_SEEK:   return "FRAME-SEEK";
+        case SAIL_CODEC_FEATURE_REGION:       return "REGION";
+        case SAIL_CODEC_FEATURE_STREAMING:    return "STREAMING";
     }
 
     return NULL;
@@ -525,6 +556,9 @@ enum SailCodecFeature sail_codec_feature_from_string(const char *str) {
         case UINT64_C(8244927930303708800):  return SAIL_CODEC_FEATURE_INTERLACED;
         case UINT64_C(6384139556):           return SAIL_CODEC_FEATURE_ICCP;
         case UINT64_C(14115912967723543398): return SAIL_CODEC_FEATURE_SOURCE_IMAGE;
+        case UINT64_C(8244793521521428485):  return SAIL_CODEC_FEATURE_FRAME_SEEK;
+        case UINT64_C(6952682705673):        return SAIL_CODEC_FEATURE_REGION;
+        case UINT64_C(249860618112082895):   return SAIL_CODEC_FEATURE_STREAMING;
     }
 
     return SAIL_CODEC_FEATURE_UNKNOWN;
@@ -30,9 +30,89 @@
 /*
  * Private functions.
  */
-static inline uint64_t calculate_hash(const char *key) {
 
-    return sail_string_hash(key) % SAIL_HASH_MAP_SIZE;
+/* Fibonacci hashing spreads the djb2 hashes over the power of 2 capacity. */
+static inline size_t home_index(uint64_t hash, size_t capacity) {
+
+    return (size_t)((hash * UINT64_C(11400714819323198485)) >> 32) & (capacity - 1);
+}
+
+static inline const char* entry_key(const struct sail_hash_map_entry *entry) {
+
+    return entry->heap_key != NULL ? entry->heap_key : entry->inline_key;
+}
+
+static void destroy_entry(struct sail_hash_map_entry *entry) {
+
+    sail_free(entry->heap_key);
+    sail_free(entry->value.value);
+
+    memset(entry, 0, sizeof(*entry));
+}
+
+static sail_status_t copy_variant_value(const struct sail_variant *source, struct sail_variant *target) {
+
+    void *value = NULL;
+
+    if (source->value != NULL) {
+        SAIL_TRY(sail_memdup(source->value, source->size, &value));
+    }
+
+    target->type  = source->type;
+    target->value = value;
+    target->size  = source->size;
+
+    return SAIL_OK;
+}
+
+/*
+ * Returns the entry with the key, or the free entry where the key must be inserted.
+ * The hash map always has free entries, so the search terminates.
+ */
+static struct sail_hash_map_entry* find_entry(const struct sail_hash_map *hash_map, const char *key, uint64_t hash) {
+
+    const size_t mask = hash_map->capacity - 1;
+
+    for (size_t i = home_index(hash, hash_map->capacity);; i = (i + 1) & mask) {
+        struct sail_hash_map_entry *entry = &hash_map->entries[i];
+
+        if (!entry->occupied || (entry->hash == hash && strcmp(entry_key(entry), key) == 0)) {
+            return entry;
+        }
+    }
+}
+
+static sail_status_t grow(struct sail_hash_map *hash_map) {
+
+    const size_t capacity = hash_map->capacity * 2;
+
+    void *ptr;
+    SAIL_TRY(sail_calloc(capacity, sizeof(struct sail_hash_map_entry), &ptr));
+    struct sail_hash_map_entry *entries = ptr;
+
+    /* Entries are moved as is, keys and values stay where they are. */
+    for (size_t i = 0; i < hash_map->capacity; i++) {
+        const struct sail_hash_map_entry *entry = &hash_map->entries[i];
+
+        if (entry->occupied) {
+            size_t index = home_index(entry->hash, capacity);
+
+            while (entries[index].occupied) {
+                index = (index + 1) & (capacity - 1);
+            }
+
+            entries[index] = *entry;
+        }
+    }
+
+    if (hash_map->entries != hash_map->inline_entries) {
+        sail_free(hash_map->entries);
+    }
+
+    hash_map->entries  = entries;
+    hash_map->capacity = capacity;
+
+    return SAIL_OK;
 }
 
 /*
@@ -46,9 +126,11 @@ sail_status_t sail_alloc_hash_map(struct sail_hash_map **hash_map) {
     SAIL_TRY(sail_malloc(sizeof(struct sail_hash_map), &ptr));
     *hash_map = ptr;
 
-    for (size_t i = 0; i < SAIL_HASH_MAP_SIZE; i++) {
-        (*hash_map)->buckets[i] = NULL;
-    }
+    (*hash_map)->capacity = SAIL_HASH_MAP_INLINE_CAPACITY;
+    (*hash_map)->size     = 0;
+    (*hash_map)->entries  = (*hash_map)->inline_entries;
+
+    memset((*hash_map)->inline_entries, 0, sizeof((*hash_map)->inline_entries));
 
     return SAIL_OK;
 }
@@ -61,6 +143,10 @@ void sail_destroy_hash_map(struct sail_hash_map *hash_map) {
 
     sail_clear_hash_map(hash_map);
 
+    if (hash_map->entries != hash_map->inline_entries) {
+        sail_free(hash_map->entries);
+    }
+
     sail_free(hash_map);
 }
 
@@ -70,34 +156,47 @@ sail_status_t sail_put_hash_map(struct sail_hash_map *hash_map, const char *key,
     SAIL_CHECK_PTR(key);
     SAIL_CHECK_PTR(value);
 
-    struct sail_variant_node **key_variant_node;
+    const uint64_t hash = sail_string_hash(key);
+    struct sail_hash_map_entry *entry = find_entry(hash_map, key, hash);
 
-    for (key_variant_node = &hash_map->buckets[calculate_hash(key)]; *key_variant_node != NULL; key_variant_node = &(*key_variant_node)->next->next) {
-        struct sail_variant_node *value_variant_node = (*key_variant_node)->next;
+    if (entry->occupied) {
+        if (!sail_equal_variants(&entry->value, value)) {
+            /* Overwrite value. */
+            struct sail_variant value_copy;
+            SAIL_TRY(copy_variant_value(value, &value_copy));
 
-        if (strcmp(sail_variant_to_string((*key_variant_node)->variant), key) == 0) {
-            if (!sail_equal_variants(value_variant_node->variant, value)) {
-                /* Overwrite value. */
-                sail_destroy_variant(value_variant_node->variant);
-                SAIL_TRY(sail_copy_variant(value, &value_variant_node->variant));
-            }
-
-            return SAIL_OK;
+            sail_free(entry->value.value);
+            entry->value = value_copy;
         }
+
+        return SAIL_OK;
     }
 
-    struct sail_variant_node *local_variant_node;
+    /* Keep the load factor below 3/4. */
+    if ((hash_map->size + 1) * 4 > hash_map->capacity * 3) {
+        SAIL_TRY(grow(hash_map));
+        entry = find_entry(hash_map, key, hash);
+    }
+
+    struct sail_hash_map_entry entry_local;
+    memset(&entry_local, 0, sizeof(entry_local));
+
+    const size_t key_length = strlen(key);
+
+    if (key_length < SAIL_HASH_MAP_INLINE_KEY_SIZE) {
+        memcpy(entry_local.inline_key, key, key_length + 1);
+    } else {
+        SAIL_TRY(sail_strdup(key, &entry_local.heap_key));
+    }
 
-    SAIL_TRY(sail_alloc_variant_node_and_value(&local_variant_node));
-    SAIL_TRY_OR_CLEANUP(sail_set_variant_string(local_variant_node->variant, key),
-                        /* cleanup */ sail_destroy_variant_node_chain(local_variant_node));
+    SAIL_TRY_OR_CLEANUP(copy_variant_value(value, &entry_local.value),
+                        /* cleanup */ sail_free(entry_local.heap_key));
 
-    SAIL_TRY_OR_CLEANUP(sail_alloc_variant_node(&local_variant_node->next),
-                        /* cleanup */ sail_destroy_variant_node_chain(local_variant_node));
-    SAIL_TRY_OR_CLEANUP(sail_copy_variant(value, &local_variant_node->next->variant),
-                        /* cleanup */ sail_destroy_variant_node_chain(local_variant_node));
+    entry_local.occupied = true;
+    entry_local.hash     = hash;
 
-    *key_variant_node = local_variant_node;
+    *entry = entry_local;
+    hash_map->size++;
 
     return SAIL_OK;
 }
@@ -108,15 +207,7 @@ bool sail_hash_map_has_key(const struct sail_hash_map *hash_map, const char *key
         return false;
     }
 
-    for (const struct sail_variant_node *key_variant_node = hash_map->buckets[calculate_hash(key)];
-            key_variant_node != NULL;
-            key_variant_node = key_variant_node->next->next) {
-        if (strcmp(sail_variant_to_string(key_variant_node->variant), key) == 0) {
-            return true;
-        }
-    }
-
-    return false;
+    return find_entry(hash_map, key, sail_string_hash(key))->occupied;
 }
 
 struct sail_variant* sail_hash_map_value(const struct sail_hash_map *hash_map, const char *key) {
@@ -125,38 +216,23 @@ struct sail_variant* sail_hash_map_value(const struct sail_hash_map *hash_map, c
         return NULL;
     }
 
-    for (struct sail_variant_node *key_variant_node = hash_map->buckets[calculate_hash(key)];
-            key_variant_node != NULL;
-            key_variant_node = key_variant_node->next->next) {
-        if (strcmp(sail_variant_to_string(key_variant_node->variant), key) == 0) {
-            return key_variant_node->next->variant;
-        }
-    }
+    struct sail_hash_map_entry *entry = find_entry(hash_map, key, sail_string_hash(key));
 
-    return NULL;
+    return entry->occupied ? &entry->value : NULL;
 }
 
 unsigned sail_hash_map_size(const struct sail_hash_map *hash_map) {
 
-    unsigned size = 0;
-
-    for (size_t i = 0; i < SAIL_HASH_MAP_SIZE; i++) {
-        for (struct sail_variant_node *key_variant_node = hash_map->buckets[i];
-                key_variant_node != NULL;
-                key_variant_node = key_variant_node->next->next) {
-            size++;
-        }
-    }
-
-    return size;
+    return (unsigned)hash_map->size;
 }
 
 void sail_traverse_hash_map(const struct sail_hash_map *hash_map, bool (*callback)(const char *key, const struct sail_variant *value)){
 
-    for (size_t i = 0; i < SAIL_HASH_MAP_SIZE; i++) {
-        for (const struct sail_variant_node *key_variant_node = hash_map->buckets[i];
-                key_variant_node != NULL && callback(sail_variant_to_string(key_variant_node->variant), key_variant_node->next->variant);
-                key_variant_node = key_variant_node->next->next) {
+    for (size_t i = 0; i < hash_map->capacity; i++) {
+        const struct sail_hash_map_entry *entry = &hash_map->entries[i];
+
+        if (entry->occupied && !callback(entry_key(entry), &entry->value)) {
+            return;
         }
     }
 }
@@ -165,10 +241,11 @@ void sail_traverse_hash_map_with_user_data(const struct sail_hash_map *hash_map,
                                            bool (*callback)(const char *key, const struct sail_variant *value, void *user_data),
                                            void *user_data) {
 
-    for (size_t i = 0; i < SAIL_HASH_MAP_SIZE; i++) {
-        for (const struct sail_variant_node *key_variant_node = hash_map->buckets[i];
-                key_variant_node != NULL && callback(sail_variant_to_string(key_variant_node->variant), key_variant_node->next->variant, user_data);
-                key_variant_node = key_variant_node->next->next) {
+    for (size_t i = 0; i < hash_map->capacity; i++) {
+        const struct sail_hash_map_entry *entry = &hash_map->entries[i];
+
+        if (entry->occupied && !callback(entry_key(entry), &entry->value, user_data)) {
+            return;
         }
     }
 }
@@ -179,37 +256,42 @@ void sail_erase_hash_map_key(struct sail_hash_map *hash_map, const char *key) {
         return;
     }
 
-    for (struct sail_variant_node **head_variant_node = &hash_map->buckets[calculate_hash(key)],
-                *key_variant_node = *head_variant_node,
-                *prev_key_variant_node = NULL;
-            key_variant_node != NULL;
-            prev_key_variant_node = key_variant_node, key_variant_node = key_variant_node->next->next) {
-        if (strcmp(sail_variant_to_string(key_variant_node->variant), key) == 0) {
+    struct sail_hash_map_entry *entry = find_entry(hash_map, key, sail_string_hash(key));
 
-            struct sail_variant_node *next_key_variant_node = key_variant_node->next->next;
+    if (!entry->occupied) {
+        return;
+    }
 
-            sail_destroy_variant_node(key_variant_node->next);
-            sail_destroy_variant_node(key_variant_node);
+    destroy_entry(entry);
+    hash_map->size--;
 
-            /* Erase from the head. */
-            if (key_variant_node == *head_variant_node) {
-                *head_variant_node = next_key_variant_node;
-            } else {
-                /* Erase from the middle/end. */
-                prev_key_variant_node->next->next = next_key_variant_node;
-            }
+    /* Shift the following entries back to close the gap, so lookups never stop at it. */
+    const size_t mask = hash_map->capacity - 1;
+    size_t gap = (size_t)(entry - hash_map->entries);
 
-            return;
+    for (size_t i = (gap + 1) & mask; hash_map->entries[i].occupied; i = (i + 1) & mask) {
+        const size_t home = home_index(hash_map->entries[i].hash, hash_map->capacity);
+
+        /* The entry can move to the gap if its home index is not in the cyclic range (gap, i]. */
+        const bool in_range = (gap < i) ? (home > gap && home <= i) : (home > gap || home <= i);
+
+        if (!in_range) {
+            hash_map->entries[gap] = hash_map->entries[i];
+            memset(&hash_map->entries[i], 0, sizeof(hash_map->entries[i]));
+            gap = i;
         }
     }
 }
 
 void sail_clear_hash_map(struct sail_hash_map *hash_map) {
 
-    for (size_t i = 0; i < SAIL_HASH_MAP_SIZE; i++) {
-        sail_destroy_variant_node_chain(hash_map->buckets[i]);
-        hash_map->buckets[i] = NULL;
+    for (size_t i = 0; i < hash_map->capacity; i++) {
+        if (hash_map->entries[i].occupied) {
+            destroy_entry(&hash_map->entries[i]);
+        }
     }
+
+    hash_map->size = 0;
 }
 
 sail_status_t sail_copy_hash_map(const struct sail_hash_map *source_hash_map, struct sail_hash_map **target_hash_map) {
@@ -220,9 +302,37 @@ sail_status_t sail_copy_hash_map(const struct sail_hash_map *source_hash_map, st
     struct sail_hash_map *hash_map_local;
     SAIL_TRY(sail_alloc_hash_map(&hash_map_local));
 
-    for (size_t i = 0; i < SAIL_HASH_MAP_SIZE; i++) {
-        SAIL_TRY_OR_CLEANUP(sail_copy_variant_node_chain(source_hash_map->buckets[i], &hash_map_local->buckets[i]),
+    /* The same capacity keeps every entry at the same index. */
+    if (source_hash_map->capacity > SAIL_HASH_MAP_INLINE_CAPACITY) {
+        void *ptr;
+        SAIL_TRY_OR_CLEANUP(sail_calloc(source_hash_map->capacity, sizeof(struct sail_hash_map_entry), &ptr),
                             /* cleanup */ sail_destroy_hash_map(hash_map_local));
+
+        hash_map_local->entries  = ptr;
+        hash_map_local->capacity = source_hash_map->capacity;
+    }
+
+    for (size_t i = 0; i < source_hash_map->capacity; i++) {
+        const struct sail_hash_map_entry *source_entry = &source_hash_map->entries[i];
+        struct sail_hash_map_entry *target_entry = &hash_map_local->entries[i];
+
+        if (!source_entry->occupied) {
+            continue;
+        }
+
+        *target_entry = *source_entry;
+        target_entry->heap_key    = NULL;
+        target_entry->value.value = NULL;
+
+        if (source_entry->heap_key != NULL) {
+            SAIL_TRY_OR_CLEANUP(sail_strdup(source_entry->heap_key, &target_entry->heap_key),
+                                /* cleanup */ sail_destroy_hash_map(hash_map_local));
+        }
+
+        SAIL_TRY_OR_CLEANUP(copy_variant_value(&source_entry->value, &target_entry->value),
+                            /* cleanup */ sail_destroy_hash_map(hash_map_local));
+
+        hash_map_local->size++;
     }
 
     *target_hash_map = hash_map_local;
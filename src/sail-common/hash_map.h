@@ -63,7 +63,7 @@ SAIL_EXPORT sail_status_t sail_put_hash_map(struct sail_hash_map *hash_map, cons
 SAIL_EXPORT bool sail_hash_map_has_key(const struct sail_hash_map *hash_map, const char *key);
 
 /*
- * Returns the key associated value or NULL.
+ * Returns the key associated value or NULL. The value is valid until the hash map is modified.
  */
 SAIL_EXPORT struct sail_variant* sail_hash_map_value(const struct sail_hash_map *hash_map, const char *key);
 
@@ -26,21 +26,45 @@
 #ifndef SAIL_HASH_MAP_PRIVATE_H
 #define SAIL_HASH_MAP_PRIVATE_H
 
-struct sail_variant_node;
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <sail-common/variant.h>
 
 enum {
-    SAIL_HASH_MAP_SIZE = 32
+    /* Entries stored in the hash map itself before the first growth. Must be a power of 2. */
+    SAIL_HASH_MAP_INLINE_CAPACITY = 8,
+
+    /* Keys shorter than this are stored in entries without extra allocations. */
+    SAIL_HASH_MAP_INLINE_KEY_SIZE = 32,
+};
+
+/*
+ * Hash map entry. Keys longer than SAIL_HASH_MAP_INLINE_KEY_SIZE - 1 are allocated on the heap.
+ * The value variant is stored in the entry, its value is owned by the variant as usual.
+ */
+struct sail_hash_map_entry {
+
+    bool occupied;
+    uint64_t hash;
+    char *heap_key;
+    char inline_key[SAIL_HASH_MAP_INLINE_KEY_SIZE];
+    struct sail_variant value;
 };
 
 /*
- * A pretty limited hash map implementation.
+ * Open-addressing hash map with linear probing. Entries live in a single array of
+ * a power of 2 capacity. Small maps use the inline entries and need no extra allocations.
  */
 struct sail_hash_map {
 
-    /*
-     * Values follow keys in the chain, e.g. key1 -> value1 -> key2 -> value2 -> NULL.
-     */
-    struct sail_variant_node *buckets[SAIL_HASH_MAP_SIZE];
+    size_t capacity;
+    size_t size;
+
+    /* Points to inline_entries or to a heap array. */
+    struct sail_hash_map_entry *entries;
+    struct sail_hash_map_entry inline_entries[SAIL_HASH_MAP_INLINE_CAPACITY];
 };
 
 #endif
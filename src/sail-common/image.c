@@ -23,6 +23,7 @@
     SOFTWARE.
 */
 
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -30,6 +31,132 @@
 
 #include "sail-common.h"
 
+/*
+ * Private functions.
+ */
+
+/* Transposition tile size in pixels. 32x32 tiles of up to 8-byte pixels fit into L1 cache. */
+#define TRANSPOSE_TILE 32
+
+static sail_status_t byte_aligned_pixel_size(enum SailPixelFormat pixel_format, unsigned *bytes_per_pixel) {
+
+    const unsigned bits_per_pixel = sail_bits_per_pixel(pixel_format);
+
+    if (bits_per_pixel == 0 || bits_per_pixel % 8 != 0) {
+        SAIL_LOG_ERROR("Only byte-aligned pixels are supported for mirroring and rotating");
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    }
+
+    *bytes_per_pixel = bits_per_pixel / 8;
+
+    return SAIL_OK;
+}
+
+/* Swaps memory blocks in chunks, so compilers vectorize the copying. */
+static void swap_memory(void *block1, void *block2, size_t size) {
+
+    uint8_t buffer[256];
+    uint8_t *ptr1 = block1;
+    uint8_t *ptr2 = block2;
+
+    while (size > 0) {
+        const size_t chunk = size < sizeof(buffer) ? size : sizeof(buffer);
+
+        memcpy(buffer, ptr1,   chunk);
+        memcpy(ptr1,   ptr2,   chunk);
+        memcpy(ptr2,   buffer, chunk);
+
+        ptr1 += chunk;
+        ptr2 += chunk;
+        size -= chunk;
+    }
+}
+
+/*
+ * Pixel sizes are compile-time constants in the loops below, so compilers
+ * replace memcpy() calls with plain (and often vectorized) loads and stores.
+ */
+#define MIRROR_ROW(pixel_size)                                              \
+    for (uint8_t *left = scan, *right = scan + (size_t)(width - 1) * (pixel_size); \
+            left < right; left += (pixel_size), right -= (pixel_size)) {    \
+        uint8_t pixel[pixel_size];                                          \
+        memcpy(pixel, left,  pixel_size);                                   \
+        memcpy(left,  right, pixel_size);                                   \
+        memcpy(right, pixel, pixel_size);                                   \
+    }
+
+static void mirror_row(uint8_t *scan, unsigned width, unsigned bytes_per_pixel) {
+
+    switch (bytes_per_pixel) {
+        case 1:  { MIRROR_ROW(1);  break; }
+        case 2:  { MIRROR_ROW(2);  break; }
+        case 3:  { MIRROR_ROW(3);  break; }
+        case 4:  { MIRROR_ROW(4);  break; }
+        case 6:  { MIRROR_ROW(6);  break; }
+        case 8:  { MIRROR_ROW(8);  break; }
+        case 12: { MIRROR_ROW(12); break; }
+        case 16: { MIRROR_ROW(16); break; }
+
+        default: {
+            for (uint8_t *left = scan, *right = scan + (size_t)(width - 1) * bytes_per_pixel;
+                    left < right; left += bytes_per_pixel, right -= bytes_per_pixel) {
+                swap_memory(left, right, bytes_per_pixel);
+            }
+        }
+    }
+}
+
+/*
+ * Output pixel (x, y) is taken from the input pixel (ix, iy) where
+ *
+ *   ix = flip_x ? input_width  - 1 - y : y
+ *   iy = flip_y ? input_height - 1 - x : x
+ *
+ * The loops walk over tiles to keep both the input and the output in cache.
+ */
+#define TRANSPOSE_TILE_PIXELS(pixel_size)                                                               \
+    for (unsigned y = tile_y; y < tile_y_end; y++) {                                                    \
+        uint8_t *output_scan = (uint8_t *)output + (size_t)y * output_bytes_per_line;                   \
+        const size_t input_offset = (size_t)(flip_x ? image->width - 1 - y : y) * (pixel_size);         \
+                                                                                                        \
+        for (unsigned x = tile_x; x < tile_x_end; x++) {                                                \
+            const unsigned iy = flip_y ? image->height - 1 - x : x;                                     \
+            memcpy(output_scan + (size_t)x * (pixel_size),                                              \
+                    (const uint8_t *)image->pixels + (size_t)iy * image->bytes_per_line + input_offset,  \
+                    pixel_size);                                                                        \
+        }                                                                                               \
+    }
+
+static void transpose_pixels(const struct sail_image *image, enum SailOrientation orientation, unsigned bytes_per_pixel,
+                                void *output, unsigned output_bytes_per_line) {
+
+    const bool flip_x = orientation == SAIL_ORIENTATION_ROTATED_270 || orientation == SAIL_ORIENTATION_MIRRORED_HORIZONTALLY_ROTATED_90;
+    const bool flip_y = orientation == SAIL_ORIENTATION_ROTATED_90  || orientation == SAIL_ORIENTATION_MIRRORED_HORIZONTALLY_ROTATED_90;
+
+    /* The output width is the input height. */
+    for (unsigned tile_y = 0; tile_y < image->width; tile_y += TRANSPOSE_TILE) {
+        const unsigned tile_y_end = tile_y + TRANSPOSE_TILE < image->width ? tile_y + TRANSPOSE_TILE : image->width;
+
+        for (unsigned tile_x = 0; tile_x < image->height; tile_x += TRANSPOSE_TILE) {
+            const unsigned tile_x_end = tile_x + TRANSPOSE_TILE < image->height ? tile_x + TRANSPOSE_TILE : image->height;
+
+            switch (bytes_per_pixel) {
+                case 1:  { TRANSPOSE_TILE_PIXELS(1);  break; }
+                case 2:  { TRANSPOSE_TILE_PIXELS(2);  break; }
+                case 3:  { TRANSPOSE_TILE_PIXELS(3);  break; }
+                case 4:  { TRANSPOSE_TILE_PIXELS(4);  break; }
+                case 6:  { TRANSPOSE_TILE_PIXELS(6);  break; }
+                case 8:  { TRANSPOSE_TILE_PIXELS(8);  break; }
+                default: { TRANSPOSE_TILE_PIXELS(bytes_per_pixel); break; }
+            }
+        }
+    }
+}
+
+/*
+ * Public functions.
+ */
+
 sail_status_t sail_alloc_image(struct sail_image **image) {
 
     SAIL_CHECK_PTR(image);
@@ -81,7 +208,7 @@ sail_status_t sail_copy_image(const struct sail_image *source, struct sail_image
 
     /* Pixels. */
     if (source->pixels != NULL) {
-        const unsigned pixels_size = source->height * source->bytes_per_line;
+        const size_t pixels_size = sail_bytes_per_image(source);
 
         SAIL_TRY_OR_CLEANUP(sail_malloc(pixels_size, &image_local->pixels),
                             /* cleanup */ sail_destroy_image(image_local));
@@ -189,48 +316,96 @@ sail_status_t sail_mirror_horizontally(struct sail_image *image) {
 
 sail_status_t sail_mirror(struct sail_image *image, enum SailOrientation orientation)
 {
+    if (image != NULL && sail_is_planar(image->pixel_format)) {
+        SAIL_LOG_ERROR("Mirroring planar images is not supported");
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    }
+
     switch (orientation) {
         case SAIL_ORIENTATION_MIRRORED_VERTICALLY: {
             SAIL_TRY(sail_check_image_valid(image));
 
-            void *line;
-            SAIL_TRY(sail_malloc(image->bytes_per_line, &line));
-
             for (unsigned row1 = 0, row2 = image->height - 1; row1 < row2; row1++, row2--) {
-                memcpy(line,                        sail_scan_line(image, row1), image->bytes_per_line);
-                memcpy(sail_scan_line(image, row1), sail_scan_line(image, row2), image->bytes_per_line);
-                memcpy(sail_scan_line(image, row2), line,                        image->bytes_per_line);
+                swap_memory(sail_scan_line(image, row1), sail_scan_line(image, row2), image->bytes_per_line);
             }
 
-            sail_free(line);
             break;
         }
         case SAIL_ORIENTATION_MIRRORED_HORIZONTALLY: {
             SAIL_TRY(sail_check_image_valid(image));
 
-            const unsigned bits_per_pixel = sail_bits_per_pixel(image->pixel_format);
+            unsigned bytes_per_pixel;
+            SAIL_TRY(byte_aligned_pixel_size(image->pixel_format, &bytes_per_pixel));
 
-            if (bits_per_pixel % 8 != 0) {
-                SAIL_LOG_ERROR("Only byte-aligned pixels are supported for the horizontal mirroring");
-                SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+            for (unsigned row = 0; row < image->height; row++) {
+                mirror_row(sail_scan_line(image, row), image->width, bytes_per_pixel);
             }
 
-            const unsigned bytes_per_pixel = bits_per_pixel / 8;
+            break;
+        }
+        default: {
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_INVALID_ARGUMENT);
+        }
+    }
+
+    return SAIL_OK;
+}
 
-            void *pixel;
-            SAIL_TRY(sail_malloc(bytes_per_pixel, &pixel));
+sail_status_t sail_rotate_image(struct sail_image *image, enum SailOrientation orientation) {
 
-            for (unsigned row = 0; row < image->height; row++) {
-                unsigned char *scan = sail_scan_line(image, row);
+    SAIL_TRY(sail_check_image_valid(image));
 
-                for (unsigned col1 = 0, col2 = (image->width - 1) * bytes_per_pixel; col1 < col2; col1 += bytes_per_pixel, col2 -= bytes_per_pixel) {
-                    memcpy(pixel,       scan + col1, bytes_per_pixel);
-                    memcpy(scan + col1, scan + col2, bytes_per_pixel);
-                    memcpy(scan + col2, pixel,       bytes_per_pixel);
-                }
+    if (sail_is_planar(image->pixel_format) && orientation != SAIL_ORIENTATION_NORMAL) {
+        SAIL_LOG_ERROR("Rotating planar images is not supported");
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    }
+
+    switch (orientation) {
+        case SAIL_ORIENTATION_NORMAL: {
+            break;
+        }
+        case SAIL_ORIENTATION_MIRRORED_HORIZONTALLY:
+        case SAIL_ORIENTATION_MIRRORED_VERTICALLY: {
+            SAIL_TRY(sail_mirror(image, orientation));
+            break;
+        }
+        case SAIL_ORIENTATION_ROTATED_180: {
+            unsigned bytes_per_pixel;
+            SAIL_TRY(byte_aligned_pixel_size(image->pixel_format, &bytes_per_pixel));
+
+            SAIL_TRY(sail_mirror(image, SAIL_ORIENTATION_MIRRORED_VERTICALLY));
+            SAIL_TRY(sail_mirror(image, SAIL_ORIENTATION_MIRRORED_HORIZONTALLY));
+            break;
+        }
+        case SAIL_ORIENTATION_ROTATED_90:
+        case SAIL_ORIENTATION_ROTATED_270:
+        case SAIL_ORIENTATION_MIRRORED_HORIZONTALLY_ROTATED_90:
+        case SAIL_ORIENTATION_MIRRORED_HORIZONTALLY_ROTATED_270: {
+            unsigned bytes_per_pixel;
+            SAIL_TRY(byte_aligned_pixel_size(image->pixel_format, &bytes_per_pixel));
+
+            const unsigned bytes_per_line = sail_bytes_per_line(image->height, image->pixel_format);
+
+            void *pixels;
+            SAIL_TRY(sail_malloc((size_t)image->width * bytes_per_line, &pixels));
+
+            transpose_pixels(image, orientation, bytes_per_pixel, pixels, bytes_per_line);
+
+            sail_free(image->pixels);
+
+            image->pixels         = pixels;
+            image->bytes_per_line = bytes_per_line;
+
+            const unsigned width = image->width;
+            image->width  = image->height;
+            image->height = width;
+
+            if (image->resolution != NULL) {
+                const double x = image->resolution->x;
+                image->resolution->x = image->resolution->y;
+                image->resolution->y = x;
             }
 
-            sail_free(pixel);
             break;
         }
         default: {
@@ -241,6 +416,131 @@ sail_status_t sail_mirror(struct sail_image *image, enum SailOrientation orienta
     return SAIL_OK;
 }
 
+sail_status_t sail_crop_image(struct sail_image *image, unsigned x, unsigned y, unsigned width, unsigned height) {
+
+    SAIL_TRY(sail_check_image_valid(image));
+
+    if (width == 0 || height == 0 || x >= image->width || y >= image->height
+            || width > image->width - x || height > image->height - y) {
+        SAIL_LOG_ERROR("Crop region %ux%u+%u+%u lies outside of the %ux%u image", width, height, x, y, image->width, image->height);
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_INCORRECT_IMAGE_DIMENSIONS);
+    }
+
+    if (x == 0 && y == 0 && width == image->width && height == image->height) {
+        return SAIL_OK;
+    }
+
+    if (sail_is_planar(image->pixel_format)) {
+        SAIL_LOG_ERROR("Cropping planar images is not supported");
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    }
+
+    const unsigned bits_per_pixel = sail_bits_per_pixel(image->pixel_format);
+    const unsigned bytes_per_line = sail_bytes_per_line(width, image->pixel_format);
+
+    /* New rows never start after their source rows, so moving them in ascending order is safe. */
+    for (unsigned row = 0; row < height; row++) {
+        const unsigned char *source = sail_scan_line(image, y + row);
+        unsigned char *target = (unsigned char *)image->pixels + (size_t)row * bytes_per_line;
+
+        if (bits_per_pixel % 8 == 0) {
+            memmove(target, source + (size_t)x * (bits_per_pixel / 8), bytes_per_line);
+        } else {
+            const size_t source_bit = (size_t)x * bits_per_pixel;
+            const size_t bits       = (size_t)width * bits_per_pixel;
+
+            for (size_t bit = 0; bit < bits; bit++) {
+                const size_t from = source_bit + bit;
+                const unsigned char mask = (unsigned char)(0x80 >> (bit % 8));
+
+                if (source[from / 8] & (0x80 >> (from % 8))) {
+                    target[bit / 8] |= mask;
+                } else {
+                    target[bit / 8] &= (unsigned char)~mask;
+                }
+            }
+        }
+    }
+
+    image->width          = width;
+    image->height         = height;
+    image->bytes_per_line = bytes_per_line;
+
+    SAIL_TRY(sail_realloc((size_t)height * bytes_per_line, &image->pixels));
+
+    return SAIL_OK;
+}
+
+size_t sail_bytes_per_image(const struct sail_image *image) {
+
+    if (image == NULL) {
+        return 0;
+    }
+
+    struct sail_plane planes[3];
+    unsigned planes_count;
+
+    if (sail_image_planes(image, planes, &planes_count) != SAIL_OK) {
+        return (size_t)image->height * image->bytes_per_line;
+    }
+
+    size_t bytes = 0;
+
+    for (unsigned i = 0; i < planes_count; i++) {
+        bytes += (size_t)planes[i].height * planes[i].bytes_per_line;
+    }
+
+    return bytes;
+}
+
+sail_status_t sail_image_planes(const struct sail_image *image, struct sail_plane planes[3], unsigned *planes_count) {
+
+    SAIL_CHECK_PTR(image);
+    SAIL_CHECK_PTR(planes);
+    SAIL_CHECK_PTR(planes_count);
+
+    uint8_t *pixels = image->pixels;
+
+    planes[0].pixels         = pixels;
+    planes[0].width          = image->width;
+    planes[0].height         = image->height;
+    planes[0].bytes_per_line = image->bytes_per_line;
+
+    if (!sail_is_planar(image->pixel_format)) {
+        *planes_count = 1;
+        return SAIL_OK;
+    }
+
+    /* Subsampled chroma planes start right after the Y plane. */
+    const unsigned chroma_width          = (image->width + 1) / 2;
+    const unsigned chroma_bytes_per_line = (image->bytes_per_line + 1) / 2;
+    const unsigned chroma_height         = (image->pixel_format == SAIL_PIXEL_FORMAT_BPP16_YUV422P)
+                                                ? image->height
+                                                : (image->height + 1) / 2;
+    const size_t luma_size = (size_t)image->height * image->bytes_per_line;
+
+    planes[1].pixels = (pixels == NULL) ? NULL : pixels + luma_size;
+    planes[1].width  = chroma_width;
+    planes[1].height = chroma_height;
+
+    if (image->pixel_format == SAIL_PIXEL_FORMAT_BPP12_NV12) {
+        planes[1].bytes_per_line = chroma_bytes_per_line * 2;
+        *planes_count = 2;
+        return SAIL_OK;
+    }
+
+    planes[1].bytes_per_line = chroma_bytes_per_line;
+
+    planes[2].pixels         = (pixels == NULL) ? NULL : pixels + luma_size + (size_t)chroma_height * chroma_bytes_per_line;
+    planes[2].width          = chroma_width;
+    planes[2].height         = chroma_height;
+    planes[2].bytes_per_line = chroma_bytes_per_line;
+
+    *planes_count = 3;
+
+    return SAIL_OK;
+}
+
 void* sail_scan_line(const struct sail_image *image, unsigned row) {
 
     if (SAIL_UNLIKELY(image == NULL || image->pixels == NULL)) {
@@ -27,6 +27,7 @@
 #define SAIL_IMAGE_H
 
 #include <stdbool.h>
+#include <stddef.h>
 
 #include <sail-common/common.h>
 #include <sail-common/export.h>
@@ -42,6 +43,22 @@ struct sail_palette;
 struct sail_resolution;
 struct sail_source_image;
 
+/*
+ * A plane of planar image pixels. See sail_image_planes().
+ */
+struct sail_plane {
+
+    /* Plane samples. Points into the image pixels. */
+    void *pixels;
+
+    /* Plane dimensions in samples. Interleaved UV samples of NV12 count as one sample. */
+    unsigned width;
+    unsigned height;
+
+    /* Length of a plane row in bytes. */
+    unsigned bytes_per_line;
+};
+
 /*
  * sail_image represents an image. Fields set by SAIL when loading images are marked with LOAD.
  * Fields that must be set by a caller when saving images are marked with SAVE.
@@ -234,6 +251,42 @@ SAIL_EXPORT sail_status_t sail_mirror_horizontally(struct sail_image *image);
  */
 SAIL_EXPORT sail_status_t sail_mirror(struct sail_image *image, enum SailOrientation orientation);
 
+/*
+ * Transforms the image according to the orientation, so an image stored with this orientation
+ * becomes upright. For example, SAIL_ORIENTATION_ROTATED_90 rotates the image 90 degrees clockwise.
+ * The image pixel size must be a multiple of 8, e.g. 8, 16, 24 etc.
+ *
+ * Rotations by 90 and 270 degrees and transpositions reallocate the pixels and swap the image
+ * width and height. Other orientations are applied in place.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_rotate_image(struct sail_image *image, enum SailOrientation orientation);
+
+/*
+ * Crops the image in place to the specified region, so the image contains only the region pixels.
+ * The region must lie inside the image. Planar pixel formats are not supported.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_crop_image(struct sail_image *image, unsigned x, unsigned y, unsigned width, unsigned height);
+
+/*
+ * Returns the number of bytes needed to hold the image pixels. For packed pixel formats it's
+ * height * bytes_per_line. For planar pixel formats it also includes the chroma planes.
+ * Returns 0 if the image is NULL.
+ */
+SAIL_EXPORT size_t sail_bytes_per_image(const struct sail_image *image);
+
+/*
+ * Fills the planes of the image pixels. Packed pixel formats have a single plane, i.e.
+ * the image pixels themselves. Planar pixel formats have up to 3 planes. The planes array
+ * must have room for at least 3 planes.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_image_planes(const struct sail_image *image, struct sail_plane planes[3], unsigned *planes_count);
+
 /*
  * Returns the scan line at the given row.
  * Return NULL if the image or its pixels is NULL.
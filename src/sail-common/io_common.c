@@ -28,6 +28,40 @@
 
 #include "sail-common.h"
 
+static sail_status_t read_io_until_eof(struct sail_io *io, void **data, size_t *data_size) {
+
+    size_t capacity = 64 * 1024;
+    size_t size = 0;
+
+    void *data_local;
+    SAIL_TRY(sail_malloc(capacity, &data_local));
+
+    for (;;) {
+        if (size == capacity) {
+            capacity *= 2;
+            SAIL_TRY_OR_CLEANUP(sail_realloc(capacity, &data_local),
+                                /* cleanup */ sail_free(data_local));
+        }
+
+        size_t read_size;
+        const sail_status_t status = io->tolerant_read(io->stream, (char *)data_local + size, capacity - size, &read_size);
+
+        if (status == SAIL_ERROR_EOF || (status == SAIL_OK && read_size == 0)) {
+            break;
+        }
+
+        SAIL_TRY_OR_CLEANUP(status,
+                            /* cleanup */ sail_free(data_local));
+
+        size += read_size;
+    }
+
+    *data      = data_local;
+    *data_size = size;
+
+    return SAIL_OK;
+}
+
 sail_status_t sail_alloc_io(struct sail_io **io) {
 
     SAIL_CHECK_PTR(io);
@@ -135,14 +169,20 @@ sail_status_t sail_alloc_data_from_io_contents(struct sail_io *io, void **data,
     SAIL_CHECK_PTR(data_size);
 
     size_t data_size_local;
-    SAIL_TRY(sail_io_size(io, &data_size_local));
-
-    /* Read stream. */
     void *data_local;
-    SAIL_TRY(sail_malloc(data_size_local, &data_local));
 
-    SAIL_TRY_OR_CLEANUP(io->strict_read(io->stream, data_local, data_size_local),
-                        /* cleanup */ sail_free(data_local));
+    if (io->features & SAIL_IO_FEATURE_SEEKABLE) {
+        SAIL_TRY(sail_io_size(io, &data_size_local));
+
+        /* Read stream. */
+        SAIL_TRY(sail_malloc(data_size_local, &data_local));
+
+        SAIL_TRY_OR_CLEANUP(io->strict_read(io->stream, data_local, data_size_local),
+                            /* cleanup */ sail_free(data_local));
+    } else {
+        /* The size is unknown, so read until the end growing the buffer. */
+        SAIL_TRY(read_io_until_eof(io, &data_local, &data_size_local));
+    }
 
     *data = data_local;
     *data_size = data_size_local;
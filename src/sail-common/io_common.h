@@ -117,7 +117,8 @@ enum SailIoFeature {
 
     /*
      * The I/O object is seekable. When this flag is off, the seek callback
-     * must return SAIL_ERROR_NOT_IMPLEMENTED.
+     * must return SAIL_ERROR_NOT_IMPLEMENTED or seek only within a limited window
+     * of recently read data like the I/O objects allocated with sail_alloc_io_read_ahead().
      */
     SAIL_IO_FEATURE_SEEKABLE = 1 << 0,
 };
@@ -38,6 +38,7 @@ sail_status_t sail_alloc_load_options(struct sail_load_options **load_options) {
 
     (*load_options)->options = 0;
     (*load_options)->tuning  = NULL;
+    (*load_options)->region  = (struct sail_region) { 0, 0, 0, 0 };
 
     return SAIL_OK;
 }
@@ -87,6 +88,7 @@ sail_status_t sail_copy_load_options(const struct sail_load_options *source, str
     SAIL_TRY(sail_alloc_load_options(&target_local));
 
     target_local->options = source->options;
+    target_local->region  = source->region;
 
     if (source->tuning != NULL) {
         SAIL_TRY_OR_CLEANUP(sail_copy_hash_map(source->tuning, &target_local->tuning),
@@ -97,3 +99,27 @@ sail_status_t sail_copy_load_options(const struct sail_load_options *source, str
 
     return SAIL_OK;
 }
+
+sail_status_t sail_clip_region(const struct sail_region *region, unsigned width, unsigned height, struct sail_region *clipped) {
+
+    SAIL_CHECK_PTR(region);
+    SAIL_CHECK_PTR(clipped);
+
+    if (region->width == 0 || region->height == 0) {
+        *clipped = (struct sail_region) { 0, 0, width, height };
+        return SAIL_OK;
+    }
+
+    if (region->x >= width || region->y >= height) {
+        SAIL_LOG_ERROR("Region %ux%u+%u+%u lies outside of the %ux%u frame",
+                        region->width, region->height, region->x, region->y, width, height);
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_INCORRECT_IMAGE_DIMENSIONS);
+    }
+
+    clipped->x      = region->x;
+    clipped->y      = region->y;
+    clipped->width  = (region->width  > width  - region->x) ? width  - region->x : region->width;
+    clipped->height = (region->height > height - region->y) ? height - region->y : region->height;
+
+    return SAIL_OK;
+}
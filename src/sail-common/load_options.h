@@ -36,6 +36,19 @@ extern "C" {
 struct sail_hash_map;
 struct sail_load_features;
 
+/*
+ * Rectangular region of an image frame.
+ */
+struct sail_region {
+
+    unsigned x;
+    unsigned y;
+    unsigned width;
+    unsigned height;
+};
+
+typedef struct sail_region sail_region_t;
+
 /*
  * Options to modify loading operations.
  */
@@ -59,6 +72,16 @@ struct sail_load_options {
      * or forward compatible.
      */
     struct sail_hash_map *tuning;
+
+    /*
+     * Region of interest to load. Loaded frames contain only this region clipped to the frame
+     * dimensions. The region is specified in the coordinates of the stored pixels, i.e. before
+     * applying SAIL_OPTION_APPLY_ORIENTATION. Zero width or height loads whole frames.
+     *
+     * Codecs with SAIL_CODEC_FEATURE_REGION decode only the region where possible. Other codecs
+     * decode whole frames and crop them.
+     */
+    struct sail_region region;
 };
 
 typedef struct sail_load_options sail_load_options_t;
@@ -90,6 +113,15 @@ SAIL_EXPORT sail_status_t sail_alloc_load_options_from_features(const struct sai
  */
 SAIL_EXPORT sail_status_t sail_copy_load_options(const struct sail_load_options *source, struct sail_load_options **target);
 
+/*
+ * Clips the region to a frame of the specified dimensions. A region with zero width or height
+ * covers the whole frame.
+ *
+ * Returns SAIL_OK on success.
+ * Returns SAIL_ERROR_INCORRECT_IMAGE_DIMENSIONS if the region lies outside of the frame.
+ */
+SAIL_EXPORT sail_status_t sail_clip_region(const struct sail_region *region, unsigned width, unsigned height, struct sail_region *clipped);
+
 /* extern "C" */
 #ifdef __cplusplus
 }
@@ -23,15 +23,304 @@
     SOFTWARE.
 */
 
+#include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
+
+#ifdef _MSC_VER
+    #include <intrin.h>
+#endif
 
 #include "sail-common.h"
 
+static struct sail_memory_allocator memory_allocator = {
+    .malloc_func  = malloc,
+    .realloc_func = realloc,
+    .calloc_func  = calloc,
+    .free_func    = free,
+};
+
+/*
+ * Arenas.
+ *
+ * Every arena allocation is preceded by a header pointing to its chunk. A chunk is referenced
+ * by every live allocation in it, and by its arena until the arena is destroyed. The last
+ * reference returns the chunk to the allocator. Live chunks are linked into a global list,
+ * so sail_free() can tell arena allocations apart. The list is not even looked at
+ * when there are no live chunks.
+ */
+
+#define ARENA_CHUNK_SIZE (16 * 1024)
+#define ARENA_ALIGNMENT  16
+
+#define ARENA_ALIGN(size) (((size) + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1))
+
+struct arena_chunk {
+
+    /* The next chunk of the same arena. */
+    struct arena_chunk *next;
+
+    /* Neighbours in the global list of live chunks. */
+    struct arena_chunk *prev_live;
+    struct arena_chunk *next_live;
+
+    /* Bytes used from the beginning of the chunk including this header. */
+    size_t used;
+
+    /* Live allocations plus one for the arena. Changed atomically. */
+    long references;
+};
+
+struct arena_header {
+
+    struct arena_chunk *chunk;
+    size_t size;
+};
+
+#define ARENA_CHUNK_HEADER_SIZE ARENA_ALIGN(sizeof(struct arena_chunk))
+#define ARENA_HEADER_SIZE       ARENA_ALIGN(sizeof(struct arena_header))
+
+struct sail_arena {
+
+    /* The first chunk is the one to allocate from. */
+    struct arena_chunk *chunks;
+};
+
+static SAIL_THREAD_LOCAL struct sail_arena *current_arena = NULL;
+
+static struct arena_chunk *live_chunks = NULL;
+static long live_chunks_count = 0;
+static long live_chunks_lock = 0;
+
+#ifdef _MSC_VER
+static long atomic_add(long volatile *value, long delta) {
+    return _InterlockedExchangeAdd(value, delta) + delta;
+}
+
+static long atomic_load(long volatile *value) {
+    return _InterlockedCompareExchange(value, 0, 0);
+}
+
+static void lock_live_chunks(void) {
+    while (_InterlockedCompareExchange(&live_chunks_lock, 1, 0) != 0) {
+    }
+}
+
+static void unlock_live_chunks(void) {
+    _InterlockedExchange(&live_chunks_lock, 0);
+}
+#else
+static long atomic_add(long volatile *value, long delta) {
+    return __atomic_add_fetch(value, delta, __ATOMIC_ACQ_REL);
+}
+
+static long atomic_load(long volatile *value) {
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+
+static void lock_live_chunks(void) {
+    while (__atomic_exchange_n(&live_chunks_lock, 1, __ATOMIC_ACQUIRE) != 0) {
+    }
+}
+
+static void unlock_live_chunks(void) {
+    __atomic_store_n(&live_chunks_lock, 0, __ATOMIC_RELEASE);
+}
+#endif
+
+static sail_status_t alloc_arena_chunk(struct arena_chunk **chunk) {
+
+    struct arena_chunk *chunk_local = memory_allocator.malloc_func(ARENA_CHUNK_SIZE);
+
+    if (chunk_local == NULL) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_MEMORY_ALLOCATION);
+    }
+
+    chunk_local->next       = NULL;
+    chunk_local->prev_live  = NULL;
+    chunk_local->used       = ARENA_CHUNK_HEADER_SIZE;
+    chunk_local->references = 1;
+
+    lock_live_chunks();
+
+    chunk_local->next_live = live_chunks;
+
+    if (live_chunks != NULL) {
+        live_chunks->prev_live = chunk_local;
+    }
+
+    live_chunks = chunk_local;
+    atomic_add(&live_chunks_count, 1);
+
+    unlock_live_chunks();
+
+    *chunk = chunk_local;
+
+    return SAIL_OK;
+}
+
+static void release_arena_chunk(struct arena_chunk *chunk) {
+
+    if (atomic_add(&chunk->references, -1) > 0) {
+        return;
+    }
+
+    lock_live_chunks();
+
+    if (chunk->prev_live != NULL) {
+        chunk->prev_live->next_live = chunk->next_live;
+    } else {
+        live_chunks = chunk->next_live;
+    }
+
+    if (chunk->next_live != NULL) {
+        chunk->next_live->prev_live = chunk->prev_live;
+    }
+
+    atomic_add(&live_chunks_count, -1);
+
+    unlock_live_chunks();
+
+    memory_allocator.free_func(chunk);
+}
+
+/* Returns the header of the arena allocation or NULL if the pointer is not allocated from an arena. */
+static struct arena_header* find_arena_header(void *ptr) {
+
+    if (ptr == NULL || atomic_load(&live_chunks_count) == 0) {
+        return NULL;
+    }
+
+    struct arena_header *header = NULL;
+
+    lock_live_chunks();
+
+    for (struct arena_chunk *chunk = live_chunks; chunk != NULL; chunk = chunk->next_live) {
+        const unsigned char *begin = (const unsigned char *)chunk;
+
+        if ((const unsigned char *)ptr > begin && (const unsigned char *)ptr < begin + ARENA_CHUNK_SIZE) {
+            header = (struct arena_header *)((unsigned char *)ptr - ARENA_HEADER_SIZE);
+            break;
+        }
+    }
+
+    unlock_live_chunks();
+
+    return header;
+}
+
+/* Allocates from the arena. Only the thread the arena is current in calls this function. */
+static sail_status_t arena_malloc(struct sail_arena *arena, size_t size, void **ptr) {
+
+    const size_t required = ARENA_HEADER_SIZE + ARENA_ALIGN(size);
+    struct arena_chunk *chunk = arena->chunks;
+
+    if (chunk == NULL || chunk->used + required > ARENA_CHUNK_SIZE) {
+        /*
+         * Reuse a chunk with no live allocations. Other threads only free allocations,
+         * so such a chunk cannot get new references in the meantime.
+         */
+        struct arena_chunk **link = &arena->chunks;
+
+        for (chunk = arena->chunks; chunk != NULL; link = &chunk->next, chunk = chunk->next) {
+            if (atomic_load(&chunk->references) == 1) {
+                chunk->used = ARENA_CHUNK_HEADER_SIZE;
+                *link = chunk->next;
+                break;
+            }
+        }
+
+        if (chunk == NULL) {
+            SAIL_TRY(alloc_arena_chunk(&chunk));
+        }
+
+        chunk->next = arena->chunks;
+        arena->chunks = chunk;
+    }
+
+    struct arena_header *header = (struct arena_header *)((unsigned char *)chunk + chunk->used);
+    header->chunk = chunk;
+    header->size  = size;
+
+    chunk->used += required;
+    atomic_add(&chunk->references, 1);
+
+    *ptr = (unsigned char *)header + ARENA_HEADER_SIZE;
+
+    return SAIL_OK;
+}
+
+sail_status_t sail_alloc_arena(struct sail_arena **arena) {
+
+    SAIL_CHECK_PTR(arena);
+
+    void *ptr;
+    SAIL_TRY(sail_malloc(sizeof(struct sail_arena), &ptr));
+    struct sail_arena *arena_local = ptr;
+
+    arena_local->chunks = NULL;
+
+    *arena = arena_local;
+
+    return SAIL_OK;
+}
+
+void sail_destroy_arena(struct sail_arena *arena) {
+
+    if (arena == NULL) {
+        return;
+    }
+
+    for (struct arena_chunk *chunk = arena->chunks; chunk != NULL;) {
+        struct arena_chunk *next = chunk->next;
+        release_arena_chunk(chunk);
+        chunk = next;
+    }
+
+    sail_free(arena);
+}
+
+struct sail_arena* sail_set_current_arena(struct sail_arena *arena) {
+
+    struct sail_arena *previous_arena = current_arena;
+    current_arena = arena;
+
+    return previous_arena;
+}
+
+sail_status_t sail_set_memory_allocator(const struct sail_memory_allocator *allocator) {
+
+    if (allocator == NULL) {
+        memory_allocator = (struct sail_memory_allocator) {
+            .malloc_func  = malloc,
+            .realloc_func = realloc,
+            .calloc_func  = calloc,
+            .free_func    = free,
+        };
+
+        return SAIL_OK;
+    }
+
+    SAIL_CHECK_PTR(allocator->malloc_func);
+    SAIL_CHECK_PTR(allocator->realloc_func);
+    SAIL_CHECK_PTR(allocator->calloc_func);
+    SAIL_CHECK_PTR(allocator->free_func);
+
+    memory_allocator = *allocator;
+
+    return SAIL_OK;
+}
+
 sail_status_t sail_malloc(size_t size, void **ptr) {
 
     SAIL_CHECK_PTR(ptr);
 
-    void *ptr_local = malloc(size);
+    if (current_arena != NULL && size != 0 && size <= SAIL_ARENA_MAX_ALLOCATION_SIZE) {
+        SAIL_TRY(arena_malloc(current_arena, size, ptr));
+        return SAIL_OK;
+    }
+
+    void *ptr_local = memory_allocator.malloc_func(size);
 
     if (ptr_local == NULL) {
         SAIL_LOG_AND_RETURN(SAIL_ERROR_MEMORY_ALLOCATION);
@@ -56,7 +345,31 @@ sail_status_t sail_realloc(size_t size, void **ptr) {
 
     SAIL_CHECK_PTR(ptr);
 
-    void *ptr_local = realloc(*ptr, size);
+    if (*ptr == NULL) {
+        SAIL_TRY(sail_malloc(size, ptr));
+        return SAIL_OK;
+    }
+
+    /* Arena allocations are moved into new allocations when they grow. */
+    struct arena_header *header = find_arena_header(*ptr);
+
+    if (header != NULL) {
+        if (size <= header->size) {
+            return SAIL_OK;
+        }
+
+        void *ptr_local;
+        SAIL_TRY(sail_malloc(size, &ptr_local));
+
+        memcpy(ptr_local, *ptr, header->size);
+        release_arena_chunk(header->chunk);
+
+        *ptr = ptr_local;
+
+        return SAIL_OK;
+    }
+
+    void *ptr_local = memory_allocator.realloc_func(*ptr, size);
 
     if (ptr_local == NULL) {
         SAIL_LOG_AND_RETURN(SAIL_ERROR_MEMORY_ALLOCATION);
@@ -71,7 +384,13 @@ sail_status_t sail_calloc(size_t nmemb, size_t size, void **ptr) {
 
     SAIL_CHECK_PTR(ptr);
 
-    void *ptr_local = calloc(nmemb, size);
+    if (current_arena != NULL && nmemb != 0 && size != 0 && nmemb <= SAIL_ARENA_MAX_ALLOCATION_SIZE / size) {
+        SAIL_TRY(arena_malloc(current_arena, nmemb * size, ptr));
+        memset(*ptr, 0, nmemb * size);
+        return SAIL_OK;
+    }
+
+    void *ptr_local = memory_allocator.calloc_func(nmemb, size);
 
     if (ptr_local == NULL) {
         SAIL_LOG_AND_RETURN(SAIL_ERROR_MEMORY_ALLOCATION);
@@ -84,5 +403,12 @@ sail_status_t sail_calloc(size_t nmemb, size_t size, void **ptr) {
 
 void sail_free(void *ptr) {
 
-    free(ptr);
+    struct arena_header *header = find_arena_header(ptr);
+
+    if (header != NULL) {
+        release_arena_chunk(header->chunk);
+        return;
+    }
+
+    memory_allocator.free_func(ptr);
 }
@@ -35,6 +35,71 @@
 extern "C" {
 #endif
 
+/*
+ * Memory allocator used by sail_malloc(), sail_realloc(), sail_calloc(), and sail_free().
+ * The functions must follow the semantics of their standard counterparts.
+ */
+struct sail_memory_allocator {
+
+    void* (*malloc_func)(size_t size);
+    void* (*realloc_func)(void *ptr, size_t size);
+    void* (*calloc_func)(size_t nmemb, size_t size);
+    void (*free_func)(void *ptr);
+};
+
+typedef struct sail_memory_allocator sail_memory_allocator_t;
+
+/*
+ * Replaces the allocator used by SAIL, for example with a pooling allocator or an arena.
+ * Pass NULL to restore the standard allocator. The allocator gets copied.
+ *
+ * Call this function before any other SAIL function, and never while memory allocated
+ * with the previous allocator is alive. The function is not thread-safe.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_set_memory_allocator(const struct sail_memory_allocator *allocator);
+
+/*
+ * Arena of small allocations. While an arena is current in a thread, sail_malloc(), sail_calloc(),
+ * and sail_realloc() called in that thread serve allocations of up to SAIL_ARENA_MAX_ALLOCATION_SIZE
+ * bytes from large chunks of the arena, so the allocator is called once per chunk.
+ *
+ * Arena allocations are freed with sail_free() as usual, in any thread, and stay valid after
+ * the arena is destroyed. A chunk is returned to the allocator when the arena is destroyed
+ * and all the allocations in the chunk are freed. Chunks with no allocations left are reused
+ * by the arena.
+ *
+ * Loading and saving operations use their own arenas with SAIL_OPTION_ARENA.
+ */
+struct sail_arena;
+
+#define SAIL_ARENA_MAX_ALLOCATION_SIZE 1024
+
+/*
+ * Allocates a new arena. The assigned arena must be destroyed later with sail_destroy_arena().
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_alloc_arena(struct sail_arena **arena);
+
+/*
+ * Destroys the specified arena. Chunks with live allocations are returned to the allocator
+ * when their last allocation is freed. Does nothing if the arena is NULL.
+ *
+ * Nothing must be allocated from the arena after it's destroyed, so make another arena
+ * or NULL current in the thread before allocating again.
+ */
+SAIL_EXPORT void sail_destroy_arena(struct sail_arena *arena);
+
+/*
+ * Makes the arena current in the calling thread. Pass NULL to allocate from the allocator
+ * directly. An arena must be current in one thread at a time.
+ *
+ * Returns the previously current arena or NULL.
+ */
+SAIL_EXPORT struct sail_arena* sail_set_current_arena(struct sail_arena *arena);
+
 /*
  * Interface to malloc().
  *
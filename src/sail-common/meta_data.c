@@ -23,6 +23,8 @@
     SOFTWARE.
 */
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -129,3 +131,101 @@ sail_status_t sail_copy_meta_data(const struct sail_meta_data *source, struct sa
 
     return SAIL_OK;
 }
+
+/*
+ * Returns a pointer to the orientation tag value in the EXIF data or NULL if the tag is not found.
+ */
+static uint8_t* exif_orientation_value(const uint8_t *exif, size_t exif_size, bool *big_endian) {
+
+    static const uint8_t EXIF_HEADER[] = { 'E', 'x', 'i', 'f', 0, 0 };
+
+    if (exif_size >= sizeof(EXIF_HEADER) && memcmp(exif, EXIF_HEADER, sizeof(EXIF_HEADER)) == 0) {
+        exif += sizeof(EXIF_HEADER);
+        exif_size -= sizeof(EXIF_HEADER);
+    }
+
+    if (exif_size < 8) {
+        return NULL;
+    }
+
+    if (exif[0] == 'M' && exif[1] == 'M') {
+        *big_endian = true;
+    } else if (exif[0] == 'I' && exif[1] == 'I') {
+        *big_endian = false;
+    } else {
+        return NULL;
+    }
+
+    #define EXIF_U16(p) (uint16_t)(*big_endian ? ((p)[0] << 8) | (p)[1] : ((p)[1] << 8) | (p)[0])
+    #define EXIF_U32(p) (uint32_t)(*big_endian ? ((uint32_t)(p)[0] << 24) | ((uint32_t)(p)[1] << 16) | ((uint32_t)(p)[2] << 8) | (p)[3] \
+                                               : ((uint32_t)(p)[3] << 24) | ((uint32_t)(p)[2] << 16) | ((uint32_t)(p)[1] << 8) | (p)[0])
+
+    const uint32_t ifd_offset = EXIF_U32(exif + 4);
+
+    if (ifd_offset > exif_size - 2) {
+        return NULL;
+    }
+
+    const unsigned entries = EXIF_U16(exif + ifd_offset);
+
+    if (entries > (exif_size - ifd_offset - 2) / 12) {
+        return NULL;
+    }
+
+    for (unsigned i = 0; i < entries; i++) {
+        const uint8_t *entry = exif + ifd_offset + 2 + i * 12;
+
+        /* Orientation, SHORT. */
+        if (EXIF_U16(entry) == 0x0112 && EXIF_U16(entry + 2) == 3) {
+            return (uint8_t *)entry + 8;
+        }
+    }
+
+    #undef EXIF_U32
+    #undef EXIF_U16
+
+    return NULL;
+}
+
+sail_status_t sail_exif_orientation(const void *exif, size_t exif_size, enum SailOrientation *orientation) {
+
+    SAIL_CHECK_PTR(exif);
+    SAIL_CHECK_PTR(orientation);
+
+    bool big_endian;
+    const uint8_t *value = exif_orientation_value(exif, exif_size, &big_endian);
+
+    if (value == NULL) {
+        *orientation = SAIL_ORIENTATION_NORMAL;
+        return SAIL_OK;
+    }
+
+    switch (big_endian ? value[1] : value[0]) {
+        case 2:  *orientation = SAIL_ORIENTATION_MIRRORED_HORIZONTALLY;            break;
+        case 3:  *orientation = SAIL_ORIENTATION_ROTATED_180;                      break;
+        case 4:  *orientation = SAIL_ORIENTATION_MIRRORED_VERTICALLY;              break;
+        case 5:  *orientation = SAIL_ORIENTATION_MIRRORED_HORIZONTALLY_ROTATED_270; break;
+        case 6:  *orientation = SAIL_ORIENTATION_ROTATED_90;                       break;
+        case 7:  *orientation = SAIL_ORIENTATION_MIRRORED_HORIZONTALLY_ROTATED_90;  break;
+        case 8:  *orientation = SAIL_ORIENTATION_ROTATED_270;                      break;
+
+        default: *orientation = SAIL_ORIENTATION_NORMAL;                           break;
+    }
+
+    return SAIL_OK;
+}
+
+sail_status_t sail_reset_exif_orientation(void *exif, size_t exif_size) {
+
+    SAIL_CHECK_PTR(exif);
+
+    bool big_endian;
+    uint8_t *value = exif_orientation_value(exif, exif_size, &big_endian);
+
+    if (value != NULL) {
+        value[0] = big_endian ? 0 : 1;
+        value[1] = big_endian ? 1 : 0;
+    }
+
+    return SAIL_OK;
+}
@@ -144,6 +144,24 @@ SAIL_EXPORT void sail_destroy_meta_data(struct sail_meta_data *meta_data);
 SAIL_EXPORT sail_status_t sail_copy_meta_data(const struct sail_meta_data *source,
                                               struct sail_meta_data **target);
 
+/*
+ * Parses the orientation tag from the raw EXIF data stored in SAIL_META_DATA_EXIF.
+ * The data may start with the "Exif\0\0" header or directly with the TIFF header.
+ * The returned orientation is the transformation needed to display the image upright.
+ * Sets the orientation to SAIL_ORIENTATION_NORMAL if the orientation tag is missing.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_exif_orientation(const void *exif, size_t exif_size, enum SailOrientation *orientation);
+
+/*
+ * Sets the orientation tag in the raw EXIF data to "normal" if the tag exists. Used when
+ * the pixels are already transformed according to the orientation.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_reset_exif_orientation(void *exif, size_t exif_size);
+
 /* extern "C" */
 #ifdef __cplusplus
 }
@@ -84,6 +84,7 @@ enum SailStatus {
     SAIL_ERROR_MISSING_PALETTE,
     SAIL_ERROR_UNSUPPORTED_FORMAT,
     SAIL_ERROR_BROKEN_IMAGE,
+    SAIL_ERROR_MISSING_ICCP,
 
     /*
      * Codecs-specific errors.
@@ -103,6 +104,7 @@ enum SailStatus {
     SAIL_ERROR_CONTEXT_UNINITIALIZED,
     SAIL_ERROR_GET_DLL_PATH,
     SAIL_ERROR_CONFLICTING_OPERATION,
+    SAIL_ERROR_CANCELLED,
 };
 
 typedef enum SailStatus sail_status_t;
@@ -336,6 +336,20 @@ unsigned sail_bits_per_pixel(enum SailPixelFormat pixel_format) {
         case SAIL_PIXEL_FORMAT_BPP40_YUVA: return 40;
         case SAIL_PIXEL_FORMAT_BPP48_YUVA: return 48;
         case SAIL_PIXEL_FORMAT_BPP64_YUVA: return 64;
+
+        case SAIL_PIXEL_FORMAT_BPP12_YUV420P: return 12;
+        case SAIL_PIXEL_FORMAT_BPP16_YUV422P: return 16;
+        case SAIL_PIXEL_FORMAT_BPP12_NV12:    return 12;
+
+        case SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED: return 32;
+        case SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED: return 32;
+        case SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED: return 32;
+        case SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED: return 32;
+
+        case SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED: return 64;
+        case SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED: return 64;
+        case SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED: return 64;
+        case SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED: return 64;
     }
 
     return 0;
@@ -411,6 +425,11 @@ bool sail_greater_bits_per_pixel(enum SailPixelFormat pixel_format1, enum SailPi
 
 unsigned sail_bytes_per_line(unsigned width, enum SailPixelFormat pixel_format) {
 
+    /* The stride of the full-resolution 8-bit Y plane. */
+    if (sail_is_planar(pixel_format)) {
+        return width;
+    }
+
     const unsigned bits_per_pixel = sail_bits_per_pixel(pixel_format);
     return (unsigned)(((double)width * bits_per_pixel + 7) / 8);
 }
@@ -451,6 +470,20 @@ bool sail_is_grayscale(enum SailPixelFormat pixel_format) {
     }
 }
 
+bool sail_is_planar(enum SailPixelFormat pixel_format) {
+
+    switch (pixel_format) {
+        case SAIL_PIXEL_FORMAT_BPP12_YUV420P:
+        case SAIL_PIXEL_FORMAT_BPP16_YUV422P:
+        case SAIL_PIXEL_FORMAT_BPP12_NV12: {
+            return true;
+        }
+        default: {
+            return false;
+        }
+    }
+}
+
 bool sail_is_rgb_family(enum SailPixelFormat pixel_format) {
 
     switch (pixel_format) {
@@ -481,7 +514,35 @@ bool sail_is_rgb_family(enum SailPixelFormat pixel_format) {
         case SAIL_PIXEL_FORMAT_BPP64_RGBA:
         case SAIL_PIXEL_FORMAT_BPP64_BGRA:
         case SAIL_PIXEL_FORMAT_BPP64_ARGB:
-        case SAIL_PIXEL_FORMAT_BPP64_ABGR: {
+        case SAIL_PIXEL_FORMAT_BPP64_ABGR:
+
+        case SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED: {
+            return true;
+        }
+        default: {
+            return false;
+        }
+    }
+}
+
+bool sail_is_premultiplied(enum SailPixelFormat pixel_format) {
+
+    switch (pixel_format) {
+        case SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED: {
             return true;
         }
         default: {
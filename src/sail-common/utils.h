@@ -135,6 +135,8 @@ SAIL_EXPORT bool sail_greater_bits_per_pixel(enum SailPixelFormat pixel_format1,
  *     (12 + 7 ) / 8                                 ==
  *     19 / 8                                        ==
  *     2 bytes per line
+ *
+ * For planar pixel formats, returns the number of bytes per line of the Y plane.
  */
 SAIL_EXPORT unsigned sail_bytes_per_line(unsigned width, enum SailPixelFormat pixel_format);
 
@@ -148,11 +150,23 @@ SAIL_EXPORT bool sail_is_indexed(enum SailPixelFormat pixel_format);
  */
 SAIL_EXPORT bool sail_is_grayscale(enum SailPixelFormat pixel_format);
 
+/*
+ * Returns true if the given pixel format is planar YUV. The pixel data of such images
+ * consists of several planes. See sail_image_planes().
+ */
+SAIL_EXPORT bool sail_is_planar(enum SailPixelFormat pixel_format);
+
 /*
  * Returns true if the given pixel format is a kind of RGB, packed or not. E.g. RGBA, BGRA, RGB555 etc.
  */
 SAIL_EXPORT bool sail_is_rgb_family(enum SailPixelFormat pixel_format);
 
+/*
+ * Returns true if the color components of the given pixel format are premultiplied by alpha.
+ * E.g. BPP32-RGBA-PREMULTIPLIED.
+ */
+SAIL_EXPORT bool sail_is_premultiplied(enum SailPixelFormat pixel_format);
+
 /*
  * Prints the recent errno value with SAIL_LOG_ERROR(). The specified format must include '%s'.
  */
@@ -0,0 +1,864 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <sail-manip/sail-manip.h>
+
+/*
+ * Linear light is represented in 1.15 fixed point, so 1.0 is 32768.
+ */
+#define LINEAR_ONE 32768
+
+/* Matrix coefficients are in 2.14 fixed point. */
+#define MATRIX_SHIFT 14
+
+/* Number of 16-bit linearization LUT intervals. */
+#define LUT16_SIZE 4096
+
+/* Number of grid points per channel in compiled 3D LUTs. */
+#define CLUT_POINTS 33
+
+/* Number of transforms cached per thread. */
+#define CACHE_SIZE 4
+
+/* D50 white point the ICC profile connection space is defined in. */
+static const double D50_X = 0.9642;
+static const double D50_Y = 1.0;
+static const double D50_Z = 0.8249;
+
+/* RGB to XYZ D50 matrices of the built-in target profiles. */
+static const double SRGB_TO_XYZ_D50[9] = {
+    0.436065674, 0.385147095, 0.143066406,
+    0.222488403, 0.716873169, 0.060607910,
+    0.013916016, 0.097076416, 0.714096069,
+};
+
+static const double DISPLAY_P3_TO_XYZ_D50[9] = {
+     0.515102,    0.291965,  0.157153,
+     0.241182,    0.692236,  0.0665819,
+    -0.00104941,  0.0418818, 0.784378,
+};
+
+struct color_transform {
+    /* True if the transform is a compiled 3D LUT. False if it's a matrix/TRC transform. */
+    bool has_clut;
+
+    /* Matrix/TRC transform. */
+    uint16_t input_lut8[3][256];
+    uint16_t input_lut16[3][LUT16_SIZE + 1];
+    int32_t matrix[9];
+
+    /* Linear light to the target profile encoding. Points to the per-thread shared LUT. */
+    const uint16_t *output_lut;
+
+    /* 3D LUT transform. CLUT_POINTS^3 RGB triplets. */
+    uint16_t *clut;
+};
+
+struct cache_entry {
+    uint64_t hash;
+    size_t size;
+    enum SailColorProfile profile;
+    struct color_transform *transform;
+};
+
+static SAIL_THREAD_LOCAL struct cache_entry cache[CACHE_SIZE];
+static SAIL_THREAD_LOCAL unsigned cache_next_index = 0;
+
+/*
+ * Both target profiles use the sRGB transfer curve, so all the transforms of a thread
+ * share one linear-to-encoded LUT. It's built with the first transform.
+ */
+static SAIL_THREAD_LOCAL uint16_t *shared_output_lut = NULL;
+
+/*
+ * ICC profile parsing. All the numbers are big-endian.
+ */
+
+struct icc_curve {
+    /* Number of table entries. 0 for parametric curves. */
+    unsigned table_size;
+    /* Bytes per table entry, 1 or 2. */
+    unsigned table_entry_size;
+    const uint8_t *table;
+
+    /* Parametric curve. */
+    int function;
+    double params[7];
+};
+
+struct icc_lut {
+    unsigned input_channels;
+    unsigned grid_points;
+    bool pcs_lab;
+
+    struct icc_curve input_curves[3];
+    const uint8_t *clut;
+    unsigned clut_entry_size;
+    struct icc_curve output_curves[3];
+};
+
+static uint16_t read_u16(const uint8_t *data) {
+
+    return (uint16_t)((data[0] << 8) | data[1]);
+}
+
+static uint32_t read_u32(const uint8_t *data) {
+
+    return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | data[3];
+}
+
+static double read_s15fixed16(const uint8_t *data) {
+
+    return (int32_t)read_u32(data) / 65536.0;
+}
+
+static uint32_t signature(const char str[4]) {
+
+    return read_u32((const uint8_t *)str);
+}
+
+static bool find_tag(const uint8_t *data, size_t size, const char tag_signature[4], const uint8_t **tag, size_t *tag_size) {
+
+    if (size < 132) {
+        return false;
+    }
+
+    const uint32_t tag_count = read_u32(data + 128);
+
+    if (tag_count > (size - 132) / 12) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < tag_count; i++) {
+        const uint8_t *entry = data + 132 + i * 12;
+
+        if (read_u32(entry) == signature(tag_signature)) {
+            const uint32_t offset = read_u32(entry + 4);
+            const uint32_t length = read_u32(entry + 8);
+
+            if (offset > size || length > size - offset || length < 8) {
+                return false;
+            }
+
+            *tag = data + offset;
+            *tag_size = length;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool parse_xyz(const uint8_t *tag, size_t tag_size, double xyz[3]) {
+
+    if (tag_size < 20 || read_u32(tag) != signature("XYZ ")) {
+        return false;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        xyz[i] = read_s15fixed16(tag + 8 + i * 4);
+    }
+
+    return true;
+}
+
+static bool parse_curve(const uint8_t *tag, size_t tag_size, struct icc_curve *curve) {
+
+    memset(curve, 0, sizeof(*curve));
+
+    if (read_u32(tag) == signature("curv")) {
+        if (tag_size < 12) {
+            return false;
+        }
+
+        const uint32_t count = read_u32(tag + 8);
+
+        if (count > (tag_size - 12) / 2) {
+            return false;
+        }
+
+        if (count == 0) {
+            curve->params[0] = 1;
+        } else if (count == 1) {
+            curve->params[0] = read_u16(tag + 12) / 256.0;
+        } else {
+            curve->table_size = count;
+            curve->table_entry_size = 2;
+            curve->table = tag + 12;
+        }
+
+        return true;
+    } else if (read_u32(tag) == signature("para")) {
+        static const unsigned PARAMS_COUNT[] = { 1, 3, 4, 5, 7 };
+
+        if (tag_size < 12) {
+            return false;
+        }
+
+        curve->function = read_u16(tag + 8);
+
+        if (curve->function > 4 || tag_size < 12 + PARAMS_COUNT[curve->function] * 4) {
+            return false;
+        }
+
+        for (unsigned i = 0; i < PARAMS_COUNT[curve->function]; i++) {
+            curve->params[i] = read_s15fixed16(tag + 12 + i * 4);
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+static double clamp01(double x) {
+
+    return x < 0 ? 0 : (x > 1 ? 1 : x);
+}
+
+static double eval_table(const uint8_t *table, unsigned table_size, unsigned table_entry_size, double x) {
+
+    const double max = table_entry_size == 2 ? 65535.0 : 255.0;
+    const double position = clamp01(x) * (table_size - 1);
+    const unsigned index = (unsigned)position;
+
+    if (index >= table_size - 1) {
+        return (table_entry_size == 2 ? read_u16(table + (table_size - 1) * 2) : table[table_size - 1]) / max;
+    }
+
+    const double fraction = position - index;
+    const double v0 = table_entry_size == 2 ? read_u16(table + index * 2)       : table[index];
+    const double v1 = table_entry_size == 2 ? read_u16(table + (index + 1) * 2) : table[index + 1];
+
+    return (v0 + (v1 - v0) * fraction) / max;
+}
+
+static double eval_curve(const struct icc_curve *curve, double x) {
+
+    if (curve->table_size > 0) {
+        return eval_table(curve->table, curve->table_size, curve->table_entry_size, x);
+    }
+
+    const double g = curve->params[0];
+    const double a = curve->params[1];
+    const double b = curve->params[2];
+    const double c = curve->params[3];
+    const double d = curve->params[4];
+    const double e = curve->params[5];
+    const double f = curve->params[6];
+
+    x = clamp01(x);
+
+    switch (curve->function) {
+        case 0: return pow(x, g);
+        case 1: return (a != 0 && x >= -b / a) ? pow(a * x + b, g)     : 0;
+        case 2: return (a != 0 && x >= -b / a) ? pow(a * x + b, g) + c : c;
+        case 3: return x >= d ? pow(a * x + b, g)     : c * x;
+        case 4: return x >= d ? pow(a * x + b, g) + e : c * x + f;
+
+        default: {
+            return x;
+        }
+    }
+}
+
+/* Parses lut8Type (mft1) and lut16Type (mft2) A2B0 tags with 3 input and 3 output channels. */
+static bool parse_lut(const uint8_t *tag, size_t tag_size, struct icc_lut *lut) {
+
+    const uint32_t type = read_u32(tag);
+    const bool lut16 = type == signature("mft2");
+
+    if ((!lut16 && type != signature("mft1")) || tag_size < 48) {
+        return false;
+    }
+
+    const unsigned input_channels  = tag[8];
+    const unsigned output_channels = tag[9];
+    const unsigned grid_points     = tag[10];
+
+    if (input_channels != 3 || output_channels != 3 || grid_points < 2) {
+        return false;
+    }
+
+    const unsigned entry_size     = lut16 ? 2 : 1;
+    const unsigned input_entries  = lut16 ? read_u16(tag + 48) : 256;
+    const unsigned output_entries = lut16 ? read_u16(tag + 50) : 256;
+    const size_t tables_offset    = lut16 ? 52 : 48;
+
+    if (input_entries < 2 || output_entries < 2) {
+        return false;
+    }
+
+    const size_t clut_entries = (size_t)grid_points * grid_points * grid_points * output_channels;
+    const size_t required_size = tables_offset
+                                    + ((size_t)input_channels * input_entries + clut_entries + (size_t)output_channels * output_entries) * entry_size;
+
+    if (tag_size < required_size) {
+        return false;
+    }
+
+    lut->input_channels  = input_channels;
+    lut->grid_points     = grid_points;
+    lut->clut_entry_size = entry_size;
+
+    const uint8_t *ptr = tag + tables_offset;
+
+    for (unsigned i = 0; i < 3; i++) {
+        lut->input_curves[i] = (struct icc_curve) { input_entries, entry_size, ptr, 0, { 0 } };
+        ptr += input_entries * entry_size;
+    }
+
+    lut->clut = ptr;
+    ptr += clut_entries * entry_size;
+
+    for (unsigned i = 0; i < 3; i++) {
+        lut->output_curves[i] = (struct icc_curve) { output_entries, entry_size, ptr, 0, { 0 } };
+        ptr += output_entries * entry_size;
+    }
+
+    return true;
+}
+
+/*
+ * Math.
+ */
+
+static void multiply_matrix_vector(const double m[9], const double v[3], double result[3]) {
+
+    for (int i = 0; i < 3; i++) {
+        result[i] = m[i * 3 + 0] * v[0] + m[i * 3 + 1] * v[1] + m[i * 3 + 2] * v[2];
+    }
+}
+
+static void multiply_matrices(const double a[9], const double b[9], double result[9]) {
+
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            result[i * 3 + j] = a[i * 3 + 0] * b[0 * 3 + j] + a[i * 3 + 1] * b[1 * 3 + j] + a[i * 3 + 2] * b[2 * 3 + j];
+        }
+    }
+}
+
+static bool invert_matrix(const double m[9], double result[9]) {
+
+    const double det = m[0] * (m[4] * m[8] - m[5] * m[7])
+                        - m[1] * (m[3] * m[8] - m[5] * m[6])
+                        + m[2] * (m[3] * m[7] - m[4] * m[6]);
+
+    if (fabs(det) < 1e-12) {
+        return false;
+    }
+
+    result[0] =  (m[4] * m[8] - m[5] * m[7]) / det;
+    result[1] = -(m[1] * m[8] - m[2] * m[7]) / det;
+    result[2] =  (m[1] * m[5] - m[2] * m[4]) / det;
+    result[3] = -(m[3] * m[8] - m[5] * m[6]) / det;
+    result[4] =  (m[0] * m[8] - m[2] * m[6]) / det;
+    result[5] = -(m[0] * m[5] - m[2] * m[3]) / det;
+    result[6] =  (m[3] * m[7] - m[4] * m[6]) / det;
+    result[7] = -(m[0] * m[7] - m[1] * m[6]) / det;
+    result[8] =  (m[0] * m[4] - m[1] * m[3]) / det;
+
+    return true;
+}
+
+/* sRGB transfer function. Display P3 shares it. */
+static double encode_srgb(double linear) {
+
+    linear = clamp01(linear);
+
+    return linear <= 0.0031308 ? linear * 12.92 : 1.055 * pow(linear, 1 / 2.4) - 0.055;
+}
+
+static double lab_f_inverse(double t) {
+
+    return t > 6.0 / 29 ? t * t * t : 3 * (6.0 / 29) * (6.0 / 29) * (t - 4.0 / 29);
+}
+
+static void lab_to_xyz(const double lab[3], double xyz[3]) {
+
+    const double fy = (lab[0] + 16) / 116;
+    const double fx = fy + lab[1] / 500;
+    const double fz = fy - lab[2] / 200;
+
+    xyz[0] = D50_X * lab_f_inverse(fx);
+    xyz[1] = D50_Y * lab_f_inverse(fy);
+    xyz[2] = D50_Z * lab_f_inverse(fz);
+}
+
+/* Tetrahedral interpolation in a 3D grid with 3 output channels. The input is in [0, 1]. */
+static void tetrahedral_double(const uint8_t *clut, unsigned entry_size, unsigned grid_points, const double input[3], double output[3]) {
+
+    const double max = entry_size == 2 ? 65535.0 : 255.0;
+    unsigned index[3];
+    double fraction[3];
+
+    for (int i = 0; i < 3; i++) {
+        const double position = clamp01(input[i]) * (grid_points - 1);
+
+        index[i] = (unsigned)position;
+
+        if (index[i] >= grid_points - 1) {
+            index[i] = grid_points - 2;
+        }
+
+        fraction[i] = position - index[i];
+    }
+
+    const size_t stride_r = (size_t)grid_points * grid_points * 3;
+    const size_t stride_g = (size_t)grid_points * 3;
+    const size_t stride_b = 3;
+    const size_t base = index[0] * stride_r + index[1] * stride_g + index[2] * stride_b;
+
+    const double fr = fraction[0], fg = fraction[1], fb = fraction[2];
+
+    for (int channel = 0; channel < 3; channel++) {
+        #define CLUT(offset) ((entry_size == 2 ? read_u16(clut + (base + (offset) + channel) * 2) : clut[base + (offset) + channel]) / max)
+
+        const double c000 = CLUT(0);
+        const double c111 = CLUT(stride_r + stride_g + stride_b);
+        double value;
+
+        if (fr >= fg) {
+            if (fg >= fb) {
+                value = c000 + (CLUT(stride_r) - c000) * fr + (CLUT(stride_r + stride_g) - CLUT(stride_r)) * fg + (c111 - CLUT(stride_r + stride_g)) * fb;
+            } else if (fr >= fb) {
+                value = c000 + (CLUT(stride_r) - c000) * fr + (CLUT(stride_r + stride_b) - CLUT(stride_r)) * fb + (c111 - CLUT(stride_r + stride_b)) * fg;
+            } else {
+                value = c000 + (CLUT(stride_b) - c000) * fb + (CLUT(stride_r + stride_b) - CLUT(stride_b)) * fr + (c111 - CLUT(stride_r + stride_b)) * fg;
+            }
+        } else {
+            if (fb >= fg) {
+                value = c000 + (CLUT(stride_b) - c000) * fb + (CLUT(stride_g + stride_b) - CLUT(stride_b)) * fg + (c111 - CLUT(stride_g + stride_b)) * fr;
+            } else if (fb >= fr) {
+                value = c000 + (CLUT(stride_g) - c000) * fg + (CLUT(stride_g + stride_b) - CLUT(stride_g)) * fb + (c111 - CLUT(stride_g + stride_b)) * fr;
+            } else {
+                value = c000 + (CLUT(stride_g) - c000) * fg + (CLUT(stride_r + stride_g) - CLUT(stride_g)) * fr + (c111 - CLUT(stride_r + stride_g)) * fb;
+            }
+        }
+
+        #undef CLUT
+
+        output[channel] = value;
+    }
+}
+
+/* Same as above, but for the compiled 16-bit LUT and integer inputs in [0, max]. */
+static void tetrahedral_int(const uint16_t *clut, uint32_t r, uint32_t g, uint32_t b, uint32_t max, uint16_t output[3]) {
+
+    uint32_t index[3];
+    uint32_t fraction[3];
+    const uint32_t input[3] = { r, g, b };
+
+    for (int i = 0; i < 3; i++) {
+        const uint32_t position = input[i] * (CLUT_POINTS - 1);
+
+        index[i] = position / max;
+        fraction[i] = position - index[i] * max;
+
+        if (index[i] == CLUT_POINTS - 1) {
+            index[i] = CLUT_POINTS - 2;
+            fraction[i] = max;
+        }
+    }
+
+    const size_t stride_r = CLUT_POINTS * CLUT_POINTS * 3;
+    const size_t stride_g = CLUT_POINTS * 3;
+    const size_t stride_b = 3;
+    const uint16_t *c = clut + index[0] * stride_r + index[1] * stride_g + index[2] * stride_b;
+
+    const int64_t fr = fraction[0], fg = fraction[1], fb = fraction[2];
+
+    for (int channel = 0; channel < 3; channel++) {
+        const int64_t c000 = c[channel];
+        const int64_t c111 = c[stride_r + stride_g + stride_b + channel];
+        int64_t sum;
+
+        if (fr >= fg) {
+            if (fg >= fb) {
+                sum = (c[stride_r + channel] - c000) * fr + (c[stride_r + stride_g + channel] - c[stride_r + channel]) * fg + (c111 - c[stride_r + stride_g + channel]) * fb;
+            } else if (fr >= fb) {
+                sum = (c[stride_r + channel] - c000) * fr + (c[stride_r + stride_b + channel] - c[stride_r + channel]) * fb + (c111 - c[stride_r + stride_b + channel]) * fg;
+            } else {
+                sum = (c[stride_b + channel] - c000) * fb + (c[stride_r + stride_b + channel] - c[stride_b + channel]) * fr + (c111 - c[stride_r + stride_b + channel]) * fg;
+            }
+        } else {
+            if (fb >= fg) {
+                sum = (c[stride_b + channel] - c000) * fb + (c[stride_g + stride_b + channel] - c[stride_b + channel]) * fg + (c111 - c[stride_g + stride_b + channel]) * fr;
+            } else if (fb >= fr) {
+                sum = (c[stride_g + channel] - c000) * fg + (c[stride_g + stride_b + channel] - c[stride_g + channel]) * fb + (c111 - c[stride_g + stride_b + channel]) * fr;
+            } else {
+                sum = (c[stride_g + channel] - c000) * fg + (c[stride_r + stride_g + channel] - c[stride_g + channel]) * fr + (c111 - c[stride_r + stride_g + channel]) * fb;
+            }
+        }
+
+        /* The interpolated value is a convex combination of the grid values, so it's never negative. */
+        output[channel] = (uint16_t)((c000 * max + sum + max / 2) / max);
+    }
+}
+
+/*
+ * Compilation.
+ */
+
+static sail_status_t fetch_output_lut(const uint16_t **output_lut) {
+
+    if (shared_output_lut == NULL) {
+        void *ptr;
+        SAIL_TRY(sail_malloc(sizeof(uint16_t) * (LINEAR_ONE + 1), &ptr));
+        shared_output_lut = ptr;
+
+        for (unsigned i = 0; i <= LINEAR_ONE; i++) {
+            shared_output_lut[i] = (uint16_t)(encode_srgb((double)i / LINEAR_ONE) * 65535 + 0.5);
+        }
+    }
+
+    *output_lut = shared_output_lut;
+
+    return SAIL_OK;
+}
+
+static uint16_t to_linear_fixed(double value) {
+
+    return (uint16_t)(clamp01(value) * LINEAR_ONE + 0.5);
+}
+
+static sail_status_t compile_matrix_trc(const double source_to_xyz[9], const struct icc_curve curves[3],
+                                        const double xyz_to_target[9], struct color_transform *transform) {
+
+    double matrix[9];
+    multiply_matrices(xyz_to_target, source_to_xyz, matrix);
+
+    for (int i = 0; i < 9; i++) {
+        transform->matrix[i] = (int32_t)lround(matrix[i] * (1 << MATRIX_SHIFT));
+    }
+
+    for (int channel = 0; channel < 3; channel++) {
+        for (unsigned i = 0; i < 256; i++) {
+            transform->input_lut8[channel][i] = to_linear_fixed(eval_curve(&curves[channel], i / 255.0));
+        }
+        for (unsigned i = 0; i <= LUT16_SIZE; i++) {
+            transform->input_lut16[channel][i] = to_linear_fixed(eval_curve(&curves[channel], (double)i / LUT16_SIZE));
+        }
+    }
+
+    transform->has_clut = false;
+
+    return SAIL_OK;
+}
+
+static sail_status_t compile_clut(const struct icc_lut *lut, const double xyz_to_target[9], struct color_transform *transform) {
+
+    void *ptr;
+    SAIL_TRY(sail_malloc(sizeof(uint16_t) * CLUT_POINTS * CLUT_POINTS * CLUT_POINTS * 3, &ptr));
+    transform->clut = ptr;
+
+    uint16_t *output = transform->clut;
+
+    for (unsigned r = 0; r < CLUT_POINTS; r++) {
+        for (unsigned g = 0; g < CLUT_POINTS; g++) {
+            for (unsigned b = 0; b < CLUT_POINTS; b++) {
+                const double device[3] = { (double)r / (CLUT_POINTS - 1), (double)g / (CLUT_POINTS - 1), (double)b / (CLUT_POINTS - 1) };
+                double curved[3];
+                double pcs[3];
+
+                for (int i = 0; i < 3; i++) {
+                    curved[i] = eval_curve(&lut->input_curves[i], device[i]);
+                }
+
+                tetrahedral_double(lut->clut, lut->clut_entry_size, lut->grid_points, curved, pcs);
+
+                for (int i = 0; i < 3; i++) {
+                    pcs[i] = eval_curve(&lut->output_curves[i], pcs[i]);
+                }
+
+                double xyz[3];
+
+                if (lut->pcs_lab) {
+                    /* Legacy 16-bit Lab encoding where 0xFF00 is 100 (L) or 127 (a, b). */
+                    const double scale = lut->clut_entry_size == 2 ? 65535.0 / 65280.0 : 1;
+                    const double lab[3] = { pcs[0] * scale * 100, pcs[1] * scale * 255 - 128, pcs[2] * scale * 255 - 128 };
+
+                    lab_to_xyz(lab, xyz);
+                } else {
+                    /* u1Fixed15 XYZ encoding where 0x8000 is 1.0. */
+                    for (int i = 0; i < 3; i++) {
+                        xyz[i] = pcs[i] * 65535.0 / 32768.0;
+                    }
+                }
+
+                double linear[3];
+                multiply_matrix_vector(xyz_to_target, xyz, linear);
+
+                for (int i = 0; i < 3; i++) {
+                    *output++ = (uint16_t)(encode_srgb(linear[i]) * 65535 + 0.5);
+                }
+            }
+        }
+    }
+
+    transform->has_clut = true;
+
+    return SAIL_OK;
+}
+
+static void destroy_color_transform(struct color_transform *transform) {
+
+    if (transform == NULL) {
+        return;
+    }
+
+    sail_free(transform->clut);
+    sail_free(transform);
+}
+
+static sail_status_t compile_color_transform(const struct sail_iccp *iccp, enum SailColorProfile profile, struct color_transform **transform) {
+
+    const uint8_t *data = iccp->data;
+    const size_t size = iccp->size;
+
+    if (size < 132 || read_u32(data + 36) != signature("acsp")) {
+        SAIL_LOG_ERROR("ICC profile is broken");
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_BROKEN_IMAGE);
+    }
+
+    if (read_u32(data + 16) != signature("RGB ")) {
+        SAIL_LOG_ERROR("Only RGB ICC profiles are supported");
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_FORMAT);
+    }
+
+    const double *target_to_xyz;
+
+    switch (profile) {
+        case SAIL_COLOR_PROFILE_SRGB:       target_to_xyz = SRGB_TO_XYZ_D50;       break;
+        case SAIL_COLOR_PROFILE_DISPLAY_P3: target_to_xyz = DISPLAY_P3_TO_XYZ_D50; break;
+
+        default: {
+            SAIL_LOG_ERROR("Unsupported target color profile %d", profile);
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_INVALID_ARGUMENT);
+        }
+    }
+
+    double xyz_to_target[9];
+    invert_matrix(target_to_xyz, xyz_to_target);
+
+    void *ptr;
+    SAIL_TRY(sail_malloc(sizeof(struct color_transform), &ptr));
+    struct color_transform *transform_local = ptr;
+    transform_local->clut = NULL;
+
+    SAIL_TRY_OR_CLEANUP(fetch_output_lut(&transform_local->output_lut),
+                        /* cleanup */ destroy_color_transform(transform_local));
+
+    /* Prefer the matrix/TRC model as it's exact and cheap. Fall back to the A2B0 LUT. */
+    static const char * const XYZ_TAGS[3] = { "rXYZ", "gXYZ", "bXYZ" };
+    static const char * const TRC_TAGS[3] = { "rTRC", "gTRC", "bTRC" };
+
+    double source_to_xyz[9];
+    struct icc_curve curves[3];
+    bool is_matrix_trc = true;
+
+    for (int i = 0; i < 3 && is_matrix_trc; i++) {
+        const uint8_t *tag;
+        size_t tag_size;
+        double xyz[3];
+
+        is_matrix_trc = find_tag(data, size, XYZ_TAGS[i], &tag, &tag_size) && parse_xyz(tag, tag_size, xyz) &&
+                        find_tag(data, size, TRC_TAGS[i], &tag, &tag_size) && parse_curve(tag, tag_size, &curves[i]);
+
+        if (is_matrix_trc) {
+            /* Colorant tags are columns of the matrix. */
+            source_to_xyz[0 * 3 + i] = xyz[0];
+            source_to_xyz[1 * 3 + i] = xyz[1];
+            source_to_xyz[2 * 3 + i] = xyz[2];
+        }
+    }
+
+    if (is_matrix_trc) {
+        SAIL_TRY_OR_CLEANUP(compile_matrix_trc(source_to_xyz, curves, xyz_to_target, transform_local),
+                            /* cleanup */ destroy_color_transform(transform_local));
+    } else {
+        const uint8_t *tag;
+        size_t tag_size;
+        struct icc_lut lut;
+
+        if (!find_tag(data, size, "A2B0", &tag, &tag_size) || !parse_lut(tag, tag_size, &lut)) {
+            destroy_color_transform(transform_local);
+            SAIL_LOG_ERROR("ICC profile has neither matrix/TRC nor supported A2B0 LUT tags");
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_FORMAT);
+        }
+
+        lut.pcs_lab = read_u32(data + 20) == signature("Lab ");
+
+        SAIL_TRY_OR_CLEANUP(compile_clut(&lut, xyz_to_target, transform_local),
+                            /* cleanup */ destroy_color_transform(transform_local));
+    }
+
+    *transform = transform_local;
+
+    return SAIL_OK;
+}
+
+/* FNV-1a. */
+static uint64_t hash_data(const uint8_t *data, size_t size) {
+
+    uint64_t hash = UINT64_C(14695981039346656037);
+
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= UINT64_C(1099511628211);
+    }
+
+    return hash;
+}
+
+/*
+ * Private functions.
+ */
+
+sail_status_t color_transform_from_iccp(const struct sail_iccp *iccp, enum SailColorProfile profile,
+                                        const struct color_transform **transform) {
+
+    SAIL_CHECK_PTR(iccp);
+    SAIL_CHECK_PTR(transform);
+
+    if (iccp->data == NULL) {
+        SAIL_LOG_ERROR("ICC profile has no data");
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_BROKEN_IMAGE);
+    }
+
+    const uint64_t hash = hash_data(iccp->data, iccp->size);
+
+    for (unsigned i = 0; i < CACHE_SIZE; i++) {
+        if (cache[i].transform != NULL && cache[i].hash == hash && cache[i].size == iccp->size && cache[i].profile == profile) {
+            *transform = cache[i].transform;
+            return SAIL_OK;
+        }
+    }
+
+    struct color_transform *transform_local;
+    SAIL_TRY(compile_color_transform(iccp, profile, &transform_local));
+
+    struct cache_entry *entry = &cache[cache_next_index];
+    cache_next_index = (cache_next_index + 1) % CACHE_SIZE;
+
+    destroy_color_transform(entry->transform);
+    *entry = (struct cache_entry) { hash, iccp->size, profile, transform_local };
+
+    *transform = transform_local;
+
+    return SAIL_OK;
+}
+
+static inline uint16_t apply_matrix_row(const struct color_transform *transform, int row, int64_t r, int64_t g, int64_t b) {
+
+    int64_t value = (transform->matrix[row * 3 + 0] * r + transform->matrix[row * 3 + 1] * g + transform->matrix[row * 3 + 2] * b
+                        + (1 << (MATRIX_SHIFT - 1))) >> MATRIX_SHIFT;
+
+    value = value < 0 ? 0 : (value > LINEAR_ONE ? LINEAR_ONE : value);
+
+    return transform->output_lut[value];
+}
+
+static inline uint16_t linearize16(const uint16_t lut[LUT16_SIZE + 1], uint16_t value) {
+
+    /* Position in 1/16 steps of the LUT grid, so that 65535 maps exactly to the last entry. */
+    const uint32_t position = (uint32_t)(((uint64_t)value * LUT16_SIZE * 16 + 65535 / 2) / 65535);
+    const uint32_t index = position >> 4;
+    const uint32_t fraction = position & 15;
+
+    if (index >= LUT16_SIZE) {
+        return lut[LUT16_SIZE];
+    }
+
+    return (uint16_t)((lut[index] * (16 - fraction) + lut[index + 1] * fraction + 8) >> 4);
+}
+
+void color_transform_apply_rgba32(const struct color_transform *transform, const sail_rgba32_t *input, sail_rgba32_t *output) {
+
+    uint16_t rgb[3];
+
+    if (transform->has_clut) {
+        tetrahedral_int(transform->clut, input->component1, input->component2, input->component3, 255, rgb);
+    } else {
+        const int64_t r = transform->input_lut8[0][input->component1];
+        const int64_t g = transform->input_lut8[1][input->component2];
+        const int64_t b = transform->input_lut8[2][input->component3];
+
+        rgb[0] = apply_matrix_row(transform, 0, r, g, b);
+        rgb[1] = apply_matrix_row(transform, 1, r, g, b);
+        rgb[2] = apply_matrix_row(transform, 2, r, g, b);
+    }
+
+    output->component1 = (uint8_t)((rgb[0] * 255U + 32767) / 65535);
+    output->component2 = (uint8_t)((rgb[1] * 255U + 32767) / 65535);
+    output->component3 = (uint8_t)((rgb[2] * 255U + 32767) / 65535);
+    output->component4 = input->component4;
+}
+
+void color_transform_apply_rgba64(const struct color_transform *transform, const sail_rgba64_t *input, sail_rgba64_t *output) {
+
+    uint16_t rgb[3];
+
+    if (transform->has_clut) {
+        tetrahedral_int(transform->clut, input->component1, input->component2, input->component3, 65535, rgb);
+    } else {
+        const int64_t r = linearize16(transform->input_lut16[0], input->component1);
+        const int64_t g = linearize16(transform->input_lut16[1], input->component2);
+        const int64_t b = linearize16(transform->input_lut16[2], input->component3);
+
+        rgb[0] = apply_matrix_row(transform, 0, r, g, b);
+        rgb[1] = apply_matrix_row(transform, 1, r, g, b);
+        rgb[2] = apply_matrix_row(transform, 2, r, g, b);
+    }
+
+    output->component1 = rgb[0];
+    output->component2 = rgb[1];
+    output->component3 = rgb[2];
+    output->component4 = input->component4;
+}
+
+/*
+ * Public functions.
+ */
+
+void sail_clear_color_transform_cache(void) {
+
+    for (unsigned i = 0; i < CACHE_SIZE; i++) {
+        destroy_color_transform(cache[i].transform);
+        cache[i].transform = NULL;
+    }
+
+    cache_next_index = 0;
+
+    sail_free(shared_output_lut);
+    shared_output_lut = NULL;
+}
@@ -0,0 +1,54 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_COLOR_TRANSFORM_H
+#define SAIL_COLOR_TRANSFORM_H
+
+#include <stdint.h>
+
+#include <sail-common/export.h>
+#include <sail-common/pixel.h>
+#include <sail-common/status.h>
+
+#include <sail-manip/manip_common.h>
+
+struct color_transform;
+struct sail_iccp;
+
+/*
+ * Returns a compiled transform from the RGB ICC profile to the target profile. Compiled transforms
+ * are cached per thread by the profile hash. The returned transform is owned by the cache and stays
+ * valid until the next call to this function or to sail_clear_color_transform_cache() in the same thread.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_HIDDEN sail_status_t color_transform_from_iccp(const struct sail_iccp *iccp, enum SailColorProfile profile,
+                                                    const struct color_transform **transform);
+
+SAIL_HIDDEN void color_transform_apply_rgba32(const struct color_transform *transform, const sail_rgba32_t *input, sail_rgba32_t *output);
+
+SAIL_HIDDEN void color_transform_apply_rgba64(const struct color_transform *transform, const sail_rgba64_t *input, sail_rgba64_t *output);
+
+#endif
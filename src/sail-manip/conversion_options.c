@@ -36,6 +36,9 @@ sail_status_t sail_alloc_conversion_options(struct sail_conversion_options **opt
     (*options)->options      = SAIL_CONVERSION_OPTION_DROP_ALPHA;
     (*options)->background48 = (sail_rgb48_t){ 0, 0, 0 };
     (*options)->background24 = (sail_rgb24_t){ 0, 0, 0 };
+    (*options)->quantization = SAIL_QUANTIZATION_ALGORITHM_MEDIAN_CUT;
+    (*options)->dithering    = SAIL_DITHERING_NONE;
+    (*options)->palette      = NULL;
 
     return SAIL_OK;
 }
@@ -46,5 +49,6 @@ void sail_destroy_conversion_options(struct sail_conversion_options *options) {
         return;
     }
 
+    sail_destroy_palette(options->palette);
     sail_free(options);
 }
@@ -36,6 +36,8 @@
 extern "C" {
 #endif
 
+struct sail_palette;
+
 /*
  * Options to control image conversion behavior.
  */
@@ -57,6 +59,28 @@ struct sail_conversion_options {
      * when options has SAIL_CONVERSION_OPTION_BLEND_ALPHA.
      */
     sail_rgb24_t background24;
+
+    /*
+     * Algorithm to build palettes when converting to indexed pixel formats.
+     * Default: SAIL_QUANTIZATION_ALGORITHM_MEDIAN_CUT.
+     */
+    enum SailQuantizationAlgorithm quantization;
+
+    /*
+     * Dithering method to use when converting to indexed pixel formats.
+     * Default: SAIL_DITHERING_NONE.
+     */
+    enum SailDithering dithering;
+
+    /*
+     * Fixed palette to map pixels to when converting to indexed pixel formats. If NULL,
+     * a new palette is built with the quantization algorithm. Its pixel format must be
+     * BPP24-RGB or BPP32-RGBA, and it must not have more colors than the output pixel format
+     * is able to address.
+     *
+     * The palette is owned by the options and destroyed in sail_destroy_conversion_options().
+     */
+    struct sail_palette *palette;
 };
 
 typedef struct sail_conversion_options sail_conversion_options_t;
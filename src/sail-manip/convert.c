@@ -35,6 +35,10 @@
  * Private functions.
  */
 
+struct output_context;
+
+typedef void (*pixel_consumer_t)(const struct output_context *output_context, uint8_t **scan8, uint16_t **scan16, const sail_rgba32_t *rgba32, const sail_rgba64_t *rgba64);
+
 struct output_context {
     struct sail_image *image;
     int r;
@@ -42,9 +46,11 @@ struct output_context {
     int b;
     int a;
     const struct sail_conversion_options *options;
-};
 
-typedef void (*pixel_consumer_t)(const struct output_context *output_context, uint8_t **scan8, uint16_t **scan16, const sail_rgba32_t *rgba32, const sail_rgba64_t *rgba64);
+    /* ICC transform applied before passing pixels to the output pixel consumer. May be NULL. */
+    const struct color_transform *transform;
+    pixel_consumer_t transformed_pixel_consumer;
+};
 
 static inline void pixel_consumer_gray8(const struct output_context *output_context, uint8_t **scan8, uint16_t ** scan16, const sail_rgba32_t *rgba32, const sail_rgba64_t *rgba64) {
 
@@ -124,6 +130,22 @@ static inline void pixel_consumer_rgba64_kind(const struct output_context *outpu
     *scan16 += 4;
 }
 
+static inline void pixel_consumer_rgba32_premultiplied_kind(const struct output_context *output_context, uint8_t **scan8, uint16_t **scan16, const sail_rgba32_t *rgba32, const sail_rgba64_t *rgba64) {
+
+    uint8_t *pixel = *scan8;
+
+    pixel_consumer_rgba32_kind(output_context, scan8, scan16, rgba32, rgba64);
+    premultiply_rgba32_pixel(pixel, output_context->r, output_context->g, output_context->b, output_context->a);
+}
+
+static inline void pixel_consumer_rgba64_premultiplied_kind(const struct output_context *output_context, uint8_t **scan8, uint16_t **scan16, const sail_rgba32_t *rgba32, const sail_rgba64_t *rgba64) {
+
+    uint16_t *pixel = *scan16;
+
+    pixel_consumer_rgba64_kind(output_context, scan8, scan16, rgba32, rgba64);
+    premultiply_rgba64_pixel(pixel, output_context->r, output_context->g, output_context->b, output_context->a);
+}
+
 static inline void pixel_consumer_ycbcr(const struct output_context *output_context, uint8_t **scan8, uint16_t ** scan16, const sail_rgba32_t *rgba32, const sail_rgba64_t *rgba64) {
 
     (void)scan16;
@@ -137,6 +159,19 @@ static inline void pixel_consumer_ycbcr(const struct output_context *output_cont
     *scan8 += 3;
 }
 
+static inline void pixel_consumer_color_transform(const struct output_context *output_context, uint8_t **scan8, uint16_t **scan16, const sail_rgba32_t *rgba32, const sail_rgba64_t *rgba64) {
+
+    if (rgba32 != NULL) {
+        sail_rgba32_t rgba32_transformed;
+        color_transform_apply_rgba32(output_context->transform, rgba32, &rgba32_transformed);
+        output_context->transformed_pixel_consumer(output_context, scan8, scan16, &rgba32_transformed, NULL);
+    } else {
+        sail_rgba64_t rgba64_transformed;
+        color_transform_apply_rgba64(output_context->transform, rgba64, &rgba64_transformed);
+        output_context->transformed_pixel_consumer(output_context, scan8, scan16, NULL, &rgba64_transformed);
+    }
+}
+
 static bool verify_and_construct_rgba_indexes_silent(enum SailPixelFormat output_pixel_format, pixel_consumer_t *pixel_consumer, int *r, int *g, int *b, int *a) {
 
     switch (output_pixel_format) {
@@ -167,6 +202,16 @@ static bool verify_and_construct_rgba_indexes_silent(enum SailPixelFormat output
         case SAIL_PIXEL_FORMAT_BPP64_ARGB: { *pixel_consumer = pixel_consumer_rgba64_kind; *r = 1; *g = 2; *b = 3; *a = 0;  break; }
         case SAIL_PIXEL_FORMAT_BPP64_ABGR: { *pixel_consumer = pixel_consumer_rgba64_kind; *r = 3; *g = 2; *b = 1; *a = 0;  break; }
 
+        case SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED: { *pixel_consumer = pixel_consumer_rgba32_premultiplied_kind; *r = 0; *g = 1; *b = 2; *a = 3; break; }
+        case SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED: { *pixel_consumer = pixel_consumer_rgba32_premultiplied_kind; *r = 2; *g = 1; *b = 0; *a = 3; break; }
+        case SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED: { *pixel_consumer = pixel_consumer_rgba32_premultiplied_kind; *r = 1; *g = 2; *b = 3; *a = 0; break; }
+        case SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED: { *pixel_consumer = pixel_consumer_rgba32_premultiplied_kind; *r = 3; *g = 2; *b = 1; *a = 0; break; }
+
+        case SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED: { *pixel_consumer = pixel_consumer_rgba64_premultiplied_kind; *r = 0; *g = 1; *b = 2; *a = 3; break; }
+        case SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED: { *pixel_consumer = pixel_consumer_rgba64_premultiplied_kind; *r = 2; *g = 1; *b = 0; *a = 3; break; }
+        case SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED: { *pixel_consumer = pixel_consumer_rgba64_premultiplied_kind; *r = 1; *g = 2; *b = 3; *a = 0; break; }
+        case SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED: { *pixel_consumer = pixel_consumer_rgba64_premultiplied_kind; *r = 3; *g = 2; *b = 1; *a = 0; break; }
+
         case SAIL_PIXEL_FORMAT_BPP24_YCBCR: { *pixel_consumer = pixel_consumer_ycbcr; *r = *g = *b = *a = -1; /* unused. */ break; }
 
         default: {
@@ -514,6 +559,23 @@ static sail_status_t convert_from_bpp32_rgba_kind(const struct sail_image *image
 
     unsigned row;
 
+    /* Fast path: blend whole scan lines into RGB-like pixels. */
+    if (ai >= 0 && output_context->a < 0 &&
+            output_context->options != NULL && (output_context->options->options & SAIL_CONVERSION_OPTION_BLEND_ALPHA) &&
+            (pixel_consumer == pixel_consumer_rgb24_kind || pixel_consumer == pixel_consumer_rgba32_kind)) {
+        const int output_pixel_size = (pixel_consumer == pixel_consumer_rgb24_kind) ? 3 : 4;
+
+        #pragma omp parallel for schedule(SAIL_OPENMP_SCHEDULE)
+        for (row = 0; row < image->height; row++) {
+            fill_rgb24_scan_from_rgba32_scan(sail_scan_line(image, row), ri, gi, bi, ai,
+                                                sail_scan_line(output_context->image, row),
+                                                output_context->r, output_context->g, output_context->b, output_pixel_size,
+                                                image->width, &output_context->options->background24);
+        }
+
+        return SAIL_OK;
+    }
+
     #pragma omp parallel for schedule(SAIL_OPENMP_SCHEDULE)
     for (row = 0; row < image->height; row++) {
         const uint8_t  *scan_input    = sail_scan_line(image, row);
@@ -552,6 +614,50 @@ static sail_status_t convert_from_bpp64_rgba_kind(const struct sail_image *image
     return SAIL_OK;
 }
 
+static sail_status_t convert_from_bpp32_premultiplied_rgba_kind(const struct sail_image *image, int ri, int gi, int bi, int ai, pixel_consumer_t pixel_consumer, const struct output_context *output_context) {
+
+    unsigned row;
+
+    #pragma omp parallel for schedule(SAIL_OPENMP_SCHEDULE)
+    for (row = 0; row < image->height; row++) {
+        const uint8_t  *scan_input    = sail_scan_line(image, row);
+              uint8_t  *scan_output8  = sail_scan_line(output_context->image, row);
+              uint16_t *scan_output16 = sail_scan_line(output_context->image, row);
+
+        for (unsigned column = 0; column < image->width; column++) {
+            sail_rgba32_t rgba32 = { *(scan_input+ri), *(scan_input+gi), *(scan_input+bi), *(scan_input+ai) };
+            unpremultiply_rgba32_values(&rgba32);
+
+            pixel_consumer(output_context, &scan_output8, &scan_output16, &rgba32, NULL);
+            scan_input += 4;
+        }
+    }
+
+    return SAIL_OK;
+}
+
+static sail_status_t convert_from_bpp64_premultiplied_rgba_kind(const struct sail_image *image, int ri, int gi, int bi, int ai, pixel_consumer_t pixel_consumer, const struct output_context *output_context) {
+
+    unsigned row;
+
+    #pragma omp parallel for schedule(SAIL_OPENMP_SCHEDULE)
+    for (row = 0; row < image->height; row++) {
+        const uint16_t *scan_input    = sail_scan_line(image, row);
+              uint8_t  *scan_output8  = sail_scan_line(output_context->image, row);
+              uint16_t *scan_output16 = sail_scan_line(output_context->image, row);
+
+        for (unsigned column = 0; column < image->width; column++) {
+            sail_rgba64_t rgba64 = { *(scan_input+ri), *(scan_input+gi), *(scan_input+bi), *(scan_input+ai) };
+            unpremultiply_rgba64_values(&rgba64);
+
+            pixel_consumer(output_context, &scan_output8, &scan_output16, NULL, &rgba64);
+            scan_input += 4;
+        }
+    }
+
+    return SAIL_OK;
+}
+
 static sail_status_t convert_from_bpp32_cmyk(const struct sail_image *image, pixel_consumer_t pixel_consumer, const struct output_context *output_context) {
 
     unsigned row;
@@ -596,6 +702,41 @@ static sail_status_t convert_from_bpp24_ycbcr(const struct sail_image *image, pi
     return SAIL_OK;
 }
 
+static sail_status_t convert_from_planar_yuv(const struct sail_image *image, pixel_consumer_t pixel_consumer, const struct output_context *output_context) {
+
+    struct sail_plane planes[3];
+    unsigned planes_count;
+    SAIL_TRY(sail_image_planes(image, planes, &planes_count));
+
+    const bool nv12                 = image->pixel_format == SAIL_PIXEL_FORMAT_BPP12_NV12;
+    const unsigned chroma_step      = nv12 ? 2 : 1;
+    const unsigned chroma_row_shift = (planes[1].height == image->height) ? 0 : 1;
+
+    unsigned row;
+
+    #pragma omp parallel for schedule(SAIL_OPENMP_SCHEDULE)
+    for (row = 0; row < image->height; row++) {
+        const unsigned chroma_row = row >> chroma_row_shift;
+
+        const uint8_t  *scan_y        = (const uint8_t *)planes[0].pixels + (size_t)row * planes[0].bytes_per_line;
+        const uint8_t  *scan_u        = (const uint8_t *)planes[1].pixels + (size_t)chroma_row * planes[1].bytes_per_line;
+        const uint8_t  *scan_v        = nv12 ? scan_u + 1 : (const uint8_t *)planes[2].pixels + (size_t)chroma_row * planes[2].bytes_per_line;
+              uint8_t  *scan_output8  = sail_scan_line(output_context->image, row);
+              uint16_t *scan_output16 = sail_scan_line(output_context->image, row);
+
+        for (unsigned column = 0; column < image->width; column++) {
+            const unsigned chroma_offset = (column / 2) * chroma_step;
+
+            sail_rgba32_t rgba32;
+            convert_ycbcr24_to_rgba32(scan_y[column], scan_u[chroma_offset], scan_v[chroma_offset], &rgba32);
+
+            pixel_consumer(output_context, &scan_output8, &scan_output16, &rgba32, NULL);
+        }
+    }
+
+    return SAIL_OK;
+}
+
 static sail_status_t convert_from_bpp32_ycck(const struct sail_image *image, pixel_consumer_t pixel_consumer, const struct output_context *output_context) {
 
     unsigned row;
@@ -618,6 +759,66 @@ static sail_status_t convert_from_bpp32_ycck(const struct sail_image *image, pix
     return SAIL_OK;
 }
 
+/*
+ * Returns true if the image has an alpha channel and all its pixels are fully opaque.
+ * Stops at the first translucent pixel.
+ */
+static bool is_opaque(const struct sail_image *image) {
+
+    unsigned components;
+    unsigned alpha_index;
+    bool alpha16;
+
+    switch (image->pixel_format) {
+        case SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE_ALPHA: { components = 2; alpha_index = 1; alpha16 = false; break; }
+        case SAIL_PIXEL_FORMAT_BPP32_GRAYSCALE_ALPHA: { components = 2; alpha_index = 1; alpha16 = true;  break; }
+
+        case SAIL_PIXEL_FORMAT_BPP32_RGBA:
+        case SAIL_PIXEL_FORMAT_BPP32_BGRA:
+        case SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED: { components = 4; alpha_index = 3; alpha16 = false; break; }
+        case SAIL_PIXEL_FORMAT_BPP32_ARGB:
+        case SAIL_PIXEL_FORMAT_BPP32_ABGR:
+        case SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED: { components = 4; alpha_index = 0; alpha16 = false; break; }
+
+        case SAIL_PIXEL_FORMAT_BPP64_RGBA:
+        case SAIL_PIXEL_FORMAT_BPP64_BGRA:
+        case SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED: { components = 4; alpha_index = 3; alpha16 = true; break; }
+        case SAIL_PIXEL_FORMAT_BPP64_ARGB:
+        case SAIL_PIXEL_FORMAT_BPP64_ABGR:
+        case SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED: { components = 4; alpha_index = 0; alpha16 = true; break; }
+
+        default: {
+            return false;
+        }
+    }
+
+    for (unsigned row = 0; row < image->height; row++) {
+        if (alpha16) {
+            const uint16_t *scan = sail_scan_line(image, row);
+
+            for (unsigned column = 0; column < image->width; column++) {
+                if (scan[column * components + alpha_index] != 65535) {
+                    return false;
+                }
+            }
+        } else {
+            const uint8_t *scan = sail_scan_line(image, row);
+
+            for (unsigned column = 0; column < image->width; column++) {
+                if (scan[column * components + alpha_index] != 255) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
 static sail_status_t conversion_impl(
     const struct sail_image *image,
     struct sail_image *image_output,
@@ -626,9 +827,24 @@ static sail_status_t conversion_impl(
     int g, /* Index of the GREEN component. */
     int b, /* Index of the BLUE component.  */
     int a, /* Index of the ALPHA component. */
-    const struct sail_conversion_options *options) {
+    const struct sail_conversion_options *options,
+    const struct color_transform *transform) {
 
-    const struct output_context output_context = { image_output, r, g, b, a, options };
+    /* Blending is a no-op for fully opaque images, so skip it. */
+    struct sail_conversion_options options_no_blending;
+
+    if (options != NULL && (options->options & SAIL_CONVERSION_OPTION_BLEND_ALPHA) && is_opaque(image)) {
+        options_no_blending = *options;
+        options_no_blending.options &= ~SAIL_CONVERSION_OPTION_BLEND_ALPHA;
+        options_no_blending.options |= SAIL_CONVERSION_OPTION_DROP_ALPHA;
+        options = &options_no_blending;
+    }
+
+    const struct output_context output_context = { image_output, r, g, b, a, options, transform, pixel_consumer };
+
+    if (transform != NULL) {
+        pixel_consumer = pixel_consumer_color_transform;
+    }
 
     /* After adding a new input pixel format, also update the switch in sail_can_convert(). */
     switch (image->pixel_format) {
@@ -772,6 +988,38 @@ static sail_status_t conversion_impl(
             SAIL_TRY(convert_from_bpp64_rgba_kind(image, 3, 2, 1, 0, pixel_consumer, &output_context));
             break;
         }
+        case SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED: {
+            SAIL_TRY(convert_from_bpp32_premultiplied_rgba_kind(image, 0, 1, 2, 3, pixel_consumer, &output_context));
+            break;
+        }
+        case SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED: {
+            SAIL_TRY(convert_from_bpp32_premultiplied_rgba_kind(image, 2, 1, 0, 3, pixel_consumer, &output_context));
+            break;
+        }
+        case SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED: {
+            SAIL_TRY(convert_from_bpp32_premultiplied_rgba_kind(image, 1, 2, 3, 0, pixel_consumer, &output_context));
+            break;
+        }
+        case SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED: {
+            SAIL_TRY(convert_from_bpp32_premultiplied_rgba_kind(image, 3, 2, 1, 0, pixel_consumer, &output_context));
+            break;
+        }
+        case SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED: {
+            SAIL_TRY(convert_from_bpp64_premultiplied_rgba_kind(image, 0, 1, 2, 3, pixel_consumer, &output_context));
+            break;
+        }
+        case SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED: {
+            SAIL_TRY(convert_from_bpp64_premultiplied_rgba_kind(image, 2, 1, 0, 3, pixel_consumer, &output_context));
+            break;
+        }
+        case SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED: {
+            SAIL_TRY(convert_from_bpp64_premultiplied_rgba_kind(image, 1, 2, 3, 0, pixel_consumer, &output_context));
+            break;
+        }
+        case SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED: {
+            SAIL_TRY(convert_from_bpp64_premultiplied_rgba_kind(image, 3, 2, 1, 0, pixel_consumer, &output_context));
+            break;
+        }
         case SAIL_PIXEL_FORMAT_BPP32_CMYK: {
             SAIL_TRY(convert_from_bpp32_cmyk(image, pixel_consumer, &output_context));
             break;
@@ -784,6 +1032,12 @@ static sail_status_t conversion_impl(
             SAIL_TRY(convert_from_bpp32_ycck(image, pixel_consumer, &output_context));
             break;
         }
+        case SAIL_PIXEL_FORMAT_BPP12_YUV420P:
+        case SAIL_PIXEL_FORMAT_BPP16_YUV422P:
+        case SAIL_PIXEL_FORMAT_BPP12_NV12: {
+            SAIL_TRY(convert_from_planar_yuv(image, pixel_consumer, &output_context));
+            break;
+        }
         default: {
             SAIL_LOG_ERROR("Conversion from %s is not currently supported", sail_pixel_format_to_string(image->pixel_format));
             SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
@@ -793,6 +1047,273 @@ static sail_status_t conversion_impl(
     return SAIL_OK;
 }
 
+static bool is_color_transform_supported(enum SailPixelFormat pixel_format) {
+
+    switch (pixel_format) {
+        case SAIL_PIXEL_FORMAT_BPP1_INDEXED:
+        case SAIL_PIXEL_FORMAT_BPP2_INDEXED:
+        case SAIL_PIXEL_FORMAT_BPP4_INDEXED:
+        case SAIL_PIXEL_FORMAT_BPP8_INDEXED:
+        case SAIL_PIXEL_FORMAT_BPP16_RGB555:
+        case SAIL_PIXEL_FORMAT_BPP16_BGR555:
+        case SAIL_PIXEL_FORMAT_BPP16_RGB565:
+        case SAIL_PIXEL_FORMAT_BPP16_BGR565:
+        case SAIL_PIXEL_FORMAT_BPP24_RGB:
+        case SAIL_PIXEL_FORMAT_BPP24_BGR:
+        case SAIL_PIXEL_FORMAT_BPP48_RGB:
+        case SAIL_PIXEL_FORMAT_BPP48_BGR:
+        case SAIL_PIXEL_FORMAT_BPP32_RGBX:
+        case SAIL_PIXEL_FORMAT_BPP32_BGRX:
+        case SAIL_PIXEL_FORMAT_BPP32_XRGB:
+        case SAIL_PIXEL_FORMAT_BPP32_XBGR:
+        case SAIL_PIXEL_FORMAT_BPP32_RGBA:
+        case SAIL_PIXEL_FORMAT_BPP32_BGRA:
+        case SAIL_PIXEL_FORMAT_BPP32_ARGB:
+        case SAIL_PIXEL_FORMAT_BPP32_ABGR:
+        case SAIL_PIXEL_FORMAT_BPP64_RGBX:
+        case SAIL_PIXEL_FORMAT_BPP64_BGRX:
+        case SAIL_PIXEL_FORMAT_BPP64_XRGB:
+        case SAIL_PIXEL_FORMAT_BPP64_XBGR:
+        case SAIL_PIXEL_FORMAT_BPP64_RGBA:
+        case SAIL_PIXEL_FORMAT_BPP64_BGRA:
+        case SAIL_PIXEL_FORMAT_BPP64_ARGB:
+        case SAIL_PIXEL_FORMAT_BPP64_ABGR:
+        case SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP24_YCBCR:
+        case SAIL_PIXEL_FORMAT_BPP12_YUV420P:
+        case SAIL_PIXEL_FORMAT_BPP16_YUV422P:
+        case SAIL_PIXEL_FORMAT_BPP12_NV12: {
+            return true;
+        }
+
+        default: {
+            return false;
+        }
+    }
+}
+
+static sail_status_t fetch_color_transform(const struct sail_image *image, enum SailColorProfile profile, const struct color_transform **transform) {
+
+    if (image->iccp == NULL) {
+        SAIL_LOG_ERROR("Image has no ICC profile");
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_MISSING_ICCP);
+    }
+
+    if (!is_color_transform_supported(image->pixel_format)) {
+        SAIL_LOG_ERROR("ICC transform from %s is not supported", sail_pixel_format_to_string(image->pixel_format));
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_FORMAT);
+    }
+
+    SAIL_TRY(color_transform_from_iccp(image->iccp, profile, transform));
+
+    return SAIL_OK;
+}
+
+/* Returns a transform to sRGB if SAIL_CONVERSION_OPTION_APPLY_ICCP is set and the ICC profile is supported, NULL otherwise. */
+static const struct color_transform *color_transform_from_options(const struct sail_image *image, const struct sail_conversion_options *options) {
+
+    if (options == NULL || !(options->options & SAIL_CONVERSION_OPTION_APPLY_ICCP) || image->iccp == NULL) {
+        return NULL;
+    }
+
+    const struct color_transform *transform;
+
+    if (fetch_color_transform(image, SAIL_COLOR_PROFILE_SRGB, &transform) != SAIL_OK) {
+        SAIL_LOG_WARNING("Failed to apply the ICC profile, converting colors as is");
+        return NULL;
+    }
+
+    return transform;
+}
+
+/* Returns the pixel size and RGB component indexes of 8-bit RGB pixel formats. */
+static bool rgb_kind_components(enum SailPixelFormat pixel_format, unsigned *bytes_per_pixel, int *r, int *g, int *b) {
+
+    switch (pixel_format) {
+        case SAIL_PIXEL_FORMAT_BPP24_RGB:  { *bytes_per_pixel = 3; *r = 0; *g = 1; *b = 2; return true; }
+        case SAIL_PIXEL_FORMAT_BPP24_BGR:  { *bytes_per_pixel = 3; *r = 2; *g = 1; *b = 0; return true; }
+
+        case SAIL_PIXEL_FORMAT_BPP32_RGBX:
+        case SAIL_PIXEL_FORMAT_BPP32_RGBA: { *bytes_per_pixel = 4; *r = 0; *g = 1; *b = 2; return true; }
+        case SAIL_PIXEL_FORMAT_BPP32_BGRX:
+        case SAIL_PIXEL_FORMAT_BPP32_BGRA: { *bytes_per_pixel = 4; *r = 2; *g = 1; *b = 0; return true; }
+        case SAIL_PIXEL_FORMAT_BPP32_XRGB:
+        case SAIL_PIXEL_FORMAT_BPP32_ARGB: { *bytes_per_pixel = 4; *r = 1; *g = 2; *b = 3; return true; }
+        case SAIL_PIXEL_FORMAT_BPP32_XBGR:
+        case SAIL_PIXEL_FORMAT_BPP32_ABGR: { *bytes_per_pixel = 4; *r = 3; *g = 2; *b = 1; return true; }
+
+        default: {
+            return false;
+        }
+    }
+}
+
+static sail_status_t convert_image_impl(const struct sail_image *image,
+                                        enum SailPixelFormat output_pixel_format,
+                                        const struct sail_conversion_options *options,
+                                        const struct color_transform *transform,
+                                        struct sail_image **image_output);
+
+static sail_status_t convert_image_to_planar_yuv(const struct sail_image *image,
+                                                 enum SailPixelFormat output_pixel_format,
+                                                 const struct sail_conversion_options *options,
+                                                 const struct color_transform *transform,
+                                                 struct sail_image **image_output) {
+
+    struct sail_image *image_local;
+    SAIL_TRY(sail_copy_image_skeleton(image, &image_local));
+
+    image_local->pixel_format = output_pixel_format;
+    image_local->bytes_per_line = sail_bytes_per_line(image_local->width, image_local->pixel_format);
+
+    SAIL_TRY_OR_CLEANUP(sail_malloc(sail_bytes_per_image(image_local), &image_local->pixels),
+                        /* cleanup */ sail_destroy_image(image_local));
+
+    const bool blend_alpha = options != NULL && (options->options & SAIL_CONVERSION_OPTION_BLEND_ALPHA) && !is_opaque(image);
+
+    unsigned bytes_per_pixel;
+    int r, g, b;
+
+    if (transform == NULL && can_rearrange_planar_yuv(image->pixel_format, output_pixel_format)) {
+        SAIL_TRY_OR_CLEANUP(rearrange_planar_yuv(image, image_local),
+                            /* cleanup */ sail_destroy_image(image_local));
+    } else if (transform == NULL && !blend_alpha && rgb_kind_components(image->pixel_format, &bytes_per_pixel, &r, &g, &b)) {
+        SAIL_TRY_OR_CLEANUP(convert_rgb_kind_to_planar_yuv(image, bytes_per_pixel, r, g, b, image_local),
+                            /* cleanup */ sail_destroy_image(image_local));
+    } else {
+        /* Other pixel formats, color transforms, and alpha blending go through RGB. */
+        struct sail_image *image_rgb;
+        SAIL_TRY_OR_CLEANUP(convert_image_impl(image, SAIL_PIXEL_FORMAT_BPP24_RGB, options, transform, &image_rgb),
+                            /* cleanup */ sail_destroy_image(image_local));
+
+        SAIL_TRY_OR_CLEANUP(convert_rgb_kind_to_planar_yuv(image_rgb, 3, 0, 1, 2, image_local),
+                            /* cleanup */ sail_destroy_image(image_rgb),
+                                          sail_destroy_image(image_local));
+
+        sail_destroy_image(image_rgb);
+    }
+
+    /* The pixels are not in the embedded color space anymore. */
+    if (transform != NULL) {
+        sail_destroy_iccp(image_local->iccp);
+        image_local->iccp = NULL;
+    }
+
+    *image_output = image_local;
+
+    return SAIL_OK;
+}
+
+static sail_status_t convert_image_to_indexed(const struct sail_image *image,
+                                               enum SailPixelFormat output_pixel_format,
+                                               const struct sail_conversion_options *options,
+                                               const struct color_transform *transform,
+                                               struct sail_image **image_output) {
+
+    struct sail_image *image_local;
+    SAIL_TRY(sail_copy_image_skeleton(image, &image_local));
+
+    image_local->pixel_format = output_pixel_format;
+    image_local->bytes_per_line = sail_bytes_per_line(image_local->width, image_local->pixel_format);
+
+    SAIL_TRY_OR_CLEANUP(sail_malloc(sail_bytes_per_image(image_local), &image_local->pixels),
+                        /* cleanup */ sail_destroy_image(image_local));
+
+    const bool fixed_palette = options != NULL && options->palette != NULL;
+    const bool blend_alpha = options != NULL && (options->options & SAIL_CONVERSION_OPTION_BLEND_ALPHA) && !is_opaque(image);
+
+    if (transform == NULL && !fixed_palette && !blend_alpha && can_repack_indexes(image, output_pixel_format)) {
+        /* The palette fits as is, just repack the indexes. */
+        SAIL_TRY_OR_CLEANUP(repack_indexes(image, image_local),
+                            /* cleanup */ sail_destroy_image(image_local));
+        SAIL_TRY_OR_CLEANUP(sail_copy_palette(image->palette, &image_local->palette),
+                            /* cleanup */ sail_destroy_image(image_local));
+    } else if (transform == NULL && !blend_alpha &&
+                (image->pixel_format == SAIL_PIXEL_FORMAT_BPP24_RGB || image->pixel_format == SAIL_PIXEL_FORMAT_BPP32_RGBA)) {
+        SAIL_TRY_OR_CLEANUP(quantize_image(image, options, image_local),
+                            /* cleanup */ sail_destroy_image(image_local));
+    } else {
+        /* Other pixel formats, color transforms, and alpha blending go through RGB(A). */
+        struct sail_image *image_rgba;
+        SAIL_TRY_OR_CLEANUP(convert_image_impl(image, blend_alpha ? SAIL_PIXEL_FORMAT_BPP24_RGB : SAIL_PIXEL_FORMAT_BPP32_RGBA,
+                                                options, transform, &image_rgba),
+                            /* cleanup */ sail_destroy_image(image_local));
+
+        SAIL_TRY_OR_CLEANUP(quantize_image(image_rgba, options, image_local),
+                            /* cleanup */ sail_destroy_image(image_rgba),
+                                          sail_destroy_image(image_local));
+
+        sail_destroy_image(image_rgba);
+    }
+
+    /* The pixels are not in the embedded color space anymore. */
+    if (transform != NULL) {
+        sail_destroy_iccp(image_local->iccp);
+        image_local->iccp = NULL;
+    }
+
+    *image_output = image_local;
+
+    return SAIL_OK;
+}
+
+static sail_status_t convert_image_impl(const struct sail_image *image,
+                                        enum SailPixelFormat output_pixel_format,
+                                        const struct sail_conversion_options *options,
+                                        const struct color_transform *transform,
+                                        struct sail_image **image_output) {
+
+    if (sail_is_planar(output_pixel_format)) {
+        SAIL_TRY(convert_image_to_planar_yuv(image, output_pixel_format, options, transform, image_output));
+        return SAIL_OK;
+    }
+
+    if (sail_is_indexed(output_pixel_format)) {
+        SAIL_TRY(convert_image_to_indexed(image, output_pixel_format, options, transform, image_output));
+        return SAIL_OK;
+    }
+
+    int r, g, b, a;
+    pixel_consumer_t pixel_consumer;
+    SAIL_TRY(verify_and_construct_rgba_indexes_verbose(output_pixel_format, &pixel_consumer, &r, &g, &b, &a));
+
+    struct sail_image *image_local;
+    SAIL_TRY(sail_copy_image_skeleton(image, &image_local));
+
+    image_local->pixel_format = output_pixel_format;
+    image_local->bytes_per_line = sail_bytes_per_line(image_local->width, image_local->pixel_format);
+
+    const size_t pixels_size = sail_bytes_per_image(image_local);
+    SAIL_TRY_OR_CLEANUP(sail_malloc(pixels_size, &image_local->pixels),
+                        /* cleanup */ sail_destroy_image(image_local));
+
+    /* Fast path: premultiply or unpremultiply whole scan lines with the same component order. */
+    if (transform == NULL && can_toggle_premultiplied_alpha(image->pixel_format, output_pixel_format)) {
+        SAIL_TRY_OR_CLEANUP(toggle_premultiplied_alpha(image, image_local),
+                            /* cleanup */ sail_destroy_image(image_local));
+    } else {
+        SAIL_TRY_OR_CLEANUP(conversion_impl(image, image_local, pixel_consumer, r, g, b, a, options, transform),
+                            /* cleanup */ sail_destroy_image(image_local));
+    }
+
+    /* The pixels are not in the embedded color space anymore. */
+    if (transform != NULL) {
+        sail_destroy_iccp(image_local->iccp);
+        image_local->iccp = NULL;
+    }
+
+    *image_output = image_local;
+
+    return SAIL_OK;
+}
+
 /*
  * Public functions.
  */
@@ -814,24 +1335,23 @@ sail_status_t sail_convert_image_with_options(const struct sail_image *image,
     SAIL_TRY(sail_check_image_valid(image));
     SAIL_CHECK_PTR(image_output);
 
-    int r, g, b, a;
-    pixel_consumer_t pixel_consumer;
-    SAIL_TRY(verify_and_construct_rgba_indexes_verbose(output_pixel_format, &pixel_consumer, &r, &g, &b, &a));
+    SAIL_TRY(convert_image_impl(image, output_pixel_format, options, color_transform_from_options(image, options), image_output));
 
-    struct sail_image *image_local;
-    SAIL_TRY(sail_copy_image_skeleton(image, &image_local));
+    return SAIL_OK;
+}
 
-    image_local->pixel_format = output_pixel_format;
-    image_local->bytes_per_line = sail_bytes_per_line(image_local->width, image_local->pixel_format);
+sail_status_t sail_convert_image_to_profile(const struct sail_image *image,
+                                            enum SailPixelFormat output_pixel_format,
+                                            enum SailColorProfile profile,
+                                            struct sail_image **image_output) {
 
-    const size_t pixels_size = (size_t)image_local->height * image_local->bytes_per_line;
-    SAIL_TRY_OR_CLEANUP(sail_malloc(pixels_size, &image_local->pixels),
-                        /* cleanup */ sail_destroy_image(image_local));
+    SAIL_TRY(sail_check_image_valid(image));
+    SAIL_CHECK_PTR(image_output);
 
-    SAIL_TRY_OR_CLEANUP(conversion_impl(image, image_local, pixel_consumer, r, g, b, a, options),
-                        /* cleanup */ sail_destroy_image(image_local));
+    const struct color_transform *transform;
+    SAIL_TRY(fetch_color_transform(image, profile, &transform));
 
-    *image_output = image_local;
+    SAIL_TRY(convert_image_impl(image, output_pixel_format, NULL /* options */, transform, image_output));
 
     return SAIL_OK;
 }
@@ -853,7 +1373,14 @@ sail_status_t sail_update_image_with_options(struct sail_image *image,
     pixel_consumer_t pixel_consumer;
     SAIL_TRY(verify_and_construct_rgba_indexes_verbose(output_pixel_format, &pixel_consumer, &r, &g, &b, &a));
 
-    if (image->pixel_format == output_pixel_format) {
+    if (sail_is_planar(image->pixel_format)) {
+        SAIL_LOG_ERROR("Updating planar images in place is not supported");
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    }
+
+    const struct color_transform *transform = color_transform_from_options(image, options);
+
+    if (image->pixel_format == output_pixel_format && transform == NULL) {
         return SAIL_OK;
     }
 
@@ -865,15 +1392,34 @@ sail_status_t sail_update_image_with_options(struct sail_image *image,
         SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
     }
 
-    SAIL_TRY(conversion_impl(image, image, pixel_consumer, r, g, b, a, options));
+    if (transform == NULL && can_toggle_premultiplied_alpha(image->pixel_format, output_pixel_format)) {
+        SAIL_TRY(toggle_premultiplied_alpha(image, image));
+    } else {
+        SAIL_TRY(conversion_impl(image, image, pixel_consumer, r, g, b, a, options, transform));
+    }
 
     image->pixel_format = output_pixel_format;
 
+    if (transform != NULL) {
+        sail_destroy_iccp(image->iccp);
+        image->iccp = NULL;
+    }
+
     return SAIL_OK;
 }
 
 bool sail_can_convert(enum SailPixelFormat input_pixel_format, enum SailPixelFormat output_pixel_format) {
 
+    /* Planar outputs are produced from RGB or rearranged from other planar formats. */
+    if (sail_is_planar(output_pixel_format)) {
+        return sail_is_planar(input_pixel_format) || sail_can_convert(input_pixel_format, SAIL_PIXEL_FORMAT_BPP24_RGB);
+    }
+
+    /* Indexed outputs are quantized from RGBA. */
+    if (sail_is_indexed(output_pixel_format)) {
+        return sail_can_convert(input_pixel_format, SAIL_PIXEL_FORMAT_BPP32_RGBA);
+    }
+
     /* After adding a new input pixel format, also update the switch in conversion_impl(). */
     switch (input_pixel_format) {
         case SAIL_PIXEL_FORMAT_BPP1_INDEXED:
@@ -911,8 +1457,19 @@ bool sail_can_convert(enum SailPixelFormat input_pixel_format, enum SailPixelFor
         case SAIL_PIXEL_FORMAT_BPP64_BGRA:
         case SAIL_PIXEL_FORMAT_BPP64_ARGB:
         case SAIL_PIXEL_FORMAT_BPP64_ABGR:
+        case SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED:
         case SAIL_PIXEL_FORMAT_BPP32_CMYK:
-        case SAIL_PIXEL_FORMAT_BPP24_YCBCR: {
+        case SAIL_PIXEL_FORMAT_BPP24_YCBCR:
+        case SAIL_PIXEL_FORMAT_BPP12_YUV420P:
+        case SAIL_PIXEL_FORMAT_BPP16_YUV422P:
+        case SAIL_PIXEL_FORMAT_BPP12_NV12: {
             int r, g, b, a;
             pixel_consumer_t pixel_consumer;
             return verify_and_construct_rgba_indexes_silent(output_pixel_format, &pixel_consumer, &r, &g, &b, &a);
@@ -955,6 +1512,21 @@ static const enum SailPixelFormat GRAYSCALE_CANDIDATES[] = {
     SAIL_PIXEL_FORMAT_BPP64_BGRX,
     SAIL_PIXEL_FORMAT_BPP64_XRGB,
     SAIL_PIXEL_FORMAT_BPP64_XBGR,
+
+    SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED,
+    SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED,
+    SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED,
+    SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED,
+
+    SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED,
+    SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED,
+    SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED,
+    SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED,
+
+    SAIL_PIXEL_FORMAT_BPP8_INDEXED,
+    SAIL_PIXEL_FORMAT_BPP4_INDEXED,
+    SAIL_PIXEL_FORMAT_BPP2_INDEXED,
+    SAIL_PIXEL_FORMAT_BPP1_INDEXED,
 };
 
 static const size_t GRAYSCALE_CANDIDATES_LENGTH = sizeof(GRAYSCALE_CANDIDATES) / sizeof(GRAYSCALE_CANDIDATES[0]);
@@ -991,8 +1563,34 @@ static const enum SailPixelFormat INDEXED_OR_FULL_COLOR_CANDIDATES[] = {
 
     SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE,
     SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE,
+
+    SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED,
+    SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED,
+    SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED,
+    SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED,
+
+    SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED,
+    SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED,
+    SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED,
+    SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED,
+
+    SAIL_PIXEL_FORMAT_BPP8_INDEXED,
+    SAIL_PIXEL_FORMAT_BPP4_INDEXED,
+    SAIL_PIXEL_FORMAT_BPP2_INDEXED,
+    SAIL_PIXEL_FORMAT_BPP1_INDEXED,
+};
+
+/* Indexed images convert losslessly into indexed pixel formats of the same or higher bit depth. */
+static const enum SailPixelFormat INDEXED_CANDIDATES[] = {
+
+    SAIL_PIXEL_FORMAT_BPP1_INDEXED,
+    SAIL_PIXEL_FORMAT_BPP2_INDEXED,
+    SAIL_PIXEL_FORMAT_BPP4_INDEXED,
+    SAIL_PIXEL_FORMAT_BPP8_INDEXED,
 };
 
+static const size_t INDEXED_CANDIDATES_LENGTH = sizeof(INDEXED_CANDIDATES) / sizeof(INDEXED_CANDIDATES[0]);
+
 static const size_t INDEXED_OR_FULL_COLOR_CANDIDATES_LENGTH = sizeof(INDEXED_OR_FULL_COLOR_CANDIDATES) / sizeof(INDEXED_OR_FULL_COLOR_CANDIDATES[0]);
 
 enum SailPixelFormat sail_closest_pixel_format(enum SailPixelFormat input_pixel_format,
@@ -1003,6 +1601,20 @@ enum SailPixelFormat sail_closest_pixel_format(enum SailPixelFormat input_pixel_
         return SAIL_PIXEL_FORMAT_UNKNOWN;
     }
 
+    if (sail_is_indexed(input_pixel_format)) {
+        for (size_t k = 0; k < INDEXED_CANDIDATES_LENGTH; k++) {
+            if (sail_bits_per_pixel(INDEXED_CANDIDATES[k]) < sail_bits_per_pixel(input_pixel_format)) {
+                continue;
+            }
+
+            for (size_t i = 0; i < pixel_formats_length; i++) {
+                if (pixel_formats[i] == INDEXED_CANDIDATES[k]) {
+                    return pixel_formats[i];
+                }
+            }
+        }
+    }
+
     const enum SailPixelFormat *candidates;
     size_t candidates_length;
 
@@ -1065,7 +1677,9 @@ sail_status_t sail_convert_image_for_saving_with_options(const struct sail_image
         SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
     }
 
-    if (best_pixel_format == image->pixel_format) {
+    const bool apply_iccp = options != NULL && (options->options & SAIL_CONVERSION_OPTION_APPLY_ICCP) && image->iccp != NULL;
+
+    if (best_pixel_format == image->pixel_format && !apply_iccp) {
         SAIL_TRY(sail_copy_image(image, image_output));
     } else {
         SAIL_TRY(sail_convert_image_with_options(image, best_pixel_format, options, image_output));
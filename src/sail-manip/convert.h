@@ -33,6 +33,8 @@
 #include <sail-common/export.h>
 #include <sail-common/status.h>
 
+#include <sail-manip/manip_common.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -52,7 +54,11 @@ struct sail_save_features;
  * BPP64-RGBA formats first, and only then to the requested output format. No platform-specific
  * instructions (like AVX or SSE) are used.
  *
- * The image ICC profile is not involved in the conversion procedure.
+ * The image ICC profile is not involved in the conversion procedure. Use sail_convert_image_to_profile()
+ * or SAIL_CONVERSION_OPTION_APPLY_ICCP to apply it.
+ *
+ * Indexed outputs are quantized with the median cut algorithm without dithering. Use
+ * sail_convert_image_with_options() to select another algorithm, dithering, or a fixed palette.
  *
  * The resulting image gets updated pixel format and bytes per line. Other properties are copied from
  * the original image.
@@ -88,8 +94,27 @@ struct sail_save_features;
  *   - SAIL_PIXEL_FORMAT_BPP64_ARGB
  *   - SAIL_PIXEL_FORMAT_BPP64_ABGR
  *
+ *   - SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED
+ *
+ *   - SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED
+ *
  *   - SAIL_PIXEL_FORMAT_BPP24_YCBCR
  *
+ *   - SAIL_PIXEL_FORMAT_BPP12_YUV420P
+ *   - SAIL_PIXEL_FORMAT_BPP16_YUV422P
+ *   - SAIL_PIXEL_FORMAT_BPP12_NV12
+ *
+ *   - SAIL_PIXEL_FORMAT_BPP1_INDEXED
+ *   - SAIL_PIXEL_FORMAT_BPP2_INDEXED
+ *   - SAIL_PIXEL_FORMAT_BPP4_INDEXED
+ *   - SAIL_PIXEL_FORMAT_BPP8_INDEXED
+ *
  * Returns SAIL_OK on success.
  */
 SAIL_EXPORT sail_status_t sail_convert_image(const struct sail_image *image,
@@ -105,7 +130,11 @@ SAIL_EXPORT sail_status_t sail_convert_image(const struct sail_image *image,
  * BPP64-RGBA formats first, and only then to the requested output format. No platform-specific
  * instructions (like AVX or SSE) are used.
  *
- * The image ICC profile (if any) is not involved into the conversion procedure.
+ * The image ICC profile (if any) is applied only with SAIL_CONVERSION_OPTION_APPLY_ICCP.
+ *
+ * Indexed outputs get a new palette built with the quantization algorithm from the options,
+ * or the fixed palette from the options. Images with few colors get lossless palettes.
+ * Alpha is kept in BPP32-RGBA palettes unless the options have SAIL_CONVERSION_OPTION_BLEND_ALPHA.
  *
  * The resulting image gets updated pixel format and bytes per line. Other properties are copied from
  * the original image.
@@ -141,8 +170,27 @@ SAIL_EXPORT sail_status_t sail_convert_image(const struct sail_image *image,
  *   - SAIL_PIXEL_FORMAT_BPP64_ARGB
  *   - SAIL_PIXEL_FORMAT_BPP64_ABGR
  *
+ *   - SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED
+ *
+ *   - SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED
+ *
  *   - SAIL_PIXEL_FORMAT_BPP24_YCBCR
  *
+ *   - SAIL_PIXEL_FORMAT_BPP12_YUV420P
+ *   - SAIL_PIXEL_FORMAT_BPP16_YUV422P
+ *   - SAIL_PIXEL_FORMAT_BPP12_NV12
+ *
+ *   - SAIL_PIXEL_FORMAT_BPP1_INDEXED
+ *   - SAIL_PIXEL_FORMAT_BPP2_INDEXED
+ *   - SAIL_PIXEL_FORMAT_BPP4_INDEXED
+ *   - SAIL_PIXEL_FORMAT_BPP8_INDEXED
+ *
  * Returns SAIL_OK on success.
  */
 SAIL_EXPORT sail_status_t sail_convert_image_with_options(const struct sail_image *image,
@@ -165,12 +213,12 @@ SAIL_EXPORT sail_status_t sail_convert_image_with_options(const struct sail_imag
  * BPP64-RGBA formats first, and only then to the requested output format. No platform-specific
  * instructions (like AVX or SSE) are used.
  *
- * The image ICC profile (if any) is not involved into the conversion procedure.
+ * The image ICC profile (if any) is applied only with SAIL_CONVERSION_OPTION_APPLY_ICCP.
  *
  * The image gets updated pixel format and bytes per line. Other properties stay as is.
  *
  * Allowed input pixel formats:
- *   - Anything that produces equal or smaller image except LUV and LAB which are not supported
+ *   - Anything that produces equal or smaller image except LUV, LAB, and planar YUV which are not supported
  *
  * Allowed output pixel formats:
  *   - SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE
@@ -200,6 +248,16 @@ SAIL_EXPORT sail_status_t sail_convert_image_with_options(const struct sail_imag
  *   - SAIL_PIXEL_FORMAT_BPP64_ARGB
  *   - SAIL_PIXEL_FORMAT_BPP64_ABGR
  *
+ *   - SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED
+ *
+ *   - SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED
+ *
  *   - SAIL_PIXEL_FORMAT_BPP24_YCBCR
  *
  * Returns SAIL_OK on success.
@@ -219,12 +277,12 @@ SAIL_EXPORT sail_status_t sail_update_image(struct sail_image *image, enum SailP
  * BPP64-RGBA formats first, and only then to the requested output format. No platform-specific
  * instructions (like AVX or SSE) are used.
  *
- * The image ICC profile (if any) is not involved into the conversion procedure.
+ * The image ICC profile (if any) is applied only with SAIL_CONVERSION_OPTION_APPLY_ICCP.
  *
  * The image gets updated pixel format and bytes per line. Other properties stay as is.
  *
  * Allowed input pixel formats:
- *   - Anything that produces equal or smaller image except LUV and LAB which are not supported
+ *   - Anything that produces equal or smaller image except LUV, LAB, and planar YUV which are not supported
  *
  * Allowed output pixel formats:
  *   - SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE
@@ -254,6 +312,16 @@ SAIL_EXPORT sail_status_t sail_update_image(struct sail_image *image, enum SailP
  *   - SAIL_PIXEL_FORMAT_BPP64_ARGB
  *   - SAIL_PIXEL_FORMAT_BPP64_ABGR
  *
+ *   - SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED
+ *
+ *   - SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED
+ *
  *   - SAIL_PIXEL_FORMAT_BPP24_YCBCR
  *
  * Returns SAIL_OK on success.
@@ -262,6 +330,38 @@ SAIL_EXPORT sail_status_t sail_update_image_with_options(struct sail_image *imag
                                                          enum SailPixelFormat output_pixel_format,
                                                          const struct sail_conversion_options *options);
 
+/*
+ * Converts the input image to the pixel format and transforms its colors from the embedded
+ * ICC profile to the target color profile. Saves the result in the output image. The output image
+ * has no ICC profile.
+ *
+ * Compiled ICC transforms are cached per thread, so converting many images with the same embedded
+ * profile compiles the transform only once. Use sail_clear_color_transform_cache() to free
+ * the cache in the current thread.
+ *
+ * Supported ICC profiles are RGB matrix/TRC profiles, and RGB lut8/lut16 (A2B0) profiles.
+ *
+ * Allowed input pixel formats:
+ *   - Indexed, RGB555, RGB565, RGB(A), BGR(A), and YCbCr formats
+ *
+ * Allowed output pixel formats:
+ *   - Same as in sail_convert_image()
+ *
+ * Returns SAIL_ERROR_MISSING_ICCP if the image has no ICC profile, or SAIL_ERROR_UNSUPPORTED_FORMAT
+ * if the ICC profile or the input pixel format is not supported.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_convert_image_to_profile(const struct sail_image *image,
+                                                        enum SailPixelFormat output_pixel_format,
+                                                        enum SailColorProfile profile,
+                                                        struct sail_image **image_output);
+
+/*
+ * Frees compiled ICC transforms cached in the current thread.
+ */
+SAIL_EXPORT void sail_clear_color_transform_cache(void);
+
 /*
  * Returns true if the conversion or updating functions can convert or update from the input
  * pixel format to the output pixel format.
@@ -45,10 +45,73 @@ enum SailConversionOption {
      * doesn't exist. For example, when we convert RGBA pixels to RGB.
      *
      * Formula:
-     *   opacity = alpha / max_alpha (to convert to [0, 1])
-     *   output_pixel = opacity * input_pixel + (1 - opacity) * background
+     *   output_pixel = (alpha * input_pixel + (max_alpha - alpha) * background + max_alpha / 2) / max_alpha
+     *
+     * Blending uses exact integer math, so the results are bit-identical on all platforms.
      */
     SAIL_CONVERSION_OPTION_BLEND_ALPHA = 1 << 1,
+
+    /*
+     * Transform pixels from the embedded ICC profile to sRGB. The output image has no ICC profile.
+     * Images without ICC profiles, or with unsupported ICC profiles, are converted as is.
+     *
+     * Supported are RGB matrix/TRC profiles, and RGB lut8/lut16 profiles.
+     */
+    SAIL_CONVERSION_OPTION_APPLY_ICCP  = 1 << 2,
+};
+
+/*
+ * Target color profiles for ICC-aware conversion.
+ */
+enum SailColorProfile {
+
+    SAIL_COLOR_PROFILE_SRGB,
+    SAIL_COLOR_PROFILE_DISPLAY_P3,
+};
+
+/*
+ * Algorithms to build palettes when converting images to indexed pixel formats.
+ */
+enum SailQuantizationAlgorithm {
+
+    /*
+     * Recursively splits the color box with the largest error at its weighted median.
+     * Fast and good quality for most images. This is the default.
+     */
+    SAIL_QUANTIZATION_ALGORITHM_MEDIAN_CUT,
+
+    /*
+     * Merges the least populated branches of a color octree. The fastest algorithm.
+     */
+    SAIL_QUANTIZATION_ALGORITHM_OCTREE,
+
+    /*
+     * Refines the median cut palette with k-means iterations. The slowest algorithm
+     * with the smallest quantization error.
+     */
+    SAIL_QUANTIZATION_ALGORITHM_KMEANS,
+};
+
+/*
+ * Dithering methods to use when converting images to indexed pixel formats.
+ */
+enum SailDithering {
+
+    /*
+     * Maps every pixel to the nearest palette color.
+     */
+    SAIL_DITHERING_NONE,
+
+    /*
+     * Diffuses the quantization error to the neighbor pixels with the Floyd-Steinberg weights.
+     */
+    SAIL_DITHERING_FLOYD_STEINBERG,
+
+    /*
+     * Adds an 8x8 Bayer threshold matrix to pixels. Doesn't depend on the neighbor pixels, so
+     * the results are stable in animations.
+     */
+    SAIL_DITHERING_ORDERED,
 };
 
 #endif
@@ -25,10 +25,51 @@
 
 #include <sail-manip/sail-manip.h>
 
-/* https://en.wikipedia.org/wiki/Grayscale */
-static const double R_TO_GRAY_COEFFICIENT = 0.299;
-static const double G_TO_GRAY_COEFFICIENT = 0.587;
-static const double B_TO_GRAY_COEFFICIENT = 0.114;
+/*
+ * https://en.wikipedia.org/wiki/Grayscale. 0.299, 0.587, and 0.114 in 16.16 fixed point.
+ * The coefficients sum up to 65536, so white stays white.
+ */
+#define R_TO_GRAY_COEFFICIENT 19595U
+#define G_TO_GRAY_COEFFICIENT 38470U
+#define B_TO_GRAY_COEFFICIENT 7471U
+
+/*
+ * Alpha blending and gray conversion use exact integer math, so the results are bit-identical
+ * on all platforms and compilers.
+ */
+
+/* 8-bit component and 8-bit alpha blended onto an 8-bit background. */
+static inline uint8_t blend8(uint32_t value, uint32_t background, uint32_t alpha) {
+
+    return (uint8_t)((value * alpha + background * (255 - alpha) + 127) / 255);
+}
+
+/* 8-bit component and 8-bit alpha blended onto a 16-bit background. */
+static inline uint16_t blend8_to16(uint32_t value, uint32_t background, uint32_t alpha) {
+
+    return (uint16_t)((value * 257 * alpha + background * (255 - alpha) + 127) / 255);
+}
+
+/* 16-bit component and 16-bit alpha blended onto a 16-bit background. */
+static inline uint16_t blend16(uint32_t value, uint32_t background, uint32_t alpha) {
+
+    return (uint16_t)((value * alpha + background * (65535 - alpha) + 32767) / 65535);
+}
+
+static inline uint8_t rgb_to_gray8(uint32_t r, uint32_t g, uint32_t b) {
+
+    return (uint8_t)((R_TO_GRAY_COEFFICIENT * r + G_TO_GRAY_COEFFICIENT * g + B_TO_GRAY_COEFFICIENT * b + 32768) >> 16);
+}
+
+static inline uint16_t rgb_to_gray16(uint32_t r, uint32_t g, uint32_t b) {
+
+    return (uint16_t)((R_TO_GRAY_COEFFICIENT * r + G_TO_GRAY_COEFFICIENT * g + B_TO_GRAY_COEFFICIENT * b + 32768) >> 16);
+}
+
+static inline bool blend_alpha(const struct sail_conversion_options *options) {
+
+    return options != NULL && (options->options & SAIL_CONVERSION_OPTION_BLEND_ALPHA);
+}
 
 sail_status_t get_palette_rgba32(const struct sail_palette *palette, unsigned index, sail_rgba32_t *rgba32) {
 
@@ -73,7 +114,7 @@ void spread_gray8_to_rgba32(uint8_t value, sail_rgba32_t *rgba32) {
 
 void spread_gray16_to_rgba32(uint16_t value, sail_rgba32_t *rgba32) {
 
-    rgba32->component1 = rgba32->component2 = rgba32->component3 = (uint8_t)(value / 257.0);
+    rgba32->component1 = rgba32->component2 = rgba32->component3 = (uint8_t)(value / 257);
     rgba32->component4 = 255;
 }
 
@@ -91,88 +132,54 @@ void spread_gray16_to_rgba64(uint16_t value, sail_rgba64_t *rgba64) {
 
 void fill_gray8_pixel_from_uint8_values(const sail_rgba32_t *rgba32, uint8_t *scan, const struct sail_conversion_options *options) {
 
-    sail_rgb24_t rgb24;
-
-    if (rgba32->component4 < 255 && options != NULL && (options->options & SAIL_CONVERSION_OPTION_BLEND_ALPHA)) {
-        const double opacity = rgba32->component4 / 255.0;
-
-        rgb24.component1 = (uint8_t)(opacity * rgba32->component1 + (1 - opacity) * options->background24.component1);
-        rgb24.component2 = (uint8_t)(opacity * rgba32->component2 + (1 - opacity) * options->background24.component2);
-        rgb24.component3 = (uint8_t)(opacity * rgba32->component3 + (1 - opacity) * options->background24.component3);
+    if (rgba32->component4 < 255 && blend_alpha(options)) {
+        *scan = rgb_to_gray8(blend8(rgba32->component1, options->background24.component1, rgba32->component4),
+                                blend8(rgba32->component2, options->background24.component2, rgba32->component4),
+                                blend8(rgba32->component3, options->background24.component3, rgba32->component4));
     } else {
-        rgb24.component1 = rgba32->component1;
-        rgb24.component2 = rgba32->component2;
-        rgb24.component3 = rgba32->component3;
+        *scan = rgb_to_gray8(rgba32->component1, rgba32->component2, rgba32->component3);
     }
-
-    *scan = (uint8_t)((R_TO_GRAY_COEFFICIENT * rgb24.component1) + (G_TO_GRAY_COEFFICIENT * rgb24.component2) + (B_TO_GRAY_COEFFICIENT * rgb24.component3));
 }
 
 void fill_gray8_pixel_from_uint16_values(const sail_rgba64_t *rgba64, uint8_t *scan, const struct sail_conversion_options *options) {
 
-    sail_rgb24_t rgb24;
-
-    if (rgba64->component4 < 65535 && options != NULL && (options->options & SAIL_CONVERSION_OPTION_BLEND_ALPHA)) {
-        const double opacity = rgba64->component4 / 65535.0;
-
-        rgb24.component1 = (uint8_t)((opacity * rgba64->component1 + (1 - opacity) * options->background48.component1) / 257.0);
-        rgb24.component2 = (uint8_t)((opacity * rgba64->component2 + (1 - opacity) * options->background48.component2) / 257.0);
-        rgb24.component3 = (uint8_t)((opacity * rgba64->component3 + (1 - opacity) * options->background48.component3) / 257.0);
+    if (rgba64->component4 < 65535 && blend_alpha(options)) {
+        *scan = rgb_to_gray8(blend16(rgba64->component1, options->background48.component1, rgba64->component4) / 257,
+                                blend16(rgba64->component2, options->background48.component2, rgba64->component4) / 257,
+                                blend16(rgba64->component3, options->background48.component3, rgba64->component4) / 257);
     } else {
-        rgb24.component1 = (uint8_t)(rgba64->component1 / 257.0);
-        rgb24.component2 = (uint8_t)(rgba64->component2 / 257.0);
-        rgb24.component3 = (uint8_t)(rgba64->component3 / 257.0);
+        *scan = rgb_to_gray8(rgba64->component1 / 257, rgba64->component2 / 257, rgba64->component3 / 257);
     }
-
-    *scan = (uint8_t)((R_TO_GRAY_COEFFICIENT * rgb24.component1) + (G_TO_GRAY_COEFFICIENT * rgb24.component2) + (B_TO_GRAY_COEFFICIENT * rgb24.component3));
 }
 
 void fill_gray16_pixel_from_uint8_values(const sail_rgba32_t *rgba32, uint16_t *scan, const struct sail_conversion_options *options) {
 
-    sail_rgb48_t rgb48;
-
-    if (rgba32->component4 < 255 && options != NULL && (options->options & SAIL_CONVERSION_OPTION_BLEND_ALPHA)) {
-        const double opacity = rgba32->component4 / 255.0;
-
-        rgb48.component1 = (uint16_t)(opacity * (rgba32->component1 * 257) + (1 - opacity) * options->background48.component1);
-        rgb48.component2 = (uint16_t)(opacity * (rgba32->component2 * 257) + (1 - opacity) * options->background48.component2);
-        rgb48.component3 = (uint16_t)(opacity * (rgba32->component3 * 257) + (1 - opacity) * options->background48.component3);
+    if (rgba32->component4 < 255 && blend_alpha(options)) {
+        *scan = rgb_to_gray16(blend8_to16(rgba32->component1, options->background48.component1, rgba32->component4),
+                                blend8_to16(rgba32->component2, options->background48.component2, rgba32->component4),
+                                blend8_to16(rgba32->component3, options->background48.component3, rgba32->component4));
     } else {
-        rgb48.component1 = rgba32->component1 * 257;
-        rgb48.component2 = rgba32->component2 * 257;
-        rgb48.component3 = rgba32->component3 * 257;
+        *scan = rgb_to_gray16(rgba32->component1 * 257, rgba32->component2 * 257, rgba32->component3 * 257);
     }
-
-    *scan = (uint16_t)((R_TO_GRAY_COEFFICIENT * rgb48.component1) + (G_TO_GRAY_COEFFICIENT * rgb48.component2) + (B_TO_GRAY_COEFFICIENT * rgb48.component3));
 }
 
 void fill_gray16_pixel_from_uint16_values(const sail_rgba64_t *rgba64, uint16_t *scan, const struct sail_conversion_options *options) {
 
-    sail_rgb48_t rgb48;
-
-    if (rgba64->component4 < 65535 && options != NULL && (options->options & SAIL_CONVERSION_OPTION_BLEND_ALPHA)) {
-        const double opacity = rgba64->component4 / 65535.0;
-
-        rgb48.component1 = (uint16_t)(opacity * rgba64->component1 + (1 - opacity) * options->background48.component1);
-        rgb48.component2 = (uint16_t)(opacity * rgba64->component2 + (1 - opacity) * options->background48.component2);
-        rgb48.component3 = (uint16_t)(opacity * rgba64->component3 + (1 - opacity) * options->background48.component3);
+    if (rgba64->component4 < 65535 && blend_alpha(options)) {
+        *scan = rgb_to_gray16(blend16(rgba64->component1, options->background48.component1, rgba64->component4),
+                                blend16(rgba64->component2, options->background48.component2, rgba64->component4),
+                                blend16(rgba64->component3, options->background48.component3, rgba64->component4));
     } else {
-        rgb48.component1 = rgba64->component1;
-        rgb48.component2 = rgba64->component2;
-        rgb48.component3 = rgba64->component3;
+        *scan = rgb_to_gray16(rgba64->component1, rgba64->component2, rgba64->component3);
     }
-
-    *scan = (uint16_t)((R_TO_GRAY_COEFFICIENT * rgb48.component1) + (G_TO_GRAY_COEFFICIENT * rgb48.component2) + (B_TO_GRAY_COEFFICIENT * rgb48.component3));
 }
 
 void fill_rgb24_pixel_from_uint8_values(const sail_rgba32_t *rgba32, uint8_t *scan, int r, int g, int b, const struct sail_conversion_options *options) {
 
-    if (rgba32->component4 < 255 && options != NULL && (options->options & SAIL_CONVERSION_OPTION_BLEND_ALPHA)) {
-        const double opacity = rgba32->component4 / 255.0;
-
-        *(scan+r) = (uint8_t)(opacity * rgba32->component1 + (1 - opacity) * options->background24.component1);
-        *(scan+g) = (uint8_t)(opacity * rgba32->component2 + (1 - opacity) * options->background24.component2);
-        *(scan+b) = (uint8_t)(opacity * rgba32->component3 + (1 - opacity) * options->background24.component3);
+    if (rgba32->component4 < 255 && blend_alpha(options)) {
+        *(scan+r) = blend8(rgba32->component1, options->background24.component1, rgba32->component4);
+        *(scan+g) = blend8(rgba32->component2, options->background24.component2, rgba32->component4);
+        *(scan+b) = blend8(rgba32->component3, options->background24.component3, rgba32->component4);
     } else {
         *(scan+r) = rgba32->component1;
         *(scan+g) = rgba32->component2;
@@ -182,27 +189,23 @@ void fill_rgb24_pixel_from_uint8_values(const sail_rgba32_t *rgba32, uint8_t *sc
 
 void fill_rgb24_pixel_from_uint16_values(const sail_rgba64_t *rgba64, uint8_t *scan, int r, int g, int b, const struct sail_conversion_options *options) {
 
-    if (rgba64->component4 < 65535 && options != NULL && (options->options & SAIL_CONVERSION_OPTION_BLEND_ALPHA)) {
-        const double opacity = rgba64->component4 / 65535.0;
-
-        *(scan+r) = (uint8_t)((opacity * rgba64->component1 + (1 - opacity) * options->background48.component1) / 257.0);
-        *(scan+g) = (uint8_t)((opacity * rgba64->component2 + (1 - opacity) * options->background48.component2) / 257.0);
-        *(scan+b) = (uint8_t)((opacity * rgba64->component3 + (1 - opacity) * options->background48.component3) / 257.0);
+    if (rgba64->component4 < 65535 && blend_alpha(options)) {
+        *(scan+r) = (uint8_t)(blend16(rgba64->component1, options->background48.component1, rgba64->component4) / 257);
+        *(scan+g) = (uint8_t)(blend16(rgba64->component2, options->background48.component2, rgba64->component4) / 257);
+        *(scan+b) = (uint8_t)(blend16(rgba64->component3, options->background48.component3, rgba64->component4) / 257);
     } else {
-        *(scan+r) = (uint8_t)(rgba64->component1 / 257.0);
-        *(scan+g) = (uint8_t)(rgba64->component2 / 257.0);
-        *(scan+b) = (uint8_t)(rgba64->component3 / 257.0);
+        *(scan+r) = (uint8_t)(rgba64->component1 / 257);
+        *(scan+g) = (uint8_t)(rgba64->component2 / 257);
+        *(scan+b) = (uint8_t)(rgba64->component3 / 257);
     }
 }
 
 void fill_rgb48_pixel_from_uint8_values(const sail_rgba32_t *rgba32, uint16_t *scan, int r, int g, int b, const struct sail_conversion_options *options) {
 
-    if (rgba32->component4 < 255 && options != NULL && (options->options & SAIL_CONVERSION_OPTION_BLEND_ALPHA)) {
-        const double opacity = rgba32->component4 / 255.0;
-
-        *(scan+r) = (uint16_t)(opacity * (rgba32->component1 * 257) + (1 - opacity) * options->background48.component1);
-        *(scan+g) = (uint16_t)(opacity * (rgba32->component2 * 257) + (1 - opacity) * options->background48.component2);
-        *(scan+b) = (uint16_t)(opacity * (rgba32->component3 * 257) + (1 - opacity) * options->background48.component3);
+    if (rgba32->component4 < 255 && blend_alpha(options)) {
+        *(scan+r) = blend8_to16(rgba32->component1, options->background48.component1, rgba32->component4);
+        *(scan+g) = blend8_to16(rgba32->component2, options->background48.component2, rgba32->component4);
+        *(scan+b) = blend8_to16(rgba32->component3, options->background48.component3, rgba32->component4);
     } else {
         *(scan+r) = rgba32->component1 * 257;
         *(scan+g) = rgba32->component2 * 257;
@@ -212,12 +215,10 @@ void fill_rgb48_pixel_from_uint8_values(const sail_rgba32_t *rgba32, uint16_t *s
 
 void fill_rgb48_pixel_from_uint16_values(const sail_rgba64_t *rgba64, uint16_t *scan, int r, int g, int b, const struct sail_conversion_options *options) {
 
-    if (rgba64->component4 < 65535 && options != NULL && (options->options & SAIL_CONVERSION_OPTION_BLEND_ALPHA)) {
-        const double opacity = rgba64->component4 / 65535.0;
-
-        *(scan+r) = (uint16_t)(opacity * rgba64->component1 + (1 - opacity) * options->background48.component1);
-        *(scan+g) = (uint16_t)(opacity * rgba64->component2 + (1 - opacity) * options->background48.component2);
-        *(scan+b) = (uint16_t)(opacity * rgba64->component3 + (1 - opacity) * options->background48.component3);
+    if (rgba64->component4 < 65535 && blend_alpha(options)) {
+        *(scan+r) = blend16(rgba64->component1, options->background48.component1, rgba64->component4);
+        *(scan+g) = blend16(rgba64->component2, options->background48.component2, rgba64->component4);
+        *(scan+b) = blend16(rgba64->component3, options->background48.component3, rgba64->component4);
     } else {
         *(scan+r) = rgba64->component1;
         *(scan+g) = rgba64->component2;
@@ -227,12 +228,10 @@ void fill_rgb48_pixel_from_uint16_values(const sail_rgba64_t *rgba64, uint16_t *
 
 void fill_rgba32_pixel_from_uint8_values(const sail_rgba32_t *rgba32, uint8_t *scan, int r, int g, int b, int a, const struct sail_conversion_options *options) {
 
-    if (a < 0 && rgba32->component4 < 255 && options != NULL && (options->options & SAIL_CONVERSION_OPTION_BLEND_ALPHA)) {
-        const double opacity = rgba32->component4 / 255.0;
-
-        *(scan+r) = (uint8_t)(opacity * rgba32->component1 + (1 - opacity) * options->background24.component1);
-        *(scan+g) = (uint8_t)(opacity * rgba32->component2 + (1 - opacity) * options->background24.component2);
-        *(scan+b) = (uint8_t)(opacity * rgba32->component3 + (1 - opacity) * options->background24.component3);
+    if (a < 0 && rgba32->component4 < 255 && blend_alpha(options)) {
+        *(scan+r) = blend8(rgba32->component1, options->background24.component1, rgba32->component4);
+        *(scan+g) = blend8(rgba32->component2, options->background24.component2, rgba32->component4);
+        *(scan+b) = blend8(rgba32->component3, options->background24.component3, rgba32->component4);
     } else {
         *(scan+r) = rgba32->component1;
         *(scan+g) = rgba32->component2;
@@ -246,31 +245,27 @@ void fill_rgba32_pixel_from_uint8_values(const sail_rgba32_t *rgba32, uint8_t *s
 
 void fill_rgba32_pixel_from_uint16_values(const sail_rgba64_t *rgba64, uint8_t *scan, int r, int g, int b, int a, const struct sail_conversion_options *options) {
 
-    if (a < 0 && rgba64->component4 < 65535 && options != NULL && (options->options & SAIL_CONVERSION_OPTION_BLEND_ALPHA)) {
-        const double opacity = rgba64->component4 / 65535.0;
-
-        *(scan+r) = (uint8_t)((opacity * rgba64->component1 + (1 - opacity) * options->background48.component1) / 257.0);
-        *(scan+g) = (uint8_t)((opacity * rgba64->component2 + (1 - opacity) * options->background48.component2) / 257.0);
-        *(scan+b) = (uint8_t)((opacity * rgba64->component3 + (1 - opacity) * options->background48.component3) / 257.0);
+    if (a < 0 && rgba64->component4 < 65535 && blend_alpha(options)) {
+        *(scan+r) = (uint8_t)(blend16(rgba64->component1, options->background48.component1, rgba64->component4) / 257);
+        *(scan+g) = (uint8_t)(blend16(rgba64->component2, options->background48.component2, rgba64->component4) / 257);
+        *(scan+b) = (uint8_t)(blend16(rgba64->component3, options->background48.component3, rgba64->component4) / 257);
     } else {
-        *(scan+r) = (uint8_t)(rgba64->component1 / 257.0);
-        *(scan+g) = (uint8_t)(rgba64->component2 / 257.0);
-        *(scan+b) = (uint8_t)(rgba64->component3 / 257.0);
+        *(scan+r) = (uint8_t)(rgba64->component1 / 257);
+        *(scan+g) = (uint8_t)(rgba64->component2 / 257);
+        *(scan+b) = (uint8_t)(rgba64->component3 / 257);
     }
 
     if (a >= 0) {
-        *(scan+a) = (uint8_t)(rgba64->component4 / 257.0);
+        *(scan+a) = (uint8_t)(rgba64->component4 / 257);
     }
 }
 
 void fill_rgba64_pixel_from_uint8_values(const sail_rgba32_t *rgba32, uint16_t *scan, int r, int g, int b, int a, const struct sail_conversion_options *options) {
 
-    if (a < 0 && rgba32->component4 < 255 && options != NULL && (options->options & SAIL_CONVERSION_OPTION_BLEND_ALPHA)) {
-        const double opacity = rgba32->component4 / 255.0;
-
-        *(scan+r) = (uint16_t)(opacity * (rgba32->component1 * 257) + (1 - opacity) * options->background48.component1);
-        *(scan+g) = (uint16_t)(opacity * (rgba32->component2 * 257) + (1 - opacity) * options->background48.component2);
-        *(scan+b) = (uint16_t)(opacity * (rgba32->component3 * 257) + (1 - opacity) * options->background48.component3);
+    if (a < 0 && rgba32->component4 < 255 && blend_alpha(options)) {
+        *(scan+r) = blend8_to16(rgba32->component1, options->background48.component1, rgba32->component4);
+        *(scan+g) = blend8_to16(rgba32->component2, options->background48.component2, rgba32->component4);
+        *(scan+b) = blend8_to16(rgba32->component3, options->background48.component3, rgba32->component4);
     } else {
         *(scan+r) = rgba32->component1 * 257;
         *(scan+g) = rgba32->component2 * 257;
@@ -284,12 +279,10 @@ void fill_rgba64_pixel_from_uint8_values(const sail_rgba32_t *rgba32, uint16_t *
 
 void fill_rgba64_pixel_from_uint16_values(const sail_rgba64_t *rgba64, uint16_t *scan, int r, int g, int b, int a, const struct sail_conversion_options *options) {
 
-    if (a < 0 && rgba64->component4 < 65535 && options != NULL && (options->options & SAIL_CONVERSION_OPTION_BLEND_ALPHA)) {
-        const double opacity = rgba64->component4 / 65535.0;
-
-        *(scan+r) = (uint16_t)(opacity * rgba64->component1 + (1 - opacity) * options->background48.component1);
-        *(scan+g) = (uint16_t)(opacity * rgba64->component2 + (1 - opacity) * options->background48.component2);
-        *(scan+b) = (uint16_t)(opacity * rgba64->component3 + (1 - opacity) * options->background48.component3);
+    if (a < 0 && rgba64->component4 < 65535 && blend_alpha(options)) {
+        *(scan+r) = blend16(rgba64->component1, options->background48.component1, rgba64->component4);
+        *(scan+g) = blend16(rgba64->component2, options->background48.component2, rgba64->component4);
+        *(scan+b) = blend16(rgba64->component3, options->background48.component3, rgba64->component4);
     } else {
         *(scan+r) = rgba64->component1;
         *(scan+g) = rgba64->component2;
@@ -305,12 +298,10 @@ void fill_ycbcr_pixel_from_uint8_values(const sail_rgba32_t *rgba32, uint8_t *sc
 
     sail_rgba32_t rgba32_no_alpha;
 
-    if (rgba32->component4 < 255 && options != NULL && (options->options & SAIL_CONVERSION_OPTION_BLEND_ALPHA)) {
-        const double opacity = rgba32->component4 / 255.0;
-
-        rgba32_no_alpha.component1 = (uint8_t)(opacity * rgba32->component1 + (1 - opacity) * options->background24.component1);
-        rgba32_no_alpha.component2 = (uint8_t)(opacity * rgba32->component2 + (1 - opacity) * options->background24.component2);
-        rgba32_no_alpha.component3 = (uint8_t)(opacity * rgba32->component3 + (1 - opacity) * options->background24.component3);
+    if (rgba32->component4 < 255 && blend_alpha(options)) {
+        rgba32_no_alpha.component1 = blend8(rgba32->component1, options->background24.component1, rgba32->component4);
+        rgba32_no_alpha.component2 = blend8(rgba32->component2, options->background24.component2, rgba32->component4);
+        rgba32_no_alpha.component3 = blend8(rgba32->component3, options->background24.component3, rgba32->component4);
     } else {
         rgba32_no_alpha = *rgba32;
     }
@@ -322,17 +313,59 @@ void fill_ycbcr_pixel_from_uint16_values(const sail_rgba64_t *rgba64, uint8_t *s
 
     sail_rgba32_t rgba32_no_alpha;
 
-    if (rgba64->component4 < 65535 && options != NULL && (options->options & SAIL_CONVERSION_OPTION_BLEND_ALPHA)) {
-        const double opacity = rgba64->component4 / 65535.0;
-
-        rgba32_no_alpha.component1 = (uint8_t)((opacity * rgba64->component1 + (1 - opacity) * options->background48.component1) / 257.0);
-        rgba32_no_alpha.component2 = (uint8_t)((opacity * rgba64->component2 + (1 - opacity) * options->background48.component2) / 257.0);
-        rgba32_no_alpha.component3 = (uint8_t)((opacity * rgba64->component3 + (1 - opacity) * options->background48.component3) / 257.0);
+    if (rgba64->component4 < 65535 && blend_alpha(options)) {
+        rgba32_no_alpha.component1 = (uint8_t)(blend16(rgba64->component1, options->background48.component1, rgba64->component4) / 257);
+        rgba32_no_alpha.component2 = (uint8_t)(blend16(rgba64->component2, options->background48.component2, rgba64->component4) / 257);
+        rgba32_no_alpha.component3 = (uint8_t)(blend16(rgba64->component3, options->background48.component3, rgba64->component4) / 257);
     } else {
-        rgba32_no_alpha.component1 = (uint8_t)(rgba64->component1 / 257.0);
-        rgba32_no_alpha.component2 = (uint8_t)(rgba64->component2 / 257.0);
-        rgba32_no_alpha.component3 = (uint8_t)(rgba64->component3 / 257.0);
+        rgba32_no_alpha.component1 = (uint8_t)(rgba64->component1 / 257);
+        rgba32_no_alpha.component2 = (uint8_t)(rgba64->component2 / 257);
+        rgba32_no_alpha.component3 = (uint8_t)(rgba64->component3 / 257);
     }
 
     convert_rgba32_to_ycbcr24(&rgba32_no_alpha, scan+0, scan+1, scan+2);
 }
+
+void fill_rgb24_scan_from_rgba32_scan(const uint8_t *scan_input, int ri, int gi, int bi, int ai,
+                                        uint8_t *scan_output, int r, int g, int b, int output_pixel_size,
+                                        unsigned width, const sail_rgb24_t *background) {
+
+    const uint32_t bg1 = background->component1;
+    const uint32_t bg2 = background->component2;
+    const uint32_t bg3 = background->component3;
+
+    /* Opaque spans are copied as is. The blending formula is exact for alpha 255 anyway. */
+    unsigned column = 0;
+
+    while (column < width) {
+        unsigned span_end = column;
+
+        while (span_end < width && scan_input[span_end * 4 + ai] == 255) {
+            span_end++;
+        }
+
+        for (; column < span_end; column++) {
+            const uint8_t *pixel_input = scan_input + column * 4;
+            uint8_t *pixel_output = scan_output + column * output_pixel_size;
+
+            pixel_output[r] = pixel_input[ri];
+            pixel_output[g] = pixel_input[gi];
+            pixel_output[b] = pixel_input[bi];
+        }
+
+        while (span_end < width && scan_input[span_end * 4 + ai] < 255) {
+            span_end++;
+        }
+
+        /* Branch-free, so the compiler is able to vectorize it. */
+        for (; column < span_end; column++) {
+            const uint8_t *pixel_input = scan_input + column * 4;
+            uint8_t *pixel_output = scan_output + column * output_pixel_size;
+            const uint32_t alpha = pixel_input[ai];
+
+            pixel_output[r] = blend8(pixel_input[ri], bg1, alpha);
+            pixel_output[g] = blend8(pixel_input[gi], bg2, alpha);
+            pixel_output[b] = blend8(pixel_input[bi], bg3, alpha);
+        }
+    }
+}
@@ -72,4 +72,12 @@ SAIL_HIDDEN void fill_ycbcr_pixel_from_uint8_values(const sail_rgba32_t *rgba32,
 
 SAIL_HIDDEN void fill_ycbcr_pixel_from_uint16_values(const sail_rgba64_t *rgba64, uint8_t *scan, const struct sail_conversion_options *options);
 
+/*
+ * Blends a whole scan line of 32-bit pixels with alpha onto the background and stores the RGB components
+ * into the output scan line with the specified output pixel size in bytes.
+ */
+SAIL_HIDDEN void fill_rgb24_scan_from_rgba32_scan(const uint8_t *scan_input, int ri, int gi, int bi, int ai,
+                                                    uint8_t *scan_output, int r, int g, int b, int output_pixel_size,
+                                                    unsigned width, const sail_rgb24_t *background);
+
 #endif
@@ -0,0 +1,285 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdint.h>
+
+#include <sail-manip/sail-manip.h>
+
+/*
+ * c * a / 255 and c * a / 65535 rounded to the nearest integer without divisions.
+ */
+static inline uint8_t mul_div255(unsigned c, unsigned a) {
+
+    const unsigned t = c * a + 128;
+    return (uint8_t)((t + (t >> 8)) >> 8);
+}
+
+static inline uint16_t mul_div65535(uint32_t c, uint32_t a) {
+
+    const uint32_t t = c * a + 32768;
+    return (uint16_t)((t + (t >> 16)) >> 16);
+}
+
+/*
+ * 255 / a in 16.16 fixed point. One division per pixel instead of three.
+ */
+static inline unsigned reciprocal8(unsigned a) {
+
+    return ((255u << 16) + a / 2) / a;
+}
+
+static inline uint8_t unpremultiply8(unsigned c, unsigned reciprocal) {
+
+    const unsigned value = (c * reciprocal + 32768) >> 16;
+    return (uint8_t)(value > 255 ? 255 : value);
+}
+
+static inline uint16_t unpremultiply16(uint32_t c, uint32_t a) {
+
+    const uint64_t value = ((uint64_t)c * 65535 + a / 2) / a;
+    return (uint16_t)(value > 65535 ? 65535 : value);
+}
+
+/*
+ * Returns the alpha index and the pixel size of the RGBA formats, and whether
+ * the format is premultiplied.
+ */
+static bool rgba_layout(enum SailPixelFormat pixel_format, enum SailPixelFormat *straight_pixel_format, bool *premultiplied, bool *rgba64, int *ai) {
+
+    switch (pixel_format) {
+        case SAIL_PIXEL_FORMAT_BPP32_RGBA:
+        case SAIL_PIXEL_FORMAT_BPP32_BGRA:
+        case SAIL_PIXEL_FORMAT_BPP32_ARGB:
+        case SAIL_PIXEL_FORMAT_BPP32_ABGR:
+        case SAIL_PIXEL_FORMAT_BPP64_RGBA:
+        case SAIL_PIXEL_FORMAT_BPP64_BGRA:
+        case SAIL_PIXEL_FORMAT_BPP64_ARGB:
+        case SAIL_PIXEL_FORMAT_BPP64_ABGR: {
+            *straight_pixel_format = pixel_format;
+            *premultiplied = false;
+            break;
+        }
+
+        case SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED: { *straight_pixel_format = SAIL_PIXEL_FORMAT_BPP32_RGBA; *premultiplied = true; break; }
+        case SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED: { *straight_pixel_format = SAIL_PIXEL_FORMAT_BPP32_BGRA; *premultiplied = true; break; }
+        case SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED: { *straight_pixel_format = SAIL_PIXEL_FORMAT_BPP32_ARGB; *premultiplied = true; break; }
+        case SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED: { *straight_pixel_format = SAIL_PIXEL_FORMAT_BPP32_ABGR; *premultiplied = true; break; }
+        case SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED: { *straight_pixel_format = SAIL_PIXEL_FORMAT_BPP64_RGBA; *premultiplied = true; break; }
+        case SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED: { *straight_pixel_format = SAIL_PIXEL_FORMAT_BPP64_BGRA; *premultiplied = true; break; }
+        case SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED: { *straight_pixel_format = SAIL_PIXEL_FORMAT_BPP64_ARGB; *premultiplied = true; break; }
+        case SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED: { *straight_pixel_format = SAIL_PIXEL_FORMAT_BPP64_ABGR; *premultiplied = true; break; }
+
+        default: {
+            return false;
+        }
+    }
+
+    switch (*straight_pixel_format) {
+        case SAIL_PIXEL_FORMAT_BPP32_RGBA:
+        case SAIL_PIXEL_FORMAT_BPP32_BGRA: { *rgba64 = false; *ai = 3; break; }
+        case SAIL_PIXEL_FORMAT_BPP32_ARGB:
+        case SAIL_PIXEL_FORMAT_BPP32_ABGR: { *rgba64 = false; *ai = 0; break; }
+        case SAIL_PIXEL_FORMAT_BPP64_RGBA:
+        case SAIL_PIXEL_FORMAT_BPP64_BGRA: { *rgba64 = true;  *ai = 3; break; }
+        default:                           { *rgba64 = true;  *ai = 0; break; }
+    }
+
+    return true;
+}
+
+/*
+ * Scan line kernels. The color components occupy the three slots next to alpha.
+ */
+static void premultiply_rgba32_scan(const uint8_t *scan_input, uint8_t *scan_output, unsigned width, int ai) {
+
+    const int ci = (ai == 0) ? 1 : 0;
+
+    for (unsigned column = 0; column < width; column++, scan_input += 4, scan_output += 4) {
+        const unsigned a = scan_input[ai];
+
+        scan_output[ci]   = mul_div255(scan_input[ci],   a);
+        scan_output[ci+1] = mul_div255(scan_input[ci+1], a);
+        scan_output[ci+2] = mul_div255(scan_input[ci+2], a);
+        scan_output[ai]   = (uint8_t)a;
+    }
+}
+
+static void unpremultiply_rgba32_scan(const uint8_t *scan_input, uint8_t *scan_output, unsigned width, int ai) {
+
+    const int ci = (ai == 0) ? 1 : 0;
+
+    for (unsigned column = 0; column < width; column++, scan_input += 4, scan_output += 4) {
+        const unsigned a = scan_input[ai];
+
+        if (a == 0) {
+            scan_output[ci] = scan_output[ci+1] = scan_output[ci+2] = 0;
+        } else {
+            const unsigned reciprocal = reciprocal8(a);
+
+            scan_output[ci]   = unpremultiply8(scan_input[ci],   reciprocal);
+            scan_output[ci+1] = unpremultiply8(scan_input[ci+1], reciprocal);
+            scan_output[ci+2] = unpremultiply8(scan_input[ci+2], reciprocal);
+        }
+
+        scan_output[ai] = (uint8_t)a;
+    }
+}
+
+static void premultiply_rgba64_scan(const uint16_t *scan_input, uint16_t *scan_output, unsigned width, int ai) {
+
+    const int ci = (ai == 0) ? 1 : 0;
+
+    for (unsigned column = 0; column < width; column++, scan_input += 4, scan_output += 4) {
+        const uint32_t a = scan_input[ai];
+
+        scan_output[ci]   = mul_div65535(scan_input[ci],   a);
+        scan_output[ci+1] = mul_div65535(scan_input[ci+1], a);
+        scan_output[ci+2] = mul_div65535(scan_input[ci+2], a);
+        scan_output[ai]   = (uint16_t)a;
+    }
+}
+
+static void unpremultiply_rgba64_scan(const uint16_t *scan_input, uint16_t *scan_output, unsigned width, int ai) {
+
+    const int ci = (ai == 0) ? 1 : 0;
+
+    for (unsigned column = 0; column < width; column++, scan_input += 4, scan_output += 4) {
+        const uint32_t a = scan_input[ai];
+
+        if (a == 0) {
+            scan_output[ci] = scan_output[ci+1] = scan_output[ci+2] = 0;
+        } else {
+            scan_output[ci]   = unpremultiply16(scan_input[ci],   a);
+            scan_output[ci+1] = unpremultiply16(scan_input[ci+1], a);
+            scan_output[ci+2] = unpremultiply16(scan_input[ci+2], a);
+        }
+
+        scan_output[ai] = (uint16_t)a;
+    }
+}
+
+/*
+ * Public functions.
+ */
+
+void premultiply_rgba32_pixel(uint8_t *pixel, int r, int g, int b, int a) {
+
+    const unsigned alpha = pixel[a];
+
+    pixel[r] = mul_div255(pixel[r], alpha);
+    pixel[g] = mul_div255(pixel[g], alpha);
+    pixel[b] = mul_div255(pixel[b], alpha);
+}
+
+void premultiply_rgba64_pixel(uint16_t *pixel, int r, int g, int b, int a) {
+
+    const uint32_t alpha = pixel[a];
+
+    pixel[r] = mul_div65535(pixel[r], alpha);
+    pixel[g] = mul_div65535(pixel[g], alpha);
+    pixel[b] = mul_div65535(pixel[b], alpha);
+}
+
+void unpremultiply_rgba32_values(sail_rgba32_t *rgba32) {
+
+    const unsigned alpha = rgba32->component4;
+
+    if (alpha == 0) {
+        rgba32->component1 = rgba32->component2 = rgba32->component3 = 0;
+    } else if (alpha < 255) {
+        const unsigned reciprocal = reciprocal8(alpha);
+
+        rgba32->component1 = unpremultiply8(rgba32->component1, reciprocal);
+        rgba32->component2 = unpremultiply8(rgba32->component2, reciprocal);
+        rgba32->component3 = unpremultiply8(rgba32->component3, reciprocal);
+    }
+}
+
+void unpremultiply_rgba64_values(sail_rgba64_t *rgba64) {
+
+    const uint32_t alpha = rgba64->component4;
+
+    if (alpha == 0) {
+        rgba64->component1 = rgba64->component2 = rgba64->component3 = 0;
+    } else if (alpha < 65535) {
+        rgba64->component1 = unpremultiply16(rgba64->component1, alpha);
+        rgba64->component2 = unpremultiply16(rgba64->component2, alpha);
+        rgba64->component3 = unpremultiply16(rgba64->component3, alpha);
+    }
+}
+
+bool can_toggle_premultiplied_alpha(enum SailPixelFormat input_pixel_format, enum SailPixelFormat output_pixel_format) {
+
+    enum SailPixelFormat input_straight_pixel_format;
+    enum SailPixelFormat output_straight_pixel_format;
+    bool input_premultiplied;
+    bool output_premultiplied;
+    bool rgba64;
+    int ai;
+
+    if (!rgba_layout(input_pixel_format, &input_straight_pixel_format, &input_premultiplied, &rgba64, &ai) ||
+            !rgba_layout(output_pixel_format, &output_straight_pixel_format, &output_premultiplied, &rgba64, &ai)) {
+        return false;
+    }
+
+    return input_straight_pixel_format == output_straight_pixel_format && input_premultiplied != output_premultiplied;
+}
+
+sail_status_t toggle_premultiplied_alpha(const struct sail_image *image, struct sail_image *image_output) {
+
+    SAIL_CHECK_PTR(image);
+    SAIL_CHECK_PTR(image_output);
+
+    enum SailPixelFormat straight_pixel_format;
+    bool premultiplied;
+    bool rgba64;
+    int ai;
+
+    if (!rgba_layout(image->pixel_format, &straight_pixel_format, &premultiplied, &rgba64, &ai)) {
+        SAIL_LOG_ERROR("Cannot toggle premultiplied alpha of %s", sail_pixel_format_to_string(image->pixel_format));
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    }
+
+    unsigned row;
+
+    #pragma omp parallel for schedule(SAIL_OPENMP_SCHEDULE)
+    for (row = 0; row < image->height; row++) {
+        if (rgba64) {
+            if (premultiplied) {
+                unpremultiply_rgba64_scan(sail_scan_line(image, row), sail_scan_line(image_output, row), image->width, ai);
+            } else {
+                premultiply_rgba64_scan(sail_scan_line(image, row), sail_scan_line(image_output, row), image->width, ai);
+            }
+        } else {
+            if (premultiplied) {
+                unpremultiply_rgba32_scan(sail_scan_line(image, row), sail_scan_line(image_output, row), image->width, ai);
+            } else {
+                premultiply_rgba32_scan(sail_scan_line(image, row), sail_scan_line(image_output, row), image->width, ai);
+            }
+        }
+    }
+
+    return SAIL_OK;
+}
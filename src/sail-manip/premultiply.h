@@ -0,0 +1,73 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_PREMULTIPLY_H
+#define SAIL_PREMULTIPLY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <sail-common/common.h>
+#include <sail-common/export.h>
+#include <sail-common/status.h>
+
+#include <sail-common/pixel.h>
+
+struct sail_image;
+
+/*
+ * Premultiplies the color components of the 8-bit pixel by its alpha.
+ */
+SAIL_HIDDEN void premultiply_rgba32_pixel(uint8_t *pixel, int r, int g, int b, int a);
+
+/*
+ * Premultiplies the color components of the 16-bit pixel by its alpha.
+ */
+SAIL_HIDDEN void premultiply_rgba64_pixel(uint16_t *pixel, int r, int g, int b, int a);
+
+/*
+ * Divides the premultiplied color components by alpha. Fully transparent pixels become black.
+ */
+SAIL_HIDDEN void unpremultiply_rgba32_values(sail_rgba32_t *rgba32);
+
+/*
+ * Divides the premultiplied color components by alpha. Fully transparent pixels become black.
+ */
+SAIL_HIDDEN void unpremultiply_rgba64_values(sail_rgba64_t *rgba64);
+
+/*
+ * Returns true if the pixel formats differ in alpha premultiplication only, e.g. BPP32-RGBA
+ * and BPP32-RGBA-PREMULTIPLIED.
+ */
+SAIL_HIDDEN bool can_toggle_premultiplied_alpha(enum SailPixelFormat input_pixel_format, enum SailPixelFormat output_pixel_format);
+
+/*
+ * Unpremultiplies premultiplied pixels and premultiplies straight pixels into the output image
+ * scan line by scan line. The output image must have its pixels allocated. It may be the input
+ * image itself. See can_toggle_premultiplied_alpha().
+ */
+SAIL_HIDDEN sail_status_t toggle_premultiplied_alpha(const struct sail_image *image, struct sail_image *image_output);
+
+#endif
@@ -0,0 +1,1211 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sail-manip/sail-manip.h>
+
+/* Open addressing hash table to collect unique colors. Power of two, at least twice larger than 256. */
+#define EXACT_TABLE_SIZE 1024
+
+/* 5-5-5-3 bits of R, G, B, and A. */
+#define HISTOGRAM_SIZE (1 << 18)
+
+/* Cells of 8x8x8 RGB values and 4 alpha ranges to look up nearest palette colors. */
+#define CELLS_COUNT (1 << 17)
+
+/* Marks cells which scan the whole palette as there was no memory for their candidates. */
+#define CELL_ALL_COLORS UINT32_MAX
+
+#define KMEANS_MAX_ITERATIONS 8
+
+/* The octree splits colors by their 4 most significant bits. */
+#define OCTREE_DEPTH 4
+
+struct color_entry {
+    uint8_t c[4];
+    uint32_t count;
+};
+
+struct exact_color {
+    uint32_t key;
+    int index;
+};
+
+struct histogram_bin {
+    uint64_t sum[4];
+    uint32_t count;
+};
+
+struct box {
+    unsigned start;
+    unsigned end;
+    double error;
+    int channel;
+};
+
+struct octree_node {
+    uint64_t sum[4];
+    uint64_t count;
+    int children[16];
+    unsigned level;
+    bool leaf;
+};
+
+/*
+ * Lists of palette colors that may be the nearest to any color in a cell. Cells are filled
+ * when they're hit for the first time, so the lists are not shared between threads.
+ */
+struct nearest_cells {
+    const uint8_t (*colors)[4];
+    unsigned color_count;
+    uint32_t *offsets;
+    uint16_t *counts;
+    uint8_t *candidates;
+    size_t candidates_size;
+    size_t candidates_capacity;
+};
+
+static const uint8_t BAYER8[8][8] = {
+    {  0, 32,  8, 40,  2, 34, 10, 42 },
+    { 48, 16, 56, 24, 50, 18, 58, 26 },
+    { 12, 44,  4, 36, 14, 46,  6, 38 },
+    { 60, 28, 52, 20, 62, 30, 54, 22 },
+    {  3, 35, 11, 43,  1, 33,  9, 41 },
+    { 51, 19, 59, 27, 49, 17, 57, 25 },
+    { 15, 47,  7, 39, 13, 45,  5, 37 },
+    { 63, 31, 55, 23, 61, 29, 53, 21 },
+};
+
+static inline uint32_t pack_color(const uint8_t c[4]) {
+
+    return (uint32_t)c[0] | ((uint32_t)c[1] << 8) | ((uint32_t)c[2] << 16) | ((uint32_t)c[3] << 24);
+}
+
+static inline uint32_t hash_color(uint32_t key) {
+
+    return key * 2654435761u;
+}
+
+static inline uint8_t clamp_uint8(int value) {
+
+    return (uint8_t)(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+static inline void fetch_pixel(const uint8_t *scan, unsigned bytes_per_pixel, unsigned column, uint8_t c[4]) {
+
+    const uint8_t *pixel = scan + (size_t)column * bytes_per_pixel;
+
+    c[0] = pixel[0];
+    c[1] = pixel[1];
+    c[2] = pixel[2];
+    c[3] = (bytes_per_pixel == 4) ? pixel[3] : 255;
+}
+
+/* Fully transparent pixels are all the same for lossy palettes. */
+static inline void fetch_normalized_pixel(const uint8_t *scan, unsigned bytes_per_pixel, unsigned column, uint8_t c[4]) {
+
+    fetch_pixel(scan, bytes_per_pixel, column, c);
+
+    if (c[3] == 0) {
+        c[0] = c[1] = c[2] = 0;
+    }
+}
+
+/* Stores the index MSB-first. The scan line must be zeroed for bit depths less than 8. */
+static inline void store_index(uint8_t *scan, unsigned bits, unsigned column, unsigned index) {
+
+    if (bits == 8) {
+        scan[column] = (uint8_t)index;
+    } else {
+        const unsigned pixels_per_byte = 8 / bits;
+        const unsigned shift = 8 - bits * (column % pixels_per_byte + 1);
+
+        scan[column / pixels_per_byte] |= (uint8_t)(index << shift);
+    }
+}
+
+static inline unsigned fetch_index(const uint8_t *scan, unsigned bits, unsigned column) {
+
+    if (bits == 8) {
+        return scan[column];
+    } else {
+        const unsigned pixels_per_byte = 8 / bits;
+        const unsigned shift = 8 - bits * (column % pixels_per_byte + 1);
+
+        return (scan[column / pixels_per_byte] >> shift) & ((1u << bits) - 1);
+    }
+}
+
+/*
+ * Unique colors.
+ */
+
+/* Returns the slot of the color, or the empty slot to insert it into. */
+static inline unsigned find_exact_color(const struct exact_color *table, uint32_t key) {
+
+    unsigned slot = hash_color(key) >> (32 - 10);
+
+    while (table[slot].index >= 0 && table[slot].key != key) {
+        slot = (slot + 1) & (EXACT_TABLE_SIZE - 1);
+    }
+
+    return slot;
+}
+
+/* Returns false if the image has more than max_colors unique colors. */
+static bool collect_exact_colors(const struct sail_image *image, unsigned bytes_per_pixel, unsigned max_colors,
+                                    struct exact_color *table, uint8_t colors[256][4], unsigned *color_count) {
+
+    for (unsigned i = 0; i < EXACT_TABLE_SIZE; i++) {
+        table[i].index = -1;
+    }
+
+    unsigned count = 0;
+    uint32_t last_key = 0;
+    bool has_last_key = false;
+
+    for (unsigned row = 0; row < image->height; row++) {
+        const uint8_t *scan = sail_scan_line(image, row);
+
+        for (unsigned column = 0; column < image->width; column++) {
+            uint8_t c[4];
+            fetch_pixel(scan, bytes_per_pixel, column, c);
+
+            const uint32_t key = pack_color(c);
+
+            /* Runs of the same color are common. */
+            if (has_last_key && key == last_key) {
+                continue;
+            }
+
+            last_key = key;
+            has_last_key = true;
+
+            const unsigned slot = find_exact_color(table, key);
+
+            if (table[slot].index < 0) {
+                if (count == max_colors) {
+                    return false;
+                }
+
+                table[slot].key   = key;
+                table[slot].index = (int)count;
+                memcpy(colors[count], c, 4);
+                count++;
+            }
+        }
+    }
+
+    *color_count = count;
+
+    return true;
+}
+
+static void map_exact_colors(const struct sail_image *image, unsigned bytes_per_pixel,
+                                const struct exact_color *table, struct sail_image *image_output) {
+
+    const unsigned bits = sail_bits_per_pixel(image_output->pixel_format);
+    unsigned row;
+
+    #pragma omp parallel for schedule(SAIL_OPENMP_SCHEDULE)
+    for (row = 0; row < image->height; row++) {
+        const uint8_t *scan_input = sail_scan_line(image, row);
+        uint8_t *scan_output = sail_scan_line(image_output, row);
+
+        memset(scan_output, 0, image_output->bytes_per_line);
+
+        for (unsigned column = 0; column < image->width; column++) {
+            uint8_t c[4];
+            fetch_pixel(scan_input, bytes_per_pixel, column, c);
+
+            store_index(scan_output, bits, column, (unsigned)table[find_exact_color(table, pack_color(c))].index);
+        }
+    }
+}
+
+/*
+ * Histogram.
+ */
+
+static sail_status_t build_histogram(const struct sail_image *image, unsigned bytes_per_pixel,
+                                        struct color_entry **entries, unsigned *entries_count) {
+
+    void *ptr;
+    SAIL_TRY(sail_calloc(HISTOGRAM_SIZE, sizeof(struct histogram_bin), &ptr));
+    struct histogram_bin *bins = ptr;
+
+    for (unsigned row = 0; row < image->height; row++) {
+        const uint8_t *scan = sail_scan_line(image, row);
+
+        for (unsigned column = 0; column < image->width; column++) {
+            uint8_t c[4];
+            fetch_normalized_pixel(scan, bytes_per_pixel, column, c);
+
+            struct histogram_bin *bin = bins + (((unsigned)(c[0] >> 3) << 13) | ((unsigned)(c[1] >> 3) << 8) |
+                                                ((unsigned)(c[2] >> 3) << 3)  | (unsigned)(c[3] >> 5));
+
+            bin->sum[0] += c[0];
+            bin->sum[1] += c[1];
+            bin->sum[2] += c[2];
+            bin->sum[3] += c[3];
+            bin->count++;
+        }
+    }
+
+    unsigned count = 0;
+
+    for (unsigned i = 0; i < HISTOGRAM_SIZE; i++) {
+        if (bins[i].count > 0) {
+            count++;
+        }
+    }
+
+    SAIL_TRY_OR_CLEANUP(sail_malloc(sizeof(struct color_entry) * count, &ptr),
+                        /* cleanup */ sail_free(bins));
+    struct color_entry *entries_local = ptr;
+
+    count = 0;
+
+    for (unsigned i = 0; i < HISTOGRAM_SIZE; i++) {
+        const struct histogram_bin *bin = bins + i;
+
+        if (bin->count > 0) {
+            for (unsigned channel = 0; channel < 4; channel++) {
+                entries_local[count].c[channel] = (uint8_t)((bin->sum[channel] + bin->count / 2) / bin->count);
+            }
+
+            entries_local[count].count = bin->count;
+            count++;
+        }
+    }
+
+    sail_free(bins);
+
+    *entries = entries_local;
+    *entries_count = count;
+
+    return SAIL_OK;
+}
+
+/*
+ * Median cut.
+ */
+
+#define DEFINE_CHANNEL_COMPARATOR(channel)                                               \
+    static int compare_entries_by_channel##channel(const void *a, const void *b) {      \
+        return (int)((const struct color_entry *)a)->c[channel] -                        \
+                (int)((const struct color_entry *)b)->c[channel];                        \
+    }
+
+DEFINE_CHANNEL_COMPARATOR(0)
+DEFINE_CHANNEL_COMPARATOR(1)
+DEFINE_CHANNEL_COMPARATOR(2)
+DEFINE_CHANNEL_COMPARATOR(3)
+
+static int (* const CHANNEL_COMPARATORS[4])(const void *, const void *) = {
+    compare_entries_by_channel0,
+    compare_entries_by_channel1,
+    compare_entries_by_channel2,
+    compare_entries_by_channel3,
+};
+
+/* Calculates the squared error of the box and the channel with the largest variance. */
+static void measure_box(const struct color_entry *entries, struct box *box) {
+
+    double sum[4] = { 0 };
+    double sum2[4] = { 0 };
+    double count = 0;
+
+    for (unsigned i = box->start; i < box->end; i++) {
+        const double weight = entries[i].count;
+
+        for (unsigned channel = 0; channel < 4; channel++) {
+            sum[channel]  += weight * entries[i].c[channel];
+            sum2[channel] += weight * entries[i].c[channel] * entries[i].c[channel];
+        }
+
+        count += weight;
+    }
+
+    box->error = 0;
+    box->channel = 0;
+
+    if (box->end - box->start < 2) {
+        return;
+    }
+
+    double largest_error = -1;
+
+    for (unsigned channel = 0; channel < 4; channel++) {
+        const double error = sum2[channel] - sum[channel] * sum[channel] / count;
+
+        box->error += error;
+
+        if (error > largest_error) {
+            largest_error = error;
+            box->channel = (int)channel;
+        }
+    }
+}
+
+static void weighted_mean(const struct color_entry *entries, unsigned start, unsigned end, uint8_t c[4]) {
+
+    uint64_t sum[4] = { 0 };
+    uint64_t count = 0;
+
+    for (unsigned i = start; i < end; i++) {
+        for (unsigned channel = 0; channel < 4; channel++) {
+            sum[channel] += (uint64_t)entries[i].c[channel] * entries[i].count;
+        }
+
+        count += entries[i].count;
+    }
+
+    for (unsigned channel = 0; channel < 4; channel++) {
+        c[channel] = (uint8_t)((sum[channel] + count / 2) / count);
+    }
+}
+
+static void median_cut(struct color_entry *entries, unsigned entries_count, unsigned max_colors,
+                        uint8_t colors[256][4], unsigned *color_count) {
+
+    struct box boxes[256];
+    unsigned boxes_count = 1;
+
+    boxes[0].start = 0;
+    boxes[0].end = entries_count;
+    measure_box(entries, &boxes[0]);
+
+    while (boxes_count < max_colors) {
+        unsigned worst = 0;
+
+        for (unsigned i = 1; i < boxes_count; i++) {
+            if (boxes[i].error > boxes[worst].error) {
+                worst = i;
+            }
+        }
+
+        struct box *box = &boxes[worst];
+
+        if (box->error <= 0) {
+            break;
+        }
+
+        qsort(entries + box->start, box->end - box->start, sizeof(struct color_entry), CHANNEL_COMPARATORS[box->channel]);
+
+        uint64_t total = 0;
+        for (unsigned i = box->start; i < box->end; i++) {
+            total += entries[i].count;
+        }
+
+        /* Split at the weighted median, and keep both halves non-empty. */
+        unsigned split = box->start + 1;
+        uint64_t accumulated = entries[box->start].count;
+
+        while (split < box->end - 1 && accumulated * 2 < total) {
+            accumulated += entries[split].count;
+            split++;
+        }
+
+        struct box *new_box = &boxes[boxes_count++];
+
+        new_box->start = split;
+        new_box->end = box->end;
+        box->end = split;
+
+        measure_box(entries, box);
+        measure_box(entries, new_box);
+    }
+
+    for (unsigned i = 0; i < boxes_count; i++) {
+        weighted_mean(entries, boxes[i].start, boxes[i].end, colors[i]);
+    }
+
+    *color_count = boxes_count;
+}
+
+/*
+ * Octree.
+ */
+
+static sail_status_t add_octree_node(struct octree_node **nodes, unsigned *nodes_count, unsigned *nodes_capacity, unsigned level) {
+
+    if (*nodes_count == *nodes_capacity) {
+        void *ptr = *nodes;
+        SAIL_TRY(sail_realloc(sizeof(struct octree_node) * (*nodes_capacity) * 2, &ptr));
+        *nodes = ptr;
+        *nodes_capacity *= 2;
+    }
+
+    struct octree_node *node = *nodes + *nodes_count;
+
+    memset(node, 0, sizeof(struct octree_node));
+
+    for (unsigned i = 0; i < 16; i++) {
+        node->children[i] = -1;
+    }
+
+    node->level = level;
+    node->leaf = (level == OCTREE_DEPTH);
+
+    (*nodes_count)++;
+
+    return SAIL_OK;
+}
+
+/* Sorts the level nodes by their pixel count with the insertion sort. */
+static void sort_octree_level(unsigned *level_nodes, unsigned level_nodes_count, const struct octree_node *nodes) {
+
+    for (unsigned i = 1; i < level_nodes_count; i++) {
+        const unsigned node = level_nodes[i];
+        unsigned k = i;
+
+        while (k > 0 && nodes[level_nodes[k - 1]].count > nodes[node].count) {
+            level_nodes[k] = level_nodes[k - 1];
+            k--;
+        }
+
+        level_nodes[k] = node;
+    }
+}
+
+/* Merges the specified number of the least populated leaf children of the node into one. */
+static void merge_octree_children(struct octree_node *nodes, struct octree_node *node, unsigned count) {
+
+    unsigned slots[16];
+    unsigned slots_count = 0;
+
+    for (unsigned child = 0; child < 16; child++) {
+        if (node->children[child] >= 0) {
+            const unsigned slot = child;
+            unsigned k = slots_count++;
+
+            while (k > 0 && nodes[node->children[slots[k - 1]]].count > nodes[node->children[slot]].count) {
+                slots[k] = slots[k - 1];
+                k--;
+            }
+
+            slots[k] = slot;
+        }
+    }
+
+    struct octree_node *target = &nodes[node->children[slots[0]]];
+
+    for (unsigned i = 1; i < count; i++) {
+        const struct octree_node *source = &nodes[node->children[slots[i]]];
+
+        for (unsigned channel = 0; channel < 4; channel++) {
+            target->sum[channel] += source->sum[channel];
+        }
+
+        target->count += source->count;
+        node->children[slots[i]] = -1;
+    }
+}
+
+static sail_status_t octree(const struct color_entry *entries, unsigned entries_count, unsigned max_colors,
+                            uint8_t colors[256][4], unsigned *color_count) {
+
+    unsigned nodes_count = 0;
+    unsigned nodes_capacity = 4096;
+
+    void *ptr;
+    SAIL_TRY(sail_malloc(sizeof(struct octree_node) * nodes_capacity, &ptr));
+    struct octree_node *nodes = ptr;
+
+    SAIL_TRY_OR_CLEANUP(add_octree_node(&nodes, &nodes_count, &nodes_capacity, 0),
+                        /* cleanup */ sail_free(nodes));
+
+    unsigned leaves_count = 0;
+
+    for (unsigned i = 0; i < entries_count; i++) {
+        const struct color_entry *entry = entries + i;
+        unsigned node = 0;
+
+        for (unsigned level = 0; ; level++) {
+            for (unsigned channel = 0; channel < 4; channel++) {
+                nodes[node].sum[channel] += (uint64_t)entry->c[channel] * entry->count;
+            }
+
+            nodes[node].count += entry->count;
+
+            if (level == OCTREE_DEPTH) {
+                break;
+            }
+
+            const unsigned bit = 7 - level;
+            const unsigned child = (((entry->c[0] >> bit) & 1u) << 3) | (((entry->c[1] >> bit) & 1u) << 2) |
+                                    (((entry->c[2] >> bit) & 1u) << 1) | ((entry->c[3] >> bit) & 1u);
+
+            if (nodes[node].children[child] < 0) {
+                SAIL_TRY_OR_CLEANUP(add_octree_node(&nodes, &nodes_count, &nodes_capacity, level + 1),
+                                    /* cleanup */ sail_free(nodes));
+                nodes[node].children[child] = (int)(nodes_count - 1);
+
+                if (level + 1 == OCTREE_DEPTH) {
+                    leaves_count++;
+                }
+            }
+
+            node = (unsigned)nodes[node].children[child];
+        }
+    }
+
+    /* Merge the least populated nodes into their parents level by level from the bottom. */
+    SAIL_TRY_OR_CLEANUP(sail_malloc(sizeof(unsigned) * nodes_count, &ptr),
+                        /* cleanup */ sail_free(nodes));
+    unsigned *level_nodes = ptr;
+
+    for (unsigned level = OCTREE_DEPTH; level-- > 0 && leaves_count > max_colors;) {
+        unsigned level_nodes_count = 0;
+
+        for (unsigned i = 0; i < nodes_count; i++) {
+            if (nodes[i].level == level) {
+                level_nodes[level_nodes_count++] = i;
+            }
+        }
+
+        sort_octree_level(level_nodes, level_nodes_count, nodes);
+
+        for (unsigned i = 0; i < level_nodes_count && leaves_count > max_colors; i++) {
+            struct octree_node *node = &nodes[level_nodes[i]];
+            unsigned children = 0;
+
+            for (unsigned child = 0; child < 16; child++) {
+                if (node->children[child] >= 0) {
+                    children++;
+                }
+            }
+
+            if (leaves_count - (children - 1) < max_colors) {
+                /* Merging all the children would leave less colors than allowed. */
+                merge_octree_children(nodes, node, leaves_count - max_colors + 1);
+                leaves_count = max_colors;
+            } else {
+                node->leaf = true;
+                leaves_count -= children - 1;
+            }
+        }
+    }
+
+    /* Collect the leaves. */
+    unsigned stack_count = 0;
+    unsigned count = 0;
+
+    level_nodes[stack_count++] = 0;
+
+    while (stack_count > 0) {
+        const struct octree_node *node = &nodes[level_nodes[--stack_count]];
+
+        if (node->leaf) {
+            for (unsigned channel = 0; channel < 4; channel++) {
+                colors[count][channel] = (uint8_t)((node->sum[channel] + node->count / 2) / node->count);
+            }
+
+            count++;
+        } else {
+            for (unsigned child = 0; child < 16; child++) {
+                if (node->children[child] >= 0) {
+                    level_nodes[stack_count++] = (unsigned)node->children[child];
+                }
+            }
+        }
+    }
+
+    sail_free(level_nodes);
+    sail_free(nodes);
+
+    *color_count = count;
+
+    return SAIL_OK;
+}
+
+/*
+ * Nearest color search.
+ */
+
+static const uint8_t ALL_COLORS[256] = {
+      0,   1,   2,   3,   4,   5,   6,   7,   8,   9,  10,  11,  12,  13,  14,  15,
+     16,  17,  18,  19,  20,  21,  22,  23,  24,  25,  26,  27,  28,  29,  30,  31,
+     32,  33,  34,  35,  36,  37,  38,  39,  40,  41,  42,  43,  44,  45,  46,  47,
+     48,  49,  50,  51,  52,  53,  54,  55,  56,  57,  58,  59,  60,  61,  62,  63,
+     64,  65,  66,  67,  68,  69,  70,  71,  72,  73,  74,  75,  76,  77,  78,  79,
+     80,  81,  82,  83,  84,  85,  86,  87,  88,  89,  90,  91,  92,  93,  94,  95,
+     96,  97,  98,  99, 100, 101, 102, 103, 104, 105, 106, 107, 108, 109, 110, 111,
+    112, 113, 114, 115, 116, 117, 118, 119, 120, 121, 122, 123, 124, 125, 126, 127,
+    128, 129, 130, 131, 132, 133, 134, 135, 136, 137, 138, 139, 140, 141, 142, 143,
+    144, 145, 146, 147, 148, 149, 150, 151, 152, 153, 154, 155, 156, 157, 158, 159,
+    160, 161, 162, 163, 164, 165, 166, 167, 168, 169, 170, 171, 172, 173, 174, 175,
+    176, 177, 178, 179, 180, 181, 182, 183, 184, 185, 186, 187, 188, 189, 190, 191,
+    192, 193, 194, 195, 196, 197, 198, 199, 200, 201, 202, 203, 204, 205, 206, 207,
+    208, 209, 210, 211, 212, 213, 214, 215, 216, 217, 218, 219, 220, 221, 222, 223,
+    224, 225, 226, 227, 228, 229, 230, 231, 232, 233, 234, 235, 236, 237, 238, 239,
+    240, 241, 242, 243, 244, 245, 246, 247, 248, 249, 250, 251, 252, 253, 254, 255,
+};
+
+/* Fully transparent and opaque colors are the most common, so they get exact alpha ranges. */
+static const int CELL_ALPHA_LOW[4]  = { 0,   1, 128, 255 };
+static const int CELL_ALPHA_HIGH[4] = { 0, 127, 254, 255 };
+
+static void destroy_nearest_cells(struct nearest_cells *cells) {
+
+    sail_free(cells->candidates);
+    sail_free(cells->counts);
+    sail_free(cells->offsets);
+}
+
+static sail_status_t alloc_nearest_cells(const uint8_t colors[256][4], unsigned color_count, struct nearest_cells *cells) {
+
+    cells->colors              = colors;
+    cells->color_count         = color_count;
+    cells->offsets             = NULL;
+    cells->counts              = NULL;
+    cells->candidates          = NULL;
+    cells->candidates_size     = 0;
+    cells->candidates_capacity = 0;
+
+    void *ptr;
+    SAIL_TRY(sail_malloc(sizeof(uint32_t) * CELLS_COUNT, &ptr));
+    cells->offsets = ptr;
+
+    SAIL_TRY_OR_CLEANUP(sail_calloc(CELLS_COUNT, sizeof(uint16_t), &ptr),
+                        /* cleanup */ destroy_nearest_cells(cells));
+    cells->counts = ptr;
+
+    return SAIL_OK;
+}
+
+static inline unsigned color_distance(const uint8_t a[4], const uint8_t b[4]) {
+
+    const int d0 = a[0] - b[0];
+    const int d1 = a[1] - b[1];
+    const int d2 = a[2] - b[2];
+    const int d3 = a[3] - b[3];
+
+    return (unsigned)(d0 * d0 + d1 * d1 + d2 * d2 + d3 * d3);
+}
+
+static inline unsigned cell_index(const uint8_t c[4]) {
+
+    const unsigned alpha = (c[3] == 255) ? 3 : ((c[3] == 0) ? 0 : ((c[3] < 128) ? 1 : 2));
+
+    return ((unsigned)(c[0] >> 3) << 12) | ((unsigned)(c[1] >> 3) << 7) | ((unsigned)(c[2] >> 3) << 2) | alpha;
+}
+
+static bool reserve_candidates(struct nearest_cells *cells, unsigned count) {
+
+    if (cells->candidates_size + count <= cells->candidates_capacity) {
+        return true;
+    }
+
+    size_t capacity = (cells->candidates_capacity == 0) ? 65536 : cells->candidates_capacity * 2;
+
+    while (capacity < cells->candidates_size + count) {
+        capacity *= 2;
+    }
+
+    void *ptr = cells->candidates;
+
+    if (sail_realloc(capacity, &ptr) != SAIL_OK) {
+        return false;
+    }
+
+    cells->candidates = ptr;
+    cells->candidates_capacity = capacity;
+
+    return true;
+}
+
+/*
+ * Any color in the cell is not farther from its nearest palette color than the smallest
+ * distance from a palette color to the farthest cell corner. Keeps the palette colors which
+ * are closer to the cell than that, sorted by their distances to the cell.
+ */
+static void fill_cell(struct nearest_cells *cells, unsigned cell) {
+
+    const int low[4]  = { (int)((cell >> 12) & 31) << 3, (int)((cell >> 7) & 31) << 3, (int)((cell >> 2) & 31) << 3, CELL_ALPHA_LOW[cell & 3] };
+    const int high[4] = { low[0] + 7, low[1] + 7, low[2] + 7, CELL_ALPHA_HIGH[cell & 3] };
+
+    unsigned nearest_distances[256];
+    unsigned threshold = UINT_MAX;
+
+    for (unsigned i = 0; i < cells->color_count; i++) {
+        unsigned nearest_distance = 0;
+        unsigned farthest_distance = 0;
+
+        for (unsigned channel = 0; channel < 4; channel++) {
+            const int value = cells->colors[i][channel];
+            const int nearest = (value < low[channel]) ? (low[channel] - value) : ((value > high[channel]) ? (value - high[channel]) : 0);
+            const int farthest = (value - low[channel] > high[channel] - value) ? (value - low[channel]) : (high[channel] - value);
+
+            nearest_distance += (unsigned)(nearest * nearest);
+            farthest_distance += (unsigned)(farthest * farthest);
+        }
+
+        nearest_distances[i] = nearest_distance;
+
+        if (farthest_distance < threshold) {
+            threshold = farthest_distance;
+        }
+    }
+
+    unsigned count = 0;
+
+    for (unsigned i = 0; i < cells->color_count; i++) {
+        if (nearest_distances[i] <= threshold) {
+            count++;
+        }
+    }
+
+    /* Scan the whole palette rather than fail in the middle of mapping. */
+    if (!reserve_candidates(cells, count)) {
+        cells->offsets[cell] = CELL_ALL_COLORS;
+        cells->counts[cell] = (uint16_t)cells->color_count;
+        return;
+    }
+
+    uint8_t *candidates = cells->candidates + cells->candidates_size;
+    count = 0;
+
+    /* Insertion sort, the lists are short. */
+    for (unsigned i = 0; i < cells->color_count; i++) {
+        if (nearest_distances[i] > threshold) {
+            continue;
+        }
+
+        unsigned position = count++;
+
+        for (; position > 0 && nearest_distances[candidates[position - 1]] > nearest_distances[i]; position--) {
+            candidates[position] = candidates[position - 1];
+        }
+
+        candidates[position] = (uint8_t)i;
+    }
+
+    cells->offsets[cell] = (uint32_t)cells->candidates_size;
+    cells->counts[cell] = (uint16_t)count;
+    cells->candidates_size += count;
+}
+
+static inline unsigned find_nearest_color(struct nearest_cells *cells, const uint8_t c[4]) {
+
+    const unsigned cell = cell_index(c);
+
+    if (cells->counts[cell] == 0) {
+        fill_cell(cells, cell);
+    }
+
+    const uint8_t *candidates = (cells->offsets[cell] == CELL_ALL_COLORS) ? ALL_COLORS : cells->candidates + cells->offsets[cell];
+    const unsigned count = cells->counts[cell];
+
+    unsigned best = candidates[0];
+    unsigned best_distance = color_distance(cells->colors[best], c);
+
+    for (unsigned i = 1; i < count && best_distance > 0; i++) {
+        const unsigned distance = color_distance(cells->colors[candidates[i]], c);
+
+        if (distance < best_distance) {
+            best_distance = distance;
+            best = candidates[i];
+        }
+    }
+
+    return best;
+}
+
+/*
+ * K-means.
+ */
+
+static sail_status_t kmeans(const struct color_entry *entries, unsigned entries_count, uint8_t colors[256][4], unsigned color_count) {
+
+    for (unsigned iteration = 0; iteration < KMEANS_MAX_ITERATIONS; iteration++) {
+        uint64_t sum[256][4] = { { 0 } };
+        uint64_t count[256] = { 0 };
+
+        struct nearest_cells cells;
+        SAIL_TRY(alloc_nearest_cells(colors, color_count, &cells));
+
+        for (unsigned i = 0; i < entries_count; i++) {
+            const unsigned index = find_nearest_color(&cells, entries[i].c);
+
+            for (unsigned channel = 0; channel < 4; channel++) {
+                sum[index][channel] += (uint64_t)entries[i].c[channel] * entries[i].count;
+            }
+
+            count[index] += entries[i].count;
+        }
+
+        destroy_nearest_cells(&cells);
+
+        bool changed = false;
+
+        for (unsigned i = 0; i < color_count; i++) {
+            if (count[i] == 0) {
+                continue;
+            }
+
+            for (unsigned channel = 0; channel < 4; channel++) {
+                const uint8_t value = (uint8_t)((sum[i][channel] + count[i] / 2) / count[i]);
+
+                if (value != colors[i][channel]) {
+                    colors[i][channel] = value;
+                    changed = true;
+                }
+            }
+        }
+
+        if (!changed) {
+            break;
+        }
+    }
+
+    return SAIL_OK;
+}
+
+/*
+ * Mapping.
+ */
+
+/* Dithering amplitude. Smaller palettes need stronger dithering. */
+static int ordered_dithering_spread(unsigned bits) {
+
+    switch (bits) {
+        case 1:  return 128;
+        case 2:  return 96;
+        case 4:  return 64;
+        default: return 32;
+    }
+}
+
+static sail_status_t map_colors(const struct sail_image *image, unsigned bytes_per_pixel, enum SailDithering dithering,
+                                const uint8_t colors[256][4], unsigned color_count, struct sail_image *image_output) {
+
+    const unsigned bits = sail_bits_per_pixel(image_output->pixel_format);
+    const int spread = ordered_dithering_spread(bits);
+
+    sail_status_t status = SAIL_OK;
+
+    #pragma omp parallel shared(status)
+    {
+        struct nearest_cells cells;
+        const sail_status_t cells_status = alloc_nearest_cells(colors, color_count, &cells);
+
+        if (cells_status != SAIL_OK) {
+            #pragma omp critical
+            status = cells_status;
+        }
+
+        unsigned row;
+
+        #pragma omp for schedule(SAIL_OPENMP_SCHEDULE)
+        for (row = 0; row < image->height; row++) {
+            if (cells_status != SAIL_OK) {
+                continue;
+            }
+
+            const uint8_t *scan_input = sail_scan_line(image, row);
+            uint8_t *scan_output = sail_scan_line(image_output, row);
+
+            memset(scan_output, 0, image_output->bytes_per_line);
+
+            for (unsigned column = 0; column < image->width; column++) {
+                uint8_t c[4];
+                fetch_normalized_pixel(scan_input, bytes_per_pixel, column, c);
+
+                if (dithering == SAIL_DITHERING_ORDERED && c[3] > 0) {
+                    const int offset = ((2 * BAYER8[row & 7][column & 7] + 1 - 64) * spread) / 128;
+
+                    c[0] = clamp_uint8(c[0] + offset);
+                    c[1] = clamp_uint8(c[1] + offset);
+                    c[2] = clamp_uint8(c[2] + offset);
+                }
+
+                store_index(scan_output, bits, column, find_nearest_color(&cells, c));
+            }
+        }
+
+        if (cells_status == SAIL_OK) {
+            destroy_nearest_cells(&cells);
+        }
+    }
+
+    if (status != SAIL_OK) {
+        SAIL_LOG_AND_RETURN(status);
+    }
+
+    return SAIL_OK;
+}
+
+/* Floyd-Steinberg error diffusion of RGB components. Runs sequentially as every row depends on the previous one. */
+static sail_status_t map_colors_floyd_steinberg(const struct sail_image *image, unsigned bytes_per_pixel,
+                                                const uint8_t colors[256][4], unsigned color_count,
+                                                struct sail_image *image_output) {
+
+    const unsigned bits = sail_bits_per_pixel(image_output->pixel_format);
+    const size_t errors_length = ((size_t)image->width + 2) * 3;
+
+    /* Errors are stored multiplied by 16. */
+    void *ptr;
+    SAIL_TRY(sail_calloc(errors_length * 2, sizeof(int), &ptr));
+    int *errors = ptr;
+    int *current_errors = errors;
+    int *next_errors = errors + errors_length;
+
+    struct nearest_cells cells;
+    SAIL_TRY_OR_CLEANUP(alloc_nearest_cells(colors, color_count, &cells),
+                        /* cleanup */ sail_free(errors));
+
+    for (unsigned row = 0; row < image->height; row++) {
+        const uint8_t *scan_input = sail_scan_line(image, row);
+        uint8_t *scan_output = sail_scan_line(image_output, row);
+
+        memset(scan_output, 0, image_output->bytes_per_line);
+        memset(next_errors, 0, errors_length * sizeof(int));
+
+        for (unsigned column = 0; column < image->width; column++) {
+            uint8_t c[4];
+            fetch_normalized_pixel(scan_input, bytes_per_pixel, column, c);
+
+            /* Transparent pixels neither receive nor spread errors. */
+            if (c[3] == 0) {
+                store_index(scan_output, bits, column, find_nearest_color(&cells, c));
+                continue;
+            }
+
+            int *error = current_errors + ((size_t)column + 1) * 3;
+
+            for (unsigned channel = 0; channel < 3; channel++) {
+                c[channel] = clamp_uint8(c[channel] + error[channel] / 16);
+            }
+
+            const unsigned index = find_nearest_color(&cells, c);
+            store_index(scan_output, bits, column, index);
+
+            int *next_error = next_errors + (size_t)column * 3;
+
+            for (unsigned channel = 0; channel < 3; channel++) {
+                const int diff = c[channel] - colors[index][channel];
+
+                error[3 + channel]      += diff * 7;
+                next_error[channel]     += diff * 3;
+                next_error[3 + channel] += diff * 5;
+                next_error[6 + channel] += diff;
+            }
+        }
+
+        int *tmp = current_errors;
+        current_errors = next_errors;
+        next_errors = tmp;
+    }
+
+    destroy_nearest_cells(&cells);
+    sail_free(errors);
+
+    return SAIL_OK;
+}
+
+static sail_status_t map_colors_with_dithering(const struct sail_image *image, unsigned bytes_per_pixel, enum SailDithering dithering,
+                                                const uint8_t colors[256][4], unsigned color_count, struct sail_image *image_output) {
+
+    if (dithering == SAIL_DITHERING_FLOYD_STEINBERG) {
+        SAIL_TRY(map_colors_floyd_steinberg(image, bytes_per_pixel, colors, color_count, image_output));
+    } else {
+        SAIL_TRY(map_colors(image, bytes_per_pixel, dithering, colors, color_count, image_output));
+    }
+
+    return SAIL_OK;
+}
+
+static sail_status_t build_palette(const uint8_t colors[256][4], unsigned color_count, struct sail_palette **palette) {
+
+    bool has_alpha = false;
+
+    for (unsigned i = 0; i < color_count; i++) {
+        if (colors[i][3] != 255) {
+            has_alpha = true;
+            break;
+        }
+    }
+
+    const unsigned bytes_per_color = has_alpha ? 4 : 3;
+
+    struct sail_palette *palette_local;
+    SAIL_TRY(sail_alloc_palette_for_data(has_alpha ? SAIL_PIXEL_FORMAT_BPP32_RGBA : SAIL_PIXEL_FORMAT_BPP24_RGB,
+                                            color_count, &palette_local));
+
+    uint8_t *data = palette_local->data;
+
+    for (unsigned i = 0; i < color_count; i++) {
+        memcpy(data + (size_t)i * bytes_per_color, colors[i], bytes_per_color);
+    }
+
+    *palette = palette_local;
+
+    return SAIL_OK;
+}
+
+static sail_status_t quantize_to_new_palette(const struct sail_image *image, unsigned bytes_per_pixel, unsigned max_colors,
+                                                enum SailQuantizationAlgorithm algorithm, enum SailDithering dithering,
+                                                uint8_t colors[256][4], unsigned *color_count,
+                                                struct sail_image *image_output) {
+
+    /* Lossless palette when the image has few colors. */
+    void *ptr;
+    SAIL_TRY(sail_malloc(sizeof(struct exact_color) * EXACT_TABLE_SIZE, &ptr));
+    struct exact_color *table = ptr;
+
+    if (collect_exact_colors(image, bytes_per_pixel, max_colors, table, colors, color_count)) {
+        map_exact_colors(image, bytes_per_pixel, table, image_output);
+        sail_free(table);
+        return SAIL_OK;
+    }
+
+    sail_free(table);
+
+    struct color_entry *entries;
+    unsigned entries_count;
+    SAIL_TRY(build_histogram(image, bytes_per_pixel, &entries, &entries_count));
+
+    switch (algorithm) {
+        case SAIL_QUANTIZATION_ALGORITHM_OCTREE: {
+            SAIL_TRY_OR_CLEANUP(octree(entries, entries_count, max_colors, colors, color_count),
+                                /* cleanup */ sail_free(entries));
+            break;
+        }
+        case SAIL_QUANTIZATION_ALGORITHM_KMEANS: {
+            median_cut(entries, entries_count, max_colors, colors, color_count);
+            SAIL_TRY_OR_CLEANUP(kmeans(entries, entries_count, colors, *color_count),
+                                /* cleanup */ sail_free(entries));
+            break;
+        }
+        default: {
+            median_cut(entries, entries_count, max_colors, colors, color_count);
+            break;
+        }
+    }
+
+    sail_free(entries);
+
+    SAIL_TRY(map_colors_with_dithering(image, bytes_per_pixel, dithering, colors, *color_count, image_output));
+
+    return SAIL_OK;
+}
+
+static sail_status_t quantize_to_fixed_palette(const struct sail_image *image, unsigned bytes_per_pixel, unsigned max_colors,
+                                                const struct sail_palette *palette, enum SailDithering dithering,
+                                                struct sail_image *image_output) {
+
+    if (palette->color_count == 0 || palette->color_count > max_colors) {
+        SAIL_LOG_ERROR("Palette with %u colors doesn't fit into %s", palette->color_count, sail_pixel_format_to_string(image_output->pixel_format));
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_INVALID_ARGUMENT);
+    }
+
+    uint8_t colors[256][4];
+
+    for (unsigned i = 0; i < palette->color_count; i++) {
+        sail_rgba32_t rgba32;
+        SAIL_TRY(get_palette_rgba32(palette, i, &rgba32));
+
+        colors[i][0] = rgba32.component1;
+        colors[i][1] = rgba32.component2;
+        colors[i][2] = rgba32.component3;
+        colors[i][3] = rgba32.component4;
+    }
+
+    SAIL_TRY(map_colors_with_dithering(image, bytes_per_pixel, dithering, (const uint8_t (*)[4])colors, palette->color_count, image_output));
+
+    return SAIL_OK;
+}
+
+/*
+ * Public functions.
+ */
+
+bool can_repack_indexes(const struct sail_image *image, enum SailPixelFormat output_pixel_format) {
+
+    return sail_is_indexed(image->pixel_format) &&
+            image->palette != NULL &&
+            image->palette->color_count <= (1u << sail_bits_per_pixel(output_pixel_format));
+}
+
+sail_status_t repack_indexes(const struct sail_image *image, struct sail_image *image_output) {
+
+    const unsigned input_bits = sail_bits_per_pixel(image->pixel_format);
+    const unsigned output_bits = sail_bits_per_pixel(image_output->pixel_format);
+    const unsigned max_index = image->palette->color_count - 1;
+
+    for (unsigned row = 0; row < image->height; row++) {
+        const uint8_t *scan_input = sail_scan_line(image, row);
+        uint8_t *scan_output = sail_scan_line(image_output, row);
+
+        memset(scan_output, 0, image_output->bytes_per_line);
+
+        for (unsigned column = 0; column < image->width; column++) {
+            const unsigned index = fetch_index(scan_input, input_bits, column);
+
+            if (index > max_index) {
+                SAIL_LOG_ERROR("Palette index %u is out of range [0; %u)", index, image->palette->color_count);
+                SAIL_LOG_AND_RETURN(SAIL_ERROR_BROKEN_IMAGE);
+            }
+
+            store_index(scan_output, output_bits, column, index);
+        }
+    }
+
+    return SAIL_OK;
+}
+
+sail_status_t quantize_image(const struct sail_image *image, const struct sail_conversion_options *options, struct sail_image *image_output) {
+
+    const unsigned bytes_per_pixel = (image->pixel_format == SAIL_PIXEL_FORMAT_BPP32_RGBA) ? 4 : 3;
+    const unsigned max_colors = 1u << sail_bits_per_pixel(image_output->pixel_format);
+
+    const enum SailQuantizationAlgorithm algorithm = (options == NULL) ? SAIL_QUANTIZATION_ALGORITHM_MEDIAN_CUT : options->quantization;
+    const enum SailDithering dithering = (options == NULL) ? SAIL_DITHERING_NONE : options->dithering;
+    const struct sail_palette *fixed_palette = (options == NULL) ? NULL : options->palette;
+
+    struct sail_palette *palette;
+
+    if (fixed_palette != NULL) {
+        SAIL_TRY(quantize_to_fixed_palette(image, bytes_per_pixel, max_colors, fixed_palette, dithering, image_output));
+        SAIL_TRY(sail_copy_palette(fixed_palette, &palette));
+    } else {
+        uint8_t colors[256][4];
+        unsigned color_count;
+
+        SAIL_TRY(quantize_to_new_palette(image, bytes_per_pixel, max_colors, algorithm, dithering, colors, &color_count, image_output));
+        SAIL_TRY(build_palette((const uint8_t (*)[4])colors, color_count, &palette));
+    }
+
+    sail_destroy_palette(image_output->palette);
+    image_output->palette = palette;
+
+    return SAIL_OK;
+}
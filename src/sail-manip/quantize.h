@@ -0,0 +1,58 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_QUANTIZE_H
+#define SAIL_QUANTIZE_H
+
+#include <stdbool.h>
+
+#include <sail-common/common.h>
+#include <sail-common/export.h>
+#include <sail-common/status.h>
+
+struct sail_conversion_options;
+struct sail_image;
+
+/*
+ * Returns true if the indexes of the indexed image can be repacked into the indexed output pixel
+ * format as is, i.e. when the output pixel format is able to address all the palette colors.
+ */
+SAIL_HIDDEN bool can_repack_indexes(const struct sail_image *image, enum SailPixelFormat output_pixel_format);
+
+/*
+ * Repacks the indexes of the indexed image into the indexed output image. The output image
+ * must have its pixels allocated. See can_repack_indexes().
+ */
+SAIL_HIDDEN sail_status_t repack_indexes(const struct sail_image *image, struct sail_image *image_output);
+
+/*
+ * Quantizes the BPP24-RGB or BPP32-RGBA pixels of the input image into the indexed output image.
+ * The output image must have its pixels allocated. Builds a new palette with the algorithm
+ * from the options, or maps the pixels to the fixed palette from the options. Options may be NULL.
+ * Replaces the output image palette.
+ */
+SAIL_HIDDEN sail_status_t quantize_image(const struct sail_image *image, const struct sail_conversion_options *options, struct sail_image *image_output);
+
+#endif
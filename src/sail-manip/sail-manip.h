@@ -36,9 +36,13 @@
 
 #ifdef SAIL_BUILD
     #include <sail-manip/cmyk.h>
+    #include <sail-manip/color_transform.h>
     #include <sail-manip/manip_utils.h>
+    #include <sail-manip/premultiply.h>
+    #include <sail-manip/quantize.h>
     #include <sail-manip/ycbcr.h>
     #include <sail-manip/ycck.h>
+    #include <sail-manip/yuv.h>
 #endif
 
 #endif
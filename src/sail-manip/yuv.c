@@ -0,0 +1,194 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdint.h>
+#include <string.h>
+
+#include <sail-manip/sail-manip.h>
+
+/*
+ * Full-range BT.601 (JFIF) coefficients scaled by 65536 like that:
+ *
+ *    Y  =  0.299000 * R + 0.587000 * G + 0.114000 * B
+ *    Cb = -0.168736 * R - 0.331264 * G + 0.500000 * B + 128
+ *    Cr =  0.500000 * R - 0.418688 * G - 0.081312 * B + 128
+ *
+ * The coefficients of every row sum up to 65536 or 0, so the results never leave [0; 255].
+ * Plain integer math lets compilers vectorize the loops below.
+ */
+#define Y_R   19595
+#define Y_G   38470
+#define Y_B    7471
+#define CB_R -11059
+#define CB_G -21709
+#define CB_B  32768
+#define CR_R  32768
+#define CR_G -27439
+#define CR_B  -5329
+
+/* 128 << 16 plus rounding. */
+#define CHROMA_BIAS 8421376
+#define ROUNDING    32768
+
+sail_status_t convert_rgb_kind_to_planar_yuv(const struct sail_image *image, unsigned bytes_per_pixel, int ri, int gi, int bi, struct sail_image *image_output) {
+
+    struct sail_plane planes[3];
+    unsigned planes_count;
+    SAIL_TRY(sail_image_planes(image_output, planes, &planes_count));
+
+    const bool nv12                    = image_output->pixel_format == SAIL_PIXEL_FORMAT_BPP12_NV12;
+    const unsigned chroma_step         = nv12 ? 2 : 1;
+    const unsigned rows_per_chroma_row = (planes[1].height == image->height) ? 1 : 2;
+
+    unsigned chroma_row;
+
+    #pragma omp parallel for schedule(SAIL_OPENMP_SCHEDULE)
+    for (chroma_row = 0; chroma_row < planes[1].height; chroma_row++) {
+        const unsigned first_row = chroma_row * rows_per_chroma_row;
+        const unsigned rows      = (first_row + rows_per_chroma_row <= image->height) ? rows_per_chroma_row : 1;
+
+        /* Luma. */
+        for (unsigned row = first_row; row < first_row + rows; row++) {
+            const uint8_t *scan_input = sail_scan_line(image, row);
+            uint8_t *scan_y = (uint8_t *)planes[0].pixels + (size_t)row * planes[0].bytes_per_line;
+
+            for (unsigned column = 0; column < image->width; column++) {
+                const uint8_t *pixel = scan_input + (size_t)column * bytes_per_pixel;
+
+                scan_y[column] = (uint8_t)((Y_R * pixel[ri] + Y_G * pixel[gi] + Y_B * pixel[bi] + ROUNDING) >> 16);
+            }
+        }
+
+        /* Chroma from the averaged block of RGB pixels. */
+        uint8_t *scan_u = (uint8_t *)planes[1].pixels + (size_t)chroma_row * planes[1].bytes_per_line;
+        uint8_t *scan_v = nv12 ? scan_u + 1 : (uint8_t *)planes[2].pixels + (size_t)chroma_row * planes[2].bytes_per_line;
+
+        for (unsigned chroma_column = 0; chroma_column < planes[1].width; chroma_column++) {
+            const unsigned first_column = chroma_column * 2;
+            const unsigned columns      = (first_column + 2 <= image->width) ? 2 : 1;
+            const int count             = (int)(rows * columns);
+
+            int r = 0, g = 0, b = 0;
+
+            for (unsigned row = first_row; row < first_row + rows; row++) {
+                const uint8_t *pixel = (const uint8_t *)sail_scan_line(image, row) + (size_t)first_column * bytes_per_pixel;
+
+                for (unsigned column = 0; column < columns; column++, pixel += bytes_per_pixel) {
+                    r += pixel[ri];
+                    g += pixel[gi];
+                    b += pixel[bi];
+                }
+            }
+
+            r = (r + count / 2) / count;
+            g = (g + count / 2) / count;
+            b = (b + count / 2) / count;
+
+            scan_u[chroma_column * chroma_step] = (uint8_t)((CB_R * r + CB_G * g + CB_B * b + CHROMA_BIAS) >> 16);
+            scan_v[chroma_column * chroma_step] = (uint8_t)((CR_R * r + CR_G * g + CR_B * b + CHROMA_BIAS) >> 16);
+        }
+    }
+
+    return SAIL_OK;
+}
+
+bool can_rearrange_planar_yuv(enum SailPixelFormat input_pixel_format, enum SailPixelFormat output_pixel_format) {
+
+    if (input_pixel_format == output_pixel_format) {
+        return sail_is_planar(input_pixel_format);
+    }
+
+    return (input_pixel_format == SAIL_PIXEL_FORMAT_BPP12_YUV420P && output_pixel_format == SAIL_PIXEL_FORMAT_BPP12_NV12) ||
+           (input_pixel_format == SAIL_PIXEL_FORMAT_BPP12_NV12    && output_pixel_format == SAIL_PIXEL_FORMAT_BPP12_YUV420P);
+}
+
+sail_status_t rearrange_planar_yuv(const struct sail_image *image, struct sail_image *image_output) {
+
+    if (!can_rearrange_planar_yuv(image->pixel_format, image_output->pixel_format)) {
+        SAIL_LOG_ERROR("Cannot rearrange %s into %s", sail_pixel_format_to_string(image->pixel_format),
+                        sail_pixel_format_to_string(image_output->pixel_format));
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    }
+
+    struct sail_plane input_planes[3];
+    struct sail_plane output_planes[3];
+    unsigned input_planes_count;
+    unsigned output_planes_count;
+
+    SAIL_TRY(sail_image_planes(image, input_planes, &input_planes_count));
+    SAIL_TRY(sail_image_planes(image_output, output_planes, &output_planes_count));
+
+    /* Planes of the same format are copied as is. */
+    if (image->pixel_format == image_output->pixel_format) {
+        for (unsigned i = 0; i < input_planes_count; i++) {
+            const unsigned bytes_to_copy = (input_planes[i].bytes_per_line < output_planes[i].bytes_per_line)
+                                                ? input_planes[i].bytes_per_line
+                                                : output_planes[i].bytes_per_line;
+
+            for (unsigned row = 0; row < input_planes[i].height; row++) {
+                memcpy((uint8_t *)output_planes[i].pixels + (size_t)row * output_planes[i].bytes_per_line,
+                       (const uint8_t *)input_planes[i].pixels + (size_t)row * input_planes[i].bytes_per_line,
+                       bytes_to_copy);
+            }
+        }
+
+        return SAIL_OK;
+    }
+
+    for (unsigned row = 0; row < image->height; row++) {
+        memcpy((uint8_t *)output_planes[0].pixels + (size_t)row * output_planes[0].bytes_per_line,
+               (const uint8_t *)input_planes[0].pixels + (size_t)row * input_planes[0].bytes_per_line,
+               image->width);
+    }
+
+    const bool to_nv12 = image_output->pixel_format == SAIL_PIXEL_FORMAT_BPP12_NV12;
+
+    unsigned chroma_row;
+
+    #pragma omp parallel for schedule(SAIL_OPENMP_SCHEDULE)
+    for (chroma_row = 0; chroma_row < input_planes[1].height; chroma_row++) {
+        if (to_nv12) {
+            const uint8_t *scan_u = (const uint8_t *)input_planes[1].pixels + (size_t)chroma_row * input_planes[1].bytes_per_line;
+            const uint8_t *scan_v = (const uint8_t *)input_planes[2].pixels + (size_t)chroma_row * input_planes[2].bytes_per_line;
+            uint8_t *scan_uv      = (uint8_t *)output_planes[1].pixels + (size_t)chroma_row * output_planes[1].bytes_per_line;
+
+            for (unsigned column = 0; column < input_planes[1].width; column++) {
+                scan_uv[column * 2 + 0] = scan_u[column];
+                scan_uv[column * 2 + 1] = scan_v[column];
+            }
+        } else {
+            const uint8_t *scan_uv = (const uint8_t *)input_planes[1].pixels + (size_t)chroma_row * input_planes[1].bytes_per_line;
+            uint8_t *scan_u        = (uint8_t *)output_planes[1].pixels + (size_t)chroma_row * output_planes[1].bytes_per_line;
+            uint8_t *scan_v        = (uint8_t *)output_planes[2].pixels + (size_t)chroma_row * output_planes[2].bytes_per_line;
+
+            for (unsigned column = 0; column < input_planes[1].width; column++) {
+                scan_u[column] = scan_uv[column * 2 + 0];
+                scan_v[column] = scan_uv[column * 2 + 1];
+            }
+        }
+    }
+
+    return SAIL_OK;
+}
@@ -0,0 +1,55 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_YUV_H
+#define SAIL_YUV_H
+
+#include <stdbool.h>
+
+#include <sail-common/common.h>
+#include <sail-common/export.h>
+#include <sail-common/status.h>
+
+struct sail_image;
+
+/*
+ * Converts 8-bit RGB pixels with the specified pixel size and component indexes into the planar
+ * YUV pixels of the output image. The output image must have its pixels allocated.
+ */
+SAIL_HIDDEN sail_status_t convert_rgb_kind_to_planar_yuv(const struct sail_image *image, unsigned bytes_per_pixel, int ri, int gi, int bi, struct sail_image *image_output);
+
+/*
+ * Returns true if the planar YUV pixels can be rearranged into the output planar pixel format
+ * without converting to RGB, i.e. between I420 and NV12.
+ */
+SAIL_HIDDEN bool can_rearrange_planar_yuv(enum SailPixelFormat input_pixel_format, enum SailPixelFormat output_pixel_format);
+
+/*
+ * Rearranges the planar YUV pixels into the planar pixels of the output image. The output image
+ * must have its pixels allocated. See can_rearrange_planar_yuv().
+ */
+SAIL_HIDDEN sail_status_t rearrange_planar_yuv(const struct sail_image *image, struct sail_image *image_output);
+
+#endif
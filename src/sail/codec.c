@@ -134,11 +134,28 @@ static sail_status_t load_codec_from_file(const struct sail_codec_info *codec_in
     SAIL_RESOLVE(codec->v8->load_frame,           handle, sail_codec_load_frame_v8,           codec_info->name);
     SAIL_RESOLVE(codec->v8->load_finish,          handle, sail_codec_load_finish_v8,          codec_info->name);
 
+    if (codec_info->load_features->features & SAIL_CODEC_FEATURE_FRAME_SEEK) {
+        SAIL_RESOLVE(codec->v8->load_seek_to_frame, handle, sail_codec_load_seek_to_frame_v8, codec_info->name);
+    } else {
+        codec->v8->load_seek_to_frame = NULL;
+    }
+
     SAIL_RESOLVE(codec->v8->save_init,            handle, sail_codec_save_init_v8,            codec_info->name);
     SAIL_RESOLVE(codec->v8->save_seek_next_frame, handle, sail_codec_save_seek_next_frame_v8, codec_info->name);
     SAIL_RESOLVE(codec->v8->save_frame,           handle, sail_codec_save_frame_v8,           codec_info->name);
     SAIL_RESOLVE(codec->v8->save_finish,          handle, sail_codec_save_finish_v8,          codec_info->name);
 
+    /* Optional. Codecs without process-wide resources don't export it. */
+    {
+        char *full_symbol_name;
+        SAIL_TRY(sail_concat(&full_symbol_name, 3, "sail_codec_release_v8", "_", codec_info->name));
+        sail_to_lower(full_symbol_name);
+
+        codec->v8->release = (sail_codec_release_v8_t)SAIL_RESOLVE_FUNC(handle, full_symbol_name);
+
+        sail_free(full_symbol_name);
+    }
+
     return SAIL_OK;
 }
 
@@ -185,6 +202,8 @@ sail_status_t alloc_and_load_codec(const struct sail_codec_info *codec_info, str
     SAIL_TRY_OR_CLEANUP(sail_malloc(sizeof(struct sail_codec_layout_v8), &ptr),
                         /* cleanup */ destroy_codec(codec_local));
     codec_local->v8 = ptr;
+    /* destroy_codec() calls it. Make sure it's valid if fetching the functions fails. */
+    codec_local->v8->release = NULL;
 
 #ifdef SAIL_COMBINE_CODECS
     if (fetch_combined_codec) {
@@ -210,6 +229,12 @@ void destroy_codec(struct sail_codec *codec) {
         return;
     }
 
+    if (codec->v8 != NULL && codec->v8->release != NULL) {
+        if (codec->v8->release() != SAIL_OK) {
+            SAIL_LOG_WARNING("Failed to release the codec resources");
+        }
+    }
+
     if (codec->handle != NULL) {
 #ifdef SAIL_WIN32
         FreeLibrary((HMODULE)codec->handle);
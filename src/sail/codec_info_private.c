@@ -324,28 +324,6 @@ static sail_status_t check_codec_info(const struct sail_codec_info *codec_info)
     return SAIL_OK;
 }
 
-static sail_status_t alloc_codec_info(struct sail_codec_info **codec_info) {
-
-    SAIL_CHECK_PTR(codec_info);
-
-    void *ptr;
-    SAIL_TRY(sail_malloc(sizeof(struct sail_codec_info), &ptr));
-    *codec_info = ptr;
-
-    (*codec_info)->path              = NULL;
-    (*codec_info)->layout            = 0;
-    (*codec_info)->version           = NULL;
-    (*codec_info)->name              = NULL;
-    (*codec_info)->description       = NULL;
-    (*codec_info)->magic_number_node = NULL;
-    (*codec_info)->extension_node    = NULL;
-    (*codec_info)->mime_type_node    = NULL;
-    (*codec_info)->load_features     = NULL;
-    (*codec_info)->save_features    = NULL;
-
-    return SAIL_OK;
-}
-
 static sail_status_t codec_read_info_from_input(const char *input, int (*ini_parser)(const char*, ini_handler, void*), struct sail_codec_info **codec_info) {
 
     struct sail_codec_info *codec_info_local;
@@ -398,6 +376,28 @@ static sail_status_t codec_read_info_from_input(const char *input, int (*ini_par
  * Public functions.
  */
 
+sail_status_t alloc_codec_info(struct sail_codec_info **codec_info) {
+
+    SAIL_CHECK_PTR(codec_info);
+
+    void *ptr;
+    SAIL_TRY(sail_malloc(sizeof(struct sail_codec_info), &ptr));
+    *codec_info = ptr;
+
+    (*codec_info)->path              = NULL;
+    (*codec_info)->layout            = 0;
+    (*codec_info)->version           = NULL;
+    (*codec_info)->name              = NULL;
+    (*codec_info)->description       = NULL;
+    (*codec_info)->magic_number_node = NULL;
+    (*codec_info)->extension_node    = NULL;
+    (*codec_info)->mime_type_node    = NULL;
+    (*codec_info)->load_features     = NULL;
+    (*codec_info)->save_features    = NULL;
+
+    return SAIL_OK;
+}
+
 void destroy_codec_info(struct sail_codec_info *codec_info) {
 
     if (codec_info == NULL) {
@@ -35,6 +35,14 @@ struct sail_codec_info;
  * Private codec info functions.
  */
 
+/*
+ * Allocates a new codec info object. The assigned object must be destroyed later
+ * with destroy_codec_info().
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_HIDDEN sail_status_t alloc_codec_info(struct sail_codec_info **codec_info);
+
 SAIL_HIDDEN void destroy_codec_info(struct sail_codec_info *codec_info);
 
 /*
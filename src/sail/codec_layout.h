@@ -39,10 +39,16 @@ struct sail_codec_layout_v8 {
     sail_codec_load_frame_v8_t           load_frame;
     sail_codec_load_finish_v8_t          load_finish;
 
+    /* Optional. NULL when the codec doesn't support the FRAME-SEEK load feature. */
+    sail_codec_load_seek_to_frame_v8_t   load_seek_to_frame;
+
     sail_codec_save_init_v8_t            save_init;
     sail_codec_save_seek_next_frame_v8_t save_seek_next_frame;
     sail_codec_save_frame_v8_t           save_frame;
     sail_codec_save_finish_v8_t          save_finish;
+
+    /* Optional. NULL when the codec keeps no process-wide resources. */
+    sail_codec_release_v8_t              release;
 };
 
 #endif
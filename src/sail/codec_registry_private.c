@@ -0,0 +1,929 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef SAIL_WIN32
+    #include <direct.h>  /* _mkdir */
+    #include <windows.h> /* MoveFileEx */
+#else
+    #include <errno.h>
+    #include <unistd.h>  /* getpid */
+#endif
+
+#include <sail/sail.h>
+
+/*
+ * Private functions.
+ */
+
+/*
+ * Registry file layout. All numbers are stored in the native byte order as the registry
+ * is never shared between machines:
+ *
+ *   header:  magic[8], int64 directory mtime, uint64 payload size, uint64 payload hash
+ *   payload: uint32 layout, string SAIL version, string codecs directory, uint32 number of entries, entries
+ *   entry:   string codec info file name, string codec file name, int64 codec info mtime,
+ *            uint64 codec info size, serialized codec info
+ *
+ * Strings are stored as uint32 length including the terminating zero followed by the characters.
+ * NULL strings have zero length.
+ */
+static const char REGISTRY_MAGIC[8] = { 'S', 'A', 'I', 'L', 'R', 'E', 'G', '2' };
+
+#define REGISTRY_DIR_MTIME_OFFSET 8
+#define REGISTRY_HEADER_SIZE      32
+
+#ifdef SAIL_WIN32
+    #define REGISTRY_PATH_SEPARATOR "\\"
+#else
+    #define REGISTRY_PATH_SEPARATOR "/"
+#endif
+
+struct registry_writer {
+    unsigned char *data;
+    size_t size;
+    size_t capacity;
+};
+
+struct registry_reader {
+    const unsigned char *data;
+    size_t size;
+    size_t offset;
+};
+
+/* FNV-1a. */
+static uint64_t payload_hash(const unsigned char *data, size_t size) {
+
+    uint64_t hash = UINT64_C(14695981039346656037);
+
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= UINT64_C(1099511628211);
+    }
+
+    return hash;
+}
+
+static sail_status_t file_stat(const char *path, int64_t *mtime, uint64_t *size) {
+
+#ifdef _MSC_VER
+    struct _stat64 attrs;
+
+    if (_stat64(path, &attrs) != 0) {
+        return SAIL_ERROR_OPEN_FILE;
+    }
+#else
+    struct stat attrs;
+
+    if (stat(path, &attrs) != 0) {
+        return SAIL_ERROR_OPEN_FILE;
+    }
+#endif
+
+    *mtime = (int64_t)attrs.st_mtime;
+
+    if (size != NULL) {
+        *size = (uint64_t)attrs.st_size;
+    }
+
+    return SAIL_OK;
+}
+
+/* "/path/jpeg.so" -> "jpeg.so". */
+static const char* file_name_from_path(const char *path) {
+
+    const char *name = path;
+
+    for (const char *it = path; *it != '\0'; it++) {
+        if (*it == '/' || *it == '\\') {
+            name = it + 1;
+        }
+    }
+
+    return name;
+}
+
+/*
+ * Writer.
+ */
+
+static sail_status_t write_bytes(struct registry_writer *writer, const void *bytes, size_t size) {
+
+    if (writer->size + size > writer->capacity) {
+        size_t new_capacity = writer->capacity == 0 ? 4096 : writer->capacity;
+
+        while (new_capacity < writer->size + size) {
+            new_capacity *= 2;
+        }
+
+        void *ptr = writer->data;
+        SAIL_TRY(sail_realloc(new_capacity, &ptr));
+        writer->data     = ptr;
+        writer->capacity = new_capacity;
+    }
+
+    memcpy(writer->data + writer->size, bytes, size);
+    writer->size += size;
+
+    return SAIL_OK;
+}
+
+static sail_status_t write_uint32(struct registry_writer *writer, uint32_t value) {
+
+    SAIL_TRY(write_bytes(writer, &value, sizeof(value)));
+
+    return SAIL_OK;
+}
+
+static sail_status_t write_int32(struct registry_writer *writer, int32_t value) {
+
+    SAIL_TRY(write_bytes(writer, &value, sizeof(value)));
+
+    return SAIL_OK;
+}
+
+static sail_status_t write_int64(struct registry_writer *writer, int64_t value) {
+
+    SAIL_TRY(write_bytes(writer, &value, sizeof(value)));
+
+    return SAIL_OK;
+}
+
+static sail_status_t write_uint64(struct registry_writer *writer, uint64_t value) {
+
+    SAIL_TRY(write_bytes(writer, &value, sizeof(value)));
+
+    return SAIL_OK;
+}
+
+static sail_status_t write_double(struct registry_writer *writer, double value) {
+
+    SAIL_TRY(write_bytes(writer, &value, sizeof(value)));
+
+    return SAIL_OK;
+}
+
+static sail_status_t write_string(struct registry_writer *writer, const char *str) {
+
+    if (str == NULL) {
+        SAIL_TRY(write_uint32(writer, 0));
+    } else {
+        const size_t length = strlen(str) + 1;
+
+        SAIL_TRY(write_uint32(writer, (uint32_t)length));
+        SAIL_TRY(write_bytes(writer, str, length));
+    }
+
+    return SAIL_OK;
+}
+
+static sail_status_t write_string_node_chain(struct registry_writer *writer, const struct sail_string_node *string_node) {
+
+    uint32_t count = 0;
+
+    for (const struct sail_string_node *node = string_node; node != NULL; node = node->next) {
+        count++;
+    }
+
+    SAIL_TRY(write_uint32(writer, count));
+
+    for (const struct sail_string_node *node = string_node; node != NULL; node = node->next) {
+        SAIL_TRY(write_string(writer, node->string));
+    }
+
+    return SAIL_OK;
+}
+
+static sail_status_t write_codec_info(struct registry_writer *writer, const struct sail_codec_info *codec_info) {
+
+    SAIL_TRY(write_int32(writer, codec_info->layout));
+    SAIL_TRY(write_int32(writer, codec_info->priority));
+    SAIL_TRY(write_string(writer, codec_info->version));
+    SAIL_TRY(write_string(writer, codec_info->name));
+    SAIL_TRY(write_string(writer, codec_info->description));
+    SAIL_TRY(write_string_node_chain(writer, codec_info->magic_number_node));
+    SAIL_TRY(write_string_node_chain(writer, codec_info->extension_node));
+    SAIL_TRY(write_string_node_chain(writer, codec_info->mime_type_node));
+
+    const struct sail_load_features *load_features = codec_info->load_features;
+
+    SAIL_TRY(write_int32(writer, load_features->features));
+    SAIL_TRY(write_string_node_chain(writer, load_features->tuning));
+
+    const struct sail_save_features *save_features = codec_info->save_features;
+
+    SAIL_TRY(write_int32(writer, save_features->features));
+
+    SAIL_TRY(write_uint32(writer, save_features->pixel_formats_length));
+    for (unsigned i = 0; i < save_features->pixel_formats_length; i++) {
+        SAIL_TRY(write_int32(writer, save_features->pixel_formats[i]));
+    }
+
+    SAIL_TRY(write_uint32(writer, save_features->compressions_length));
+    for (unsigned i = 0; i < save_features->compressions_length; i++) {
+        SAIL_TRY(write_int32(writer, save_features->compressions[i]));
+    }
+
+    SAIL_TRY(write_int32(writer, save_features->default_compression));
+
+    const struct sail_compression_level *compression_level = save_features->compression_level;
+
+    SAIL_TRY(write_uint32(writer, compression_level != NULL));
+
+    if (compression_level != NULL) {
+        SAIL_TRY(write_double(writer, compression_level->min_level));
+        SAIL_TRY(write_double(writer, compression_level->max_level));
+        SAIL_TRY(write_double(writer, compression_level->default_level));
+        SAIL_TRY(write_double(writer, compression_level->step));
+    }
+
+    SAIL_TRY(write_string_node_chain(writer, save_features->tuning));
+
+    return SAIL_OK;
+}
+
+static sail_status_t write_entry(struct registry_writer *writer, const char *codecs_path, const struct sail_codec_info *codec_info) {
+
+    if (codec_info->path == NULL) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_NULL_PTR);
+    }
+
+    /* "/path/jpeg.so" -> "jpeg.codec.info". */
+    const char *codec_file_name = file_name_from_path(codec_info->path);
+    const char *suffix = strrchr(codec_file_name, '.');
+
+    if (suffix == NULL || suffix == codec_file_name) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_INVALID_ARGUMENT);
+    }
+
+    char *codec_base_name;
+    SAIL_TRY(sail_strdup_length(codec_file_name, (size_t)(suffix - codec_file_name), &codec_base_name));
+
+    char *codec_info_path;
+    SAIL_TRY_OR_CLEANUP(sail_concat(&codec_info_path, 4, codecs_path, REGISTRY_PATH_SEPARATOR, codec_base_name, ".codec.info"),
+                        /* cleanup */ sail_free(codec_base_name));
+    sail_free(codec_base_name);
+
+    int64_t codec_info_mtime;
+    uint64_t codec_info_size;
+    SAIL_TRY_OR_CLEANUP(file_stat(codec_info_path, &codec_info_mtime, &codec_info_size),
+                        /* cleanup */ sail_free(codec_info_path));
+
+    SAIL_TRY_OR_CLEANUP(write_string(writer, file_name_from_path(codec_info_path)),
+                        /* cleanup */ sail_free(codec_info_path));
+    sail_free(codec_info_path);
+
+    SAIL_TRY(write_string(writer, codec_file_name));
+    SAIL_TRY(write_int64(writer, codec_info_mtime));
+    SAIL_TRY(write_uint64(writer, codec_info_size));
+    SAIL_TRY(write_codec_info(writer, codec_info));
+
+    return SAIL_OK;
+}
+
+/*
+ * Reader.
+ */
+
+static sail_status_t read_bytes(struct registry_reader *reader, void *bytes, size_t size) {
+
+    if (reader->size - reader->offset < size) {
+        return SAIL_ERROR_PARSE_FILE;
+    }
+
+    memcpy(bytes, reader->data + reader->offset, size);
+    reader->offset += size;
+
+    return SAIL_OK;
+}
+
+static sail_status_t read_uint32(struct registry_reader *reader, uint32_t *value) {
+
+    SAIL_TRY(read_bytes(reader, value, sizeof(*value)));
+
+    return SAIL_OK;
+}
+
+static sail_status_t read_int32(struct registry_reader *reader, int32_t *value) {
+
+    SAIL_TRY(read_bytes(reader, value, sizeof(*value)));
+
+    return SAIL_OK;
+}
+
+static sail_status_t read_int(struct registry_reader *reader, int *value) {
+
+    int32_t value32;
+    SAIL_TRY(read_int32(reader, &value32));
+
+    *value = value32;
+
+    return SAIL_OK;
+}
+
+static sail_status_t read_int64(struct registry_reader *reader, int64_t *value) {
+
+    SAIL_TRY(read_bytes(reader, value, sizeof(*value)));
+
+    return SAIL_OK;
+}
+
+static sail_status_t read_uint64(struct registry_reader *reader, uint64_t *value) {
+
+    SAIL_TRY(read_bytes(reader, value, sizeof(*value)));
+
+    return SAIL_OK;
+}
+
+static sail_status_t read_double(struct registry_reader *reader, double *value) {
+
+    SAIL_TRY(read_bytes(reader, value, sizeof(*value)));
+
+    return SAIL_OK;
+}
+
+/* Returns a pointer into the registry data. The string is NULL if it was NULL when saved. */
+static sail_status_t read_string_view(struct registry_reader *reader, const char **str) {
+
+    uint32_t length;
+    SAIL_TRY(read_uint32(reader, &length));
+
+    if (length == 0) {
+        *str = NULL;
+        return SAIL_OK;
+    }
+
+    if (reader->size - reader->offset < length || reader->data[reader->offset + length - 1] != '\0') {
+        return SAIL_ERROR_PARSE_FILE;
+    }
+
+    *str = (const char *)(reader->data + reader->offset);
+    reader->offset += length;
+
+    return SAIL_OK;
+}
+
+static sail_status_t read_string(struct registry_reader *reader, char **str) {
+
+    const char *view;
+    SAIL_TRY(read_string_view(reader, &view));
+
+    SAIL_TRY(sail_strdup(view, str));
+
+    return SAIL_OK;
+}
+
+static sail_status_t read_string_node_chain(struct registry_reader *reader, struct sail_string_node **string_node) {
+
+    uint32_t count;
+    SAIL_TRY(read_uint32(reader, &count));
+
+    struct sail_string_node **last_string_node = string_node;
+
+    for (uint32_t i = 0; i < count; i++) {
+        struct sail_string_node *node;
+        SAIL_TRY(sail_alloc_string_node(&node));
+
+        *last_string_node = node;
+        last_string_node = &node->next;
+
+        SAIL_TRY(read_string(reader, &node->string));
+    }
+
+    return SAIL_OK;
+}
+
+static sail_status_t read_ints(struct registry_reader *reader, int **values, unsigned *length) {
+
+    uint32_t count;
+    SAIL_TRY(read_uint32(reader, &count));
+
+    if (count == 0) {
+        return SAIL_OK;
+    }
+
+    if ((reader->size - reader->offset) / sizeof(int32_t) < count) {
+        return SAIL_ERROR_PARSE_FILE;
+    }
+
+    void *ptr;
+    SAIL_TRY(sail_malloc((size_t)count * sizeof(int), &ptr));
+    *values = ptr;
+    *length = count;
+
+    for (uint32_t i = 0; i < count; i++) {
+        SAIL_TRY(read_int(reader, *values + i));
+    }
+
+    return SAIL_OK;
+}
+
+/* All the allocated members are destroyed with the codec info in case of errors. */
+static sail_status_t read_codec_info(struct registry_reader *reader, struct sail_codec_info *codec_info) {
+
+    int priority;
+
+    SAIL_TRY(read_int(reader, &codec_info->layout));
+    SAIL_TRY(read_int(reader, &priority));
+    codec_info->priority = priority;
+
+    SAIL_TRY(read_string(reader, &codec_info->version));
+    SAIL_TRY(read_string(reader, &codec_info->name));
+    SAIL_TRY(read_string(reader, &codec_info->description));
+    SAIL_TRY(read_string_node_chain(reader, &codec_info->magic_number_node));
+    SAIL_TRY(read_string_node_chain(reader, &codec_info->extension_node));
+    SAIL_TRY(read_string_node_chain(reader, &codec_info->mime_type_node));
+
+    struct sail_load_features *load_features = codec_info->load_features;
+
+    SAIL_TRY(read_int(reader, &load_features->features));
+    SAIL_TRY(read_string_node_chain(reader, &load_features->tuning));
+
+    struct sail_save_features *save_features = codec_info->save_features;
+    int default_compression;
+
+    SAIL_TRY(read_int(reader, &save_features->features));
+    SAIL_TRY(read_ints(reader, (int **)&save_features->pixel_formats, &save_features->pixel_formats_length));
+    SAIL_TRY(read_ints(reader, (int **)&save_features->compressions, &save_features->compressions_length));
+    SAIL_TRY(read_int(reader, &default_compression));
+    save_features->default_compression = default_compression;
+
+    uint32_t has_compression_level;
+    SAIL_TRY(read_uint32(reader, &has_compression_level));
+
+    if (has_compression_level) {
+        SAIL_TRY(sail_alloc_compression_level(&save_features->compression_level));
+
+        SAIL_TRY(read_double(reader, &save_features->compression_level->min_level));
+        SAIL_TRY(read_double(reader, &save_features->compression_level->max_level));
+        SAIL_TRY(read_double(reader, &save_features->compression_level->default_level));
+        SAIL_TRY(read_double(reader, &save_features->compression_level->step));
+    }
+
+    SAIL_TRY(read_string_node_chain(reader, &save_features->tuning));
+
+    return SAIL_OK;
+}
+
+static sail_status_t read_entry(struct registry_reader *reader, const char *codecs_path, struct sail_codec_bundle_node **codec_bundle_node) {
+
+    const char *codec_info_name;
+    const char *codec_name;
+    int64_t codec_info_mtime;
+    uint64_t codec_info_size;
+
+    SAIL_TRY(read_string_view(reader, &codec_info_name));
+    SAIL_TRY(read_string_view(reader, &codec_name));
+    SAIL_TRY(read_int64(reader, &codec_info_mtime));
+    SAIL_TRY(read_uint64(reader, &codec_info_size));
+
+    if (codec_info_name == NULL || codec_name == NULL) {
+        return SAIL_ERROR_PARSE_FILE;
+    }
+
+    /* The codec info file must be untouched since the registry was saved. */
+    {
+        char *codec_info_path;
+        SAIL_TRY(sail_concat(&codec_info_path, 3, codecs_path, REGISTRY_PATH_SEPARATOR, codec_info_name));
+
+        int64_t actual_mtime;
+        uint64_t actual_size;
+        const sail_status_t status = file_stat(codec_info_path, &actual_mtime, &actual_size);
+        sail_free(codec_info_path);
+
+        if (status != SAIL_OK || actual_mtime != codec_info_mtime || actual_size != codec_info_size) {
+            SAIL_LOG_DEBUG("Codec info '%s' has been changed since the codec registry was saved", codec_info_name);
+            return SAIL_ERROR_PARSE_FILE;
+        }
+    }
+
+    struct sail_codec_bundle_node *local_codec_bundle_node;
+    SAIL_TRY(alloc_codec_bundle_node(&local_codec_bundle_node));
+
+    SAIL_TRY_OR_CLEANUP(alloc_codec_bundle(&local_codec_bundle_node->codec_bundle),
+                        /* cleanup */ destroy_codec_bundle_node(local_codec_bundle_node));
+
+    struct sail_codec_info *codec_info;
+    SAIL_TRY_OR_CLEANUP(alloc_codec_info(&codec_info),
+                        /* cleanup */ destroy_codec_bundle_node(local_codec_bundle_node));
+    local_codec_bundle_node->codec_bundle->codec_info = codec_info;
+
+    SAIL_TRY_OR_CLEANUP(sail_alloc_load_features(&codec_info->load_features),
+                        /* cleanup */ destroy_codec_bundle_node(local_codec_bundle_node));
+    SAIL_TRY_OR_CLEANUP(sail_alloc_save_features(&codec_info->save_features),
+                        /* cleanup */ destroy_codec_bundle_node(local_codec_bundle_node));
+    SAIL_TRY_OR_CLEANUP(sail_concat(&codec_info->path, 3, codecs_path, REGISTRY_PATH_SEPARATOR, codec_name),
+                        /* cleanup */ destroy_codec_bundle_node(local_codec_bundle_node));
+    SAIL_TRY_OR_CLEANUP(read_codec_info(reader, codec_info),
+                        /* cleanup */ destroy_codec_bundle_node(local_codec_bundle_node));
+
+    *codec_bundle_node = local_codec_bundle_node;
+
+    return SAIL_OK;
+}
+
+static sail_status_t read_payload(struct registry_reader *reader, const char *codecs_path, struct sail_codec_bundle_node **codec_bundle_node) {
+
+    uint32_t layout;
+    const char *version;
+    uint32_t entries;
+
+    const char *saved_codecs_path;
+    SAIL_TRY(read_uint32(reader, &layout));
+    SAIL_TRY(read_string_view(reader, &version));
+    SAIL_TRY(read_string_view(reader, &saved_codecs_path));
+    SAIL_TRY(read_uint32(reader, &entries));
+
+    /* The codec info format could be changed by another SAIL version. */
+    if (layout != SAIL_CODEC_LAYOUT_V8 || version == NULL || strcmp(version, SAIL_VERSION_STRING) != 0) {
+        SAIL_LOG_DEBUG("Codec registry for '%s' has been saved by another SAIL version", codecs_path);
+        return SAIL_ERROR_PARSE_FILE;
+    }
+
+    /* Registry file names are hashes of the codecs directories which could collide. */
+    if (saved_codecs_path == NULL || strcmp(saved_codecs_path, codecs_path) != 0) {
+        SAIL_LOG_DEBUG("Codec registry for '%s' has been saved for '%s'", codecs_path, saved_codecs_path);
+        return SAIL_ERROR_PARSE_FILE;
+    }
+
+    struct sail_codec_bundle_node *first_codec_bundle_node = NULL;
+    struct sail_codec_bundle_node **last_codec_bundle_node = &first_codec_bundle_node;
+
+    for (uint32_t i = 0; i < entries; i++) {
+        struct sail_codec_bundle_node *local_codec_bundle_node;
+
+        SAIL_TRY_OR_CLEANUP(read_entry(reader, codecs_path, &local_codec_bundle_node),
+                            /* cleanup */ destroy_codec_bundle_node_chain(first_codec_bundle_node));
+
+        *last_codec_bundle_node = local_codec_bundle_node;
+        last_codec_bundle_node = &local_codec_bundle_node->next;
+    }
+
+    *codec_bundle_node = first_codec_bundle_node;
+
+    return SAIL_OK;
+}
+
+static sail_status_t read_registry(const unsigned char *data, size_t size, const char *codecs_path,
+                                   struct sail_codec_bundle_node **codec_bundle_node) {
+
+    struct registry_reader reader = { data, size, 0 };
+
+    char magic[sizeof(REGISTRY_MAGIC)];
+    int64_t dir_mtime;
+    uint64_t payload_size;
+    uint64_t expected_payload_hash;
+
+    SAIL_TRY(read_bytes(&reader, magic, sizeof(magic)));
+    SAIL_TRY(read_int64(&reader, &dir_mtime));
+    SAIL_TRY(read_uint64(&reader, &payload_size));
+    SAIL_TRY(read_uint64(&reader, &expected_payload_hash));
+
+    if (memcmp(magic, REGISTRY_MAGIC, sizeof(REGISTRY_MAGIC)) != 0 || payload_size != size - REGISTRY_HEADER_SIZE) {
+        SAIL_LOG_DEBUG("Codec registry in '%s' is corrupted", codecs_path);
+        return SAIL_ERROR_PARSE_FILE;
+    }
+
+    /* Codec info files have been added or removed since the registry was saved. */
+    int64_t actual_dir_mtime;
+    SAIL_TRY(file_stat(codecs_path, &actual_dir_mtime, NULL));
+
+    if (actual_dir_mtime != dir_mtime) {
+        SAIL_LOG_DEBUG("Codecs directory '%s' has been changed since the codec registry was saved", codecs_path);
+        return SAIL_ERROR_PARSE_FILE;
+    }
+
+    if (payload_hash(data + REGISTRY_HEADER_SIZE, (size_t)payload_size) != expected_payload_hash) {
+        SAIL_LOG_DEBUG("Codec registry in '%s' has invalid hash", codecs_path);
+        return SAIL_ERROR_PARSE_FILE;
+    }
+
+    SAIL_TRY(read_payload(&reader, codecs_path, codec_bundle_node));
+
+    return SAIL_OK;
+}
+
+/* Returns a copy of the environment variable value, or NULL when it's not set or empty. */
+static char* env_value(const char *name) {
+
+    char *value = NULL;
+
+#ifdef _MSC_VER
+    char *env = NULL;
+    _dupenv_s(&env, NULL, name);
+
+    if (env != NULL && env[0] != '\0') {
+        sail_strdup(env, &value);
+    }
+
+    free(env);
+#else
+    const char *env = getenv(name);
+
+    if (env != NULL && env[0] != '\0') {
+        sail_strdup(env, &value);
+    }
+#endif
+
+    return value;
+}
+
+static sail_status_t make_dir(const char *path) {
+
+#ifdef SAIL_WIN32
+    if (_mkdir(path) != 0 && !sail_is_dir(path)) {
+        return SAIL_ERROR_OPEN_FILE;
+    }
+#else
+    if (mkdir(path, 0700) != 0 && errno != EEXIST) {
+        return SAIL_ERROR_OPEN_FILE;
+    }
+#endif
+
+    return SAIL_OK;
+}
+
+/*
+ * Builds the per-user directory registries are saved into, and creates it when create is true:
+ *
+ *   - Windows: %LOCALAPPDATA%\sail
+ *   - macOS:   $HOME/Library/Caches/sail
+ *   - Others:  $XDG_CACHE_HOME/sail or $HOME/.cache/sail
+ *
+ * Codecs directories are usually not writable by users, and they must not be written into
+ * at runtime even when they are.
+ */
+static sail_status_t registry_dir(bool create, char **path) {
+
+#ifdef SAIL_WIN32
+    char *cache_path = env_value("LOCALAPPDATA");
+#elif defined(SAIL_APPLE)
+    char *cache_path = NULL;
+    char *home = env_value("HOME");
+
+    if (home != NULL) {
+        sail_concat(&cache_path, 2, home, "/Library/Caches");
+        sail_free(home);
+    }
+#else
+    char *cache_path = env_value("XDG_CACHE_HOME");
+
+    if (cache_path == NULL) {
+        char *home = env_value("HOME");
+
+        if (home != NULL) {
+            sail_concat(&cache_path, 2, home, "/.cache");
+            sail_free(home);
+        }
+    }
+#endif
+
+    if (cache_path == NULL) {
+        return SAIL_ERROR_OPEN_FILE;
+    }
+
+    if (create) {
+        SAIL_TRY_OR_CLEANUP(make_dir(cache_path),
+                            /* cleanup */ sail_free(cache_path));
+    }
+
+    SAIL_TRY_OR_CLEANUP(sail_concat(path, 3, cache_path, REGISTRY_PATH_SEPARATOR, "sail"),
+                        /* cleanup */ sail_free(cache_path));
+    sail_free(cache_path);
+
+    if (create) {
+        SAIL_TRY_OR_CLEANUP(make_dir(*path),
+                            /* cleanup */ sail_free(*path));
+    }
+
+    return SAIL_OK;
+}
+
+/* "/usr/lib/sail/codecs" -> "<registry dir>/codecs-0123456789ABCDEF.registry". */
+static sail_status_t registry_path(const char *codecs_path, bool create, char **path) {
+
+    char *dir;
+    SAIL_TRY(registry_dir(create, &dir));
+
+    const uint64_t hash = sail_string_hash(codecs_path);
+    char hash_string[sizeof(hash) * 2 + 1];
+
+    SAIL_TRY_OR_CLEANUP(sail_data_into_hex_string(&hash, sizeof(hash), hash_string),
+                        /* cleanup */ sail_free(dir));
+    SAIL_TRY_OR_CLEANUP(sail_concat(path, 5, dir, REGISTRY_PATH_SEPARATOR, "codecs-", hash_string, ".registry"),
+                        /* cleanup */ sail_free(dir));
+    sail_free(dir);
+
+    return SAIL_OK;
+}
+
+static sail_status_t write_file(const char *path, const void *data, size_t size) {
+
+    FILE *fptr;
+
+#ifdef _MSC_VER
+    if (fopen_s(&fptr, path, "wb") != 0) {
+        fptr = NULL;
+    }
+#else
+    fptr = fopen(path, "wb");
+#endif
+
+    if (fptr == NULL) {
+        return SAIL_ERROR_OPEN_FILE;
+    }
+
+    const bool written = fwrite(data, 1, size, fptr) == size;
+
+    if (fclose(fptr) != 0 || !written) {
+        return SAIL_ERROR_WRITE_IO;
+    }
+
+    return SAIL_OK;
+}
+
+/*
+ * The registry is written into a temporary file next to it, and then renamed over the old one,
+ * so readers in other processes see either the old or the new registry, never a partially written one.
+ * The temporary file name includes the process ID as several processes may save the registry
+ * at the same time.
+ */
+static sail_status_t save_registry(const char *codecs_path, const char *path, const struct registry_writer *writer) {
+
+    char pid_string[24];
+#ifdef SAIL_WIN32
+    snprintf(pid_string, sizeof(pid_string), "%lu", (unsigned long)GetCurrentProcessId());
+#else
+    snprintf(pid_string, sizeof(pid_string), "%ld", (long)getpid());
+#endif
+
+    char *temp_path;
+    SAIL_TRY(sail_concat(&temp_path, 4, path, ".", pid_string, ".tmp"));
+
+    SAIL_TRY_OR_CLEANUP(write_file(temp_path, writer->data, writer->size),
+                        /* cleanup */ remove(temp_path),
+                                      sail_free(temp_path));
+
+#ifdef SAIL_WIN32
+    const bool renamed = MoveFileExA(temp_path, path, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    const bool renamed = rename(temp_path, path) == 0;
+#endif
+
+    if (!renamed) {
+        remove(temp_path);
+        sail_free(temp_path);
+        return SAIL_ERROR_WRITE_IO;
+    }
+
+    sail_free(temp_path);
+
+    SAIL_LOG_DEBUG("Saved codec registry '%s' for '%s'", path, codecs_path);
+
+    return SAIL_OK;
+}
+
+/*
+ * Public functions.
+ */
+
+sail_status_t codec_registry_load(const char *codecs_path, struct sail_codec_bundle_node **codec_bundle_node) {
+
+    SAIL_CHECK_PTR(codecs_path);
+    SAIL_CHECK_PTR(codec_bundle_node);
+
+    char *path;
+    SAIL_TRY(registry_path(codecs_path, /* create */ false, &path));
+
+    if (!sail_is_file(path)) {
+        sail_free(path);
+        return SAIL_ERROR_OPEN_FILE;
+    }
+
+    void *data;
+    size_t size;
+
+    SAIL_TRY_OR_CLEANUP(sail_alloc_data_from_file_contents(path, &data, &size),
+                        /* cleanup */ sail_free(path));
+    sail_free(path);
+
+    if (size < REGISTRY_HEADER_SIZE) {
+        sail_free(data);
+        return SAIL_ERROR_READ_FILE;
+    }
+
+    const sail_status_t status = read_registry(data, size, codecs_path, codec_bundle_node);
+
+    sail_free(data);
+
+    return status;
+}
+
+sail_status_t codec_registry_dir_mtime(const char *codecs_path, int64_t *dir_mtime) {
+
+    SAIL_CHECK_PTR(codecs_path);
+    SAIL_CHECK_PTR(dir_mtime);
+
+    SAIL_TRY(file_stat(codecs_path, dir_mtime, NULL));
+
+    /*
+     * Modification times have a granularity of one second. When the directory has been modified
+     * within the current second, more codecs could be installed in the same second unnoticed.
+     */
+    if (*dir_mtime >= (int64_t)time(NULL)) {
+        *dir_mtime = -1;
+    }
+
+    return SAIL_OK;
+}
+
+sail_status_t codec_registry_save(const char *codecs_path, int64_t dir_mtime, const struct sail_codec_bundle_node *codec_bundle_node) {
+
+    SAIL_CHECK_PTR(codecs_path);
+
+    if (dir_mtime < 0) {
+        SAIL_LOG_DEBUG("Codecs directory '%s' has just been modified, so not saving the codec registry", codecs_path);
+        return SAIL_OK;
+    }
+
+    struct registry_writer writer = { NULL, 0, 0 };
+
+    /* Header. The payload size and hash are filled later. */
+    SAIL_TRY(write_bytes(&writer, REGISTRY_MAGIC, sizeof(REGISTRY_MAGIC)));
+    SAIL_TRY_OR_CLEANUP(write_int64(&writer, dir_mtime),
+                        /* cleanup */ sail_free(writer.data));
+    SAIL_TRY_OR_CLEANUP(write_uint64(&writer, 0),
+                        /* cleanup */ sail_free(writer.data));
+    SAIL_TRY_OR_CLEANUP(write_uint64(&writer, 0),
+                        /* cleanup */ sail_free(writer.data));
+
+    /* Payload. */
+    uint32_t entries = 0;
+
+    for (const struct sail_codec_bundle_node *node = codec_bundle_node; node != NULL; node = node->next) {
+        entries++;
+    }
+
+    SAIL_TRY_OR_CLEANUP(write_uint32(&writer, SAIL_CODEC_LAYOUT_V8),
+                        /* cleanup */ sail_free(writer.data));
+    SAIL_TRY_OR_CLEANUP(write_string(&writer, SAIL_VERSION_STRING),
+                        /* cleanup */ sail_free(writer.data));
+    SAIL_TRY_OR_CLEANUP(write_string(&writer, codecs_path),
+                        /* cleanup */ sail_free(writer.data));
+    SAIL_TRY_OR_CLEANUP(write_uint32(&writer, entries),
+                        /* cleanup */ sail_free(writer.data));
+
+    for (const struct sail_codec_bundle_node *node = codec_bundle_node; node != NULL; node = node->next) {
+        SAIL_TRY_OR_CLEANUP(write_entry(&writer, codecs_path, node->codec_bundle->codec_info),
+                            /* cleanup */ sail_free(writer.data));
+    }
+
+    const uint64_t payload_size = writer.size - REGISTRY_HEADER_SIZE;
+    const uint64_t hash = payload_hash(writer.data + REGISTRY_HEADER_SIZE, (size_t)payload_size);
+
+    memcpy(writer.data + REGISTRY_DIR_MTIME_OFFSET + sizeof(int64_t), &payload_size, sizeof(payload_size));
+    memcpy(writer.data + REGISTRY_DIR_MTIME_OFFSET + sizeof(int64_t) + sizeof(uint64_t), &hash, sizeof(hash));
+
+    char *path;
+    SAIL_TRY_OR_CLEANUP(registry_path(codecs_path, /* create */ true, &path),
+                        /* cleanup */ sail_free(writer.data));
+
+    SAIL_TRY_OR_CLEANUP(save_registry(codecs_path, path, &writer),
+                        /* cleanup */ sail_free(path),
+                                      sail_free(writer.data));
+
+    sail_free(path);
+    sail_free(writer.data);
+
+    return SAIL_OK;
+}
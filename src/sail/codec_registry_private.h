@@ -0,0 +1,71 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_CODEC_REGISTRY_PRIVATE_H
+#define SAIL_CODEC_REGISTRY_PRIVATE_H
+
+#include <stdint.h>
+
+#include <sail-common/export.h>
+#include <sail-common/status.h>
+
+struct sail_codec_bundle_node;
+
+/*
+ * Private codec registry functions.
+ *
+ * A codec registry is a binary file stored in the user cache directory, one per codecs directory. It holds
+ * the already parsed codec info objects of the directory, so initializing the context doesn't need to list
+ * the directory and parse every codec info file. The registry is validated by the SAIL version, the directory
+ * modification time, the modification time and the size of every codec info file, and the payload hash.
+ */
+
+/*
+ * Loads the codec registry from the specified codecs directory and builds a chain of codec bundles
+ * from it. The loaded codec bundles don't have codecs loaded.
+ *
+ * Returns SAIL_OK on success. Returns an error when the registry doesn't exist or it's outdated.
+ */
+SAIL_HIDDEN sail_status_t codec_registry_load(const char *codecs_path, struct sail_codec_bundle_node **codec_bundle_node);
+
+/*
+ * Returns the modification time of the specified codecs directory. Must be called before enumerating
+ * the directory, so codecs installed during the enumeration invalidate the saved registry.
+ * Sets -1 when the directory has been modified within the current second.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_HIDDEN sail_status_t codec_registry_dir_mtime(const char *codecs_path, int64_t *dir_mtime);
+
+/*
+ * Saves the specified chain of codec bundles enumerated in the specified codecs directory into
+ * the codec registry. dir_mtime is the value returned by codec_registry_dir_mtime() before the enumeration.
+ * Does nothing when it's -1. The codecs directory itself is not written into.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_HIDDEN sail_status_t codec_registry_save(const char *codecs_path, int64_t dir_mtime, const struct sail_codec_bundle_node *codec_bundle_node);
+
+#endif
@@ -231,13 +231,47 @@ static sail_status_t preload_codecs(struct sail_context *context) {
 
     SAIL_LOG_DEBUG("Preloading codecs");
 
+    /* Collect the codecs to load. */
+    int codecs_num = 0;
+
     for (struct sail_codec_bundle_node *codec_bundle_node = context->codec_bundle_node; codec_bundle_node != NULL; codec_bundle_node = codec_bundle_node->next) {
-        const struct sail_codec *codec;
+        if (codec_bundle_node->codec_bundle->codec == NULL) {
+            codecs_num++;
+        }
+    }
+
+    if (codecs_num == 0) {
+        SAIL_TRY(unlock_context());
+        return SAIL_OK;
+    }
 
+    struct sail_codec_bundle **codec_bundle_array;
+    void *ptr;
+    SAIL_TRY_OR_CLEANUP(sail_malloc(sizeof(struct sail_codec_bundle *) * codecs_num, &ptr),
+                        /* cleanup */ unlock_context());
+    codec_bundle_array = ptr;
+
+    {
+        int i = 0;
+        for (struct sail_codec_bundle_node *codec_bundle_node = context->codec_bundle_node; codec_bundle_node != NULL; codec_bundle_node = codec_bundle_node->next) {
+            if (codec_bundle_node->codec_bundle->codec == NULL) {
+                codec_bundle_array[i++] = codec_bundle_node->codec_bundle;
+            }
+        }
+    }
+
+    /*
+     * Load the codecs in parallel. Every iteration touches its own codec bundle only,
+     * and the context is locked for the whole operation.
+     */
+#pragma omp parallel for schedule(SAIL_OPENMP_SCHEDULE)
+    for (int i = 0; i < codecs_num; i++) {
         /* Ignore loading errors on purpose. */
-        (void)load_codec_by_codec_info(codec_bundle_node->codec_bundle->codec_info, &codec);
+        (void)alloc_and_load_codec(codec_bundle_array[i]->codec_info, &codec_bundle_array[i]->codec);
     }
 
+    sail_free(codec_bundle_array);
+
     SAIL_TRY(unlock_context());
 
     return SAIL_OK;
@@ -327,6 +361,25 @@ static sail_status_t print_enumerated_codecs(struct sail_context *context) {
 }
 
 #if !defined SAIL_COMBINE_CODECS || defined SAIL_THIRD_PARTY_CODECS_PATH
+#ifndef SAIL_WIN32
+static bool ld_library_path_contains(const char *ld_library_path, const char *path) {
+
+    const size_t path_length = strlen(path);
+
+    for (const char *it = ld_library_path; it != NULL; it = strchr(it, ':')) {
+        if (*it == ':') {
+            it++;
+        }
+
+        if (strncmp(it, path, path_length) == 0 && (it[path_length] == ':' || it[path_length] == '\0')) {
+            return true;
+        }
+    }
+
+    return false;
+}
+#endif
+
 /* Add codecs_path/lib to the DLL/SO search path. */
 static sail_status_t add_lib_subdir_to_dll_search_path(const char *codecs_path) {
 
@@ -357,6 +410,12 @@ static sail_status_t add_lib_subdir_to_dll_search_path(const char *codecs_path)
     char *combined_ld_library_path;
     char *env = getenv("LD_LIBRARY_PATH");
 
+    if (env != NULL && ld_library_path_contains(env, full_path_to_lib)) {
+        SAIL_LOG_DEBUG("LD_LIBRARY_PATH already contains '%s'", full_path_to_lib);
+        sail_free(full_path_to_lib);
+        return SAIL_OK;
+    }
+
     if (env == NULL) {
         SAIL_TRY_OR_CLEANUP(sail_strdup(full_path_to_lib, &combined_ld_library_path),
                             sail_free(full_path_to_lib));
@@ -459,8 +518,29 @@ static sail_status_t enumerate_codecs_in_paths(struct sail_context *context, con
 
         SAIL_TRY(add_lib_subdir_to_dll_search_path(codecs_path));
 
+        /* Try the codec registry first to avoid listing the directory and parsing every codec info file. */
+        if (codec_registry_load(codecs_path, &codec_bundle_node) == SAIL_OK) {
+            SAIL_LOG_DEBUG("Loaded codecs in '%s' from the codec registry", codecs_path);
+
+            for (*last_codec_bundle_node = codec_bundle_node; *last_codec_bundle_node != NULL;
+                    last_codec_bundle_node = &(*last_codec_bundle_node)->next) {
+            }
+
+            continue;
+        }
+
         SAIL_LOG_DEBUG("Enumerating codecs in '%s'", codecs_path);
 
+        /* Record the directory modification time before listing it. */
+        int64_t dir_mtime;
+
+        if (codec_registry_dir_mtime(codecs_path, &dir_mtime) != SAIL_OK) {
+            dir_mtime = -1;
+        }
+
+        struct sail_codec_bundle_node **first_codec_bundle_node_in_path = last_codec_bundle_node;
+        bool all_codec_infos_parsed = true;
+
 #ifdef SAIL_WIN32
         const char *plugs_info_mask = "\\*.codec.info";
 
@@ -500,6 +580,8 @@ static sail_status_t enumerate_codecs_in_paths(struct sail_context *context, con
             if (build_codec_bundle_from_codec_info_path(full_path, &codec_bundle_node) == SAIL_OK) {
                 *last_codec_bundle_node = codec_bundle_node;
                 last_codec_bundle_node = &codec_bundle_node->next;
+            } else {
+                all_codec_infos_parsed = false;
             }
 
             sail_free(full_path);
@@ -539,6 +621,8 @@ static sail_status_t enumerate_codecs_in_paths(struct sail_context *context, con
                     if (build_codec_bundle_from_codec_info_path(full_path, &codec_bundle_node) == SAIL_OK) {
                         *last_codec_bundle_node = codec_bundle_node;
                         last_codec_bundle_node = &codec_bundle_node->next;
+                    } else {
+                        all_codec_infos_parsed = false;
                     }
                 }
             }
@@ -548,6 +632,17 @@ static sail_status_t enumerate_codecs_in_paths(struct sail_context *context, con
 
         closedir(d);
 #endif
+
+        /*
+         * Save the codec registry for the next time. Broken codec info files are not saved,
+         * so don't save the registry to catch fixing them. Saving fails when there's no
+         * writable user cache directory which is expected.
+         */
+        if (all_codec_infos_parsed) {
+            if (codec_registry_save(codecs_path, dir_mtime, *first_codec_bundle_node_in_path) != SAIL_OK) {
+                SAIL_LOG_DEBUG("Failed to save the codec registry for '%s'", codecs_path);
+            }
+        }
     }
 
     return SAIL_OK;
@@ -37,6 +37,24 @@
 
 #include <sail/sail.h>
 
+#ifdef SAIL_HAVE_POSIX_FADVISE
+    #include <fcntl.h>
+    #include <sys/stat.h>
+    #include <sys/types.h>
+    #include <unistd.h>
+#endif
+
+#ifdef SAIL_HAVE_IO_URING
+    #include "uring_private.h"
+#endif
+
+/*
+ * Size and number of the read-ahead windows of prefetched files. The windows after the current one
+ * are read in background. The size must be a power of two.
+ */
+#define SAIL_IO_PREFETCH_WINDOW  ((size_t)256 << 10)
+#define SAIL_IO_PREFETCH_WINDOWS 4
+
 struct io_file_state {
     FILE *fptr;
     size_t file_size;
@@ -220,6 +238,387 @@ static sail_status_t alloc_io_file(const char *path, const char *mode, struct sa
     return SAIL_OK;
 }
 
+#ifdef SAIL_HAVE_POSIX_FADVISE
+
+struct io_prefetch_window {
+    unsigned char *buffer;
+
+    /* Window-aligned file offset of the buffered data and its length. */
+    size_t offset;
+    size_t length;
+
+    /* The window is being read with io_uring. */
+    bool in_flight;
+
+    /* The buffer holds the data of the window. */
+    bool valid;
+};
+
+struct io_prefetched_file_state {
+    int fd;
+    size_t file_size;
+
+    /* Current I/O position. */
+    size_t position;
+
+    /* Reads the windows after the current one in background. NULL when io_uring is not available. */
+    struct sail_uring *uring;
+
+    struct io_prefetch_window windows[SAIL_IO_PREFETCH_WINDOWS];
+
+    /* The window with the current position or NULL. */
+    struct io_prefetch_window *current;
+};
+
+static sail_status_t io_prefetched_file_read_at(struct io_prefetched_file_state *state, void *buf, size_t offset, size_t size, size_t *read_size) {
+
+    *read_size = 0;
+
+    while (*read_size < size) {
+        const ssize_t result = pread(state->fd, (unsigned char *)buf + *read_size, size - *read_size, (off_t)(offset + *read_size));
+
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            sail_print_errno("Failed to read from the file: %s");
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_READ_IO);
+        } else if (result == 0) {
+            break;
+        }
+
+        *read_size += (size_t)result;
+    }
+
+    return SAIL_OK;
+}
+
+static struct io_prefetch_window* io_prefetched_file_find_window(struct io_prefetched_file_state *state, size_t offset) {
+
+    for (unsigned i = 0; i < SAIL_IO_PREFETCH_WINDOWS; i++) {
+        struct io_prefetch_window *window = &state->windows[i];
+
+        if (window->offset == offset && (window->valid || window->in_flight)) {
+            return window;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Returns a window that can be reused for another offset: not in flight, not the current one,
+ * and not holding the data in [from, to). Returns NULL if there are no such windows.
+ */
+static struct io_prefetch_window* io_prefetched_file_spare_window(struct io_prefetched_file_state *state, size_t from, size_t to) {
+
+    for (unsigned i = 0; i < SAIL_IO_PREFETCH_WINDOWS; i++) {
+        struct io_prefetch_window *window = &state->windows[i];
+
+        if (window->in_flight || window == state->current) {
+            continue;
+        }
+
+        if (!window->valid || window->offset < from || window->offset >= to) {
+            return window;
+        }
+    }
+
+    return NULL;
+}
+
+#ifdef SAIL_HAVE_IO_URING
+/* Waits for any window in flight. Failed reads leave the window invalid, so it's read again synchronously. */
+static sail_status_t io_prefetched_file_complete_window(struct io_prefetched_file_state *state) {
+
+    uint64_t index;
+    int result;
+    SAIL_TRY(uring_wait(state->uring, &index, &result));
+
+    struct io_prefetch_window *window = &state->windows[index];
+
+    window->in_flight = false;
+
+    if (result < 0) {
+        SAIL_LOG_DEBUG("Failed to read the file window at %zu in background: %s", window->offset, strerror(-result));
+        return SAIL_OK;
+    }
+
+    window->length = (size_t)result;
+
+    /* Short read in the middle of the file. Read the rest synchronously. */
+    if (window->length < SAIL_IO_PREFETCH_WINDOW && window->offset + window->length < state->file_size) {
+        size_t rest_length;
+
+        if (io_prefetched_file_read_at(state, window->buffer + window->length, window->offset + window->length,
+                                        SAIL_IO_PREFETCH_WINDOW - window->length, &rest_length) != SAIL_OK) {
+            return SAIL_OK;
+        }
+
+        window->length += rest_length;
+    }
+
+    window->valid = true;
+
+    return SAIL_OK;
+}
+#endif
+
+/*
+ * Starts reading the windows in [from, to) that are not buffered yet. Uses io_uring when it's available,
+ * or asks the kernel to read them into the page cache with posix_fadvise() otherwise.
+ */
+static void io_prefetched_file_read_ahead(struct io_prefetched_file_state *state, size_t from, size_t to) {
+
+    if (to > state->file_size) {
+        to = state->file_size;
+    }
+
+    if (from >= to) {
+        return;
+    }
+
+#ifdef SAIL_HAVE_IO_URING
+    if (state->uring != NULL) {
+        for (size_t offset = from; offset < to; offset += SAIL_IO_PREFETCH_WINDOW) {
+            if (io_prefetched_file_find_window(state, offset) != NULL) {
+                continue;
+            }
+
+            struct io_prefetch_window *window = io_prefetched_file_spare_window(state, from, to);
+
+            if (window == NULL) {
+                break;
+            }
+
+            window->offset = offset;
+            window->length = 0;
+            window->valid  = false;
+
+            if (uring_submit_read(state->uring, state->fd, window->buffer, SAIL_IO_PREFETCH_WINDOW,
+                                    offset, (uint64_t)(window - state->windows)) != SAIL_OK) {
+                break;
+            }
+
+            window->in_flight = true;
+        }
+
+        return;
+    }
+#endif
+
+    posix_fadvise(state->fd, (off_t)from, (off_t)(to - from), POSIX_FADV_WILLNEED);
+}
+
+/* Makes the window that contains the current position current and reads ahead the windows after it. */
+static sail_status_t io_prefetched_file_refill(struct io_prefetched_file_state *state) {
+
+    const size_t window_offset = state->position & ~(SAIL_IO_PREFETCH_WINDOW - 1);
+    const size_t read_ahead_end = window_offset + SAIL_IO_PREFETCH_WINDOW * SAIL_IO_PREFETCH_WINDOWS;
+
+    state->current = NULL;
+
+    struct io_prefetch_window *window = io_prefetched_file_find_window(state, window_offset);
+
+#ifdef SAIL_HAVE_IO_URING
+    while (window != NULL && window->in_flight) {
+        SAIL_TRY(io_prefetched_file_complete_window(state));
+    }
+#endif
+
+    if (window == NULL || !window->valid) {
+        window = io_prefetched_file_spare_window(state, window_offset, read_ahead_end);
+
+#ifdef SAIL_HAVE_IO_URING
+        /* All the spare windows are in flight. */
+        while (window == NULL) {
+            SAIL_TRY(io_prefetched_file_complete_window(state));
+            window = io_prefetched_file_spare_window(state, window_offset, read_ahead_end);
+        }
+#endif
+
+        window->offset = window_offset;
+        window->length = 0;
+        window->valid  = false;
+
+        SAIL_TRY(io_prefetched_file_read_at(state, window->buffer, window_offset, SAIL_IO_PREFETCH_WINDOW, &window->length));
+
+        window->valid = true;
+    }
+
+    state->current = window;
+
+    /* Start reading the next windows, so they're ready when the decoder gets there. */
+    io_prefetched_file_read_ahead(state, window_offset + SAIL_IO_PREFETCH_WINDOW, read_ahead_end);
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_prefetched_file_tolerant_read(void *stream, void *buf, size_t size_to_read, size_t *read_size) {
+
+    SAIL_CHECK_PTR(stream);
+    SAIL_CHECK_PTR(buf);
+    SAIL_CHECK_PTR(read_size);
+
+    struct io_prefetched_file_state *state = stream;
+    unsigned char *buf_ptr = buf;
+
+    *read_size = 0;
+
+    while (*read_size < size_to_read && state->position < state->file_size) {
+        const size_t left = size_to_read - *read_size;
+        const struct io_prefetch_window *window = state->current;
+
+        if (window != NULL && state->position >= window->offset && state->position < window->offset + window->length) {
+            const size_t buffer_position = state->position - window->offset;
+            const size_t available       = window->length - buffer_position;
+            const size_t to_copy         = left < available ? left : available;
+
+            memcpy(buf_ptr + *read_size, window->buffer + buffer_position, to_copy);
+
+            *read_size      += to_copy;
+            state->position += to_copy;
+        } else if (left >= SAIL_IO_PREFETCH_WINDOW) {
+            /* Large reads go directly into the destination buffer. */
+            size_t direct_read_size;
+            SAIL_TRY(io_prefetched_file_read_at(state, buf_ptr + *read_size, state->position, left, &direct_read_size));
+
+            *read_size      += direct_read_size;
+            state->position += direct_read_size;
+
+            break;
+        } else {
+            SAIL_TRY(io_prefetched_file_refill(state));
+
+            if (state->position >= state->current->offset + state->current->length) {
+                break;
+            }
+        }
+    }
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_prefetched_file_strict_read(void *stream, void *buf, size_t size_to_read) {
+
+    size_t read_size;
+
+    SAIL_TRY(io_prefetched_file_tolerant_read(stream, buf, size_to_read, &read_size));
+
+    if (read_size != size_to_read) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_READ_IO);
+    }
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_prefetched_file_seek(void *stream, long offset, int whence) {
+
+    SAIL_CHECK_PTR(stream);
+
+    struct io_prefetched_file_state *state = stream;
+
+    long base;
+
+    switch (whence) {
+        case SEEK_SET: base = 0;                      break;
+        case SEEK_CUR: base = (long)state->position;  break;
+        case SEEK_END: base = (long)state->file_size; break;
+
+        default: {
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_SEEK_WHENCE);
+        }
+    }
+
+    if (base + offset < 0) {
+        SAIL_LOG_ERROR("Failed to seek: negative position");
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_SEEK_IO);
+    }
+
+    state->position = (size_t)(base + offset);
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_prefetched_file_tell(void *stream, size_t *offset) {
+
+    SAIL_CHECK_PTR(stream);
+    SAIL_CHECK_PTR(offset);
+
+    const struct io_prefetched_file_state *state = stream;
+
+    *offset = state->position;
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_prefetched_file_close(void *stream) {
+
+    SAIL_CHECK_PTR(stream);
+
+    struct io_prefetched_file_state *state = stream;
+
+#ifdef SAIL_HAVE_IO_URING
+    /* The kernel writes into the buffers until the reads are completed. */
+    for (unsigned i = 0; i < SAIL_IO_PREFETCH_WINDOWS; i++) {
+        while (state->windows[i].in_flight) {
+            SAIL_TRY(io_prefetched_file_complete_window(state));
+        }
+    }
+
+    uring_destroy(state->uring);
+#endif
+
+    const int result = close(state->fd);
+
+    sail_free(state->windows[0].buffer);
+    sail_free(state);
+
+    if (result != 0) {
+        sail_print_errno("Failed to close the file: %s");
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_CLOSE_IO);
+    }
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_prefetched_file_eof(void *stream, bool *result) {
+
+    SAIL_CHECK_PTR(stream);
+    SAIL_CHECK_PTR(result);
+
+    const struct io_prefetched_file_state *state = stream;
+
+    *result = state->position >= state->file_size;
+
+    return SAIL_OK;
+}
+
+static sail_status_t open_prefetched_file(const char *path, int *fd, size_t *file_size) {
+
+    *fd = open(path, O_RDONLY);
+
+    if (*fd < 0) {
+        sail_print_errno("Failed to open the specified file: %s");
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_OPEN_FILE);
+    }
+
+    struct stat st;
+
+    if (fstat(*fd, &st) != 0) {
+        sail_print_errno("Failed to get the file size: %s");
+        close(*fd);
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_OPEN_FILE);
+    }
+
+    *file_size = (size_t)st.st_size;
+
+    return SAIL_OK;
+}
+
+#endif
+
 /*
  * Public functions.
  */
@@ -258,3 +657,93 @@ sail_status_t sail_alloc_io_read_write_file(const char *path, struct sail_io **i
 
     return SAIL_OK;
 }
+
+sail_status_t sail_alloc_io_read_file_prefetched(const char *path, struct sail_io **io) {
+
+#ifdef SAIL_HAVE_POSIX_FADVISE
+    SAIL_CHECK_PTR(path);
+    SAIL_CHECK_PTR(io);
+
+    SAIL_LOG_DEBUG("Opening file '%s' for prefetched reading", path);
+
+    int fd;
+    size_t file_size;
+    SAIL_TRY(open_prefetched_file(path, &fd, &file_size));
+
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    void *ptr;
+    SAIL_TRY_OR_CLEANUP(sail_malloc(sizeof(struct io_prefetched_file_state), &ptr),
+                        /* cleanup */ close(fd));
+    struct io_prefetched_file_state *state = ptr;
+
+    SAIL_TRY_OR_CLEANUP(sail_malloc(SAIL_IO_PREFETCH_WINDOW * SAIL_IO_PREFETCH_WINDOWS, &ptr),
+                        /* cleanup */ close(fd), sail_free(state));
+
+    state->fd        = fd;
+    state->file_size = file_size;
+    state->position  = 0;
+    state->uring     = NULL;
+    state->current   = NULL;
+
+    for (unsigned i = 0; i < SAIL_IO_PREFETCH_WINDOWS; i++) {
+        state->windows[i].buffer    = (unsigned char *)ptr + SAIL_IO_PREFETCH_WINDOW * i;
+        state->windows[i].offset    = 0;
+        state->windows[i].length    = 0;
+        state->windows[i].in_flight = false;
+        state->windows[i].valid     = false;
+    }
+
+#ifdef SAIL_HAVE_IO_URING
+    /* Fall back to posix_fadvise() when io_uring is not available. */
+    if (getenv("SAIL_DISABLE_IO_URING") == NULL) {
+        uring_alloc(SAIL_IO_PREFETCH_WINDOWS, &state->uring);
+    }
+#endif
+
+    SAIL_TRY_OR_CLEANUP(sail_alloc_io(io),
+                        /* cleanup */ io_prefetched_file_close(state));
+
+    /* The whole file is going to be read sequentially. Start reading the first windows right away. */
+    io_prefetched_file_read_ahead(state, 0, SAIL_IO_PREFETCH_WINDOW * SAIL_IO_PREFETCH_WINDOWS);
+
+    (*io)->stream         = state;
+    (*io)->features       = SAIL_IO_FEATURE_SEEKABLE;
+    (*io)->tolerant_read  = io_prefetched_file_tolerant_read;
+    (*io)->strict_read    = io_prefetched_file_strict_read;
+    (*io)->tolerant_write = sail_io_noop_tolerant_write;
+    (*io)->strict_write   = sail_io_noop_strict_write;
+    (*io)->seek           = io_prefetched_file_seek;
+    (*io)->tell           = io_prefetched_file_tell;
+    (*io)->flush          = sail_io_noop_flush;
+    (*io)->close          = io_prefetched_file_close;
+    (*io)->eof            = io_prefetched_file_eof;
+
+    return SAIL_OK;
+#else
+    SAIL_TRY(sail_alloc_io_read_file(path, io));
+
+    return SAIL_OK;
+#endif
+}
+
+sail_status_t sail_prefetch_file(const char *path) {
+
+    SAIL_CHECK_PTR(path);
+
+#ifdef SAIL_HAVE_POSIX_FADVISE
+    int fd;
+    size_t file_size;
+    SAIL_TRY(open_prefetched_file(path, &fd, &file_size));
+
+    /* The kernel reads the file in background. The page cache keeps the data after closing the file. */
+    posix_fadvise(fd, 0, (off_t)file_size, POSIX_FADV_WILLNEED);
+
+    if (close(fd) != 0) {
+        sail_print_errno("Failed to close the file: %s");
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_CLOSE_IO);
+    }
+#endif
+
+    return SAIL_OK;
+}
@@ -49,6 +49,31 @@ SAIL_EXPORT sail_status_t sail_alloc_io_read_file(const char *path, struct sail_
  */
 SAIL_EXPORT sail_status_t sail_alloc_io_read_write_file(const char *path, struct sail_io **io);
 
+/*
+ * Opens the specified image file for reading and allocates a new I/O object for it that is tuned
+ * for loading many files in a row. The file is read in window-aligned chunks, and the next chunks
+ * are read in background while the current one is being decoded.
+ *
+ * On Linux, the chunks are read with io_uring if it's available. Otherwise, or when
+ * the SAIL_DISABLE_IO_URING environment variable is set, the kernel is asked to read them
+ * into the page cache with posix_fadvise(). On platforms without posix_fadvise(), it's
+ * equivalent to sail_alloc_io_read_file().
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_alloc_io_read_file_prefetched(const char *path, struct sail_io **io);
+
+/*
+ * Asks the operating system to start reading the specified file into the page cache in background
+ * and returns immediately. Batch loaders can call it for the next few files while decoding the current one,
+ * so the following loads don't wait for the disk.
+ *
+ * Does nothing on platforms without posix_fadvise().
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_prefetch_file(const char *path);
+
 /* extern "C" */
 #ifdef __cplusplus
 }
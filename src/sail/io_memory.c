@@ -26,6 +26,7 @@
 #include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 
 #include <sail/sail.h>
@@ -65,6 +66,9 @@ struct mem_io_write_stream {
     void *buffer;
 };
 
+/* Initial capacity of growable buffers. Grows geometrically when exceeded. */
+static const size_t GROWABLE_MEMORY_INITIAL_LENGTH = 16 * 1024;
+
 /*
  * Private functions.
  */
@@ -187,8 +191,8 @@ static sail_status_t io_memory_seek(void *stream, long offset, int whence) {
     if (new_pos >= mem_io_buffer_info->length) {
         new_pos = mem_io_buffer_info->length;
         mem_io_buffer_info->accessible_length = mem_io_buffer_info->length;
-    } else if (new_pos >= mem_io_buffer_info->accessible_length) {
-        mem_io_buffer_info->accessible_length = new_pos + 1;
+    } else if (new_pos > mem_io_buffer_info->accessible_length) {
+        mem_io_buffer_info->accessible_length = new_pos;
     }
 
     mem_io_buffer_info->pos = new_pos;
@@ -224,6 +228,125 @@ static sail_status_t io_memory_close(void *stream) {
     return SAIL_OK;
 }
 
+static sail_status_t io_growable_memory_tolerant_write(void *stream, const void *buf, size_t size_to_write, size_t *written_size) {
+
+    SAIL_CHECK_PTR(stream);
+    SAIL_CHECK_PTR(buf);
+    SAIL_CHECK_PTR(written_size);
+
+    struct mem_io_write_stream *mem_io_write_stream = (struct mem_io_write_stream *)stream;
+    struct mem_io_buffer_info *mem_io_buffer_info = &mem_io_write_stream->mem_io_buffer_info;
+
+    *written_size = 0;
+
+    const size_t end_pos = mem_io_buffer_info->pos + size_to_write;
+
+    if (end_pos < mem_io_buffer_info->pos) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_WRITE_IO);
+    }
+
+    /* Grow geometrically to keep the number of reallocations logarithmic. */
+    if (end_pos > mem_io_buffer_info->length) {
+        size_t new_length = (mem_io_buffer_info->length == 0) ? GROWABLE_MEMORY_INITIAL_LENGTH : mem_io_buffer_info->length;
+
+        while (new_length < end_pos && new_length <= SIZE_MAX / 2) {
+            new_length *= 2;
+        }
+
+        if (new_length < end_pos) {
+            new_length = end_pos;
+        }
+
+        void *ptr = mem_io_write_stream->buffer;
+        SAIL_TRY(sail_realloc(new_length, &ptr));
+
+        mem_io_write_stream->buffer = ptr;
+        mem_io_buffer_info->length  = new_length;
+    }
+
+    /* Zero the gap left by seeking past the end. */
+    if (mem_io_buffer_info->pos > mem_io_buffer_info->accessible_length) {
+        memset((char *)mem_io_write_stream->buffer + mem_io_buffer_info->accessible_length,
+                0,
+                mem_io_buffer_info->pos - mem_io_buffer_info->accessible_length);
+    }
+
+    memcpy((char *)mem_io_write_stream->buffer + mem_io_buffer_info->pos, buf, size_to_write);
+    mem_io_buffer_info->pos = end_pos;
+
+    if (mem_io_buffer_info->pos > mem_io_buffer_info->accessible_length) {
+        mem_io_buffer_info->accessible_length = mem_io_buffer_info->pos;
+    }
+
+    *written_size = size_to_write;
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_growable_memory_strict_write(void *stream, const void *buf, size_t size_to_write) {
+
+    size_t written_size;
+
+    SAIL_TRY(io_growable_memory_tolerant_write(stream, buf, size_to_write, &written_size));
+
+    if (written_size != size_to_write) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_WRITE_IO);
+    }
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_growable_memory_seek(void *stream, long offset, int whence) {
+
+    SAIL_CHECK_PTR(stream);
+
+    struct mem_io_buffer_info *mem_io_buffer_info = (struct mem_io_buffer_info *)stream;
+
+    size_t base_pos;
+
+    switch (whence) {
+        case SEEK_SET: {
+            base_pos = 0;
+            break;
+        }
+
+        case SEEK_CUR: {
+            base_pos = mem_io_buffer_info->pos;
+            break;
+        }
+
+        case SEEK_END: {
+            base_pos = mem_io_buffer_info->accessible_length;
+            break;
+        }
+
+        default: {
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_SEEK_WHENCE);
+        }
+    }
+
+    if (offset < 0 && (size_t)(-offset) > base_pos) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_SEEK_IO);
+    }
+
+    /* Seeking past the end is allowed. The gap is zeroed on the next write. */
+    mem_io_buffer_info->pos = base_pos + offset;
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_growable_memory_close(void *stream) {
+
+    SAIL_CHECK_PTR(stream);
+
+    struct mem_io_write_stream *mem_io_write_stream = (struct mem_io_write_stream *)stream;
+
+    sail_free(mem_io_write_stream->buffer);
+    sail_free(mem_io_write_stream);
+
+    return SAIL_OK;
+}
+
 static sail_status_t io_memory_eof(void *stream, bool *result) {
 
     SAIL_CHECK_PTR(stream);
@@ -260,6 +383,7 @@ sail_status_t sail_alloc_io_read_memory(const void *buffer, size_t length, struc
     mem_io_read_stream->mem_io_buffer_info.pos               = 0;
     mem_io_read_stream->buffer                               = buffer;
 
+    io_local->features       = SAIL_IO_FEATURE_SEEKABLE;
     io_local->stream         = mem_io_read_stream;
     io_local->tolerant_read  = io_memory_tolerant_read;
     io_local->strict_read    = io_memory_strict_read;
@@ -312,3 +436,76 @@ sail_status_t sail_alloc_io_read_write_memory(void *buffer, size_t length, struc
 
     return SAIL_OK;
 }
+
+sail_status_t sail_alloc_io_write_memory(void *buffer, size_t length, struct sail_io **io) {
+
+    SAIL_TRY(sail_alloc_io_read_write_memory(buffer, length, io));
+
+    /* Nothing is written yet. */
+    struct mem_io_write_stream *mem_io_write_stream = (*io)->stream;
+    mem_io_write_stream->mem_io_buffer_info.accessible_length = 0;
+
+    return SAIL_OK;
+}
+
+sail_status_t sail_alloc_io_write_growable_memory(struct sail_io **io) {
+
+    SAIL_CHECK_PTR(io);
+
+    SAIL_LOG_DEBUG("Opening growable memory buffer for writing");
+
+    struct sail_io *io_local;
+    SAIL_TRY(sail_alloc_io(&io_local));
+
+    void *ptr;
+    SAIL_TRY_OR_CLEANUP(sail_malloc(sizeof(struct mem_io_write_stream), &ptr),
+                        /* cleanup */ sail_destroy_io(io_local));
+    struct mem_io_write_stream *mem_io_write_stream = ptr;
+
+    mem_io_write_stream->mem_io_buffer_info.length            = 0;
+    mem_io_write_stream->mem_io_buffer_info.accessible_length = 0;
+    mem_io_write_stream->mem_io_buffer_info.pos               = 0;
+    mem_io_write_stream->buffer                               = NULL;
+
+    io_local->features       = SAIL_IO_FEATURE_SEEKABLE;
+    io_local->stream         = mem_io_write_stream;
+    io_local->tolerant_read  = io_memory_tolerant_read;
+    io_local->strict_read    = io_memory_strict_read;
+    io_local->tolerant_write = io_growable_memory_tolerant_write;
+    io_local->strict_write   = io_growable_memory_strict_write;
+    io_local->seek           = io_growable_memory_seek;
+    io_local->tell           = io_memory_tell;
+    io_local->flush          = io_memory_flush;
+    io_local->close          = io_growable_memory_close;
+    io_local->eof            = io_memory_eof;
+
+    *io = io_local;
+
+    return SAIL_OK;
+}
+
+sail_status_t sail_io_take_buffer(struct sail_io *io, void **buffer, size_t *buffer_size) {
+
+    SAIL_CHECK_PTR(io);
+    SAIL_CHECK_PTR(io->stream);
+    SAIL_CHECK_PTR(buffer);
+    SAIL_CHECK_PTR(buffer_size);
+
+    if (io->close != io_growable_memory_close) {
+        SAIL_LOG_ERROR("Only growable memory I/O streams can hand their buffers over");
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_INVALID_IO);
+    }
+
+    struct mem_io_write_stream *mem_io_write_stream = io->stream;
+    struct mem_io_buffer_info *mem_io_buffer_info = &mem_io_write_stream->mem_io_buffer_info;
+
+    *buffer      = mem_io_write_stream->buffer;
+    *buffer_size = mem_io_buffer_info->accessible_length;
+
+    mem_io_write_stream->buffer           = NULL;
+    mem_io_buffer_info->length            = 0;
+    mem_io_buffer_info->accessible_length = 0;
+    mem_io_buffer_info->pos               = 0;
+
+    return SAIL_OK;
+}
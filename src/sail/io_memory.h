@@ -51,6 +51,38 @@ SAIL_EXPORT sail_status_t sail_alloc_io_read_memory(const void *buffer, size_t l
  */
 SAIL_EXPORT sail_status_t sail_alloc_io_read_write_memory(void *buffer, size_t length, struct sail_io **io);
 
+/*
+ * Opens the specified memory buffer for writing and allocates a new I/O object for it.
+ * In contrast to sail_alloc_io_read_write_memory(), the buffer is treated as empty. Reading
+ * and seeking to the end are limited to the data written so far, so the stream size
+ * is the exact number of bytes written.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_alloc_io_write_memory(void *buffer, size_t length, struct sail_io **io);
+
+/*
+ * Allocates a new I/O object that writes into a memory buffer allocated and grown by SAIL.
+ * The buffer grows geometrically, so there is no need to guess the size of the output
+ * beforehand. The written data can be read back. Use sail_io_take_buffer() to get the data.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_alloc_io_write_growable_memory(struct sail_io **io);
+
+/*
+ * Hands the buffer of the growable memory I/O object allocated with sail_alloc_io_write_growable_memory()
+ * over to the caller without copying. Assigns the exact number of bytes written to the 'buffer_size'
+ * argument. The buffer may be NULL if nothing was written. The caller must free the buffer
+ * with sail_free().
+ *
+ * The I/O object becomes empty and can be used to write new data.
+ *
+ * Returns SAIL_OK on success.
+ * Returns SAIL_ERROR_INVALID_IO if the I/O object is not a growable memory I/O object.
+ */
+SAIL_EXPORT sail_status_t sail_io_take_buffer(struct sail_io *io, void **buffer, size_t *buffer_size);
+
 /* extern "C" */
 #ifdef __cplusplus
 }
@@ -0,0 +1,289 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <sail/sail.h>
+
+struct read_ahead_stream {
+
+    struct sail_io *source;
+
+    /* The last read bytes. The first byte is at the 'buffer_offset' stream position. */
+    unsigned char *buffer;
+    size_t buffer_capacity;
+    size_t buffer_length;
+    size_t buffer_offset;
+
+    /* Current stream position. */
+    size_t pos;
+
+    bool source_eof;
+};
+
+/*
+ * Private functions.
+ */
+
+/* Reads more data from the source into the buffer dropping the oldest bytes when it's full. */
+static sail_status_t read_ahead_fill(struct read_ahead_stream *read_ahead_stream, size_t *read_size) {
+
+    *read_size = 0;
+
+    if (read_ahead_stream->source_eof) {
+        return SAIL_OK;
+    }
+
+    /* Read in half-window chunks to amortize moving the kept bytes. */
+    const size_t size_to_read = (read_ahead_stream->buffer_capacity + 1) / 2;
+
+    if (read_ahead_stream->buffer_length + size_to_read > read_ahead_stream->buffer_capacity) {
+        const size_t drop = read_ahead_stream->buffer_length + size_to_read - read_ahead_stream->buffer_capacity;
+
+        memmove(read_ahead_stream->buffer, read_ahead_stream->buffer + drop, read_ahead_stream->buffer_length - drop);
+        read_ahead_stream->buffer_length -= drop;
+        read_ahead_stream->buffer_offset += drop;
+    }
+
+    const sail_status_t status = read_ahead_stream->source->tolerant_read(read_ahead_stream->source->stream,
+                                                                          read_ahead_stream->buffer + read_ahead_stream->buffer_length,
+                                                                          size_to_read,
+                                                                          read_size);
+
+    if (status == SAIL_ERROR_EOF || (status == SAIL_OK && *read_size == 0)) {
+        read_ahead_stream->source_eof = true;
+        *read_size = 0;
+        return SAIL_OK;
+    }
+
+    SAIL_TRY(status);
+
+    read_ahead_stream->buffer_length += *read_size;
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_read_ahead_tolerant_read(void *stream, void *buf, size_t size_to_read, size_t *read_size) {
+
+    SAIL_CHECK_PTR(stream);
+    SAIL_CHECK_PTR(buf);
+    SAIL_CHECK_PTR(read_size);
+
+    struct read_ahead_stream *read_ahead_stream = stream;
+
+    *read_size = 0;
+
+    while (*read_size < size_to_read) {
+        const size_t buffer_end = read_ahead_stream->buffer_offset + read_ahead_stream->buffer_length;
+
+        /* Serve from the buffer. */
+        if (read_ahead_stream->pos < buffer_end) {
+            const size_t available = buffer_end - read_ahead_stream->pos;
+            const size_t size_to_copy = (size_to_read - *read_size < available) ? size_to_read - *read_size : available;
+
+            memcpy((unsigned char *)buf + *read_size,
+                    read_ahead_stream->buffer + (read_ahead_stream->pos - read_ahead_stream->buffer_offset),
+                    size_to_copy);
+
+            read_ahead_stream->pos += size_to_copy;
+            *read_size += size_to_copy;
+            continue;
+        }
+
+        size_t filled;
+        SAIL_TRY(read_ahead_fill(read_ahead_stream, &filled));
+
+        if (filled == 0) {
+            break;
+        }
+    }
+
+    if (*read_size == 0 && size_to_read > 0) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_EOF);
+    }
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_read_ahead_strict_read(void *stream, void *buf, size_t size_to_read) {
+
+    size_t read_size;
+
+    SAIL_TRY(io_read_ahead_tolerant_read(stream, buf, size_to_read, &read_size));
+
+    if (read_size != size_to_read) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_READ_IO);
+    }
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_read_ahead_seek(void *stream, long offset, int whence) {
+
+    SAIL_CHECK_PTR(stream);
+
+    struct read_ahead_stream *read_ahead_stream = stream;
+
+    size_t base_pos;
+
+    switch (whence) {
+        case SEEK_SET: {
+            base_pos = 0;
+            break;
+        }
+
+        case SEEK_CUR: {
+            base_pos = read_ahead_stream->pos;
+            break;
+        }
+
+        default: {
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_SEEK_WHENCE);
+        }
+    }
+
+    if (offset < 0 && (size_t)(-offset) > base_pos) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_SEEK_IO);
+    }
+
+    const size_t new_pos = base_pos + offset;
+
+    /* The data before the window is gone. */
+    if (new_pos < read_ahead_stream->buffer_offset) {
+        SAIL_LOG_ERROR("Cannot seek to %lu: only the last %lu bytes are kept",
+                        (unsigned long)new_pos, (unsigned long)read_ahead_stream->buffer_capacity);
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_SEEK_IO);
+    }
+
+    /* Read and discard the data up to the new position. */
+    while (new_pos > read_ahead_stream->buffer_offset + read_ahead_stream->buffer_length) {
+        size_t filled;
+        SAIL_TRY(read_ahead_fill(read_ahead_stream, &filled));
+
+        if (filled == 0) {
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_EOF);
+        }
+    }
+
+    read_ahead_stream->pos = new_pos;
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_read_ahead_tell(void *stream, size_t *offset) {
+
+    SAIL_CHECK_PTR(stream);
+    SAIL_CHECK_PTR(offset);
+
+    struct read_ahead_stream *read_ahead_stream = stream;
+
+    *offset = read_ahead_stream->pos;
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_read_ahead_close(void *stream) {
+
+    SAIL_CHECK_PTR(stream);
+
+    struct read_ahead_stream *read_ahead_stream = stream;
+
+    sail_free(read_ahead_stream->buffer);
+    sail_free(read_ahead_stream);
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_read_ahead_eof(void *stream, bool *result) {
+
+    SAIL_CHECK_PTR(stream);
+    SAIL_CHECK_PTR(result);
+
+    struct read_ahead_stream *read_ahead_stream = stream;
+
+    /* Look ahead to detect the end of the source. */
+    if (read_ahead_stream->pos >= read_ahead_stream->buffer_offset + read_ahead_stream->buffer_length) {
+        size_t filled;
+        SAIL_TRY(read_ahead_fill(read_ahead_stream, &filled));
+    }
+
+    *result = read_ahead_stream->pos >= read_ahead_stream->buffer_offset + read_ahead_stream->buffer_length;
+
+    return SAIL_OK;
+}
+
+/*
+ * Public functions.
+ */
+
+sail_status_t sail_alloc_io_read_ahead(struct sail_io *source, size_t window, struct sail_io **io) {
+
+    SAIL_TRY(sail_check_io_valid(source));
+    SAIL_CHECK_PTR(io);
+
+    if (window == 0) {
+        SAIL_LOG_ERROR("The read-ahead window must not be empty");
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_INVALID_ARGUMENT);
+    }
+
+    SAIL_LOG_DEBUG("Opening read-ahead I/O stream with the window of %lu bytes", (unsigned long)window);
+
+    struct sail_io *io_local;
+    SAIL_TRY(sail_alloc_io(&io_local));
+
+    void *ptr;
+    SAIL_TRY_OR_CLEANUP(sail_malloc(sizeof(struct read_ahead_stream), &ptr),
+                        /* cleanup */ sail_destroy_io(io_local));
+    struct read_ahead_stream *read_ahead_stream = ptr;
+
+    SAIL_TRY_OR_CLEANUP(sail_malloc(window, &ptr),
+                        /* cleanup */ sail_free(read_ahead_stream),
+                                      sail_destroy_io(io_local));
+
+    read_ahead_stream->source          = source;
+    read_ahead_stream->buffer          = ptr;
+    read_ahead_stream->buffer_capacity = window;
+    read_ahead_stream->buffer_length   = 0;
+    read_ahead_stream->buffer_offset   = 0;
+    read_ahead_stream->pos             = 0;
+    read_ahead_stream->source_eof      = false;
+
+    io_local->features       = 0;
+    io_local->stream         = read_ahead_stream;
+    io_local->tolerant_read  = io_read_ahead_tolerant_read;
+    io_local->strict_read    = io_read_ahead_strict_read;
+    io_local->tolerant_write = sail_io_noop_tolerant_write;
+    io_local->strict_write   = sail_io_noop_strict_write;
+    io_local->seek           = io_read_ahead_seek;
+    io_local->tell           = io_read_ahead_tell;
+    io_local->flush          = sail_io_noop_flush;
+    io_local->close          = io_read_ahead_close;
+    io_local->eof            = io_read_ahead_eof;
+
+    *io = io_local;
+
+    return SAIL_OK;
+}
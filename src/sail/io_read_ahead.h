@@ -0,0 +1,69 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_IO_READ_AHEAD_H
+#define SAIL_IO_READ_AHEAD_H
+
+#include <stddef.h> /* size_t */
+
+#include <sail-common/export.h>
+#include <sail-common/status.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct sail_io;
+
+/*
+ * Allocates a new I/O object that reads from the specified non-seekable I/O source like a pipe
+ * or a socket. The new I/O object keeps the last 'window' bytes read, so it can seek backwards
+ * within them, for example, to detect the image format by its magic number. Seeking forward
+ * reads and discards data. Seeking relative to the end is not supported.
+ *
+ * The new I/O object is not marked as seekable. When loading from it, codecs that cannot read
+ * forward only (see SAIL_CODEC_FEATURE_STREAMING) get the rest of the stream spooled into memory.
+ *
+ * The source must outlive the new I/O object. Destroying the new I/O object doesn't close the source.
+ *
+ * Typical usage: sail_alloc_io()                               ->
+ *                set I/O callbacks                             ->
+ *                sail_alloc_io_read_ahead()                    ->
+ *                sail_codec_info_by_magic_number_from_io()     ->
+ *                sail_start_loading_from_io()                  ->
+ *                sail_load_next_frame()                        ->
+ *                sail_stop_loading()                           ->
+ *                sail_destroy_io() for both I/O objects.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_alloc_io_read_ahead(struct sail_io *source, size_t window, struct sail_io **io);
+
+/* extern "C" */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -92,6 +92,8 @@ sail_status_t SAIL_CONSTRUCT_CODEC_FUNC(sail_codec_load_init_v8)(struct sail_io
  *   - Allocate the image and the source image (sail_image.sail_source_image).
  *   - Fill the expected image properties (width, height, pixel format, image properties etc.) and meta data.
  *     The image pixel format must be as close to the source as possible.
+ *   - Fill the dimensions of the region from the load options clipped with sail_clip_region()
+ *     when the codec info lists the REGION load feature.
  *   - Seek to the next image frame.
  *
  * This function MUST NOT:
@@ -120,6 +122,28 @@ sail_status_t SAIL_CONSTRUCT_CODEC_FUNC(sail_codec_load_seek_next_frame_v8)(void
  */
 sail_status_t SAIL_CONSTRUCT_CODEC_FUNC(sail_codec_load_frame_v8)(void *state, struct sail_image *image);
 
+/*
+ * Seeks to the specified frame. The frame is NOT loaded or decoded. The next call
+ * to sail_codec_load_seek_next_frame_v8() must return the frame with the specified index.
+ * Frame indexes start from 0.
+ *
+ * This function is optional. libsail resolves it only when the codec info lists FRAME-SEEK
+ * in its load features. Otherwise, libsail falls back to restarting the loading
+ * when needed and skipping the preceding frames one by one.
+ *
+ * libsail, the caller of this function, guarantees the following:
+ *   - The state points to the state allocated by sail_codec_load_init_v8().
+ *   - The function is never called between sail_codec_load_seek_next_frame_v8()
+ *     and sail_codec_load_frame_v8().
+ *
+ * This function MUST:
+ *   - Position the codec at the frame with the specified index regardless of the current position.
+ *
+ * Returns SAIL_OK on success.
+ * Returns SAIL_ERROR_NO_MORE_FRAMES when no frame with the specified index is available.
+ */
+sail_status_t SAIL_CONSTRUCT_CODEC_FUNC(sail_codec_load_seek_to_frame_v8)(void *state, unsigned frame);
+
 /*
  * Finilizes loading operation. No more loadings are possible after calling this function.
  * This function doesn't close the io stream. It just stops decoding. Use io->close() or sail_destroy_io()
@@ -209,6 +233,21 @@ sail_status_t SAIL_CONSTRUCT_CODEC_FUNC(sail_codec_save_frame_v8)(void *state, c
  */
 sail_status_t SAIL_CONSTRUCT_CODEC_FUNC(sail_codec_save_finish_v8)(void **state);
 
+/*
+ * Releases process-wide resources the codec keeps between loading or saving operations,
+ * e.g. caches shared by all the states.
+ *
+ * This function is optional. libsail resolves it when it's exported by the codec, and calls it
+ * right before unloading the codec in sail_finish() or sail_unload_codecs(). Combined codecs
+ * must set the SAIL_CODEC_RELEASE target property to ON to get it called.
+ *
+ * libsail, the caller of this function, guarantees the following:
+ *   - No loading or saving operations with this codec are in progress.
+ *
+ * Returns SAIL_OK on success.
+ */
+sail_status_t SAIL_CONSTRUCT_CODEC_FUNC(sail_codec_release_v8)(void);
+
 /* extern "C" */
 #ifdef __cplusplus
 }
@@ -37,6 +37,12 @@ typedef sail_status_t (*sail_codec_load_seek_next_frame_v8_t)(void *state, struc
 typedef sail_status_t (*sail_codec_load_frame_v8_t)(void *state, struct sail_image *image);
 typedef sail_status_t (*sail_codec_load_finish_v8_t)(void **state);
 
+/*
+ * Optional decoding functions.
+ */
+
+typedef sail_status_t (*sail_codec_load_seek_to_frame_v8_t)(void *state, unsigned frame);
+
 /*
  * Encoding functions.
  */
@@ -46,4 +52,10 @@ typedef sail_status_t (*sail_codec_save_seek_next_frame_v8_t)(void *state, const
 typedef sail_status_t (*sail_codec_save_frame_v8_t)(void *state, const struct sail_image *image);
 typedef sail_status_t (*sail_codec_save_finish_v8_t)(void **state);
 
+/*
+ * Optional codec functions.
+ */
+
+typedef sail_status_t (*sail_codec_release_v8_t)(void);
+
 #endif
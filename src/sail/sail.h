@@ -38,6 +38,7 @@
 #include <sail/io_file.h>
 #include <sail/io_memory.h>
 #include <sail/io_noop.h>
+#include <sail/io_read_ahead.h>
 #include <sail/sail_advanced.h>
 #include <sail/sail_deep_diver.h>
 #include <sail/sail_junior.h>
@@ -48,6 +49,7 @@
     #include <sail/codec_bundle_node_private.h>
     #include <sail/codec_bundle_private.h>
     #include <sail/codec_info_private.h>
+    #include <sail/codec_registry_private.h>
     #include <sail/codec_layout.h>
     #include <sail/context_private.h>
     #include <sail/ini.h>
@@ -24,6 +24,7 @@
 */
 
 #include <stddef.h>
+#include <stdio.h> /* SEEK_SET */
 #include <stdlib.h>
 
 #include <sail/sail.h>
@@ -91,19 +92,30 @@ sail_status_t sail_start_loading_from_memory(const void *buffer, size_t buffer_s
     return SAIL_OK;
 }
 
-sail_status_t sail_load_next_frame(void *state, struct sail_image **image) {
+/* Pixels are never allocated from the arena. */
+static sail_status_t alloc_pixels(struct sail_image *image) {
 
-    SAIL_CHECK_PTR(state);
-    SAIL_CHECK_PTR(image);
+    struct sail_arena *arena = sail_set_current_arena(NULL);
+    const sail_status_t status = sail_malloc(sail_bytes_per_image(image), &image->pixels);
+    sail_set_current_arena(arena);
 
-    struct hidden_state *state_of_mind = (struct hidden_state *)state;
+    SAIL_TRY(status);
 
-    SAIL_TRY(sail_check_io_valid(state_of_mind->io));
-    SAIL_CHECK_PTR(state_of_mind->state);
-    SAIL_CHECK_PTR(state_of_mind->codec);
+    return SAIL_OK;
+}
+
+static sail_status_t load_next_frame(struct hidden_state *state_of_mind, struct sail_image **image) {
 
     struct sail_image *image_local;
-    SAIL_TRY(state_of_mind->codec->v8->load_seek_next_frame(state_of_mind->state, &image_local));
+
+    if (state_of_mind->peeked_image != NULL) {
+        image_local = state_of_mind->peeked_image;
+        state_of_mind->peeked_image = NULL;
+    } else {
+        SAIL_TRY(state_of_mind->codec->v8->load_seek_next_frame(state_of_mind->state, &image_local));
+    }
+
+    state_of_mind->current_frame++;
 
     if (image_local->pixels != NULL) {
         SAIL_LOG_ERROR("Internal error in %s codec: codecs must not allocate pixels", state_of_mind->codec_info->name);
@@ -111,27 +123,91 @@ sail_status_t sail_load_next_frame(void *state, struct sail_image **image) {
         SAIL_LOG_AND_RETURN(SAIL_ERROR_CONFLICTING_OPERATION);
     }
 
-    /* Allocate pixels. */
-    const size_t pixels_size = (size_t)image_local->height * image_local->bytes_per_line;
-    SAIL_TRY_OR_CLEANUP(sail_malloc(pixels_size, &image_local->pixels),
+    SAIL_TRY_OR_CLEANUP(alloc_pixels(image_local),
                         /* cleanup */ sail_destroy_image(image_local));
 
     SAIL_TRY_OR_CLEANUP(state_of_mind->codec->v8->load_frame(state_of_mind->state, image_local),
                         /* cleanup */ sail_destroy_image(image_local));
 
+    /* Cropping and rotating allocate pixels. */
+    sail_set_current_arena(NULL);
+
+    /* The codec decoded the whole frame, so crop it to the requested region. */
+    if ((state_of_mind->codec_info->load_features->features & SAIL_CODEC_FEATURE_REGION) == 0) {
+        struct sail_region region;
+        SAIL_TRY_OR_CLEANUP(sail_clip_region(&state_of_mind->load_options->region, image_local->width, image_local->height, &region),
+                            /* cleanup */ sail_destroy_image(image_local));
+        SAIL_TRY_OR_CLEANUP(sail_crop_image(image_local, region.x, region.y, region.width, region.height),
+                            /* cleanup */ sail_destroy_image(image_local));
+    }
+
+    if (state_of_mind->load_options->options & SAIL_OPTION_APPLY_ORIENTATION) {
+        SAIL_TRY_OR_CLEANUP(apply_exif_orientation(image_local),
+                            /* cleanup */ sail_destroy_image(image_local));
+    }
+
+    if (state_of_mind->discard_meta_data) {
+        sail_destroy_meta_data_node_chain(image_local->meta_data_node);
+        image_local->meta_data_node = NULL;
+    }
+
     *image = image_local;
 
     return SAIL_OK;
 }
 
-sail_status_t sail_stop_loading(void *state) {
+static sail_status_t seek_to_frame(struct hidden_state *state_of_mind, unsigned frame) {
+
+    /*
+     * Seeking backwards needs the beginning of the I/O stream, also in codecs that jump
+     * to frames directly. Fail early instead of leaving the codec in a half-restarted state.
+     */
+    if (frame < state_of_mind->current_frame && (state_of_mind->io->features & SAIL_IO_FEATURE_SEEKABLE) == 0) {
+        SAIL_LOG_ERROR("Failed to seek backwards to frame #%u: the I/O stream is not seekable", frame);
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_NOT_IMPLEMENTED);
+    }
+
+    /* The codec knows how to jump to the frame directly. */
+    if (state_of_mind->codec->v8->load_seek_to_frame != NULL) {
+        SAIL_TRY(state_of_mind->codec->v8->load_seek_to_frame(state_of_mind->state, frame));
+        state_of_mind->current_frame = frame;
 
-    /* Not an error. */
-    if (state == NULL) {
         return SAIL_OK;
     }
 
-    struct hidden_state *state_of_mind = (struct hidden_state *)state;
+    /* Restart loading from the very beginning to seek backwards. */
+    if (frame < state_of_mind->current_frame) {
+        SAIL_LOG_DEBUG("Restarting loading to seek backwards to frame #%u", frame);
+
+        sail_destroy_image(state_of_mind->peeked_image);
+        state_of_mind->peeked_image = NULL;
+
+        SAIL_TRY(state_of_mind->codec->v8->load_finish(&state_of_mind->state));
+        SAIL_TRY(state_of_mind->io->seek(state_of_mind->io->stream, 0, SEEK_SET));
+        SAIL_TRY_OR_CLEANUP(state_of_mind->codec->v8->load_init(state_of_mind->io, state_of_mind->load_options, &state_of_mind->state),
+                            /* cleanup */ state_of_mind->codec->v8->load_finish(&state_of_mind->state));
+
+        state_of_mind->current_frame = 0;
+    }
+
+    /* Codecs may keep decoder state between frames, so skipped frames must be fully loaded. */
+    while (state_of_mind->current_frame < frame) {
+        struct sail_image *image;
+        SAIL_TRY(sail_load_next_frame(state_of_mind, &image));
+        sail_destroy_image(image);
+    }
+
+    /* Fetch the frame header to report a missing frame now. sail_load_next_frame() continues from it. */
+    if (state_of_mind->peeked_image == NULL) {
+        struct sail_image *image;
+        SAIL_TRY(state_of_mind->codec->v8->load_seek_next_frame(state_of_mind->state, &image));
+        state_of_mind->peeked_image = image;
+    }
+
+    return SAIL_OK;
+}
+
+static sail_status_t stop_loading(struct hidden_state *state_of_mind) {
 
     /* Not an error. */
     if (state_of_mind->codec == NULL) {
@@ -147,6 +223,71 @@ sail_status_t sail_stop_loading(void *state) {
     return SAIL_OK;
 }
 
+static sail_status_t write_next_frame(struct hidden_state *state_of_mind, const struct sail_image *image) {
+
+    SAIL_TRY(state_of_mind->codec->v8->save_seek_next_frame(state_of_mind->state, image));
+    SAIL_TRY(state_of_mind->codec->v8->save_frame(state_of_mind->state, image));
+
+    return SAIL_OK;
+}
+
+sail_status_t sail_load_next_frame(void *state, struct sail_image **image) {
+
+    SAIL_CHECK_PTR(state);
+    SAIL_CHECK_PTR(image);
+
+    struct hidden_state *state_of_mind = (struct hidden_state *)state;
+
+    SAIL_TRY(sail_check_io_valid(state_of_mind->io));
+    SAIL_CHECK_PTR(state_of_mind->state);
+    SAIL_CHECK_PTR(state_of_mind->codec);
+
+    struct sail_arena *previous_arena = sail_set_current_arena(state_of_mind->arena);
+    const sail_status_t status = load_next_frame(state_of_mind, image);
+    sail_set_current_arena(previous_arena);
+
+    SAIL_TRY(status);
+
+    return SAIL_OK;
+}
+
+sail_status_t sail_seek_to_frame(void *state, unsigned frame) {
+
+    SAIL_CHECK_PTR(state);
+
+    struct hidden_state *state_of_mind = (struct hidden_state *)state;
+
+    SAIL_TRY(sail_check_io_valid(state_of_mind->io));
+    SAIL_CHECK_PTR(state_of_mind->state);
+    SAIL_CHECK_PTR(state_of_mind->codec);
+
+    struct sail_arena *previous_arena = sail_set_current_arena(state_of_mind->arena);
+    const sail_status_t status = seek_to_frame(state_of_mind, frame);
+    sail_set_current_arena(previous_arena);
+
+    SAIL_TRY(status);
+
+    return SAIL_OK;
+}
+
+sail_status_t sail_stop_loading(void *state) {
+
+    /* Not an error. */
+    if (state == NULL) {
+        return SAIL_OK;
+    }
+
+    struct hidden_state *state_of_mind = (struct hidden_state *)state;
+
+    struct sail_arena *previous_arena = sail_set_current_arena(state_of_mind->arena);
+    const sail_status_t status = stop_loading(state_of_mind);
+    sail_set_current_arena(previous_arena);
+
+    SAIL_TRY(status);
+
+    return SAIL_OK;
+}
+
 sail_status_t sail_start_saving_into_file(const char *path, const struct sail_codec_info *codec_info, void **state) {
 
     SAIL_TRY(sail_start_saving_into_file_with_options(path, codec_info, NULL, state));
@@ -177,8 +318,11 @@ sail_status_t sail_write_next_frame(void *state, const struct sail_image *image)
     SAIL_TRY(allowed_write_output_pixel_format(state_of_mind->codec_info->save_features,
                                                 image->pixel_format));
 
-    SAIL_TRY(state_of_mind->codec->v8->save_seek_next_frame(state_of_mind->state, image));
-    SAIL_TRY(state_of_mind->codec->v8->save_frame(state_of_mind->state, image));
+    struct sail_arena *previous_arena = sail_set_current_arena(state_of_mind->arena);
+    const sail_status_t status = write_next_frame(state_of_mind, image);
+    sail_set_current_arena(previous_arena);
+
+    SAIL_TRY(status);
 
     return SAIL_OK;
 }
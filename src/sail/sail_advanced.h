@@ -110,6 +110,29 @@ SAIL_EXPORT sail_status_t sail_start_loading_from_memory(const void *buffer, siz
  */
 SAIL_EXPORT sail_status_t sail_load_next_frame(void *state, struct sail_image **image);
 
+/*
+ * Seeks to the specified frame of the file started by sail_start_loading_from_file() and brothers.
+ * The next call to sail_load_next_frame() returns the frame with the specified index.
+ * Frame indexes start from 0.
+ *
+ * Codecs with the FRAME-SEEK load feature jump to the frame directly. With other codecs,
+ * SAIL loads and discards the preceding frames, and restarts loading from the beginning
+ * of the I/O stream to seek backwards. With any codec, seeking backwards requires a seekable
+ * I/O stream. Non-seekable streams of codecs without the STREAMING load feature are spooled
+ * into memory when loading starts, so they are seekable.
+ *
+ * Typical usage: sail_start_loading_from_file() ->
+ *                sail_seek_to_frame()           ->
+ *                sail_load_next_frame()         ->
+ *                sail_stop_loading().
+ *
+ * Returns SAIL_OK on success.
+ * Returns SAIL_ERROR_NO_MORE_FRAMES when no frame with the specified index is available.
+ * Returns SAIL_ERROR_NOT_IMPLEMENTED when seeking backwards in a non-seekable I/O stream.
+ * Loading can be continued forward after that.
+ */
+SAIL_EXPORT sail_status_t sail_seek_to_frame(void *state, unsigned frame);
+
 /*
  * Stops loading the file started by sail_start_loading_from_file() and brothers.
  * Does nothing if the state is NULL.
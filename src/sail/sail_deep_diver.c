@@ -99,7 +99,7 @@ sail_status_t sail_start_saving_into_memory_with_options(void *buffer, size_t bu
     SAIL_CHECK_PTR(codec_info);
 
     struct sail_io *io;
-    SAIL_TRY(sail_alloc_io_read_write_memory(buffer, buffer_size, &io));
+    SAIL_TRY(sail_alloc_io_write_memory(buffer, buffer_size, &io));
 
     /* The I/O object will be destroyed in this function. */
     SAIL_TRY(start_saving_io_with_options(io, true, codec_info, save_options, state));
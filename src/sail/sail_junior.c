@@ -174,3 +174,33 @@ sail_status_t sail_save_into_memory(void *buffer, size_t buffer_size, const stru
 
     return SAIL_OK;
 }
+
+sail_status_t sail_save_into_growable_memory(const struct sail_image *image, const struct sail_codec_info *codec_info,
+                                             void **buffer, size_t *buffer_size) {
+
+    SAIL_TRY(sail_check_image_valid(image));
+    SAIL_CHECK_PTR(codec_info);
+    SAIL_CHECK_PTR(buffer);
+    SAIL_CHECK_PTR(buffer_size);
+
+    struct sail_io *io;
+    SAIL_TRY(sail_alloc_io_write_growable_memory(&io));
+
+    void *state = NULL;
+
+    SAIL_TRY_OR_CLEANUP(sail_start_saving_into_io(io, codec_info, &state),
+                        /* cleanup */ sail_stop_saving(state), sail_destroy_io(io));
+
+    SAIL_TRY_OR_CLEANUP(sail_write_next_frame(state, image),
+                        /* cleanup */ sail_stop_saving(state), sail_destroy_io(io));
+
+    SAIL_TRY_OR_CLEANUP(sail_stop_saving(state),
+                        /* cleanup */ sail_destroy_io(io));
+
+    SAIL_TRY_OR_CLEANUP(sail_io_take_buffer(io, buffer, buffer_size),
+                        /* cleanup */ sail_destroy_io(io));
+
+    sail_destroy_io(io);
+
+    return SAIL_OK;
+}
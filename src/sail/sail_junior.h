@@ -98,6 +98,25 @@ SAIL_EXPORT sail_status_t sail_save_into_file(const char *path, const struct sai
  */
 SAIL_EXPORT sail_status_t sail_save_into_memory(void *buffer, size_t buffer_size, const struct sail_image *image, size_t *written);
 
+/*
+ * Saves the specified image into a memory buffer allocated by SAIL with the specified codec.
+ * The buffer grows while saving, so there is no need to guess the size of the output beforehand.
+ *
+ * Assigns the buffer to the 'buffer' argument and the exact number of bytes written
+ * to the 'buffer_size' argument. The caller must free the buffer with sail_free().
+ *
+ * If the selected image format doesn't support the image pixel format, an error is returned.
+ * Consider converting the image into a supported image format beforehand with functions
+ * from sail-manip.
+ *
+ * Typical usage: sail_codec_info_from_extension() ->
+ *                sail_save_into_growable_memory().
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_save_into_growable_memory(const struct sail_image *image, const struct sail_codec_info *codec_info,
+                                                         void **buffer, size_t *buffer_size);
+
 /* extern "C" */
 #ifdef __cplusplus
 }
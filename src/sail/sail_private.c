@@ -106,24 +106,17 @@ void destroy_hidden_state(struct hidden_state *state) {
     sail_destroy_load_options(state->load_options);
     sail_destroy_save_options(state->save_options);
 
+    sail_destroy_image(state->peeked_image);
+
     /* This state must be freed and zeroed by codecs. We free it just in case to avoid memory leaks. */
     sail_free(state->state);
 
+    struct sail_arena *arena = state->arena;
     sail_free(state);
+    sail_destroy_arena(arena);
 }
 
-sail_status_t stop_saving(void *state, size_t *written) {
-
-    if (written != NULL) {
-        *written = 0;
-    }
-
-    /* Not an error. */
-    if (state == NULL) {
-        return SAIL_OK;
-    }
-
-    struct hidden_state *state_of_mind = (struct hidden_state *)state;
+static sail_status_t finish_saving(struct hidden_state *state_of_mind, size_t *written) {
 
     /* Not an error. */
     if (state_of_mind->codec == NULL) {
@@ -146,6 +139,28 @@ sail_status_t stop_saving(void *state, size_t *written) {
     return SAIL_OK;
 }
 
+sail_status_t stop_saving(void *state, size_t *written) {
+
+    if (written != NULL) {
+        *written = 0;
+    }
+
+    /* Not an error. */
+    if (state == NULL) {
+        return SAIL_OK;
+    }
+
+    struct hidden_state *state_of_mind = (struct hidden_state *)state;
+
+    struct sail_arena *previous_arena = sail_set_current_arena(state_of_mind->arena);
+    const sail_status_t status = finish_saving(state_of_mind, written);
+    sail_set_current_arena(previous_arena);
+
+    SAIL_TRY(status);
+
+    return SAIL_OK;
+}
+
 sail_status_t allowed_write_output_pixel_format(const struct sail_save_features *save_features, enum SailPixelFormat pixel_format) {
 
     SAIL_CHECK_PTR(save_features);
@@ -159,3 +174,37 @@ sail_status_t allowed_write_output_pixel_format(const struct sail_save_features
     print_unsupported_write_pixel_format(pixel_format);
     SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
 }
+
+sail_status_t apply_exif_orientation(struct sail_image *image) {
+
+    for (struct sail_meta_data_node *meta_data_node = image->meta_data_node; meta_data_node != NULL; meta_data_node = meta_data_node->next) {
+        struct sail_variant *value = meta_data_node->meta_data->value;
+
+        if (meta_data_node->meta_data->key != SAIL_META_DATA_EXIF || value->type != SAIL_VARIANT_TYPE_DATA) {
+            continue;
+        }
+
+        enum SailOrientation orientation;
+        SAIL_TRY(sail_exif_orientation(value->value, value->size, &orientation));
+
+        if (orientation == SAIL_ORIENTATION_NORMAL) {
+            return SAIL_OK;
+        }
+
+        if (sail_rotate_image(image, orientation) != SAIL_OK) {
+            SAIL_LOG_WARNING("Failed to apply %s orientation to %s image, leaving it as is",
+                                sail_orientation_to_string(orientation), sail_pixel_format_to_string(image->pixel_format));
+            return SAIL_OK;
+        }
+
+        SAIL_TRY(sail_reset_exif_orientation(value->value, value->size));
+
+        if (image->source_image != NULL) {
+            image->source_image->orientation = orientation;
+        }
+
+        return SAIL_OK;
+    }
+
+    return SAIL_OK;
+}
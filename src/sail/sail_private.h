@@ -33,8 +33,10 @@
 #include <sail-common/export.h>
 #include <sail-common/status.h>
 
+struct sail_arena;
 struct sail_codec_info;
 struct sail_codec;
+struct sail_image;
 struct sail_save_features;
 
 struct hidden_state {
@@ -48,6 +50,24 @@ struct hidden_state {
     /* Local state passed to codec loading and saving functions. */
     void *state;
 
+    /* Index of the frame to be returned by the next sail_load_next_frame() call. */
+    unsigned current_frame;
+
+    /*
+     * Header of the current frame already fetched from the codec by sail_seek_to_frame()
+     * to make sure the frame exists. NULL otherwise.
+     */
+    struct sail_image *peeked_image;
+
+    /* Meta data is loaded only to apply the EXIF orientation and must not be returned. */
+    bool discard_meta_data;
+
+    /*
+     * Arena of SAIL_OPTION_ARENA made current while the codec is called. NULL otherwise.
+     * Destroyed last, so the state itself may be allocated from it.
+     */
+    struct sail_arena *arena;
+
     /* Shallow pointers to internal data structures so no need to free these. */
     const struct sail_codec_info *codec_info;
     const struct sail_codec *codec;
@@ -60,6 +80,12 @@ SAIL_HIDDEN void destroy_hidden_state(struct hidden_state *state);
 
 SAIL_HIDDEN sail_status_t stop_saving(void *state, size_t *written);
 
+/*
+ * Rotates the loaded image according to the orientation tag of its EXIF meta data
+ * and resets the tag.
+ */
+SAIL_HIDDEN sail_status_t apply_exif_orientation(struct sail_image *image);
+
 SAIL_HIDDEN sail_status_t allowed_write_output_pixel_format(const struct sail_save_features *save_features, enum SailPixelFormat pixel_format);
 
 #endif
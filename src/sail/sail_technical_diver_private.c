@@ -23,6 +23,7 @@
     SOFTWARE.
 */
 
+#include <stdio.h>
 #include <stdlib.h>
 
 #include <sail/sail.h>
@@ -56,31 +57,75 @@ static sail_status_t allowed_write_compression(const struct sail_save_features *
     SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_COMPRESSION);
 }
 
-/*
- * Public functions.
- */
+/* Copies the rest of the I/O stream into a new seekable memory I/O object. */
+static sail_status_t spool_io_into_memory(struct sail_io *io, struct sail_io **spooled_io) {
 
-sail_status_t start_loading_io_with_options(struct sail_io *io, bool own_io,
-                                            const struct sail_codec_info *codec_info,
-                                            const struct sail_load_options *load_options, void **state) {
+    struct sail_io *spooled_io_local;
+    SAIL_TRY(sail_alloc_io_write_growable_memory(&spooled_io_local));
 
-    SAIL_TRY_OR_CLEANUP(check_io_arguments(io, codec_info, state),
-                        /* cleanup */ if (own_io) sail_destroy_io(io));
+    const size_t chunk_size = 64 * 1024;
+    void *chunk;
+    SAIL_TRY_OR_CLEANUP(sail_malloc(chunk_size, &chunk),
+                        /* cleanup */ sail_destroy_io(spooled_io_local));
 
-    *state = NULL;
+    for (;;) {
+        size_t read_size;
+        const sail_status_t status = io->tolerant_read(io->stream, chunk, chunk_size, &read_size);
+
+        if (status == SAIL_ERROR_EOF || (status == SAIL_OK && read_size == 0)) {
+            break;
+        }
+
+        SAIL_TRY_OR_CLEANUP(status,
+                            /* cleanup */ sail_free(chunk), sail_destroy_io(spooled_io_local));
+        SAIL_TRY_OR_CLEANUP(spooled_io_local->strict_write(spooled_io_local->stream, chunk, read_size),
+                            /* cleanup */ sail_free(chunk), sail_destroy_io(spooled_io_local));
+    }
+
+    sail_free(chunk);
+
+    SAIL_TRY_OR_CLEANUP(spooled_io_local->seek(spooled_io_local->stream, 0, SEEK_SET),
+                        /* cleanup */ sail_destroy_io(spooled_io_local));
+
+    *spooled_io = spooled_io_local;
+
+    return SAIL_OK;
+}
+
+static sail_status_t alloc_hidden_state(struct sail_io *io, bool own_io, const struct sail_codec_info *codec_info,
+                                        struct sail_arena *arena, struct hidden_state **state) {
 
     void *ptr;
     SAIL_TRY_OR_CLEANUP(sail_malloc(sizeof(struct hidden_state), &ptr),
-                        /* cleanup */ if (own_io) sail_destroy_io(io));
+                        /* cleanup */ if (own_io) sail_destroy_io(io),
+                                      sail_destroy_arena(arena));
     struct hidden_state *state_of_mind = ptr;
 
-    state_of_mind->io           = io;
-    state_of_mind->own_io       = own_io;
-    state_of_mind->load_options = NULL;
-    state_of_mind->save_options = NULL;
-    state_of_mind->state        = NULL;
-    state_of_mind->codec_info   = codec_info;
-    state_of_mind->codec        = NULL;
+    state_of_mind->io                = io;
+    state_of_mind->own_io            = own_io;
+    state_of_mind->load_options      = NULL;
+    state_of_mind->save_options      = NULL;
+    state_of_mind->state             = NULL;
+    state_of_mind->current_frame     = 0;
+    state_of_mind->peeked_image      = NULL;
+    state_of_mind->discard_meta_data = false;
+    state_of_mind->arena             = arena;
+    state_of_mind->codec_info        = codec_info;
+    state_of_mind->codec             = NULL;
+
+    *state = state_of_mind;
+
+    return SAIL_OK;
+}
+
+/* Called with the arena current. The arena is destroyed with the state on error. */
+static sail_status_t init_loading(struct sail_io *io, bool own_io,
+                                    const struct sail_codec_info *codec_info,
+                                    const struct sail_load_options *load_options,
+                                    struct sail_arena *arena, void **state) {
+
+    struct hidden_state *state_of_mind;
+    SAIL_TRY(alloc_hidden_state(io, own_io, codec_info, arena, &state_of_mind));
 
     SAIL_TRY_OR_CLEANUP(load_codec_by_codec_info(state_of_mind->codec_info, &state_of_mind->codec),
                         /* cleanup */ destroy_hidden_state(state_of_mind));
@@ -93,6 +138,13 @@ sail_status_t start_loading_io_with_options(struct sail_io *io, bool own_io,
                             /* cleanup */ destroy_hidden_state(state_of_mind));
     }
 
+    /* The EXIF orientation is fetched from meta data. */
+    if ((state_of_mind->load_options->options & SAIL_OPTION_APPLY_ORIENTATION) &&
+            !(state_of_mind->load_options->options & SAIL_OPTION_META_DATA)) {
+        state_of_mind->load_options->options |= SAIL_OPTION_META_DATA;
+        state_of_mind->discard_meta_data = true;
+    }
+
     SAIL_TRY_OR_CLEANUP(state_of_mind->codec->v8->load_init(state_of_mind->io, state_of_mind->load_options, &state_of_mind->state),
                         /* cleanup */ state_of_mind->codec->v8->load_finish(&state_of_mind->state),
                                       destroy_hidden_state(state_of_mind));
@@ -102,6 +154,81 @@ sail_status_t start_loading_io_with_options(struct sail_io *io, bool own_io,
     return SAIL_OK;
 }
 
+/* Called with the arena current. The arena is destroyed with the state on error. */
+static sail_status_t init_saving(struct sail_io *io, bool own_io,
+                                    const struct sail_codec_info *codec_info,
+                                    const struct sail_save_options *save_options,
+                                    struct sail_arena *arena, void **state) {
+
+    struct hidden_state *state_of_mind;
+    SAIL_TRY(alloc_hidden_state(io, own_io, codec_info, arena, &state_of_mind));
+
+    SAIL_TRY_OR_CLEANUP(load_codec_by_codec_info(state_of_mind->codec_info, &state_of_mind->codec),
+                        /* cleanup */ destroy_hidden_state(state_of_mind));
+
+    if (save_options == NULL) {
+        SAIL_TRY_OR_CLEANUP(sail_alloc_save_options_from_features(state_of_mind->codec_info->save_features, &state_of_mind->save_options),
+                            /* cleanup */ destroy_hidden_state(state_of_mind));
+    } else {
+        SAIL_TRY_OR_CLEANUP(sail_copy_save_options(save_options, &state_of_mind->save_options),
+                            /* cleanup */ destroy_hidden_state(state_of_mind));
+    }
+
+    SAIL_TRY_OR_CLEANUP(state_of_mind->codec->v8->save_init(state_of_mind->io, state_of_mind->save_options, &state_of_mind->state),
+                        /* cleanup */ state_of_mind->codec->v8->save_finish(&state_of_mind->state),
+                                      destroy_hidden_state(state_of_mind));
+
+    *state = state_of_mind;
+
+    return SAIL_OK;
+}
+
+/*
+ * Public functions.
+ */
+
+sail_status_t start_loading_io_with_options(struct sail_io *io, bool own_io,
+                                            const struct sail_codec_info *codec_info,
+                                            const struct sail_load_options *load_options, void **state) {
+
+    SAIL_TRY_OR_CLEANUP(check_io_arguments(io, codec_info, state),
+                        /* cleanup */ if (own_io) sail_destroy_io(io));
+
+    *state = NULL;
+
+    /* Codecs that need random access cannot load from non-seekable streams directly. */
+    if ((io->features & SAIL_IO_FEATURE_SEEKABLE) == 0 &&
+            (codec_info->load_features->features & SAIL_CODEC_FEATURE_STREAMING) == 0) {
+        SAIL_LOG_DEBUG("%s codec needs random access, spooling the non-seekable I/O stream into memory", codec_info->name);
+
+        struct sail_io *spooled_io;
+        SAIL_TRY_OR_CLEANUP(spool_io_into_memory(io, &spooled_io),
+                            /* cleanup */ if (own_io) sail_destroy_io(io));
+
+        if (own_io) {
+            sail_destroy_io(io);
+        }
+
+        io     = spooled_io;
+        own_io = true;
+    }
+
+    struct sail_arena *arena = NULL;
+
+    if (load_options != NULL && (load_options->options & SAIL_OPTION_ARENA)) {
+        SAIL_TRY_OR_CLEANUP(sail_alloc_arena(&arena),
+                            /* cleanup */ if (own_io) sail_destroy_io(io));
+    }
+
+    struct sail_arena *previous_arena = sail_set_current_arena(arena);
+    const sail_status_t status = init_loading(io, own_io, codec_info, load_options, arena, state);
+    sail_set_current_arena(previous_arena);
+
+    SAIL_TRY(status);
+
+    return SAIL_OK;
+}
+
 sail_status_t start_saving_io_with_options(struct sail_io *io, bool own_io,
                                            const struct sail_codec_info *codec_info,
                                            const struct sail_save_options *save_options, void **state) {
@@ -120,35 +247,18 @@ sail_status_t start_saving_io_with_options(struct sail_io *io, bool own_io,
                             /* cleanup */ if (own_io) sail_destroy_io(io));
     }
 
-    void *ptr;
-    SAIL_TRY_OR_CLEANUP(sail_malloc(sizeof(struct hidden_state), &ptr),
-                        /* cleanup */ if (own_io) sail_destroy_io(io));
-    struct hidden_state *state_of_mind = ptr;
+    struct sail_arena *arena = NULL;
 
-    state_of_mind->io           = io;
-    state_of_mind->own_io       = own_io;
-    state_of_mind->load_options = NULL;
-    state_of_mind->save_options = NULL;
-    state_of_mind->state        = NULL;
-    state_of_mind->codec_info   = codec_info;
-    state_of_mind->codec        = NULL;
-
-    SAIL_TRY_OR_CLEANUP(load_codec_by_codec_info(state_of_mind->codec_info, &state_of_mind->codec),
-                        /* cleanup */ destroy_hidden_state(state_of_mind));
-
-    if (save_options == NULL) {
-        SAIL_TRY_OR_CLEANUP(sail_alloc_save_options_from_features(state_of_mind->codec_info->save_features, &state_of_mind->save_options),
-                            /* cleanup */ destroy_hidden_state(state_of_mind));
-    } else {
-        SAIL_TRY_OR_CLEANUP(sail_copy_save_options(save_options, &state_of_mind->save_options),
-                            /* cleanup */ destroy_hidden_state(state_of_mind));
+    if (save_options != NULL && (save_options->options & SAIL_OPTION_ARENA)) {
+        SAIL_TRY_OR_CLEANUP(sail_alloc_arena(&arena),
+                            /* cleanup */ if (own_io) sail_destroy_io(io));
     }
 
-    SAIL_TRY_OR_CLEANUP(state_of_mind->codec->v8->save_init(state_of_mind->io, state_of_mind->save_options, &state_of_mind->state),
-                        /* cleanup */ state_of_mind->codec->v8->save_finish(&state_of_mind->state),
-                                      destroy_hidden_state(state_of_mind));
+    struct sail_arena *previous_arena = sail_set_current_arena(arena);
+    const sail_status_t status = init_saving(io, own_io, codec_info, save_options, arena, state);
+    sail_set_current_arena(previous_arena);
 
-    *state = state_of_mind;
+    SAIL_TRY(status);
 
     return SAIL_OK;
 }
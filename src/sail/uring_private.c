@@ -0,0 +1,282 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <sail/sail.h>
+
+#include "uring_private.h"
+
+/*
+ * Private functions.
+ */
+
+struct sail_uring {
+    int fd;
+    unsigned entries;
+
+    /* Submission queue. */
+    void *sq_ring;
+    size_t sq_ring_size;
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    struct io_uring_sqe *sqes;
+    size_t sqes_size;
+
+    /* Completion queue. Shares the mapping with the submission queue on newer kernels. */
+    void *cq_ring;
+    size_t cq_ring_size;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    struct io_uring_cqe *cqes;
+};
+
+static int uring_setup(unsigned entries, struct io_uring_params *params) {
+    return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static int uring_register(int fd, unsigned opcode, void *arg, unsigned nr_args) {
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+/* IORING_OP_READ and the probe appeared in Linux 5.6. */
+static bool uring_supports_read(int fd) {
+
+    const size_t probe_size = sizeof(struct io_uring_probe) + IORING_OP_LAST * sizeof(struct io_uring_probe_op);
+    struct io_uring_probe *probe = calloc(1, probe_size);
+
+    if (probe == NULL) {
+        return false;
+    }
+
+    const bool supported = uring_register(fd, IORING_REGISTER_PROBE, probe, IORING_OP_LAST) == 0 &&
+                            probe->last_op >= IORING_OP_READ &&
+                            (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED) != 0;
+
+    free(probe);
+
+    return supported;
+}
+
+static void unmap_uring(struct sail_uring *uring) {
+
+    if (uring->sqes != NULL) {
+        munmap(uring->sqes, uring->sqes_size);
+    }
+
+    if (uring->cq_ring != NULL && uring->cq_ring != uring->sq_ring) {
+        munmap(uring->cq_ring, uring->cq_ring_size);
+    }
+
+    if (uring->sq_ring != NULL) {
+        munmap(uring->sq_ring, uring->sq_ring_size);
+    }
+}
+
+static sail_status_t map_uring(struct sail_uring *uring, const struct io_uring_params *params) {
+
+    uring->sq_ring_size = params->sq_off.array + params->sq_entries * sizeof(unsigned);
+    uring->cq_ring_size = params->cq_off.cqes + params->cq_entries * sizeof(struct io_uring_cqe);
+
+    const bool single_mmap = (params->features & IORING_FEAT_SINGLE_MMAP) != 0;
+
+    if (single_mmap && uring->cq_ring_size > uring->sq_ring_size) {
+        uring->sq_ring_size = uring->cq_ring_size;
+    }
+
+    uring->sq_ring = mmap(NULL, uring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->fd, IORING_OFF_SQ_RING);
+
+    if (uring->sq_ring == MAP_FAILED) {
+        uring->sq_ring = NULL;
+        sail_print_errno("Failed to map the io_uring submission queue: %s");
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_MEMORY_ALLOCATION);
+    }
+
+    if (single_mmap) {
+        uring->cq_ring = uring->sq_ring;
+    } else {
+        uring->cq_ring = mmap(NULL, uring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->fd, IORING_OFF_CQ_RING);
+
+        if (uring->cq_ring == MAP_FAILED) {
+            uring->cq_ring = NULL;
+            sail_print_errno("Failed to map the io_uring completion queue: %s");
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_MEMORY_ALLOCATION);
+        }
+    }
+
+    uring->sqes_size = params->sq_entries * sizeof(struct io_uring_sqe);
+    uring->sqes      = mmap(NULL, uring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->fd, IORING_OFF_SQES);
+
+    if (uring->sqes == MAP_FAILED) {
+        uring->sqes = NULL;
+        sail_print_errno("Failed to map the io_uring submission entries: %s");
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_MEMORY_ALLOCATION);
+    }
+
+    unsigned char *sq_ring = uring->sq_ring;
+    uring->sq_head  = (unsigned *)(sq_ring + params->sq_off.head);
+    uring->sq_tail  = (unsigned *)(sq_ring + params->sq_off.tail);
+    uring->sq_mask  = (unsigned *)(sq_ring + params->sq_off.ring_mask);
+    uring->sq_array = (unsigned *)(sq_ring + params->sq_off.array);
+
+    unsigned char *cq_ring = uring->cq_ring;
+    uring->cq_head = (unsigned *)(cq_ring + params->cq_off.head);
+    uring->cq_tail = (unsigned *)(cq_ring + params->cq_off.tail);
+    uring->cq_mask = (unsigned *)(cq_ring + params->cq_off.ring_mask);
+    uring->cqes    = (struct io_uring_cqe *)(cq_ring + params->cq_off.cqes);
+
+    return SAIL_OK;
+}
+
+/*
+ * Public functions.
+ */
+
+sail_status_t uring_alloc(unsigned entries, struct sail_uring **uring) {
+
+    SAIL_CHECK_PTR(uring);
+
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    const int fd = uring_setup(entries, &params);
+
+    /* Not an error. Callers fall back to regular reads. */
+    if (fd < 0) {
+        SAIL_LOG_DEBUG("io_uring is not available: %s", strerror(errno));
+        return SAIL_ERROR_NOT_IMPLEMENTED;
+    }
+
+    if (!uring_supports_read(fd)) {
+        SAIL_LOG_DEBUG("io_uring doesn't support IORING_OP_READ");
+        close(fd);
+        return SAIL_ERROR_NOT_IMPLEMENTED;
+    }
+
+    void *ptr;
+    SAIL_TRY_OR_CLEANUP(sail_malloc(sizeof(struct sail_uring), &ptr),
+                        /* cleanup */ close(fd));
+    struct sail_uring *uring_local = ptr;
+
+    memset(uring_local, 0, sizeof(struct sail_uring));
+    uring_local->fd      = fd;
+    uring_local->entries = params.sq_entries;
+
+    SAIL_TRY_OR_CLEANUP(map_uring(uring_local, &params),
+                        /* cleanup */ unmap_uring(uring_local), close(fd), sail_free(uring_local));
+
+    *uring = uring_local;
+
+    return SAIL_OK;
+}
+
+void uring_destroy(struct sail_uring *uring) {
+
+    if (uring == NULL) {
+        return;
+    }
+
+    unmap_uring(uring);
+    close(uring->fd);
+    sail_free(uring);
+}
+
+sail_status_t uring_submit_read(struct sail_uring *uring, int fd, void *buf, size_t size, uint64_t offset, uint64_t user_data) {
+
+    SAIL_CHECK_PTR(uring);
+    SAIL_CHECK_PTR(buf);
+
+    const unsigned tail = *uring->sq_tail;
+
+    if (tail - __atomic_load_n(uring->sq_head, __ATOMIC_ACQUIRE) >= uring->entries) {
+        SAIL_LOG_ERROR("The io_uring submission queue is full");
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_READ_IO);
+    }
+
+    const unsigned index = tail & *uring->sq_mask;
+    struct io_uring_sqe *sqe = &uring->sqes[index];
+
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+    sqe->opcode    = IORING_OP_READ;
+    sqe->fd        = fd;
+    sqe->addr      = (uint64_t)(uintptr_t)buf;
+    sqe->len       = (uint32_t)size;
+    sqe->off       = offset;
+    sqe->user_data = user_data;
+
+    uring->sq_array[index] = index;
+    __atomic_store_n(uring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+    while (uring_enter(uring->fd, 1, 0, 0) < 0) {
+        if (errno != EINTR) {
+            sail_print_errno("Failed to submit a read to io_uring: %s");
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_READ_IO);
+        }
+    }
+
+    return SAIL_OK;
+}
+
+sail_status_t uring_wait(struct sail_uring *uring, uint64_t *user_data, int *result) {
+
+    SAIL_CHECK_PTR(uring);
+    SAIL_CHECK_PTR(user_data);
+    SAIL_CHECK_PTR(result);
+
+    for (;;) {
+        const unsigned head = *uring->cq_head;
+
+        if (head != __atomic_load_n(uring->cq_tail, __ATOMIC_ACQUIRE)) {
+            const struct io_uring_cqe *cqe = &uring->cqes[head & *uring->cq_mask];
+
+            *user_data = cqe->user_data;
+            *result    = cqe->res;
+
+            __atomic_store_n(uring->cq_head, head + 1, __ATOMIC_RELEASE);
+
+            return SAIL_OK;
+        }
+
+        if (uring_enter(uring->fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) {
+            sail_print_errno("Failed to wait for io_uring completions: %s");
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_READ_IO);
+        }
+    }
+}
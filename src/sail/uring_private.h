@@ -0,0 +1,73 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_URING_PRIVATE_H
+#define SAIL_URING_PRIVATE_H
+
+#include <stddef.h> /* size_t */
+#include <stdint.h>
+
+#include <sail-common/export.h>
+#include <sail-common/status.h>
+
+/*
+ * Minimal io_uring support for reading files asynchronously on Linux.
+ *
+ * The ring is set up with raw system calls, so liburing is not needed. A ring must be used
+ * by one thread at a time.
+ */
+struct sail_uring;
+
+/*
+ * Sets up a new ring with the specified number of entries.
+ *
+ * Returns SAIL_OK on success. Returns SAIL_ERROR_NOT_IMPLEMENTED when the kernel doesn't support
+ * io_uring, it's disabled, or it doesn't support IORING_OP_READ.
+ */
+SAIL_HIDDEN sail_status_t uring_alloc(unsigned entries, struct sail_uring **uring);
+
+/*
+ * Destroys the ring. Reads in flight must be completed before.
+ */
+SAIL_HIDDEN void uring_destroy(struct sail_uring *uring);
+
+/*
+ * Queues a read of up to size bytes at the specified file offset into the buffer and submits it
+ * to the kernel. The buffer must stay valid until the read is completed. The number of reads
+ * in flight must not exceed the number of entries.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_HIDDEN sail_status_t uring_submit_read(struct sail_uring *uring, int fd, void *buf, size_t size, uint64_t offset, uint64_t user_data);
+
+/*
+ * Waits for any submitted read to complete. Sets result to the number of bytes read
+ * or a negative errno value.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_HIDDEN sail_status_t uring_wait(struct sail_uring *uring, uint64_t *user_data, int *result);
+
+#endif
@@ -0,0 +1,319 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <exception>
+#include <functional>
+#include <tuple>
+#include <vector>
+
+#include <sail-c++/sail-c++.h>
+
+#include "munit.h"
+
+#include "test-images.h"
+
+/* Multi-frame image to load asynchronously. ICO is used as it is always built with all its frames. */
+static const char * const MULTI_FRAME_PATH = SAIL_TEST_IMAGES_PATH "/ico/bpp32-bgra.multiple.ico";
+
+/* Runs posted tasks when asked to, so tests control when an asynchronous operation happens. */
+class manual_executor
+{
+public:
+    sail::executor executor() {
+        return [this](std::function<void()> task) { tasks.push_back(std::move(task)); };
+    }
+
+    void run() {
+        for (const std::function<void()> &task : tasks) {
+            task();
+        }
+
+        tasks.clear();
+    }
+
+    std::vector<std::function<void()>> tasks;
+};
+
+static void assert_same_image(const sail::image &expected, const sail::image &actual) {
+    munit_assert_true(expected.is_valid());
+    munit_assert_true(actual.is_valid());
+    munit_assert_uint(actual.width(), ==, expected.width());
+    munit_assert_uint(actual.height(), ==, expected.height());
+    munit_assert_uint(actual.bytes_per_line(), ==, expected.bytes_per_line());
+    munit_assert(actual.pixel_format() == expected.pixel_format());
+    munit_assert_size(actual.pixels_size(), ==, expected.pixels_size());
+    munit_assert_memory_equal(expected.pixels_size(), actual.pixels(), expected.pixels());
+}
+
+/* Loads all the frames synchronously to compare asynchronous loading against. */
+static std::vector<sail::image> load_frames(const char *path) {
+    std::vector<sail::image> frames;
+
+    sail::image_input input(path);
+    sail::image image;
+
+    while (input.next_frame(&image) == SAIL_OK) {
+        frames.push_back(image);
+    }
+
+    return frames;
+}
+
+static MunitResult test_cancellation_token(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    sail::cancellation_token token;
+    munit_assert_false(token.is_cancelled());
+
+    const sail::cancellation_token copy = token;
+    token.cancel();
+    munit_assert_true(token.is_cancelled());
+    munit_assert_true(copy.is_cancelled());
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_custom_executor(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    std::vector<std::function<void()>> tasks;
+    const sail::executor executor = [&tasks](std::function<void()> task) { tasks.push_back(std::move(task)); };
+
+    /* Not an image. */
+    std::future<std::tuple<sail::image, sail_status_t>> future = sail::load_async(__FILE__, sail::cancellation_token(), executor);
+    munit_assert_size(tasks.size(), ==, 1);
+
+    tasks.front()();
+    const std::tuple<sail::image, sail_status_t> result = future.get();
+    munit_assert_false(std::get<0>(result).is_valid());
+    munit_assert(std::get<1>(result) != SAIL_OK);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_default_executor(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    std::future<std::tuple<sail::image, sail_status_t>> future = sail::load_async(__FILE__);
+    const std::tuple<sail::image, sail_status_t> result = future.get();
+    munit_assert_false(std::get<0>(result).is_valid());
+    munit_assert(std::get<1>(result) != SAIL_OK);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_exception(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    std::future<std::tuple<sail::image, sail_status_t>> future = sail::load_async("non-existing-file.png");
+
+    bool thrown = false;
+
+    try {
+        future.get();
+    } catch (const std::exception &) {
+        thrown = true;
+    }
+
+    munit_assert_true(thrown);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_cancelled_load(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    sail::cancellation_token token;
+    token.cancel();
+
+    std::future<std::tuple<sail::image, sail_status_t>> future = sail::load_async("non-existing-file.png", token);
+    const std::tuple<sail::image, sail_status_t> result = future.get();
+    munit_assert_false(std::get<0>(result).is_valid());
+    munit_assert(std::get<1>(result) == SAIL_ERROR_CANCELLED);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_cancelled_save(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    sail::image image(SAIL_PIXEL_FORMAT_BPP24_RGB, 16, 16);
+    munit_assert(image.is_valid());
+
+    sail::cancellation_token token;
+    token.cancel();
+
+    std::future<sail_status_t> future = sail::save_async("non-existing-file.png", std::move(image), token);
+    munit_assert(future.get() == SAIL_ERROR_CANCELLED);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_load_file(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    if (!sail::codec_info::from_path(MULTI_FRAME_PATH).is_valid()) {
+        return MUNIT_SKIP;
+    }
+
+    const sail::image expected = sail::image_input(MULTI_FRAME_PATH).next_frame();
+
+    std::future<std::tuple<sail::image, sail_status_t>> future = sail::load_async(MULTI_FRAME_PATH);
+    const std::tuple<sail::image, sail_status_t> result = future.get();
+    munit_assert(std::get<1>(result) == SAIL_OK);
+    assert_same_image(expected, std::get<0>(result));
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_input_next_frame(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    if (!sail::codec_info::from_path(MULTI_FRAME_PATH).is_valid()) {
+        return MUNIT_SKIP;
+    }
+
+    const std::vector<sail::image> frames = load_frames(MULTI_FRAME_PATH);
+    munit_assert_size(frames.size(), >, 1);
+
+    sail::image_input input(MULTI_FRAME_PATH);
+
+    for (const sail::image &frame : frames) {
+        std::future<std::tuple<sail::image, sail_status_t>> future = input.next_frame_async();
+        const std::tuple<sail::image, sail_status_t> result = future.get();
+        munit_assert(std::get<1>(result) == SAIL_OK);
+        assert_same_image(frame, std::get<0>(result));
+    }
+
+    std::future<std::tuple<sail::image, sail_status_t>> future = input.next_frame_async();
+    const std::tuple<sail::image, sail_status_t> result = future.get();
+    munit_assert_false(std::get<0>(result).is_valid());
+    munit_assert(std::get<1>(result) == SAIL_ERROR_NO_MORE_FRAMES);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_output_next_frame(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    const sail::codec_info codec_info = sail::codec_info::from_extension("png");
+
+    if (!codec_info.is_valid() || !sail::codec_info::from_path(MULTI_FRAME_PATH).is_valid()) {
+        return MUNIT_SKIP;
+    }
+
+    /* PNG loads RGBA images back as is. */
+    sail::image expected = sail::image_input(MULTI_FRAME_PATH).next_frame();
+    munit_assert_true(expected.is_valid());
+    munit_assert(expected.convert(SAIL_PIXEL_FORMAT_BPP32_RGBA) == SAIL_OK);
+
+    sail::arbitrary_data arbitrary_data;
+
+    {
+        sail::image_output output(&arbitrary_data, codec_info);
+
+        std::future<sail_status_t> future = output.next_frame_async(expected);
+        munit_assert(future.get() == SAIL_OK);
+        munit_assert(output.finish() == SAIL_OK);
+    }
+
+    munit_assert_size(arbitrary_data.size(), >, 0);
+
+    sail::image_input input(arbitrary_data);
+    assert_same_image(expected, input.next_frame());
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_cancelled_next_frame(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    if (!sail::codec_info::from_path(MULTI_FRAME_PATH).is_valid()) {
+        return MUNIT_SKIP;
+    }
+
+    const std::vector<sail::image> frames = load_frames(MULTI_FRAME_PATH);
+    munit_assert_size(frames.size(), >, 1);
+
+    manual_executor executor;
+    sail::cancellation_token token;
+
+    sail::image_input input(MULTI_FRAME_PATH);
+    input.with(token);
+
+    std::future<std::tuple<sail::image, sail_status_t>> first = input.next_frame_async(executor.executor());
+    executor.run();
+    const std::tuple<sail::image, sail_status_t> first_result = first.get();
+    munit_assert(std::get<1>(first_result) == SAIL_OK);
+    assert_same_image(frames.front(), std::get<0>(first_result));
+
+    /* Cancel the load of the second frame after it has been posted, but before it runs. */
+    std::future<std::tuple<sail::image, sail_status_t>> second = input.next_frame_async(executor.executor());
+    munit_assert_size(executor.tasks.size(), ==, 1);
+    token.cancel();
+    executor.run();
+    const std::tuple<sail::image, sail_status_t> second_result = second.get();
+    munit_assert_false(std::get<0>(second_result).is_valid());
+    munit_assert(std::get<1>(second_result) == SAIL_ERROR_CANCELLED);
+
+    return MUNIT_OK;
+}
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/cancellation-token",   test_cancellation_token,   NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/custom-executor",      test_custom_executor,      NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/default-executor",     test_default_executor,     NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/exception",            test_exception,            NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/cancelled-load",       test_cancelled_load,       NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/cancelled-save",       test_cancelled_save,       NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/load-file",            test_load_file,            NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/input-next-frame",     test_input_next_frame,     NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/output-next-frame",    test_output_next_frame,    NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/cancelled-next-frame", test_cancelled_next_frame, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/bindings/c++/async",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
@@ -0,0 +1,152 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <cstring>
+#include <vector>
+
+#include <sail-c++/sail-c++.h>
+
+#include "munit.h"
+
+#include "test-images.h"
+
+static void assert_same_frame(const sail::image &expected, const sail::image &actual) {
+    munit_assert_true(actual.is_valid());
+    munit_assert_uint(actual.width(), ==, expected.width());
+    munit_assert_uint(actual.height(), ==, expected.height());
+    munit_assert(actual.pixel_format() == expected.pixel_format());
+    munit_assert_int(actual.delay(), ==, expected.delay());
+    munit_assert_size(actual.pixels_size(), ==, expected.pixels_size());
+    munit_assert_memory_equal(expected.pixels_size(), actual.pixels(), expected.pixels());
+}
+
+/* Loads all the frames sequentially to compare seeking against. */
+static std::vector<sail::image> load_frames(const char *path) {
+    std::vector<sail::image> frames;
+
+    sail::image_input input(path);
+    sail::image image;
+
+    while (input.next_frame(&image) == SAIL_OK) {
+        frames.push_back(image);
+    }
+
+    return frames;
+}
+
+static MunitResult test_seek(const MunitParameter params[], const std::vector<unsigned> &order) {
+    const char *path = munit_parameters_get(params, "path");
+
+    if (!sail::codec_info::from_path(path).is_valid()) {
+        return MUNIT_SKIP;
+    }
+
+    const std::vector<sail::image> frames = load_frames(path);
+    munit_assert_size(frames.size(), >, 0);
+
+    sail::image_input input(path);
+
+    for (const unsigned percent : order) {
+        /* The order is given in percents of the last frame index. */
+        const unsigned frame = static_cast<unsigned>(frames.size() - 1) * percent / 100;
+        munit_assert(input.seek(frame) == SAIL_OK);
+
+        assert_same_frame(frames[frame], input.next_frame());
+
+        if (frame + 1 < frames.size()) {
+            assert_same_frame(frames[frame + 1], input.next_frame());
+        }
+    }
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_seek_forward(const MunitParameter params[], void *user_data) {
+    (void)user_data;
+
+    return test_seek(params, { 0, 25, 50, 100 });
+}
+
+static MunitResult test_seek_backward(const MunitParameter params[], void *user_data) {
+    (void)user_data;
+
+    return test_seek(params, { 100, 75, 50, 0, 100, 25 });
+}
+
+static MunitResult test_seek_out_of_range(const MunitParameter params[], void *user_data) {
+    (void)user_data;
+
+    const char *path = munit_parameters_get(params, "path");
+
+    if (!sail::codec_info::from_path(path).is_valid()) {
+        return MUNIT_SKIP;
+    }
+
+    const std::vector<sail::image> frames = load_frames(path);
+    munit_assert_size(frames.size(), >, 0);
+
+    sail::image_input input(path);
+
+    munit_assert(input.seek(static_cast<unsigned>(frames.size())) == SAIL_ERROR_NO_MORE_FRAMES);
+    munit_assert(input.seek(static_cast<unsigned>(frames.size()) + 10) == SAIL_ERROR_NO_MORE_FRAMES);
+
+    /* Loading can be continued after a failed seek. */
+    munit_assert(input.seek(0) == SAIL_OK);
+    assert_same_frame(frames[0], input.next_frame());
+
+    return MUNIT_OK;
+}
+
+static char *path_params[] = {
+    (char *)SAIL_TEST_IMAGES_PATH "/gif/bpp8-indexed.animated.gif",
+    (char *)SAIL_TEST_IMAGES_PATH "/ico/bpp32-bgra.multiple.ico",
+    (char *)SAIL_TEST_IMAGES_PATH "/png/bpp32-rgba.animated.png",
+    NULL
+};
+
+static MunitParameterEnum test_params[] = {
+    { (char *)"path", path_params },
+    { NULL, NULL },
+};
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/forward",      test_seek_forward,      NULL, NULL, MUNIT_TEST_OPTION_NONE, test_params },
+    { (char *)"/backward",     test_seek_backward,     NULL, NULL, MUNIT_TEST_OPTION_NONE, test_params },
+    { (char *)"/out-of-range", test_seek_out_of_range, NULL, NULL, MUNIT_TEST_OPTION_NONE, test_params },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/seek",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
@@ -0,0 +1,174 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <string.h>
+
+#include <sail-common/sail-common.h>
+
+#include "munit.h"
+
+/*
+ * 4x3 image, every pixel is its index:
+ *
+ *   0  1  2  3
+ *   4  5  6  7
+ *   8  9 10 11
+ */
+static struct sail_image* alloc_test_image(enum SailPixelFormat pixel_format) {
+
+    struct sail_image *image;
+    munit_assert(sail_alloc_image(&image) == SAIL_OK);
+
+    image->width          = 4;
+    image->height         = 3;
+    image->pixel_format   = pixel_format;
+    image->bytes_per_line = sail_bytes_per_line(image->width, image->pixel_format);
+
+    munit_assert(sail_malloc((size_t)image->height * image->bytes_per_line, &image->pixels) == SAIL_OK);
+
+    const unsigned bytes_per_pixel = sail_bits_per_pixel(pixel_format) / 8;
+
+    for (unsigned row = 0; row < image->height; row++) {
+        uint8_t *scan = sail_scan_line(image, row);
+
+        for (unsigned column = 0; column < image->width; column++) {
+            memset(scan + column * bytes_per_pixel, (int)(row * image->width + column), bytes_per_pixel);
+        }
+    }
+
+    return image;
+}
+
+static MunitResult test_crop(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    const enum SailPixelFormat pixel_formats[] = {
+        SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE,
+        SAIL_PIXEL_FORMAT_BPP24_RGB,
+        SAIL_PIXEL_FORMAT_BPP64_RGBA,
+    };
+
+    for (size_t i = 0; i < sizeof(pixel_formats) / sizeof(pixel_formats[0]); i++) {
+        struct sail_image *image = alloc_test_image(pixel_formats[i]);
+        const unsigned bytes_per_pixel = sail_bits_per_pixel(pixel_formats[i]) / 8;
+
+        munit_assert(sail_crop_image(image, 1, 1, 2, 2) == SAIL_OK);
+
+        munit_assert_uint(image->width, ==, 2);
+        munit_assert_uint(image->height, ==, 2);
+        munit_assert_uint(image->bytes_per_line, ==, sail_bytes_per_line(2, pixel_formats[i]));
+
+        const uint8_t expected[] = { 5, 6, 9, 10 };
+
+        for (unsigned row = 0; row < 2; row++) {
+            const uint8_t *scan = sail_scan_line(image, row);
+
+            for (unsigned column = 0; column < 2; column++) {
+                for (unsigned b = 0; b < bytes_per_pixel; b++) {
+                    munit_assert_uint8(scan[column * bytes_per_pixel + b], ==, expected[row * 2 + column]);
+                }
+            }
+        }
+
+        sail_destroy_image(image);
+    }
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_crop_sub_byte(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image;
+    munit_assert(sail_alloc_image(&image) == SAIL_OK);
+
+    /* 10x2 image, 1 bit per pixel. */
+    image->width          = 10;
+    image->height         = 2;
+    image->pixel_format   = SAIL_PIXEL_FORMAT_BPP1_GRAYSCALE;
+    image->bytes_per_line = sail_bytes_per_line(image->width, image->pixel_format);
+
+    munit_assert(sail_malloc((size_t)image->height * image->bytes_per_line, &image->pixels) == SAIL_OK);
+
+    const uint8_t pixels[] = { 0xB6, 0xC0, 0x5A, 0x40 };
+    memcpy(image->pixels, pixels, sizeof(pixels));
+
+    munit_assert(sail_crop_image(image, 3, 0, 6, 2) == SAIL_OK);
+
+    munit_assert_uint(image->width, ==, 6);
+    munit_assert_uint(image->bytes_per_line, ==, 1);
+
+    /* 1011 0110 11 -> 101101, 0101 1010 01 -> 110100. */
+    const uint8_t *scan = sail_scan_line(image, 0);
+    munit_assert_uint8(scan[0] & 0xFC, ==, 0xB4);
+    scan = sail_scan_line(image, 1);
+    munit_assert_uint8(scan[0] & 0xFC, ==, 0xD0);
+
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_crop_invalid(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image = alloc_test_image(SAIL_PIXEL_FORMAT_BPP24_RGB);
+
+    munit_assert(sail_crop_image(image, 4, 0, 1, 1) == SAIL_ERROR_INCORRECT_IMAGE_DIMENSIONS);
+    munit_assert(sail_crop_image(image, 1, 1, 4, 1) == SAIL_ERROR_INCORRECT_IMAGE_DIMENSIONS);
+    munit_assert(sail_crop_image(image, 0, 0, 0, 1) == SAIL_ERROR_INCORRECT_IMAGE_DIMENSIONS);
+
+    /* Cropping to the whole image is a no-op. */
+    munit_assert(sail_crop_image(image, 0, 0, 4, 3) == SAIL_OK);
+    munit_assert_uint(image->width, ==, 4);
+    munit_assert_uint(image->height, ==, 3);
+
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/crop",          test_crop,          NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/crop-sub-byte", test_crop_sub_byte, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/crop-invalid",  test_crop_invalid,  NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/crop",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
@@ -24,6 +24,7 @@
 */
 
 #include <stddef.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
@@ -355,13 +356,73 @@ static MunitResult test_clear(const MunitParameter params[], void *user_data) {
     return MUNIT_OK;
 }
 
+static MunitResult test_erase_keeps_others(const MunitParameter params[], void *user_data) {
+
+    (void)params;
+    (void)user_data;
+
+    enum {
+        KEYS = 200
+    };
+
+    struct sail_hash_map *hash_map;
+    munit_assert(sail_alloc_hash_map(&hash_map) == SAIL_OK);
+
+    struct sail_variant *value;
+    munit_assert(sail_alloc_variant(&value) == SAIL_OK);
+
+    /* Mix short and long keys. */
+    char key[128];
+
+    for (int i = 0; i < KEYS; i++) {
+        snprintf(key, sizeof(key), (i % 3 == 0) ? "a-pretty-long-key-that-does-not-fit-inline-%d" : "key-%d", i);
+        sail_set_variant_int(value, i);
+        munit_assert(sail_put_hash_map(hash_map, key, value) == SAIL_OK);
+    }
+
+    /* Erase every other key. */
+    for (int i = 0; i < KEYS; i += 2) {
+        snprintf(key, sizeof(key), (i % 3 == 0) ? "a-pretty-long-key-that-does-not-fit-inline-%d" : "key-%d", i);
+        sail_erase_hash_map_key(hash_map, key);
+    }
+
+    munit_assert(sail_hash_map_size(hash_map) == KEYS / 2);
+
+    struct sail_hash_map *hash_map_copy;
+    munit_assert(sail_copy_hash_map(hash_map, &hash_map_copy) == SAIL_OK);
+
+    for (int i = 0; i < KEYS; i++) {
+        snprintf(key, sizeof(key), (i % 3 == 0) ? "a-pretty-long-key-that-does-not-fit-inline-%d" : "key-%d", i);
+
+        const struct sail_hash_map *maps[] = { hash_map, hash_map_copy };
+
+        for (int m = 0; m < 2; m++) {
+            const struct sail_variant *value_in_map = sail_hash_map_value(maps[m], key);
+
+            if (i % 2 == 0) {
+                munit_assert_null(value_in_map);
+            } else {
+                munit_assert_not_null(value_in_map);
+                munit_assert_int(sail_variant_to_int(value_in_map), ==, i);
+            }
+        }
+    }
+
+    sail_destroy_hash_map(hash_map_copy);
+    sail_destroy_variant(value);
+    sail_destroy_hash_map(hash_map);
+
+    return MUNIT_OK;
+}
+
 static MunitTest test_suite_tests[] = {
-    { (char *)"/put",            test_put,            NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
-    { (char *)"/put-erase-many", test_put_erase_many, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
-    { (char *)"/copy",           test_copy,           NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
-    { (char *)"/overwrite",      test_overwrite,      NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
-    { (char *)"/erase",          test_erase,          NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
-    { (char *)"/clear",          test_clear,          NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/put",                test_put,                NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/put-erase-many",     test_put_erase_many,     NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/copy",               test_copy,               NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/overwrite",          test_overwrite,          NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/erase",              test_erase,              NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/erase-keeps-others", test_erase_keeps_others, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/clear",              test_clear,              NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
 
     { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
 };
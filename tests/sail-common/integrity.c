@@ -159,6 +159,19 @@ static MunitResult test_pixel_format_to_string(const MunitParameter params[], vo
     munit_assert_string_equal(sail_pixel_format_to_string(SAIL_PIXEL_FORMAT_BPP48_YUVA), "BPP48-YUVA");
     munit_assert_string_equal(sail_pixel_format_to_string(SAIL_PIXEL_FORMAT_BPP64_YUVA), "BPP64-YUVA");
 
+    munit_assert_string_equal(sail_pixel_format_to_string(SAIL_PIXEL_FORMAT_BPP12_YUV420P), "BPP12-YUV420P");
+    munit_assert_string_equal(sail_pixel_format_to_string(SAIL_PIXEL_FORMAT_BPP16_YUV422P), "BPP16-YUV422P");
+    munit_assert_string_equal(sail_pixel_format_to_string(SAIL_PIXEL_FORMAT_BPP12_NV12),    "BPP12-NV12");
+
+    munit_assert_string_equal(sail_pixel_format_to_string(SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED), "BPP32-RGBA-PREMULTIPLIED");
+    munit_assert_string_equal(sail_pixel_format_to_string(SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED), "BPP32-BGRA-PREMULTIPLIED");
+    munit_assert_string_equal(sail_pixel_format_to_string(SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED), "BPP32-ARGB-PREMULTIPLIED");
+    munit_assert_string_equal(sail_pixel_format_to_string(SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED), "BPP32-ABGR-PREMULTIPLIED");
+    munit_assert_string_equal(sail_pixel_format_to_string(SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED), "BPP64-RGBA-PREMULTIPLIED");
+    munit_assert_string_equal(sail_pixel_format_to_string(SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED), "BPP64-BGRA-PREMULTIPLIED");
+    munit_assert_string_equal(sail_pixel_format_to_string(SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED), "BPP64-ARGB-PREMULTIPLIED");
+    munit_assert_string_equal(sail_pixel_format_to_string(SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED), "BPP64-ABGR-PREMULTIPLIED");
+
     return MUNIT_OK;
 }
 
@@ -256,6 +269,19 @@ static MunitResult test_pixel_format_from_string(const MunitParameter params[],
     munit_assert(sail_pixel_format_from_string("BPP48-YUVA") == SAIL_PIXEL_FORMAT_BPP48_YUVA);
     munit_assert(sail_pixel_format_from_string("BPP64-YUVA") == SAIL_PIXEL_FORMAT_BPP64_YUVA);
 
+    munit_assert(sail_pixel_format_from_string("BPP12-YUV420P") == SAIL_PIXEL_FORMAT_BPP12_YUV420P);
+    munit_assert(sail_pixel_format_from_string("BPP16-YUV422P") == SAIL_PIXEL_FORMAT_BPP16_YUV422P);
+    munit_assert(sail_pixel_format_from_string("BPP12-NV12")    == SAIL_PIXEL_FORMAT_BPP12_NV12);
+
+    munit_assert(sail_pixel_format_from_string("BPP32-RGBA-PREMULTIPLIED") == SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED);
+    munit_assert(sail_pixel_format_from_string("BPP32-BGRA-PREMULTIPLIED") == SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED);
+    munit_assert(sail_pixel_format_from_string("BPP32-ARGB-PREMULTIPLIED") == SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED);
+    munit_assert(sail_pixel_format_from_string("BPP32-ABGR-PREMULTIPLIED") == SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED);
+    munit_assert(sail_pixel_format_from_string("BPP64-RGBA-PREMULTIPLIED") == SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED);
+    munit_assert(sail_pixel_format_from_string("BPP64-BGRA-PREMULTIPLIED") == SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED);
+    munit_assert(sail_pixel_format_from_string("BPP64-ARGB-PREMULTIPLIED") == SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED);
+    munit_assert(sail_pixel_format_from_string("BPP64-ABGR-PREMULTIPLIED") == SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED);
+
     return MUNIT_OK;
 }
 
@@ -561,6 +587,9 @@ static MunitResult test_codec_feature_to_string(const MunitParameter params[], v
     munit_assert_string_equal(sail_codec_feature_to_string(SAIL_CODEC_FEATURE_INTERLACED),   "INTERLACED");
     munit_assert_string_equal(sail_codec_feature_to_string(SAIL_CODEC_FEATURE_ICCP),         "ICCP");
     munit_assert_string_equal(sail_codec_feature_to_string(SAIL_CODEC_FEATURE_SOURCE_IMAGE), "SOURCE-IMAGE");
+    munit_assert_string_equal(sail_codec_feature_to_string(SAIL_CODEC_FEATURE_FRAME_SEEK),   "FRAME-SEEK");
+    munit_assert_string_equal(sail_codec_feature_to_string(SAIL_CODEC_FEATURE_REGION),       "REGION");
+    munit_assert_string_equal(sail_codec_feature_to_string(SAIL_CODEC_FEATURE_STREAMING),    "STREAMING");
 
     return MUNIT_OK;
 }
@@ -580,6 +609,9 @@ static MunitResult test_codec_feature_from_string(const MunitParameter params[],
     munit_assert(sail_codec_feature_from_string("INTERLACED")   == SAIL_CODEC_FEATURE_INTERLACED);
     munit_assert(sail_codec_feature_from_string("ICCP")         == SAIL_CODEC_FEATURE_ICCP);
     munit_assert(sail_codec_feature_from_string("SOURCE-IMAGE") == SAIL_CODEC_FEATURE_SOURCE_IMAGE);
+    munit_assert(sail_codec_feature_from_string("FRAME-SEEK")   == SAIL_CODEC_FEATURE_FRAME_SEEK);
+    munit_assert(sail_codec_feature_from_string("REGION")       == SAIL_CODEC_FEATURE_REGION);
+    munit_assert(sail_codec_feature_from_string("STREAMING")    == SAIL_CODEC_FEATURE_STREAMING);
 
     return MUNIT_OK;
 }
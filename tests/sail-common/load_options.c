@@ -23,6 +23,8 @@
     SOFTWARE.
 */
 
+#include <string.h>
+
 #include <sail-common/sail-common.h>
 
 #include "munit.h"
@@ -36,6 +38,8 @@ static MunitResult test_alloc_options(const MunitParameter params[], void *user_
     munit_assert_not_null(load_options);
     munit_assert(load_options->options == 0);
     munit_assert_null(load_options->tuning);
+    munit_assert_uint(load_options->region.width, ==, 0);
+    munit_assert_uint(load_options->region.height, ==, 0);
 
     sail_destroy_load_options(load_options);
 
@@ -50,12 +54,14 @@ static MunitResult test_copy_options(const MunitParameter params[], void *user_d
     munit_assert(sail_alloc_load_options(&load_options) == SAIL_OK);
 
     load_options->options = SAIL_OPTION_ICCP;
+    load_options->region  = (struct sail_region) { 1, 2, 3, 4 };
 
     struct sail_load_options *load_options_copy = NULL;
     munit_assert(sail_copy_load_options(load_options, &load_options_copy) == SAIL_OK);
     munit_assert_not_null(load_options_copy);
 
     munit_assert(load_options_copy->options == load_options->options);
+    munit_assert(memcmp(&load_options_copy->region, &load_options->region, sizeof(struct sail_region)) == 0);
     munit_assert_null(load_options_copy->tuning);
 
     sail_destroy_load_options(load_options_copy);
@@ -81,10 +87,42 @@ static MunitResult test_options_from_features(const MunitParameter params[], voi
     return MUNIT_OK;
 }
 
+static MunitResult test_clip_region(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_region clipped;
+
+    /* Empty regions cover the whole frame. */
+    const struct sail_region empty = { 5, 5, 0, 0 };
+    munit_assert(sail_clip_region(&empty, 100, 50, &clipped) == SAIL_OK);
+    munit_assert_uint(clipped.x, ==, 0);
+    munit_assert_uint(clipped.y, ==, 0);
+    munit_assert_uint(clipped.width, ==, 100);
+    munit_assert_uint(clipped.height, ==, 50);
+
+    const struct sail_region inside = { 10, 20, 30, 10 };
+    munit_assert(sail_clip_region(&inside, 100, 50, &clipped) == SAIL_OK);
+    munit_assert(memcmp(&clipped, &inside, sizeof(struct sail_region)) == 0);
+
+    const struct sail_region overlapping = { 90, 40, 30, 30 };
+    munit_assert(sail_clip_region(&overlapping, 100, 50, &clipped) == SAIL_OK);
+    munit_assert_uint(clipped.x, ==, 90);
+    munit_assert_uint(clipped.y, ==, 40);
+    munit_assert_uint(clipped.width, ==, 10);
+    munit_assert_uint(clipped.height, ==, 10);
+
+    const struct sail_region outside = { 100, 0, 10, 10 };
+    munit_assert(sail_clip_region(&outside, 100, 50, &clipped) == SAIL_ERROR_INCORRECT_IMAGE_DIMENSIONS);
+
+    return MUNIT_OK;
+}
+
 static MunitTest test_suite_tests[] = {
     { (char *)"/alloc", test_alloc_options, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
     { (char *)"/copy", test_copy_options, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
     { (char *)"/from-features", test_options_from_features, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/clip-region", test_clip_region, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
 
     { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
 };
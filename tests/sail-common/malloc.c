@@ -23,6 +23,7 @@
     SOFTWARE.
 */
 
+#include <stdlib.h>
 #include <string.h>
 
 #include <sail-common/sail-common.h>
@@ -93,10 +94,241 @@ static MunitResult test_realloc(const MunitParameter params[], void *user_data)
     return MUNIT_OK;
 }
 
+static unsigned allocations;
+static unsigned deallocations;
+
+static void* counting_malloc(size_t size) {
+    allocations++;
+    return malloc(size);
+}
+
+static void* counting_realloc(void *ptr, size_t size) {
+    if (ptr == NULL) {
+        allocations++;
+    }
+    return realloc(ptr, size);
+}
+
+static void* counting_calloc(size_t nmemb, size_t size) {
+    allocations++;
+    return calloc(nmemb, size);
+}
+
+static void counting_free(void *ptr) {
+    if (ptr != NULL) {
+        deallocations++;
+    }
+    free(ptr);
+}
+
+static MunitResult test_memory_allocator(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    const struct sail_memory_allocator allocator = {
+        .malloc_func  = counting_malloc,
+        .realloc_func = counting_realloc,
+        .calloc_func  = counting_calloc,
+        .free_func    = counting_free,
+    };
+
+    allocations   = 0;
+    deallocations = 0;
+
+    munit_assert(sail_set_memory_allocator(&allocator) == SAIL_OK);
+
+    void *ptr1 = NULL;
+    munit_assert(sail_malloc(16, &ptr1) == SAIL_OK);
+    void *ptr2 = NULL;
+    munit_assert(sail_calloc(4, 4, &ptr2) == SAIL_OK);
+    void *ptr3 = NULL;
+    munit_assert(sail_realloc(16, &ptr3) == SAIL_OK);
+    munit_assert(sail_realloc(32, &ptr3) == SAIL_OK);
+
+    sail_free(ptr1);
+    sail_free(ptr2);
+    sail_free(ptr3);
+
+    munit_assert_uint(allocations, ==, 3);
+    munit_assert_uint(deallocations, ==, 3);
+
+    /* Incomplete allocators are rejected. */
+    const struct sail_memory_allocator incomplete = {
+        .malloc_func  = counting_malloc,
+        .realloc_func = NULL,
+        .calloc_func  = counting_calloc,
+        .free_func    = counting_free,
+    };
+    munit_assert(sail_set_memory_allocator(&incomplete) == SAIL_ERROR_NULL_PTR);
+
+    /* Restore the standard allocator. */
+    munit_assert(sail_set_memory_allocator(NULL) == SAIL_OK);
+
+    void *ptr4 = NULL;
+    munit_assert(sail_malloc(16, &ptr4) == SAIL_OK);
+    sail_free(ptr4);
+
+    munit_assert_uint(allocations, ==, 3);
+    munit_assert_uint(deallocations, ==, 3);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_arena(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    const struct sail_memory_allocator allocator = {
+        .malloc_func  = counting_malloc,
+        .realloc_func = counting_realloc,
+        .calloc_func  = counting_calloc,
+        .free_func    = counting_free,
+    };
+
+    allocations   = 0;
+    deallocations = 0;
+
+    munit_assert(sail_set_memory_allocator(&allocator) == SAIL_OK);
+
+    struct sail_arena *arena = NULL;
+    munit_assert(sail_alloc_arena(&arena) == SAIL_OK);
+    munit_assert_not_null(arena);
+    munit_assert_null(sail_set_current_arena(arena));
+
+    /* Small allocations share a chunk. */
+    void *ptrs[64];
+
+    for (unsigned i = 0; i < 64; i++) {
+        munit_assert(sail_malloc(32 + i, &ptrs[i]) == SAIL_OK);
+        munit_assert_size((size_t)ptrs[i] % 16, ==, 0);
+        memset(ptrs[i], (int)i, 32 + i);
+    }
+
+    void *zeroed = NULL;
+    munit_assert(sail_calloc(16, 4, &zeroed) == SAIL_OK);
+
+    for (unsigned i = 0; i < 64; i++) {
+        munit_assert_uint8(((unsigned char *)zeroed)[i], ==, 0);
+    }
+
+    /* Arena plus one chunk. */
+    munit_assert_uint(allocations, ==, 2);
+
+    /* Big allocations bypass the arena. */
+    void *big = NULL;
+    munit_assert(sail_malloc(SAIL_ARENA_MAX_ALLOCATION_SIZE + 1, &big) == SAIL_OK);
+    munit_assert_uint(allocations, ==, 3);
+    sail_free(big);
+    munit_assert_uint(deallocations, ==, 1);
+
+    for (unsigned i = 0; i < 64; i++) {
+        munit_assert_uint8(((unsigned char *)ptrs[i])[31 + i], ==, i);
+        sail_free(ptrs[i]);
+    }
+
+    sail_free(zeroed);
+
+    /* Freed chunks are reused. */
+    for (unsigned i = 0; i < 1000; i++) {
+        void *ptr = NULL;
+        munit_assert(sail_malloc(SAIL_ARENA_MAX_ALLOCATION_SIZE, &ptr) == SAIL_OK);
+        sail_free(ptr);
+    }
+
+    munit_assert_uint(allocations, ==, 3);
+    munit_assert_uint(deallocations, ==, 1);
+
+    munit_assert_ptr_equal(sail_set_current_arena(NULL), arena);
+    sail_destroy_arena(arena);
+
+    munit_assert_uint(deallocations, ==, 3);
+
+    munit_assert(sail_set_memory_allocator(NULL) == SAIL_OK);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_arena_realloc(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_arena *arena = NULL;
+    munit_assert(sail_alloc_arena(&arena) == SAIL_OK);
+    sail_set_current_arena(arena);
+
+    void *ptr = NULL;
+    munit_assert(sail_realloc(16, &ptr) == SAIL_OK);
+    memset(ptr, 0xAB, 16);
+
+    /* Shrinking keeps the allocation. */
+    void *shrunk = ptr;
+    munit_assert(sail_realloc(8, &shrunk) == SAIL_OK);
+    munit_assert_ptr_equal(shrunk, ptr);
+
+    /* Growing moves the data out of the arena. */
+    munit_assert(sail_realloc(64 * 1024, &ptr) == SAIL_OK);
+    munit_assert_ptr_not_equal(ptr, shrunk);
+
+    for (unsigned i = 0; i < 16; i++) {
+        munit_assert_uint8(((unsigned char *)ptr)[i], ==, 0xAB);
+    }
+
+    memset(ptr, 0, 64 * 1024);
+    sail_free(ptr);
+
+    sail_set_current_arena(NULL);
+    sail_destroy_arena(arena);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_arena_outlived(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    const struct sail_memory_allocator allocator = {
+        .malloc_func  = counting_malloc,
+        .realloc_func = counting_realloc,
+        .calloc_func  = counting_calloc,
+        .free_func    = counting_free,
+    };
+
+    allocations   = 0;
+    deallocations = 0;
+
+    munit_assert(sail_set_memory_allocator(&allocator) == SAIL_OK);
+
+    struct sail_arena *arena = NULL;
+    munit_assert(sail_alloc_arena(&arena) == SAIL_OK);
+    sail_set_current_arena(arena);
+
+    void *ptr = NULL;
+    munit_assert(sail_malloc(100, &ptr) == SAIL_OK);
+
+    sail_set_current_arena(NULL);
+    sail_destroy_arena(arena);
+
+    /* The chunk is alive while the allocation is. */
+    munit_assert_uint(allocations, ==, 2);
+    munit_assert_uint(deallocations, ==, 1);
+    memset(ptr, 0, 100);
+
+    sail_free(ptr);
+    munit_assert_uint(deallocations, ==, 2);
+
+    munit_assert(sail_set_memory_allocator(NULL) == SAIL_OK);
+
+    return MUNIT_OK;
+}
+
 static MunitTest test_suite_tests[] = {
-    { (char *)"/malloc",  test_malloc,  NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
-    { (char *)"/calloc",  test_calloc,  NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
-    { (char *)"/realloc", test_realloc, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/malloc",           test_malloc,           NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/calloc",           test_calloc,           NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/realloc",          test_realloc,          NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/memory-allocator", test_memory_allocator, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/arena",            test_arena,            NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/arena-realloc",    test_arena_realloc,    NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/arena-outlived",   test_arena_outlived,   NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
 
     { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
 };
@@ -173,6 +173,42 @@ static MunitResult test_copy_unknown_string_meta_data(const MunitParameter param
     return MUNIT_OK;
 }
 
+static MunitResult test_exif_orientation(const MunitParameter params[], void *user_data) {
+
+    (void)params;
+    (void)user_data;
+
+    /* Big-endian TIFF header with a single Orientation entry in IFD0. */
+    uint8_t exif_be[] = { 'E', 'x', 'i', 'f', 0, 0,
+                            'M', 'M', 0, 42, 0, 0, 0, 8,
+                            0, 1,
+                            0x01, 0x12, 0, 3, 0, 0, 0, 1, 0, 6, 0, 0,
+                            0, 0, 0, 0 };
+    /* Little-endian without the Exif header. */
+    uint8_t exif_le[] = { 'I', 'I', 42, 0, 8, 0, 0, 0,
+                            1, 0,
+                            0x12, 0x01, 3, 0, 1, 0, 0, 0, 5, 0, 0, 0,
+                            0, 0, 0, 0 };
+
+    enum SailOrientation orientation;
+
+    munit_assert(sail_exif_orientation(exif_be, sizeof(exif_be), &orientation) == SAIL_OK);
+    munit_assert(orientation == SAIL_ORIENTATION_ROTATED_90);
+
+    munit_assert(sail_exif_orientation(exif_le, sizeof(exif_le), &orientation) == SAIL_OK);
+    munit_assert(orientation == SAIL_ORIENTATION_MIRRORED_HORIZONTALLY_ROTATED_270);
+
+    munit_assert(sail_reset_exif_orientation(exif_be, sizeof(exif_be)) == SAIL_OK);
+    munit_assert(sail_exif_orientation(exif_be, sizeof(exif_be), &orientation) == SAIL_OK);
+    munit_assert(orientation == SAIL_ORIENTATION_NORMAL);
+
+    /* Truncated data. */
+    munit_assert(sail_exif_orientation(exif_le, 12, &orientation) == SAIL_OK);
+    munit_assert(orientation == SAIL_ORIENTATION_NORMAL);
+
+    return MUNIT_OK;
+}
+
 static MunitTest test_suite_tests[] = {
     { (char *)"/alloc",                             test_alloc_meta_data,                  NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
     { (char *)"/alloc-from-known-key",              test_alloc_meta_data_from_known_key,   NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
@@ -181,6 +217,7 @@ static MunitTest test_suite_tests[] = {
     { (char *)"/alloc-with-value-from-unknown-key", test_alloc_meta_data_and_value_from_unknown_key, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
     { (char *)"/copy-known-string",                 test_copy_known_string_meta_data,      NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
     { (char *)"/copy-unknown-string",               test_copy_unknown_string_meta_data,    NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/exif-orientation",                  test_exif_orientation,                 NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
 
     { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
 };
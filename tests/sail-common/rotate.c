@@ -0,0 +1,157 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <string.h>
+
+#include <sail-common/sail-common.h>
+
+#include "munit.h"
+
+/*
+ * 3x2 image, every pixel is its index:
+ *
+ *   0 1 2
+ *   3 4 5
+ */
+static struct sail_image* alloc_test_image(enum SailPixelFormat pixel_format) {
+
+    struct sail_image *image;
+    munit_assert(sail_alloc_image(&image) == SAIL_OK);
+
+    image->width          = 3;
+    image->height         = 2;
+    image->pixel_format   = pixel_format;
+    image->bytes_per_line = sail_bytes_per_line(image->width, image->pixel_format);
+
+    munit_assert(sail_malloc((size_t)image->height * image->bytes_per_line, &image->pixels) == SAIL_OK);
+
+    const unsigned bytes_per_pixel = sail_bits_per_pixel(pixel_format) / 8;
+
+    for (unsigned row = 0; row < image->height; row++) {
+        uint8_t *scan = sail_scan_line(image, row);
+
+        for (unsigned column = 0; column < image->width; column++) {
+            memset(scan + column * bytes_per_pixel, (int)(row * image->width + column), bytes_per_pixel);
+        }
+    }
+
+    return image;
+}
+
+static void assert_pixels(const struct sail_image *image, unsigned width, unsigned height, const uint8_t *expected) {
+
+    munit_assert_uint(image->width, ==, width);
+    munit_assert_uint(image->height, ==, height);
+    munit_assert_uint(image->bytes_per_line, ==, sail_bytes_per_line(width, image->pixel_format));
+
+    const unsigned bytes_per_pixel = sail_bits_per_pixel(image->pixel_format) / 8;
+
+    for (unsigned row = 0; row < height; row++) {
+        const uint8_t *scan = sail_scan_line(image, row);
+
+        for (unsigned column = 0; column < width; column++) {
+            for (unsigned i = 0; i < bytes_per_pixel; i++) {
+                munit_assert_uint8(scan[column * bytes_per_pixel + i], ==, expected[row * width + column]);
+            }
+        }
+    }
+}
+
+static MunitResult test_rotate(const MunitParameter params[], void *user_data) {
+
+    (void)params;
+    (void)user_data;
+
+    static const struct {
+        enum SailOrientation orientation;
+        unsigned width;
+        unsigned height;
+        uint8_t expected[6];
+    } CASES[] = {
+        { SAIL_ORIENTATION_NORMAL,                            3, 2, { 0, 1, 2, 3, 4, 5 } },
+        { SAIL_ORIENTATION_MIRRORED_HORIZONTALLY,             3, 2, { 2, 1, 0, 5, 4, 3 } },
+        { SAIL_ORIENTATION_MIRRORED_VERTICALLY,               3, 2, { 3, 4, 5, 0, 1, 2 } },
+        { SAIL_ORIENTATION_ROTATED_180,                       3, 2, { 5, 4, 3, 2, 1, 0 } },
+        { SAIL_ORIENTATION_ROTATED_90,                        2, 3, { 3, 0, 4, 1, 5, 2 } },
+        { SAIL_ORIENTATION_ROTATED_270,                       2, 3, { 2, 5, 1, 4, 0, 3 } },
+        { SAIL_ORIENTATION_MIRRORED_HORIZONTALLY_ROTATED_90,  2, 3, { 5, 2, 4, 1, 3, 0 } },
+        { SAIL_ORIENTATION_MIRRORED_HORIZONTALLY_ROTATED_270, 2, 3, { 0, 3, 1, 4, 2, 5 } },
+    };
+
+    static const enum SailPixelFormat PIXEL_FORMATS[] = {
+        SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE,
+        SAIL_PIXEL_FORMAT_BPP24_RGB,
+        SAIL_PIXEL_FORMAT_BPP32_RGBA,
+        SAIL_PIXEL_FORMAT_BPP48_RGB,
+    };
+
+    for (size_t i = 0; i < sizeof(PIXEL_FORMATS) / sizeof(PIXEL_FORMATS[0]); i++) {
+        for (size_t j = 0; j < sizeof(CASES) / sizeof(CASES[0]); j++) {
+            struct sail_image *image = alloc_test_image(PIXEL_FORMATS[i]);
+
+            munit_assert(sail_rotate_image(image, CASES[j].orientation) == SAIL_OK);
+            assert_pixels(image, CASES[j].width, CASES[j].height, CASES[j].expected);
+
+            sail_destroy_image(image);
+        }
+    }
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_rotate_unsupported(const MunitParameter params[], void *user_data) {
+
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image = alloc_test_image(SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE);
+    image->pixel_format = SAIL_PIXEL_FORMAT_BPP4_GRAYSCALE;
+
+    munit_assert(sail_rotate_image(image, SAIL_ORIENTATION_ROTATED_90) == SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    munit_assert(sail_rotate_image(image, SAIL_ORIENTATION_ROTATED_180) == SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/rotate",             test_rotate,             NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/rotate-unsupported", test_rotate_unsupported, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/rotate",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
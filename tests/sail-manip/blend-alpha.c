@@ -0,0 +1,163 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <string.h>
+
+#include <sail/sail.h>
+#include <sail-manip/sail-manip.h>
+
+#include "munit.h"
+
+static struct sail_image* alloc_rgba32_image(const uint8_t *pixels, unsigned width) {
+
+    struct sail_image *image;
+    munit_assert(sail_alloc_image(&image) == SAIL_OK);
+
+    image->width          = width;
+    image->height         = 1;
+    image->pixel_format   = SAIL_PIXEL_FORMAT_BPP32_RGBA;
+    image->bytes_per_line = sail_bytes_per_line(image->width, image->pixel_format);
+
+    munit_assert(sail_malloc(image->bytes_per_line, &image->pixels) == SAIL_OK);
+    memcpy(image->pixels, pixels, image->bytes_per_line);
+
+    return image;
+}
+
+static struct sail_conversion_options* alloc_blend_options(void) {
+
+    struct sail_conversion_options *options;
+    munit_assert(sail_alloc_conversion_options(&options) == SAIL_OK);
+
+    options->options      = SAIL_CONVERSION_OPTION_BLEND_ALPHA;
+    options->background24 = (sail_rgb24_t) { 255, 255, 255 };
+    options->background48 = (sail_rgb48_t) { 65535, 65535, 65535 };
+
+    return options;
+}
+
+static MunitResult test_blend_rgb24(const MunitParameter params[], void *user_data) {
+
+    (void)params;
+    (void)user_data;
+
+    /* Translucent, opaque, fully transparent. */
+    const uint8_t pixels[] = { 200, 100, 0, 128,   10, 20, 30, 255,   1, 2, 3, 0 };
+    const uint8_t expected_rgb[] = { 227, 177, 127,   10, 20, 30,   255, 255, 255 };
+    const uint8_t expected_bgr[] = { 127, 177, 227,   30, 20, 10,   255, 255, 255 };
+
+    struct sail_image *image = alloc_rgba32_image(pixels, 3);
+    struct sail_conversion_options *options = alloc_blend_options();
+
+    struct sail_image *image_output;
+    munit_assert(sail_convert_image_with_options(image, SAIL_PIXEL_FORMAT_BPP24_RGB, options, &image_output) == SAIL_OK);
+    munit_assert_memory_equal(sizeof(expected_rgb), image_output->pixels, expected_rgb);
+    sail_destroy_image(image_output);
+
+    munit_assert(sail_convert_image_with_options(image, SAIL_PIXEL_FORMAT_BPP24_BGR, options, &image_output) == SAIL_OK);
+    munit_assert_memory_equal(sizeof(expected_bgr), image_output->pixels, expected_bgr);
+    sail_destroy_image(image_output);
+
+    sail_destroy_conversion_options(options);
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_blend_other(const MunitParameter params[], void *user_data) {
+
+    (void)params;
+    (void)user_data;
+
+    const uint8_t pixels[] = { 200, 100, 0, 128,   255, 255, 255, 255 };
+
+    struct sail_image *image = alloc_rgba32_image(pixels, 2);
+    struct sail_conversion_options *options = alloc_blend_options();
+
+    struct sail_image *image_output;
+
+    {
+        const uint8_t expected[] = { 186, 255 };
+
+        munit_assert(sail_convert_image_with_options(image, SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE, options, &image_output) == SAIL_OK);
+        munit_assert_memory_equal(sizeof(expected), image_output->pixels, expected);
+        sail_destroy_image(image_output);
+    }
+
+    {
+        const uint16_t expected[] = { 58440, 45539, 32639,   65535, 65535, 65535 };
+
+        munit_assert(sail_convert_image_with_options(image, SAIL_PIXEL_FORMAT_BPP48_RGB, options, &image_output) == SAIL_OK);
+        munit_assert_memory_equal(sizeof(expected), image_output->pixels, expected);
+        sail_destroy_image(image_output);
+    }
+
+    sail_destroy_conversion_options(options);
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_blend_opaque(const MunitParameter params[], void *user_data) {
+
+    (void)params;
+    (void)user_data;
+
+    const uint8_t pixels[] = { 200, 100, 0, 255,   10, 20, 30, 255 };
+    const uint8_t expected[] = { 200, 100, 0,   10, 20, 30 };
+
+    struct sail_image *image = alloc_rgba32_image(pixels, 2);
+    struct sail_conversion_options *options = alloc_blend_options();
+
+    struct sail_image *image_output;
+    munit_assert(sail_convert_image_with_options(image, SAIL_PIXEL_FORMAT_BPP24_RGB, options, &image_output) == SAIL_OK);
+    munit_assert_memory_equal(sizeof(expected), image_output->pixels, expected);
+    sail_destroy_image(image_output);
+
+    sail_destroy_conversion_options(options);
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/rgb24", test_blend_rgb24, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/other", test_blend_other, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/opaque", test_blend_opaque, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/blend-alpha",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
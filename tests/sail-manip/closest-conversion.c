@@ -53,7 +53,7 @@ static MunitResult test_best_conversion_grayscale(const MunitParameter params[],
         const enum SailPixelFormat pixel_formats[] = { SAIL_PIXEL_FORMAT_BPP1_INDEXED, SAIL_PIXEL_FORMAT_BPP2_INDEXED };
         const size_t pixel_formats_length = sizeof(pixel_formats) / sizeof(pixel_formats[0]);
 
-        munit_assert_int(sail_closest_pixel_format(SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE, pixel_formats, pixel_formats_length), ==, SAIL_PIXEL_FORMAT_UNKNOWN);
+        munit_assert_int(sail_closest_pixel_format(SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE, pixel_formats, pixel_formats_length), ==, SAIL_PIXEL_FORMAT_BPP2_INDEXED);
     }
 
     return MUNIT_OK;
@@ -85,6 +85,27 @@ static MunitResult test_best_conversion_indexed(const MunitParameter params[], v
         munit_assert_int(sail_closest_pixel_format(SAIL_PIXEL_FORMAT_BPP1_INDEXED, pixel_formats, pixel_formats_length), ==, SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE);
     }
 
+    {
+        const enum SailPixelFormat pixel_formats[] = { SAIL_PIXEL_FORMAT_BPP24_RGB, SAIL_PIXEL_FORMAT_BPP1_INDEXED, SAIL_PIXEL_FORMAT_BPP8_INDEXED };
+        const size_t pixel_formats_length = sizeof(pixel_formats) / sizeof(pixel_formats[0]);
+
+        munit_assert_int(sail_closest_pixel_format(SAIL_PIXEL_FORMAT_BPP4_INDEXED, pixel_formats, pixel_formats_length), ==, SAIL_PIXEL_FORMAT_BPP8_INDEXED);
+    }
+
+    {
+        const enum SailPixelFormat pixel_formats[] = { SAIL_PIXEL_FORMAT_BPP4_INDEXED, SAIL_PIXEL_FORMAT_BPP24_RGB };
+        const size_t pixel_formats_length = sizeof(pixel_formats) / sizeof(pixel_formats[0]);
+
+        munit_assert_int(sail_closest_pixel_format(SAIL_PIXEL_FORMAT_BPP8_INDEXED, pixel_formats, pixel_formats_length), ==, SAIL_PIXEL_FORMAT_BPP24_RGB);
+    }
+
+    {
+        const enum SailPixelFormat pixel_formats[] = { SAIL_PIXEL_FORMAT_BPP1_INDEXED, SAIL_PIXEL_FORMAT_BPP4_INDEXED };
+        const size_t pixel_formats_length = sizeof(pixel_formats) / sizeof(pixel_formats[0]);
+
+        munit_assert_int(sail_closest_pixel_format(SAIL_PIXEL_FORMAT_BPP8_INDEXED, pixel_formats, pixel_formats_length), ==, SAIL_PIXEL_FORMAT_BPP4_INDEXED);
+    }
+
     return MUNIT_OK;
 }
 
@@ -114,6 +135,13 @@ static MunitResult test_best_conversion_rgb(const MunitParameter params[], void
         munit_assert_int(sail_closest_pixel_format(SAIL_PIXEL_FORMAT_BPP24_RGB, pixel_formats, pixel_formats_length), ==, SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE);
     }
 
+    {
+        const enum SailPixelFormat pixel_formats[] = { SAIL_PIXEL_FORMAT_BPP4_INDEXED, SAIL_PIXEL_FORMAT_BPP8_INDEXED };
+        const size_t pixel_formats_length = sizeof(pixel_formats) / sizeof(pixel_formats[0]);
+
+        munit_assert_int(sail_closest_pixel_format(SAIL_PIXEL_FORMAT_BPP24_RGB, pixel_formats, pixel_formats_length), ==, SAIL_PIXEL_FORMAT_BPP8_INDEXED);
+    }
+
     return MUNIT_OK;
 }
 
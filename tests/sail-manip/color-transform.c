@@ -0,0 +1,326 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <sail/sail.h>
+#include <sail-manip/sail-manip.h>
+
+#include "munit.h"
+
+/* sRGB colorants in the D50 PCS. */
+static const double SRGB_COLORANTS[3][3] = {
+    { 0.436065674, 0.222488403, 0.013916016 },
+    { 0.385147095, 0.716873169, 0.097076416 },
+    { 0.143066406, 0.060607910, 0.714096069 },
+};
+
+static void write_u16(uint8_t *data, unsigned value) {
+
+    data[0] = (uint8_t)(value >> 8);
+    data[1] = (uint8_t)value;
+}
+
+static void write_u32(uint8_t *data, uint32_t value) {
+
+    data[0] = (uint8_t)(value >> 24);
+    data[1] = (uint8_t)(value >> 16);
+    data[2] = (uint8_t)(value >> 8);
+    data[3] = (uint8_t)value;
+}
+
+static void write_s15fixed16(uint8_t *data, double value) {
+
+    write_u32(data, (uint32_t)(int32_t)(value * 65536 + 0.5));
+}
+
+static void write_signature(uint8_t *data, const char signature[4]) {
+
+    memcpy(data, signature, 4);
+}
+
+/* Builds an ICC header and a tag table. Returns the offset of the first tag data. */
+static size_t write_header(uint8_t *data, size_t size, const char pcs[4], unsigned tag_count) {
+
+    memset(data, 0, size);
+
+    write_u32(data, (uint32_t)size);
+    write_signature(data + 12, "mntr");
+    write_signature(data + 16, "RGB ");
+    write_signature(data + 20, pcs);
+    write_signature(data + 36, "acsp");
+    write_u32(data + 128, tag_count);
+
+    return 132 + tag_count * 12;
+}
+
+static void write_tag_entry(uint8_t *data, unsigned index, const char signature[4], size_t offset, size_t length) {
+
+    write_signature(data + 132 + index * 12, signature);
+    write_u32(data + 132 + index * 12 + 4, (uint32_t)offset);
+    write_u32(data + 132 + index * 12 + 8, (uint32_t)length);
+}
+
+/* sRGB matrix/TRC profile. */
+static struct sail_iccp* alloc_srgb_matrix_iccp(void) {
+
+    static const char * const XYZ_TAGS[3] = { "rXYZ", "gXYZ", "bXYZ" };
+    static const char * const TRC_TAGS[3] = { "rTRC", "gTRC", "bTRC" };
+
+    uint8_t data[132 + 6 * 12 + 3 * 20 + 32];
+    size_t offset = write_header(data, sizeof(data), "XYZ ", 6);
+
+    for (unsigned i = 0; i < 3; i++) {
+        write_tag_entry(data, i, XYZ_TAGS[i], offset, 20);
+        write_signature(data + offset, "XYZ ");
+
+        for (unsigned j = 0; j < 3; j++) {
+            write_s15fixed16(data + offset + 8 + j * 4, SRGB_COLORANTS[i][j]);
+        }
+
+        offset += 20;
+    }
+
+    /* All the channels share the same parametric sRGB curve. */
+    for (unsigned i = 0; i < 3; i++) {
+        write_tag_entry(data, 3 + i, TRC_TAGS[i], offset, 32);
+    }
+
+    write_signature(data + offset, "para");
+    write_u16(data + offset + 8, 3);
+    write_s15fixed16(data + offset + 12, 2.4);
+    write_s15fixed16(data + offset + 16, 1 / 1.055);
+    write_s15fixed16(data + offset + 20, 0.055 / 1.055);
+    write_s15fixed16(data + offset + 24, 1 / 12.92);
+    write_s15fixed16(data + offset + 28, 0.04045);
+
+    struct sail_iccp *iccp;
+    munit_assert(sail_alloc_iccp_from_data(data, sizeof(data), &iccp) == SAIL_OK);
+
+    return iccp;
+}
+
+/* Linear RGB lut16 profile with sRGB primaries and a 2x2x2 CLUT in the XYZ PCS. */
+static struct sail_iccp* alloc_linear_lut16_iccp(void) {
+
+    uint8_t data[132 + 12 + 52 + (3 * 2 + 2 * 2 * 2 * 3 + 3 * 2) * 2];
+    size_t offset = write_header(data, sizeof(data), "XYZ ", 1);
+
+    write_tag_entry(data, 0, "A2B0", offset, sizeof(data) - offset);
+
+    uint8_t *tag = data + offset;
+    write_signature(tag, "mft2");
+    tag[8] = 3;
+    tag[9] = 3;
+    tag[10] = 2;
+
+    /* Identity matrix. */
+    for (unsigned i = 0; i < 3; i++) {
+        write_s15fixed16(tag + 12 + (i * 3 + i) * 4, 1);
+    }
+
+    write_u16(tag + 48, 2);
+    write_u16(tag + 50, 2);
+
+    uint8_t *ptr = tag + 52;
+
+    /* Identity input curves. */
+    for (unsigned channel = 0; channel < 3; channel++) {
+        write_u16(ptr, 0);
+        write_u16(ptr + 2, 65535);
+        ptr += 4;
+    }
+
+    /* The CLUT is the RGB to XYZ matrix, u1Fixed15 encoded. */
+    for (unsigned r = 0; r < 2; r++) {
+        for (unsigned g = 0; g < 2; g++) {
+            for (unsigned b = 0; b < 2; b++) {
+                for (unsigned i = 0; i < 3; i++) {
+                    const double value = r * SRGB_COLORANTS[0][i] + g * SRGB_COLORANTS[1][i] + b * SRGB_COLORANTS[2][i];
+                    write_u16(ptr, (unsigned)(value * 32768 + 0.5));
+                    ptr += 2;
+                }
+            }
+        }
+    }
+
+    /* Identity output curves. */
+    for (unsigned channel = 0; channel < 3; channel++) {
+        write_u16(ptr, 0);
+        write_u16(ptr + 2, 65535);
+        ptr += 4;
+    }
+
+    struct sail_iccp *iccp;
+    munit_assert(sail_alloc_iccp_from_data(data, sizeof(data), &iccp) == SAIL_OK);
+
+    return iccp;
+}
+
+static struct sail_image* alloc_rgb24_image(const uint8_t *pixels, unsigned width, struct sail_iccp *iccp) {
+
+    struct sail_image *image;
+    munit_assert(sail_alloc_image(&image) == SAIL_OK);
+
+    image->width          = width;
+    image->height         = 1;
+    image->pixel_format   = SAIL_PIXEL_FORMAT_BPP24_RGB;
+    image->bytes_per_line = sail_bytes_per_line(image->width, image->pixel_format);
+    image->iccp           = iccp;
+
+    munit_assert(sail_malloc(image->bytes_per_line, &image->pixels) == SAIL_OK);
+    memcpy(image->pixels, pixels, image->bytes_per_line);
+
+    return image;
+}
+
+static void assert_pixels_close(const uint8_t *actual, const uint8_t *expected, size_t size) {
+
+    for (size_t i = 0; i < size; i++) {
+        munit_assert_int(abs(actual[i] - expected[i]), <=, 1);
+    }
+}
+
+static const uint8_t PIXELS[] = { 0, 0, 0,   255, 255, 255,   200, 100, 0,   10, 128, 240,   1, 2, 3 };
+
+static MunitResult test_srgb_identity(const MunitParameter params[], void *user_data) {
+
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image = alloc_rgb24_image(PIXELS, 5, alloc_srgb_matrix_iccp());
+
+    struct sail_image *image_output;
+    munit_assert(sail_convert_image_to_profile(image, SAIL_PIXEL_FORMAT_BPP24_RGB, SAIL_COLOR_PROFILE_SRGB, &image_output) == SAIL_OK);
+    munit_assert_null(image_output->iccp);
+    assert_pixels_close(image_output->pixels, PIXELS, sizeof(PIXELS));
+    sail_destroy_image(image_output);
+
+    /* 16-bit output. */
+    munit_assert(sail_convert_image_to_profile(image, SAIL_PIXEL_FORMAT_BPP48_RGB, SAIL_COLOR_PROFILE_SRGB, &image_output) == SAIL_OK);
+    const uint16_t *pixels16 = image_output->pixels;
+    for (size_t i = 0; i < sizeof(PIXELS); i++) {
+        munit_assert_int(abs(pixels16[i] - PIXELS[i] * 257), <=, 257);
+    }
+    sail_destroy_image(image_output);
+
+    sail_destroy_image(image);
+
+    sail_clear_color_transform_cache();
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_lut16(const MunitParameter params[], void *user_data) {
+
+    (void)params;
+    (void)user_data;
+
+    const uint8_t pixels[] = { 0, 0, 0,   255, 255, 255,   128, 128, 128,   255, 128, 0 };
+    const uint8_t expected[] = { 0, 0, 0,   255, 255, 255,   188, 188, 188,   255, 188, 0 };
+
+    struct sail_image *image = alloc_rgb24_image(pixels, 4, alloc_linear_lut16_iccp());
+
+    struct sail_image *image_output;
+    munit_assert(sail_convert_image_to_profile(image, SAIL_PIXEL_FORMAT_BPP24_RGB, SAIL_COLOR_PROFILE_SRGB, &image_output) == SAIL_OK);
+    assert_pixels_close(image_output->pixels, expected, sizeof(expected));
+    sail_destroy_image(image_output);
+
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_display_p3(const MunitParameter params[], void *user_data) {
+
+    (void)params;
+    (void)user_data;
+
+    const uint8_t pixels[] = { 255, 0, 0,   255, 255, 255 };
+    const uint8_t expected[] = { 234, 51, 35,   255, 255, 255 };
+
+    struct sail_image *image = alloc_rgb24_image(pixels, 2, alloc_srgb_matrix_iccp());
+
+    struct sail_image *image_output;
+    munit_assert(sail_convert_image_to_profile(image, SAIL_PIXEL_FORMAT_BPP24_RGB, SAIL_COLOR_PROFILE_DISPLAY_P3, &image_output) == SAIL_OK);
+    assert_pixels_close(image_output->pixels, expected, sizeof(expected));
+    sail_destroy_image(image_output);
+
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_option(const MunitParameter params[], void *user_data) {
+
+    (void)params;
+    (void)user_data;
+
+    struct sail_conversion_options *options;
+    munit_assert(sail_alloc_conversion_options(&options) == SAIL_OK);
+    options->options = SAIL_CONVERSION_OPTION_APPLY_ICCP;
+
+    struct sail_image *image = alloc_rgb24_image(PIXELS, 5, alloc_srgb_matrix_iccp());
+
+    struct sail_image *image_output;
+    munit_assert(sail_convert_image_with_options(image, SAIL_PIXEL_FORMAT_BPP32_RGBA, options, &image_output) == SAIL_OK);
+    munit_assert_null(image_output->iccp);
+    sail_destroy_image(image_output);
+
+    /* Updating in place to the same pixel format still applies the profile. */
+    munit_assert(sail_update_image_with_options(image, SAIL_PIXEL_FORMAT_BPP24_RGB, options) == SAIL_OK);
+    munit_assert_null(image->iccp);
+    assert_pixels_close(image->pixels, PIXELS, sizeof(PIXELS));
+
+    /* No ICC profile. */
+    munit_assert(sail_convert_image_to_profile(image, SAIL_PIXEL_FORMAT_BPP24_RGB, SAIL_COLOR_PROFILE_SRGB, &image_output) == SAIL_ERROR_MISSING_ICCP);
+
+    sail_destroy_image(image);
+    sail_destroy_conversion_options(options);
+
+    return MUNIT_OK;
+}
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/srgb-identity", test_srgb_identity, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/lut16", test_lut16, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/display-p3", test_display_p3, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/option", test_option, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/color-transform",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
@@ -0,0 +1,208 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdlib.h>
+
+#include <sail/sail.h>
+#include <sail-manip/sail-manip.h>
+
+#include "munit.h"
+
+/* Every 8-bit color value against every alpha value. */
+static struct sail_image* alloc_rgba32_image(enum SailPixelFormat pixel_format, bool premultiplied_values) {
+
+    struct sail_image *image;
+    munit_assert(sail_alloc_image(&image) == SAIL_OK);
+
+    image->width          = 256;
+    image->height         = 256;
+    image->pixel_format   = pixel_format;
+    image->bytes_per_line = sail_bytes_per_line(image->width, image->pixel_format);
+
+    munit_assert(sail_malloc((size_t)image->height * image->bytes_per_line, &image->pixels) == SAIL_OK);
+
+    for (unsigned row = 0; row < image->height; row++) {
+        uint8_t *scan = sail_scan_line(image, row);
+
+        for (unsigned column = 0; column < image->width; column++) {
+            /* Premultiplied colors never exceed alpha. */
+            const uint8_t color = (uint8_t)(premultiplied_values ? column * row / 255 : column);
+
+            *scan++ = color;
+            *scan++ = (uint8_t)((premultiplied_values ? row : 255) - color);
+            *scan++ = (uint8_t)(color / 2);
+            *scan++ = (uint8_t)row;
+        }
+    }
+
+    return image;
+}
+
+static MunitResult test_premultiply(const MunitParameter params[], void *user_data) {
+
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image = alloc_rgba32_image(SAIL_PIXEL_FORMAT_BPP32_RGBA, false);
+    struct sail_image *image_output;
+
+    munit_assert(sail_convert_image(image, SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED, &image_output) == SAIL_OK);
+    munit_assert(image_output->pixel_format == SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED);
+
+    for (unsigned row = 0; row < image->height; row++) {
+        const uint8_t *scan        = sail_scan_line(image, row);
+        const uint8_t *scan_output = sail_scan_line(image_output, row);
+
+        for (unsigned i = 0; i < image->width * 4; i += 4) {
+            const unsigned a = scan[i + 3];
+
+            munit_assert_uint8(scan_output[i + 0], ==, (scan[i + 0] * a + 127) / 255);
+            munit_assert_uint8(scan_output[i + 1], ==, (scan[i + 1] * a + 127) / 255);
+            munit_assert_uint8(scan_output[i + 2], ==, (scan[i + 2] * a + 127) / 255);
+            munit_assert_uint8(scan_output[i + 3], ==, a);
+        }
+    }
+
+    sail_destroy_image(image_output);
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_round_trip(const MunitParameter params[], void *user_data) {
+
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image = alloc_rgba32_image(SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED, true);
+    struct sail_image *image_straight;
+    struct sail_image *image_output;
+
+    /* Premultiplied -> straight -> premultiplied is lossless. */
+    munit_assert(sail_convert_image(image, SAIL_PIXEL_FORMAT_BPP32_RGBA, &image_straight) == SAIL_OK);
+    munit_assert(sail_convert_image(image_straight, SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED, &image_output) == SAIL_OK);
+    munit_assert_memory_equal((size_t)image->height * image->bytes_per_line, image_output->pixels, image->pixels);
+    sail_destroy_image(image_output);
+
+    /* Fully transparent pixels become black. */
+    const uint8_t *scan = sail_scan_line(image_straight, 0);
+    for (unsigned i = 0; i < image_straight->width * 4; i++) {
+        munit_assert_uint8(scan[i], ==, 0);
+    }
+
+    /* The generic path with a different component order agrees with the fast path. */
+    struct sail_image *image_argb;
+    munit_assert(sail_convert_image(image, SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED, &image_argb) == SAIL_OK);
+    munit_assert(sail_convert_image(image_argb, SAIL_PIXEL_FORMAT_BPP32_RGBA, &image_output) == SAIL_OK);
+    munit_assert_memory_equal((size_t)image->height * image->bytes_per_line, image_output->pixels, image_straight->pixels);
+    sail_destroy_image(image_output);
+    sail_destroy_image(image_argb);
+
+    /* In-place updates. */
+    munit_assert(sail_update_image(image, SAIL_PIXEL_FORMAT_BPP32_RGBA) == SAIL_OK);
+    munit_assert_memory_equal((size_t)image->height * image->bytes_per_line, image->pixels, image_straight->pixels);
+
+    sail_destroy_image(image_straight);
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_rgba64(const MunitParameter params[], void *user_data) {
+
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image = alloc_rgba32_image(SAIL_PIXEL_FORMAT_BPP32_RGBA, false);
+    struct sail_image *image64;
+    struct sail_image *image64_premultiplied;
+    struct sail_image *image_output;
+
+    munit_assert(sail_convert_image(image, SAIL_PIXEL_FORMAT_BPP64_RGBA, &image64) == SAIL_OK);
+    munit_assert(sail_convert_image(image64, SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED, &image64_premultiplied) == SAIL_OK);
+
+    /* 16-bit premultiplied pixels keep enough precision to restore 8-bit straight ones. */
+    for (unsigned row = 1; row < image->height; row++) {
+        const uint16_t *scan = sail_scan_line(image64_premultiplied, row);
+
+        for (unsigned column = 0; column < image->width; column++, scan += 4) {
+            munit_assert_uint16(scan[2], <=, scan[3]);
+        }
+    }
+
+    munit_assert(sail_convert_image(image64_premultiplied, SAIL_PIXEL_FORMAT_BPP32_RGBA, &image_output) == SAIL_OK);
+
+    for (unsigned row = 1; row < image->height; row++) {
+        const uint8_t *scan        = sail_scan_line(image, row);
+        const uint8_t *scan_output = sail_scan_line(image_output, row);
+
+        for (unsigned i = 0; i < image->width * 4; i++) {
+            munit_assert_int(abs(scan[i] - scan_output[i]), <=, 1);
+        }
+    }
+
+    sail_destroy_image(image_output);
+    sail_destroy_image(image64_premultiplied);
+    sail_destroy_image(image64);
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_can_convert(const MunitParameter params[], void *user_data) {
+
+    (void)params;
+    (void)user_data;
+
+    munit_assert(sail_is_premultiplied(SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED));
+    munit_assert(!sail_is_premultiplied(SAIL_PIXEL_FORMAT_BPP32_ABGR));
+
+    munit_assert(sail_can_convert(SAIL_PIXEL_FORMAT_BPP24_RGB, SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED));
+    munit_assert(sail_can_convert(SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED, SAIL_PIXEL_FORMAT_BPP24_YCBCR));
+    munit_assert(sail_can_convert(SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED, SAIL_PIXEL_FORMAT_BPP12_YUV420P));
+
+    return MUNIT_OK;
+}
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/premultiply", test_premultiply, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/round-trip", test_round_trip, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/rgba64", test_rgba64, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/can-convert", test_can_convert, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/premultiply",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
@@ -0,0 +1,338 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <sail/sail.h>
+#include <sail-manip/sail-manip.h>
+
+#include "munit.h"
+
+/* Smooth gradients with many more colors than any palette holds. */
+static struct sail_image* alloc_gradient_image(enum SailPixelFormat pixel_format, unsigned colors) {
+
+    struct sail_image *image;
+    munit_assert(sail_alloc_image(&image) == SAIL_OK);
+
+    image->width          = 128;
+    image->height         = 128;
+    image->pixel_format   = pixel_format;
+    image->bytes_per_line = sail_bytes_per_line(image->width, image->pixel_format);
+
+    munit_assert(sail_malloc((size_t)image->height * image->bytes_per_line, &image->pixels) == SAIL_OK);
+
+    const unsigned bytes_per_pixel = sail_bits_per_pixel(pixel_format) / 8;
+
+    for (unsigned row = 0; row < image->height; row++) {
+        uint8_t *scan = sail_scan_line(image, row);
+
+        for (unsigned column = 0; column < image->width; column++, scan += bytes_per_pixel) {
+            const unsigned seed = (colors == 0) ? column : (column * colors / image->width);
+
+            scan[0] = (uint8_t)(seed * 2);
+            scan[1] = (uint8_t)((colors == 0) ? row * 2 : seed * 7);
+            scan[2] = (uint8_t)((colors == 0) ? 255 - (column + row) : seed * 13);
+
+            if (bytes_per_pixel == 4) {
+                scan[3] = (uint8_t)((colors == 0) ? ((row < 32) ? 0 : 255 - row) : 255);
+            }
+        }
+    }
+
+    return image;
+}
+
+static unsigned fetch_index(const struct sail_image *image, unsigned row, unsigned column) {
+
+    const unsigned bits = sail_bits_per_pixel(image->pixel_format);
+    const unsigned pixels_per_byte = 8 / bits;
+    const uint8_t *scan = sail_scan_line(image, row);
+
+    return (scan[column / pixels_per_byte] >> (8 - bits * (column % pixels_per_byte + 1))) & ((1u << bits) - 1);
+}
+
+static void assert_indexes_valid(const struct sail_image *image) {
+
+    munit_assert_not_null(image->palette);
+    munit_assert_uint(image->palette->color_count, >, 0);
+    munit_assert_uint(image->palette->color_count, <=, 1u << sail_bits_per_pixel(image->pixel_format));
+
+    for (unsigned row = 0; row < image->height; row++) {
+        for (unsigned column = 0; column < image->width; column++) {
+            munit_assert_uint(fetch_index(image, row, column), <, image->palette->color_count);
+        }
+    }
+}
+
+static MunitResult test_exact_palette(const MunitParameter params[], void *user_data) {
+
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image = alloc_gradient_image(SAIL_PIXEL_FORMAT_BPP24_RGB, 16);
+    struct sail_image *image_indexed;
+    struct sail_image *image_output;
+
+    /* Images with few colors are converted losslessly. */
+    munit_assert(sail_convert_image(image, SAIL_PIXEL_FORMAT_BPP4_INDEXED, &image_indexed) == SAIL_OK);
+    assert_indexes_valid(image_indexed);
+    munit_assert_int(image_indexed->palette->pixel_format, ==, SAIL_PIXEL_FORMAT_BPP24_RGB);
+
+    munit_assert(sail_convert_image(image_indexed, SAIL_PIXEL_FORMAT_BPP24_RGB, &image_output) == SAIL_OK);
+    munit_assert_memory_equal((size_t)image->height * image->bytes_per_line, image_output->pixels, image->pixels);
+    sail_destroy_image(image_output);
+
+    /* Indexes are repacked as is when the palette fits. */
+    munit_assert(sail_convert_image(image_indexed, SAIL_PIXEL_FORMAT_BPP8_INDEXED, &image_output) == SAIL_OK);
+    munit_assert_uint(image_output->palette->color_count, ==, image_indexed->palette->color_count);
+    munit_assert_memory_equal((size_t)image_indexed->palette->color_count * 3, image_output->palette->data, image_indexed->palette->data);
+
+    for (unsigned row = 0; row < image->height; row++) {
+        for (unsigned column = 0; column < image->width; column++) {
+            munit_assert_uint(fetch_index(image_output, row, column), ==, fetch_index(image_indexed, row, column));
+        }
+    }
+
+    sail_destroy_image(image_output);
+    sail_destroy_image(image_indexed);
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_quantize(const MunitParameter params[], void *user_data) {
+
+    (void)user_data;
+
+    const enum SailPixelFormat pixel_format = sail_pixel_format_from_string(munit_parameters_get(params, "pixel-format"));
+    const char *algorithm = munit_parameters_get(params, "algorithm");
+    const char *dithering = munit_parameters_get(params, "dithering");
+
+    struct sail_conversion_options *options;
+    munit_assert(sail_alloc_conversion_options(&options) == SAIL_OK);
+
+    options->quantization = (strcmp(algorithm, "octree") == 0) ? SAIL_QUANTIZATION_ALGORITHM_OCTREE
+                                : (strcmp(algorithm, "kmeans") == 0) ? SAIL_QUANTIZATION_ALGORITHM_KMEANS
+                                : SAIL_QUANTIZATION_ALGORITHM_MEDIAN_CUT;
+    options->dithering = (strcmp(dithering, "floyd-steinberg") == 0) ? SAIL_DITHERING_FLOYD_STEINBERG
+                            : (strcmp(dithering, "ordered") == 0) ? SAIL_DITHERING_ORDERED
+                            : SAIL_DITHERING_NONE;
+
+    struct sail_image *image = alloc_gradient_image(SAIL_PIXEL_FORMAT_BPP24_RGB, 0);
+    struct sail_image *image_indexed;
+    struct sail_image *image_output;
+
+    munit_assert(sail_convert_image_with_options(image, pixel_format, options, &image_indexed) == SAIL_OK);
+    munit_assert_int(image_indexed->pixel_format, ==, pixel_format);
+    assert_indexes_valid(image_indexed);
+
+    /* Average colors of 8x8 blocks stay close to the original as dithering preserves them. */
+    munit_assert(sail_convert_image(image_indexed, SAIL_PIXEL_FORMAT_BPP24_RGB, &image_output) == SAIL_OK);
+
+    unsigned error = 0;
+    unsigned blocks = 0;
+
+    for (unsigned block_row = 0; block_row < image->height; block_row += 8) {
+        for (unsigned block_column = 0; block_column < image->width; block_column += 8) {
+            for (unsigned channel = 0; channel < 3; channel++) {
+                int sum = 0;
+
+                for (unsigned row = block_row; row < block_row + 8; row++) {
+                    const uint8_t *scan        = sail_scan_line(image, row);
+                    const uint8_t *scan_output = sail_scan_line(image_output, row);
+
+                    for (unsigned column = block_column; column < block_column + 8; column++) {
+                        sum += scan[column * 3 + channel] - scan_output[column * 3 + channel];
+                    }
+                }
+
+                error += (unsigned)abs(sum) / 64;
+                blocks++;
+            }
+        }
+    }
+
+    munit_assert_uint(error / blocks, <=, (pixel_format == SAIL_PIXEL_FORMAT_BPP8_INDEXED) ? 4 : 48);
+
+    sail_destroy_image(image_output);
+    sail_destroy_image(image_indexed);
+    sail_destroy_image(image);
+    sail_destroy_conversion_options(options);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_fixed_palette(const MunitParameter params[], void *user_data) {
+
+    (void)params;
+    (void)user_data;
+
+    static const uint8_t BLACK_AND_WHITE[] = { 0, 0, 0, 255, 255, 255 };
+
+    struct sail_conversion_options *options;
+    munit_assert(sail_alloc_conversion_options(&options) == SAIL_OK);
+    munit_assert(sail_alloc_palette_from_data(SAIL_PIXEL_FORMAT_BPP24_RGB, BLACK_AND_WHITE, 2, &options->palette) == SAIL_OK);
+
+    struct sail_image *image = alloc_gradient_image(SAIL_PIXEL_FORMAT_BPP24_RGB, 0);
+    struct sail_image *image_gray;
+    struct sail_image *image_indexed;
+
+    munit_assert(sail_convert_image(image, SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE, &image_gray) == SAIL_OK);
+    munit_assert(sail_convert_image_with_options(image_gray, SAIL_PIXEL_FORMAT_BPP1_INDEXED, options, &image_indexed) == SAIL_OK);
+    assert_indexes_valid(image_indexed);
+
+    /* The fixed palette is used as is, and pixels map to the nearest colors. */
+    munit_assert_uint(image_indexed->palette->color_count, ==, 2);
+    munit_assert_memory_equal(sizeof(BLACK_AND_WHITE), image_indexed->palette->data, BLACK_AND_WHITE);
+
+    for (unsigned row = 0; row < image->height; row++) {
+        const uint8_t *scan = sail_scan_line(image_gray, row);
+
+        for (unsigned column = 0; column < image->width; column++) {
+            munit_assert_uint(fetch_index(image_indexed, row, column), ==, (scan[column] < 128) ? 0 : 1);
+        }
+    }
+
+    sail_destroy_image(image_indexed);
+
+    /* Fixed palettes may have less colors than the output pixel format addresses. */
+    munit_assert(sail_convert_image_with_options(image_gray, SAIL_PIXEL_FORMAT_BPP8_INDEXED, options, &image_indexed) == SAIL_OK);
+    munit_assert_uint(image_indexed->palette->color_count, ==, 2);
+    sail_destroy_image(image_indexed);
+
+    /* The palette doesn't fit. */
+    sail_destroy_palette(options->palette);
+    munit_assert(sail_alloc_palette_for_data(SAIL_PIXEL_FORMAT_BPP24_RGB, 3, &options->palette) == SAIL_OK);
+    munit_assert(sail_convert_image_with_options(image_gray, SAIL_PIXEL_FORMAT_BPP1_INDEXED, options, &image_indexed) != SAIL_OK);
+
+    sail_destroy_image(image_gray);
+    sail_destroy_image(image);
+    sail_destroy_conversion_options(options);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_alpha(const MunitParameter params[], void *user_data) {
+
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image = alloc_gradient_image(SAIL_PIXEL_FORMAT_BPP32_RGBA, 0);
+    struct sail_image *image_indexed;
+
+    /* Translucent pixels produce RGBA palettes, and transparent pixels stay transparent. */
+    munit_assert(sail_convert_image(image, SAIL_PIXEL_FORMAT_BPP8_INDEXED, &image_indexed) == SAIL_OK);
+    assert_indexes_valid(image_indexed);
+    munit_assert_int(image_indexed->palette->pixel_format, ==, SAIL_PIXEL_FORMAT_BPP32_RGBA);
+
+    const uint8_t *palette = image_indexed->palette->data;
+
+    for (unsigned row = 0; row < image->height; row++) {
+        const uint8_t *scan = sail_scan_line(image, row);
+
+        for (unsigned column = 0; column < image->width; column++) {
+            const uint8_t alpha = palette[fetch_index(image_indexed, row, column) * 4 + 3];
+
+            if (scan[column * 4 + 3] == 0) {
+                munit_assert_uint8(alpha, ==, 0);
+            } else {
+                munit_assert_int(abs(alpha - scan[column * 4 + 3]), <=, 32);
+            }
+        }
+    }
+
+    sail_destroy_image(image_indexed);
+
+    /* Blending produces RGB palettes. */
+    struct sail_conversion_options *options;
+    munit_assert(sail_alloc_conversion_options(&options) == SAIL_OK);
+    options->options = SAIL_CONVERSION_OPTION_BLEND_ALPHA;
+    options->dithering = SAIL_DITHERING_FLOYD_STEINBERG;
+
+    munit_assert(sail_convert_image_with_options(image, SAIL_PIXEL_FORMAT_BPP4_INDEXED, options, &image_indexed) == SAIL_OK);
+    assert_indexes_valid(image_indexed);
+    munit_assert_int(image_indexed->palette->pixel_format, ==, SAIL_PIXEL_FORMAT_BPP24_RGB);
+
+    sail_destroy_image(image_indexed);
+    sail_destroy_conversion_options(options);
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_can_convert(const MunitParameter params[], void *user_data) {
+
+    (void)params;
+    (void)user_data;
+
+    munit_assert(sail_can_convert(SAIL_PIXEL_FORMAT_BPP24_RGB, SAIL_PIXEL_FORMAT_BPP8_INDEXED));
+    munit_assert(sail_can_convert(SAIL_PIXEL_FORMAT_BPP64_ABGR, SAIL_PIXEL_FORMAT_BPP1_INDEXED));
+    munit_assert(sail_can_convert(SAIL_PIXEL_FORMAT_BPP8_INDEXED, SAIL_PIXEL_FORMAT_BPP4_INDEXED));
+    munit_assert(sail_can_convert(SAIL_PIXEL_FORMAT_BPP12_YUV420P, SAIL_PIXEL_FORMAT_BPP2_INDEXED));
+    munit_assert(!sail_can_convert(SAIL_PIXEL_FORMAT_BPP24_CIE_LAB, SAIL_PIXEL_FORMAT_BPP8_INDEXED));
+
+    return MUNIT_OK;
+}
+
+static char *pixel_format_params[] = {
+    (char *)"BPP1-INDEXED",
+    (char *)"BPP4-INDEXED",
+    (char *)"BPP8-INDEXED",
+    NULL
+};
+
+static char *algorithm_params[] = { (char *)"median-cut", (char *)"octree", (char *)"kmeans", NULL };
+
+static char *dithering_params[] = { (char *)"none", (char *)"floyd-steinberg", (char *)"ordered", NULL };
+
+static MunitParameterEnum test_params[] = {
+    { (char *)"pixel-format", pixel_format_params },
+    { (char *)"algorithm",    algorithm_params },
+    { (char *)"dithering",    dithering_params },
+    { NULL, NULL },
+};
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/exact-palette", test_exact_palette, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/quantize", test_quantize, NULL, NULL, MUNIT_TEST_OPTION_NONE, test_params },
+    { (char *)"/fixed-palette", test_fixed_palette, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/alpha", test_alpha, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/can-convert", test_can_convert, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/quantize",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
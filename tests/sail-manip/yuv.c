@@ -0,0 +1,196 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <sail/sail.h>
+#include <sail-manip/sail-manip.h>
+
+#include "munit.h"
+
+/* Odd dimensions exercise the partial chroma blocks. */
+static const unsigned WIDTH  = 7;
+static const unsigned HEIGHT = 5;
+
+static struct sail_image* alloc_rgb24_image(void) {
+
+    struct sail_image *image;
+    munit_assert(sail_alloc_image(&image) == SAIL_OK);
+
+    image->width          = WIDTH;
+    image->height         = HEIGHT;
+    image->pixel_format   = SAIL_PIXEL_FORMAT_BPP24_RGB;
+    image->bytes_per_line = sail_bytes_per_line(image->width, image->pixel_format);
+
+    munit_assert(sail_malloc((size_t)image->height * image->bytes_per_line, &image->pixels) == SAIL_OK);
+
+    /* Smooth gradients survive chroma subsampling well. */
+    for (unsigned row = 0; row < image->height; row++) {
+        uint8_t *scan = sail_scan_line(image, row);
+
+        for (unsigned column = 0; column < image->width; column++) {
+            *scan++ = (uint8_t)(60 + column * 10);
+            *scan++ = (uint8_t)(80 + row * 10);
+            *scan++ = (uint8_t)(120 + column * 5 + row * 5);
+        }
+    }
+
+    return image;
+}
+
+static void assert_images_close(const struct sail_image *image1, const struct sail_image *image2, int tolerance) {
+
+    munit_assert_uint(image1->width,  ==, image2->width);
+    munit_assert_uint(image1->height, ==, image2->height);
+
+    for (unsigned row = 0; row < image1->height; row++) {
+        const uint8_t *scan1 = sail_scan_line(image1, row);
+        const uint8_t *scan2 = sail_scan_line(image2, row);
+
+        for (unsigned i = 0; i < image1->width * 3; i++) {
+            munit_assert_int(abs(scan1[i] - scan2[i]), <=, tolerance);
+        }
+    }
+}
+
+static MunitResult test_planes(const MunitParameter params[], void *user_data) {
+
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image;
+    munit_assert(sail_alloc_image(&image) == SAIL_OK);
+
+    image->width          = WIDTH;
+    image->height         = HEIGHT;
+    image->pixel_format   = SAIL_PIXEL_FORMAT_BPP12_YUV420P;
+    image->bytes_per_line = sail_bytes_per_line(image->width, image->pixel_format);
+
+    munit_assert_uint(image->bytes_per_line, ==, WIDTH);
+    munit_assert_size(sail_bytes_per_image(image), ==, 7 * 5 + 4 * 3 * 2);
+
+    image->pixel_format = SAIL_PIXEL_FORMAT_BPP16_YUV422P;
+    munit_assert_size(sail_bytes_per_image(image), ==, 7 * 5 + 4 * 5 * 2);
+
+    image->pixel_format = SAIL_PIXEL_FORMAT_BPP12_NV12;
+    munit_assert_size(sail_bytes_per_image(image), ==, 7 * 5 + 8 * 3);
+
+    struct sail_plane planes[3];
+    unsigned planes_count;
+    munit_assert(sail_image_planes(image, planes, &planes_count) == SAIL_OK);
+    munit_assert_uint(planes_count, ==, 2);
+    munit_assert_uint(planes[1].width, ==, 4);
+    munit_assert_uint(planes[1].height, ==, 3);
+    munit_assert_uint(planes[1].bytes_per_line, ==, 8);
+
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_round_trip(const MunitParameter params[], void *user_data) {
+
+    (void)params;
+    (void)user_data;
+
+    const enum SailPixelFormat pixel_formats[] = {
+        SAIL_PIXEL_FORMAT_BPP12_YUV420P,
+        SAIL_PIXEL_FORMAT_BPP16_YUV422P,
+        SAIL_PIXEL_FORMAT_BPP12_NV12,
+    };
+
+    struct sail_image *image = alloc_rgb24_image();
+
+    for (size_t i = 0; i < sizeof(pixel_formats) / sizeof(pixel_formats[0]); i++) {
+        munit_assert(sail_can_convert(SAIL_PIXEL_FORMAT_BPP24_RGB, pixel_formats[i]));
+        munit_assert(sail_can_convert(pixel_formats[i], SAIL_PIXEL_FORMAT_BPP24_RGB));
+
+        struct sail_image *image_yuv;
+        munit_assert(sail_convert_image(image, pixel_formats[i], &image_yuv) == SAIL_OK);
+        munit_assert(image_yuv->pixel_format == pixel_formats[i]);
+
+        struct sail_image *image_rgb;
+        munit_assert(sail_convert_image(image_yuv, SAIL_PIXEL_FORMAT_BPP24_RGB, &image_rgb) == SAIL_OK);
+        assert_images_close(image, image_rgb, 8);
+
+        sail_destroy_image(image_rgb);
+        sail_destroy_image(image_yuv);
+    }
+
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_rearrange(const MunitParameter params[], void *user_data) {
+
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image = alloc_rgb24_image();
+
+    struct sail_image *image_i420;
+    munit_assert(sail_convert_image(image, SAIL_PIXEL_FORMAT_BPP12_YUV420P, &image_i420) == SAIL_OK);
+
+    struct sail_image *image_nv12;
+    munit_assert(sail_convert_image(image, SAIL_PIXEL_FORMAT_BPP12_NV12, &image_nv12) == SAIL_OK);
+
+    /* I420 -> NV12 must match the direct conversion exactly and back. */
+    struct sail_image *image_output;
+    munit_assert(sail_convert_image(image_i420, SAIL_PIXEL_FORMAT_BPP12_NV12, &image_output) == SAIL_OK);
+    munit_assert_memory_equal(sail_bytes_per_image(image_nv12), image_output->pixels, image_nv12->pixels);
+    sail_destroy_image(image_output);
+
+    munit_assert(sail_convert_image(image_nv12, SAIL_PIXEL_FORMAT_BPP12_YUV420P, &image_output) == SAIL_OK);
+    munit_assert_memory_equal(sail_bytes_per_image(image_i420), image_output->pixels, image_i420->pixels);
+    sail_destroy_image(image_output);
+
+    sail_destroy_image(image_nv12);
+    sail_destroy_image(image_i420);
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/planes", test_planes, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/round-trip", test_round_trip, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/rearrange", test_rearrange, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/yuv",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
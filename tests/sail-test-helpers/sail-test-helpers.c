@@ -0,0 +1,216 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <string.h>
+
+#include <sail/sail.h>
+
+#include "sail-test-helpers.h"
+
+void sail_test_put_bytes(struct sail_test_writer *writer, const void *bytes, size_t size) {
+
+    memcpy(writer->data + writer->size, bytes, size);
+    writer->size += size;
+}
+
+void sail_test_put_uint16_le(struct sail_test_writer *writer, unsigned value) {
+
+    sail_test_put_bytes(writer, (uint8_t[2]){ (uint8_t)value, (uint8_t)(value >> 8) }, 2);
+}
+
+void sail_test_put_uint16_be(struct sail_test_writer *writer, unsigned value) {
+
+    sail_test_put_bytes(writer, (uint8_t[2]){ (uint8_t)(value >> 8), (uint8_t)value }, 2);
+}
+
+void sail_test_put_uint32_le(struct sail_test_writer *writer, uint32_t value) {
+
+    sail_test_put_bytes(writer, (uint8_t[4]){ (uint8_t)value, (uint8_t)(value >> 8), (uint8_t)(value >> 16), (uint8_t)(value >> 24) }, 4);
+}
+
+void sail_test_put_uint32_be(struct sail_test_writer *writer, uint32_t value) {
+
+    sail_test_put_bytes(writer, (uint8_t[4]){ (uint8_t)(value >> 24), (uint8_t)(value >> 16), (uint8_t)(value >> 8), (uint8_t)value }, 4);
+}
+
+static sail_status_t put_tuning(struct sail_hash_map **tuning, const char *key, const struct sail_variant *variant) {
+
+    if (*tuning == NULL) {
+        SAIL_TRY(sail_alloc_hash_map(tuning));
+    }
+
+    SAIL_TRY(sail_put_hash_map(*tuning, key, variant));
+
+    return SAIL_OK;
+}
+
+sail_status_t sail_test_put_tuning_unsigned_int(struct sail_hash_map **tuning, const char *key, unsigned value) {
+
+    struct sail_variant *variant;
+    SAIL_TRY(sail_alloc_variant(&variant));
+
+    SAIL_TRY_OR_CLEANUP(sail_set_variant_unsigned_int(variant, value),
+                        /* cleanup */ sail_destroy_variant(variant));
+    SAIL_TRY_OR_CLEANUP(put_tuning(tuning, key, variant),
+                        /* cleanup */ sail_destroy_variant(variant));
+
+    sail_destroy_variant(variant);
+
+    return SAIL_OK;
+}
+
+sail_status_t sail_test_put_tuning_string(struct sail_hash_map **tuning, const char *key, const char *value) {
+
+    struct sail_variant *variant;
+    SAIL_TRY(sail_alloc_variant(&variant));
+
+    SAIL_TRY_OR_CLEANUP(sail_set_variant_string(variant, value),
+                        /* cleanup */ sail_destroy_variant(variant));
+    SAIL_TRY_OR_CLEANUP(put_tuning(tuning, key, variant),
+                        /* cleanup */ sail_destroy_variant(variant));
+
+    sail_destroy_variant(variant);
+
+    return SAIL_OK;
+}
+
+sail_status_t sail_test_put_tuning_bool(struct sail_hash_map **tuning, const char *key, bool value) {
+
+    struct sail_variant *variant;
+    SAIL_TRY(sail_alloc_variant(&variant));
+
+    SAIL_TRY_OR_CLEANUP(sail_set_variant_bool(variant, value),
+                        /* cleanup */ sail_destroy_variant(variant));
+    SAIL_TRY_OR_CLEANUP(put_tuning(tuning, key, variant),
+                        /* cleanup */ sail_destroy_variant(variant));
+
+    sail_destroy_variant(variant);
+
+    return SAIL_OK;
+}
+
+sail_status_t sail_test_alloc_image(unsigned width, unsigned height, enum SailPixelFormat pixel_format,
+                                    struct sail_image **image) {
+
+    struct sail_image *image_local;
+    SAIL_TRY(sail_alloc_image(&image_local));
+
+    image_local->width          = width;
+    image_local->height         = height;
+    image_local->pixel_format   = pixel_format;
+    image_local->bytes_per_line = sail_bytes_per_line(width, pixel_format);
+
+    SAIL_TRY_OR_CLEANUP(sail_malloc(sail_bytes_per_image(image_local), &image_local->pixels),
+                        /* cleanup */ sail_destroy_image(image_local));
+
+    *image = image_local;
+
+    return SAIL_OK;
+}
+
+sail_status_t sail_test_save_frames(const struct sail_image * const images[], unsigned images_count,
+                                    const struct sail_codec_info *codec_info,
+                                    const struct sail_save_options *save_options,
+                                    void **buffer, size_t *buffer_size) {
+
+    struct sail_io *io;
+    SAIL_TRY(sail_alloc_io_write_growable_memory(&io));
+
+    void *state = NULL;
+    SAIL_TRY_OR_CLEANUP(sail_start_saving_into_io_with_options(io, codec_info, save_options, &state),
+                        /* cleanup */ sail_stop_saving(state), sail_destroy_io(io));
+
+    for (unsigned i = 0; i < images_count; i++) {
+        SAIL_TRY_OR_CLEANUP(sail_write_next_frame(state, images[i]),
+                            /* cleanup */ sail_stop_saving(state), sail_destroy_io(io));
+    }
+
+    SAIL_TRY_OR_CLEANUP(sail_stop_saving(state),
+                        /* cleanup */ sail_destroy_io(io));
+
+    SAIL_TRY_OR_CLEANUP(sail_io_take_buffer(io, buffer, buffer_size),
+                        /* cleanup */ sail_destroy_io(io));
+    sail_destroy_io(io);
+
+    return SAIL_OK;
+}
+
+sail_status_t sail_test_save_image(const struct sail_image *image, const struct sail_codec_info *codec_info,
+                                   const struct sail_save_options *save_options,
+                                   void **buffer, size_t *buffer_size) {
+
+    SAIL_TRY(sail_test_save_frames(&image, 1, codec_info, save_options, buffer, buffer_size));
+
+    return SAIL_OK;
+}
+
+sail_status_t sail_test_load_frames(const void *buffer, size_t buffer_size,
+                                    const struct sail_codec_info *codec_info,
+                                    const struct sail_load_options *load_options,
+                                    struct sail_image *images[], unsigned max_images, unsigned *images_count) {
+
+    void *state;
+    SAIL_TRY(sail_start_loading_from_memory_with_options(buffer, buffer_size, codec_info, load_options, &state));
+
+    sail_status_t status = SAIL_OK;
+    *images_count = 0;
+
+    while (*images_count < max_images && (status = sail_load_next_frame(state, &images[*images_count])) == SAIL_OK) {
+        (*images_count)++;
+    }
+
+    const sail_status_t stop_status = sail_stop_loading(state);
+
+    if (status == SAIL_OK || status == SAIL_ERROR_NO_MORE_FRAMES) {
+        status = stop_status;
+    }
+
+    if (status != SAIL_OK) {
+        for (unsigned i = 0; i < *images_count; i++) {
+            sail_destroy_image(images[i]);
+        }
+
+        *images_count = 0;
+
+        SAIL_LOG_AND_RETURN(status);
+    }
+
+    return SAIL_OK;
+}
+
+sail_status_t sail_test_load_image(const void *buffer, size_t buffer_size,
+                                   const struct sail_codec_info *codec_info,
+                                   const struct sail_load_options *load_options,
+                                   struct sail_image **image) {
+
+    void *state;
+    SAIL_TRY(sail_start_loading_from_memory_with_options(buffer, buffer_size, codec_info, load_options, &state));
+
+    SAIL_TRY_OR_CLEANUP(sail_load_next_frame(state, image),
+                        /* cleanup */ sail_stop_loading(state));
+    SAIL_TRY(sail_stop_loading(state));
+
+    return SAIL_OK;
+}
@@ -0,0 +1,108 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_TEST_HELPERS_H
+#define SAIL_TEST_HELPERS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <sail-common/export.h>
+#include <sail-common/pixel.h>
+#include <sail-common/status.h>
+
+struct sail_codec_info;
+struct sail_hash_map;
+struct sail_image;
+struct sail_load_options;
+struct sail_save_options;
+
+/*
+ * Appends data to a buffer allocated by the caller. The buffer must be large enough.
+ */
+struct sail_test_writer {
+    uint8_t *data;
+    size_t size;
+};
+
+SAIL_EXPORT void sail_test_put_bytes(struct sail_test_writer *writer, const void *bytes, size_t size);
+
+SAIL_EXPORT void sail_test_put_uint16_le(struct sail_test_writer *writer, unsigned value);
+
+SAIL_EXPORT void sail_test_put_uint16_be(struct sail_test_writer *writer, unsigned value);
+
+SAIL_EXPORT void sail_test_put_uint32_le(struct sail_test_writer *writer, uint32_t value);
+
+SAIL_EXPORT void sail_test_put_uint32_be(struct sail_test_writer *writer, uint32_t value);
+
+/*
+ * Puts the tuning value into the hash map. Allocates the hash map if it's NULL.
+ */
+SAIL_EXPORT sail_status_t sail_test_put_tuning_unsigned_int(struct sail_hash_map **tuning, const char *key, unsigned value);
+
+SAIL_EXPORT sail_status_t sail_test_put_tuning_string(struct sail_hash_map **tuning, const char *key, const char *value);
+
+SAIL_EXPORT sail_status_t sail_test_put_tuning_bool(struct sail_hash_map **tuning, const char *key, bool value);
+
+/*
+ * Allocates a new image with uninitialized pixels.
+ */
+SAIL_EXPORT sail_status_t sail_test_alloc_image(unsigned width, unsigned height, enum SailPixelFormat pixel_format,
+                                                struct sail_image **image);
+
+/*
+ * Saves the frames into a new memory buffer. The save options may be NULL. The buffer must be freed with sail_free().
+ */
+SAIL_EXPORT sail_status_t sail_test_save_frames(const struct sail_image * const images[], unsigned images_count,
+                                                const struct sail_codec_info *codec_info,
+                                                const struct sail_save_options *save_options,
+                                                void **buffer, size_t *buffer_size);
+
+/*
+ * Saves the single image into a new memory buffer. The save options may be NULL.
+ */
+SAIL_EXPORT sail_status_t sail_test_save_image(const struct sail_image *image, const struct sail_codec_info *codec_info,
+                                               const struct sail_save_options *save_options,
+                                               void **buffer, size_t *buffer_size);
+
+/*
+ * Loads up to max_images frames from the memory buffer. The codec info and the load options may be NULL.
+ * On error, the loaded frames are destroyed and images_count is set to 0.
+ */
+SAIL_EXPORT sail_status_t sail_test_load_frames(const void *buffer, size_t buffer_size,
+                                                const struct sail_codec_info *codec_info,
+                                                const struct sail_load_options *load_options,
+                                                struct sail_image *images[], unsigned max_images, unsigned *images_count);
+
+/*
+ * Loads the first frame from the memory buffer. The codec info and the load options may be NULL.
+ */
+SAIL_EXPORT sail_status_t sail_test_load_image(const void *buffer, size_t buffer_size,
+                                               const struct sail_codec_info *codec_info,
+                                               const struct sail_load_options *load_options,
+                                               struct sail_image **image);
+
+#endif
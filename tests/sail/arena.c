@@ -0,0 +1,191 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdlib.h>
+
+#include <sail/sail.h>
+
+#include "sail-comparators.h"
+#include "sail-test-helpers.h"
+
+#include "munit.h"
+
+#include "test-images.h"
+
+#define MAX_FRAMES 16
+
+static unsigned allocations;
+
+static void* counting_malloc(size_t size) {
+    allocations++;
+    return malloc(size);
+}
+
+static void* counting_realloc(void *ptr, size_t size) {
+    if (ptr == NULL) {
+        allocations++;
+    }
+    return realloc(ptr, size);
+}
+
+static void* counting_calloc(size_t nmemb, size_t size) {
+    allocations++;
+    return calloc(nmemb, size);
+}
+
+static const struct sail_memory_allocator counting_allocator = {
+    .malloc_func  = counting_malloc,
+    .realloc_func = counting_realloc,
+    .calloc_func  = counting_calloc,
+    .free_func    = free,
+};
+
+/* Loads the frames with or without the arena and counts the allocator calls. */
+static void load_frames(const void *buffer, size_t buffer_size, const struct sail_codec_info *codec_info, int options,
+                        struct sail_image *images[], unsigned *images_count, unsigned *allocations_count) {
+
+    struct sail_load_options *load_options;
+    munit_assert(sail_alloc_load_options_from_features(codec_info->load_features, &load_options) == SAIL_OK);
+    load_options->options |= options;
+
+    allocations = 0;
+    munit_assert(sail_test_load_frames(buffer, buffer_size, codec_info, load_options, images, MAX_FRAMES, images_count) == SAIL_OK);
+    *allocations_count = allocations;
+
+    sail_destroy_load_options(load_options);
+}
+
+static MunitResult test_load(const MunitParameter params[], void *user_data) {
+    (void)user_data;
+
+    const char *path = munit_parameters_get(params, "path");
+
+    const struct sail_codec_info *codec_info;
+
+    if (sail_codec_info_from_path(path, &codec_info) != SAIL_OK) {
+        return MUNIT_SKIP;
+    }
+
+    void *buffer;
+    size_t buffer_size;
+    munit_assert(sail_alloc_data_from_file_contents(path, &buffer, &buffer_size) == SAIL_OK);
+
+    struct sail_image *images[MAX_FRAMES];
+    unsigned images_count;
+    unsigned plain_allocations;
+    load_frames(buffer, buffer_size, codec_info, 0, images, &images_count, &plain_allocations);
+
+    struct sail_image *arena_images[MAX_FRAMES];
+    unsigned arena_images_count;
+    unsigned arena_allocations;
+    load_frames(buffer, buffer_size, codec_info, SAIL_OPTION_ARENA, arena_images, &arena_images_count, &arena_allocations);
+
+    munit_assert_uint(arena_allocations, <, plain_allocations);
+
+    /* The images outlive the arena. */
+    munit_assert_uint(arena_images_count, ==, images_count);
+
+    for (unsigned i = 0; i < images_count; i++) {
+        munit_assert(sail_test_compare_images(images[i], arena_images[i]) == SAIL_OK);
+        sail_destroy_image(images[i]);
+        sail_destroy_image(arena_images[i]);
+    }
+
+    sail_free(buffer);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_save(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    const struct sail_codec_info *codec_info;
+
+    if (sail_codec_info_from_extension("png", &codec_info) != SAIL_OK) {
+        return MUNIT_SKIP;
+    }
+
+    struct sail_image *image;
+    munit_assert(sail_test_alloc_image(16, 16, SAIL_PIXEL_FORMAT_BPP24_RGB, &image) == SAIL_OK);
+
+    for (unsigned i = 0; i < sail_bytes_per_image(image); i++) {
+        ((unsigned char *)image->pixels)[i] = (unsigned char)i;
+    }
+
+    struct sail_save_options *save_options;
+    munit_assert(sail_alloc_save_options_from_features(codec_info->save_features, &save_options) == SAIL_OK);
+    save_options->options |= SAIL_OPTION_ARENA;
+
+    void *buffer;
+    size_t buffer_size;
+    munit_assert(sail_test_save_image(image, codec_info, save_options, &buffer, &buffer_size) == SAIL_OK);
+
+    struct sail_image *loaded_image;
+    munit_assert(sail_test_load_image(buffer, buffer_size, codec_info, NULL, &loaded_image) == SAIL_OK);
+    munit_assert_memory_equal(sail_bytes_per_image(image), loaded_image->pixels, image->pixels);
+
+    sail_destroy_image(loaded_image);
+    sail_free(buffer);
+    sail_destroy_save_options(save_options);
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static char *paths[] = {
+    (char *)SAIL_TEST_IMAGES_PATH "/png/bpp4-indexed.comment.iccp.png",
+    (char *)SAIL_TEST_IMAGES_PATH "/jpeg/bpp24-ycbcr.comment.iccp.jpeg",
+    (char *)SAIL_TEST_IMAGES_PATH "/ico/bpp32-bgra.multiple.ico",
+    NULL
+};
+
+static MunitParameterEnum test_params[] = {
+    { (char *)"path", paths },
+    { NULL, NULL },
+};
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/load", test_load, NULL, NULL, MUNIT_TEST_OPTION_NONE, test_params },
+    { (char *)"/save", test_save, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/arena",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+
+    /* The allocator must be set before any other SAIL function. */
+    sail_set_memory_allocator(&counting_allocator);
+
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
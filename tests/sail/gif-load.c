@@ -0,0 +1,229 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <sail/sail.h>
+
+#include "sail-test-helpers.h"
+
+#include "munit.h"
+
+#include "test-images.h"
+
+#define MAX_FRAMES 8
+
+/*
+ * 16x12 screen with frames of different sizes, offsets, transparency and disposal methods.
+ */
+static const char PATH[] = SAIL_TEST_IMAGES_PATH "/gif/bpp8-indexed.animated.gif";
+
+static const struct {
+    unsigned left;
+    unsigned top;
+    unsigned width;
+    unsigned height;
+    const char *disposal;
+} EXPECTED_FRAMES[] = {
+    { 0,  0, 16, 12, "none"       },
+    { 2,  3,  8,  6, "background" },
+    { 8,  6,  6,  4, "previous"   },
+    { 0,  0, 16, 12, "none"       },
+    { 10, 6,  5,  5, "none"       },
+};
+
+#define EXPECTED_FRAMES_COUNT (sizeof(EXPECTED_FRAMES) / sizeof(EXPECTED_FRAMES[0]))
+
+static sail_status_t load_frames(bool raw_frames, struct sail_image *images[], unsigned *images_count) {
+
+    const struct sail_codec_info *codec_info;
+    SAIL_TRY(sail_codec_info_from_extension("gif", &codec_info));
+
+    void *buffer;
+    size_t buffer_size;
+    SAIL_TRY(sail_alloc_data_from_file_contents(PATH, &buffer, &buffer_size));
+
+    struct sail_load_options *load_options;
+    SAIL_TRY_OR_CLEANUP(sail_alloc_load_options_from_features(codec_info->load_features, &load_options),
+                        /* cleanup */ sail_free(buffer));
+
+    if (raw_frames) {
+        SAIL_TRY_OR_CLEANUP(sail_test_put_tuning_bool(&load_options->tuning, "gif-raw-frames", true),
+                            /* cleanup */ sail_destroy_load_options(load_options),
+                                          sail_free(buffer));
+    }
+
+    SAIL_TRY_OR_CLEANUP(sail_test_load_frames(buffer, buffer_size, codec_info, load_options, images, MAX_FRAMES, images_count),
+                        /* cleanup */ sail_destroy_load_options(load_options),
+                                      sail_free(buffer));
+
+    sail_destroy_load_options(load_options);
+    sail_free(buffer);
+
+    return SAIL_OK;
+}
+
+static void destroy_frames(struct sail_image *images[], unsigned images_count) {
+
+    for (unsigned i = 0; i < images_count; i++) {
+        sail_destroy_image(images[i]);
+    }
+}
+
+static unsigned unsigned_property(const struct sail_image *image, const char *key) {
+
+    const struct sail_variant *variant = sail_hash_map_value(image->source_image->special_properties, key);
+    munit_assert_not_null(variant);
+
+    return sail_variant_to_unsigned_int(variant);
+}
+
+static MunitResult test_raw_frames(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    const struct sail_codec_info *codec_info;
+
+    if (sail_codec_info_from_extension("gif", &codec_info) != SAIL_OK) {
+        return MUNIT_SKIP;
+    }
+
+    struct sail_image *images[MAX_FRAMES];
+    unsigned images_count;
+    munit_assert(load_frames(true, images, &images_count) == SAIL_OK);
+    munit_assert_uint(images_count, ==, EXPECTED_FRAMES_COUNT);
+
+    for (unsigned i = 0; i < images_count; i++) {
+        const struct sail_image *image = images[i];
+
+        munit_assert_uint(image->width, ==, EXPECTED_FRAMES[i].width);
+        munit_assert_uint(image->height, ==, EXPECTED_FRAMES[i].height);
+        munit_assert(image->pixel_format == SAIL_PIXEL_FORMAT_BPP32_RGBA);
+
+        /* Stored without SAIL_OPTION_SOURCE_IMAGE. */
+        munit_assert_not_null(image->source_image);
+        munit_assert_not_null(image->source_image->special_properties);
+
+        munit_assert_uint(unsigned_property(image, "gif-screen-width"), ==, 16);
+        munit_assert_uint(unsigned_property(image, "gif-screen-height"), ==, 12);
+        munit_assert_uint(unsigned_property(image, "gif-frame-left"), ==, EXPECTED_FRAMES[i].left);
+        munit_assert_uint(unsigned_property(image, "gif-frame-top"), ==, EXPECTED_FRAMES[i].top);
+
+        const struct sail_variant *disposal = sail_hash_map_value(image->source_image->special_properties, "gif-frame-disposal");
+        munit_assert_not_null(disposal);
+        munit_assert_string_equal(sail_variant_to_string(disposal), EXPECTED_FRAMES[i].disposal);
+    }
+
+    destroy_frames(images, images_count);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_composed(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    const struct sail_codec_info *codec_info;
+
+    if (sail_codec_info_from_extension("gif", &codec_info) != SAIL_OK) {
+        return MUNIT_SKIP;
+    }
+
+    struct sail_image *raw_images[MAX_FRAMES];
+    unsigned raw_images_count;
+    munit_assert(load_frames(true, raw_images, &raw_images_count) == SAIL_OK);
+
+    struct sail_image *images[MAX_FRAMES];
+    unsigned images_count;
+    munit_assert(load_frames(false, images, &images_count) == SAIL_OK);
+    munit_assert_uint(images_count, ==, raw_images_count);
+
+    /*
+     * Compose the raw frames independently. Transparent pixels keep the canvas,
+     * "background" clears the frame rectangle to transparent before the next frame.
+     * The codec treats "previous" as "none".
+     */
+    uint32_t canvas[12][16];
+    memset(canvas, 0, sizeof(canvas));
+
+    for (unsigned i = 0; i < images_count; i++) {
+        const struct sail_image *raw_image = raw_images[i];
+        const struct sail_image *image = images[i];
+
+        munit_assert_uint(image->width, ==, 16);
+        munit_assert_uint(image->height, ==, 12);
+        munit_assert(image->pixel_format == SAIL_PIXEL_FORMAT_BPP32_RGBA);
+        munit_assert_int(image->delay, ==, raw_image->delay);
+
+        if (i > 0 && strcmp(EXPECTED_FRAMES[i - 1].disposal, "background") == 0) {
+            for (unsigned row = 0; row < EXPECTED_FRAMES[i - 1].height; row++) {
+                memset(&canvas[EXPECTED_FRAMES[i - 1].top + row][EXPECTED_FRAMES[i - 1].left], 0,
+                        EXPECTED_FRAMES[i - 1].width * sizeof(uint32_t));
+            }
+        }
+
+        for (unsigned row = 0; row < raw_image->height; row++) {
+            const uint32_t *pixel = sail_scan_line(raw_image, row);
+
+            for (unsigned column = 0; column < raw_image->width; column++) {
+                const unsigned char *rgba = (const unsigned char *)&pixel[column];
+
+                if (rgba[3] != 0) {
+                    canvas[EXPECTED_FRAMES[i].top + row][EXPECTED_FRAMES[i].left + column] = pixel[column];
+                }
+            }
+        }
+
+        for (unsigned row = 0; row < image->height; row++) {
+            munit_assert_memory_equal(sizeof(canvas[row]), sail_scan_line(image, row), canvas[row]);
+        }
+    }
+
+    destroy_frames(images, images_count);
+    destroy_frames(raw_images, raw_images_count);
+
+    return MUNIT_OK;
+}
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/raw-frames", test_raw_frames, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/composed",   test_composed,   NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/gif-load",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
@@ -0,0 +1,578 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sail/sail.h>
+
+#include "sail-test-helpers.h"
+
+#include "munit.h"
+
+/* Larger than the LZW segment of 256K pixels, so parallel saving splits it. */
+#define LARGE_WIDTH  640
+#define LARGE_HEIGHT 480
+
+#define MAX_FRAMES 8
+
+/* Per channel errors of the median cut quantized gradient. */
+#define MAX_QUANTIZATION_ERROR      24
+#define MAX_MEAN_QUANTIZATION_ERROR 6
+
+/*
+ * Allocates an 8-bit indexed frame with distinct palette colors. The palette entry 'transparent_color'
+ * is made transparent. -1 means no transparent entries.
+ */
+static sail_status_t alloc_frame(unsigned width, unsigned height, unsigned color_count, int transparent_color,
+                                    struct sail_image **image) {
+
+    struct sail_image *image_local;
+    SAIL_TRY(sail_test_alloc_image(width, height, SAIL_PIXEL_FORMAT_BPP8_INDEXED, &image_local));
+
+    const enum SailPixelFormat palette_pixel_format = (transparent_color >= 0) ? SAIL_PIXEL_FORMAT_BPP32_RGBA : SAIL_PIXEL_FORMAT_BPP24_RGB;
+    const unsigned bytes_per_color = (transparent_color >= 0) ? 4 : 3;
+
+    SAIL_TRY_OR_CLEANUP(sail_alloc_palette_for_data(palette_pixel_format, color_count, &image_local->palette),
+                        /* cleanup */ sail_destroy_image(image_local));
+
+    /* Distinct colors, so every index is decoded unambiguously. */
+    unsigned char *color = image_local->palette->data;
+
+    for (unsigned i = 0; i < color_count; i++, color += bytes_per_color) {
+        color[0] = (unsigned char)i;
+        color[1] = (unsigned char)(255 - i);
+        color[2] = (unsigned char)(i * 7);
+
+        if (bytes_per_color == 4) {
+            color[3] = ((int)i == transparent_color) ? 0 : 255;
+        }
+    }
+
+    image_local->delay = 100;
+
+    *image = image_local;
+
+    return SAIL_OK;
+}
+
+static void fill_frame(struct sail_image *image, unsigned seed) {
+
+    const unsigned color_count = image->palette->color_count;
+
+    for (unsigned row = 0; row < image->height; row++) {
+        unsigned char *scan = sail_scan_line(image, row);
+
+        for (unsigned column = 0; column < image->width; column++) {
+            scan[column] = (unsigned char)((column / 3 + row / 5 + seed) % color_count);
+        }
+    }
+}
+
+static void fill_rectangle(struct sail_image *image, unsigned left, unsigned top, unsigned width, unsigned height, unsigned char index) {
+
+    for (unsigned row = top; row < top + height; row++) {
+        memset((unsigned char *)sail_scan_line(image, row) + left, index, width);
+    }
+}
+
+/* Compares the composited RGBA frame with the indexed frame it was saved from. */
+static void assert_frame_equal(const struct sail_image *expected, const struct sail_image *actual) {
+
+    munit_assert_uint(actual->width, ==, expected->width);
+    munit_assert_uint(actual->height, ==, expected->height);
+    munit_assert(actual->pixel_format == SAIL_PIXEL_FORMAT_BPP32_RGBA);
+
+    const struct sail_palette *palette = expected->palette;
+    const unsigned bytes_per_color = (palette->pixel_format == SAIL_PIXEL_FORMAT_BPP32_RGBA) ? 4 : 3;
+
+    for (unsigned row = 0; row < expected->height; row++) {
+        const unsigned char *indexes = sail_scan_line(expected, row);
+        const unsigned char *pixel = sail_scan_line(actual, row);
+
+        for (unsigned column = 0; column < expected->width; column++, pixel += 4) {
+            const unsigned char *color = (const unsigned char *)palette->data + indexes[column] * bytes_per_color;
+
+            /* Transparent pixels show the transparent background. */
+            if (bytes_per_color == 4 && color[3] < 128) {
+                const unsigned char transparent[4] = { 0, 0, 0, 0 };
+                munit_assert_memory_equal(4, pixel, transparent);
+            } else {
+                const unsigned char opaque[4] = { color[0], color[1], color[2], 255 };
+                munit_assert_memory_equal(4, pixel, opaque);
+            }
+        }
+    }
+}
+
+static void assert_round_trip(struct sail_image *frames[], unsigned frames_count, const struct sail_codec_info *codec_info,
+                                const struct sail_save_options *save_options) {
+
+    void *buffer = NULL;
+    size_t buffer_size;
+    munit_assert(sail_test_save_frames((const struct sail_image * const *)frames, frames_count, codec_info, save_options,
+                                        &buffer, &buffer_size) == SAIL_OK);
+
+    struct sail_image *images[MAX_FRAMES];
+    unsigned images_count;
+    munit_assert(sail_test_load_frames(buffer, buffer_size, codec_info, NULL, images, MAX_FRAMES, &images_count) == SAIL_OK);
+    munit_assert_uint(images_count, ==, frames_count);
+
+    for (unsigned i = 0; i < frames_count; i++) {
+        assert_frame_equal(frames[i], images[i]);
+        sail_destroy_image(images[i]);
+    }
+
+    sail_free(buffer);
+}
+
+/*
+ * Converts the indexed frame to the RGB-family pixel format. Channel offsets follow
+ * the pixel format name. Transparent colors lose their alpha in 24-bit formats.
+ */
+static sail_status_t indexed_to_rgb(const struct sail_image *image, enum SailPixelFormat pixel_format, struct sail_image **rgb_image) {
+
+    /* R, G, B, A offsets. */
+    int offsets[4];
+
+    switch (pixel_format) {
+        case SAIL_PIXEL_FORMAT_BPP24_RGB:  memcpy(offsets, (int[4]) { 0, 1, 2, -1 }, sizeof(offsets)); break;
+        case SAIL_PIXEL_FORMAT_BPP24_BGR:  memcpy(offsets, (int[4]) { 2, 1, 0, -1 }, sizeof(offsets)); break;
+        case SAIL_PIXEL_FORMAT_BPP32_RGBA: memcpy(offsets, (int[4]) { 0, 1, 2,  3 }, sizeof(offsets)); break;
+        case SAIL_PIXEL_FORMAT_BPP32_BGRA: memcpy(offsets, (int[4]) { 2, 1, 0,  3 }, sizeof(offsets)); break;
+        case SAIL_PIXEL_FORMAT_BPP32_ARGB: memcpy(offsets, (int[4]) { 1, 2, 3,  0 }, sizeof(offsets)); break;
+        case SAIL_PIXEL_FORMAT_BPP32_ABGR: memcpy(offsets, (int[4]) { 3, 2, 1,  0 }, sizeof(offsets)); break;
+
+        default: {
+            return SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT;
+        }
+    }
+
+    struct sail_image *rgb_image_local;
+    SAIL_TRY(sail_test_alloc_image(image->width, image->height, pixel_format, &rgb_image_local));
+
+    const struct sail_palette *palette = image->palette;
+    const unsigned bytes_per_color = (palette->pixel_format == SAIL_PIXEL_FORMAT_BPP32_RGBA) ? 4 : 3;
+    const unsigned bytes_per_pixel = (offsets[3] >= 0) ? 4 : 3;
+
+    for (unsigned row = 0; row < image->height; row++) {
+        const unsigned char *indexes = sail_scan_line(image, row);
+        unsigned char *pixel = sail_scan_line(rgb_image_local, row);
+
+        for (unsigned column = 0; column < image->width; column++, pixel += bytes_per_pixel) {
+            const unsigned char *color = (const unsigned char *)palette->data + indexes[column] * bytes_per_color;
+
+            pixel[offsets[0]] = color[0];
+            pixel[offsets[1]] = color[1];
+            pixel[offsets[2]] = color[2];
+
+            if (offsets[3] >= 0) {
+                pixel[offsets[3]] = (bytes_per_color == 4) ? color[3] : 255;
+            }
+        }
+    }
+
+    rgb_image_local->delay = image->delay;
+
+    *rgb_image = rgb_image_local;
+
+    return SAIL_OK;
+}
+
+static void destroy_frames(struct sail_image *frames[], unsigned frames_count) {
+
+    for (unsigned i = 0; i < frames_count; i++) {
+        sail_destroy_image(frames[i]);
+    }
+}
+
+static MunitResult test_single_frame(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    const struct sail_codec_info *codec_info;
+
+    if (sail_codec_info_from_extension("gif", &codec_info) != SAIL_OK) {
+        return MUNIT_SKIP;
+    }
+
+    struct sail_image *frame;
+    munit_assert(alloc_frame(33, 17, 16, -1, &frame) == SAIL_OK);
+    fill_frame(frame, 0);
+
+    assert_round_trip(&frame, 1, codec_info, NULL);
+
+    sail_destroy_image(frame);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_animated(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    const struct sail_codec_info *codec_info;
+
+    if (sail_codec_info_from_extension("gif", &codec_info) != SAIL_OK) {
+        return MUNIT_SKIP;
+    }
+
+    /* Frames of different content over the whole screen, some with transparent pixels. */
+    struct sail_image *frames[4];
+
+    for (unsigned i = 0; i < 4; i++) {
+        munit_assert(alloc_frame(40, 30, 32, 5, &frames[i]) == SAIL_OK);
+        fill_frame(frames[i], i * 3);
+    }
+
+    /* Transparent pixels over opaque pixels of the previous frame. */
+    fill_rectangle(frames[2], 10, 8, 12, 6, 5);
+
+    assert_round_trip(frames, 4, codec_info, NULL);
+
+    destroy_frames(frames, 4);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_delta_transparency(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    const struct sail_codec_info *codec_info;
+
+    if (sail_codec_info_from_extension("gif", &codec_info) != SAIL_OK) {
+        return MUNIT_SKIP;
+    }
+
+    /*
+     * Palettes without transparent colors and with room for one more entry.
+     * Unchanged pixels around a moving block are written with the reserved transparency index.
+     */
+    struct sail_image *frames[5];
+
+    for (unsigned i = 0; i < 5; i++) {
+        munit_assert(alloc_frame(48, 32, 16, -1, &frames[i]) == SAIL_OK);
+        fill_frame(frames[i], 0);
+        fill_rectangle(frames[i], 4 + i * 6, 10, 8, 8, 15);
+    }
+
+    /* A frame without changes. */
+    memcpy(frames[4]->pixels, frames[3]->pixels, sail_bytes_per_image(frames[3]));
+
+    assert_round_trip(frames, 5, codec_info, NULL);
+
+    destroy_frames(frames, 5);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_full_palette(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    const struct sail_codec_info *codec_info;
+
+    if (sail_codec_info_from_extension("gif", &codec_info) != SAIL_OK) {
+        return MUNIT_SKIP;
+    }
+
+    /* No room for the transparency index. Delta frames are only cropped. */
+    struct sail_image *frames[3];
+
+    for (unsigned i = 0; i < 3; i++) {
+        munit_assert(alloc_frame(64, 48, 256, -1, &frames[i]) == SAIL_OK);
+        fill_frame(frames[i], 0);
+    }
+
+    fill_rectangle(frames[1], 20, 10, 16, 12, 255);
+    fill_rectangle(frames[2], 30, 20, 10, 10, 0);
+
+    assert_round_trip(frames, 3, codec_info, NULL);
+
+    destroy_frames(frames, 3);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_interlaced(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    const struct sail_codec_info *codec_info;
+
+    if (sail_codec_info_from_extension("gif", &codec_info) != SAIL_OK) {
+        return MUNIT_SKIP;
+    }
+
+    struct sail_save_options *save_options;
+    munit_assert(sail_alloc_save_options_from_features(codec_info->save_features, &save_options) == SAIL_OK);
+    save_options->options |= SAIL_OPTION_INTERLACED;
+
+    /* Heights not divisible by the interlacing steps. */
+    struct sail_image *frames[3];
+
+    for (unsigned i = 0; i < 3; i++) {
+        munit_assert(alloc_frame(29, 37, 64, -1, &frames[i]) == SAIL_OK);
+        fill_frame(frames[i], i);
+    }
+
+    fill_rectangle(frames[2], 3, 5, 7, 19, 1);
+
+    assert_round_trip(frames, 3, codec_info, save_options);
+
+    destroy_frames(frames, 3);
+    sail_destroy_save_options(save_options);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_threads(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    const struct sail_codec_info *codec_info;
+
+    if (sail_codec_info_from_extension("gif", &codec_info) != SAIL_OK) {
+        return MUNIT_SKIP;
+    }
+
+    struct sail_save_options *save_options;
+    munit_assert(sail_alloc_save_options_from_features(codec_info->save_features, &save_options) == SAIL_OK);
+    munit_assert(sail_test_put_tuning_unsigned_int(&save_options->tuning, "gif-threads", 4) == SAIL_OK);
+
+    srand(1);
+
+    struct sail_image *frames[2];
+
+    for (unsigned i = 0; i < 2; i++) {
+        munit_assert(alloc_frame(LARGE_WIDTH, LARGE_HEIGHT, 256, -1, &frames[i]) == SAIL_OK);
+        fill_frame(frames[i], i);
+    }
+
+    /* Noise fills the LZW dictionary, so segments hit the code size limit. */
+    unsigned char *pixels = frames[0]->pixels;
+
+    for (size_t i = 0; i < sail_bytes_per_image(frames[0]) / 2; i++) {
+        pixels[i] = (unsigned char)rand();
+    }
+
+    assert_round_trip(frames, 2, codec_info, save_options);
+
+    destroy_frames(frames, 2);
+    sail_destroy_save_options(save_options);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_rgb(const MunitParameter params[], void *user_data) {
+    (void)user_data;
+
+    const struct sail_codec_info *codec_info;
+
+    if (sail_codec_info_from_extension("gif", &codec_info) != SAIL_OK) {
+        return MUNIT_SKIP;
+    }
+
+    const enum SailPixelFormat pixel_format = sail_pixel_format_from_string(munit_parameters_get(params, "pixel-format"));
+    const bool alpha = sail_bits_per_pixel(pixel_format) == 32;
+
+    /* Fewer than 256 colors are saved exactly. */
+    struct sail_image *frame;
+    munit_assert(alloc_frame(33, 17, 40, alpha ? 7 : -1, &frame) == SAIL_OK);
+    fill_frame(frame, 0);
+
+    struct sail_image *rgb_frame;
+    munit_assert(indexed_to_rgb(frame, pixel_format, &rgb_frame) == SAIL_OK);
+
+    /* The same path as sail_save_into_file("image.gif", rgb_frame). */
+    void *buffer = NULL;
+    size_t buffer_size;
+    munit_assert(sail_save_into_growable_memory(rgb_frame, codec_info, &buffer, &buffer_size) == SAIL_OK);
+
+    struct sail_image *image;
+    munit_assert(sail_test_load_image(buffer, buffer_size, codec_info, NULL, &image) == SAIL_OK);
+    assert_frame_equal(frame, image);
+
+    sail_destroy_image(image);
+    sail_free(buffer);
+    sail_destroy_image(rgb_frame);
+    sail_destroy_image(frame);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_rgba_animated(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    const struct sail_codec_info *codec_info;
+
+    if (sail_codec_info_from_extension("gif", &codec_info) != SAIL_OK) {
+        return MUNIT_SKIP;
+    }
+
+    /* Moving blocks and transparent pixels, so delta frames are written. */
+    struct sail_image *frames[4];
+    struct sail_image *rgba_frames[4];
+
+    for (unsigned i = 0; i < 4; i++) {
+        munit_assert(alloc_frame(40, 30, 32, 5, &frames[i]) == SAIL_OK);
+        fill_frame(frames[i], 0);
+        fill_rectangle(frames[i], 2 + i * 8, 6, 8, 8, 31);
+    }
+
+    fill_rectangle(frames[2], 10, 20, 12, 6, 5);
+
+    for (unsigned i = 0; i < 4; i++) {
+        munit_assert(indexed_to_rgb(frames[i], SAIL_PIXEL_FORMAT_BPP32_RGBA, &rgba_frames[i]) == SAIL_OK);
+    }
+
+    void *buffer = NULL;
+    size_t buffer_size;
+    munit_assert(sail_test_save_frames((const struct sail_image * const *)rgba_frames, 4, codec_info, NULL,
+                                        &buffer, &buffer_size) == SAIL_OK);
+
+    struct sail_image *images[MAX_FRAMES];
+    unsigned images_count;
+    munit_assert(sail_test_load_frames(buffer, buffer_size, codec_info, NULL, images, MAX_FRAMES, &images_count) == SAIL_OK);
+    munit_assert_uint(images_count, ==, 4);
+
+    for (unsigned i = 0; i < 4; i++) {
+        assert_frame_equal(frames[i], images[i]);
+        sail_destroy_image(images[i]);
+    }
+
+    sail_free(buffer);
+    destroy_frames(rgba_frames, 4);
+    destroy_frames(frames, 4);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_quantized(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    const struct sail_codec_info *codec_info;
+
+    if (sail_codec_info_from_extension("gif", &codec_info) != SAIL_OK) {
+        return MUNIT_SKIP;
+    }
+
+    /* A smooth gradient of 6144 colors is reduced with median cut. */
+    struct sail_image *frame;
+    munit_assert(sail_test_alloc_image(96, 64, SAIL_PIXEL_FORMAT_BPP24_RGB, &frame) == SAIL_OK);
+
+    for (unsigned row = 0; row < frame->height; row++) {
+        unsigned char *pixel = sail_scan_line(frame, row);
+
+        for (unsigned column = 0; column < frame->width; column++, pixel += 3) {
+            pixel[0] = (unsigned char)(column * 255 / 95);
+            pixel[1] = (unsigned char)(row * 4);
+            pixel[2] = (unsigned char)(255 - column - row);
+        }
+    }
+
+    void *buffer = NULL;
+    size_t buffer_size;
+    munit_assert(sail_test_save_image(frame, codec_info, NULL, &buffer, &buffer_size) == SAIL_OK);
+
+    struct sail_image *image;
+    munit_assert(sail_test_load_image(buffer, buffer_size, codec_info, NULL, &image) == SAIL_OK);
+    munit_assert_uint(image->width, ==, frame->width);
+    munit_assert_uint(image->height, ==, frame->height);
+
+    unsigned max_error = 0;
+    uint64_t total_error = 0;
+
+    for (unsigned row = 0; row < frame->height; row++) {
+        const unsigned char *expected = sail_scan_line(frame, row);
+        const unsigned char *actual = sail_scan_line(image, row);
+
+        for (unsigned column = 0; column < frame->width; column++, expected += 3, actual += 4) {
+            munit_assert_uint8(actual[3], ==, 255);
+
+            for (unsigned channel = 0; channel < 3; channel++) {
+                const unsigned error = (unsigned)abs((int)actual[channel] - (int)expected[channel]);
+
+                max_error = (error > max_error) ? error : max_error;
+                total_error += error;
+            }
+        }
+    }
+
+    munit_assert_uint(max_error, <=, MAX_QUANTIZATION_ERROR);
+    munit_assert_uint64(total_error / ((uint64_t)frame->width * frame->height * 3), <=, MAX_MEAN_QUANTIZATION_ERROR);
+
+    sail_destroy_image(image);
+    sail_free(buffer);
+    sail_destroy_image(frame);
+
+    return MUNIT_OK;
+}
+
+static char *pixel_formats[] = {
+    (char *)"BPP24-RGB",
+    (char *)"BPP24-BGR",
+    (char *)"BPP32-RGBA",
+    (char *)"BPP32-BGRA",
+    (char *)"BPP32-ARGB",
+    (char *)"BPP32-ABGR",
+    NULL
+};
+
+static MunitParameterEnum rgb_params[] = {
+    { (char *)"pixel-format", pixel_formats },
+    { NULL, NULL },
+};
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/single-frame",       test_single_frame,       NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/animated",           test_animated,           NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/delta-transparency", test_delta_transparency, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/full-palette",       test_full_palette,       NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/interlaced",         test_interlaced,         NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/threads",            test_threads,            NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/rgb",                test_rgb,                NULL, NULL, MUNIT_TEST_OPTION_NONE, rgb_params },
+    { (char *)"/rgba-animated",      test_rgba_animated,      NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/quantized",          test_quantized,          NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/gif-save",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
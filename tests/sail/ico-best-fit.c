@@ -0,0 +1,357 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sail/sail.h>
+
+#include "sail-test-helpers.h"
+
+#include "munit.h"
+
+#define PNG_SIZE 256
+
+struct entry {
+    unsigned size;
+    unsigned bit_count;
+    uint8_t value;
+};
+
+/* 16x16x32, 32x32x32, 32x32x8 and a 256x256 PNG. */
+static const struct entry bmp_entries[] = {
+    { 16, 32, 0x10 },
+    { 32, 32, 0x20 },
+    { 32,  8, 0x30 },
+};
+
+#define BMP_ENTRIES_COUNT (sizeof(bmp_entries) / sizeof(bmp_entries[0]))
+
+static void put_uint32_at(struct sail_test_writer *writer, size_t offset, uint32_t value) {
+
+    const size_t saved_size = writer->size;
+    writer->size = offset;
+    sail_test_put_uint32_le(writer, value);
+    writer->size = saved_size;
+}
+
+/* BITMAPINFOHEADER with a doubled height, an optional gray palette, a solid image and an empty mask. */
+static void put_bmp(struct sail_test_writer *writer, const struct entry *entry) {
+
+    sail_test_put_uint32_le(writer, 40);
+    sail_test_put_uint32_le(writer, entry->size);
+    sail_test_put_uint32_le(writer, entry->size * 2);
+    sail_test_put_uint16_le(writer, 1);
+    sail_test_put_uint16_le(writer, entry->bit_count);
+
+    for (unsigned i = 0; i < 6; i++) {
+        sail_test_put_uint32_le(writer, 0);
+    }
+
+    if (entry->bit_count == 8) {
+        for (unsigned i = 0; i < 256; i++) {
+            sail_test_put_bytes(writer, (uint8_t[4]){ (uint8_t)i, (uint8_t)i, (uint8_t)i, 0 }, 4);
+        }
+    }
+
+    const unsigned bytes_per_pixel = entry->bit_count / 8;
+
+    for (unsigned y = 0; y < entry->size; y++) {
+        for (unsigned x = 0; x < entry->size; x++) {
+            if (bytes_per_pixel == 4) {
+                sail_test_put_bytes(writer, (uint8_t[4]){ entry->value, entry->value, entry->value, 0xff }, 4);
+            } else {
+                sail_test_put_bytes(writer, &entry->value, 1);
+            }
+        }
+    }
+
+    const unsigned mask_bytes_per_line = (entry->size + 31) / 32 * 4;
+    memset(writer->data + writer->size, 0, mask_bytes_per_line * entry->size);
+    writer->size += mask_bytes_per_line * entry->size;
+}
+
+static sail_status_t build_png(void **png, size_t *png_size) {
+
+    const struct sail_codec_info *codec_info;
+    SAIL_TRY(sail_codec_info_from_extension("png", &codec_info));
+
+    struct sail_image *image;
+    SAIL_TRY(sail_test_alloc_image(PNG_SIZE, PNG_SIZE, SAIL_PIXEL_FORMAT_BPP32_RGBA, &image));
+
+    for (unsigned y = 0; y < PNG_SIZE; y++) {
+        uint8_t *scan = sail_scan_line(image, y);
+
+        for (unsigned x = 0; x < PNG_SIZE; x++) {
+            scan[x * 4 + 0] = (uint8_t)x;
+            scan[x * 4 + 1] = (uint8_t)y;
+            scan[x * 4 + 2] = (uint8_t)(x ^ y);
+            scan[x * 4 + 3] = (uint8_t)(255 - x);
+        }
+    }
+
+    SAIL_TRY_OR_CLEANUP(sail_save_into_growable_memory(image, codec_info, png, png_size),
+                        /* cleanup */ sail_destroy_image(image));
+
+    sail_destroy_image(image);
+
+    return SAIL_OK;
+}
+
+/* Builds an icon with the BMP entries and optionally a PNG entry. */
+static uint8_t* build_ico(const void *png, size_t png_size, unsigned *entries_count, size_t *ico_size) {
+
+    *entries_count = BMP_ENTRIES_COUNT + (png != NULL ? 1 : 0);
+
+    struct sail_test_writer writer = { malloc(1024 * 1024 + png_size), 0 };
+
+    sail_test_put_uint16_le(&writer, 0);
+    sail_test_put_uint16_le(&writer, 1);
+    sail_test_put_uint16_le(&writer, *entries_count);
+
+    const size_t dir_offset = writer.size;
+
+    for (unsigned i = 0; i < *entries_count; i++) {
+        const bool is_png = i == BMP_ENTRIES_COUNT;
+
+        sail_test_put_bytes(&writer, (uint8_t[4]){ is_png ? 0 : (uint8_t)bmp_entries[i].size, is_png ? 0 : (uint8_t)bmp_entries[i].size, 0, 0 }, 4);
+        sail_test_put_uint16_le(&writer, 1);
+        sail_test_put_uint16_le(&writer, is_png ? 32 : bmp_entries[i].bit_count);
+        /* Size and offset are patched below. */
+        sail_test_put_uint32_le(&writer, 0);
+        sail_test_put_uint32_le(&writer, 0);
+    }
+
+    for (unsigned i = 0; i < *entries_count; i++) {
+        const size_t offset = writer.size;
+
+        if (i == BMP_ENTRIES_COUNT) {
+            sail_test_put_bytes(&writer, png, png_size);
+        } else {
+            put_bmp(&writer, &bmp_entries[i]);
+        }
+
+        put_uint32_at(&writer, dir_offset + i * 16 + 8,  (uint32_t)(writer.size - offset));
+        put_uint32_at(&writer, dir_offset + i * 16 + 12, (uint32_t)offset);
+    }
+
+    *ico_size = writer.size;
+    return writer.data;
+}
+
+/* Loads all the frames. Zero tuning values are not set. */
+static sail_status_t load_frames(const void *buffer, size_t buffer_size, unsigned size, unsigned bit_depth,
+                                    struct sail_image **images, unsigned max_images, unsigned *images_count) {
+
+    const struct sail_codec_info *codec_info;
+    SAIL_TRY(sail_codec_info_from_extension("ico", &codec_info));
+
+    struct sail_load_options *load_options;
+    SAIL_TRY(sail_alloc_load_options_from_features(codec_info->load_features, &load_options));
+
+    if (size != 0) {
+        SAIL_TRY_OR_CLEANUP(sail_test_put_tuning_unsigned_int(&load_options->tuning, "ico-width", size),
+                            /* cleanup */ sail_destroy_load_options(load_options));
+    }
+
+    if (bit_depth != 0) {
+        SAIL_TRY_OR_CLEANUP(sail_test_put_tuning_unsigned_int(&load_options->tuning, "ico-bit-depth", bit_depth),
+                            /* cleanup */ sail_destroy_load_options(load_options));
+    }
+
+    SAIL_TRY_OR_CLEANUP(sail_test_load_frames(buffer, buffer_size, codec_info, load_options, images, max_images, images_count),
+                        /* cleanup */ sail_destroy_load_options(load_options));
+    sail_destroy_load_options(load_options);
+
+    return SAIL_OK;
+}
+
+/* Returns the index of the entry the image was decoded from. */
+static unsigned identify(const struct sail_image *image) {
+
+    if (image->width == PNG_SIZE) {
+        return BMP_ENTRIES_COUNT;
+    }
+
+    const uint8_t value = *(const uint8_t *)image->pixels;
+
+    for (unsigned i = 0; i < BMP_ENTRIES_COUNT; i++) {
+        if (bmp_entries[i].size == image->width && bmp_entries[i].value == value) {
+            return i;
+        }
+    }
+
+    munit_error("Unknown image");
+    return 0;
+}
+
+static MunitResult test_all_frames(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    const struct sail_codec_info *codec_info;
+
+    if (sail_codec_info_from_extension("ico", &codec_info) != SAIL_OK) {
+        return MUNIT_SKIP;
+    }
+
+    void *png = NULL;
+    size_t png_size = 0;
+
+    if (build_png(&png, &png_size) != SAIL_OK) {
+        return MUNIT_SKIP;
+    }
+
+    unsigned entries_count;
+    size_t ico_size;
+    uint8_t *ico = build_ico(png, png_size, &entries_count, &ico_size);
+
+    struct sail_image *images[8];
+    unsigned images_count;
+    munit_assert(load_frames(ico, ico_size, 0, 0, images, 8, &images_count) == SAIL_OK);
+    munit_assert_uint(images_count, ==, entries_count);
+
+    for (unsigned i = 0; i < BMP_ENTRIES_COUNT; i++) {
+        munit_assert_uint(identify(images[i]), ==, i);
+        munit_assert_uint(images[i]->height, ==, bmp_entries[i].size);
+    }
+
+    /* The embedded PNG is decoded in place. */
+    const struct sail_image *image = images[BMP_ENTRIES_COUNT];
+
+    munit_assert_uint(image->width, ==, PNG_SIZE);
+    munit_assert_uint(image->height, ==, PNG_SIZE);
+    munit_assert(image->pixel_format == SAIL_PIXEL_FORMAT_BPP32_RGBA);
+
+    for (unsigned y = 0; y < PNG_SIZE; y++) {
+        const uint8_t *scan = sail_scan_line(image, y);
+
+        for (unsigned x = 0; x < PNG_SIZE; x++) {
+            munit_assert_uint8(scan[x * 4 + 0], ==, (uint8_t)x);
+            munit_assert_uint8(scan[x * 4 + 1], ==, (uint8_t)y);
+            munit_assert_uint8(scan[x * 4 + 2], ==, (uint8_t)(x ^ y));
+            munit_assert_uint8(scan[x * 4 + 3], ==, (uint8_t)(255 - x));
+        }
+    }
+
+    for (unsigned i = 0; i < images_count; i++) {
+        sail_destroy_image(images[i]);
+    }
+
+    /* Truncated PNG data must be reported. */
+    munit_assert(load_frames(ico, ico_size - png_size / 2, 0, 0, images, 8, &images_count) != SAIL_OK);
+    munit_assert_uint(images_count, ==, 0);
+
+    free(ico);
+    sail_free(png);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_best_fit(const MunitParameter params[], void *user_data) {
+    (void)user_data;
+
+    const unsigned size      = (unsigned)atoi(munit_parameters_get(params, "size"));
+    const unsigned bit_depth = (unsigned)atoi(munit_parameters_get(params, "bit-depth"));
+
+    const struct sail_codec_info *codec_info;
+
+    if (sail_codec_info_from_extension("ico", &codec_info) != SAIL_OK) {
+        return MUNIT_SKIP;
+    }
+
+    void *png = NULL;
+    size_t png_size = 0;
+
+    if (build_png(&png, &png_size) != SAIL_OK) {
+        return MUNIT_SKIP;
+    }
+
+    unsigned entries_count;
+    size_t ico_size;
+    uint8_t *ico = build_ico(png, png_size, &entries_count, &ico_size);
+
+    /* Expected entry per the requested size and bit depth. All the entries are loaded with no tuning. */
+    unsigned expected;
+
+    if (size == 0 && bit_depth == 0) {
+        expected = 0;
+    } else if (size == 0 || size > 32) {
+        expected = BMP_ENTRIES_COUNT;
+    } else if (size <= 16) {
+        expected = 0;
+    } else {
+        expected = (bit_depth > 0 && bit_depth <= 8) ? 2 : 1;
+    }
+
+    struct sail_image *images[8];
+    unsigned images_count;
+    munit_assert(load_frames(ico, ico_size, size, bit_depth, images, 8, &images_count) == SAIL_OK);
+
+    /* Only the selected entry is decoded. */
+    munit_assert_uint(images_count, ==, (size == 0 && bit_depth == 0) ? entries_count : 1);
+    munit_assert_uint(identify(images[0]), ==, expected);
+
+    for (unsigned i = 0; i < images_count; i++) {
+        sail_destroy_image(images[i]);
+    }
+
+    free(ico);
+    sail_free(png);
+
+    return MUNIT_OK;
+}
+
+static char *size_params[] = { (char *)"0", (char *)"16", (char *)"24", (char *)"32", (char *)"48", (char *)"512", NULL };
+
+static char *bit_depth_params[] = { (char *)"0", (char *)"4", (char *)"8", (char *)"24", NULL };
+
+static MunitParameterEnum test_params[] = {
+    { (char *)"size",      size_params },
+    { (char *)"bit-depth", bit_depth_params },
+    { NULL, NULL },
+};
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/all-frames", test_all_frames, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/best-fit",   test_best_fit,   NULL, NULL, MUNIT_TEST_OPTION_NONE, test_params },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/ico-best-fit",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
@@ -0,0 +1,308 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sail/sail.h>
+
+#ifdef SAIL_HAVE_IO_URING
+    #include <dirent.h>
+    #include <unistd.h>
+    #include <linux/io_uring.h>
+    #include <sys/syscall.h>
+#endif
+
+#include "munit.h"
+
+/* Spans a few read-ahead windows and doesn't end on a window boundary. */
+#define DATA_SIZE (((size_t)5 << 19) + 123)
+
+#define DATA_PATH "io-file-prefetched.data"
+
+static unsigned char *data;
+
+static void *setup(const MunitParameter params[], void *user_data) {
+
+    (void)user_data;
+
+#ifdef SAIL_HAVE_IO_URING
+    const char *backend = munit_parameters_get(params, "backend");
+
+    if (backend != NULL && strcmp(backend, "fadvise") == 0) {
+        setenv("SAIL_DISABLE_IO_URING", "1", 1);
+    } else {
+        unsetenv("SAIL_DISABLE_IO_URING");
+    }
+#else
+    (void)params;
+#endif
+
+    data = munit_malloc(DATA_SIZE);
+
+    for (size_t i = 0; i < DATA_SIZE; i++) {
+        data[i] = (unsigned char)(i % 251);
+    }
+
+    FILE *fptr = fopen(DATA_PATH, "wb");
+    munit_assert_not_null(fptr);
+    munit_assert_size(fwrite(data, 1, DATA_SIZE, fptr), ==, DATA_SIZE);
+    munit_assert_int(fclose(fptr), ==, 0);
+
+    return NULL;
+}
+
+static void tear_down(void *fixture) {
+
+    (void)fixture;
+
+    remove(DATA_PATH);
+    free(data);
+}
+
+static MunitResult test_read(const MunitParameter params[], void *user_data) {
+
+    (void)params;
+    (void)user_data;
+
+    struct sail_io *io;
+    munit_assert(sail_alloc_io_read_file_prefetched(DATA_PATH, &io) == SAIL_OK);
+    munit_assert(io->features & SAIL_IO_FEATURE_SEEKABLE);
+
+    unsigned char *buf = munit_malloc(DATA_SIZE);
+    size_t offset = 0;
+
+    /* Small reads crossing window boundaries and a large direct read. */
+    const size_t chunks[] = { 7, 1000, 65536, (size_t)1 << 20, 333 };
+
+    for (size_t i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++) {
+        munit_assert(io->strict_read(io->stream, buf + offset, chunks[i]) == SAIL_OK);
+        offset += chunks[i];
+    }
+
+    size_t read_size;
+    munit_assert(io->tolerant_read(io->stream, buf + offset, DATA_SIZE, &read_size) == SAIL_OK);
+    munit_assert_size(offset + read_size, ==, DATA_SIZE);
+    munit_assert_memory_equal(DATA_SIZE, buf, data);
+
+    bool eof;
+    munit_assert(io->eof(io->stream, &eof) == SAIL_OK);
+    munit_assert_true(eof);
+
+    munit_assert(io->strict_read(io->stream, buf, 1) == SAIL_ERROR_READ_IO);
+
+    free(buf);
+    sail_destroy_io(io);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_seek(const MunitParameter params[], void *user_data) {
+
+    (void)params;
+    (void)user_data;
+
+    struct sail_io *io;
+    munit_assert(sail_alloc_io_read_file_prefetched(DATA_PATH, &io) == SAIL_OK);
+
+    unsigned char buf[100];
+    size_t offset;
+
+    munit_assert(io->seek(io->stream, -50, SEEK_END) == SAIL_OK);
+    munit_assert(io->tell(io->stream, &offset) == SAIL_OK);
+    munit_assert_size(offset, ==, DATA_SIZE - 50);
+
+    size_t read_size;
+    munit_assert(io->tolerant_read(io->stream, buf, sizeof(buf), &read_size) == SAIL_OK);
+    munit_assert_size(read_size, ==, 50);
+    munit_assert_memory_equal(50, buf, data + DATA_SIZE - 50);
+
+    /* Back to the beginning, out of the current window. */
+    munit_assert(io->seek(io->stream, 10, SEEK_SET) == SAIL_OK);
+    munit_assert(io->strict_read(io->stream, buf, sizeof(buf)) == SAIL_OK);
+    munit_assert_memory_equal(sizeof(buf), buf, data + 10);
+
+    munit_assert(io->seek(io->stream, -20, SEEK_CUR) == SAIL_OK);
+    munit_assert(io->strict_read(io->stream, buf, 20) == SAIL_OK);
+    munit_assert_memory_equal(20, buf, data + 90);
+
+    munit_assert(io->seek(io->stream, -1, SEEK_SET) == SAIL_ERROR_SEEK_IO);
+    munit_assert(io->seek(io->stream, 0, 100) == SAIL_ERROR_UNSUPPORTED_SEEK_WHENCE);
+
+    sail_destroy_io(io);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_prefetch(const MunitParameter params[], void *user_data) {
+
+    (void)params;
+    (void)user_data;
+
+    munit_assert(sail_prefetch_file(DATA_PATH) == SAIL_OK);
+
+    struct sail_io *io;
+    munit_assert(sail_alloc_io_read_file_prefetched(DATA_PATH, &io) == SAIL_OK);
+
+    void *contents;
+    size_t contents_size;
+    munit_assert(sail_alloc_data_from_io_contents(io, &contents, &contents_size) == SAIL_OK);
+    munit_assert_size(contents_size, ==, DATA_SIZE);
+    munit_assert_memory_equal(DATA_SIZE, contents, data);
+
+    sail_free(contents);
+    sail_destroy_io(io);
+
+    return MUNIT_OK;
+}
+
+/* Jumps around the file, so windows in flight get abandoned and reused. */
+static MunitResult test_random_reads(const MunitParameter params[], void *user_data) {
+
+    (void)params;
+    (void)user_data;
+
+    struct sail_io *io;
+    munit_assert(sail_alloc_io_read_file_prefetched(DATA_PATH, &io) == SAIL_OK);
+
+    unsigned char *buf = munit_malloc(DATA_SIZE);
+
+    for (int i = 0; i < 200; i++) {
+        const size_t offset = (size_t)munit_rand_int_range(0, (int)DATA_SIZE - 1);
+        const size_t size = (size_t)munit_rand_int_range(1, i % 10 == 0 ? (int)DATA_SIZE : 5000);
+
+        munit_assert(io->seek(io->stream, (long)offset, SEEK_SET) == SAIL_OK);
+
+        size_t read_size;
+        munit_assert(io->tolerant_read(io->stream, buf, size, &read_size) == SAIL_OK);
+        munit_assert_size(read_size, ==, size < DATA_SIZE - offset ? size : DATA_SIZE - offset);
+        munit_assert_memory_equal(read_size, buf, data + offset);
+    }
+
+    free(buf);
+    sail_destroy_io(io);
+
+    return MUNIT_OK;
+}
+
+#ifdef SAIL_HAVE_IO_URING
+static bool has_io_uring_fd(void) {
+
+    DIR *dir = opendir("/proc/self/fd");
+    munit_assert_not_null(dir);
+
+    bool found = false;
+    struct dirent *entry;
+
+    while (!found && (entry = readdir(dir)) != NULL) {
+        char path[288];
+        char target[64];
+        snprintf(path, sizeof(path), "/proc/self/fd/%s", entry->d_name);
+
+        const ssize_t length = readlink(path, target, sizeof(target) - 1);
+
+        if (length > 0) {
+            target[length] = '\0';
+            found = strstr(target, "io_uring") != NULL;
+        }
+    }
+
+    closedir(dir);
+
+    return found;
+}
+
+static MunitResult test_io_uring(const MunitParameter params[], void *user_data) {
+
+    (void)user_data;
+
+    struct io_uring_params uring_params;
+    memset(&uring_params, 0, sizeof(uring_params));
+    const int fd = (int)syscall(__NR_io_uring_setup, 1, &uring_params);
+
+    if (fd < 0) {
+        return MUNIT_SKIP;
+    }
+
+    close(fd);
+
+    struct sail_io *io;
+    munit_assert(sail_alloc_io_read_file_prefetched(DATA_PATH, &io) == SAIL_OK);
+    munit_assert(has_io_uring_fd() == (strcmp(munit_parameters_get(params, "backend"), "io_uring") == 0));
+    sail_destroy_io(io);
+
+    munit_assert_false(has_io_uring_fd());
+
+    return MUNIT_OK;
+}
+#endif
+
+static MunitResult test_missing_file(const MunitParameter params[], void *user_data) {
+
+    (void)params;
+    (void)user_data;
+
+    struct sail_io *io;
+    munit_assert(sail_alloc_io_read_file_prefetched("io-file-prefetched.missing", &io) == SAIL_ERROR_OPEN_FILE);
+
+    return MUNIT_OK;
+}
+
+static char *backends[] = {
+    (char *)"io_uring",
+    (char *)"fadvise",
+    NULL
+};
+
+static MunitParameterEnum test_params[] = {
+    { (char *)"backend", backends },
+    { NULL, NULL },
+};
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/read",         test_read,         setup, tear_down, MUNIT_TEST_OPTION_NONE, test_params },
+    { (char *)"/seek",         test_seek,         setup, tear_down, MUNIT_TEST_OPTION_NONE, test_params },
+    { (char *)"/prefetch",     test_prefetch,     setup, tear_down, MUNIT_TEST_OPTION_NONE, test_params },
+    { (char *)"/random-reads", test_random_reads, setup, tear_down, MUNIT_TEST_OPTION_NONE, test_params },
+#ifdef SAIL_HAVE_IO_URING
+    { (char *)"/io-uring",     test_io_uring,     setup, tear_down, MUNIT_TEST_OPTION_NONE, test_params },
+#endif
+    { (char *)"/missing-file", test_missing_file, NULL,  NULL,      MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/io-file-prefetched",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
@@ -0,0 +1,170 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <sail/sail.h>
+
+#include "munit.h"
+
+static MunitResult test_write_memory_size(const MunitParameter params[], void *user_data) {
+
+    (void)params;
+    (void)user_data;
+
+    char buffer[64];
+    struct sail_io *io;
+    munit_assert(sail_alloc_io_write_memory(buffer, sizeof(buffer), &io) == SAIL_OK);
+
+    munit_assert(io->strict_write(io->stream, "abcdef", 6) == SAIL_OK);
+
+    size_t size;
+    munit_assert(io->seek(io->stream, 0, SEEK_SET) == SAIL_OK);
+    munit_assert(sail_io_size(io, &size) == SAIL_OK);
+    munit_assert_size(size, ==, 6);
+
+    /* Writing past the buffer fails. */
+    const char data[sizeof(buffer)] = { 0 };
+    munit_assert(io->seek(io->stream, 0, SEEK_END) == SAIL_OK);
+    munit_assert(io->strict_write(io->stream, data, sizeof(data)) != SAIL_OK);
+
+    sail_destroy_io(io);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_growable_memory(const MunitParameter params[], void *user_data) {
+
+    (void)params;
+    (void)user_data;
+
+    struct sail_io *io;
+    munit_assert(sail_alloc_io_write_growable_memory(&io) == SAIL_OK);
+
+    /* Force several reallocations. */
+    const size_t size = 100 * 1024 + 7;
+    char *data = munit_malloc(size);
+
+    for (size_t i = 0; i < size; i++) {
+        data[i] = (char)(i % 251);
+    }
+
+    for (size_t offset = 0; offset < size; offset += 1000) {
+        const size_t chunk = (size - offset < 1000) ? size - offset : 1000;
+        munit_assert(io->strict_write(io->stream, data + offset, chunk) == SAIL_OK);
+    }
+
+    /* Overwrite the beginning and read it back. */
+    munit_assert(io->seek(io->stream, 0, SEEK_SET) == SAIL_OK);
+    munit_assert(io->strict_write(io->stream, "xyz", 3) == SAIL_OK);
+    memcpy(data, "xyz", 3);
+
+    char read_back[3];
+    munit_assert(io->seek(io->stream, 0, SEEK_SET) == SAIL_OK);
+    munit_assert(io->strict_read(io->stream, read_back, sizeof(read_back)) == SAIL_OK);
+    munit_assert_memory_equal(sizeof(read_back), read_back, "xyz");
+
+    void *buffer;
+    size_t buffer_size;
+    munit_assert(sail_io_take_buffer(io, &buffer, &buffer_size) == SAIL_OK);
+    munit_assert_size(buffer_size, ==, size);
+    munit_assert_memory_equal(size, buffer, data);
+
+    sail_free(buffer);
+
+    /* The I/O object is empty after handing the buffer over. */
+    munit_assert(sail_io_take_buffer(io, &buffer, &buffer_size) == SAIL_OK);
+    munit_assert_null(buffer);
+    munit_assert_size(buffer_size, ==, 0);
+
+    free(data);
+    sail_destroy_io(io);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_growable_memory_gap(const MunitParameter params[], void *user_data) {
+
+    (void)params;
+    (void)user_data;
+
+    struct sail_io *io;
+    munit_assert(sail_alloc_io_write_growable_memory(&io) == SAIL_OK);
+
+    munit_assert(io->strict_write(io->stream, "a", 1) == SAIL_OK);
+    munit_assert(io->seek(io->stream, 3, SEEK_CUR) == SAIL_OK);
+    munit_assert(io->strict_write(io->stream, "b", 1) == SAIL_OK);
+
+    void *buffer;
+    size_t buffer_size;
+    munit_assert(sail_io_take_buffer(io, &buffer, &buffer_size) == SAIL_OK);
+    munit_assert_size(buffer_size, ==, 5);
+    munit_assert_memory_equal(5, buffer, "a\0\0\0b");
+
+    sail_free(buffer);
+    sail_destroy_io(io);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_take_buffer_invalid_io(const MunitParameter params[], void *user_data) {
+
+    (void)params;
+    (void)user_data;
+
+    char buffer[16];
+    struct sail_io *io;
+    munit_assert(sail_alloc_io_read_write_memory(buffer, sizeof(buffer), &io) == SAIL_OK);
+
+    void *taken;
+    size_t taken_size;
+    munit_assert(sail_io_take_buffer(io, &taken, &taken_size) == SAIL_ERROR_INVALID_IO);
+
+    sail_destroy_io(io);
+
+    return MUNIT_OK;
+}
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/write-memory-size",      test_write_memory_size,      NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/growable-memory",        test_growable_memory,        NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/growable-memory-gap",    test_growable_memory_gap,    NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/take-buffer-invalid-io", test_take_buffer_invalid_io, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/io-memory",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
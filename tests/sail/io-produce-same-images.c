@@ -70,13 +70,62 @@ static MunitResult test_io_produce_same_images(const MunitParameter params[], vo
     return MUNIT_OK;
 }
 
+static MunitResult test_stream_produces_same_images(const MunitParameter params[], void *user_data) {
+    (void)user_data;
+
+    const char *path = munit_parameters_get(params, "path");
+
+    struct sail_image *image_file = NULL;
+    munit_assert(sail_load_from_file(path, &image_file) == SAIL_OK);
+    munit_assert_not_null(image_file);
+
+    void *data;
+    size_t data_size;
+    munit_assert(sail_alloc_data_from_file_contents(path, &data, &data_size) == SAIL_OK);
+
+    /* Emulate a pipe. */
+    struct sail_io *source;
+    munit_assert(sail_alloc_io_read_memory(data, data_size, &source) == SAIL_OK);
+    source->features = 0;
+    source->seek     = sail_io_noop_seek;
+
+    struct sail_io *io;
+    munit_assert(sail_alloc_io_read_ahead(source, 4096, &io) == SAIL_OK);
+
+    /* Sniffing the magic number seeks back within the window. Not all formats have magic numbers. */
+    const struct sail_codec_info *codec_info;
+    if (sail_codec_info_by_magic_number_from_io(io, &codec_info) != SAIL_OK) {
+        munit_assert(sail_codec_info_from_path(path, &codec_info) == SAIL_OK);
+    }
+
+    void *state;
+    munit_assert(sail_start_loading_from_io(io, codec_info, &state) == SAIL_OK);
+
+    struct sail_image *image_stream = NULL;
+    munit_assert(sail_load_next_frame(state, &image_stream) == SAIL_OK);
+    munit_assert_not_null(image_stream);
+
+    munit_assert(sail_stop_loading(state) == SAIL_OK);
+
+    munit_assert(sail_test_compare_images(image_file, image_stream) == SAIL_OK);
+
+    sail_destroy_io(io);
+    sail_destroy_io(source);
+    sail_free(data);
+    sail_destroy_image(image_stream);
+    sail_destroy_image(image_file);
+
+    return MUNIT_OK;
+}
+
 static MunitParameterEnum test_params[] = {
     { (char *)"path", (char **)SAIL_TEST_IMAGES },
     { NULL, NULL },
 };
 
 static MunitTest test_suite_tests[] = {
-    { (char *)"/io-produce-same-images", test_io_produce_same_images, NULL, NULL, MUNIT_TEST_OPTION_NONE, test_params },
+    { (char *)"/io-produce-same-images",      test_io_produce_same_images,      NULL, NULL, MUNIT_TEST_OPTION_NONE, test_params },
+    { (char *)"/stream-produces-same-images", test_stream_produces_same_images, NULL, NULL, MUNIT_TEST_OPTION_NONE, test_params },
 
     { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
 };
@@ -0,0 +1,204 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdio.h>
+
+#include <sail/sail.h>
+
+#include "munit.h"
+
+#define DATA_SIZE 10000
+
+static unsigned char data[DATA_SIZE];
+
+/* Returns at most 7 bytes per read to emulate a pipe. */
+static sail_status_t pipe_tolerant_read(void *stream, void *buf, size_t size_to_read, size_t *read_size) {
+
+    size_t *pos = stream;
+
+    if (*pos >= DATA_SIZE) {
+        *read_size = 0;
+        return SAIL_OK;
+    }
+
+    size_t size = (size_to_read < 7) ? size_to_read : 7;
+    if (*pos + size > DATA_SIZE) {
+        size = DATA_SIZE - *pos;
+    }
+
+    for (size_t i = 0; i < size; i++) {
+        ((unsigned char *)buf)[i] = data[*pos + i];
+    }
+
+    *pos += size;
+    *read_size = size;
+
+    return SAIL_OK;
+}
+
+static sail_status_t pipe_close(void *stream) {
+
+    (void)stream;
+
+    return SAIL_OK;
+}
+
+static void *setup(const MunitParameter params[], void *user_data) {
+
+    (void)params;
+    (void)user_data;
+
+    for (size_t i = 0; i < DATA_SIZE; i++) {
+        data[i] = (unsigned char)(i % 253);
+    }
+
+    static size_t pos;
+    pos = 0;
+
+    struct sail_io *source;
+    munit_assert(sail_alloc_io(&source) == SAIL_OK);
+
+    source->features       = 0;
+    source->stream         = &pos;
+    source->tolerant_read  = pipe_tolerant_read;
+    source->strict_read    = sail_io_noop_strict_read;
+    source->tolerant_write = sail_io_noop_tolerant_write;
+    source->strict_write   = sail_io_noop_strict_write;
+    source->seek           = sail_io_noop_seek;
+    source->tell           = sail_io_noop_tell;
+    source->flush          = sail_io_noop_flush;
+    source->close          = pipe_close;
+    source->eof            = sail_io_noop_eof;
+
+    return source;
+}
+
+static void tear_down(void *fixture) {
+
+    sail_destroy_io(fixture);
+}
+
+static MunitResult test_read_and_seek_back(const MunitParameter params[], void *user_data) {
+
+    (void)params;
+
+    struct sail_io *io;
+    munit_assert(sail_alloc_io_read_ahead(user_data, 64, &io) == SAIL_OK);
+
+    unsigned char buf[100];
+    munit_assert(io->strict_read(io->stream, buf, 16) == SAIL_OK);
+    munit_assert_memory_equal(16, buf, data);
+
+    /* Sniff the magic number again. */
+    munit_assert(io->seek(io->stream, 0, SEEK_SET) == SAIL_OK);
+    munit_assert(io->strict_read(io->stream, buf, sizeof(buf)) == SAIL_OK);
+    munit_assert_memory_equal(sizeof(buf), buf, data);
+
+    size_t offset;
+    munit_assert(io->tell(io->stream, &offset) == SAIL_OK);
+    munit_assert_size(offset, ==, sizeof(buf));
+
+    /* Small look-back. */
+    munit_assert(io->seek(io->stream, -10, SEEK_CUR) == SAIL_OK);
+    munit_assert(io->strict_read(io->stream, buf, 10) == SAIL_OK);
+    munit_assert_memory_equal(10, buf, data + 90);
+
+    /* The beginning is out of the window now. */
+    munit_assert(io->seek(io->stream, 0, SEEK_SET) == SAIL_ERROR_SEEK_IO);
+    munit_assert(io->seek(io->stream, 0, SEEK_END) == SAIL_ERROR_UNSUPPORTED_SEEK_WHENCE);
+
+    sail_destroy_io(io);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_seek_forward_and_eof(const MunitParameter params[], void *user_data) {
+
+    (void)params;
+
+    struct sail_io *io;
+    munit_assert(sail_alloc_io_read_ahead(user_data, 64, &io) == SAIL_OK);
+
+    munit_assert(io->seek(io->stream, DATA_SIZE - 5, SEEK_SET) == SAIL_OK);
+
+    bool eof;
+    munit_assert(io->eof(io->stream, &eof) == SAIL_OK);
+    munit_assert_false(eof);
+
+    unsigned char buf[10];
+    size_t read_size;
+    munit_assert(io->tolerant_read(io->stream, buf, sizeof(buf), &read_size) == SAIL_OK);
+    munit_assert_size(read_size, ==, 5);
+    munit_assert_memory_equal(5, buf, data + DATA_SIZE - 5);
+
+    munit_assert(io->eof(io->stream, &eof) == SAIL_OK);
+    munit_assert_true(eof);
+
+    munit_assert(io->tolerant_read(io->stream, buf, sizeof(buf), &read_size) == SAIL_ERROR_EOF);
+    munit_assert(io->seek(io->stream, DATA_SIZE + 1, SEEK_SET) == SAIL_ERROR_EOF);
+
+    sail_destroy_io(io);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_contents(const MunitParameter params[], void *user_data) {
+
+    (void)params;
+
+    struct sail_io *io;
+    munit_assert(sail_alloc_io_read_ahead(user_data, 64, &io) == SAIL_OK);
+
+    void *contents;
+    size_t contents_size;
+    munit_assert(sail_alloc_data_from_io_contents(io, &contents, &contents_size) == SAIL_OK);
+    munit_assert_size(contents_size, ==, DATA_SIZE);
+    munit_assert_memory_equal(DATA_SIZE, contents, data);
+
+    sail_free(contents);
+    sail_destroy_io(io);
+
+    return MUNIT_OK;
+}
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/read-and-seek-back",   test_read_and_seek_back,   setup, tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/seek-forward-and-eof", test_seek_forward_and_eof, setup, tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/contents",             test_contents,             setup, tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/io-read-ahead",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
@@ -0,0 +1,167 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <sail/sail.h>
+
+#include "sail-comparators.h"
+#include "sail-test-helpers.h"
+
+#include "munit.h"
+
+/* Large enough to be decoded in parallel. */
+#define WIDTH  1203
+#define HEIGHT 1001
+
+static sail_status_t generate_image(enum SailPixelFormat pixel_format, struct sail_image **image) {
+
+    struct sail_image *image_local;
+    SAIL_TRY(sail_test_alloc_image(WIDTH, HEIGHT, pixel_format, &image_local));
+
+    /* Sharp edges make upsampled chroma rows depend on their neighbors. */
+    unsigned char *pixels = image_local->pixels;
+
+    for (size_t i = 0; i < sail_bytes_per_image(image_local); i++) {
+        const size_t x = i % image_local->bytes_per_line;
+        const size_t y = i / image_local->bytes_per_line;
+
+        pixels[i] = (unsigned char)(((x / 5) ^ (y / 3)) * 37 + x);
+    }
+
+    *image = image_local;
+
+    return SAIL_OK;
+}
+
+static sail_status_t save_image(const struct sail_image *image, const struct sail_codec_info *codec_info, const char *subsampling,
+                                void **buffer, size_t *buffer_size) {
+
+    struct sail_save_options *save_options;
+    SAIL_TRY(sail_alloc_save_options_from_features(codec_info->save_features, &save_options));
+
+    SAIL_TRY_OR_CLEANUP(sail_test_put_tuning_unsigned_int(&save_options->tuning, "jpeg-restart-interval", 1),
+                        /* cleanup */ sail_destroy_save_options(save_options));
+    SAIL_TRY_OR_CLEANUP(sail_test_put_tuning_string(&save_options->tuning, "jpeg-chroma-subsampling", subsampling),
+                        /* cleanup */ sail_destroy_save_options(save_options));
+
+    SAIL_TRY_OR_CLEANUP(sail_test_save_image(image, codec_info, save_options, buffer, buffer_size),
+                        /* cleanup */ sail_destroy_save_options(save_options));
+    sail_destroy_save_options(save_options);
+
+    return SAIL_OK;
+}
+
+static sail_status_t load_image(const void *buffer, size_t buffer_size, const struct sail_codec_info *codec_info,
+                                unsigned threads, struct sail_image **image) {
+
+    struct sail_load_options *load_options;
+    SAIL_TRY(sail_alloc_load_options_from_features(codec_info->load_features, &load_options));
+
+    SAIL_TRY_OR_CLEANUP(sail_test_put_tuning_unsigned_int(&load_options->tuning, "jpeg-threads", threads),
+                        /* cleanup */ sail_destroy_load_options(load_options));
+
+    SAIL_TRY_OR_CLEANUP(sail_test_load_image(buffer, buffer_size, codec_info, load_options, image),
+                        /* cleanup */ sail_destroy_load_options(load_options));
+    sail_destroy_load_options(load_options);
+
+    return SAIL_OK;
+}
+
+static bool has_restart_markers(const unsigned char *data, size_t data_size) {
+
+    for (size_t i = 0; i + 1 < data_size; i++) {
+        if (data[i] == 0xFF && data[i + 1] == 0xD0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static MunitResult test_parallel_equals_serial(const MunitParameter params[], void *user_data) {
+    (void)user_data;
+
+    const char *subsampling = munit_parameters_get(params, "subsampling");
+
+    const struct sail_codec_info *codec_info;
+
+    if (sail_codec_info_from_extension("jpg", &codec_info) != SAIL_OK) {
+        return MUNIT_SKIP;
+    }
+
+    const enum SailPixelFormat pixel_format = (strcmp(subsampling, "gray") == 0)
+                                                ? SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE
+                                                : SAIL_PIXEL_FORMAT_BPP24_YCBCR;
+
+    struct sail_image *image = NULL;
+    munit_assert(generate_image(pixel_format, &image) == SAIL_OK);
+
+    void *buffer = NULL;
+    size_t buffer_size;
+    munit_assert(save_image(image, codec_info, subsampling, &buffer, &buffer_size) == SAIL_OK);
+    munit_assert_true(has_restart_markers(buffer, buffer_size));
+
+    struct sail_image *serial_image = NULL;
+    munit_assert(load_image(buffer, buffer_size, codec_info, 1, &serial_image) == SAIL_OK);
+
+    struct sail_image *parallel_image = NULL;
+    munit_assert(load_image(buffer, buffer_size, codec_info, 4, &parallel_image) == SAIL_OK);
+
+    munit_assert(sail_test_compare_images(serial_image, parallel_image) == SAIL_OK);
+
+    sail_destroy_image(parallel_image);
+    sail_destroy_image(serial_image);
+    sail_free(buffer);
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static char *subsampling_params[] = { (char *)"444", (char *)"422", (char *)"420", (char *)"gray", NULL };
+
+static MunitParameterEnum test_params[] = {
+    { (char *)"subsampling", subsampling_params },
+    { NULL, NULL },
+};
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/parallel-equals-serial", test_parallel_equals_serial, NULL, NULL, MUNIT_TEST_OPTION_NONE, test_params },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/jpeg-restart-intervals",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
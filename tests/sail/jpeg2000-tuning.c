@@ -0,0 +1,144 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdio.h>
+
+#include <sail/sail.h>
+
+#include "sail-comparators.h"
+#include "sail-test-helpers.h"
+
+#include "munit.h"
+
+#include "test-images.h"
+
+#define PATH SAIL_TEST_IMAGES_PATH "/jpeg2000/bpp24-rgb.jp2"
+
+static sail_status_t load_image(const void *buffer, size_t buffer_size, const struct sail_codec_info *codec_info,
+                                unsigned max_layers, unsigned threads, struct sail_image **image) {
+
+    struct sail_load_options *load_options;
+    SAIL_TRY(sail_alloc_load_options_from_features(codec_info->load_features, &load_options));
+
+    SAIL_TRY_OR_CLEANUP(sail_test_put_tuning_unsigned_int(&load_options->tuning, "jpeg2000-max-layers", max_layers),
+                        /* cleanup */ sail_destroy_load_options(load_options));
+    SAIL_TRY_OR_CLEANUP(sail_test_put_tuning_unsigned_int(&load_options->tuning, "jpeg2000-threads", threads),
+                        /* cleanup */ sail_destroy_load_options(load_options));
+
+    SAIL_TRY_OR_CLEANUP(sail_test_load_image(buffer, buffer_size, codec_info, load_options, image),
+                        /* cleanup */ sail_destroy_load_options(load_options));
+    sail_destroy_load_options(load_options);
+
+    return SAIL_OK;
+}
+
+static MunitResult test_threads(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    const struct sail_codec_info *codec_info;
+
+    if (sail_codec_info_from_extension("jp2", &codec_info) != SAIL_OK) {
+        return MUNIT_SKIP;
+    }
+
+    void *buffer;
+    size_t buffer_size;
+    munit_assert(sail_alloc_data_from_file_contents(PATH, &buffer, &buffer_size) == SAIL_OK);
+
+    struct sail_image *image = NULL;
+    munit_assert(sail_test_load_image(buffer, buffer_size, codec_info, NULL, &image) == SAIL_OK);
+
+    /* Deinterleaving in parallel produces the same pixels. */
+    static const unsigned threads[] = { 1, 4 };
+
+    for (size_t i = 0; i < sizeof(threads) / sizeof(threads[0]); i++) {
+        struct sail_image *tuned_image = NULL;
+        munit_assert(load_image(buffer, buffer_size, codec_info, 0, threads[i], &tuned_image) == SAIL_OK);
+        munit_assert(sail_test_compare_images(image, tuned_image) == SAIL_OK);
+        sail_destroy_image(tuned_image);
+    }
+
+    sail_destroy_image(image);
+    sail_free(buffer);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_max_layers(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    const struct sail_codec_info *codec_info;
+
+    if (sail_codec_info_from_extension("jp2", &codec_info) != SAIL_OK) {
+        return MUNIT_SKIP;
+    }
+
+    void *buffer;
+    size_t buffer_size;
+    munit_assert(sail_alloc_data_from_file_contents(PATH, &buffer, &buffer_size) == SAIL_OK);
+
+    struct sail_image *image = NULL;
+    munit_assert(sail_test_load_image(buffer, buffer_size, codec_info, NULL, &image) == SAIL_OK);
+
+    /* A preview from the first layer keeps the geometry and the pixel format. */
+    struct sail_image *preview_image = NULL;
+    munit_assert(load_image(buffer, buffer_size, codec_info, 1, 2, &preview_image) == SAIL_OK);
+    munit_assert_uint(preview_image->width, ==, image->width);
+    munit_assert_uint(preview_image->height, ==, image->height);
+    munit_assert(preview_image->pixel_format == image->pixel_format);
+    sail_destroy_image(preview_image);
+
+    /* More layers than the file has decodes all of them. */
+    struct sail_image *full_image = NULL;
+    munit_assert(load_image(buffer, buffer_size, codec_info, 1000, 2, &full_image) == SAIL_OK);
+    munit_assert(sail_test_compare_images(image, full_image) == SAIL_OK);
+    sail_destroy_image(full_image);
+
+    sail_destroy_image(image);
+    sail_free(buffer);
+
+    return MUNIT_OK;
+}
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/threads",    test_threads,    NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/max-layers", test_max_layers, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/jpeg2000-tuning",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
@@ -0,0 +1,116 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdio.h>
+
+#include <sail/sail.h>
+
+#include "sail-comparators.h"
+
+#include "munit.h"
+
+#include "test-images.h"
+
+static sail_status_t load_first_frame(const char *path, const struct sail_region *region, struct sail_image **image) {
+
+    const struct sail_codec_info *codec_info;
+    SAIL_TRY(sail_codec_info_from_path(path, &codec_info));
+
+    struct sail_load_options *load_options;
+    SAIL_TRY(sail_alloc_load_options_from_features(codec_info->load_features, &load_options));
+
+    if (region != NULL) {
+        load_options->region = *region;
+    }
+
+    void *state;
+    SAIL_TRY_OR_CLEANUP(sail_start_loading_from_file_with_options(path, codec_info, load_options, &state),
+                        /* cleanup */ sail_destroy_load_options(load_options));
+    sail_destroy_load_options(load_options);
+
+    SAIL_TRY_OR_CLEANUP(sail_load_next_frame(state, image),
+                        /* cleanup */ sail_stop_loading(state));
+    SAIL_TRY(sail_stop_loading(state));
+
+    return SAIL_OK;
+}
+
+static MunitResult test_load_region(const MunitParameter params[], void *user_data) {
+    (void)user_data;
+
+    const char *path = munit_parameters_get(params, "path");
+
+    struct sail_image *image = NULL;
+    munit_assert(load_first_frame(path, NULL, &image) == SAIL_OK);
+    munit_assert_not_null(image);
+
+    /* Planar pixels cannot be cropped. */
+    if (sail_is_planar(image->pixel_format)) {
+        sail_destroy_image(image);
+        return MUNIT_SKIP;
+    }
+
+    const struct sail_region region = {
+        image->width / 4,
+        image->height / 3,
+        image->width / 2 + 1,
+        image->height / 2 + 1,
+    };
+
+    struct sail_image *image_region = NULL;
+    munit_assert(load_first_frame(path, &region, &image_region) == SAIL_OK);
+    munit_assert_not_null(image_region);
+
+    munit_assert(sail_crop_image(image, region.x, region.y, region.width, region.height) == SAIL_OK);
+    munit_assert(sail_test_compare_images(image, image_region) == SAIL_OK);
+
+    sail_destroy_image(image_region);
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitParameterEnum test_params[] = {
+    { (char *)"path", (char **)SAIL_TEST_IMAGES },
+    { NULL, NULL },
+};
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/load-region", test_load_region, NULL, NULL, MUNIT_TEST_OPTION_NONE, test_params },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/load-region",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
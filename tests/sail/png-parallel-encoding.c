@@ -0,0 +1,170 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sail/sail.h>
+
+#include "sail-comparators.h"
+#include "sail-test-helpers.h"
+
+#include "munit.h"
+
+/* Large enough to be split into many row blocks. */
+#define WIDTH  1000
+#define HEIGHT 600
+
+static sail_status_t generate_image(enum SailPixelFormat pixel_format, struct sail_image **image) {
+
+    struct sail_image *image_local;
+    SAIL_TRY(sail_test_alloc_image(WIDTH, HEIGHT, pixel_format, &image_local));
+
+    /* Mix of gradients and noise to make different filters win on different rows. */
+    unsigned char *pixels = image_local->pixels;
+
+    for (size_t i = 0; i < sail_bytes_per_image(image_local); i++) {
+        const size_t x = i % image_local->bytes_per_line;
+        const size_t y = i / image_local->bytes_per_line;
+
+        pixels[i] = (y % 7 == 0) ? (unsigned char)rand() : (unsigned char)(x * 3 + y * (x / 100));
+    }
+
+    *image = image_local;
+
+    return SAIL_OK;
+}
+
+static sail_status_t save_image(const struct sail_image *image, const struct sail_codec_info *codec_info,
+                                unsigned threads, double compression_level, bool interlaced,
+                                void **buffer, size_t *buffer_size) {
+
+    struct sail_save_options *save_options;
+    SAIL_TRY(sail_alloc_save_options_from_features(codec_info->save_features, &save_options));
+
+    save_options->compression_level = compression_level;
+
+    if (!interlaced) {
+        save_options->options &= ~SAIL_OPTION_INTERLACED;
+    }
+
+    SAIL_TRY_OR_CLEANUP(sail_test_put_tuning_unsigned_int(&save_options->tuning, "png-threads", threads),
+                        /* cleanup */ sail_destroy_save_options(save_options));
+
+    SAIL_TRY_OR_CLEANUP(sail_test_save_image(image, codec_info, save_options, buffer, buffer_size),
+                        /* cleanup */ sail_destroy_save_options(save_options));
+    sail_destroy_save_options(save_options);
+
+    return SAIL_OK;
+}
+
+static MunitResult test_parallel_equals_serial(const MunitParameter params[], void *user_data) {
+    (void)user_data;
+
+    const enum SailPixelFormat pixel_format = sail_pixel_format_from_string(munit_parameters_get(params, "pixel-format"));
+    const double compression_level = atof(munit_parameters_get(params, "compression-level"));
+    const bool interlaced = strcmp(munit_parameters_get(params, "interlaced"), "yes") == 0;
+
+    const struct sail_codec_info *codec_info;
+
+    if (sail_codec_info_from_extension("png", &codec_info) != SAIL_OK) {
+        return MUNIT_SKIP;
+    }
+
+    srand(1);
+
+    struct sail_image *image = NULL;
+    munit_assert(generate_image(pixel_format, &image) == SAIL_OK);
+
+    void *serial_buffer = NULL;
+    size_t serial_buffer_size;
+    munit_assert(save_image(image, codec_info, 1, compression_level, interlaced, &serial_buffer, &serial_buffer_size) == SAIL_OK);
+
+    void *parallel_buffer = NULL;
+    size_t parallel_buffer_size;
+    munit_assert(save_image(image, codec_info, 4, compression_level, interlaced, &parallel_buffer, &parallel_buffer_size) == SAIL_OK);
+
+    struct sail_image *serial_image = NULL;
+    munit_assert(sail_test_load_image(serial_buffer, serial_buffer_size, NULL, NULL, &serial_image) == SAIL_OK);
+
+    struct sail_image *parallel_image = NULL;
+    munit_assert(sail_test_load_image(parallel_buffer, parallel_buffer_size, NULL, NULL, &parallel_image) == SAIL_OK);
+
+    munit_assert(sail_test_compare_images(serial_image, parallel_image) == SAIL_OK);
+
+    /* Swapped channels are loaded in the PNG order. */
+    if (parallel_image->pixel_format == image->pixel_format) {
+        munit_assert_memory_equal(sail_bytes_per_image(image), image->pixels, parallel_image->pixels);
+    }
+
+    sail_destroy_image(parallel_image);
+    sail_destroy_image(serial_image);
+    sail_free(parallel_buffer);
+    sail_free(serial_buffer);
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static char *pixel_format_params[] = {
+    (char *)"BPP4-GRAYSCALE",
+    (char *)"BPP8-GRAYSCALE",
+    (char *)"BPP24-RGB",
+    (char *)"BPP48-BGR",
+    (char *)"BPP32-ABGR",
+    (char *)"BPP64-ARGB",
+    NULL
+};
+
+static char *compression_level_params[] = { (char *)"1", (char *)"6", (char *)"9", NULL };
+
+static char *interlaced_params[] = { (char *)"yes", (char *)"no", NULL };
+
+static MunitParameterEnum test_params[] = {
+    { (char *)"pixel-format",      pixel_format_params },
+    { (char *)"compression-level", compression_level_params },
+    { (char *)"interlaced",        interlaced_params },
+    { NULL, NULL },
+};
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/parallel-equals-serial", test_parallel_equals_serial, NULL, NULL, MUNIT_TEST_OPTION_NONE, test_params },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/png-parallel-encoding",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
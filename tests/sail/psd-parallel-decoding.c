@@ -0,0 +1,248 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sail/sail.h>
+
+#include "sail-test-helpers.h"
+
+#include "munit.h"
+
+/* Spans several strips with a partial last one. */
+#define WIDTH  157
+#define HEIGHT 150
+
+/* PackBits with runs of 3+ equal bytes and literals in between. Returns the packed size. */
+static size_t pack_bits(const uint8_t *src, size_t size, uint8_t *dst) {
+
+    size_t written = 0;
+
+    for (size_t i = 0; i < size;) {
+        size_t run = 1;
+
+        while (i + run < size && run < 128 && src[i + run] == src[i]) {
+            run++;
+        }
+
+        if (run >= 3) {
+            dst[written++] = (uint8_t)(257 - run);
+            dst[written++] = src[i];
+            i += run;
+        } else {
+            size_t literal = 0;
+
+            while (i + literal < size && literal < 128 &&
+                    !(i + literal + 2 < size && src[i + literal] == src[i + literal + 1] && src[i + literal] == src[i + literal + 2])) {
+                literal++;
+            }
+
+            dst[written++] = (uint8_t)(literal - 1);
+            memcpy(dst + written, src + i, literal);
+            written += literal;
+            i += literal;
+        }
+    }
+
+    return written;
+}
+
+/* Sample of the channel at the pixel. Mixes runs and noise to produce both kinds of RLE packets. */
+static unsigned sample(unsigned channel, unsigned x, unsigned y, unsigned depth) {
+
+    const unsigned value = (y % 4 == 0) ? 1000 * (channel + 1) : (x * 37 + y * 11 + channel * 101) * (x % 3 + 1);
+
+    return (depth == 8) ? (value & 0xff) : (value & 0xffff);
+}
+
+static uint8_t *build_psd(unsigned mode, unsigned channels, unsigned depth, bool rle, size_t *psd_size) {
+
+    const size_t row_size = (size_t)WIDTH * depth / 8;
+    struct sail_test_writer writer = { malloc(64 + (size_t)channels * HEIGHT * (2 + row_size * 2)), 0 };
+    munit_assert_not_null(writer.data);
+
+    sail_test_put_bytes(&writer, "8BPS", 4);
+    sail_test_put_uint16_be(&writer, 1);
+    sail_test_put_bytes(&writer, (uint8_t[6]){ 0 }, 6);
+    sail_test_put_uint16_be(&writer, channels);
+    sail_test_put_uint32_be(&writer, HEIGHT);
+    sail_test_put_uint32_be(&writer, WIDTH);
+    sail_test_put_uint16_be(&writer, depth);
+    sail_test_put_uint16_be(&writer, mode);
+    sail_test_put_uint32_be(&writer, 0); /* Color mode data. */
+    sail_test_put_uint32_be(&writer, 0); /* Image resources. */
+    sail_test_put_uint32_be(&writer, 0); /* Layer and mask information. */
+    sail_test_put_uint16_be(&writer, rle ? 1 : 0);
+
+    uint8_t *row    = malloc(row_size);
+    uint8_t *packed = malloc(row_size * 2);
+    size_t byte_counts_offset = writer.size;
+
+    if (rle) {
+        writer.size += (size_t)channels * HEIGHT * 2;
+    }
+
+    for (unsigned channel = 0; channel < channels; channel++) {
+        for (unsigned y = 0; y < HEIGHT; y++) {
+            for (unsigned x = 0; x < WIDTH; x++) {
+                const unsigned value = sample(channel, x, y, depth);
+
+                if (depth == 8) {
+                    row[x] = (uint8_t)value;
+                } else {
+                    row[x * 2]     = (uint8_t)(value >> 8);
+                    row[x * 2 + 1] = (uint8_t)value;
+                }
+            }
+
+            if (rle) {
+                const size_t packed_size = pack_bits(row, row_size, packed);
+                sail_test_put_bytes(&writer, packed, packed_size);
+
+                writer.data[byte_counts_offset++] = (uint8_t)(packed_size >> 8);
+                writer.data[byte_counts_offset++] = (uint8_t)packed_size;
+            } else {
+                sail_test_put_bytes(&writer, row, row_size);
+            }
+        }
+    }
+
+    free(packed);
+    free(row);
+
+    *psd_size = writer.size;
+    return writer.data;
+}
+
+static sail_status_t load_image(const void *buffer, size_t buffer_size, unsigned threads, struct sail_image **image) {
+
+    const struct sail_codec_info *codec_info;
+    SAIL_TRY(sail_codec_info_from_extension("psd", &codec_info));
+
+    struct sail_load_options *load_options;
+    SAIL_TRY(sail_alloc_load_options_from_features(codec_info->load_features, &load_options));
+
+    SAIL_TRY_OR_CLEANUP(sail_test_put_tuning_unsigned_int(&load_options->tuning, "psd-threads", threads),
+                        /* cleanup */ sail_destroy_load_options(load_options));
+
+    SAIL_TRY_OR_CLEANUP(sail_test_load_image(buffer, buffer_size, codec_info, load_options, image),
+                        /* cleanup */ sail_destroy_load_options(load_options));
+    sail_destroy_load_options(load_options);
+
+    return SAIL_OK;
+}
+
+static MunitResult test_decode(const MunitParameter params[], void *user_data) {
+    (void)user_data;
+
+    const char *format = munit_parameters_get(params, "format");
+    const bool rle = strcmp(munit_parameters_get(params, "compression"), "RLE") == 0;
+    const unsigned threads = (unsigned)atoi(munit_parameters_get(params, "threads"));
+
+    unsigned mode, channels, depth;
+    enum SailPixelFormat expected_pixel_format;
+
+    if (strcmp(format, "gray16") == 0) {
+        mode = 1; channels = 1; depth = 16; expected_pixel_format = SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE;
+    } else if (strcmp(format, "rgb8") == 0) {
+        mode = 3; channels = 3; depth = 8;  expected_pixel_format = SAIL_PIXEL_FORMAT_BPP24_RGB;
+    } else if (strcmp(format, "rgba16") == 0) {
+        mode = 3; channels = 4; depth = 16; expected_pixel_format = SAIL_PIXEL_FORMAT_BPP64_RGBA;
+    } else {
+        mode = 4; channels = 4; depth = 8;  expected_pixel_format = SAIL_PIXEL_FORMAT_BPP32_CMYK;
+    }
+
+    const struct sail_codec_info *codec_info;
+
+    if (sail_codec_info_from_extension("psd", &codec_info) != SAIL_OK) {
+        return MUNIT_SKIP;
+    }
+
+    size_t psd_size;
+    uint8_t *psd = build_psd(mode, channels, depth, rle, &psd_size);
+
+    struct sail_image *image = NULL;
+    munit_assert(load_image(psd, psd_size, threads, &image) == SAIL_OK);
+
+    munit_assert(image->width == WIDTH);
+    munit_assert(image->height == HEIGHT);
+    munit_assert(image->pixel_format == expected_pixel_format);
+
+    for (unsigned y = 0; y < HEIGHT; y++) {
+        const uint8_t  *scan8  = sail_scan_line(image, y);
+        const uint16_t *scan16 = sail_scan_line(image, y);
+
+        for (unsigned x = 0; x < WIDTH; x++) {
+            for (unsigned channel = 0; channel < channels; channel++) {
+                const unsigned actual = (depth == 8) ? scan8[x * channels + channel] : scan16[x * channels + channel];
+                munit_assert_uint(actual, ==, sample(channel, x, y, depth));
+            }
+        }
+    }
+
+    sail_destroy_image(image);
+
+    /* Truncated data must be reported. */
+    munit_assert(load_image(psd, psd_size - 1, threads, &image) != SAIL_OK);
+
+    free(psd);
+
+    return MUNIT_OK;
+}
+
+static char *format_params[] = { (char *)"gray16", (char *)"rgb8", (char *)"rgba16", (char *)"cmyk8", NULL };
+
+static char *compression_params[] = { (char *)"NONE", (char *)"RLE", NULL };
+
+static char *threads_params[] = { (char *)"1", (char *)"4", NULL };
+
+static MunitParameterEnum test_params[] = {
+    { (char *)"format",      format_params },
+    { (char *)"compression", compression_params },
+    { (char *)"threads",     threads_params },
+    { NULL, NULL },
+};
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/decode", test_decode, NULL, NULL, MUNIT_TEST_OPTION_NONE, test_params },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/psd-parallel-decoding",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
@@ -0,0 +1,234 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sail/sail.h>
+
+#include "sail-test-helpers.h"
+
+#include "munit.h"
+
+/* Large enough to be encoded into many I/O chunks. */
+#define WIDTH  1000
+#define HEIGHT 600
+
+static sail_status_t generate_image(enum SailPixelFormat pixel_format, struct sail_image **image) {
+
+    struct sail_image *image_local;
+    SAIL_TRY(sail_test_alloc_image(WIDTH, HEIGHT, pixel_format, &image_local));
+
+    /* Noise, gradients, and long runs crossing rows to produce every QOI chunk type. */
+    unsigned char *pixels = image_local->pixels;
+
+    for (size_t i = 0; i < sail_bytes_per_image(image_local); i++) {
+        const size_t x = i % image_local->bytes_per_line;
+        const size_t y = i / image_local->bytes_per_line;
+
+        if (y % 5 == 0) {
+            pixels[i] = 200;
+        } else if (y % 5 == 1) {
+            pixels[i] = (unsigned char)rand();
+        } else {
+            pixels[i] = (unsigned char)(x / 3 + y * (x / 200));
+        }
+    }
+
+    *image = image_local;
+
+    return SAIL_OK;
+}
+
+static sail_status_t load_image(const void *buffer, size_t buffer_size, const struct sail_codec_info *codec_info,
+                                const char *pixel_format, struct sail_image **image) {
+
+    struct sail_load_options *load_options;
+    SAIL_TRY(sail_alloc_load_options_from_features(codec_info->load_features, &load_options));
+
+    if (pixel_format != NULL) {
+        SAIL_TRY_OR_CLEANUP(sail_test_put_tuning_string(&load_options->tuning, "qoi-pixel-format", pixel_format),
+                            /* cleanup */ sail_destroy_load_options(load_options));
+    }
+
+    SAIL_TRY_OR_CLEANUP(sail_test_load_image(buffer, buffer_size, codec_info, load_options, image),
+                        /* cleanup */ sail_destroy_load_options(load_options));
+    sail_destroy_load_options(load_options);
+
+    return SAIL_OK;
+}
+
+/* Returns the byte offsets of R, G, B, and A in the pixel, or -1 for missing alpha. */
+static void channel_offsets(enum SailPixelFormat pixel_format, int offsets[4]) {
+
+    const bool bgr = pixel_format == SAIL_PIXEL_FORMAT_BPP24_BGR || pixel_format == SAIL_PIXEL_FORMAT_BPP32_BGRA;
+
+    offsets[0] = bgr ? 2 : 0;
+    offsets[1] = 1;
+    offsets[2] = bgr ? 0 : 2;
+    offsets[3] = (sail_bits_per_pixel(pixel_format) == 32) ? 3 : -1;
+}
+
+static void assert_same_pixels(const struct sail_image *expected, const struct sail_image *actual) {
+
+    munit_assert(actual->width == expected->width);
+    munit_assert(actual->height == expected->height);
+
+    int expected_offsets[4];
+    channel_offsets(expected->pixel_format, expected_offsets);
+
+    int actual_offsets[4];
+    channel_offsets(actual->pixel_format, actual_offsets);
+
+    const unsigned expected_bpp = sail_bits_per_pixel(expected->pixel_format) / 8;
+    const unsigned actual_bpp   = sail_bits_per_pixel(actual->pixel_format) / 8;
+
+    for (unsigned row = 0; row < expected->height; row++) {
+        const unsigned char *expected_scan = sail_scan_line(expected, row);
+        const unsigned char *actual_scan   = sail_scan_line(actual, row);
+
+        for (unsigned column = 0; column < expected->width; column++) {
+            const unsigned char *expected_pixel = expected_scan + column * expected_bpp;
+            const unsigned char *actual_pixel   = actual_scan + column * actual_bpp;
+
+            for (unsigned channel = 0; channel < 3; channel++) {
+                munit_assert_uint8(actual_pixel[actual_offsets[channel]], ==, expected_pixel[expected_offsets[channel]]);
+            }
+
+            /* Missing alpha is opaque, and alpha is dropped from 24-bit output. */
+            if (actual_offsets[3] >= 0) {
+                const unsigned char expected_alpha = (expected_offsets[3] >= 0) ? expected_pixel[expected_offsets[3]] : 255;
+                munit_assert_uint8(actual_pixel[actual_offsets[3]], ==, expected_alpha);
+            }
+        }
+    }
+}
+
+static MunitResult test_round_trip(const MunitParameter params[], void *user_data) {
+    (void)user_data;
+
+    const enum SailPixelFormat pixel_format = sail_pixel_format_from_string(munit_parameters_get(params, "pixel-format"));
+
+    const struct sail_codec_info *codec_info;
+
+    if (sail_codec_info_from_extension("qoi", &codec_info) != SAIL_OK) {
+        return MUNIT_SKIP;
+    }
+
+    srand(1);
+
+    struct sail_image *image = NULL;
+    munit_assert(generate_image(pixel_format, &image) == SAIL_OK);
+
+    void *buffer = NULL;
+    size_t buffer_size;
+    munit_assert(sail_test_save_image(image, codec_info, NULL, &buffer, &buffer_size) == SAIL_OK);
+
+    /* The file pixel format: RGB or RGBA. */
+    struct sail_image *loaded_image = NULL;
+    munit_assert(load_image(buffer, buffer_size, codec_info, NULL, &loaded_image) == SAIL_OK);
+    munit_assert(sail_bits_per_pixel(loaded_image->pixel_format) == sail_bits_per_pixel(pixel_format));
+    assert_same_pixels(image, loaded_image);
+    sail_destroy_image(loaded_image);
+
+    /* Decoded straight into every supported layout. */
+    static const char *output_pixel_formats[] = { "BPP24-RGB", "BPP24-BGR", "BPP32-RGBA", "BPP32-BGRA" };
+
+    for (size_t i = 0; i < sizeof(output_pixel_formats) / sizeof(output_pixel_formats[0]); i++) {
+        munit_assert(load_image(buffer, buffer_size, codec_info, output_pixel_formats[i], &loaded_image) == SAIL_OK);
+        munit_assert(loaded_image->pixel_format == sail_pixel_format_from_string(output_pixel_formats[i]));
+        assert_same_pixels(image, loaded_image);
+        sail_destroy_image(loaded_image);
+    }
+
+    sail_free(buffer);
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_truncated(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    const struct sail_codec_info *codec_info;
+
+    if (sail_codec_info_from_extension("qoi", &codec_info) != SAIL_OK) {
+        return MUNIT_SKIP;
+    }
+
+    srand(1);
+
+    struct sail_image *image = NULL;
+    munit_assert(generate_image(SAIL_PIXEL_FORMAT_BPP32_RGBA, &image) == SAIL_OK);
+
+    void *buffer = NULL;
+    size_t buffer_size;
+    munit_assert(sail_test_save_image(image, codec_info, NULL, &buffer, &buffer_size) == SAIL_OK);
+
+    /* Cut the end marker and the last chunks. */
+    struct sail_image *loaded_image = NULL;
+    munit_assert(load_image(buffer, buffer_size - 16, codec_info, NULL, &loaded_image) == SAIL_ERROR_BROKEN_IMAGE);
+    munit_assert_null(loaded_image);
+
+    sail_free(buffer);
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static char *pixel_format_params[] = {
+    (char *)"BPP24-RGB",
+    (char *)"BPP24-BGR",
+    (char *)"BPP32-RGBA",
+    (char *)"BPP32-BGRA",
+    NULL
+};
+
+static MunitParameterEnum test_params[] = {
+    { (char *)"pixel-format", pixel_format_params },
+    { NULL, NULL },
+};
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/round-trip", test_round_trip, NULL, NULL, MUNIT_TEST_OPTION_NONE, test_params },
+    { (char *)"/truncated",  test_truncated,  NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/qoi-streaming",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
@@ -0,0 +1,198 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdbool.h>
+#include <string.h>
+
+#include <sail/sail.h>
+
+#include "sail-test-helpers.h"
+
+#include "munit.h"
+
+#include "test-images.h"
+
+#define MAX_FRAMES 8
+
+struct expected_frame {
+    unsigned x;
+    unsigned y;
+    unsigned width;
+    unsigned height;
+    const char *dispose;
+    const char *blend;
+};
+
+/* Codec-specific tuning and special property names. */
+struct raw_frames_format {
+    const char *path;
+    const char *tuning;
+    const char *canvas_width;
+    const char *canvas_height;
+    const char *frame_x;
+    const char *frame_y;
+    const char *dispose;
+    const char *blend;
+};
+
+static const struct raw_frames_format APNG = {
+    SAIL_TEST_IMAGES_PATH "/png/bpp32-rgba.animated.png",
+    "png-raw-frames",
+    "apng-canvas-width",
+    "apng-canvas-height",
+    "apng-frame-x",
+    "apng-frame-y",
+    "apng-frame-dispose-op",
+    "apng-frame-blend-op",
+};
+
+static const struct expected_frame APNG_FRAMES[] = {
+    { 0,  0, 16, 12, "none",       "over"   },
+    { 2,  3,  8,  6, "background", "over"   },
+    { 8,  6,  6,  4, "previous",   "source" },
+    { 0,  0, 16, 12, "none",       "source" },
+    { 10, 6,  5,  5, "none",       "over"   },
+};
+
+static const struct raw_frames_format WEBP = {
+    SAIL_TEST_IMAGES_PATH "/webp/bpp32-rgba.animated.webp",
+    "webp-raw-frames",
+    "webp-canvas-width",
+    "webp-canvas-height",
+    "webp-frame-x",
+    "webp-frame-y",
+    "webp-frame-dispose-method",
+    "webp-frame-blend-method",
+};
+
+static const struct expected_frame WEBP_FRAMES[] = {
+    { 0,  0, 16, 12, "none",       "none"  },
+    { 2,  2,  8,  6, "background", "blend" },
+    { 8,  6,  6,  4, "none",       "none"  },
+    { 10, 6,  4,  4, "none",       "blend" },
+};
+
+static const struct sail_variant* property(const struct sail_image *image, const char *key) {
+
+    const struct sail_variant *variant = sail_hash_map_value(image->source_image->special_properties, key);
+    munit_assert_not_null(variant);
+
+    return variant;
+}
+
+/* Both test images have a 16x12 canvas. */
+static MunitResult test_raw_frames(const struct raw_frames_format *format,
+                                    const struct expected_frame expected_frames[], unsigned expected_frames_count) {
+
+    const struct sail_codec_info *codec_info;
+
+    if (sail_codec_info_from_path(format->path, &codec_info) != SAIL_OK) {
+        return MUNIT_SKIP;
+    }
+
+    void *buffer;
+    size_t buffer_size;
+    munit_assert(sail_alloc_data_from_file_contents(format->path, &buffer, &buffer_size) == SAIL_OK);
+
+    struct sail_load_options *load_options;
+    munit_assert(sail_alloc_load_options_from_features(codec_info->load_features, &load_options) == SAIL_OK);
+    munit_assert(sail_test_put_tuning_bool(&load_options->tuning, format->tuning, true) == SAIL_OK);
+
+    struct sail_image *images[MAX_FRAMES];
+    unsigned images_count;
+    munit_assert(sail_test_load_frames(buffer, buffer_size, codec_info, load_options, images, MAX_FRAMES, &images_count) == SAIL_OK);
+
+    /* libpng without the APNG patch reads the default image only. */
+    if (images_count == 1 && (images[0]->source_image == NULL ||
+                                images[0]->source_image->special_properties == NULL ||
+                                !sail_hash_map_has_key(images[0]->source_image->special_properties, format->frame_x))) {
+        sail_destroy_image(images[0]);
+        sail_destroy_load_options(load_options);
+        sail_free(buffer);
+        return MUNIT_SKIP;
+    }
+
+    munit_assert_uint(images_count, ==, expected_frames_count);
+
+    for (unsigned i = 0; i < images_count; i++) {
+        const struct sail_image *image = images[i];
+        const struct expected_frame *expected = &expected_frames[i];
+
+        munit_assert_uint(image->width, ==, expected->width);
+        munit_assert_uint(image->height, ==, expected->height);
+        munit_assert_uint(image->bytes_per_line, ==, sail_bytes_per_line(image->width, image->pixel_format));
+
+        /* Stored without SAIL_OPTION_SOURCE_IMAGE. */
+        munit_assert_not_null(image->source_image);
+        munit_assert_not_null(image->source_image->special_properties);
+
+        munit_assert_uint(sail_variant_to_unsigned_int(property(image, format->canvas_width)), ==, 16);
+        munit_assert_uint(sail_variant_to_unsigned_int(property(image, format->canvas_height)), ==, 12);
+        munit_assert_uint(sail_variant_to_unsigned_int(property(image, format->frame_x)), ==, expected->x);
+        munit_assert_uint(sail_variant_to_unsigned_int(property(image, format->frame_y)), ==, expected->y);
+        munit_assert_string_equal(sail_variant_to_string(property(image, format->dispose)), expected->dispose);
+        munit_assert_string_equal(sail_variant_to_string(property(image, format->blend)), expected->blend);
+
+        sail_destroy_image(images[i]);
+    }
+
+    sail_destroy_load_options(load_options);
+    sail_free(buffer);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_apng(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    return test_raw_frames(&APNG, APNG_FRAMES, sizeof(APNG_FRAMES) / sizeof(APNG_FRAMES[0]));
+}
+
+static MunitResult test_webp(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    return test_raw_frames(&WEBP, WEBP_FRAMES, sizeof(WEBP_FRAMES) / sizeof(WEBP_FRAMES[0]));
+}
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/apng", test_apng, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/webp", test_webp, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/raw-frames",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
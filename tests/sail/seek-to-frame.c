@@ -0,0 +1,387 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <sail/sail.h>
+
+#include "sail-comparators.h"
+#include "sail-test-helpers.h"
+
+#include "munit.h"
+
+#include "test-images.h"
+
+#define MAX_FRAMES 16
+
+struct frames {
+    struct sail_image *images[MAX_FRAMES];
+    unsigned count;
+};
+
+/* Non-seekable stream over a memory buffer, like a pipe. */
+struct pipe {
+    const unsigned char *data;
+    size_t size;
+    size_t pos;
+};
+
+static sail_status_t pipe_tolerant_read(void *stream, void *buf, size_t size_to_read, size_t *read_size) {
+
+    struct pipe *pipe = stream;
+
+    const size_t size = (size_to_read < pipe->size - pipe->pos) ? size_to_read : pipe->size - pipe->pos;
+
+    memcpy(buf, pipe->data + pipe->pos, size);
+
+    pipe->pos += size;
+    *read_size = size;
+
+    return SAIL_OK;
+}
+
+static sail_status_t pipe_close(void *stream) {
+
+    (void)stream;
+
+    return SAIL_OK;
+}
+
+static void alloc_pipe_io(struct pipe *pipe, struct sail_io **io) {
+
+    munit_assert(sail_alloc_io(io) == SAIL_OK);
+
+    (*io)->features       = 0;
+    (*io)->stream         = pipe;
+    (*io)->tolerant_read  = pipe_tolerant_read;
+    (*io)->strict_read    = sail_io_noop_strict_read;
+    (*io)->tolerant_write = sail_io_noop_tolerant_write;
+    (*io)->strict_write   = sail_io_noop_strict_write;
+    (*io)->seek           = sail_io_noop_seek;
+    (*io)->tell           = sail_io_noop_tell;
+    (*io)->flush          = sail_io_noop_flush;
+    (*io)->close          = pipe_close;
+    (*io)->eof            = sail_io_noop_eof;
+}
+
+/* Loads all the frames sequentially to compare seeking against. The load options may be NULL. */
+static MunitResult load_frames_sequentially(const char *path, const struct sail_load_options *load_options, struct frames *frames) {
+
+    const struct sail_codec_info *codec_info;
+
+    if (sail_codec_info_from_path(path, &codec_info) != SAIL_OK) {
+        return MUNIT_SKIP;
+    }
+
+    void *buffer;
+    size_t buffer_size;
+    munit_assert(sail_alloc_data_from_file_contents(path, &buffer, &buffer_size) == SAIL_OK);
+    munit_assert(sail_test_load_frames(buffer, buffer_size, codec_info, load_options, frames->images, MAX_FRAMES, &frames->count) == SAIL_OK);
+    munit_assert_uint(frames->count, >, 0);
+    sail_free(buffer);
+
+    return MUNIT_OK;
+}
+
+static void destroy_frames(struct frames *frames) {
+
+    for (unsigned i = 0; i < frames->count; i++) {
+        sail_destroy_image(frames->images[i]);
+    }
+}
+
+static void assert_same_frame(const struct sail_image *expected, const struct sail_image *actual) {
+
+    munit_assert_uint(actual->width, ==, expected->width);
+    munit_assert_uint(actual->height, ==, expected->height);
+    munit_assert_uint(actual->bytes_per_line, ==, expected->bytes_per_line);
+    munit_assert(actual->pixel_format == expected->pixel_format);
+    munit_assert_int(actual->delay, ==, expected->delay);
+    munit_assert_memory_equal(sail_bytes_per_image(expected), actual->pixels, expected->pixels);
+
+    if (expected->palette != NULL) {
+        munit_assert(sail_test_compare_palettes(expected->palette, actual->palette) == SAIL_OK);
+    }
+}
+
+/* Seeks to the frame and checks it and the frame after it against the sequentially loaded ones. */
+static void seek_and_compare(void *state, const struct frames *frames, unsigned frame) {
+
+    munit_assert(sail_seek_to_frame(state, frame) == SAIL_OK);
+
+    for (unsigned i = frame; i < frame + 2 && i < frames->count; i++) {
+        struct sail_image *image = NULL;
+        munit_assert(sail_load_next_frame(state, &image) == SAIL_OK);
+        assert_same_frame(frames->images[i], image);
+        sail_destroy_image(image);
+    }
+}
+
+static MunitResult test_seek(const MunitParameter params[], void *user_data, const unsigned *order, unsigned order_length) {
+    (void)user_data;
+
+    const char *path = munit_parameters_get(params, "path");
+
+    struct frames frames;
+    const MunitResult result = load_frames_sequentially(path, NULL, &frames);
+
+    if (result != MUNIT_OK) {
+        return result;
+    }
+
+    void *state = NULL;
+    munit_assert(sail_start_loading_from_file(path, NULL, &state) == SAIL_OK);
+
+    for (unsigned i = 0; i < order_length; i++) {
+        /* The order is given in percents of the last frame index. */
+        seek_and_compare(state, &frames, (frames.count - 1) * order[i] / 100);
+    }
+
+    munit_assert(sail_stop_loading(state) == SAIL_OK);
+
+    destroy_frames(&frames);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_seek_forward(const MunitParameter params[], void *user_data) {
+
+    static const unsigned order[] = { 0, 25, 50, 100 };
+
+    return test_seek(params, user_data, order, sizeof(order) / sizeof(order[0]));
+}
+
+static MunitResult test_seek_backward(const MunitParameter params[], void *user_data) {
+
+    static const unsigned order[] = { 100, 75, 50, 0, 100, 25 };
+
+    return test_seek(params, user_data, order, sizeof(order) / sizeof(order[0]));
+}
+
+static MunitResult test_seek_out_of_range(const MunitParameter params[], void *user_data) {
+    (void)user_data;
+
+    const char *path = munit_parameters_get(params, "path");
+
+    struct frames frames;
+    const MunitResult result = load_frames_sequentially(path, NULL, &frames);
+
+    if (result != MUNIT_OK) {
+        return result;
+    }
+
+    void *state = NULL;
+    munit_assert(sail_start_loading_from_file(path, NULL, &state) == SAIL_OK);
+
+    munit_assert(sail_seek_to_frame(state, frames.count) == SAIL_ERROR_NO_MORE_FRAMES);
+    munit_assert(sail_seek_to_frame(state, frames.count + 10) == SAIL_ERROR_NO_MORE_FRAMES);
+
+    /* Loading can be continued after a failed seek. */
+    seek_and_compare(state, &frames, frames.count - 1);
+    seek_and_compare(state, &frames, 0);
+
+    munit_assert(sail_stop_loading(state) == SAIL_OK);
+
+    destroy_frames(&frames);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_seek_without_loading(const MunitParameter params[], void *user_data) {
+    (void)user_data;
+
+    const char *path = munit_parameters_get(params, "path");
+
+    struct frames frames;
+    const MunitResult result = load_frames_sequentially(path, NULL, &frames);
+
+    if (result != MUNIT_OK) {
+        return result;
+    }
+
+    void *state = NULL;
+    munit_assert(sail_start_loading_from_file(path, NULL, &state) == SAIL_OK);
+
+    /* Seeks that skip the frames they have just positioned at. */
+    for (unsigned frame = 0; frame < frames.count; frame++) {
+        munit_assert(sail_seek_to_frame(state, frame) == SAIL_OK);
+        munit_assert(sail_seek_to_frame(state, frame) == SAIL_OK);
+    }
+
+    seek_and_compare(state, &frames, frames.count - 1);
+    seek_and_compare(state, &frames, 0);
+
+    munit_assert(sail_stop_loading(state) == SAIL_OK);
+
+    destroy_frames(&frames);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_seek_backward_non_seekable(const MunitParameter params[], void *user_data) {
+    (void)user_data;
+
+    const char *path = munit_parameters_get(params, "path");
+
+    struct frames frames;
+    const MunitResult result = load_frames_sequentially(path, NULL, &frames);
+
+    if (result != MUNIT_OK) {
+        return result;
+    }
+
+    const struct sail_codec_info *codec_info;
+    munit_assert(sail_codec_info_from_path(path, &codec_info) == SAIL_OK);
+
+    void *buffer;
+    size_t buffer_size;
+    munit_assert(sail_alloc_data_from_file_contents(path, &buffer, &buffer_size) == SAIL_OK);
+
+    struct pipe pipe = { buffer, buffer_size, 0 };
+    struct sail_io *source;
+    alloc_pipe_io(&pipe, &source);
+
+    struct sail_io *io;
+    munit_assert(sail_alloc_io_read_ahead(source, 64, &io) == SAIL_OK);
+
+    void *state = NULL;
+    munit_assert(sail_start_loading_from_io(io, codec_info, &state) == SAIL_OK);
+
+    /* Frame #0 and the frame after it. */
+    seek_and_compare(state, &frames, 0);
+
+    if (codec_info->load_features->features & SAIL_CODEC_FEATURE_STREAMING) {
+        /* Also codecs with the fast path cannot rewind a non-seekable stream. */
+        munit_assert(sail_seek_to_frame(state, 0) == SAIL_ERROR_NOT_IMPLEMENTED);
+
+        /* Loading can be continued forward after a failed seek. */
+        if (frames.count > 2) {
+            seek_and_compare(state, &frames, 2);
+            seek_and_compare(state, &frames, frames.count - 1);
+        }
+    } else {
+        /* The stream is spooled into memory, so it's seekable. */
+        seek_and_compare(state, &frames, frames.count - 1);
+        seek_and_compare(state, &frames, 0);
+    }
+
+    munit_assert(sail_stop_loading(state) == SAIL_OK);
+
+    sail_destroy_io(io);
+    sail_destroy_io(source);
+    sail_free(buffer);
+    destroy_frames(&frames);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_seek_raw_frames(const MunitParameter params[], void *user_data) {
+    (void)user_data;
+
+    const char *path = munit_parameters_get(params, "path");
+
+    const struct sail_codec_info *codec_info;
+
+    if (sail_codec_info_from_path(path, &codec_info) != SAIL_OK) {
+        return MUNIT_SKIP;
+    }
+
+    /* Tuning names start with the codec name, e.g. "gif-raw-frames". */
+    char tuning[64];
+    snprintf(tuning, sizeof(tuning), "%s-raw-frames", codec_info->extension_node->string);
+
+    struct sail_load_options *load_options;
+    munit_assert(sail_alloc_load_options_from_features(codec_info->load_features, &load_options) == SAIL_OK);
+    munit_assert(sail_test_put_tuning_bool(&load_options->tuning, tuning, true) == SAIL_OK);
+
+    struct frames frames;
+    munit_assert(load_frames_sequentially(path, load_options, &frames) == MUNIT_OK);
+
+    void *state = NULL;
+    munit_assert(sail_start_loading_from_file_with_options(path, codec_info, load_options, &state) == SAIL_OK);
+
+    /* Raw frames don't depend on each other, so the fast paths jump to them directly. */
+    static const unsigned order[] = { 100, 50, 0, 75, 25 };
+
+    for (unsigned i = 0; i < sizeof(order) / sizeof(order[0]); i++) {
+        seek_and_compare(state, &frames, (frames.count - 1) * order[i] / 100);
+    }
+
+    munit_assert(sail_stop_loading(state) == SAIL_OK);
+
+    sail_destroy_load_options(load_options);
+    destroy_frames(&frames);
+
+    return MUNIT_OK;
+}
+
+static char *path_params[] = {
+    (char *)SAIL_TEST_IMAGES_PATH "/gif/bpp8-indexed.animated.gif",
+    (char *)SAIL_TEST_IMAGES_PATH "/ico/bpp32-bgra.multiple.ico",
+    (char *)SAIL_TEST_IMAGES_PATH "/png/bpp32-rgba.animated.png",
+    (char *)SAIL_TEST_IMAGES_PATH "/webp/bpp32-rgba.animated.webp",
+    NULL
+};
+
+static MunitParameterEnum test_params[] = {
+    { (char *)"path", path_params },
+    { NULL, NULL },
+};
+
+static char *raw_path_params[] = {
+    (char *)SAIL_TEST_IMAGES_PATH "/gif/bpp8-indexed.animated.gif",
+    (char *)SAIL_TEST_IMAGES_PATH "/png/bpp32-rgba.animated.png",
+    (char *)SAIL_TEST_IMAGES_PATH "/webp/bpp32-rgba.animated.webp",
+    NULL
+};
+
+static MunitParameterEnum raw_test_params[] = {
+    { (char *)"path", raw_path_params },
+    { NULL, NULL },
+};
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/forward",               test_seek_forward,               NULL, NULL, MUNIT_TEST_OPTION_NONE, test_params },
+    { (char *)"/backward",              test_seek_backward,              NULL, NULL, MUNIT_TEST_OPTION_NONE, test_params },
+    { (char *)"/out-of-range",          test_seek_out_of_range,          NULL, NULL, MUNIT_TEST_OPTION_NONE, test_params },
+    { (char *)"/without-loading",       test_seek_without_loading,       NULL, NULL, MUNIT_TEST_OPTION_NONE, test_params },
+    { (char *)"/backward-non-seekable", test_seek_backward_non_seekable, NULL, NULL, MUNIT_TEST_OPTION_NONE, test_params },
+    { (char *)"/raw-frames",            test_seek_raw_frames,            NULL, NULL, MUNIT_TEST_OPTION_NONE, raw_test_params },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/seek-to-frame",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
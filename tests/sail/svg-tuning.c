@@ -0,0 +1,170 @@
+/*  This file is part of SAIL (https://github.com/HappySeaFox/sail)
+
+    Copyright (c) 2023 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <sail/sail.h>
+
+#include "sail-test-helpers.h"
+
+#include "munit.h"
+
+/* 30x20 user units filled with an opaque color. */
+static const char SVG[] =
+    "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"30\" height=\"20\" viewBox=\"0 0 30 20\">"
+    "<rect x=\"0\" y=\"0\" width=\"30\" height=\"20\" fill=\"#FF0000\"/>"
+    "</svg>";
+
+/* Zero tuning values are not set. */
+static sail_status_t load_image(const struct sail_codec_info *codec_info, unsigned width, unsigned height, unsigned dpi,
+                                struct sail_image **image) {
+
+    struct sail_load_options *load_options;
+    SAIL_TRY(sail_alloc_load_options_from_features(codec_info->load_features, &load_options));
+
+    if (width != 0) {
+        SAIL_TRY_OR_CLEANUP(sail_test_put_tuning_unsigned_int(&load_options->tuning, "svg-width", width),
+                            /* cleanup */ sail_destroy_load_options(load_options));
+    }
+    if (height != 0) {
+        SAIL_TRY_OR_CLEANUP(sail_test_put_tuning_unsigned_int(&load_options->tuning, "svg-height", height),
+                            /* cleanup */ sail_destroy_load_options(load_options));
+    }
+    if (dpi != 0) {
+        SAIL_TRY_OR_CLEANUP(sail_test_put_tuning_unsigned_int(&load_options->tuning, "svg-dpi", dpi),
+                            /* cleanup */ sail_destroy_load_options(load_options));
+    }
+
+    SAIL_TRY_OR_CLEANUP(sail_test_load_image(SVG, strlen(SVG), codec_info, load_options, image),
+                        /* cleanup */ sail_destroy_load_options(load_options));
+    sail_destroy_load_options(load_options);
+
+    return SAIL_OK;
+}
+
+struct test_case {
+    unsigned width;
+    unsigned height;
+    unsigned dpi;
+    unsigned expected_width;
+    unsigned expected_height;
+};
+
+static const struct test_case test_cases[] = {
+    /* Intrinsic size. */
+    {  0,  0,   0, 30, 20 },
+    /* The other dimension is rounded, not ceiled: 33.3 -> 33. */
+    { 50,  0,   0, 50, 33 },
+    {  0, 50,   0, 75, 50 },
+    /* Fit into the box: the width is limiting. */
+    { 50, 50,   0, 50, 33 },
+    /* Fit into the box: the height is limiting. */
+    { 90, 10,   0, 15, 10 },
+    /* 1.5 times the default 96 DPI. */
+    {  0,  0, 144, 45, 30 },
+    /* The target size takes precedence over DPI. */
+    { 60,  0, 144, 60, 40 },
+};
+
+static MunitResult test_size(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    const struct sail_codec_info *codec_info;
+
+    if (sail_codec_info_from_extension("svg", &codec_info) != SAIL_OK) {
+        return MUNIT_SKIP;
+    }
+
+    for (size_t i = 0; i < sizeof(test_cases) / sizeof(test_cases[0]); i++) {
+        const struct test_case *test_case = &test_cases[i];
+
+        struct sail_image *image = NULL;
+        munit_assert(load_image(codec_info, test_case->width, test_case->height, test_case->dpi, &image) == SAIL_OK);
+
+        munit_assert(image->pixel_format == SAIL_PIXEL_FORMAT_BPP32_RGBA);
+        munit_assert_uint(image->width, ==, test_case->expected_width);
+        munit_assert_uint(image->height, ==, test_case->expected_height);
+
+        /* The picture covers the whole image, so the corners are opaque. */
+        const unsigned char *first_pixel = sail_scan_line(image, 0);
+        const unsigned char *last_pixel  = (const unsigned char *)sail_scan_line(image, image->height - 1) + (image->width - 1) * 4;
+
+        munit_assert_uint8(first_pixel[3], ==, 255);
+        munit_assert_uint8(last_pixel[3], ==, 255);
+
+        sail_destroy_image(image);
+    }
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_repeated_loads(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    const struct sail_codec_info *codec_info;
+
+    if (sail_codec_info_from_extension("svg", &codec_info) != SAIL_OK) {
+        return MUNIT_SKIP;
+    }
+
+    struct sail_image *image = NULL;
+    munit_assert(load_image(codec_info, 64, 0, 0, &image) == SAIL_OK);
+
+    /* Every decode creates its own rasterizer and renders the same pixels. */
+    for (unsigned i = 0; i < 5; i++) {
+        struct sail_image *next_image = NULL;
+        munit_assert(load_image(codec_info, 64, 0, 0, &next_image) == SAIL_OK);
+        munit_assert_uint(next_image->width, ==, image->width);
+        munit_assert_uint(next_image->height, ==, image->height);
+        munit_assert_memory_equal(sail_bytes_per_image(image), next_image->pixels, image->pixels);
+        sail_destroy_image(next_image);
+    }
+
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/size",           test_size,           NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/repeated-loads", test_repeated_loads, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/svg-tuning",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}